@@ -40,6 +40,44 @@ void MMU_enable_count(void)
 	CoreWithMMUOn++;
 }
 
+/* Compositor benchmark, n windows with the top one bouncing round the screen */
+#define BENCH_WND_WTH 96
+#define BENCH_WND_HT 72
+#define BENCH_FRAMES 200
+static HWND benchWnd[200];
+
+static uint32_t CompositorBench (uint32_t n, bool fullRedraw)
+{
+	uint32_t seed = 12345;
+	int sw = GetScreenWidth() - BENCH_WND_WTH;
+	int sh = GetScreenHeight() - BENCH_WND_HT;
+	for (uint32_t i = 0; i < n; i++) {
+		char buf[8];
+		seed = seed * 1103515245 + 12345;							// Simple LCG for positions and colours
+		benchWnd[i] = CreateWindowSurface((seed >> 8) % sw, (seed >> 16) % sh, BENCH_WND_WTH, BENCH_WND_HT);
+		HDC dc = GetDC(benchWnd[i]);
+		SetDCBrushColor(dc, 0xFF000000 | seed);
+		Rectangle(dc, 0, 0, BENCH_WND_WTH, BENCH_WND_HT);			// Window frame and body
+		TextOut(dc, 4, 4, buf, sprintf(buf, "%u", (unsigned int)i));// Window number
+	}
+	ComposeDesktop();												// Initial full compose
+	int x = 0, y = 0, dx = 3, dy = 2;
+	uint64_t start = timer_getTickCount64();
+	for (uint32_t f = 0; f < BENCH_FRAMES; f++) {
+		x += dx;
+		y += dy;
+		if ((x < 0) || (x >= sw)) { dx = -dx; x += 2 * dx; }		// Bounce off the screen sides
+		if ((y < 0) || (y >= sh)) { dy = -dy; y += 2 * dy; }
+		MoveWindow(benchWnd[n - 1], x, y, BENCH_WND_WTH, BENCH_WND_HT, TRUE);
+		if (fullRedraw) InvalidateRect(0, 0, FALSE);				// Baseline recomposes everything
+		ComposeDesktop();
+	}
+	uint64_t elapsed = timer_getTickCount64() - start;
+	for (uint32_t i = 0; i < n; i++) DestroyWindow(benchWnd[i]);
+	ComposeDesktop();
+	return (uint32_t)((BENCH_FRAMES * 1000000ull) / (elapsed ? elapsed : 1));
+}
+
 static const char Spin[4] = { '|', '/', '-', '\\' };
 void main(void)
 {
@@ -99,6 +137,21 @@ void main(void)
 	semaphore_give(&check_hello); // release hello semaphore
 	while (hellocount != 3) {};
 	printf("Core print above could be in any order\n");
+
+	/* Benchmark the window compositor, results print after as compose overwrites the console */
+	static const uint32_t benchCount[3] = { 10, 50, 200 };
+	uint32_t damageFps[3], fullFps[3];
+	SetDesktopColor(0xFF204060);
+	for (int b = 0; b < 3; b++) {
+		damageFps[b] = CompositorBench(benchCount[b], false);
+		fullFps[b] = CompositorBench(benchCount[b], true);
+	}
+	SetDCBrushColor(0, 0xFF000000);
+	Rectangle(0, 0, 0, GetScreenWidth(), GetScreenHeight());		// Clear screen back for console
+	GotoXY(0, 0);
+	for (int b = 0; b < 3; b++)
+		printf("Compositor %3u windows: damage %u fps, full redraw %u fps\n",
+			(unsigned int)benchCount[b], (unsigned int)damageFps[b], (unsigned int)fullFps[b]);
 	printf("\ntest all done ... now deadlooping stop\n");
 	i = 0;
 	while (1) {
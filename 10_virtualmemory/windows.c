@@ -26,6 +26,7 @@
 
 #include <stdbool.h>			// C standard unit needed for bool and true/false
 #include <stdint.h>				// C standard unit needed for uint8_t, uint32_t, etc
+#include <string.h>				// C standard unit needed for memcpy
 #include "rpi-smartstart.h"
 #include "Font8x16.h"			// Provides the 8x16 bitmap font for console 
 #include "windows.h"			// This units header
@@ -34,6 +35,12 @@
 {					 INTERNAL DEVICE CONTEXT STRUCTURE						}
 {--------------------------------------------------------------------------*/
 typedef struct __attribute__((__packed__, aligned(4))) tagINTDC {
+	/* Surface the DC draws on, the screen or a window surface */
+	uintptr_t fb;													// Surface address
+	uint32_t wth;													// Surface width
+	uint32_t ht;													// Surface height
+	uint32_t pitch;													// Pitch in pixels (Line to line offset)
+
 	/* Position control */
 	POINT curPos;													// Current position of graphics pointer
 	POINT cursor;													// Current cursor position
@@ -82,6 +89,38 @@ static struct __attribute__((__packed__, aligned(4))) {
 static unsigned int extDCcount = 0;
 static INTDC extDC[MAX_EXT_DC] = { 0 };
 
+/*--------------------------------------------------------------------------}
+{				   RETAINED WINDOW COMPOSITOR STRUCTURES					}
+{--------------------------------------------------------------------------*/
+#define MAX_WINDOWS 256													// Maximum windows the compositor can hold
+#define MAX_DAMAGE_RECTS 32												// Damage rectangles held between composes
+#define MAX_VISIBLE_RECTS 512											// Uncovered fragments of one damage rectangle
+#define WND_SURFACE_POOL (8 * 1024 * 1024)								// Memory shared by all window surfaces
+
+typedef struct __attribute__((__packed__, aligned(4))) tagINTWND {
+	RECT rc;														// Window position on screen
+	uint32_t poolOfs;												// Offset of surface in the surface pool
+	uint32_t poolSize;												// Size of surface in bytes
+	INTDC dc;														// DC that draws on the window surface
+	struct {
+		unsigned usedWnd : 1;										// Window slot is in use
+		unsigned visible : 1;										// Window is shown
+		unsigned _reserved : 30;
+	};
+} INTWND;
+
+static struct __attribute__((__packed__, aligned(4))) {
+	uint32_t count;													// Number of windows in z-order
+	uint32_t damageCount;											// Number of damage rectangles
+	INTDC deskDC;													// DC used to fill uncovered desktop
+	uint16_t zOrder[MAX_WINDOWS];									// Window indexes from bottom (0) to top
+	RECT damage[MAX_DAMAGE_RECTS];									// Damaged screen rectangles
+	INTWND wnd[MAX_WINDOWS];										// Window slots
+} WNDMGR_CB = { 0 };
+
+static RECT visRect[MAX_VISIBLE_RECTS];								// Work list of uncovered fragments
+static uint8_t __attribute__((aligned(16))) surfacePool[WND_SURFACE_POOL];
+
 /***************************************************************************}
 {						  PRIVATE C ROUTINES 			                    }
 {***************************************************************************/
@@ -96,12 +135,12 @@ static INTDC extDC[MAX_EXT_DC] = { 0 };
 . As an internal function pairs assumed to be correctly ordered and dc valid.
 .--------------------------------------------------------------------------*/
 static void ClearArea16(INTDC* dc, uint_fast32_t x1, uint_fast32_t y1, uint_fast32_t x2, uint_fast32_t y2) {
-	RGB565* __attribute__((__packed__, aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (y1 * WINAPI_CB.pitch * 2) + (x1 * 2));
+	RGB565* __attribute__((__packed__, aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (y1 * dc->pitch * 2) + (x1 * 2));
 	for (uint_fast32_t y = 0; y < (y2 - y1); y++) {					// For each y line
 		for (uint_fast32_t x = 0; x < (x2 - x1); x++) {				// For each x between x1 and x2
 			video_wr_ptr[x] = dc->BrushColor565;					// Write the colour
 		}
-		video_wr_ptr += WINAPI_CB.pitch;							// Offset to next line
+		video_wr_ptr += dc->pitch;									// Offset to next line
 	}
 }
 
@@ -111,11 +150,11 @@ static void ClearArea16(INTDC* dc, uint_fast32_t x1, uint_fast32_t y1, uint_fast
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void VertLine16(INTDC* dc, uint_fast32_t cy, int_fast8_t dir) {
-	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	for (uint_fast32_t i = 0; i < cy; i++) {						// For each y line
 		video_wr_ptr[0] = dc->TxtColor565;							// Write the current text colour
-		if (dir == 1) video_wr_ptr += WINAPI_CB.pitch;				// Positive offset to next line
-		  else  video_wr_ptr -= WINAPI_CB.pitch;					// Negative offset to next line
+		if (dir == 1) video_wr_ptr += dc->pitch;					// Positive offset to next line
+		  else  video_wr_ptr -= dc->pitch;							// Negative offset to next line
 	}
 }
 
@@ -125,7 +164,7 @@ static void VertLine16(INTDC* dc, uint_fast32_t cy, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void HorzLine16(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
-	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	for (uint_fast32_t i = 0; i < cx; i++) {						// For each x pixel
 		video_wr_ptr[0] = dc->TxtColor565;							// Write the current text colour
 		video_wr_ptr += dir;										// Positive offset to next pixel
@@ -138,7 +177,7 @@ static void HorzLine16(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void DiagLine16(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8_t xdir, int_fast8_t ydir) {
-	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	uint_fast32_t tx = 0;											// Zero test x value
 	uint_fast32_t ty = 0;											// Zero test y value
 	uint_fast32_t eulerMax = (dy > dx) ? dy : dx;					// Larger of dx and dy value
@@ -152,7 +191,7 @@ static void DiagLine16(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir * WINAPI_CB.pitch);				// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * dc->pitch);						// Move pointer up/down 1 line
 		}
 	}
 }
@@ -163,7 +202,7 @@ static void DiagLine16(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void WriteChar16(INTDC * dc, uint8_t Ch) {
-	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -172,7 +211,7 @@ static void WriteChar16(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0) col = dc->TxtColor565;		// If bit set take current text colour
 			video_wr_ptr[xoffs] = col;								// Write pixel
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -184,7 +223,7 @@ static void WriteChar16(INTDC * dc, uint8_t Ch) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void TransparentWriteChar16(INTDC * dc, uint8_t Ch) {
-	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -192,7 +231,7 @@ static void TransparentWriteChar16(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0) 								// If bit set take text colour
 				video_wr_ptr[xoffs] = dc->TxtColor565;				// Write pixel in current text colour
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -205,13 +244,13 @@ static void TransparentWriteChar16(INTDC * dc, uint8_t Ch) {
 .--------------------------------------------------------------------------*/
 static void PutImage16(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, uint_fast32_t p2wth, HIMAGE ImageSrc, bool BottomUp) {
 	HIMAGE video_wr_ptr;
-	video_wr_ptr.ptrRGB565 = (RGB565*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 2) + (dc->curPos.x * 2));
+	video_wr_ptr.ptrRGB565 = (RGB565*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 2) + (dc->curPos.x * 2));
 	for (uint_fast32_t y = 0; y < dy; y++) {						// For each line
 		for (uint_fast32_t x = 0; x < dx; x++) {					// For each pixel
 			video_wr_ptr.ptrRGB565[x] = ImageSrc.ptrRGB565[x];		// Transfer pixel
 		}
-		if (BottomUp) video_wr_ptr.ptrRGB565 -= WINAPI_CB.pitch;	// Next line up
-			else video_wr_ptr.ptrRGB565 += WINAPI_CB.pitch;			// Next line down
+		if (BottomUp) video_wr_ptr.ptrRGB565 -= dc->pitch;			// Next line up
+			else video_wr_ptr.ptrRGB565 += dc->pitch;				// Next line down
 		ImageSrc.rawImage += p2wth;									// Adjust image pointer by power 2 width
 	}
 }
@@ -226,12 +265,12 @@ static void PutImage16(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, uint_fast
 . As an internal function pairs assumed to be correctly ordered and dc valid.
 .--------------------------------------------------------------------------*/
 static void ClearArea24(INTDC * dc, uint_fast32_t x1, uint_fast32_t y1, uint_fast32_t x2, uint_fast32_t y2) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (y1 * WINAPI_CB.pitch * 3) + (x1 * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (y1 * dc->pitch * 3) + (x1 * 3));
 	for (uint_fast32_t y = 0; y < (y2 - y1); y++) {					// For each y line
 		for (uint_fast32_t x = 0; x < (x2 - x1); x++) {				// For each x between x1 and x2
 			video_wr_ptr[x] = dc->BrushColor.rgb;					// Write the colour
 		}
-		video_wr_ptr += WINAPI_CB.pitch;							// Offset to next line
+		video_wr_ptr += dc->pitch;									// Offset to next line
 	}
 }
 
@@ -241,11 +280,11 @@ static void ClearArea24(INTDC * dc, uint_fast32_t x1, uint_fast32_t y1, uint_fas
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void VertLine24(INTDC * dc, uint_fast32_t cy, int_fast8_t dir) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	for (uint_fast32_t i = 0; i < cy; i++) {						// For each y line
 		video_wr_ptr[0] = dc->TxtColor.rgb;							// Write the colour
-		if (dir == 1) video_wr_ptr += WINAPI_CB.pitch;				// Positive offset to next line
-		  else  video_wr_ptr -= WINAPI_CB.pitch;					// Negative offset to next line
+		if (dir == 1) video_wr_ptr += dc->pitch;					// Positive offset to next line
+		  else  video_wr_ptr -= dc->pitch;							// Negative offset to next line
 	}
 }
 
@@ -255,7 +294,7 @@ static void VertLine24(INTDC * dc, uint_fast32_t cy, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void HorzLine24(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	for (uint_fast32_t i = 0; i < cx; i++) {						// For each x pixel
 		video_wr_ptr[0] = dc->TxtColor.rgb;							// Write the colour
 		video_wr_ptr += dir;										// Positive offset to next pixel
@@ -268,7 +307,7 @@ static void HorzLine24(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void DiagLine24(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8_t xdir, int_fast8_t ydir) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	uint_fast32_t tx = 0;
 	uint_fast32_t ty = 0;
 	uint_fast32_t eulerMax = (dy > dx) ? dy : dx;					// Larger of dx and dy value
@@ -282,7 +321,7 @@ static void DiagLine24(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir * WINAPI_CB.pitch);				// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * dc->pitch);						// Move pointer up/down 1 line
 		}
 	}
 }
@@ -293,7 +332,7 @@ static void DiagLine24(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void WriteChar24(INTDC * dc, uint8_t Ch) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -302,7 +341,7 @@ static void WriteChar24(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0) col = dc->TxtColor.rgb;		// If bit set take text colour
 			video_wr_ptr[xoffs] = col;								// Write pixel
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -314,7 +353,7 @@ static void WriteChar24(INTDC * dc, uint8_t Ch) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void TransparentWriteChar24(INTDC * dc, uint8_t Ch) {
-	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	RGB* __attribute__((aligned(1))) video_wr_ptr = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -322,7 +361,7 @@ static void TransparentWriteChar24(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0)								// If bit set take text colour
 				video_wr_ptr[xoffs] = dc->TxtColor.rgb;				// Write pixel
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -335,13 +374,13 @@ static void TransparentWriteChar24(INTDC * dc, uint8_t Ch) {
 .--------------------------------------------------------------------------*/
 static void PutImage24(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, uint_fast32_t p2wth, HIMAGE ImageSrc, bool BottomUp) {
 	HIMAGE video_wr_ptr;
-	video_wr_ptr.ptrRGB = (RGB*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 3) + (dc->curPos.x * 3));
+	video_wr_ptr.ptrRGB = (RGB*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 3) + (dc->curPos.x * 3));
 	for (uint_fast32_t y = 0; y < dy; y++) {						// For each line
 		for (uint_fast32_t x = 0; x < dx; x++) {					// For each pixel
 			video_wr_ptr.ptrRGB[x] = ImageSrc.ptrRGB[x];			// Transfer pixel
 		}
-		if (BottomUp) video_wr_ptr.ptrRGB -= WINAPI_CB.pitch;		// Next line up
-			else video_wr_ptr.ptrRGB += WINAPI_CB.pitch;			// Next line down
+		if (BottomUp) video_wr_ptr.ptrRGB -= dc->pitch;				// Next line up
+			else video_wr_ptr.ptrRGB += dc->pitch;					// Next line down
 		ImageSrc.rawImage += p2wth;									// Adjust image pointer by power 2 width
 	}
 }
@@ -356,12 +395,12 @@ static void PutImage24(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, uint_fast
 . As an internal function pairs assumed to be correctly ordered and dc valid.
 .--------------------------------------------------------------------------*/
 static void ClearArea32(INTDC * dc, uint_fast32_t x1, uint_fast32_t y1, uint_fast32_t x2, uint_fast32_t y2) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (y1 * WINAPI_CB.pitch * 4) + (y1 * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y1 * dc->pitch * 4) + (x1 * 4));
 	for (uint_fast32_t y = 0; y < (y2 - y1); y++) {					// For each y line
 		for (uint_fast32_t x = 0; x < (x2 - x1); x++) {				// For each x between x1 and x2
 			video_wr_ptr[x] = dc->BrushColor;						// Write the current brush colour
 		}
-		video_wr_ptr += WINAPI_CB.pitch;							// Next line down
+		video_wr_ptr += dc->pitch;									// Next line down
 	}
 }
 
@@ -371,11 +410,11 @@ static void ClearArea32(INTDC * dc, uint_fast32_t x1, uint_fast32_t y1, uint_fas
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void VertLine32(INTDC * dc, uint_fast32_t cy, int_fast8_t dir) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	for (uint_fast32_t i = 0; i < cy; i++) {						// For each y line
 		video_wr_ptr[0] = dc->TxtColor;								// Write the colour
-		if (dir == 1) video_wr_ptr += WINAPI_CB.pitch;				// Positive offset to next line
-			else  video_wr_ptr -= WINAPI_CB.pitch;					// Negative offset to next line
+		if (dir == 1) video_wr_ptr += dc->pitch;					// Positive offset to next line
+			else  video_wr_ptr -= dc->pitch;						// Negative offset to next line
 	}
 }
 
@@ -385,7 +424,7 @@ static void VertLine32(INTDC * dc, uint_fast32_t cy, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void HorzLine32(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	for (uint_fast32_t i = 0; i < cx; i++) {						// For each x pixel
 		video_wr_ptr[0] = dc->TxtColor;								// Write the colour
 		video_wr_ptr += dir;										// Positive offset to next pixel
@@ -398,7 +437,7 @@ static void HorzLine32(INTDC * dc, uint_fast32_t cx, int_fast8_t dir) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void DiagLine32(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8_t xdir, int_fast8_t ydir) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	uint_fast32_t tx = 0;
 	uint_fast32_t ty = 0;
 	uint_fast32_t eulerMax = (dy > dx) ? dy : dx;					// Larger of dx and dy value
@@ -412,7 +451,7 @@ static void DiagLine32(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir * WINAPI_CB.pitch);				// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * dc->pitch);						// Move pointer up/down 1 line
 		}
 	}
 }
@@ -423,7 +462,7 @@ static void DiagLine32(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void WriteChar32(INTDC * dc, uint8_t Ch) {
-	RGBA* __attribute__((__packed__, aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	RGBA* __attribute__((__packed__, aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -432,7 +471,7 @@ static void WriteChar32(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0) col = dc->TxtColor;			// If bit set take text colour
 			video_wr_ptr[xoffs] = col;								// Write pixel
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -444,7 +483,7 @@ static void WriteChar32(INTDC * dc, uint8_t Ch) {
 . As an internal function the dc is assumed to be valid.
 .--------------------------------------------------------------------------*/
 static void TransparentWriteChar32(INTDC * dc, uint8_t Ch) {
-	RGBA* __attribute__((__packed__, aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	RGBA* __attribute__((__packed__, aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	for (uint_fast32_t y = 0; y < 4; y++) {
 		uint32_t b = BitFont[(Ch * 4) + y];							// Fetch character bits
 		for (uint_fast32_t i = 0; i < 32; i++) {					// For each bit
@@ -452,7 +491,7 @@ static void TransparentWriteChar32(INTDC * dc, uint8_t Ch) {
 			if ((b & 0x80000000) != 0)								// If bit set take text colour
 				video_wr_ptr[xoffs] = dc->TxtColor;					// Write pixel
 			b <<= 1;												// Roll font bits left
-			if (xoffs == 7) video_wr_ptr += WINAPI_CB.pitch;		// If was bit 7 next line down
+			if (xoffs == 7) video_wr_ptr += dc->pitch;				// If was bit 7 next line down
 		}
 	}
 }
@@ -465,13 +504,13 @@ static void TransparentWriteChar32(INTDC * dc, uint8_t Ch) {
 .--------------------------------------------------------------------------*/
 static void PutImage32(INTDC * dc, uint_fast32_t dx, uint_fast32_t dy, uint_fast32_t p2wth, HIMAGE ImageSrc, bool BottomUp) {
 	HIMAGE video_wr_ptr;
-	video_wr_ptr.ptrRGBA = (RGBA*)(uintptr_t)(WINAPI_CB.fb + (dc->curPos.y * WINAPI_CB.pitch * 4) + (dc->curPos.x * 4));
+	video_wr_ptr.ptrRGBA = (RGBA*)(uintptr_t)(dc->fb + (dc->curPos.y * dc->pitch * 4) + (dc->curPos.x * 4));
 	for (uint_fast32_t y = 0; y < dy; y++) {						// For each line
 		for (uint_fast32_t x = 0; x < dx; x++) {					// For each pixel
 			video_wr_ptr.ptrRGBA[x] = ImageSrc.ptrRGBA[x];			// Transfer pixel
 		}
-		if (BottomUp) video_wr_ptr.ptrRGBA -= WINAPI_CB.pitch;		// Next line up
-			else video_wr_ptr.ptrRGBA += WINAPI_CB.pitch;			// Next line down
+		if (BottomUp) video_wr_ptr.ptrRGBA -= dc->pitch;			// Next line up
+			else video_wr_ptr.ptrRGBA += dc->pitch;					// Next line down
 		ImageSrc.rawImage += p2wth;									// Adjust image pointer by power 2 width
 	}
 }
@@ -781,6 +820,10 @@ bool PiConsole_Init (int Width,										// Screen width request (Use 0 if you w
 		break;
 	}
 
+	extDC[0].fb = WINAPI_CB.fb;										// Console DC draws on the screen
+	extDC[0].wth = WINAPI_CB.wth;									// Console DC width is screen width
+	extDC[0].ht = WINAPI_CB.ht;										// Console DC height is screen height
+	extDC[0].pitch = WINAPI_CB.pitch;								// Console DC pitch is screen pitch
 	extDC[0].usedDC = 1;
 	extDCcount++;
 
@@ -1002,6 +1045,11 @@ HDC CreateExternalDC (int num)
 	if (num < MAX_EXT_DC) {
 		if (extDC[num].usedDC == 0)
 		{
+			extDC[num].fb = extDC[0].fb;
+			extDC[num].wth = extDC[0].wth;
+			extDC[num].ht = extDC[0].ht;
+			extDC[num].pitch = extDC[0].pitch;
+
 			extDC[num].curPos = extDC[0].curPos;
 			extDC[num].cursor = extDC[0].cursor;
 
@@ -1024,6 +1072,417 @@ HDC CreateExternalDC (int num)
 }
 
 
+/*==========================================================================}
+{					 RETAINED WINDOW COMPOSITOR ROUTINES					}
+{==========================================================================*/
+
+/*-[INTERNAL: IntersectRc]--------------------------------------------------}
+. Sets dst to the intersection of the two rectangles.
+. RETURN: true if the intersection is not empty
+.--------------------------------------------------------------------------*/
+static bool IntersectRc (RECT* dst, const RECT* a, const RECT* b)
+{
+	dst->left = (a->left > b->left) ? a->left : b->left;			// Larger left
+	dst->top = (a->top > b->top) ? a->top : b->top;					// Larger top
+	dst->right = (a->right < b->right) ? a->right : b->right;		// Smaller right
+	dst->bottom = (a->bottom < b->bottom) ? a->bottom : b->bottom;	// Smaller bottom
+	return ((dst->left < dst->right) && (dst->top < dst->bottom));
+}
+
+/*-[INTERNAL: AreaRc]-------------------------------------------------------}
+. Returns the pixel area of a correctly ordered rectangle.
+.--------------------------------------------------------------------------*/
+static uint32_t AreaRc (const RECT* r)
+{
+	return (uint32_t)(r->right - r->left) * (uint32_t)(r->bottom - r->top);
+}
+
+/*-[INTERNAL: UnionRc]------------------------------------------------------}
+. Sets dst to the smallest rectangle holding both rectangles.
+.--------------------------------------------------------------------------*/
+static void UnionRc (RECT* dst, const RECT* a, const RECT* b)
+{
+	dst->left = (a->left < b->left) ? a->left : b->left;			// Smaller left
+	dst->top = (a->top < b->top) ? a->top : b->top;					// Smaller top
+	dst->right = (a->right > b->right) ? a->right : b->right;		// Larger right
+	dst->bottom = (a->bottom > b->bottom) ? a->bottom : b->bottom;	// Larger bottom
+}
+
+/*-[INTERNAL: AddDamage]----------------------------------------------------}
+. Adds a screen rectangle to the damage list. Rectangles are merged with any
+. existing damage where the union wastes no more area than the two cover, so
+. a small window move becomes one rectangle. If the list is full the rect
+. merges with the entry it grows least.
+.--------------------------------------------------------------------------*/
+static void AddDamage (const RECT* r)
+{
+	RECT screen = { 0, 0, (int32_t)WINAPI_CB.wth, (int32_t)WINAPI_CB.ht };
+	RECT d;
+	if (!IntersectRc(&d, r, &screen)) return;						// Nothing on screen
+	bool merged;
+	do {
+		merged = false;
+		for (uint32_t i = 0; i < WNDMGR_CB.damageCount; i++) {
+			RECT u;
+			UnionRc(&u, &d, &WNDMGR_CB.damage[i]);					// Union with this entry
+			if (AreaRc(&u) <= AreaRc(&d) + AreaRc(&WNDMGR_CB.damage[i])) {
+				d = u;												// Take the merged rectangle
+				WNDMGR_CB.damage[i] = WNDMGR_CB.damage[--WNDMGR_CB.damageCount];// Remove entry
+				merged = true;										// Merged rect may now merge with others
+				break;
+			}
+		}
+	} while (merged);
+	if (WNDMGR_CB.damageCount == MAX_DAMAGE_RECTS) {				// Damage list full
+		uint32_t best = 0, bestGrow = 0xFFFFFFFF;
+		for (uint32_t i = 0; i < MAX_DAMAGE_RECTS; i++) {
+			RECT u;
+			UnionRc(&u, &d, &WNDMGR_CB.damage[i]);
+			uint32_t grow = AreaRc(&u) - AreaRc(&WNDMGR_CB.damage[i]);
+			if (grow < bestGrow) {									// Smallest growth so far
+				bestGrow = grow;
+				best = i;
+			}
+		}
+		UnionRc(&WNDMGR_CB.damage[best], &d, &WNDMGR_CB.damage[best]);
+	}
+	else WNDMGR_CB.damage[WNDMGR_CB.damageCount++] = d;				// Add as new entry
+}
+
+/*-[INTERNAL: WndFromHandle]------------------------------------------------}
+. Converts a window handle to the internal window checking it is valid.
+.--------------------------------------------------------------------------*/
+static INTWND* WndFromHandle (HWND hWnd)
+{
+	INTWND* w = (INTWND*)hWnd;
+	if ((w < &WNDMGR_CB.wnd[0]) || (w >= &WNDMGR_CB.wnd[MAX_WINDOWS])
+		|| (w->usedWnd == 0)) return 0;								// Not a live window
+	return w;
+}
+
+/*-[INTERNAL: AllocSurface]-------------------------------------------------}
+. First fit allocation in the surface pool. The live windows are the only
+. record of used space, a candidate offset is bumped past any window surface
+. it overlaps until a gap fits. The window being resized is excluded.
+. RETURN: offset in pool or 0xFFFFFFFF if no gap is large enough
+.--------------------------------------------------------------------------*/
+static uint32_t AllocSurface (uint32_t size, const INTWND* exclude)
+{
+	uint32_t ofs = 0;
+	size = (size + 15) & ~15u;										// Keep surfaces 16 byte aligned
+	bool moved;
+	do {
+		moved = false;
+		if (ofs + size > WND_SURFACE_POOL) return 0xFFFFFFFF;		// Pool exhausted
+		for (uint32_t i = 0; i < MAX_WINDOWS; i++) {
+			const INTWND* w = &WNDMGR_CB.wnd[i];
+			if ((w->usedWnd) && (w != exclude) &&
+				(w->poolOfs < ofs + size) && (ofs < w->poolOfs + w->poolSize)) {
+				ofs = w->poolOfs + w->poolSize;						// Move past this surface
+				moved = true;
+			}
+		}
+	} while (moved);
+	return ofs;
+}
+
+/*-[INTERNAL: SetupWindowSurface]-------------------------------------------}
+. Allocates the window surface and sets the window DC to draw on it. The DC
+. takes the console DC colours and the surface is cleared in brush colour.
+.--------------------------------------------------------------------------*/
+static bool SetupWindowSurface (INTWND* w, uint32_t cx, uint32_t cy)
+{
+	uint32_t size = cx * cy * (WINAPI_CB.depth >> 3);				// Surface size in bytes
+	uint32_t ofs = AllocSurface(size, w);
+	if (ofs == 0xFFFFFFFF) return false;							// No room in pool
+	w->poolOfs = ofs;
+	w->poolSize = (size + 15) & ~15u;
+	w->dc = extDC[0];												// Take console DC colours and modes
+	w->dc.fb = (uintptr_t)&surfacePool[ofs];						// DC draws on the surface
+	w->dc.wth = cx;
+	w->dc.ht = cy;
+	w->dc.pitch = cx;												// Surface lines are packed
+	w->dc.curPos.x = 0;
+	w->dc.curPos.y = 0;
+	w->dc.bmp = 0;
+	WINAPI_CB.ClearArea(&w->dc, 0, 0, cx, cy);						// Clear surface to brush colour
+	return true;
+}
+
+/*-[INTERNAL: BlitWindowRect]-----------------------------------------------}
+. Copies the screen rectangle r from the window surface to the screen. The
+. rectangle must lie within both the window and the screen.
+.--------------------------------------------------------------------------*/
+static void BlitWindowRect (const INTWND* w, const RECT* r)
+{
+	uint32_t bpp = WINAPI_CB.depth >> 3;							// Bytes per pixel
+	uint32_t len = (r->right - r->left) * bpp;						// Bytes per line
+	uint8_t* src = (uint8_t*)w->dc.fb + ((r->top - w->rc.top) * w->dc.pitch + (r->left - w->rc.left)) * bpp;
+	uint8_t* dst = (uint8_t*)WINAPI_CB.fb + (r->top * WINAPI_CB.pitch + r->left) * bpp;
+	for (int32_t y = r->top; y < r->bottom; y++) {					// For each line
+		memcpy(dst, src, len);										// Copy the line
+		src += w->dc.pitch * bpp;									// Next surface line
+		dst += WINAPI_CB.pitch * bpp;								// Next screen line
+	}
+}
+
+/*-[INTERNAL: PaintRectBottomUp]--------------------------------------------}
+. Painters fallback for when a damage rect fragments past the work list.
+. Desktop fill then every window bottom up clipped to the rect.
+.--------------------------------------------------------------------------*/
+static uint32_t PaintRectBottomUp (const RECT* d)
+{
+	uint32_t pixels = AreaRc(d);
+	WINAPI_CB.ClearArea(&WNDMGR_CB.deskDC, d->left, d->top, d->right, d->bottom);
+	for (uint32_t z = 0; z < WNDMGR_CB.count; z++) {
+		INTWND* w = &WNDMGR_CB.wnd[WNDMGR_CB.zOrder[z]];
+		RECT c;
+		if ((w->visible) && IntersectRc(&c, d, &w->rc)) {
+			BlitWindowRect(w, &c);									// Blit window part in rect
+			pixels += AreaRc(&c);
+		}
+	}
+	return pixels;
+}
+
+/*-[INTERNAL: ComposeRect]--------------------------------------------------}
+. Composes one damage rectangle front to back. The rect starts as the only
+. uncovered fragment, each window from the top blits its overlap with every
+. uncovered fragment and the fragment is replaced by the up to 4 pieces the
+. window does not cover. Once nothing is uncovered the walk stops so windows
+. underneath are culled. Left over fragments get the desktop colour.
+. RETURN: Number of screen pixels written
+.--------------------------------------------------------------------------*/
+static uint32_t ComposeRect (const RECT* d)
+{
+	uint32_t pixels = 0;
+	uint32_t n = 1;
+	visRect[0] = *d;												// Whole rect starts uncovered
+	for (int z = WNDMGR_CB.count - 1; (z >= 0) && (n > 0); z--) {	// Top of z-order down
+		INTWND* w = &WNDMGR_CB.wnd[WNDMGR_CB.zOrder[z]];
+		RECT c;
+		if ((w->visible == 0) || !IntersectRc(&c, d, &w->rc)) continue;// Window misses the damage
+		for (uint32_t i = 0; i < n; ) {
+			RECT u = visRect[i];
+			if (!IntersectRc(&c, &u, &w->rc)) {						// Window misses this fragment
+				i++;
+				continue;
+			}
+			if (n + 3 > MAX_VISIBLE_RECTS)							// Could overflow the work list
+				return PaintRectBottomUp(d);						// Fall back to painting it all
+			BlitWindowRect(w, &c);									// Window shows in this part
+			pixels += AreaRc(&c);
+			visRect[i] = visRect[--n];								// Remove fragment, recheck slot i
+			if (u.top < c.top) visRect[n++] = (RECT){ u.left, u.top, u.right, c.top };
+			if (c.bottom < u.bottom) visRect[n++] = (RECT){ u.left, c.bottom, u.right, u.bottom };
+			if (u.left < c.left) visRect[n++] = (RECT){ u.left, c.top, c.left, c.bottom };
+			if (c.right < u.right) visRect[n++] = (RECT){ c.right, c.top, u.right, c.bottom };
+		}
+	}
+	for (uint32_t i = 0; i < n; i++) {								// Anything left is desktop
+		WINAPI_CB.ClearArea(&WNDMGR_CB.deskDC, visRect[i].left, visRect[i].top,
+			visRect[i].right, visRect[i].bottom);
+		pixels += AreaRc(&visRect[i]);
+	}
+	return pixels;
+}
+
+/*-[CreateWindowSurface]----------------------------------------------------}
+. Creates a window at the given screen position with its own cached surface
+. in the screen colour depth. The window goes on top of the z-order, the
+. surface is cleared to the current console brush colour and its area is
+. marked damaged so the next ComposeDesktop shows it.
+. RETURN: Handle to the window or 0 if no window slot or surface memory
+.--------------------------------------------------------------------------*/
+HWND CreateWindowSurface (int X,									// Left x screen position of window
+						  int Y,									// Top y screen position of window
+						  int nWidth,								// Width of window
+						  int nHeight)								// Height of window
+{
+	if ((WINAPI_CB.fb == 0) || (nWidth <= 0) || (nHeight <= 0)) return 0;
+	for (uint32_t i = 0; i < MAX_WINDOWS; i++) {
+		INTWND* w = &WNDMGR_CB.wnd[i];
+		if (w->usedWnd == 0) {										// Free window slot
+			if (!SetupWindowSurface(w, nWidth, nHeight)) return 0;	// No surface memory
+			w->rc = (RECT){ X, Y, X + nWidth, Y + nHeight };		// Screen position
+			w->usedWnd = 1;
+			w->visible = 1;
+			WNDMGR_CB.zOrder[WNDMGR_CB.count++] = i;				// On top of z-order
+			AddDamage(&w->rc);										// Show it next compose
+			return (HWND)w;
+		}
+	}
+	return 0;														// No free window slot
+}
+
+/*-[DestroyWindow]----------------------------------------------------------}
+. Matches WIN32 API, Destroys the window and releases its surface. The area
+. it covered is damaged so the windows below are exposed on next compose.
+.--------------------------------------------------------------------------*/
+BOOL DestroyWindow (HWND hWnd)										// Handle to the window
+{
+	INTWND* w = WndFromHandle(hWnd);
+	if (w == 0) return FALSE;										// Invalid window
+	uint16_t idx = (uint16_t)(w - &WNDMGR_CB.wnd[0]);
+	uint32_t j = 0;
+	for (uint32_t z = 0; z < WNDMGR_CB.count; z++)					// Remove from z-order
+		if (WNDMGR_CB.zOrder[z] != idx) WNDMGR_CB.zOrder[j++] = WNDMGR_CB.zOrder[z];
+	WNDMGR_CB.count = j;
+	if (w->visible) AddDamage(&w->rc);								// Expose what was below
+	w->usedWnd = 0;													// Slot and surface are free
+	w->poolSize = 0;
+	return TRUE;
+}
+
+/*-[GetDC]------------------------------------------------------------------}
+. Matches WIN32 API, Returns the DC which draws on the window surface with
+. co-ordinates relative to the window. Drawing does not reach the screen
+. until the drawn area is invalidated and ComposeDesktop is called.
+.--------------------------------------------------------------------------*/
+HDC GetDC (HWND hWnd)												// Handle to the window
+{
+	INTWND* w = WndFromHandle(hWnd);
+	return (w) ? (HDC)&w->dc : 0;									// Window surface DC
+}
+
+/*-[MoveWindow]-------------------------------------------------------------}
+. Matches WIN32 API, Changes the position and size of the window. If the
+. size changes the surface is reallocated and cleared. If bRepaint is set
+. the old and new areas are damaged for the next compose.
+.--------------------------------------------------------------------------*/
+BOOL MoveWindow (HWND hWnd,											// Handle to the window
+				 int X,												// New left x screen position
+				 int Y,												// New top y screen position
+				 int nWidth,										// New width of window
+				 int nHeight,										// New height of window
+				 BOOL bRepaint)										// Damage old and new areas
+{
+	INTWND* w = WndFromHandle(hWnd);
+	if ((w == 0) || (nWidth <= 0) || (nHeight <= 0)) return FALSE;
+	RECT old = w->rc;
+	if ((nWidth != old.right - old.left) || (nHeight != old.bottom - old.top)) {
+		INTDC hold = w->dc;											// Hold DC colours and modes
+		if (!SetupWindowSurface(w, nWidth, nHeight)) return FALSE;	// No room for new size
+		hold.fb = w->dc.fb;											// Restore DC settings on new surface
+		hold.wth = w->dc.wth;
+		hold.ht = w->dc.ht;
+		hold.pitch = w->dc.pitch;
+		w->dc = hold;
+	}
+	w->rc = (RECT){ X, Y, X + nWidth, Y + nHeight };				// New screen position
+	if ((bRepaint) && (w->visible)) {
+		AddDamage(&old);											// Expose area left behind
+		AddDamage(&w->rc);											// Show window at new area
+	}
+	return TRUE;
+}
+
+/*-[BringWindowToTop]-------------------------------------------------------}
+. Matches WIN32 API, Moves the window to the top of the z-order.
+.--------------------------------------------------------------------------*/
+BOOL BringWindowToTop (HWND hWnd)									// Handle to the window
+{
+	INTWND* w = WndFromHandle(hWnd);
+	if (w == 0) return FALSE;										// Invalid window
+	uint16_t idx = (uint16_t)(w - &WNDMGR_CB.wnd[0]);
+	uint32_t j = 0;
+	for (uint32_t z = 0; z < WNDMGR_CB.count; z++)					// Remove from current z position
+		if (WNDMGR_CB.zOrder[z] != idx) WNDMGR_CB.zOrder[j++] = WNDMGR_CB.zOrder[z];
+	WNDMGR_CB.zOrder[j] = idx;										// Put back on top
+	if (w->visible) AddDamage(&w->rc);								// May now cover others
+	return TRUE;
+}
+
+/*-[ShowWindow]-------------------------------------------------------------}
+. Matches WIN32 API, Shows or hides the window with SW_SHOW or SW_HIDE.
+. RETURN: Non zero if the window was previously visible, zero if hidden
+.--------------------------------------------------------------------------*/
+BOOL ShowWindow (HWND hWnd,											// Handle to the window
+				 int nCmdShow)										// SW_SHOW or SW_HIDE
+{
+	INTWND* w = WndFromHandle(hWnd);
+	if (w == 0) return FALSE;										// Invalid window
+	BOOL wasVisible = w->visible;
+	w->visible = (nCmdShow == SW_HIDE) ? 0 : 1;						// Set new visibility
+	if (wasVisible != (BOOL)w->visible) AddDamage(&w->rc);			// Area changes on next compose
+	return wasVisible;
+}
+
+/*-[InvalidateRect]---------------------------------------------------------}
+. Matches WIN32 API, Marks the window relative rectangle as damaged after
+. drawing to the window DC. A null rect damages the whole window and a null
+. window damages the whole screen. bErase is ignored as surfaces retain.
+.--------------------------------------------------------------------------*/
+BOOL InvalidateRect (HWND hWnd,										// Handle to the window (0 means whole screen)
+					 const RECT* lpRect,							// Window relative rect (0 means whole window)
+					 BOOL bErase)									// Ignored
+{
+	(void)bErase;
+	if (hWnd == 0) {												// Whole screen
+		RECT screen = { 0, 0, (int32_t)WINAPI_CB.wth, (int32_t)WINAPI_CB.ht };
+		WNDMGR_CB.damageCount = 0;									// Full screen covers all damage
+		AddDamage(&screen);
+		return TRUE;
+	}
+	INTWND* w = WndFromHandle(hWnd);
+	if (w == 0) return FALSE;										// Invalid window
+	if (w->visible == 0) return TRUE;								// Hidden so nothing to show
+	if (lpRect) {
+		RECT r = { lpRect->left + w->rc.left, lpRect->top + w->rc.top,
+			lpRect->right + w->rc.left, lpRect->bottom + w->rc.top };// Window to screen co-ordinates
+		RECT c;
+		if (IntersectRc(&c, &r, &w->rc)) AddDamage(&c);				// Damage part within window
+	}
+	else AddDamage(&w->rc);											// Damage whole window
+	return TRUE;
+}
+
+/*-[GetWindowRect]----------------------------------------------------------}
+. Matches WIN32 API, Returns the screen rectangle the window occupies.
+.--------------------------------------------------------------------------*/
+BOOL GetWindowRect (HWND hWnd,										// Handle to the window
+					LPRECT lpRect)									// Pointer to return rectangle in
+{
+	INTWND* w = WndFromHandle(hWnd);
+	if ((w == 0) || (lpRect == 0)) return FALSE;					// Invalid window or pointer
+	*lpRect = w->rc;												// Return window rectangle
+	return TRUE;
+}
+
+/*-[SetDesktopColor]--------------------------------------------------------}
+. Sets the colour shown where no window covers the screen and damages the
+. whole screen so the new colour is drawn on the next compose.
+. RETURN: The previous desktop colour
+.--------------------------------------------------------------------------*/
+COLORREF SetDesktopColor (COLORREF crColor)							// The new desktop colour
+{
+	COLORREF retValue = SetDCBrushColor((HDC)&WNDMGR_CB.deskDC, crColor);
+	InvalidateRect(0, 0, FALSE);									// Redraw whole desktop
+	return retValue;
+}
+
+/*-[ComposeDesktop]---------------------------------------------------------}
+. Recomposes the damaged screen areas. Windows are walked from the top of
+. the z-order down and each only blits the part of a damaged area not yet
+. covered by a window above, so hidden windows cost nothing. Any area left
+. uncovered is filled with the desktop colour. The damage list is cleared.
+. RETURN: Number of screen pixels written
+.--------------------------------------------------------------------------*/
+uint32_t ComposeDesktop (void)
+{
+	uint32_t pixels = 0;
+	if (WINAPI_CB.fb == 0) return 0;								// Screen not initialized
+	WNDMGR_CB.deskDC.fb = WINAPI_CB.fb;								// Desktop DC draws on the screen
+	WNDMGR_CB.deskDC.wth = WINAPI_CB.wth;
+	WNDMGR_CB.deskDC.ht = WINAPI_CB.ht;
+	WNDMGR_CB.deskDC.pitch = WINAPI_CB.pitch;
+	for (uint32_t i = 0; i < WNDMGR_CB.damageCount; i++)
+		pixels += ComposeRect(&WNDMGR_CB.damage[i]);				// Compose each damage rect
+	WNDMGR_CB.damageCount = 0;										// All damage repaired
+	return pixels;
+}
+
+
 /*==========================================================================}
 {						SCREEN RESOLUTION API								}
 {==========================================================================*/
@@ -43,6 +43,7 @@ typedef uint32_t	COLORREF;					// COLORREF is a uint32_t
 typedef uintptr_t	HDC;						// HDC is really a pointer
 typedef uintptr_t	HANDLE;						// HANDLE is really a pointer
 typedef uintptr_t	HINSTANCE;					// HINSTANCE is really a pointer
+typedef uintptr_t	HWND;						// HWND is really a pointer
 typedef uint32_t	UINT;						// UINT is an unsigned 32bit int
 typedef char*		LPCSTR;						// LPCSTR is a char pointer
 
@@ -58,6 +59,12 @@ typedef char*		LPCSTR;						// LPCSTR is a char pointer
 #define TRANSPARENT	1
 #define OPAQUE		2
 
+/*--------------------------------------------------------------------------}
+;{				  ENUMERATED SHOW WINDOW MODES AS PER WIN32 API				}
+;{-------------------------------------------------------------------------*/
+#define SW_HIDE		0
+#define SW_SHOW		5
+
 /***************************************************************************}
 {		 	        PUBLIC GRAPHICS STRUCTURE DEFINITIONS					}
 ****************************************************************************/
@@ -107,6 +114,17 @@ typedef struct __attribute__((__packed__))
 	int32_t y;											// y co-ordinate
 } POINT, * LPPOINT;										// Typedef define POINT and LPPOINT
 
+/*--------------------------------------------------------------------------}
+{						 RECT STRUCTURE DEFINITION							}
+{--------------------------------------------------------------------------*/
+typedef struct __attribute__((__packed__))
+{
+	int32_t left;										// Left x co-ordinate
+	int32_t top;										// Top y co-ordinate
+	int32_t right;										// Right x co-ordinate (not included)
+	int32_t bottom;										// Bottom y co-ordinate (not included)
+} RECT, * LPRECT;										// Typedef define RECT and LPRECT
+
 
 /*--------------------------------------------------------------------------}
 {						DIFFERENT IMAGE POINTER UNION						}
@@ -321,6 +339,90 @@ HGDIOBJ SelectObject(HDC hdc,										// Handle to the DC (0 means use standard
 {==========================================================================*/
 HDC CreateExternalDC (int num);
 
+/*==========================================================================}
+{					 RETAINED WINDOW COMPOSITOR ROUTINES					}
+{==========================================================================*/
+
+/*-[CreateWindowSurface]----------------------------------------------------}
+. Creates a window at the given screen position with its own cached surface
+. in the screen colour depth. The window goes on top of the z-order, the
+. surface is cleared to the current console brush colour and its area is
+. marked damaged so the next ComposeDesktop shows it.
+. RETURN: Handle to the window or 0 if no window slot or surface memory
+.--------------------------------------------------------------------------*/
+HWND CreateWindowSurface (int X,									// Left x screen position of window
+						  int Y,									// Top y screen position of window
+						  int nWidth,								// Width of window
+						  int nHeight);								// Height of window
+
+/*-[DestroyWindow]----------------------------------------------------------}
+. Matches WIN32 API, Destroys the window and releases its surface. The area
+. it covered is damaged so the windows below are exposed on next compose.
+.--------------------------------------------------------------------------*/
+BOOL DestroyWindow (HWND hWnd);										// Handle to the window
+
+/*-[GetDC]------------------------------------------------------------------}
+. Matches WIN32 API, Returns the DC which draws on the window surface with
+. co-ordinates relative to the window. Drawing does not reach the screen
+. until the drawn area is invalidated and ComposeDesktop is called.
+.--------------------------------------------------------------------------*/
+HDC GetDC (HWND hWnd);												// Handle to the window
+
+/*-[MoveWindow]-------------------------------------------------------------}
+. Matches WIN32 API, Changes the position and size of the window. If the
+. size changes the surface is reallocated and cleared. If bRepaint is set
+. the old and new areas are damaged for the next compose.
+.--------------------------------------------------------------------------*/
+BOOL MoveWindow (HWND hWnd,											// Handle to the window
+				 int X,												// New left x screen position
+				 int Y,												// New top y screen position
+				 int nWidth,										// New width of window
+				 int nHeight,										// New height of window
+				 BOOL bRepaint);									// Damage old and new areas
+
+/*-[BringWindowToTop]-------------------------------------------------------}
+. Matches WIN32 API, Moves the window to the top of the z-order.
+.--------------------------------------------------------------------------*/
+BOOL BringWindowToTop (HWND hWnd);									// Handle to the window
+
+/*-[ShowWindow]-------------------------------------------------------------}
+. Matches WIN32 API, Shows or hides the window with SW_SHOW or SW_HIDE.
+. RETURN: Non zero if the window was previously visible, zero if hidden
+.--------------------------------------------------------------------------*/
+BOOL ShowWindow (HWND hWnd,											// Handle to the window
+				 int nCmdShow);										// SW_SHOW or SW_HIDE
+
+/*-[InvalidateRect]---------------------------------------------------------}
+. Matches WIN32 API, Marks the window relative rectangle as damaged after
+. drawing to the window DC. A null rect damages the whole window and a null
+. window damages the whole screen. bErase is ignored as surfaces retain.
+.--------------------------------------------------------------------------*/
+BOOL InvalidateRect (HWND hWnd,										// Handle to the window (0 means whole screen)
+					 const RECT* lpRect,							// Window relative rect (0 means whole window)
+					 BOOL bErase);									// Ignored
+
+/*-[GetWindowRect]----------------------------------------------------------}
+. Matches WIN32 API, Returns the screen rectangle the window occupies.
+.--------------------------------------------------------------------------*/
+BOOL GetWindowRect (HWND hWnd,										// Handle to the window
+					LPRECT lpRect);									// Pointer to return rectangle in
+
+/*-[SetDesktopColor]--------------------------------------------------------}
+. Sets the colour shown where no window covers the screen and damages the
+. whole screen so the new colour is drawn on the next compose.
+. RETURN: The previous desktop colour
+.--------------------------------------------------------------------------*/
+COLORREF SetDesktopColor (COLORREF crColor);						// The new desktop colour
+
+/*-[ComposeDesktop]---------------------------------------------------------}
+. Recomposes the damaged screen areas. Windows are walked from the top of
+. the z-order down and each only blits the part of a damaged area not yet
+. covered by a window above, so hidden windows cost nothing. Any area left
+. uncovered is filled with the desktop colour. The damage list is cleared.
+. RETURN: Number of screen pixels written
+.--------------------------------------------------------------------------*/
+uint32_t ComposeDesktop (void);
+
 
 /*==========================================================================}
 {						SCREEN RESOLUTION API								}
@@ -0,0 +1,337 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for malloc
+#include <string.h>								// Needed for memset, memcmp
+#include <time.h>								// Needed for clock_gettime
+#include "rpi-QPUKernels.h"						// QPU kernel library under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: ComputeCheck.c											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check of rpi-QPUKernels.                                            }
+{                                                                           }
+{  Checks: every kernel's code has its branches inside the code and ends   }
+{  with the host interrupt, thrend and 2 delay slots. The RGB to YUV       }
+{  reference gives the BT.601 values of known colours. For 1 to 12 QPUs    }
+{  the uniform streams split the work with nothing missed, nothing done    }
+{  twice and nothing outside the buffers touched, checked by running each  }
+{  stream through QPU_KernelModel in a pretend VC4 address space and       }
+{  comparing with the reference over the whole buffer.                     }
+{                                                                           }
+{  Then the speed of the ARM references is measured, the figures the Pi    }
+{  demo's QPU times are set against.                                       }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define BENCH_MIN_NS	200000000ull			// Each kernel runs at least this long
+#define FAKE_VC4		0x40000000u				// Pretend VC4 address of the memory
+#define MEM_WORDS		(1 << 20)				// Pretend GPU memory (4MB)
+#define GUARD			0xDEADBEEFu				// Fill of memory nothing should write
+
+static int failures = 0;
+static uint32_t* mem = NULL;					// The pretend GPU memory
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void Check (bool ok, const char* what)
+{
+	printf("  %-60s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok) failures++;
+}
+
+static uint32_t rng = 12345;
+static uint32_t Random (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return rng;
+}
+
+static float RandomFloat (void)
+{
+	return (float)(Random() >> 8) / (float)(1 << 24) * 2.0f - 1.0f;	// -1 to 1
+}
+
+static void* FakeToPtr (uint32_t vc4Addr)
+{
+	return &mem[(vc4Addr - FAKE_VC4) / 4];
+}
+
+static uint32_t FakeVC4 (const void* p)
+{
+	return FAKE_VC4 + (uint32_t)((const uint32_t*)p - mem) * 4;
+}
+
+/*--------------------------------------------------------------------------}
+{ Branches land inside the code and it ends host_int, thrend, nop, nop.     }
+{--------------------------------------------------------------------------*/
+static bool CodeGood (const QPU_KERNEL* k)
+{
+	uint32_t n = k->codeWords / 2;
+	if ((k->codeWords & 1) || (n < 4)) return false;
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t hi = k->code[i * 2 + 1];
+		if ((hi >> 28) == 15) {										// Branch, relative to 4 on in bytes
+			int32_t target = (int32_t)(i + 4) + (int32_t)k->code[i * 2] / 8;
+			if ((target < 0) || (target >= (int32_t)(n - 4))) return false;
+		} else if (((hi >> 28) == 3) && (i != n - 3)) return false;	// Only the one thrend
+	}
+	uint32_t hostInt = k->code[(n - 4) * 2 + 1];
+	return ((k->code[(n - 3) * 2 + 1] >> 28) == 3)					// thrend
+		&& (((hostInt >> 6) & 63) == 38);							// add writes host_int
+}
+
+static bool YuvKnown (void)
+{
+	static const uint32_t rgb[5] = { 0xFFFFFFFF, 0xFF000000, 0xFF0000FF, 0xFF00FF00, 0x80FF0000 };
+	static const uint32_t yuv[5] = { 0xFF8080EB, 0xFF808010, 0xFFF05A52, 0xFF223690, 0x806EF029 };
+	uint32_t out[5];
+	QPU_RefRgbToYuv(out, rgb, 5);
+	return (memcmp(out, yuv, sizeof(out)) == 0);
+}
+
+/*--------------------------------------------------------------------------}
+{ Runs the qpus streams in unif through the C model.                        }
+{--------------------------------------------------------------------------*/
+static void RunStreams (const QPU_KERNEL* k, const uint32_t* unif, uint32_t qpus)
+{
+	for (uint32_t i = 0; i < qpus; i++)
+		QPU_KernelModel(k, &unif[i * k->uniforms], FakeToPtr);
+}
+
+/*--------------------------------------------------------------------------}
+{ Memory is laid out src (srcWords), dst (dstWords) then a guard of 64     }
+{ words. The model runs the streams for each count of QPUs and dst must    }
+{ match expect with src and the guard untouched.                            }
+{--------------------------------------------------------------------------*/
+static uint32_t* src;
+static uint32_t* dst;
+static uint32_t srcWords, dstWords;
+
+static void Layout (uint32_t srcCount, uint32_t dstCount)
+{
+	srcWords = srcCount;
+	dstWords = dstCount;
+	src = mem;
+	dst = mem + srcWords;
+	for (uint32_t i = 0; i < srcWords; i++) src[i] = Random();
+	for (uint32_t i = 0; i < dstWords + 64; i++) dst[i] = GUARD;
+}
+
+static bool GuardGood (const uint32_t* srcCopy)
+{
+	for (uint32_t i = 0; i < 64; i++)
+		if (dst[dstWords + i] != GUARD) return false;
+	return (memcmp(src, srcCopy, srcWords * 4) == 0);
+}
+
+typedef uint32_t (*MAKE_STREAMS) (uint32_t* unif, uint32_t qpus);
+
+static bool SplitGood (const QPU_KERNEL* k, MAKE_STREAMS make, const uint32_t* expect, const uint32_t* dstStart)
+{
+	static uint32_t unif[QPU_MAX * 16];
+	uint32_t* srcCopy = malloc(srcWords * 4);
+	uint32_t* dstCopy = malloc(dstWords * 4);
+	memcpy(srcCopy, src, srcWords * 4);
+	memcpy(dstCopy, dstStart, dstWords * 4);						// y of SAXPY is read too
+	bool ok = true;
+	for (uint32_t qpus = 1; (qpus <= QPU_MAX) && ok; qpus++) {
+		memcpy(dst, dstCopy, dstWords * 4);
+		uint32_t used = make(unif, qpus);
+		RunStreams(k, unif, used);
+		ok = (used > 0) && (used <= qpus) && (memcmp(dst, expect, dstWords * 4) == 0) && GuardGood(srcCopy);
+	}
+	free(srcCopy);
+	free(dstCopy);
+	return ok;
+}
+
+static uint32_t count, width, height;
+static float a;
+static float w[9];
+
+static uint32_t MemsetStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_MemsetUniforms(unif, qpus, FakeVC4(dst), 0x12345678, count);
+}
+
+static uint32_t MemcpyStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_MemcpyUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), count);
+}
+
+static uint32_t SaxpyStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_SaxpyUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), a, count);
+}
+
+static uint32_t ConvStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_Conv3x3Uniforms(unif, qpus, FakeVC4(dst), width, FakeVC4(src), width + 2, width, height, w);
+}
+
+static uint32_t YuvStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_RgbToYuvUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), count);
+}
+
+static bool MemsetGood (uint32_t words)
+{
+	count = words;
+	Layout(16, words);
+	uint32_t* expect = malloc(words * 4);
+	for (uint32_t i = 0; i < words; i++) expect[i] = 0x12345678;
+	bool ok = SplitGood(&QPU_KernelMemset, MemsetStreams, expect, dst);
+	free(expect);
+	return ok;
+}
+
+static bool MemcpyGood (uint32_t words)
+{
+	count = words;
+	Layout(words, words);
+	bool ok = SplitGood(&QPU_KernelMemcpy, MemcpyStreams, src, dst);
+	return ok;
+}
+
+static bool SaxpyGood (uint32_t floats)
+{
+	count = floats;
+	a = RandomFloat();
+	Layout(floats, floats);
+	float* x = (float*)src;
+	float* y = (float*)dst;
+	for (uint32_t i = 0; i < floats; i++) {
+		x[i] = RandomFloat();
+		y[i] = RandomFloat();
+	}
+	float* expect = malloc(floats * 4);
+	memcpy(expect, y, floats * 4);
+	QPU_RefSaxpy(expect, x, a, floats);
+	bool ok = SplitGood(&QPU_KernelSaxpy, SaxpyStreams, (uint32_t*)expect, dst);
+	free(expect);
+	return ok;
+}
+
+static bool ConvGood (uint32_t wth, uint32_t ht)
+{
+	width = wth;
+	height = ht;
+	for (int j = 0; j < 9; j++) w[j] = RandomFloat();
+	Layout((wth + 2) * (ht + 2), wth * ht);
+	float* in = (float*)src;
+	for (uint32_t i = 0; i < srcWords; i++) in[i] = RandomFloat();
+	float* expect = malloc(wth * ht * 4);
+	QPU_RefConv3x3(expect, wth, in, wth + 2, wth, ht, w);
+	bool ok = true;
+	for (uint32_t y = 0; y < ht; y++)								// Against a double sum
+		for (uint32_t x = 0; x < wth; x++) {
+			double sum = 0.0;
+			for (int j = 0; j < 3; j++)
+				for (int i = 0; i < 3; i++)
+					sum += (double)in[(y + j) * (wth + 2) + x + i] * w[j * 3 + i];
+			double d = sum - expect[y * wth + x];
+			if ((d > 1e-5) || (d < -1e-5)) ok = false;
+		}
+	ok = ok && SplitGood(&QPU_KernelConv3x3, ConvStreams, (uint32_t*)expect, dst);
+	free(expect);
+	return ok;
+}
+
+static bool YuvGood (uint32_t pixels)
+{
+	count = pixels;
+	Layout(pixels, pixels);
+	uint32_t* expect = malloc(pixels * 4);
+	QPU_RefRgbToYuv(expect, src, pixels);
+	bool ok = SplitGood(&QPU_KernelRgbToYuv, YuvStreams, expect, dst);
+	free(expect);
+	return ok;
+}
+
+/*--------------------------------------------------------------------------}
+{ Times one stream of the whole job through the model (the ARM reference)   }
+{ and reports MB/s of output.                                               }
+{--------------------------------------------------------------------------*/
+static void Bench (const QPU_KERNEL* k, MAKE_STREAMS make, uint32_t outWords)
+{
+	uint32_t unif[16];
+	make(unif, 1);
+	uint64_t start = NowNs(), ns;
+	uint32_t runs = 0;
+	do {
+		QPU_KernelModel(k, unif, FakeToPtr);
+		runs++;
+		ns = NowNs() - start;
+	} while (ns < BENCH_MIN_NS);
+	double us = (double)ns / runs / 1000.0;
+	printf("  %-8s %7u words  %9.1f us  %7.1f MB/s\n", k->name, (unsigned)outWords, us, outWords * 4.0 / us);
+}
+
+int main (void)
+{
+	mem = malloc(MEM_WORDS * 4);
+	if (!mem) return 1;
+	printf("Code\n");
+	Check(CodeGood(&QPU_KernelMemset), "memset branches and ending");
+	Check(CodeGood(&QPU_KernelMemcpy), "memcpy branches and ending");
+	Check(CodeGood(&QPU_KernelSaxpy), "saxpy branches and ending");
+	Check(CodeGood(&QPU_KernelConv3x3), "conv3x3 branches and ending");
+	Check(CodeGood(&QPU_KernelRgbToYuv), "rgb2yuv branches and ending");
+
+	printf("References\n");
+	Check(YuvKnown(), "RGB to YUV of white, black, red, green and blue");
+
+	printf("Uniform streams on 1 to 12 QPUs\n");
+	Check(MemsetGood(16 * 1000), "memset 16000 words");
+	Check(MemsetGood(16 * 5), "memset 80 words (fewer blocks than QPUs)");
+	Check(MemcpyGood(16 * 4099), "memcpy 65584 words");
+	Check(SaxpyGood(16 * 777), "saxpy 12432 floats");
+	Check(ConvGood(64, 45), "conv3x3 64x45");
+	Check(ConvGood(16, 3), "conv3x3 16x3 (fewer rows than QPUs)");
+	Check(YuvGood(16 * 2000), "rgb2yuv 32000 pixels");
+	uint32_t unif[QPU_MAX * 16];
+	Check(!QPU_MemcpyUniforms(unif, 4, 0, 0, 17) && !QPU_Conv3x3Uniforms(unif, 4, 0, 16, 0, 18, 20, 4, w)
+		&& !QPU_SaxpyUniforms(unif, 0, 0, 0, 1.0f, 16), "Part blocks and 0 QPUs refused");
+
+	printf("ARM reference speed (one thread)\n");
+	count = 1 << 18;
+	Layout(count, count);
+	Bench(&QPU_KernelMemset, MemsetStreams, count);
+	Bench(&QPU_KernelMemcpy, MemcpyStreams, count);
+	for (uint32_t i = 0; i < 2 * count; i++) mem[i] = 0;			// Keep the floats tame
+	Bench(&QPU_KernelSaxpy, SaxpyStreams, count);
+	width = 512;
+	height = 480;
+	Layout((width + 2) * (height + 2), width * height);
+	for (uint32_t i = 0; i < srcWords; i++) ((float*)src)[i] = 0.5f;
+	Bench(&QPU_KernelConv3x3, ConvStreams, width * height);
+	count = 1 << 18;
+	Layout(count, count);
+	Bench(&QPU_KernelRgbToYuv, YuvStreams, count);
+
+	free(mem);
+	printf("\n%s\n", failures ? "COMPUTE CHECK FAILED" : "All compute checks good");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,282 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf, fopen
+#include <stdlib.h>								// Needed for malloc
+#include <string.h>								// Needed for memcpy, memset
+#include <time.h>								// Needed for clock_gettime
+#include "rpi-Math3D.h"							// Screen matrix as DoRotate builds it
+#include "rpi-V3DList.h"						// Binning lists as EmitFrameLists writes them
+#include "rpi-SoftRaster.h"						// Renders the lists
+#include "rpi-MeshFile.h"						// Models on the SD card image
+#include "rpi-Cull.h"							// Culling under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: CullCheck.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check of rpi-Cull on the .msh models. Each model is loaded and      }
+{  scaled as CreateVertexData does it and turned through VIEWS rotations    }
+{  of the GLES2_Model view, off centre so part of it leaves the screen. For }
+{  every view the binning list is written as EmitFrameLists/EmitPrimitives  }
+{  do, once whole and once with the runs Cull_Visible leaves, and both are  }
+{  drawn by rpi-SoftRaster with the depth test, shaded by depth like the    }
+{  QPU vertex shader so a wrongly culled front face shows.                  }
+{                                                                           }
+{  Checks: the culled image is pixel for pixel the unculled one. Reported:  }
+{  triangles submitted against the mesh, clusters dropped off screen and    }
+{  back facing, and the software render time of both.                      }
+{                                                                           }
+{  Usage: CullCheck model.msh ...                                           }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define SCREEN_WTH		1280
+#define SCREEN_HT		720
+#define MODEL_SIZE		400.0f					// desiredMaxSize Main.c loads pitts with
+#define VIEWS			36						// Rotations checked, 10 degrees apart
+
+#define GPU_VC4			0x1E000000u				// Fake VC4 address of the fake GPU memory
+#define GPU_SIZE		0x1000000u				// 16MB of it
+static uint8_t* gpuMem;							// Host memory standing in for GPU memory
+static uint32_t gpuUsed;
+
+static void* ToARM (uint32_t vc4)
+{
+	return &gpuMem[vc4 - GPU_VC4];
+}
+
+static uint32_t GpuAlloc (uint32_t size)
+{
+	uint32_t addr = GPU_VC4 + ((gpuUsed + 15) & ~15u);
+	gpuUsed = addr - GPU_VC4 + size;
+	return (gpuUsed <= GPU_SIZE) ? addr : 0;
+}
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* A model loaded into fake GPU memory as the Pi code leaves it */
+typedef struct model {
+	float* positions;							// x,y,z scaled and centred (original vertexes)
+	uint32_t vertexCount;
+	uint32_t indexVC4, indexCount;				// 16 bit triangle indexes
+	uint32_t vertexVC4;							// SOFT_VERTEX emit vertexes
+	uint32_t recordVC4;							// NV shader record
+	uint32_t binStart, binSize;					// Binning list (room for a list a cluster)
+	uint32_t tileAlloc, tileState;
+	CULL_SET cull;
+	CULL_RUN* runs;
+} MODEL;
+
+/*--------------------------------------------------------------------------}
+{ Loads a .msh as LoadMeshFile does, centred and scaled to MODEL_SIZE.     }
+{--------------------------------------------------------------------------*/
+static bool LoadModel (const char* fileName, MODEL* m)
+{
+	FILE* fp = fopen(fileName, "rb");
+	if (fp == 0) return false;
+	fseek(fp, 0, SEEK_END);
+	uint32_t fileSize = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	uint8_t* file = malloc(fileSize);
+	bool ok = file && (fread(file, 1, fileSize, fp) == fileSize);
+	fclose(fp);
+	const MESH_FILE_HEADER* hdr = (const MESH_FILE_HEADER*)file;
+	if (!ok || (fileSize < sizeof(MESH_FILE_HEADER)) || !MeshFile_CheckHeader(hdr, fileSize)) {
+		free(file);
+		return false;
+	}
+	float maxSize = 0.0f;
+	for (int a = 0; a < 3; a++)
+		if (hdr->max[a] - hdr->min[a] > maxSize) maxSize = hdr->max[a] - hdr->min[a];
+	m->vertexCount = hdr->vertexCount;
+	m->indexCount = hdr->indexCount;
+	m->positions = malloc(m->vertexCount * 3 * sizeof(float));
+	m->indexVC4 = GpuAlloc(m->indexCount * sizeof(uint16_t));
+	m->vertexVC4 = GpuAlloc(m->vertexCount * sizeof(SOFT_VERTEX));
+	m->recordVC4 = GpuAlloc(16);
+	uint32_t memSize = Cull_MemorySize(m->indexCount);
+	void* cullMem = malloc(memSize);
+	if (!m->positions || !m->indexVC4 || !m->vertexVC4 || !m->recordVC4 || !cullMem) return false;
+	memcpy(ToARM(m->indexVC4), file + hdr->indexOffset, m->indexCount * sizeof(uint16_t));
+	MeshFile_Positions(hdr, (const int16_t*)(file + hdr->positionOffset),
+		(maxSize > 0.0f) ? MODEL_SIZE / maxSize : 1.0f, m->positions, 3 * sizeof(float));
+	free(file);
+
+	if (!Cull_BuildSet(&m->cull, cullMem, memSize, m->positions, 3 * sizeof(float),
+		ToARM(m->indexVC4), m->indexCount)) return false;
+	m->runs = malloc(m->cull.count * sizeof(CULL_RUN));
+
+	uint8_t* r = ToARM(m->recordVC4);							// NV shader record
+	r[0] = 0x01;												// flags
+	r[1] = sizeof(SOFT_VERTEX);									// stride
+	r[2] = 0;													// num uniforms
+	r[3] = 3;													// num varyings
+	memset(&r[4], 0, 8);										// fragment shader and uniforms (not run here)
+	memcpy(&r[12], &m->vertexVC4, 4);							// vertex data
+
+	uint32_t tiles = ((SCREEN_WTH + 63) / 64) * ((SCREEN_HT + 63) / 64);
+	m->tileAlloc = GpuAlloc(tiles * 64);
+	m->tileState = GpuAlloc(tiles * 48);
+	m->binSize = 0x40 + m->cull.count * 14 + 0x10;				// As EmitFrameLists sizes it
+	m->binStart = GpuAlloc(m->binSize);
+	return m->runs && m->tileAlloc && m->tileState && m->binStart;
+}
+
+/*--------------------------------------------------------------------------}
+{ Writes the depth tested binning list with a primitive list a run.        }
+{--------------------------------------------------------------------------*/
+static uint32_t BuildList (const MODEL* m, const CULL_RUN* runs, uint32_t runCount)
+{
+	uint32_t binWth = (SCREEN_WTH + 63) / 64, binHt = (SCREEN_HT + 63) / 64;
+	V3D_LIST list;
+	V3DList_Init(&list, ToARM(m->binStart), m->binStart, m->binSize);
+	V3DList_TileBinningConfig(&list, m->tileAlloc, binWth * binHt * 64, m->tileState, binWth, binHt, 0x04);
+	V3DList_StartTileBinning(&list);
+	V3DList_PrimitiveListFormat(&list, 0x12);
+	V3DList_ClipWindow(&list, 0, 0, SCREEN_WTH, SCREEN_HT);
+	V3DList_ConfigState(&list, 0x03, 0x90, 0x03);				// Depth less and update, early Z
+	V3DList_ViewportOffset(&list, 0, 0);
+	V3DList_NVShaderState(&list, m->recordVC4);
+	for (uint32_t i = 0; i < runCount; i++)
+		V3DList_IndexedPrimitiveList(&list, PRIM_TRIANGLE | INDEX_TYPE_16, runs[i].indexCount,
+			m->indexVC4 + runs[i].firstIndex * sizeof(uint16_t), runs[i].maxIndex);
+	V3DList_FlushAllState(&list);
+	V3DList_Nop(&list);
+	V3DList_Halt(&list);
+	return list.overflow ? 0 : V3DList_Size(&list);
+}
+
+/*--------------------------------------------------------------------------}
+{ Builds the DoRotate screen matrix for a z rotation, centred at cx,cy and  }
+{ writes the emit vertexes shaded by depth as the QPU vertex shader does.   }
+{--------------------------------------------------------------------------*/
+static void Transform (const MODEL* m, float angle, float cx, float cy, MATRIX3D* mvp)
+{
+	static const MATRIX3D tiltX = MATRIX3D_XROT_INIT(0.78539815f);
+	static const MATRIX3D tiltY = MATRIX3D_YROT_INIT(0.78539815f);
+	MATRIX3D view;
+	Matrix3D_Multiply(&view, &tiltX, &tiltY);
+	Matrix3D_SetRotation(mvp, 2, angle);
+	Matrix3D_Multiply(mvp, &view, mvp);
+	MATRIX3D s = MATRIX3D_TRANSLATE_INIT(cx, cy, 0.5f);
+	s.coef[2][2] = 0.5f / MODEL_SIZE;
+	Matrix3D_Multiply(mvp, &s, mvp);
+
+	SOFT_VERTEX* ev = ToARM(m->vertexVC4);
+	for (uint32_t i = 0; i < m->vertexCount; i++) {			// TransformVertexBatch plain C path
+		const float* p = &m->positions[i * 3];
+		float x = mvp->coef[0][0] * p[0] + mvp->coef[0][1] * p[1] + mvp->coef[0][2] * p[2] + mvp->coef[0][3];
+		float y = mvp->coef[1][0] * p[0] + mvp->coef[1][1] * p[1] + mvp->coef[1][2] * p[2] + mvp->coef[1][3];
+		float z = mvp->coef[2][0] * p[0] + mvp->coef[2][1] * p[1] + mvp->coef[2][2] * p[2] + mvp->coef[2][3];
+		SOFT_VERTEX v = { (uint16_t)(int32_t)(x * 16.0f), (uint16_t)(int32_t)(y * 16.0f), z, 1.0f,
+			1.0f - z, 1.0f - z, 1.0f - z };
+		memcpy(&ev[i], &v, sizeof(v));
+	}
+}
+
+static SOFT_SCENE scene;						// Big (tile table) so not on the stack
+static uint32_t* bins;
+static uint32_t binSize = 1 << 21;
+static float depthTile[SOFT_TILE_SIZE * SOFT_TILE_SIZE];
+
+/* Draws the model binning list, returns the ns it took or 0 if it failed */
+static uint64_t Render (const MODEL* m, uint32_t listSize, uint32_t* pixels)
+{
+	SOFT_TARGET target = { pixels, SCREEN_WTH, SCREEN_HT, SCREEN_WTH, depthTile };
+	uint64_t t = NowNs();
+	if (!SoftRaster_SetupFromList(&scene, ToARM(m->binStart), listSize, ToARM, 0xFF000000, bins, binSize))
+		return 0;
+	SoftRaster_RenderTiles(&scene, &target, 0, 1);
+	return NowNs() - t + 1;
+}
+
+int main (int argc, char* argv[])
+{
+	int failures = 0;
+	if (argc < 2) {
+		printf("Usage: CullCheck model.msh ...\n");
+		return 2;
+	}
+	gpuMem = calloc(1, GPU_SIZE);
+	bins = malloc(binSize * sizeof(uint32_t));
+	uint32_t* whole = malloc(SCREEN_WTH * SCREEN_HT * sizeof(uint32_t));
+	uint32_t* culled = malloc(SCREEN_WTH * SCREEN_HT * sizeof(uint32_t));
+	if (!gpuMem || !bins || !whole || !culled) return 2;
+
+	for (int arg = 1; arg < argc; arg++) {
+		MODEL m = { 0 };
+		gpuUsed = 0;
+		if (!LoadModel(argv[arg], &m)) {
+			printf("%s: can't be loaded\n", argv[arg]);
+			failures++;
+			continue;
+		}
+		printf("%s: %u triangles, %u clusters of %u\n", argv[arg], (unsigned)(m.indexCount / 3),
+			(unsigned)m.cull.count, (unsigned)CULL_CLUSTER_TRIS);
+
+		uint64_t wholeNs = 0, culledNs = 0, submitted = 0, total = 0;
+		uint32_t offScreen = 0, backFacing = 0, runs = 0, diffViews = 0, diffPixels = 0;
+		for (uint32_t view = 0; view < VIEWS; view++) {
+			MATRIX3D mvp;
+			CULL_STATS cs;
+			// Every fourth view is pushed to the screen corner so the frustum has work
+			float cx = (view % 4 == 3) ? SCREEN_WTH - 60.0f : SCREEN_WTH / 2.0f;
+			float cy = (view % 4 == 3) ? 60.0f : SCREEN_HT / 2.0f;
+			Transform(&m, view * 6.2831852f / VIEWS, cx, cy, &mvp);
+
+			uint32_t n = Cull_Visible(&m.cull, &mvp, SCREEN_WTH, SCREEN_HT, 0, m.runs, 0);	// No tests, one run
+			uint64_t ns = Render(&m, BuildList(&m, m.runs, n), whole);
+			n = Cull_Visible(&m.cull, &mvp, SCREEN_WTH, SCREEN_HT, CULL_FRUSTUM | CULL_BACKFACE, m.runs, &cs);
+			uint64_t cullNs = Render(&m, BuildList(&m, m.runs, n), culled);
+			if (ns == 0 || cullNs == 0) {
+				printf("  view %u: binning list not drawn (bins needed %u)\n", (unsigned)view, (unsigned)scene.binUsed);
+				failures++;
+				break;
+			}
+			wholeNs += ns;
+			culledNs += cullNs;
+			submitted += cs.trisSubmitted;
+			total += cs.trisTotal;
+			offScreen += cs.offScreen;
+			backFacing += cs.backFacing;
+			runs += cs.runs;
+			uint32_t diff = 0;
+			for (uint32_t i = 0; i < SCREEN_WTH * SCREEN_HT; i++) if (whole[i] != culled[i]) diff++;
+			if (diff) diffViews++;
+			diffPixels += diff;
+		}
+		printf("  %u views: %.1f%% of triangles submitted, clusters %.1f off screen %.1f back facing, %.1f lists a view\n",
+			(unsigned)VIEWS, total ? 100.0 * submitted / total : 0.0, (double)offScreen / VIEWS,
+			(double)backFacing / VIEWS, (double)runs / VIEWS);
+		printf("  software render %.3f ms/frame whole, %.3f ms/frame culled\n",
+			wholeNs / 1e6 / VIEWS, culledNs / 1e6 / VIEWS);
+		printf("  %u pixels differ in %u views\n", (unsigned)diffPixels, (unsigned)diffViews);
+		if (diffPixels) failures++;
+		free(m.positions);
+		free(m.runs);
+		free(m.cull.cluster);
+	}
+
+	printf("\n%s\n", failures ? "CULL CHECK FAILED" : "Culled renders match the whole model");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,321 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for atoi
+#include <string.h>								// Needed for strcmp, memcpy
+#include "rpi-V3DList.h"						// Control list builder under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: ListCheck.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check of the rpi-V3DList control lists. The binning and render      }
+{  lists EmitFrameLists in rpi-GLES.c writes are built the same way into    }
+{  host memory standing in for a frame arena, validated and their sizes     }
+{  printed for a few screen sizes. Then damaged copies (missing packets,    }
+{  bad addresses, wrong tiles) are validated, each must be rejected.       }
+{  Returns non zero if a good list fails or a bad list passes.              }
+{                                                                           }
+{  Usage: ListCheck [-d] [width height triangles]                          }
+{         -d disassembles the lists of the first size                       }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/* Sizes as rpi-GLES.c uses them */
+#define BINNING_LIST_SIZE		0x80		// Binning control list
+#define SHADER_RECORD_SIZE		0x40		// Shader state record and its attribute record
+#define UNIFORMS_SIZE			0x40		// Vertex/coordinate shader uniforms (matrix)
+#define RENDER_LIST_HEADER		0x40		// Render list before the tile entries
+#define RENDER_LIST_PER_TILE	9			// Tile coordinates, branch to sublist and store
+#define TILE_STATE_PER_TILE		48			// Tile state data the binner keeps per tile
+#define TILE_ALLOC_PER_TILE		64			// Initial 32 byte block and room to chain
+#define TILE_ALLOC_PER_PRIM		8			// Compressed triangle record allowing for the tiles it crosses
+#define TILE_ALLOC_MIN			0x4000		// Never give the binner less than this
+
+#define ARENA_VC4		0x1E000000u			// Fake VC4 address of the frame arena
+#define ARENA_SIZE		0x400000u			// Host memory standing in for it
+#define MESH_VC4		0x1D000000u			// Fake VC4 address of the index array
+#define FB_VC4			0x1C000000u			// Fake VC4 address of the frame buffer
+
+static uint8_t arenaMem[ARENA_SIZE];		// The frame arena the lists are written in
+
+/* One frame's lists as EmitFrameLists lays them out */
+typedef struct frame {
+	uint32_t width, height, indexCount;		// Render size and triangle index count
+	uint32_t binWth, binHt;					// Tiles across and down
+	uint32_t tileAlloc, tileAllocSize;		// Tile allocation memory
+	uint32_t tileState;						// Tile state data
+	uint32_t binStart, binEnd;				// Binning list
+	uint32_t shaderRecord;					// Shader record
+	uint32_t renderStart, renderEnd;		// Render list
+	uint32_t used;							// Arena bytes used
+	V3D_MEM_RANGE ranges[3];				// Memory the lists may point into
+} FRAME;
+
+static int quiet (const char *fmt, ...)
+{
+	(void)fmt;
+	return 0;
+}
+
+static uint8_t* ARMaddr (uint32_t vc4)
+{
+	return &arenaMem[vc4 - ARENA_VC4];
+}
+
+static uint32_t Alloc (FRAME* f, uint32_t size, uint32_t align)
+{
+	uint32_t addr = (ARENA_VC4 + f->used + align - 1) & ~(align - 1);
+	f->used = addr + size - ARENA_VC4;
+	return addr;
+}
+
+/*--------------------------------------------------------------------------}
+{ Builds a frame's render and binning lists exactly as EmitFrameLists does. }
+{ Returns false if either list did not fit its space.                      }
+{--------------------------------------------------------------------------*/
+static bool BuildFrame (FRAME* f, uint32_t width, uint32_t height, uint32_t triangles, bool vertexShading)
+{
+	V3D_LIST list;
+	*f = (FRAME) { 0 };
+	f->width = width;
+	f->height = height;
+	f->indexCount = triangles * 3;
+	f->binWth = (width + 63) / 64;
+	f->binHt = (height + 63) / 64;
+	uint32_t tiles = f->binWth * f->binHt;
+	uint32_t tileAlloc = tiles * TILE_ALLOC_PER_TILE + triangles * TILE_ALLOC_PER_PRIM;
+	if (tileAlloc < TILE_ALLOC_MIN) tileAlloc = TILE_ALLOC_MIN;
+	f->tileAllocSize = (tileAlloc + 0xFFF) & ~0xFFF;
+
+	f->tileAlloc = Alloc(f, f->tileAllocSize, 0x1000);
+	Alloc(f, ((f->tileAllocSize / 2) + 0xFFF) & ~0xFFF, 0x1000);	// Overflow
+	f->tileState = Alloc(f, tiles * TILE_STATE_PER_TILE, 16);
+	f->binStart = Alloc(f, BINNING_LIST_SIZE, 16);
+	f->shaderRecord = Alloc(f, SHADER_RECORD_SIZE, 16);
+	Alloc(f, UNIFORMS_SIZE, 16);
+	f->renderStart = Alloc(f, RENDER_LIST_HEADER + tiles * RENDER_LIST_PER_TILE, 16);
+	if (f->used > ARENA_SIZE) return false;
+
+	f->ranges[0] = (V3D_MEM_RANGE) { ARENA_VC4, f->used, "frame arena" };
+	f->ranges[1] = (V3D_MEM_RANGE) { MESH_VC4, f->indexCount * 2, "mesh pool" };
+	f->ranges[2] = (V3D_MEM_RANGE) { FB_VC4, width * height * 4, "frame buffer" };
+
+	V3DList_Init(&list, ARMaddr(f->renderStart), f->renderStart, RENDER_LIST_HEADER + tiles * RENDER_LIST_PER_TILE);
+	V3DList_RenderTiles(&list, 0xff000000, FB_VC4, width, height, 0x04, f->binWth, f->binHt, f->tileAlloc);
+	if (list.overflow) return false;
+	f->renderEnd = V3DList_EndVC4(&list);
+
+	V3DList_Init(&list, ARMaddr(f->binStart), f->binStart, BINNING_LIST_SIZE);
+	V3DList_TileBinningConfig(&list, f->tileAlloc, f->tileAllocSize, f->tileState, f->binWth, f->binHt, 0x04);
+	V3DList_StartTileBinning(&list);
+	V3DList_PrimitiveListFormat(&list, 0x12);
+	V3DList_ClipWindow(&list, 0, 0, width, height);
+	V3DList_ConfigState(&list, 0x03, 0x00, 0x0);
+	V3DList_ViewportOffset(&list, 0, 0);
+	if (vertexShading) V3DList_ShaderState(&list, f->shaderRecord, 1);
+		else V3DList_NVShaderState(&list, f->shaderRecord);
+	V3DList_IndexedPrimitiveList(&list, PRIM_TRIANGLE | INDEX_TYPE_16, f->indexCount, MESH_VC4, f->indexCount + 2);
+	V3DList_FlushAllState(&list);
+	V3DList_Nop(&list);
+	V3DList_Halt(&list);
+	if (list.overflow) return false;
+	f->binEnd = V3DList_EndVC4(&list);
+	return true;
+}
+
+static uint32_t CheckBin (const FRAME* f, const uint8_t* list, uint32_t size, int (*prn) (const char *fmt, ...))
+{
+	V3D_VALIDATE v = { .type = V3DLIST_BINNING, .ranges = f->ranges, .rangeCount = 3,
+		.binWth = f->binWth, .binHt = f->binHt };
+	return V3DList_Validate(list, size, f->binStart, &v, prn);
+}
+
+static uint32_t CheckRender (const FRAME* f, const uint8_t* list, uint32_t size, int (*prn) (const char *fmt, ...))
+{
+	V3D_VALIDATE v = { .type = V3DLIST_RENDER, .ranges = f->ranges, .rangeCount = 3,
+		.binWth = f->binWth, .binHt = f->binHt, .tileAlloc = f->tileAlloc };
+	return V3DList_Validate(list, size, f->renderStart, &v, prn);
+}
+
+/*--------------------------------------------------------------------------}
+{  Damaged lists, each is a copy of a good list with one thing broken      }
+{--------------------------------------------------------------------------*/
+static uint8_t work[0x10000];					// Damaged copy of a list
+
+/* Removes the packet at byte offset ofs of the copy, returns new size */
+static uint32_t DropPacket (uint32_t size, uint32_t ofs)
+{
+	uint32_t len = V3DList_PacketLength(work[ofs]);
+	memmove(&work[ofs], &work[ofs + len], size - ofs - len);
+	return size - len;
+}
+
+/* Byte offset of the n'th (0 = first) packet with opcode in the copy */
+static uint32_t FindPacket (uint32_t size, uint8_t opcode, uint32_t n)
+{
+	for (uint32_t ofs = 0; ofs < size; ofs += V3DList_PacketLength(work[ofs]))
+		if (work[ofs] == opcode && n-- == 0) return ofs;
+	return size;
+}
+
+static void Put32 (uint8_t* p, uint32_t d)
+{
+	p[0] = (uint8_t)d;
+	p[1] = (uint8_t)(d >> 8);
+	p[2] = (uint8_t)(d >> 16);
+	p[3] = (uint8_t)(d >> 24);
+}
+
+static int failures = 0;
+
+static void ExpectBad (const char* what, uint32_t errors)
+{
+	printf("  %-44s %s (%u problems)\n", what, errors ? "rejected" : "ACCEPTED", (unsigned)errors);
+	if (errors == 0) failures++;
+}
+
+static void DamagedLists (const FRAME* f)
+{
+	uint32_t binSize = f->binEnd - f->binStart;
+	uint32_t renderSize = f->renderEnd - f->renderStart;
+	uint32_t size, ofs;
+	printf("Damaged lists (each must be rejected):\n");
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	size = DropPacket(binSize, FindPacket(binSize, GL_START_TILE_BINNING, 0));
+	ExpectBad("binning: no START_TILE_BINNING", CheckBin(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	size = DropPacket(binSize, FindPacket(binSize, GL_NV_SHADER_STATE, 0));
+	ExpectBad("binning: no shader state", CheckBin(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	size = DropPacket(binSize, FindPacket(binSize, GL_CLIP_WINDOW, 0));
+	ExpectBad("binning: no clip window", CheckBin(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	size = DropPacket(binSize, FindPacket(binSize, GL_FLUSH_ALL_STATE, 0));
+	ExpectBad("binning: no flush before halt", CheckBin(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	ofs = FindPacket(binSize, GL_TILE_BINNING_CONFIG, 0);
+	Put32(&work[ofs + 5], f->binWth * f->binHt * 16);				// Half the initial blocks
+	ExpectBad("binning: tile allocation too small", CheckBin(f, work, binSize, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	ofs = FindPacket(binSize, GL_INDEXED_PRIMITIVE_LIST, 0);
+	Put32(&work[ofs + 2], f->indexCount * 2);						// Twice the indices the mesh has
+	ExpectBad("binning: index array past mesh pool", CheckBin(f, work, binSize, quiet));
+
+	memcpy(work, ARMaddr(f->binStart), binSize);
+	ExpectBad("binning: list cut short", CheckBin(f, work, binSize - 3, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	size = DropPacket(renderSize, FindPacket(renderSize, GL_STORE_MULTISAMPLE_END, 0));
+	ExpectBad("render: no end of frame store", CheckRender(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	ofs = FindPacket(renderSize, GL_STORE_MULTISAMPLE, 0);
+	work[ofs] = GL_STORE_MULTISAMPLE_END;							// End of frame on the first tile
+	ExpectBad("render: end of frame before last tile", CheckRender(f, work, renderSize, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	ofs = FindPacket(renderSize, GL_TILE_COORDINATES, 3);
+	work[ofs + 1] = 0;												// Tile 0,2 draws 0,1 again
+	work[ofs + 2] = 1;
+	ExpectBad("render: tile drawn twice", CheckRender(f, work, renderSize, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	ofs = FindPacket(renderSize, GL_BRANCH_TO_SUBLIST, 1);
+	Put32(&work[ofs + 1], f->tileAlloc);							// Second tile branches to the first's block
+	ExpectBad("render: branch to wrong tile block", CheckRender(f, work, renderSize, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	size = DropPacket(renderSize, FindPacket(renderSize, GL_STORE_MULTISAMPLE, 0));
+	ExpectBad("render: tile never stored", CheckRender(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	size = DropPacket(renderSize, FindPacket(renderSize, GL_TILE_RENDER_CONFIG, 0));
+	ExpectBad("render: no TILE_RENDER_CONFIG", CheckRender(f, work, size, quiet));
+
+	memcpy(work, ARMaddr(f->renderStart), renderSize);
+	ofs = FindPacket(renderSize, GL_TILE_RENDER_CONFIG, 0);
+	Put32(&work[ofs + 1], FB_VC4 + 0x1000);						// Frame buffer runs off its memory
+	ExpectBad("render: frame buffer out of range", CheckRender(f, work, renderSize, quiet));
+
+	ExpectBad("render: validated as binning", CheckBin(f, ARMaddr(f->renderStart), renderSize, quiet));
+}
+
+int main (int argc, char* argv[])
+{
+	static const uint32_t sizes[][3] = {							// width, height, triangles
+		{ 640, 480, 1800 }, { 1024, 768, 1800 }, { 1280, 720, 1800 }, { 1920, 1080, 1800 }, { 1920, 1080, 20000 },
+	};
+	uint32_t userSize[3];
+	const uint32_t (*list)[3] = sizes;
+	uint32_t count = sizeof(sizes) / sizeof(sizes[0]);
+	bool disassemble = false;
+	int arg = 1;
+	FRAME f;
+
+	if (arg < argc && strcmp(argv[arg], "-d") == 0) {
+		disassemble = true;
+		arg++;
+	}
+	if (arg + 2 < argc) {											// width height triangles given
+		userSize[0] = atoi(argv[arg]);
+		userSize[1] = atoi(argv[arg + 1]);
+		userSize[2] = atoi(argv[arg + 2]);
+		list = &userSize;
+		count = 1;
+	}
+
+	printf("Screen       Tris  Tiles  Bin list  Render list  Tile alloc  Arena     NV  QPU\n");
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t nvErrors, qpuErrors;
+		if (!BuildFrame(&f, list[i][0], list[i][1], list[i][2], true)) {
+			printf("%ux%u: lists do not fit\n", (unsigned)list[i][0], (unsigned)list[i][1]);
+			failures++;
+			continue;
+		}
+		qpuErrors = CheckBin(&f, ARMaddr(f.binStart), f.binEnd - f.binStart, printf)
+			+ CheckRender(&f, ARMaddr(f.renderStart), f.renderEnd - f.renderStart, printf);
+		BuildFrame(&f, list[i][0], list[i][1], list[i][2], false);
+		nvErrors = CheckBin(&f, ARMaddr(f.binStart), f.binEnd - f.binStart, printf)
+			+ CheckRender(&f, ARMaddr(f.renderStart), f.renderEnd - f.renderStart, printf);
+		printf("%4ux%-4u %8u %6u %9u %12u %11u %6uK %4s %4s\n", (unsigned)f.width, (unsigned)f.height,
+			(unsigned)list[i][2], (unsigned)(f.binWth * f.binHt), (unsigned)(f.binEnd - f.binStart),
+			(unsigned)(f.renderEnd - f.renderStart), (unsigned)f.tileAllocSize, (unsigned)(f.used / 1024),
+			nvErrors ? "FAIL" : "ok", qpuErrors ? "FAIL" : "ok");
+		if (nvErrors || qpuErrors) failures++;
+	}
+
+	BuildFrame(&f, list[0][0], list[0][1], list[0][2], false);
+	if (disassemble) {
+		printf("\nBinning list:\n");
+		V3DList_Disassemble(ARMaddr(f.binStart), f.binEnd - f.binStart, f.binStart, printf);
+		printf("\nRender list:\n");
+		V3DList_Disassemble(ARMaddr(f.renderStart), f.renderEnd - f.renderStart, f.renderStart, printf);
+	}
+	printf("\n");
+	if (f.binWth * f.binHt >= 4) DamagedLists(&f);
+
+	printf("\n%s\n", failures ? "LIST CHECK FAILED" : "All lists good, all damaged lists rejected");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,243 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, uint64_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for atoi
+#include <math.h>								// Needed for sinf, cosf, fabsf
+#include <time.h>								// Needed for clock_gettime
+#include "rpi-Math3D.h"							// Math routines under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: Math3DBench.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host benchmark of rpi-Math3D against the by value MATRIX3D helpers it    }
+{  replaced (copied below as the Legacy routines). Results of the two are   }
+{  compared first, then points/sec for single point, AoS and SoA batch     }
+{  transforms and matrix multiplies/sec are printed. Built on an ARM host   }
+{  (Pi running Linux) the NEON paths are the ones measured.                 }
+{                                                                           }
+{  Usage: Math3DBench [points]          default 4096 (about a model size)   }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define BENCH_MIN_NS	200000000ull					// Each test runs at least this many nsec
+#define MAX_POINTS		65536							// Largest point batch
+
+/*--------------------------------------------------------------------------}
+{     LEGACY BY VALUE ROUTINES AS THEY WERE IN rpi-GLES.c (the baseline)    }
+{  Kept out of line, they were external functions called per point/matrix. }
+{--------------------------------------------------------------------------*/
+static __attribute__((noinline)) MATRIX3D LegacyZRotationMatrix3D (GLfloat angle_in_rad) {
+	GLfloat sineValue = sinf(angle_in_rad);
+	GLfloat cosineValue = cosf(angle_in_rad);
+	MATRIX3D m = IdentityMatrix3D;
+	m.coef[0][0] = cosineValue;
+	m.coef[0][1] = -sineValue;
+	m.coef[1][0] = sineValue;
+	m.coef[1][1] = cosineValue;
+	return(m);
+}
+
+static __attribute__((noinline)) MATRIX3D LegacyMultiplyMatrix3D (MATRIX3D a, MATRIX3D  b) {
+	MATRIX3D  m = IdentityMatrix3D;
+	for (uint_fast8_t i = 0; i < 4; i++) {
+		for (uint_fast8_t j = 0; j < 4; j++) {
+			GLfloat sum = (a.coef[i][0] * b.coef[0][j]);
+			sum = sum + (a.coef[i][1] * b.coef[1][j]);
+			sum = sum + (a.coef[i][2] * b.coef[2][j]);
+			sum = sum + (a.coef[i][3] * b.coef[3][j]);
+			m.coef[i][j] = sum;
+		}
+	}
+	return (m);
+}
+
+static __attribute__((noinline)) void LegacyTransformPoint3D (GLfloat inX, GLfloat inY, GLfloat inZ, MATRIX3D a,
+									GLfloat* outX, GLfloat* outY, GLfloat* outZ)
+{
+	GLfloat tw, tx, ty, tz;
+	tw = a.coef[3][0] * inX + a.coef[3][1] * inY + a.coef[3][2] * inZ + a.coef[3][3];
+	tx = a.coef[0][0] * inX + a.coef[0][1] * inY + a.coef[0][2] * inZ + a.coef[0][3];
+	ty = a.coef[1][0] * inX + a.coef[1][1] * inY + a.coef[1][2] * inZ + a.coef[1][3];
+	tz = a.coef[2][0] * inX + a.coef[2][1] * inY + a.coef[2][2] * inZ + a.coef[2][3];
+	if ((tw != GLFLOAT_ZERO) && (tw != GLFLOAT_ONE)) {
+		tx /= tw;
+		ty /= tw;
+		tz /= tw;
+	}
+	if (outX) *outX = tx;
+	if (outY) *outY = ty;
+	if (outZ) *outZ = tz;
+}
+
+/*--------------------------------------------------------------------------}
+{							BENCHMARK DATA									}
+{--------------------------------------------------------------------------*/
+static VEC3 aosIn[MAX_POINTS], aosOut[MAX_POINTS];
+static GLfloat soaX[MAX_POINTS], soaY[MAX_POINTS], soaZ[MAX_POINTS];
+static GLfloat soaOX[MAX_POINTS], soaOY[MAX_POINTS], soaOZ[MAX_POINTS];
+static uint32_t numPoints = 4096;
+static MATRIX3D benchMatrix;
+static MATRIX3D rotTable[256];							// Matrices the multiply tests chain
+static volatile GLfloat sink;							// Stops results being optimized away
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+typedef void (*BENCHFUNC) (uint32_t i);					// Bench body, i is the repeat count
+
+static void BenchLegacyPoints (uint32_t i)
+{
+	for (uint32_t k = 0; k < numPoints; k++)
+		LegacyTransformPoint3D(aosIn[k].x, aosIn[k].y, aosIn[k].z, benchMatrix,
+			&aosOut[k].x, &aosOut[k].y, &aosOut[k].z);
+}
+
+static void BenchAoSPoints (uint32_t i)
+{
+	Matrix3D_TransformPoints(&benchMatrix, aosIn, aosOut, numPoints);
+}
+
+static void BenchSoAPoints (uint32_t i)
+{
+	Matrix3D_TransformPointsSoA(&benchMatrix, soaX, soaY, soaZ, soaOX, soaOY, soaOZ, numPoints);
+}
+
+static void BenchNormals (uint32_t i)
+{
+	Matrix3D_TransformNormals(&benchMatrix, aosIn, aosOut, numPoints, true);
+}
+
+static void BenchLegacyMultiply (uint32_t i)
+{
+	MATRIX3D m = benchMatrix;
+	for (uint32_t k = 0; k < 256; k++)
+		m = LegacyMultiplyMatrix3D(m, rotTable[k]);
+	sink = m.coef[0][0];
+}
+
+static void BenchMultiply (uint32_t i)
+{
+	MATRIX3D m = benchMatrix;
+	for (uint32_t k = 0; k < 256; k++)
+		Matrix3D_Multiply(&m, &m, &rotTable[k]);
+	sink = m.coef[0][0];
+}
+
+/*--------------------------------------------------------------------------}
+{  Runs a bench body in doubling batches until BENCH_MIN_NS has elapsed.    }
+{  items is the number of points (or multiplies) one call processes.        }
+{--------------------------------------------------------------------------*/
+static double RunBench (const char* name, BENCHFUNC fn, uint32_t items, double baseline)
+{
+	uint64_t start, elapsed = 0;
+	uint32_t count = 0, batch = 1;
+	fn(0);															// Warm up caches
+	start = NowNs();
+	while (elapsed < BENCH_MIN_NS) {
+		for (uint32_t i = 0; i < batch; i++) fn(count + i);			// Run the batch
+		count += batch;
+		if (batch < (1u << 16)) batch <<= 1;						// Double batch size
+		elapsed = NowNs() - start;
+	}
+	double rate = (double)items * count * 1e9 / (double)elapsed;	// Items per second
+	if (baseline > 0.0) printf("  %-22s %8.2f M/s  x%.2f\n", name, rate / 1e6, rate / baseline);
+		else printf("  %-22s %8.2f M/s\n", name, rate / 1e6);
+	return rate;
+}
+
+/*--------------------------------------------------------------------------}
+{  Checks the new routines give the legacy results before timing anything.  }
+{--------------------------------------------------------------------------*/
+static bool CheckResults (void)
+{
+	float maxErr = 0.0f;
+	MATRIX3D a = LegacyMultiplyMatrix3D(benchMatrix, LegacyZRotationMatrix3D(0.3f));
+	MATRIX3D b;
+	Matrix3D_SetRotation(&b, 2, 0.3f);
+	Matrix3D_Multiply(&b, &benchMatrix, &b);
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			if (fabsf(a.coef[i][j] - b.coef[i][j]) > maxErr) maxErr = fabsf(a.coef[i][j] - b.coef[i][j]);
+	Matrix3D_TransformPoints(&benchMatrix, aosIn, aosOut, numPoints);
+	Matrix3D_TransformPointsSoA(&benchMatrix, soaX, soaY, soaZ, soaOX, soaOY, soaOZ, numPoints);
+	for (uint32_t k = 0; k < numPoints; k++) {
+		GLfloat x, y, z;
+		LegacyTransformPoint3D(aosIn[k].x, aosIn[k].y, aosIn[k].z, benchMatrix, &x, &y, &z);
+		float e = fabsf(x - aosOut[k].x) + fabsf(y - aosOut[k].y) + fabsf(z - aosOut[k].z);
+		e += fabsf(x - soaOX[k]) + fabsf(y - soaOY[k]) + fabsf(z - soaOZ[k]);
+		if (e > maxErr) maxErr = e;
+	}
+	printf("  max difference to legacy %g\n", maxErr);
+	return (maxErr < 1e-3f);
+}
+
+int main (int argc, char* argv[])
+{
+	static const MATRIX3D tiltX = MATRIX3D_XROT_INIT(0.78539815f);	// Same view as CreateVertexData
+	static const MATRIX3D tiltY = MATRIX3D_YROT_INIT(0.78539815f);
+	if (argc >= 2) numPoints = atoi(argv[1]);
+	if ((numPoints < 4) || (numPoints > MAX_POINTS)) {
+		printf("Points must be 4 to %u\n", MAX_POINTS);
+		return 1;
+	}
+	for (uint32_t k = 0, s = 12345; k < numPoints; k++) {			// Pseudo random model sized points
+		s = s * 1103515245 + 12345;
+		aosIn[k].x = soaX[k] = (float)((s >> 8) & 0xFFFF) / 256.0f - 128.0f;
+		s = s * 1103515245 + 12345;
+		aosIn[k].y = soaY[k] = (float)((s >> 8) & 0xFFFF) / 256.0f - 128.0f;
+		s = s * 1103515245 + 12345;
+		aosIn[k].z = soaZ[k] = (float)((s >> 8) & 0xFFFF) / 256.0f - 128.0f;
+	}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	printf("rpi-Math3D NEON build, %u points\n", numPoints);
+#else
+	printf("rpi-Math3D scalar build, %u points\n", numPoints);
+#endif
+	for (int pass = 0; pass < 2; pass++) {
+		Matrix3D_Multiply(&benchMatrix, &tiltX, &tiltY);
+		if (pass == 0) {
+			MATRIX3D s = MATRIX3D_TRANSLATE_INIT(512.0f, 384.0f, 0.5f);	// DoRotate style screen matrix
+			Matrix3D_Multiply(&benchMatrix, &s, &benchMatrix);
+			printf("Affine matrix (no w divide)\n");
+		} else {
+			benchMatrix.coef[3][2] = 0.01f;							// Simple perspective row
+			benchMatrix.coef[3][3] = 2.0f;
+			printf("Perspective matrix (w divide)\n");
+		}
+		if (!CheckResults()) {
+			printf("Results do not match legacy routines\n");
+			return 1;
+		}
+		double base = RunBench("TransformPoint3D x N", BenchLegacyPoints, numPoints, 0.0);
+		RunBench("TransformPoints AoS", BenchAoSPoints, numPoints, base);
+		RunBench("TransformPointsSoA", BenchSoAPoints, numPoints, base);
+		RunBench("TransformNormals", BenchNormals, numPoints, base);
+	}
+	for (uint32_t k = 0; k < 256; k++)								// Chain of small rotations to multiply
+		rotTable[k] = LegacyZRotationMatrix3D(0.001f * k);
+	printf("Matrix multiply\n");
+	double base = RunBench("MultiplyMatrix3D", BenchLegacyMultiply, 256, 0.0);
+	RunBench("Matrix3D_Multiply", BenchMultiply, 256, base);
+	return 0;
+}
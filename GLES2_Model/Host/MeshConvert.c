@@ -0,0 +1,320 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, uint64_t etc
+#include <stdio.h>								// Needed for printf, fopen
+#include <stdlib.h>								// Needed for malloc, strtol
+#include <string.h>								// Needed for strcmp, strrchr
+#include <math.h>								// Needed for sqrtf, fabsf
+#include <time.h>								// Needed for clock_gettime
+#include "rpi-MeshFile.h"						// Mesh file format
+#include "MeshOpt.h"							// Weld and reorder before writing
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: MeshConvert.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host conversion of an OBJ model to the binary mesh cache the Pi loads   }
+{  (rpi-MeshFile.h). Faces are fan triangulated as ParseWaveFrontMesh does }
+{  it (0,1,2 then 0,2,3 ...). Unless -u is given the mesh is then welded   }
+{  on the quantise grid and its triangles and vertexes reordered for the   }
+{  vertex cache (MeshOpt.c), ACMR before and after is printed for FIFO     }
+{  caches of 8, 16 and 32. With -n smooth normals are added, each the area }
+{  weighted sum of the face normals around the vertex.                     }
+{  The file written is read back and checked: header, indexes identical,  }
+{  positions within the quantise step. OBJ parse and .msh load times are   }
+{  printed to compare.                                                      }
+{                                                                           }
+{  Usage: MeshConvert [-n] [-u] model.obj [model.msh]  default out is     }
+{                                                    .msh beside the OBJ   }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+typedef struct mesh {
+	float* positions;							// x,y,z a vertex
+	uint32_t vertexCount;
+	uint32_t vertexMax;							// Vertexes positions can hold
+	uint16_t* indices;							// Triangle list
+	uint32_t indexCount;
+	uint32_t indexMax;							// Indexes indices can hold
+	uint32_t faces;								// OBJ faces read
+} MESH;
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static bool AddIndex (MESH* m, uint32_t index)
+{
+	if (m->indexCount == m->indexMax) {
+		m->indexMax = (m->indexMax) ? m->indexMax * 2 : 4096;
+		m->indices = realloc(m->indices, m->indexMax * sizeof(uint16_t));
+		if (m->indices == 0) return false;
+	}
+	m->indices[m->indexCount++] = (uint16_t)index;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Reads the v and f lines of an OBJ file, anything else is skipped. Face   }
+{ corners may be v, v/t, v//n or v/t/n and negative (relative) indexes.    }
+{--------------------------------------------------------------------------*/
+static bool ReadObj (const char* fileName, MESH* m)
+{
+	char line[1024];
+	uint32_t lineNo = 0;
+	FILE* fp = fopen(fileName, "r");
+	if (fp == 0) {
+		printf("Unable to open %s\n", fileName);
+		return false;
+	}
+	*m = (MESH) { 0 };
+	while (fgets(line, sizeof(line), fp)) {
+		lineNo++;
+		if ((line[0] == 'v') && (line[1] == ' ')) {
+			if (m->vertexCount == m->vertexMax) {
+				m->vertexMax = (m->vertexMax) ? m->vertexMax * 2 : 4096;
+				m->positions = realloc(m->positions, m->vertexMax * 3 * sizeof(float));
+				if (m->positions == 0) break;
+			}
+			float* p = &m->positions[m->vertexCount * 3];
+			if (sscanf(&line[2], "%f %f %f", &p[0], &p[1], &p[2]) != 3) {
+				printf("%s line %u: bad vertex\n", fileName, lineNo);
+				break;
+			}
+			m->vertexCount++;
+		} else if ((line[0] == 'f') && (line[1] == ' ')) {
+			uint32_t corner[3], n = 0;
+			char* s = &line[2];
+			for (;;) {
+				while (*s == ' ' || *s == '\t') s++;
+				char* e;
+				long v = strtol(s, &e, 10);
+				if (e == s) break;								// No more corners
+				while (*e && *e != ' ' && *e != '\t' && *e != '\r' && *e != '\n') e++;	// Skip /t/n
+				s = e;
+				if (v < 0) v += m->vertexCount + 1;				// Relative to the last vertex
+				if ((v < 1) || (v > (long)m->vertexCount) || (v > 65536)) {
+					printf("%s line %u: face index %ld is not a vertex (or over 65536)\n", fileName, lineNo, v);
+					fclose(fp);
+					return false;
+				}
+				if (n < 2) corner[n] = v - 1;
+				else {											// Fan triangle 0, n-1, n
+					corner[2] = v - 1;
+					if (!AddIndex(m, corner[0]) || !AddIndex(m, corner[1]) || !AddIndex(m, corner[2])) {
+						printf("%s: out of memory\n", fileName);
+						fclose(fp);
+						return false;
+					}
+					corner[1] = corner[2];
+				}
+				n++;
+			}
+			if (n < 3) {
+				printf("%s line %u: face with under 3 vertexes\n", fileName, lineNo);
+				break;
+			}
+			m->faces++;
+		}
+	}
+	bool ok = feof(fp) && (m->vertexCount > 0) && (m->vertexCount <= 65536);
+	fclose(fp);
+	if (!ok) printf("%s: not read, no vertexes, over 65536 vertexes or out of memory\n", fileName);
+	return ok;
+}
+
+/*--------------------------------------------------------------------------}
+{ Smooth normals, the cross product of two edges is the face normal times  }
+{ twice its area so summing them weights each face by its area.            }
+{--------------------------------------------------------------------------*/
+static float* SmoothNormals (const MESH* m)
+{
+	float* n = calloc(m->vertexCount * 3, sizeof(float));
+	if (n == 0) return 0;
+	for (uint32_t t = 0; t < m->indexCount; t += 3) {
+		const float* a = &m->positions[m->indices[t] * 3];
+		const float* b = &m->positions[m->indices[t + 1] * 3];
+		const float* c = &m->positions[m->indices[t + 2] * 3];
+		float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+		float f[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+		for (int i = 0; i < 3; i++)
+			for (int a = 0; a < 3; a++)
+				n[m->indices[t + i] * 3 + a] += f[a];
+	}
+	for (uint32_t i = 0; i < m->vertexCount; i++) {
+		float* v = &n[i * 3];
+		float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+		if (len > 0.0f) {
+			v[0] /= len; v[1] /= len; v[2] /= len;
+		}
+	}
+	return n;
+}
+
+/*--------------------------------------------------------------------------}
+{ Reads fileName back the way the Pi does, header then the index block and }
+{ the rest in one read each, and checks it against the mesh it came from.  }
+{--------------------------------------------------------------------------*/
+static bool CheckFile (const char* fileName, const MESH* m, uint64_t* loadNs)
+{
+	uint64_t t = NowNs();
+	FILE* fp = fopen(fileName, "rb");
+	if (fp == 0) return false;
+	fseek(fp, 0, SEEK_END);
+	uint32_t fileSize = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	MESH_FILE_HEADER hdr;
+	if ((fread(&hdr, sizeof(hdr), 1, fp) != 1) || !MeshFile_CheckHeader(&hdr, fileSize)) {
+		fclose(fp);
+		printf("%s: header check failed\n", fileName);
+		return false;
+	}
+	uint32_t indexBytes = hdr.positionOffset - hdr.indexOffset;
+	uint32_t restBytes = hdr.fileSize - hdr.positionOffset;
+	uint16_t* indices = malloc(indexBytes);
+	uint8_t* rest = malloc(restBytes);
+	float* pos = malloc(hdr.vertexCount * 3 * sizeof(float));
+	bool ok = indices && rest && pos && (fread(indices, 1, indexBytes, fp) == indexBytes)
+		&& (fread(rest, 1, restBytes, fp) == restBytes);
+	fclose(fp);
+	if (ok) MeshFile_Positions(&hdr, (const int16_t*)rest, 1.0f, pos, 3 * sizeof(float));
+	*loadNs = NowNs() - t;
+
+	if (ok) ok = (hdr.vertexCount == m->vertexCount) && (hdr.indexCount == m->indexCount)
+		&& (memcmp(indices, m->indices, m->indexCount * sizeof(uint16_t)) == 0);
+	float worst = 0.0f, size = 0.0f;
+	for (int a = 0; ok && a < 3; a++) {
+		float centre = (hdr.min[a] + hdr.max[a]) * 0.5f;
+		float step = (hdr.max[a] - hdr.min[a]) / (2.0f * MESH_QUANT_MAX);
+		if (hdr.max[a] - hdr.min[a] > size) size = hdr.max[a] - hdr.min[a];
+		for (uint32_t i = 0; i < m->vertexCount; i++) {
+			float err = fabsf(pos[i * 3 + a] + centre - m->positions[i * 3 + a]);
+			if (err > step * 0.5f + (fabsf(centre) + step * MESH_QUANT_MAX) * 1e-6f) ok = false;	// Half a step plus float rounding
+			if (err > worst) worst = err;
+		}
+	}
+	if (ok) printf("Read back ok, worst position error %g (%.6f%% of model size)\n",
+		worst, (size > 0.0f) ? 100.0f * worst / size : 0.0f);
+	else printf("%s: read back does not match the mesh\n", fileName);
+	free(indices);
+	free(rest);
+	free(pos);
+	return ok;
+}
+
+static void PrintACMR (const char* title, const MESH* m)
+{
+	printf("%s ACMR FIFO 8: %.3f  16: %.3f  32: %.3f\n", title,
+		MeshOpt_ACMR(m->indices, m->indexCount, m->vertexCount, 8),
+		MeshOpt_ACMR(m->indices, m->indexCount, m->vertexCount, 16),
+		MeshOpt_ACMR(m->indices, m->indexCount, m->vertexCount, 32));
+}
+
+/*--------------------------------------------------------------------------}
+{ Welds on the grid the .msh quantises to, so only vertexes that would be  }
+{ written identical are merged, then reorders triangles and vertexes.      }
+{--------------------------------------------------------------------------*/
+static bool Optimise (MESH* m)
+{
+	float min[3], max[3], cell[3];
+	for (int a = 0; a < 3; a++) {
+		min[a] = max[a] = m->positions[a];
+		for (uint32_t i = 1; i < m->vertexCount; i++) {
+			float v = m->positions[i * 3 + a];
+			if (v < min[a]) min[a] = v;
+			if (v > max[a]) max[a] = v;
+		}
+		cell[a] = (max[a] - min[a]) / (2.0f * MESH_QUANT_MAX);
+	}
+	uint32_t verts = m->vertexCount, tris = m->indexCount / 3;
+	PrintACMR("Before:", m);
+	m->vertexCount = MeshOpt_Weld(m->positions, m->vertexCount, m->indices, &m->indexCount, cell);
+	if ((m->vertexCount == 0) || !MeshOpt_ReorderTriangles(m->indices, m->indexCount, m->vertexCount)) return false;
+	m->vertexCount = MeshOpt_ReorderVertices(m->positions, m->vertexCount, m->indices, m->indexCount);
+	if (m->vertexCount == 0) return false;
+	printf("Welded/unused vertices removed: %u, degenerate triangles removed: %u\n",
+		verts - m->vertexCount, tris - m->indexCount / 3);
+	PrintACMR("After: ", m);
+	return true;
+}
+
+int main (int argc, char* argv[])
+{
+	bool normals = false, optimise = true;
+	int arg = 1;
+	for (; (arg < argc) && (argv[arg][0] == '-'); arg++) {
+		if (strcmp(argv[arg], "-n") == 0) normals = true;
+		else if (strcmp(argv[arg], "-u") == 0) optimise = false;
+		else break;
+	}
+	if (arg >= argc) {
+		printf("Usage: MeshConvert [-n] [-u] model.obj [model.msh]\n");
+		return 1;
+	}
+	const char* objName = argv[arg++];
+	char mshName[1024];
+	if (arg < argc) snprintf(mshName, sizeof(mshName), "%s", argv[arg]);
+	else {
+		const char* dot = strrchr(objName, '.');
+		int len = (dot && !strchr(dot, '/')) ? (int)(dot - objName) : (int)strlen(objName);
+		snprintf(mshName, sizeof(mshName), "%.*s.msh", len, objName);
+	}
+
+	MESH m;
+	uint64_t t = NowNs();
+	if (!ReadObj(objName, &m)) return 1;
+	uint64_t parseNs = NowNs() - t;
+	printf("%s: %u vertices, %u faces -> %u triangles\n", objName, m.vertexCount, m.faces, m.indexCount / 3);
+	t = NowNs();
+	if (optimise && !Optimise(&m)) {
+		printf("%s: out of memory optimising\n", objName);
+		return 1;
+	}
+	uint64_t optNs = NowNs() - t;
+	float* n = (normals) ? SmoothNormals(&m) : 0;
+	uint32_t size = MeshFile_Build(0, 0, m.positions, m.vertexCount, m.indices, m.indexCount, n, m.faces);
+	uint8_t* file = (size) ? malloc(size) : 0;
+	if ((file == 0) || (MeshFile_Build(file, size, m.positions, m.vertexCount, m.indices, m.indexCount, n, m.faces) != size)) {
+		printf("%s: mesh can not be stored\n", objName);
+		return 1;
+	}
+	FILE* fp = fopen(mshName, "wb");
+	if ((fp == 0) || (fwrite(file, 1, size, fp) != size) || fclose(fp)) {
+		printf("Unable to write %s\n", mshName);
+		return 1;
+	}
+
+	FILE* obj = fopen(objName, "rb");
+	fseek(obj, 0, SEEK_END);
+	long objSize = ftell(obj);
+	fclose(obj);
+	printf("%s: %u vertices, %u triangles%s, %u bytes (OBJ text %ld bytes)\n", mshName, m.vertexCount,
+		m.indexCount / 3, (normals) ? ", smooth normals" : "", size, objSize);
+	uint64_t loadNs;
+	if (!CheckFile(mshName, &m, &loadNs)) return 1;
+	printf("Host times: OBJ parse %.2f ms, optimise %.2f ms, .msh load %.2f ms\n",
+		parseNs / 1e6, optNs / 1e6, loadNs / 1e6);
+	free(file);
+	free(n);
+	free(m.positions);
+	free(m.indices);
+	return 0;
+}
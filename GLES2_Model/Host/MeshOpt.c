@@ -0,0 +1,256 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <stdlib.h>								// Needed for malloc, calloc, free
+#include <string.h>								// Needed for memcpy
+#include <math.h>								// Needed for floorf, powf
+#include "MeshOpt.h"							// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: MeshOpt.c													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+#define NO_VERTEX	0xFFFFFFFF					// Empty hash slot / vertex not numbered yet
+
+/*-[MeshOpt_Weld]-----------------------------------------------------------}
+. Vertexes whose positions round to the same point on a grid of cell[0..2]
+. (x,y,z) are merged into the first of them, a cell of 0 on all three axes
+. only merges identical positions. Positions are compacted and indexes
+. rewritten, triangles left with a repeated index are removed.
+. RETURN: New vertex count (*indexCount is updated), 0 out of memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshOpt_Weld (float* positions, uint32_t vertexCount, uint16_t* indices, uint32_t* indexCount, const float cell[3])
+{
+	uint32_t tableSize = 1;
+	while (tableSize < vertexCount * 2) tableSize <<= 1;			// Power of 2 at least half empty
+	int32_t* key = malloc(vertexCount * 3 * sizeof(int32_t));
+	uint32_t* table = malloc(tableSize * sizeof(uint32_t));
+	uint32_t* newId = malloc(vertexCount * sizeof(uint32_t));
+	uint32_t count = 0;
+	if (key && table && newId) {
+		float min[3] = { positions[0], positions[1], positions[2] };
+		for (uint32_t i = 1; i < vertexCount; i++)
+			for (int a = 0; a < 3; a++)
+				if (positions[i * 3 + a] < min[a]) min[a] = positions[i * 3 + a];
+		for (uint32_t i = 0; i < vertexCount * 3; i++) {
+			int a = i % 3;
+			if (cell[a] > 0.0f) key[i] = (int32_t)floorf((positions[i] - min[a]) / cell[a] + 0.5f);
+				else memcpy(&key[i], &positions[i], sizeof(int32_t));	// Float bits, identical only
+		}
+		memset(table, 0xFF, tableSize * sizeof(uint32_t));
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			const int32_t* k = &key[v * 3];
+			uint32_t h = ((uint32_t)k[0] * 73856093u ^ (uint32_t)k[1] * 19349663u ^ (uint32_t)k[2] * 83492791u) & (tableSize - 1);
+			while ((table[h] != NO_VERTEX) && memcmp(&key[table[h] * 3], k, 3 * sizeof(int32_t)))
+				h = (h + 1) & (tableSize - 1);						// Linear probe to a match or a gap
+			if (table[h] == NO_VERTEX) {							// First vertex at this point
+				table[h] = v;
+				newId[v] = count;
+				memmove(&positions[count * 3], &positions[v * 3], 3 * sizeof(float));	// count <= v
+				count++;
+			} else newId[v] = newId[table[h]];						// Merge into the first
+		}
+		uint32_t out = 0;
+		for (uint32_t t = 0; t + 3 <= *indexCount; t += 3) {
+			uint32_t a = newId[indices[t]], b = newId[indices[t + 1]], c = newId[indices[t + 2]];
+			if ((a == b) || (b == c) || (a == c)) continue;			// Welded to a line or point
+			indices[out++] = a;
+			indices[out++] = b;
+			indices[out++] = c;
+		}
+		*indexCount = out;
+	}
+	free(key);
+	free(table);
+	free(newId);
+	return count;
+}
+
+/*--------------------------------------------------------------------------}
+{ Forsyth vertex score, high for vertexes near the front of the cache and  }
+{ for vertexes with few triangles left so they get finished off.           }
+{--------------------------------------------------------------------------*/
+#define CACHE_DECAY_POWER	1.5f
+#define LAST_TRI_SCORE		0.75f
+#define VALENCE_BOOST_SCALE	2.0f
+#define VALENCE_BOOST_POWER	0.5f
+
+static float VertexScore (int32_t cachePos, uint32_t trisLeft)
+{
+	if (trisLeft == 0) return -1.0f;							// No triangles need it
+	float score = 0.0f;
+	if (cachePos >= 0) {
+		if (cachePos < 3) score = LAST_TRI_SCORE;					// Used by the last triangle, fixed score
+		else score = powf(1.0f - (float)(cachePos - 3) / (MESHOPT_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+	}
+	return score + VALENCE_BOOST_SCALE * powf((float)trisLeft, -VALENCE_BOOST_POWER);
+}
+
+/*-[MeshOpt_ReorderTriangles]-----------------------------------------------}
+. Reorders the triangles of the index list for vertex cache reuse with an
+. LRU cache of MESHOPT_CACHE_SIZE. Each triangle keeps its winding.
+. RETURN: True done, False out of memory (indices is then unchanged)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MeshOpt_ReorderTriangles (uint16_t* indices, uint32_t indexCount, uint32_t vertexCount)
+{
+	uint32_t triCount = indexCount / 3;
+	uint32_t* trisLeft = calloc(vertexCount, sizeof(uint32_t));	// Triangles not yet drawn using each vertex
+	uint32_t* adjStart = calloc(vertexCount + 1, sizeof(uint32_t));	// Vertex v's triangles from adj[adjStart[v]]
+	uint32_t* adj = malloc(indexCount * sizeof(uint32_t) + 1);
+	int32_t* cachePos = malloc(vertexCount * sizeof(int32_t));
+	float* vScore = malloc(vertexCount * sizeof(float));
+	float* tScore = malloc(triCount * sizeof(float) + 1);
+	bool* added = calloc(triCount + 1, sizeof(bool));
+	uint16_t* out = malloc(indexCount * sizeof(uint16_t) + 1);
+	bool ok = trisLeft && adjStart && adj && cachePos && vScore && tScore && added && out;
+	if (ok) {
+		for (uint32_t i = 0; i < indexCount; i++) adjStart[indices[i] + 1]++;
+		for (uint32_t v = 0; v < vertexCount; v++) adjStart[v + 1] += adjStart[v];
+		for (uint32_t i = 0; i < indexCount; i++) {
+			uint32_t v = indices[i];
+			adj[adjStart[v] + trisLeft[v]++] = i / 3;
+		}
+		for (uint32_t v = 0; v < vertexCount; v++) {
+			cachePos[v] = -1;
+			vScore[v] = VertexScore(-1, trisLeft[v]);
+		}
+		int32_t best = -1;
+		float bestScore = -1.0f;
+		for (uint32_t t = 0; t < triCount; t++) {
+			tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+			if (tScore[t] > bestScore) {
+				bestScore = tScore[t];
+				best = t;
+			}
+		}
+
+		uint32_t cache[MESHOPT_CACHE_SIZE + 3], cacheCount = 0;
+		uint32_t nextFree = 0;										// No triangle before this is left
+		for (uint32_t n = 0; n < triCount; n++) {
+			if (best < 0) {											// Nothing in the cache is useful
+				while (added[nextFree]) nextFree++;					// Start again at the first one left
+				best = nextFree;
+			}
+			const uint16_t* tri = &indices[best * 3];
+			memcpy(&out[n * 3], tri, 3 * sizeof(uint16_t));
+			added[best] = true;
+
+			// Take the triangle off its vertexes lists
+			for (int i = 0; i < 3; i++) {
+				uint32_t v = tri[i], *list = &adj[adjStart[v]];
+				for (uint32_t j = 0; j < trisLeft[v]; j++)
+					if (list[j] == (uint32_t)best) {
+						list[j] = list[--trisLeft[v]];				// Swap the last one in
+						break;
+					}
+			}
+
+			// Its vertexes go to the front of the cache, the rest move back
+			uint32_t newCache[MESHOPT_CACHE_SIZE + 3], newCount = 0;
+			for (int i = 0; i < 3; i++) newCache[newCount++] = tri[i];
+			for (uint32_t i = 0; i < cacheCount; i++)
+				if ((cache[i] != tri[0]) && (cache[i] != tri[1]) && (cache[i] != tri[2]))
+					newCache[newCount++] = cache[i];
+
+			// Rescore what moved, anything past the cache size just fell out
+			best = -1;
+			bestScore = -1.0f;
+			for (uint32_t i = 0; i < newCount; i++) {
+				uint32_t v = newCache[i];
+				cachePos[v] = (i < MESHOPT_CACHE_SIZE) ? (int32_t)i : -1;
+				vScore[v] = VertexScore(cachePos[v], trisLeft[v]);
+			}
+			for (uint32_t i = 0; i < newCount; i++) {
+				uint32_t v = newCache[i];
+				for (uint32_t j = 0; j < trisLeft[v]; j++) {
+					uint32_t t = adj[adjStart[v] + j];
+					tScore[t] = vScore[indices[t * 3]] + vScore[indices[t * 3 + 1]] + vScore[indices[t * 3 + 2]];
+					if (tScore[t] > bestScore) {
+						bestScore = tScore[t];
+						best = t;
+					}
+				}
+			}
+			cacheCount = (newCount < MESHOPT_CACHE_SIZE) ? newCount : MESHOPT_CACHE_SIZE;
+			memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+		}
+		memcpy(indices, out, triCount * 3 * sizeof(uint16_t));
+	}
+	free(trisLeft);
+	free(adjStart);
+	free(adj);
+	free(cachePos);
+	free(vScore);
+	free(tScore);
+	free(added);
+	free(out);
+	return ok;
+}
+
+/*-[MeshOpt_ReorderVertices]------------------------------------------------}
+. Renumbers the vertexes in order of first use by the index list, moving
+. the x,y,z positions to match. Vertexes no triangle uses are dropped.
+. RETURN: New vertex count, 0 out of memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshOpt_ReorderVertices (float* positions, uint32_t vertexCount, uint16_t* indices, uint32_t indexCount)
+{
+	uint32_t* newId = malloc(vertexCount * sizeof(uint32_t));
+	float* copy = malloc(vertexCount * 3 * sizeof(float));
+	uint32_t count = 0;
+	if (newId && copy) {
+		memcpy(copy, positions, vertexCount * 3 * sizeof(float));
+		memset(newId, 0xFF, vertexCount * sizeof(uint32_t));
+		for (uint32_t i = 0; i < indexCount; i++) {
+			uint32_t v = indices[i];
+			if (newId[v] == NO_VERTEX) {							// First use numbers it
+				newId[v] = count;
+				memcpy(&positions[count * 3], &copy[v * 3], 3 * sizeof(float));
+				count++;
+			}
+			indices[i] = newId[v];
+		}
+	}
+	free(newId);
+	free(copy);
+	return count;
+}
+
+/*-[MeshOpt_ACMR]-----------------------------------------------------------}
+. Average cache miss ratio, vertexes transformed per triangle, drawing the
+. index list through a FIFO cache of cacheSize vertexes. 3.0 is no reuse,
+. 0.5 is about the best a large regular grid can do.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+float MeshOpt_ACMR (const uint16_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+	if (indexCount < 3) return 0.0f;
+	uint32_t* inserted = calloc(vertexCount, sizeof(uint32_t));	// FIFO time each vertex went in
+	if (inserted == 0) return 0.0f;
+	uint32_t time = cacheSize + 1, misses = 0;						// Time 0 is always a miss
+	for (uint32_t i = 0; i < indexCount; i++) {
+		uint32_t v = indices[i];
+		if (time - inserted[v] > cacheSize) {						// Pushed out (or never in)
+			inserted[v] = time++;
+			misses++;
+		}
+	}
+	free(inserted);
+	return (float)misses / (indexCount / 3);
+}
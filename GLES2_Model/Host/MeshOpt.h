@@ -0,0 +1,75 @@
+#ifndef _MESHOPT_
+#define _MESHOPT_
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: MeshOpt.h													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Mesh optimisation MeshConvert runs before a .msh file is written:        }
+{                                                                           }
+{  1) MeshOpt_Weld merges vertexes that land on the same quantised         }
+{     position and drops the triangles that leaves with no area.            }
+{  2) MeshOpt_ReorderTriangles puts the triangles in an order that reuses   }
+{     the vertex cache (Forsyth, "Linear-Speed Vertex Cache Optimisation"). }
+{     Nearby triangles end up together which also helps the binner.        }
+{  3) MeshOpt_ReorderVertices numbers the vertexes in the order the         }
+{     triangles first use them so vertex fetches walk memory forward.       }
+{                                                                           }
+{  MeshOpt_ACMR measures the result on a FIFO vertex cache.                 }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define MESHOPT_CACHE_SIZE	32					// LRU cache size the triangle order is tuned for
+
+/*-[MeshOpt_Weld]-----------------------------------------------------------}
+. Vertexes whose positions round to the same point on a grid of cell[0..2]
+. (x,y,z) are merged into the first of them, a cell of 0 on all three axes
+. only merges identical positions. Positions are compacted and indexes
+. rewritten, triangles left with a repeated index are removed.
+. RETURN: New vertex count (*indexCount is updated), 0 out of memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshOpt_Weld (float* positions, uint32_t vertexCount, uint16_t* indices, uint32_t* indexCount, const float cell[3]);
+
+/*-[MeshOpt_ReorderTriangles]-----------------------------------------------}
+. Reorders the triangles of the index list for vertex cache reuse with an
+. LRU cache of MESHOPT_CACHE_SIZE. Each triangle keeps its winding.
+. RETURN: True done, False out of memory (indices is then unchanged)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MeshOpt_ReorderTriangles (uint16_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+/*-[MeshOpt_ReorderVertices]------------------------------------------------}
+. Renumbers the vertexes in order of first use by the index list, moving
+. the x,y,z positions to match. Vertexes no triangle uses are dropped.
+. RETURN: New vertex count, 0 out of memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshOpt_ReorderVertices (float* positions, uint32_t vertexCount, uint16_t* indices, uint32_t indexCount);
+
+/*-[MeshOpt_ACMR]-----------------------------------------------------------}
+. Average cache miss ratio, vertexes transformed per triangle, drawing the
+. index list through a FIFO cache of cacheSize vertexes. 3.0 is no reuse,
+. 0.5 is about the best a large regular grid can do.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+float MeshOpt_ACMR (const uint16_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize);
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf, fopen
+#include <stdlib.h>								// Needed for malloc, strtoul
+#include <string.h>								// Needed for strcmp, strrchr
+#include "QPUAsm.h"								// The assembler
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPUAs.c													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  QPU assembler for the shader sources (QPUAsm.h has the dialect).         }
+{                                                                           }
+{  QPUAs file.qasm [file.h]   assembles to the body of a C array, one      }
+{                             instruction a line with its source, written  }
+{                             to file.h or the screen                      }
+{  QPUAs -d file              disassembles every pair of hex words in a    }
+{                             C file or table, eg a shader in an old .c    }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+static char* LoadFile (const char* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* text = malloc(size + 1);
+	if ((text) && (fread(text, 1, size, f) == (size_t)size)) text[size] = '\0';
+	else {
+		free(text);
+		text = NULL;
+	}
+	fclose(f);
+	return text;
+}
+
+/* Every 0x number in the text in order, taken 2 at a time as instructions */
+static int Disassemble (const char* text)
+{
+	uint32_t w[2], n = 0, index = 0;
+	for (const char* p = text; (p = strstr(p, "0x")) != NULL; ) {
+		char* end;
+		w[n++] = strtoul(p, &end, 16);
+		p = end;
+		if (n == 2) {
+			char line[200];
+			QPUAsm_Disassemble(w[0], w[1], index, line, sizeof(line));
+			printf("%4u: 0x%08x, 0x%08x  %s\n", (unsigned)index++, (unsigned)w[0], (unsigned)w[1], line);
+			n = 0;
+		}
+	}
+	return (n == 0) ? 0 : 1;
+}
+
+int main (int argc, char* argv[])
+{
+	if ((argc == 3) && (strcmp(argv[1], "-d") == 0)) {
+		char* text = LoadFile(argv[2]);
+		if (!text) {
+			printf("Can't read %s\n", argv[2]);
+			return 1;
+		}
+		int r = Disassemble(text);
+		free(text);
+		return r;
+	}
+	if ((argc < 2) || (argc > 3) || (argv[1][0] == '-')) {
+		printf("usage: QPUAs file.qasm [file.h]\n       QPUAs -d file\n");
+		return 1;
+	}
+	char* source = LoadFile(argv[1]);
+	if (!source) {
+		printf("Can't read %s\n", argv[1]);
+		return 1;
+	}
+	static QPUASM_PROGRAM prog;
+	if (!QPUAsm_Assemble(&prog, source)) {
+		fprintf(stderr, "%s:%d: %s\n", argv[1], prog.errorLine, prog.error);
+		free(source);
+		return 1;
+	}
+	free(source);
+	const char* name = strrchr(argv[1], '/');
+	name = name ? name + 1 : argv[1];
+	size_t size = 256 * (prog.lineCount + 1);
+	char* table = malloc(size);
+	QPUAsm_Table(&prog, name, table, size);
+	FILE* f = (argc == 3) ? fopen(argv[2], "w") : stdout;
+	if (!f) {
+		printf("Can't write %s\n", argv[2]);
+		free(table);
+		return 1;
+	}
+	fputs(table, f);
+	if (f != stdout) fclose(f);
+	free(table);
+	return 0;
+}
@@ -0,0 +1,740 @@
+#ifndef _QPUASM_
+#define _QPUASM_
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPUAsm.h													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Header only VideoCore IV QPU assembler and disassembler for the shader  }
+{  dialect the hex comments in the sources have always been written in.   }
+{  Include it in one or more host tools, everything is static.             }
+{                                                                           }
+{  One instruction a line, "add op; mul op; signal" with any part left     }
+{  out, a single op is the add op unless only the mul ALU has it:          }
+{      fadd r0, r0, r5; mov r1, vary                                        }
+{      nop; fmul r0, ra0, unif                                              }
+{      mov tlbc, r3; nop; thrend                                            }
+{  Ops take .setf and a condition (.ifz .ifnz .ifn .ifnn .ifc .ifnc        }
+{  .never), mov is or (add) or v8min (mul) of a source with itself.       }
+{  Registers: r0-r5, ra0-ra31, rb0-rb31, raw raNN/rbNN for 32-63, and the  }
+{  named reads and writes of the tables below (unif, vary, vpm, tlbc...).  }
+{  A named register both files have goes in the file that is free, the    }
+{  add op's second operand tries regfile B first. Small immediates are    }
+{  -16..15 and 1.0..128.0, 1/256..0.5 in powers of 2. Pack is a suffix on }
+{  the destination (ra.16a .16b .8888 .8a-.8d, mul output .8888 .8a-.8d   }
+{  colour), unpack a suffix on an ra or r4 source (.16a .16b .8dr .8a-.8d).}
+{      ldi dst, value            value is integer or float                  }
+{      ldi dst, value; ldi dst2, value   the mul ALU writes dst2           }
+{      brr.cond label            also brr .+n / .-n in instructions        }
+{      .word lo, hi              raw instruction                            }
+{      label:                                                               }
+{  Branch conditions are allz allnz anyz anynz alln allnn anyn anynn allc  }
+{  allnc anyc anync or none for always. # starts a comment.                }
+{                                                                           }
+{  QPUAsm_Disassemble writes an instruction back in the same dialect, so  }
+{  assembling what it gives reproduces the words.                         }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <stdio.h>								// Needed for snprintf
+#include <stdlib.h>								// Needed for strtol, strtod
+#include <string.h>								// Needed for strcmp, strncpy
+#include <ctype.h>								// Needed for isspace
+
+#define QPUASM_MAX_INSTR		2048			// Instructions in one program
+#define QPUASM_MAX_LABELS		128				// Labels in one program
+#define QPUASM_TEXT				96				// Longest instruction or comment kept
+
+/* Instruction fields, high word first as the VideoCore IV reference gives them */
+#define QPU_SIG_BKPT			0
+#define QPU_SIG_NONE			1
+#define QPU_SIG_THRSW			2
+#define QPU_SIG_THREND			3
+#define QPU_SIG_SBWAIT			4
+#define QPU_SIG_SBDONE			5
+#define QPU_SIG_LTHRSW			6
+#define QPU_SIG_LOADCV			7
+#define QPU_SIG_LOADC			8
+#define QPU_SIG_LDCEND			9
+#define QPU_SIG_LDTMU0			10
+#define QPU_SIG_LDTMU1			11
+#define QPU_SIG_LOADAM			12
+#define QPU_SIG_SMALLIMM		13
+#define QPU_SIG_LDI				14
+#define QPU_SIG_BRANCH			15
+
+#define QPU_R_NOP				39				// Read/write address of nothing
+
+/* A line of the source, what went where for listings and generated tables */
+typedef struct qpuasm_line {
+	int instr;									// Instruction index, -1 for a label line
+	char text[QPUASM_TEXT];						// Instruction or label as written
+	char comment[QPUASM_TEXT];					// Trailing # comment (may be empty)
+} QPUASM_LINE;
+
+/* An assembled program */
+typedef struct qpuasm_program {
+	uint32_t words[QPUASM_MAX_INSTR * 2];		// Low word then high word of each instruction
+	uint32_t count;								// Instructions
+	QPUASM_LINE lines[QPUASM_MAX_INSTR + QPUASM_MAX_LABELS];
+	uint32_t lineCount;
+	char labelName[QPUASM_MAX_LABELS][32];		// Labels and the instruction each is at
+	uint32_t labelInstr[QPUASM_MAX_LABELS];
+	uint32_t labelCount;
+	char error[160];							// What went wrong when assembly fails
+	int errorLine;								// Source line of the error (1 on)
+} QPUASM_PROGRAM;
+
+static const char* const qpuAddOps[32] = {
+	"nop", "fadd", "fsub", "fmin", "fmax", "fminabs", "fmaxabs", "ftoi", "itof", NULL, NULL, NULL,
+	"add", "sub", "shr", "asr", "ror", "shl", "min", "max", "and", "or", "xor", "not", "clz",
+	NULL, NULL, NULL, NULL, NULL, "v8adds", "v8subs" };
+static const char* const qpuMulOps[8] = { "nop", "fmul", "mul24", "v8muld", "v8min", "v8max", "v8adds", "v8subs" };
+static const char* const qpuSignals[16] = { "bkpt", "", "thrsw", "thrend", "sbwait", "sbdone", "lthrsw",
+	"loadcv", "loadc", "ldcend", "ldtmu0", "ldtmu1", "loadam", NULL, NULL, NULL };
+static const char* const qpuConds[8] = { "never", "", "ifz", "ifnz", "ifn", "ifnn", "ifc", "ifnc" };
+static const char* const qpuBranchConds[16] = { "allz", "allnz", "anyz", "anynz", "alln", "allnn", "anyn",
+	"anynn", "allc", "allnc", "anyc", "anync", NULL, NULL, NULL, "" };
+/* Write addresses 32..63 of regfile A and B */
+static const char* const qpuWriteA[32] = { "r0", "r1", "r2", "r3", "tmu_noswap", "r5quad", "host_int", "-",
+	"unif_addr", "quad_x", "ms_flags", "tlb_stencil", "tlbz", "tlbm", "tlbc", "tlbam", "vpm", "vr_setup",
+	"vr_addr", "mutex_release", "recip", "rsqrt", "exp", "log", "tmu0_s", "tmu0_t", "tmu0_r", "tmu0_b",
+	"tmu1_s", "tmu1_t", "tmu1_r", "tmu1_b" };
+static const char* const qpuWriteB[32] = { "r0", "r1", "r2", "r3", "tmu_noswap", "r5rep", "host_int", "-",
+	"unif_addr", "quad_y", "rev_flag", "tlb_stencil", "tlbz", "tlbm", "tlbc", "tlbam", "vpm", "vw_setup",
+	"vw_addr", "mutex_release", "recip", "rsqrt", "exp", "log", "tmu0_s", "tmu0_t", "tmu0_r", "tmu0_b",
+	"tmu1_s", "tmu1_t", "tmu1_r", "tmu1_b" };
+/* Read addresses 32..63 of regfile A and B */
+static const char* const qpuReadA[32] = { "unif", NULL, NULL, "vary", NULL, NULL, "elem_num", "-",
+	NULL, "x_coord", "ms_flags", NULL, NULL, NULL, NULL, NULL, "vpm", "vr_busy", "vr_wait", "mutex" };
+static const char* const qpuReadB[32] = { "unif", NULL, NULL, "vary", NULL, NULL, "qpu_num", "-",
+	NULL, "y_coord", "rev_flag", NULL, NULL, NULL, NULL, NULL, "vpm", "vw_busy", "vw_wait", "mutex" };
+static const char* const qpuPackA[8] = { "", "16a", "16b", "8888", "8a", "8b", "8c", "8d" };
+static const char* const qpuUnpack[8] = { "", "16a", "16b", "8dr", "8a", "8b", "8c", "8d" };
+
+/* Fields of an ALU instruction while it is put together */
+typedef struct qpuasm_alu {
+	uint32_t sig, unpack, pm, pack, condAdd, condMul, sf, ws, waddrAdd, waddrMul;
+	uint32_t opAdd, opMul, raddrA, raddrB, addA, addB, mulA, mulB;
+	bool usedA, usedB, usedImm;					// raddr A/B or the small immediate taken
+	int wsWant;									// -1 free, else the ws bit a write needs
+	int pmWant;									// -1 free, else the pm bit a pack/unpack needs
+	int unpackWant;								// Unpack asked for (0 none)
+	char* err;									// Error text buffer (160)
+} QPUASM_ALU;
+
+/*--------------------------------------------------------------------------}
+{ Small helpers: trimming, names to table indexes and number parsing.       }
+{--------------------------------------------------------------------------*/
+static inline char* QPUAsm_Trim (char* s)
+{
+	while (isspace((unsigned char)*s)) s++;
+	char* e = s + strlen(s);
+	while ((e > s) && isspace((unsigned char)e[-1])) *--e = '\0';
+	return s;
+}
+
+static inline int QPUAsm_Find (const char* const* table, int count, const char* name)
+{
+	for (int i = 0; i < count; i++)
+		if ((table[i]) && (strcmp(table[i], name) == 0)) return i;
+	return -1;
+}
+
+static inline bool QPUAsm_Error (char* err, const char* msg, const char* what)
+{
+	snprintf(err, 160, "%s '%s'", msg, what);
+	return false;
+}
+
+/* Integer or float number, floats come back as their bits with isFloat set */
+static inline bool QPUAsm_Number (const char* s, uint32_t* value, bool* isFloat)
+{
+	char* end;
+	*isFloat = false;
+	if ((strchr(s, '.')) && (strncmp(s, "0x", 2) != 0)) {
+		float f = strtof(s, &end);
+		if ((*end == 'f') || (*end == 'F')) end++;
+		if ((end == s) || (*end)) return false;
+		union { float f; uint32_t u; } b = { .f = f };
+		*value = b.u;
+		*isFloat = true;
+		return true;
+	}
+	long long v = strtoll(s, &end, 0);
+	if ((end == s) || (*end) || (v < -2147483648LL) || (v > 4294967295LL)) return false;
+	*value = (uint32_t)v;
+	return true;
+}
+
+/* Small immediate field for a number, -1 if it has none. Shifts and rotates */
+/* only use the low 5 bits so for them 16..31 are the fields of -16..-1.    */
+static inline int QPUAsm_SmallImm (const char* s, bool shift)
+{
+	uint32_t v;
+	bool isFloat;
+	if (!QPUAsm_Number(s, &v, &isFloat)) return -1;
+	if (!isFloat) {
+		int32_t i = (int32_t)v;
+		if ((i >= 0) && ((i <= 15) || ((shift) && (i <= 31)))) return i;
+		if ((i >= -16) && (i <= -1)) return 32 + i;
+		return -1;
+	}
+	union { uint32_t u; float f; } b = { .u = v };
+	for (int i = 0; i < 8; i++) {
+		if (b.f == (float)(1 << i)) return 32 + i;					// 1.0 .. 128.0
+		if (b.f == 1.0f / (float)(256 >> i)) return 40 + i;			// 1/256 .. 1/2
+	}
+	return -1;
+}
+
+/*--------------------------------------------------------------------------}
+{ Takes a register read for an ALU input, returns the input mux (0-7).      }
+{ preferB asks for regfile B first for names both files have.               }
+{--------------------------------------------------------------------------*/
+static inline int QPUAsm_Read (QPUASM_ALU* a, char* tok, bool preferB, bool shift)
+{
+	char* dot = strchr(tok, '.');
+	int unpack = 0;
+	if ((dot) && (!isdigit((unsigned char)dot[1]) || (tok[0] == 'r'))) {	// Suffix, not a float
+		if ((tok[0] == 'r') && ((tok[1] == 'a') || (tok[1] == '4'))) {
+			unpack = QPUAsm_Find(qpuUnpack, 8, dot + 1);
+			if (unpack <= 0) return QPUAsm_Error(a->err, "Bad unpack", tok), -1;
+			*dot = '\0';
+		}
+	}
+	if ((tok[0] == 'r') && (tok[1] >= '0') && (tok[1] <= '5') && (tok[2] == '\0')) {
+		if (unpack) {
+			if ((tok[1] != '4') || ((a->pmWant == 0) || ((a->unpackWant) && (a->unpackWant != unpack))))
+				return QPUAsm_Error(a->err, "Unpack clash", tok), -1;
+			a->pmWant = 1;
+			a->unpackWant = unpack;
+		}
+		return tok[1] - '0';
+	}
+	int file = -1, addr = -1;
+	if ((tok[0] == 'r') && ((tok[1] == 'a') || (tok[1] == 'b')) && isdigit((unsigned char)tok[2])) {
+		char* end;
+		addr = strtol(&tok[2], &end, 10);
+		if ((*end) || (addr > 63)) return QPUAsm_Error(a->err, "Bad register", tok), -1;
+		file = (tok[1] == 'a') ? 0 : 1;
+	} else {
+		int ia = QPUAsm_Find(qpuReadA, 32, tok), ib = QPUAsm_Find(qpuReadB, 32, tok);
+		if ((ia >= 0) && (ib >= 0)) {								// Either file, take the free one
+			bool freeA = (!a->usedA) || (a->raddrA == (uint32_t)(ia + 32));
+			bool freeB = ((!a->usedB) || (a->raddrB == (uint32_t)(ib + 32))) && (!a->usedImm);
+			file = ((preferB) && (freeB)) ? 1 : (freeA ? 0 : 1);
+			addr = 32 + (file ? ib : ia);
+		} else if (ia >= 0) {
+			file = 0;
+			addr = 32 + ia;
+		} else if (ib >= 0) {
+			file = 1;
+			addr = 32 + ib;
+		}
+	}
+	if (file < 0) {													// Must be a small immediate
+		int imm = QPUAsm_SmallImm(tok, shift);
+		if (imm < 0) return QPUAsm_Error(a->err, "Bad source", tok), -1;
+		if ((a->usedImm) && (a->raddrB != (uint32_t)imm)) return QPUAsm_Error(a->err, "Two small immediates", tok), -1;
+		if ((a->usedB) && (!a->usedImm)) return QPUAsm_Error(a->err, "Small immediate and regfile B", tok), -1;
+		if ((a->sig != QPU_SIG_NONE) && (a->sig != QPU_SIG_SMALLIMM)) return QPUAsm_Error(a->err, "Small immediate and signal", tok), -1;
+		a->sig = QPU_SIG_SMALLIMM;
+		a->usedImm = a->usedB = true;
+		a->raddrB = imm;
+		return 7;
+	}
+	if (unpack) {
+		if ((file != 0) || (a->pmWant == 1) || ((a->unpackWant) && (a->unpackWant != unpack)))
+			return QPUAsm_Error(a->err, "Unpack clash", tok), -1;
+		a->pmWant = 0;
+		a->unpackWant = unpack;
+	}
+	if (file == 0) {
+		if ((a->usedA) && (a->raddrA != (uint32_t)addr)) return QPUAsm_Error(a->err, "Second regfile A read", tok), -1;
+		a->usedA = true;
+		a->raddrA = addr;
+		return 6;
+	}
+	if (a->usedImm) return QPUAsm_Error(a->err, "Regfile B and small immediate", tok), -1;
+	if ((a->usedB) && (a->raddrB != (uint32_t)addr)) return QPUAsm_Error(a->err, "Second regfile B read", tok), -1;
+	a->usedB = true;
+	a->raddrB = addr;
+	return 7;
+}
+
+/*--------------------------------------------------------------------------}
+{ Takes a destination for the add or mul ALU, sets waddr, ws and pack.      }
+{--------------------------------------------------------------------------*/
+static inline bool QPUAsm_Write (QPUASM_ALU* a, char* tok, bool mul)
+{
+	char* dot = strchr(tok, '.');
+	int pack = 0;
+	if (dot) {
+		*dot = '\0';
+		pack = QPUAsm_Find(qpuPackA, 8, dot + 1);
+		if ((pack <= 0) || ((mul) && (pack < 3))) return QPUAsm_Error(a->err, "Bad pack", dot + 1);
+	}
+	int file = -1, addr;
+	if ((tok[0] == 'r') && ((tok[1] == 'a') || (tok[1] == 'b')) && isdigit((unsigned char)tok[2])) {
+		char* end;
+		addr = strtol(&tok[2], &end, 10);
+		if ((*end) || (addr > 63)) return QPUAsm_Error(a->err, "Bad register", tok);
+		file = (tok[1] == 'a') ? 0 : 1;
+	} else {
+		int ia = QPUAsm_Find(qpuWriteA, 32, tok), ib = QPUAsm_Find(qpuWriteB, 32, tok);
+		if ((ia < 0) && (ib < 0)) return QPUAsm_Error(a->err, "Bad destination", tok);
+		if ((ia >= 0) && (ib >= 0)) addr = 32 + ia;				// Same in both files
+		else {
+			file = (ia >= 0) ? 0 : 1;
+			addr = 32 + ((ia >= 0) ? ia : ib);
+		}
+	}
+	if (file >= 0) {												// Add writes A unless ws, mul B unless ws
+		int ws = mul ? (file == 0) : (file == 1);
+		if ((a->wsWant >= 0) && (a->wsWant != ws)) return QPUAsm_Error(a->err, "Both ALUs write one regfile", tok);
+		a->wsWant = ws;
+	}
+	if (pack) {
+		int pm = mul ? 1 : 0;
+		if ((!mul) && (file != 0)) return QPUAsm_Error(a->err, "Add pack needs regfile A", tok);
+		if ((a->pmWant >= 0) && (a->pmWant != pm)) return QPUAsm_Error(a->err, "Pack clash", tok);
+		if ((a->pack) && (a->pack != (uint32_t)pack)) return QPUAsm_Error(a->err, "Two packs", tok);
+		a->pmWant = pm;
+		a->pack = pack;
+	}
+	if (mul) a->waddrMul = addr; else a->waddrAdd = addr;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Splits "op.cond.setf" into op, condition and the setf flag.               }
+{--------------------------------------------------------------------------*/
+static inline bool QPUAsm_OpName (char* name, uint32_t* cond, bool* setf, char* err)
+{
+	*cond = 1;
+	*setf = false;
+	char* dot = strchr(name, '.');
+	while (dot) {
+		*dot = '\0';
+		char* next = strchr(dot + 1, '.');
+		if (next) *next = '\0';
+		if (strcmp(dot + 1, "setf") == 0) *setf = true;
+		else {
+			int c = QPUAsm_Find(qpuConds, 8, dot + 1);
+			if (c < 0) return QPUAsm_Error(err, "Bad op suffix", dot + 1);
+			*cond = c;
+		}
+		if (next) *next = '.';
+		dot = next;
+	}
+	return true;
+}
+
+/* Splits "a, b, c" into up to 3 trimmed operands */
+static inline int QPUAsm_Operands (char* s, char** ops)
+{
+	int n = 0;
+	while ((*s) && (n < 4)) {
+		char* comma = strchr(s, ',');
+		if (comma) *comma = '\0';
+		ops[n++] = QPUAsm_Trim(s);
+		if (!comma) break;
+		s = comma + 1;
+	}
+	return n;
+}
+
+/*--------------------------------------------------------------------------}
+{ One op ("fadd r0, r0, r5") for the add or mul ALU.                        }
+{--------------------------------------------------------------------------*/
+static inline bool QPUAsm_Op (QPUASM_ALU* a, char* text, bool mul)
+{
+	char* sp = text;
+	while ((*sp) && (!isspace((unsigned char)*sp))) sp++;
+	char* rest = sp;
+	if (*sp) *rest++ = '\0';
+	uint32_t cond;
+	bool setf;
+	if (!QPUAsm_OpName(text, &cond, &setf, a->err)) return false;
+	if (strcmp(text, "nop") == 0) return true;
+	char* ops[4];
+	int n = QPUAsm_Operands(rest, ops);
+	bool mov = (strcmp(text, "mov") == 0);
+	int op = mov ? (mul ? 4 : 21) : (mul ? QPUAsm_Find(qpuMulOps, 8, text) : QPUAsm_Find(qpuAddOps, 32, text));
+	if (op <= 0) return QPUAsm_Error(a->err, mul ? "Bad mul op" : "Bad add op", text);
+	bool unary = mov || ((!mul) && ((op == 7) || (op == 8) || (op == 23) || (op == 24)));	// ftoi itof not clz
+	if ((unary && (n != 2)) || ((!unary) && (n != 3))) return QPUAsm_Error(a->err, "Wrong operand count for", text);
+	if (!QPUAsm_Write(a, ops[0], mul)) return false;
+	char srcA[QPUASM_TEXT], srcB[QPUASM_TEXT];
+	strncpy(srcA, ops[1], QPUASM_TEXT - 1);
+	srcA[QPUASM_TEXT - 1] = '\0';
+	strncpy(srcB, unary ? ops[1] : ops[2], QPUASM_TEXT - 1);
+	srcB[QPUASM_TEXT - 1] = '\0';
+	bool same = (strcmp(srcA, srcB) == 0);
+	bool shift = (!mul) && (op >= 14) && (op <= 17);				// shr asr ror shl
+	int muxA = QPUAsm_Read(a, srcA, false, false);
+	if (muxA < 0) return false;
+	int muxB = QPUAsm_Read(a, srcB, !same, shift);
+	if (muxB < 0) return false;
+	if (setf) a->sf = 1;
+	if (mul) {
+		a->opMul = op; a->mulA = muxA; a->mulB = muxB; a->condMul = cond;
+	} else {
+		a->opAdd = op; a->addA = muxA; a->addB = muxB; a->condAdd = cond;
+	}
+	return true;
+}
+
+static inline bool QPUAsm_IsMulOnly (const char* part)
+{
+	char name[16];
+	int i = 0;
+	while ((part[i]) && (part[i] != '.') && (!isspace((unsigned char)part[i])) && (i < 15)) { name[i] = part[i]; i++; }
+	name[i] = '\0';
+	int m = QPUAsm_Find(qpuMulOps, 8, name);
+	return (m > 0) && (QPUAsm_Find(qpuAddOps, 32, name) < 0);
+}
+
+/*--------------------------------------------------------------------------}
+{ Assembles one instruction, branch targets must be .+n/.-n. labels (NULL   }
+{ when not assembling a program) resolves branch labels, err gets 160 chars.}
+{ RETURN: True assembled into lo/hi, False with err set                     }
+{--------------------------------------------------------------------------*/
+static inline bool QPUAsm_Instruction (const char* source, uint32_t index, const QPUASM_PROGRAM* labels,
+	uint32_t* lo, uint32_t* hi, char* err)
+{
+	char buf[256];
+	strncpy(buf, source, sizeof(buf) - 1);
+	buf[sizeof(buf) - 1] = '\0';
+	char* s = QPUAsm_Trim(buf);
+	err[0] = '\0';
+
+	if (strncmp(s, ".word", 5) == 0) {								// Raw words
+		char* ops[4];
+		uint32_t v[2];
+		bool f;
+		if ((QPUAsm_Operands(s + 5, ops) != 2) || (!QPUAsm_Number(ops[0], &v[0], &f)) || (!QPUAsm_Number(ops[1], &v[1], &f)))
+			return QPUAsm_Error(err, "Bad .word", source);
+		*lo = v[0];
+		*hi = v[1];
+		return true;
+	}
+
+	if ((strncmp(s, "brr", 3) == 0) && ((s[3] == '.') || isspace((unsigned char)s[3]))) {	// Relative branch
+		char* p = s + 3;
+		int cond = 15;
+		if (*p == '.') {
+			char* e = ++p;
+			while ((*e) && (!isspace((unsigned char)*e))) e++;
+			char c = *e;
+			*e = '\0';
+			cond = QPUAsm_Find(qpuBranchConds, 16, p);
+			if ((cond < 0) || (cond == 15)) return QPUAsm_Error(err, "Bad branch condition", p);
+			*e = c;
+			p = e;
+		}
+		p = QPUAsm_Trim(p);
+		int32_t target;
+		if ((p[0] == '.') && ((p[1] == '+') || (p[1] == '-'))) target = (int32_t)index + (int32_t)strtol(p + 1, NULL, 10);
+		else {
+			int found = -1;
+			for (uint32_t i = 0; (labels) && (i < labels->labelCount); i++)
+				if (strcmp(labels->labelName[i], p) == 0) found = labels->labelInstr[i];
+			if (found < 0) return QPUAsm_Error(err, "Unknown label", p);
+			target = found;
+		}
+		*lo = (uint32_t)((target - (int32_t)(index + 4)) * 8);		// Bytes on from the instruction after the delay slots
+		*hi = (QPU_SIG_BRANCH << 28) | (cond << 20) | (1 << 19) | (QPU_R_NOP << 6) | QPU_R_NOP;
+		return true;
+	}
+
+	QPUASM_ALU a = { .sig = QPU_SIG_NONE, .condAdd = 0, .condMul = 0, .waddrAdd = QPU_R_NOP, .waddrMul = QPU_R_NOP,
+		.raddrA = QPU_R_NOP, .raddrB = QPU_R_NOP, .wsWant = -1, .pmWant = -1, .err = err };
+	char* parts[4];
+	int n = 0;
+	for (char* p = s; (p) && (n < 4); ) {
+		char* semi = strchr(p, ';');
+		if (semi) *semi = '\0';
+		parts[n++] = QPUAsm_Trim(p);
+		p = semi ? semi + 1 : NULL;
+	}
+
+	if ((strncmp(parts[0], "ldi", 3) == 0) && ((parts[0][3] == '.') || isspace((unsigned char)parts[0][3]))) {
+		uint32_t value = 0;
+		for (int i = 0; i < n; i++) {								// ldi dst, value [; ldi dst2, value]
+			char* t = parts[i];
+			if ((strncmp(t, "ldi", 3) != 0) || (i > 1)) return QPUAsm_Error(err, "Only ldi can go with ldi", t);
+			char* sp = t + 3;
+			while ((*sp) && (!isspace((unsigned char)*sp))) sp++;
+			char* rest = sp;
+			if (*sp) *rest++ = '\0';
+			uint32_t cond, v;
+			bool setf, isFloat;
+			if (!QPUAsm_OpName(t, &cond, &setf, err)) return false;
+			char* ops[4];
+			if ((QPUAsm_Operands(rest, ops) != 2) || (!QPUAsm_Number(ops[1], &v, &isFloat)))
+				return QPUAsm_Error(err, "Bad ldi", source);
+			if ((i == 1) && (v != value)) return QPUAsm_Error(err, "ldi of two values", source);
+			value = v;
+			bool mul = (i == 1) || ((n == 1) && (QPUAsm_Find(qpuWriteA, 32, ops[0]) < 0)
+				&& (QPUAsm_Find(qpuWriteB, 32, ops[0]) >= 0));		// A lone regfile B peripheral goes out the mul side
+			if (!QPUAsm_Write(&a, ops[0], mul)) return false;
+			if (setf) a.sf = 1;
+			if (mul) a.condMul = cond; else a.condAdd = cond;
+		}
+		if (a.pmWant == 0) return QPUAsm_Error(err, "No add pack on ldi", source);
+		*lo = value;
+		*hi = (QPU_SIG_LDI << 28) | ((a.pmWant > 0) << 24) | (a.pack << 20) | (a.condAdd << 17) | (a.condMul << 14)
+			| (a.sf << 13) | ((a.wsWant > 0) << 12) | (a.waddrAdd << 6) | a.waddrMul;
+		return true;
+	}
+
+	int ops = 0;
+	char* opText[2] = { NULL, NULL };
+	for (int i = 0; i < n; i++) {
+		int sig = QPUAsm_Find(qpuSignals, 16, parts[i]);
+		if ((i == 2) && (strcmp(parts[i], "nop") == 0)) continue;	// "nop; nop; nop" is no signal
+		if ((sig >= 0) && (parts[i][0])) {
+			if (a.sig != QPU_SIG_NONE) return QPUAsm_Error(err, "Two signals", parts[i]);
+			a.sig = sig;
+		} else if (ops < 2) opText[ops++] = parts[i];
+		else return QPUAsm_Error(err, "Too many ops", parts[i]);
+	}
+	if ((ops == 1) && (QPUAsm_IsMulOnly(opText[0]))) {				// A lone mul op goes to the mul ALU
+		opText[1] = opText[0];
+		opText[0] = NULL;
+	}
+	uint32_t sigBefore = a.sig;
+	if ((opText[0]) && (!QPUAsm_Op(&a, opText[0], false))) return false;
+	if ((opText[1]) && (!QPUAsm_Op(&a, opText[1], true))) return false;
+	if ((a.sig == QPU_SIG_SMALLIMM) && (sigBefore != QPU_SIG_NONE)) return QPUAsm_Error(err, "Small immediate and signal", source);
+	a.unpack = a.unpackWant;
+	a.pm = (a.pmWant > 0);
+	*hi = (a.sig << 28) | (a.unpack << 25) | (a.pm << 24) | (a.pack << 20) | (a.condAdd << 17) | (a.condMul << 14)
+		| (a.sf << 13) | ((a.wsWant > 0) << 12) | (a.waddrAdd << 6) | a.waddrMul;
+	*lo = (a.opMul << 29) | (a.opAdd << 24) | (a.raddrA << 18) | (a.raddrB << 12) | (a.addA << 9) | (a.addB << 6)
+		| (a.mulA << 3) | a.mulB;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Assembles a whole source text, two passes so branches can go forward.     }
+{ RETURN: True assembled, False with prog->error and errorLine set          }
+{--------------------------------------------------------------------------*/
+static inline bool QPUAsm_Assemble (QPUASM_PROGRAM* prog, const char* source)
+{
+	memset(prog, 0, sizeof(QPUASM_PROGRAM));
+	for (int pass = 0; pass < 2; pass++) {
+		const char* p = source;
+		int lineNo = 0;
+		prog->count = 0;
+		prog->lineCount = 0;
+		while (*p) {
+			char line[256];
+			size_t len = strcspn(p, "\n");
+			size_t copy = (len < sizeof(line) - 1) ? len : sizeof(line) - 1;
+			memcpy(line, p, copy);
+			line[copy] = '\0';
+			p += len + (p[len] == '\n');
+			lineNo++;
+			char* comment = strchr(line, '#');
+			if (comment) *comment++ = '\0';
+			char* text = QPUAsm_Trim(line);
+			if (!text[0]) continue;
+			QPUASM_LINE* l = &prog->lines[prog->lineCount];
+			size_t tl = strlen(text);
+			if (text[tl - 1] == ':') {								// Label
+				text[tl - 1] = '\0';
+				if (pass == 0) {
+					if ((prog->labelCount >= QPUASM_MAX_LABELS) || (tl > 31)) {
+						prog->errorLine = lineNo;
+						return QPUAsm_Error(prog->error, "Too many labels or too long", text);
+					}
+					for (uint32_t i = 0; i < prog->labelCount; i++)
+						if (strcmp(prog->labelName[i], text) == 0) {
+							prog->errorLine = lineNo;
+							return QPUAsm_Error(prog->error, "Label defined twice", text);
+						}
+					strcpy(prog->labelName[prog->labelCount], text);
+					prog->labelInstr[prog->labelCount++] = prog->count;
+				}
+				l->instr = -1;
+			} else {
+				if (prog->count >= QPUASM_MAX_INSTR) {
+					prog->errorLine = lineNo;
+					return QPUAsm_Error(prog->error, "Program too long at", text);
+				}
+				uint32_t lo = 0, hi = 0;
+				if ((pass == 1) && (!QPUAsm_Instruction(text, prog->count, prog, &lo, &hi, prog->error))) {
+					prog->errorLine = lineNo;
+					return false;
+				}
+				prog->words[prog->count * 2] = lo;
+				prog->words[prog->count * 2 + 1] = hi;
+				l->instr = prog->count++;
+			}
+			snprintf(l->text, QPUASM_TEXT, "%s", text);
+			snprintf(l->comment, QPUASM_TEXT, "%s", comment ? QPUAsm_Trim(comment) : "");
+			prog->lineCount++;
+		}
+	}
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Disassembly of a read, dst or op.                                         }
+{--------------------------------------------------------------------------*/
+static inline void QPUAsm_ReadName (char* out, size_t size, uint32_t mux, uint32_t raddrA, uint32_t raddrB,
+	uint32_t sig, uint32_t unpack, uint32_t pm, bool shift, bool raw)
+{
+	if (mux < 6) {
+		snprintf(out, size, "r%u%s%s", (unsigned)mux, ((mux == 4) && pm && unpack) ? "." : "",
+			((mux == 4) && pm && unpack) ? qpuUnpack[unpack] : "");
+		return;
+	}
+	if ((mux == 7) && (sig == QPU_SIG_SMALLIMM)) {
+		uint32_t imm = raddrB;
+		if ((imm < 16) || ((shift) && (imm < 32))) snprintf(out, size, "%u", (unsigned)imm);
+		else if (imm < 32) snprintf(out, size, "%d", (int)imm - 32);
+		else if (imm < 40) snprintf(out, size, "%u.0", 1u << (imm - 32));
+		else if (imm < 48) snprintf(out, size, "%g", 1.0 / (double)(256 >> (imm - 40)));
+		else snprintf(out, size, "?");								// Vector rotate, .word only
+		return;
+	}
+	uint32_t addr = (mux == 6) ? raddrA : raddrB;
+	const char* name = (addr >= 32) ? ((mux == 6) ? qpuReadA : qpuReadB)[addr - 32] : NULL;
+	const char* up = ((mux == 6) && (!pm) && unpack) ? qpuUnpack[unpack] : "";
+	if ((name) && (!raw)) snprintf(out, size, "%s%s%s", name, up[0] ? "." : "", up);
+	else snprintf(out, size, "r%c%u%s%s", (mux == 6) ? 'a' : 'b', (unsigned)addr, up[0] ? "." : "", up);
+}
+
+static inline void QPUAsm_WriteName (char* out, size_t size, uint32_t waddr, bool fileB, uint32_t pack, bool raw)
+{
+	const char* p = pack ? qpuPackA[pack] : "";
+	if ((waddr < 32) || (raw)) snprintf(out, size, "r%c%u%s%s", fileB ? 'b' : 'a', (unsigned)waddr, p[0] ? "." : "", p);
+	else snprintf(out, size, "%s%s%s", (fileB ? qpuWriteB : qpuWriteA)[waddr - 32], p[0] ? "." : "", p);
+}
+
+static inline void QPUAsm_OpText (char* out, size_t size, bool mul, uint32_t op, uint32_t cond, bool setf,
+	const char* dst, const char* a, const char* b)
+{
+	const char* name = mul ? qpuMulOps[op & 7] : qpuAddOps[op];
+	if (!name) name = "?";
+	bool mov = (strcmp(a, b) == 0) && (mul ? (op == 4) : (op == 21));
+	bool unary = (!mul) && ((op == 7) || (op == 8) || (op == 23) || (op == 24));
+	char opName[32];
+	snprintf(opName, sizeof(opName), "%s%s%s%s", mov ? "mov" : name, (cond != 1) ? "." : "", (cond != 1) ? qpuConds[cond] : "",
+		setf ? ".setf" : "");
+	if ((mov) || (unary && (strcmp(a, b) == 0))) snprintf(out, size, "%s %s, %s", opName, dst, a);
+	else snprintf(out, size, "%s %s, %s, %s", opName, dst, a, b);
+}
+
+/*--------------------------------------------------------------------------}
+{ Writes one instruction as text, index is where it sits for branches.      }
+{ Falls back to raw register numbers, then .word, so the text always       }
+{ assembles back to the same words.                                        }
+{--------------------------------------------------------------------------*/
+static inline void QPUAsm_Disassemble (uint32_t lo, uint32_t hi, uint32_t index, char* text, size_t size)
+{
+	uint32_t sig = hi >> 28, unpack = (hi >> 25) & 7, pm = (hi >> 24) & 1, pack = (hi >> 20) & 15;
+	uint32_t condAdd = (hi >> 17) & 7, condMul = (hi >> 14) & 7, sf = (hi >> 13) & 1, ws = (hi >> 12) & 1;
+	uint32_t waddrAdd = (hi >> 6) & 63, waddrMul = hi & 63;
+	for (int raw = 0; raw < 2; raw++) {
+		char out[400] = "";
+		if (sig == QPU_SIG_BRANCH) {
+			uint32_t cond = (hi >> 20) & 15;
+			int32_t target = (int32_t)lo / 8 + 4;
+			if ((qpuBranchConds[cond]) && (hi & (1 << 19)) && (!(hi & (1 << 18))))
+				snprintf(out, sizeof(out), "brr%s%s .%c%d", cond == 15 ? "" : ".", qpuBranchConds[cond],
+					target < 0 ? '-' : '+', target < 0 ? -target : target);
+		} else if (sig == QPU_SIG_LDI) {
+			char dA[32], dM[32];
+			QPUAsm_WriteName(dA, sizeof(dA), waddrAdd, ws, pm ? 0 : pack, raw);
+			QPUAsm_WriteName(dM, sizeof(dM), waddrMul, !ws, pm ? pack : 0, raw);
+			if ((waddrAdd == QPU_R_NOP) && (condAdd == 0) && (waddrMul != QPU_R_NOP))
+				snprintf(out, sizeof(out), "ldi%s%s%s %s, 0x%08x", (condMul != 1) ? "." : "",
+					(condMul != 1) ? qpuConds[condMul] : "", sf ? ".setf" : "", dM, (unsigned)lo);
+			else {
+				int n = snprintf(out, sizeof(out), "ldi%s%s%s %s, 0x%08x", (condAdd != 1) ? "." : "",
+					(condAdd != 1) ? qpuConds[condAdd] : "", sf ? ".setf" : "", dA, (unsigned)lo);
+				if (waddrMul != QPU_R_NOP)
+					snprintf(out + n, sizeof(out) - n, "; ldi%s%s %s, 0x%08x", (condMul != 1) ? "." : "",
+						(condMul != 1) ? qpuConds[condMul] : "", dM, (unsigned)lo);
+			}
+		} else {
+			uint32_t opMul = lo >> 29, opAdd = (lo >> 24) & 31, raddrA = (lo >> 18) & 63, raddrB = (lo >> 12) & 63;
+			uint32_t addA = (lo >> 9) & 7, addB = (lo >> 6) & 7, mulA = (lo >> 3) & 7, mulB = lo & 7;
+			char addText[160] = "nop", mulText[160] = "nop", r1[32], r2[32], d[32];
+			bool sfAdd = sf && (opAdd != 0), sfMul = sf && (opAdd == 0);
+			if (opAdd) {
+				QPUAsm_WriteName(d, sizeof(d), waddrAdd, ws, pm ? 0 : pack, raw);
+				QPUAsm_ReadName(r1, sizeof(r1), addA, raddrA, raddrB, sig, unpack, pm, false, raw);
+				QPUAsm_ReadName(r2, sizeof(r2), addB, raddrA, raddrB, sig, unpack, pm, (opAdd >= 14) && (opAdd <= 17), raw);
+				QPUAsm_OpText(addText, sizeof(addText), false, opAdd, condAdd, sfAdd, d, r1, r2);
+			}
+			if (opMul) {
+				QPUAsm_WriteName(d, sizeof(d), waddrMul, !ws, pm ? pack : 0, raw);
+				QPUAsm_ReadName(r1, sizeof(r1), mulA, raddrA, raddrB, sig, unpack, pm, false, raw);
+				QPUAsm_ReadName(r2, sizeof(r2), mulB, raddrA, raddrB, sig, unpack, pm, false, raw);
+				QPUAsm_OpText(mulText, sizeof(mulText), true, opMul, condMul, sfMul, d, r1, r2);
+			}
+			const char* sigName = (sig < 13) ? qpuSignals[sig] : "";
+			if (sigName[0]) snprintf(out, sizeof(out), "%s; %s; %s", addText, mulText, sigName);
+			else if (opMul) snprintf(out, sizeof(out), "%s; %s", addText, mulText);
+			else snprintf(out, sizeof(out), "%s", addText);
+		}
+		uint32_t l2, h2;
+		char err[160];
+		if ((out[0]) && (QPUAsm_Instruction(out, index, NULL, &l2, &h2, err)) && (l2 == lo) && (h2 == hi)) {
+			snprintf(text, size, "%s", out);
+			return;
+		}
+	}
+	snprintf(text, size, ".word 0x%08x, 0x%08x", (unsigned)lo, (unsigned)hi);
+}
+
+/*--------------------------------------------------------------------------}
+{ Writes prog as the body of a C uint32_t array, low word then high word a  }
+{ line with the source in a comment, labels as comment lines. sourceName   }
+{ goes in the first line. RETURN: chars written (out is always ended)      }
+{--------------------------------------------------------------------------*/
+static inline size_t QPUAsm_Table (const QPUASM_PROGRAM* prog, const char* sourceName, char* out, size_t size)
+{
+	size_t n = 0;
+	#define QPUASM_PUT(...) do { int w = snprintf(out + n, (n < size) ? size - n : 0, __VA_ARGS__); \
+		if (w > 0) n += (size_t)w; } while (0)
+	QPUASM_PUT("/* Generated from %s by Host/QPUAs (make shaders), edit the .qasm not this */\n", sourceName);
+	for (uint32_t i = 0; i < prog->lineCount; i++) {
+		const QPUASM_LINE* l = &prog->lines[i];
+		if (l->instr < 0) {
+			QPUASM_PUT("\t/* %s: */\n", l->text);
+			continue;
+		}
+		bool last = ((uint32_t)l->instr == prog->count - 1);
+		QPUASM_PUT("\t0x%08x, 0x%08x%s\t/* %s%s%s%s */\n", (unsigned)prog->words[l->instr * 2],
+			(unsigned)prog->words[l->instr * 2 + 1], last ? "" : ",", l->text,
+			l->comment[0] ? " (" : "", l->comment, l->comment[0] ? ")" : "");
+	}
+	#undef QPUASM_PUT
+	if ((size) && (n >= size)) out[size - 1] = '\0';
+	return n;
+}
+
+#endif
@@ -0,0 +1,554 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for malloc
+#include <string.h>								// Needed for memset, memcmp
+#include <math.h>								// Needed for fabsf
+#include "rpi-QPUKernels.h"						// Library kernels and their C model
+#include "rpi-Texture.h"						// Texture layout for the texturing shader
+#include "QPUAsm.h"								// Assembler under test
+#include "QPUSim.h"								// Simulator under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPUCheck.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check of the QPU assembler, the simulator and the shaders.          }
+{                                                                           }
+{  QPUCheck file.qasm ...                                                   }
+{                                                                           }
+{  Assembler: instructions whose words are known from the old hand written }
+{  hex assemble to them, broken lines are refused, every .qasm given       }
+{  assembles, its generated .h is up to date and each instruction          }
+{  disassembles to text that assembles back to the same words.            }
+{                                                                           }
+{  Simulator: the library kernels run on 1, 5 and 12 simulated QPUs must   }
+{  write exactly what QPU_KernelModel does, and the renderer's colour and  }
+{  texture fragment shaders, coordinate and vertex shaders and the GUI's   }
+{  window compositing shader must give what the same sums in C give.      }
+{  Every run must be free of regfile hazards.                             }
+{  The instruction, slot and stall figures of each are printed.            }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define FAKE_VC4		0x40000000u				// Pretend VC4 address of the memory
+#define MEM_WORDS		(1 << 20)				// Pretend GPU memory (4MB)
+#define GUARD			0xDEADBEEFu				// Fill of memory nothing should write
+#define MAX_RUN			2000000					// Instructions a run may take
+
+/* The shaders SetupRenderer loads */
+static const uint32_t colourFrag[] = {
+#include "Shaders/ColourFrag.h"
+};
+static const uint32_t textureFrag[] = {
+#include "Shaders/TextureFrag.h"
+};
+static const uint32_t coordShader[] = {
+#include "Shaders/Coord.h"
+};
+static const uint32_t vertexShader[] = {
+#include "Shaders/Vertex.h"
+};
+
+/* GL_GUI_STEP1's window compositing shader */
+static const uint32_t compositeFrag[] = {
+#include "../GL_GUI_STEP1/Shaders/Composite.h"
+};
+
+static int failures = 0;
+static uint32_t* mem = NULL;					// The pretend GPU memory
+
+static void Check (bool ok, const char* what)
+{
+	printf("  %-60s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok) failures++;
+}
+
+static uint32_t rng = 12345;
+static uint32_t Random (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return rng;
+}
+
+static float RandomFloat (void)
+{
+	return (float)(Random() >> 8) / (float)(1 << 24) * 2.0f - 1.0f;	// -1 to 1
+}
+
+static void* FakeToPtr (uint32_t vc4Addr)
+{
+	return &mem[(vc4Addr - FAKE_VC4) / 4];
+}
+
+static uint32_t FakeVC4 (const void* p)
+{
+	return FAKE_VC4 + (uint32_t)((const uint32_t*)p - mem) * 4;
+}
+
+static uint32_t FloatBits (float f)
+{
+	union { float f; uint32_t u; } b = { .f = f };
+	return b.u;
+}
+
+static char* LoadFile (const char* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* text = malloc(size + 1);
+	if ((text) && (fread(text, 1, size, f) == (size_t)size)) text[size] = '\0';
+	else {
+		free(text);
+		text = NULL;
+	}
+	fclose(f);
+	return text;
+}
+
+/*--------------------------------------------------------------------------}
+{ Assembler: words of the old hand written hex and lines that must fail.    }
+{--------------------------------------------------------------------------*/
+static const struct { const char* text; uint32_t lo, hi; } known[] = {
+	{ "mov r0, vary; mov r3.8d, 1.0", 0x958e0dbf, 0xd1724823 },
+	{ "fadd r0, r0, r5; mov r1, vary; sbwait", 0x818e7176, 0x40024821 },
+	{ "fadd r2, r2, r5; mov r3.8a, r0", 0x819e7540, 0x114248a3 },
+	{ "mov tlbz, rb15", 0x159cffc0, 0x10020b27 },
+	{ "mov tlbc, r3; nop; thrend", 0x159e76c0, 0x30020ba7 },
+	{ "nop; nop; sbdone", 0x009e7000, 0x500009e7 },
+	{ "nop; nop; ldtmu0", 0x009e7000, 0xa00009e7 },
+	{ "ldi vr_setup, 0x00301a00", 0x00301a00, 0xe0020c67 },
+	{ "ldi vw_setup, 0x00001a00", 0x00001a00, 0xe00049f1 },
+	{ "mov recip, r3; mov ra7, r3", 0x959e76db, 0x10025d07 },
+	{ "ftoi r0, r0; fmul r1, r1, 16.0", 0x279e400f, 0xd0024821 },
+	{ "shr r0, r0, 16", 0x0e9d01c0, 0xd0020827 },
+	{ "fsub r3, 1.0, r2", 0x029e0e80, 0xd00208e7 },
+	{ "or vw_setup, ra0, r2", 0x15027c80, 0x10021c67 },
+	{ "add ra1, ra1, r2; mov -, vw_wait", 0x8c072cbf, 0x10024067 },
+	{ "sub.setf r1, r1, 1", 0x0d9c13c0, 0xd0022867 },
+	{ "mov host_int, 1", 0x159c1fc0, 0xd00209a7 },
+	{ "nop; mul24 r3, ra11, rb16", 0x402d0037, 0x100049e3 },
+};
+
+static const char* const broken[] = {
+	"fadd r0, ra1, ra2",						// Two regfile A reads
+	"fadd r0, r1, 2.0; fmul r1, r1, 4.0",		// Two small immediates
+	"mov r0, 3; nop; thrend",					// Small immediate and a signal
+	"fadd rb0, r0, r1; fmul rb1, r0, r1",		// Both ALUs write regfile B
+	"fadd r0, r0",								// Operand missing
+	"fmov r0, r1",								// No such op
+	"mov r0, 17",								// Not a small immediate
+	"mov r0, unif; nop; thrend; sbdone",		// Two signals
+	"brr.allz nowhere",							// Unknown label
+	"mov r0.8a, r1",							// Add pack to an accumulator
+	"ldi r0, 1; ldi r1, 2",						// Two values
+};
+
+static bool KnownGood (void)
+{
+	for (size_t i = 0; i < sizeof(known) / sizeof(known[0]); i++) {
+		uint32_t lo, hi;
+		char err[160];
+		if (!QPUAsm_Instruction(known[i].text, 0, NULL, &lo, &hi, err) || (lo != known[i].lo) || (hi != known[i].hi)) {
+			printf("    %s gave 0x%08x, 0x%08x %s\n", known[i].text, (unsigned)lo, (unsigned)hi, err);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool BrokenRefused (void)
+{
+	for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); i++) {
+		uint32_t lo, hi;
+		char err[160];
+		if (QPUAsm_Instruction(broken[i], 0, NULL, &lo, &hi, err)) {
+			printf("    %s was taken\n", broken[i]);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* Every instruction disassembles to text that assembles to the same words */
+static bool RoundTrip (const uint32_t* words, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		char text[200], err[160];
+		uint32_t lo, hi;
+		QPUAsm_Disassemble(words[i * 2], words[i * 2 + 1], i, text, sizeof(text));
+		if (!QPUAsm_Instruction(text, i, NULL, &lo, &hi, err) || (lo != words[i * 2]) || (hi != words[i * 2 + 1])
+			|| (strncmp(text, ".word", 5) == 0)) {
+			printf("    %u: %s\n", (unsigned)i, text);
+			return false;
+		}
+	}
+	return true;
+}
+
+/* A .qasm assembles, the .h beside it is what it assembles to and round trips */
+static void SourceGood (const char* name)
+{
+	static QPUASM_PROGRAM prog;
+	static char table[256 * (QPUASM_MAX_INSTR + QPUASM_MAX_LABELS)];
+	char what[200], header[512];
+	const char* base = strrchr(name, '/');
+	base = base ? base + 1 : name;
+	char* source = LoadFile(name);
+	bool ok = (source) && QPUAsm_Assemble(&prog, source);
+	if ((source) && (!ok)) printf("    %s:%d: %s\n", name, prog.errorLine, prog.error);
+	free(source);
+	snprintf(what, sizeof(what), "%s assembles", base);
+	Check(ok, what);
+	if (!ok) return;
+	snprintf(header, sizeof(header), "%.*s.h", (int)(strlen(name) - 5), name);
+	char* current = LoadFile(header);
+	QPUAsm_Table(&prog, base, table, sizeof(table));
+	snprintf(what, sizeof(what), "%.*s.h is up to date (else make shaders)", (int)(strlen(base) - 5), base);
+	Check((current) && (strcmp(current, table) == 0), what);
+	free(current);
+	snprintf(what, sizeof(what), "%s disassembles and assembles back", base);
+	Check(RoundTrip(prog.words, prog.count), what);
+}
+
+/*--------------------------------------------------------------------------}
+{ Library kernels, memory is src (srcWords), dst (dstWords) and a guard.   }
+{ The model and the simulator each run the streams from the same start.    }
+{--------------------------------------------------------------------------*/
+static uint32_t* src;
+static uint32_t* dst;
+static uint32_t srcWords, dstWords;
+
+static void Layout (uint32_t srcCount, uint32_t dstCount)
+{
+	srcWords = srcCount;
+	dstWords = dstCount;
+	src = mem;
+	dst = mem + srcWords;
+	for (uint32_t i = 0; i < srcWords; i++) src[i] = Random();
+	for (uint32_t i = 0; i < dstWords + 64; i++) dst[i] = GUARD;
+}
+
+static void Hazards (const QPU_SIM* sim)
+{
+	for (uint32_t i = 0; (i < sim->stats.hazards) && (i < QPUSIM_HAZARDS); i++)
+		printf("    hazard at instruction %u\n", (unsigned)sim->hazardAt[i]);
+}
+
+typedef uint32_t (*MAKE_STREAMS) (uint32_t* unif, uint32_t qpus);
+
+static bool KernelGood (const QPU_KERNEL* k, MAKE_STREAMS make, QPUSIM_STATS* total)
+{
+	static uint32_t unif[QPU_MAX * 16];
+	static const uint32_t counts[3] = { 1, 5, QPU_MAX };
+	uint32_t* start = malloc((srcWords + dstWords + 64) * 4);
+	uint32_t* expect = malloc((srcWords + dstWords + 64) * 4);
+	memcpy(start, mem, (srcWords + dstWords + 64) * 4);
+	bool ok = true;
+	for (int c = 0; (c < 3) && ok; c++) {
+		uint32_t used = make(unif, counts[c]);
+		memcpy(mem, start, (srcWords + dstWords + 64) * 4);
+		for (uint32_t q = 0; q < used; q++) QPU_KernelModel(k, &unif[q * k->uniforms], FakeToPtr);
+		memcpy(expect, mem, (srcWords + dstWords + 64) * 4);
+		memcpy(mem, start, (srcWords + dstWords + 64) * 4);
+		memset(total, 0, sizeof(QPUSIM_STATS));
+		for (uint32_t q = 0; (q < used) && ok; q++) {
+			static QPU_SIM sim;
+			QPUSim_Init(&sim, k->code, k->codeWords);
+			sim.uniforms = &unif[q * k->uniforms];
+			sim.uniformCount = k->uniforms;
+			sim.qpuNum = q;
+			sim.mem = (uint8_t*)mem;
+			sim.memVC4 = FAKE_VC4;
+			sim.memSize = MEM_WORDS * 4;
+			ok = QPUSim_Run(&sim, MAX_RUN) && (sim.hostInt == 1) && (sim.stats.hazards == 0);
+			if (!ok) printf("    %s QPU %u: %s\n", k->name, (unsigned)q, sim.error);
+			Hazards(&sim);
+			QPUSim_AddStats(total, &sim.stats);
+		}
+		ok = ok && (memcmp(mem, expect, (srcWords + dstWords + 64) * 4) == 0);
+	}
+	free(start);
+	free(expect);
+	return ok;
+}
+
+static uint32_t count, width, height;
+static float a;
+static float w[9];
+
+static uint32_t MemsetStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_MemsetUniforms(unif, qpus, FakeVC4(dst), 0x12345678, count);
+}
+
+static uint32_t MemcpyStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_MemcpyUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), count);
+}
+
+static uint32_t SaxpyStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_SaxpyUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), a, count);
+}
+
+static uint32_t ConvStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_Conv3x3Uniforms(unif, qpus, FakeVC4(dst), width, FakeVC4(src), width + 2, width, height, w);
+}
+
+static uint32_t YuvStreams (uint32_t* unif, uint32_t qpus)
+{
+	return QPU_RgbToYuvUniforms(unif, qpus, FakeVC4(dst), FakeVC4(src), count);
+}
+
+static void Kernels (void)
+{
+	QPUSIM_STATS stats[5];
+	count = 16 * 100;
+	Layout(16, count);
+	Check(KernelGood(&QPU_KernelMemset, MemsetStreams, &stats[0]), "memset 1600 words");
+	Layout(count, count);
+	Check(KernelGood(&QPU_KernelMemcpy, MemcpyStreams, &stats[1]), "memcpy 1600 words");
+	a = RandomFloat();
+	Layout(count, count);
+	for (uint32_t i = 0; i < 2 * count; i++) ((float*)mem)[i] = RandomFloat();
+	Check(KernelGood(&QPU_KernelSaxpy, SaxpyStreams, &stats[2]), "saxpy 1600 floats");
+	width = 48;
+	height = 30;
+	for (int j = 0; j < 9; j++) w[j] = RandomFloat();
+	Layout((width + 2) * (height + 2), width * height);
+	for (uint32_t i = 0; i < srcWords; i++) ((float*)src)[i] = RandomFloat();
+	Check(KernelGood(&QPU_KernelConv3x3, ConvStreams, &stats[3]), "conv3x3 48x30");
+	Layout(count, count);
+	Check(KernelGood(&QPU_KernelRgbToYuv, YuvStreams, &stats[4]), "rgb2yuv 1600 pixels");
+	printf("  On 12 QPUs, all QPUs added:\n");
+	QPUSim_PrintStats("memset", &stats[0]);
+	QPUSim_PrintStats("memcpy", &stats[1]);
+	QPUSim_PrintStats("saxpy", &stats[2]);
+	QPUSim_PrintStats("conv3x3", &stats[3]);
+	QPUSim_PrintStats("rgb2yuv", &stats[4]);
+}
+
+/*--------------------------------------------------------------------------}
+{ Renderer shaders.                                                         }
+{--------------------------------------------------------------------------*/
+static void SimSetup (QPU_SIM* sim, const uint32_t* code, uint32_t words, const uint32_t* unif, uint32_t n)
+{
+	QPUSim_Init(sim, code, words);
+	sim->uniforms = unif;
+	sim->uniformCount = n;
+	sim->mem = (uint8_t*)mem;
+	sim->memVC4 = FAKE_VC4;
+	sim->memSize = MEM_WORDS * 4;
+}
+
+/* Colour shader: r,g,b varyings (value + C) packed with alpha 255, Z kept */
+static bool ColourFragGood (QPUSIM_STATS* stats)
+{
+	static QPU_SIM sim;
+	SimSetup(&sim, colourFrag, sizeof(colourFrag) / 4, NULL, 0);
+	sim.varyingCount = 3;
+	for (int v = 0; v < 3; v++) {
+		sim.varyC[v] = 0.25f * v;
+		for (int i = 0; i < QPUSIM_LANES; i++) sim.vary[v][i] = (float)i / 40.0f;
+	}
+	for (int i = 0; i < QPUSIM_LANES; i++) sim.regB[15][i] = 0x100 * i + 7;
+	bool ok = QPUSim_Run(&sim, MAX_RUN) && (sim.tlbColourWrites == 1) && (sim.tlbZWrites == 1) && (sim.stats.hazards == 0);
+	for (int i = 0; (i < QPUSIM_LANES) && ok; i++) {
+		uint32_t c = 0xFF000000;
+		for (int v = 0; v < 3; v++) {
+			float f = (float)i / 40.0f + 0.25f * v;
+			c |= (uint32_t)(f * 255.0f + 0.5f) << (v * 8);
+		}
+		ok = (sim.tlbColour[i] == c) && (sim.tlbZ[i] == 0x100u * i + 7);
+	}
+	if (sim.error[0]) printf("    %s\n", sim.error);
+	*stats = sim.stats;
+	return ok;
+}
+
+/* Texture shader: s,t varyings sample the nearest texel of a 64x32 T-format texture */
+static bool TextureFragGood (QPUSIM_STATS* stats)
+{
+	static QPU_SIM sim;
+	TEXTURE_LAYOUT layout;
+	if (!Texture_Layout(&layout, 64, 32, false)) return false;
+	uint32_t* texels = malloc(64 * 32 * 4);
+	for (int i = 0; i < 64 * 32; i++) texels[i] = Random();
+	uint32_t* texture = mem + 4096;									// 16K on, 4K aligned
+	Texture_Swizzle(texture, &layout.level[0], texels, 64);
+	uint32_t unif[2] = { FakeVC4(texture), (64 << 8) | (32 << 20) };	// Base and type RGBA8888, size
+	SimSetup(&sim, textureFrag, sizeof(textureFrag) / 4, unif, 2);
+	sim.varyingCount = 3;
+	for (int i = 0; i < QPUSIM_LANES; i++) {
+		sim.vary[0][i] = (i * 4 + 0.5f) / 64.0f;
+		sim.vary[1][i] = (i * 2 + 0.5f) / 32.0f - 1.0f;				// Repeat wrap
+		sim.vary[2][i] = 0.0f;
+	}
+	bool ok = QPUSim_Run(&sim, MAX_RUN) && (sim.tlbColourWrites == 1) && (sim.stats.hazards == 0) && (sim.unifPos == 2);
+	for (int i = 0; (i < QPUSIM_LANES) && ok; i++) ok = (sim.tlbColour[i] == texels[(i * 2) * 64 + i * 4]);
+	if (sim.error[0]) printf("    %s\n", sim.error);
+	free(texels);
+	*stats = sim.stats;
+	return ok;
+}
+
+/* Composite shader: the nearest texel blended over the tile colour by its alpha */
+static bool CompositeFragGood (QPUSIM_STATS* stats)
+{
+	static QPU_SIM sim;
+	TEXTURE_LAYOUT layout;
+	if (!Texture_Layout(&layout, 40, 24, false)) return false;		// Window sizes need not be powers of 2
+	uint32_t* texels = malloc(40 * 24 * 4);
+	for (int i = 0; i < 40 * 24; i++) texels[i] = Random();
+	texels[0] |= 0xFF000000;										// Opaque and clear texels in the samples
+	texels[40 * 1 + 1] &= 0x00FFFFFF;
+	uint32_t* texture = mem + 4096;
+	Texture_Swizzle(texture, &layout.level[0], texels, 40);
+	uint32_t unif[2] = { FakeVC4(texture), (1 << 0) | (1 << 2) | (1 << 4) | (1 << 7) | (40 << 8) | (24 << 20) };	// Clamp, nearest
+	SimSetup(&sim, compositeFrag, sizeof(compositeFrag) / 4, unif, 2);
+	sim.varyingCount = 2;
+	for (int i = 0; i < QPUSIM_LANES; i++) {
+		sim.vary[0][i] = (i + 0.5f) / 40.0f;
+		sim.vary[1][i] = (i + 0.5f) / 24.0f;
+		sim.tileColour[i] = Random();
+	}
+	bool ok = QPUSim_Run(&sim, MAX_RUN) && (sim.tlbColourWrites == 1) && (sim.stats.hazards == 0) && (sim.unifPos == 2);
+	for (int i = 0; (i < QPUSIM_LANES) && ok; i++) {
+		uint32_t src = texels[i * 40 + i], dst = sim.tileColour[i], a = src >> 24, c = 0;
+		for (int b = 0; b < 32; b += 8) {
+			uint32_t s = ((src >> b) & 0xFF) * a + 128, d = ((dst >> b) & 0xFF) * (255 - a) + 128;
+			s = (s + (s >> 8)) >> 8;
+			d = (d + (d >> 8)) >> 8;
+			c |= ((s + d > 255) ? 255 : s + d) << b;
+		}
+		ok = (sim.tlbColour[i] == c);
+	}
+	ok = ok && (sim.tlbColour[0] == texels[0]) && (sim.tlbColour[1] == sim.tileColour[1]);
+	if (sim.error[0]) printf("    %s\n", sim.error);
+	free(texels);
+	*stats = sim.stats;
+	return ok;
+}
+
+/* Coordinate and vertex shader: the matrix times x,y,z from VPM rows 0-2 */
+static bool TransformGood (const uint32_t* code, uint32_t words, bool vertex, QPUSIM_STATS* stats)
+{
+	static QPU_SIM sim;
+	float m[16];
+	uint32_t unif[16];
+	for (int i = 0; i < 16; i++) {
+		m[i] = RandomFloat() * 100.0f;
+		unif[i] = FloatBits(m[i]);
+	}
+	m[15] = 300.0f;															// Keep W away from 0
+	unif[15] = FloatBits(m[15]);
+	SimSetup(&sim, code, words, unif, 16);
+	float in[3][QPUSIM_LANES];
+	for (int r = 0; r < 3; r++)
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			in[r][i] = RandomFloat() * 50.0f;
+			sim.vpm[r][i] = FloatBits(in[r][i]);
+		}
+	bool ok = QPUSim_Run(&sim, MAX_RUN) && (sim.stats.hazards == 0) && (sim.unifPos == 16);
+	for (int i = 0; (i < QPUSIM_LANES) && ok; i++) {
+		float c[4];
+		for (int r = 0; r < 4; r++)
+			c[r] = ((in[0][i] * m[r * 4] + in[1][i] * m[r * 4 + 1]) + in[2][i] * m[r * 4 + 2]) + m[r * 4 + 3];
+		float rw = 1.0f / c[3];
+		uint32_t xs = (uint32_t)(int32_t)(c[0] * rw * 16.0f) & 0xFFFF, ys = (uint32_t)(int32_t)(c[1] * rw * 16.0f) << 16;
+		float zs = c[2] * rw;
+		uint32_t expect[10];
+		int n = 0;
+		if (!vertex) for (int r = 0; r < 4; r++) expect[n++] = FloatBits(c[r]);
+		expect[n++] = xs | ys;
+		expect[n++] = FloatBits(zs);
+		expect[n++] = FloatBits(rw);
+		if (vertex) for (int r = 0; r < 3; r++) expect[n++] = FloatBits(1.0f - zs);
+		for (int r = 0; r < n; r++)
+			if (sim.vpm[r][i] != expect[r]) ok = false;
+	}
+	if (sim.error[0]) printf("    %s\n", sim.error);
+	Hazards(&sim);
+	*stats = sim.stats;
+	return ok;
+}
+
+/* A regfile read straight after its write is a hazard with the old value, */
+/* r4 read the instruction after the SFU write stalls 2 slots.            */
+static bool HazardsCaught (void)
+{
+	static const char source[] =
+		"mov ra0, 5\n"
+		"mov ra0, 7\n"
+		"mov r0, ra0			# hazard, reads 5\n"
+		"mov recip, 4.0\n"
+		"mov r1, r4			# stalls 2 for 0.25\n"
+		"mov host_int, 1\n"
+		"nop; nop; thrend\n"
+		"nop\n"
+		"nop\n";
+	static QPUASM_PROGRAM prog;
+	static QPU_SIM sim;
+	if (!QPUAsm_Assemble(&prog, source)) return false;
+	SimSetup(&sim, prog.words, prog.count * 2, NULL, 0);
+	return QPUSim_Run(&sim, MAX_RUN) && (sim.stats.hazards == 1) && (sim.hazardAt[0] == 2) && (sim.acc[0][3] == 5)
+		&& (sim.stats.stallSfu == 2) && (sim.acc[1][0] == FloatBits(0.25f)) && (sim.stats.slots == sim.stats.instructions + 2);
+}
+
+static void Shaders (void)
+{
+	QPUSIM_STATS stats[5];
+	Check(ColourFragGood(&stats[0]), "colour fragment shader");
+	Check(TextureFragGood(&stats[1]), "texture fragment shader");
+	Check(TransformGood(coordShader, sizeof(coordShader) / 4, false, &stats[2]), "coordinate shader");
+	Check(TransformGood(vertexShader, sizeof(vertexShader) / 4, true, &stats[3]), "vertex shader");
+	Check(CompositeFragGood(&stats[4]), "GUI window composite shader");
+	QPUSim_PrintStats("colour frag", &stats[0]);
+	QPUSim_PrintStats("texture frag", &stats[1]);
+	QPUSim_PrintStats("coordinate", &stats[2]);
+	QPUSim_PrintStats("vertex", &stats[3]);
+	QPUSim_PrintStats("composite frag", &stats[4]);
+}
+
+int main (int argc, char* argv[])
+{
+	mem = malloc(MEM_WORDS * 4);
+	if (!mem) return 1;
+	printf("Assembler\n");
+	Check(KnownGood(), "old hand written hex reproduced");
+	Check(BrokenRefused(), "broken instructions refused");
+	for (int i = 1; i < argc; i++) SourceGood(argv[i]);
+
+	printf("Simulator\n");
+	Check(HazardsCaught(), "regfile hazard and SFU stall caught");
+
+	printf("Simulated library kernels against the C model on 1, 5 and 12 QPUs\n");
+	Kernels();
+
+	printf("Simulated renderer shaders against C\n");
+	Shaders();
+
+	free(mem);
+	printf("\n%s\n", failures ? "QPU CHECK FAILED" : "All QPU checks good");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for malloc, strtoul
+#include <string.h>								// Needed for strcmp, strtok
+#include "QPUAsm.h"								// Assembler
+#include "QPUSim.h"								// Simulator
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPURun.c													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Runs a .qasm on the simulated QPU and prints what it did.               }
+{                                                                           }
+{  QPURun file.qasm [-u u0,u1..] [-v v0,v1..] [-q qpu] [-t]                 }
+{     -u  the uniform stream, integers or floats (with a point)            }
+{     -v  varyings, every element reads the value and r5 gets 0            }
+{     -q  the QPU number qpu_num reads                                      }
+{     -t  trace every instruction with its issue slot                      }
+{                                                                           }
+{  Memory is 1MB of zeros at VC4 address 0x40000000 for TMU lookups and    }
+{  DMA. A fragment shader sees rb15 (Z) 0, ra15 (W) 1.0 and the 16        }
+{  elements as 2x2 quads of a 4x4 block at x_coord/y_coord 0-3.            }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define MEM_VC4			0x40000000u				// Where the memory sits
+#define MEM_BYTES		(1 << 20)				// 1MB
+#define MAX_RUN			10000000				// Instructions before giving up
+
+static char* LoadFile (const char* name)
+{
+	FILE* f = fopen(name, "rb");
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	char* text = malloc(size + 1);
+	if ((text) && (fread(text, 1, size, f) == (size_t)size)) text[size] = '\0';
+	else {
+		free(text);
+		text = NULL;
+	}
+	fclose(f);
+	return text;
+}
+
+/* Comma list of numbers to values, RETURN: count or -1 on a bad number */
+static int Values (char* list, uint32_t* out, int max)
+{
+	int n = 0;
+	for (char* tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+		bool isFloat;
+		if ((n >= max) || (!QPUAsm_Number(QPUAsm_Trim(tok), &out[n], &isFloat))) return -1;
+		n++;
+	}
+	return n;
+}
+
+int main (int argc, char* argv[])
+{
+	static QPUASM_PROGRAM prog;
+	static QPU_SIM sim;
+	static uint32_t unif[1024], vary[QPUSIM_MAX_VARY];
+	int unifCount = 0, varyCount = 0;
+	uint32_t qpu = 0;
+	bool trace = false;
+	const char* name = NULL;
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-u") == 0) && (i + 1 < argc)) unifCount = Values(argv[++i], unif, 1024);
+		else if ((strcmp(argv[i], "-v") == 0) && (i + 1 < argc)) varyCount = Values(argv[++i], vary, QPUSIM_MAX_VARY);
+		else if ((strcmp(argv[i], "-q") == 0) && (i + 1 < argc)) qpu = strtoul(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "-t") == 0) trace = true;
+		else if (argv[i][0] != '-') name = argv[i];
+		else name = NULL, i = argc;
+	}
+	if ((!name) || (unifCount < 0) || (varyCount < 0)) {
+		printf("usage: QPURun file.qasm [-u u0,u1..] [-v v0,v1..] [-q qpu] [-t]\n");
+		return 1;
+	}
+	char* source = LoadFile(name);
+	if (!source) {
+		printf("Can't read %s\n", name);
+		return 1;
+	}
+	if (!QPUAsm_Assemble(&prog, source)) {
+		fprintf(stderr, "%s:%d: %s\n", name, prog.errorLine, prog.error);
+		free(source);
+		return 1;
+	}
+	free(source);
+
+	QPUSim_Init(&sim, prog.words, prog.count * 2);
+	sim.uniforms = unif;
+	sim.uniformCount = unifCount;
+	sim.qpuNum = qpu;
+	sim.trace = trace;
+	sim.mem = calloc(MEM_BYTES, 1);
+	sim.memVC4 = MEM_VC4;
+	sim.memSize = MEM_BYTES;
+	sim.varyingCount = varyCount;
+	for (int v = 0; v < varyCount; v++)
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			union { uint32_t u; float f; } b = { .u = vary[v] };
+			sim.vary[v][i] = b.f;
+		}
+	for (int i = 0; i < QPUSIM_LANES; i++) {
+		sim.regA[15][i] = 0x3F800000;								// W 1.0
+		sim.xCoord[i] = (i & 1) | ((i >> 1) & 2);
+		sim.yCoord[i] = ((i >> 1) & 1) | ((i >> 2) & 2);
+	}
+	bool ok = QPUSim_Run(&sim, MAX_RUN);
+	printf("%s: %u instructions\n", name, (unsigned)prog.count);
+	QPUSim_PrintStats(ok ? "ran" : "stopped", &sim.stats);
+	printf("  uniforms %u  varyings %u  TMU %u  SFU %u  VPM reads %u writes %u  DMA words %u  branches %u\n",
+		(unsigned)sim.stats.uniforms, (unsigned)sim.stats.varyings, (unsigned)sim.stats.tmuLookups,
+		(unsigned)sim.stats.sfuOps, (unsigned)sim.stats.vpmReads, (unsigned)sim.stats.vpmWrites,
+		(unsigned)sim.stats.dmaWords, (unsigned)sim.stats.branches);
+	for (uint32_t i = 0; (i < sim.stats.hazards) && (i < QPUSIM_HAZARDS); i++)
+		printf("  hazard: regfile read the instruction after its write at %u\n", (unsigned)sim.hazardAt[i]);
+	if (sim.tlbColourWrites) printf("  tile colour %08x %08x %08x %08x ...\n", (unsigned)sim.tlbColour[0],
+		(unsigned)sim.tlbColour[1], (unsigned)sim.tlbColour[2], (unsigned)sim.tlbColour[3]);
+	if (sim.tlbZWrites) printf("  tile Z      %08x %08x %08x %08x ...\n", (unsigned)sim.tlbZ[0],
+		(unsigned)sim.tlbZ[1], (unsigned)sim.tlbZ[2], (unsigned)sim.tlbZ[3]);
+	if (sim.hostInt) printf("  host interrupt %u\n", (unsigned)sim.hostInt);
+	if (!ok) printf("  %s\n", sim.error);
+	free(sim.mem);
+	return ok ? 0 : 1;
+}
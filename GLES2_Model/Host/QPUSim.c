@@ -0,0 +1,742 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf, snprintf
+#include <string.h>								// Needed for memset, memcpy
+#include <math.h>								// Needed for sqrtf, exp2f, log2f
+#include "rpi-Texture.h"						// Texel layout for texture lookups
+#include "QPUAsm.h"								// Disassembly for the trace
+#include "QPUSim.h"								// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPUSim.c													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  QPU simulator, see QPUSim.h. Floats are flushed to zero on the way in   }
+{  and out as the QPU does, the SFU answers are exact (the hardware's are  }
+{  good to about 1 part in 2^22). Flag C is the carry of add, the borrow   }
+{  of sub and clear for everything else.                                   }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+typedef union { uint32_t u; float f; } BITS;
+
+static float F (uint32_t u)
+{
+	BITS b = { .u = u };
+	if ((b.u & 0x7F800000) == 0) b.u &= 0x80000000;				// Denormals read as zero
+	return b.f;
+}
+
+static uint32_t U (float f)
+{
+	BITS b = { .f = f };
+	if ((b.u & 0x7F800000) == 0) b.u &= 0x80000000;				// Denormals written as zero
+	return b.u;
+}
+
+static float HalfToFloat (uint32_t h)
+{
+	uint32_t s = (h >> 15) & 1, e = (h >> 10) & 0x1F, m = h & 0x3FF;
+	float f = (e == 0) ? 0.0f : (e == 31) ? INFINITY : ldexpf((float)(m | 0x400), (int)e - 25);
+	return s ? -f : f;
+}
+
+static uint32_t FloatToHalf (float f)
+{
+	uint32_t s = signbit(f) ? 0x8000 : 0;
+	f = fabsf(f);
+	if (f < 6.1035156e-05f) return s;								// Flush to zero
+	if (f >= 65520.0f) return s | 0x7C00;
+	int e;
+	float m = frexpf(f, &e);										// f = m * 2^e, m in [0.5, 1)
+	uint32_t mant = (uint32_t)(m * 2048.0f + 0.5f);				// 11 bits with the hidden one
+	if (mant == 2048) { mant = 1024; e++; }
+	return s | ((uint32_t)(e + 14) << 10) | (mant & 0x3FF);
+}
+
+static bool Fail (QPU_SIM* sim, const char* msg)
+{
+	snprintf(sim->error, sizeof(sim->error), "instruction %u: %s", (unsigned)sim->pc, msg);
+	return false;
+}
+
+/*--------------------------------------------------------------------------}
+{ Memory of the pretend VC4 address space.                                  }
+{--------------------------------------------------------------------------*/
+static uint32_t* Mem (QPU_SIM* sim, uint32_t vc4, uint32_t bytes)
+{
+	if ((vc4 & 3) || (vc4 < sim->memVC4) || (vc4 - sim->memVC4 > sim->memSize)
+		|| (sim->memSize - (vc4 - sim->memVC4) < bytes)) return NULL;
+	return (uint32_t*)&sim->mem[vc4 - sim->memVC4];
+}
+
+/*--------------------------------------------------------------------------}
+{ Unpack of a regfile A or r4 read for an op working on floats or ints.     }
+{--------------------------------------------------------------------------*/
+static uint32_t Unpack (uint32_t v, uint32_t unpack, bool isFloat)
+{
+	switch (unpack) {
+		case 1:														// 16a
+		case 2:														// 16b
+			v = (unpack == 1) ? (v & 0xFFFF) : (v >> 16);
+			return isFloat ? U(HalfToFloat(v)) : (uint32_t)(int32_t)(int16_t)v;
+		case 3:														// 8dr
+			v >>= 24;
+			return isFloat ? U((float)v / 255.0f) : v * 0x01010101;
+		case 4: case 5: case 6: case 7:								// 8a-8d
+			v = (v >> ((unpack - 4) * 8)) & 0xFF;
+			return isFloat ? U((float)v / 255.0f) : v;
+	}
+	return v;
+}
+
+/* Float to colour byte as the mul pack does */
+static uint32_t ColourByte (uint32_t v)
+{
+	float f = F(v);
+	if (!(f > 0.0f)) return 0;
+	if (f >= 1.0f) return 255;
+	return (uint32_t)(f * 255.0f + 0.5f);
+}
+
+/*--------------------------------------------------------------------------}
+{ The ALU ops.                                                              }
+{--------------------------------------------------------------------------*/
+static bool AddOpIsFloat (uint32_t op)
+{
+	return ((op >= 1) && (op <= 7));								// ftoi reads a float
+}
+
+static uint32_t AddOp (uint32_t op, uint32_t a, uint32_t b, bool* carry)
+{
+	*carry = false;
+	switch (op) {
+		case 1: return U(F(a) + F(b));
+		case 2: return U(F(a) - F(b));
+		case 3: return U(fminf(F(a), F(b)));
+		case 4: return U(fmaxf(F(a), F(b)));
+		case 5: return U(fminf(fabsf(F(a)), fabsf(F(b))));
+		case 6: return U(fmaxf(fabsf(F(a)), fabsf(F(b))));
+		case 7: {
+			float f = F(a);
+			return ((f > -2147483648.0f) && (f < 2147483648.0f)) ? (uint32_t)(int32_t)f : 0;
+		}
+		case 8: return U((float)(int32_t)a);
+		case 12: *carry = ((uint64_t)a + b) > 0xFFFFFFFFull; return a + b;
+		case 13: *carry = (a < b); return a - b;
+		case 14: return a >> (b & 31);
+		case 15: return (uint32_t)((int32_t)a >> (b & 31));
+		case 16: return (b & 31) ? (a >> (b & 31)) | (a << (32 - (b & 31))) : a;
+		case 17: return a << (b & 31);
+		case 18: return ((int32_t)a < (int32_t)b) ? a : b;
+		case 19: return ((int32_t)a > (int32_t)b) ? a : b;
+		case 20: return a & b;
+		case 21: return a | b;
+		case 22: return a ^ b;
+		case 23: return ~a;
+		case 24: return (a == 0) ? 32 : (uint32_t)__builtin_clz(a);
+		case 30:
+		case 31: {
+			uint32_t r = 0;
+			for (int i = 0; i < 32; i += 8) {
+				int x = (a >> i) & 0xFF, y = (b >> i) & 0xFF;
+				int s = (op == 30) ? x + y : x - y;
+				r |= (uint32_t)((s < 0) ? 0 : (s > 255) ? 255 : s) << i;
+			}
+			return r;
+		}
+	}
+	return 0;
+}
+
+static uint32_t MulOp (uint32_t op, uint32_t a, uint32_t b)
+{
+	if (op == 1) return U(F(a) * F(b));
+	if (op == 2) return (a & 0xFFFFFF) * (b & 0xFFFFFF);
+	uint32_t r = 0;
+	for (int i = 0; i < 32; i += 8) {
+		int x = (a >> i) & 0xFF, y = (b >> i) & 0xFF, s = 0;
+		switch (op) {
+			case 3: s = x * y + 128; s = (s + (s >> 8)) >> 8; break;	// x * y / 255 rounded
+			case 4: s = (x < y) ? x : y; break;
+			case 5: s = (x > y) ? x : y; break;
+			case 6: s = x + y; break;
+			case 7: s = x - y; break;
+		}
+		r |= (uint32_t)((s < 0) ? 0 : (s > 255) ? 255 : s) << i;
+	}
+	return r;
+}
+
+static bool Cond (const QPU_SIM* sim, uint32_t cond, int lane)
+{
+	switch (cond) {
+		case 1: return true;
+		case 2: return sim->flagZ[lane];
+		case 3: return !sim->flagZ[lane];
+		case 4: return sim->flagN[lane];
+		case 5: return !sim->flagN[lane];
+		case 6: return sim->flagC[lane];
+		case 7: return !sim->flagC[lane];
+	}
+	return false;
+}
+
+/*--------------------------------------------------------------------------}
+{ Reads of the peripheral registers (raddr 32-63), once per instruction.    }
+{--------------------------------------------------------------------------*/
+static bool ReadSpecial (QPU_SIM* sim, uint32_t addr, bool fileB, uint32_t* out)
+{
+	switch (addr) {
+		case 32: {													// unif
+			uint32_t v;
+			if (sim->unifFromMem) {
+				uint32_t* p = Mem(sim, sim->unifAddr, 4);
+				if (!p) return Fail(sim, "uniform address outside memory");
+				v = *p;
+				sim->unifAddr += 4;
+			} else {
+				if (sim->unifPos >= sim->uniformCount) return Fail(sim, "read past the end of the uniforms");
+				v = sim->uniforms[sim->unifPos++];
+			}
+			sim->stats.uniforms++;
+			for (int i = 0; i < QPUSIM_LANES; i++) out[i] = v;
+			return true;
+		}
+		case 35:													// vary, C goes to r5 at the end
+			if (sim->varyPos >= sim->varyingCount) return Fail(sim, "read past the last varying");
+			for (int i = 0; i < QPUSIM_LANES; i++) out[i] = U(sim->vary[sim->varyPos][i]);
+			sim->stats.varyings++;
+			return true;
+		case 38:													// elem_num / qpu_num
+			for (int i = 0; i < QPUSIM_LANES; i++) out[i] = fileB ? sim->qpuNum : (uint32_t)i;
+			return true;
+		case 41:													// x_coord / y_coord
+			memcpy(out, fileB ? sim->yCoord : sim->xCoord, sizeof(uint32_t) * QPUSIM_LANES);
+			return true;
+		case 48:													// vpm
+			if (sim->vprLeft == 0) return Fail(sim, "VPM read with no read setup left");
+			memcpy(out, sim->vpm[sim->vprAddr % QPUSIM_VPM_ROWS], sizeof(uint32_t) * QPUSIM_LANES);
+			sim->vprAddr += sim->vprStride;
+			sim->vprLeft--;
+			sim->stats.vpmReads++;
+			return true;
+		case 39:													// nop
+		case 49:													// vr_busy / vw_busy (waited on)
+		case 50:													// vr_wait / vw_wait
+		case 51:													// mutex acquire, one QPU always gets it
+		default:
+			memset(out, 0, sizeof(uint32_t) * QPUSIM_LANES);
+			return true;
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ VPM DMA, 32 bit horizontal only.                                          }
+{--------------------------------------------------------------------------*/
+static bool DmaLoad (QPU_SIM* sim, uint32_t addr)
+{
+	uint32_t s = sim->vdrSetup;
+	if ((s >> 28) & 7) return Fail(sim, "only 32 bit VPM DMA loads are simulated");
+	if (s & (1 << 11)) return Fail(sim, "only horizontal VPM DMA loads are simulated");
+	uint32_t rowLen = (s >> 20) & 15, rows = (s >> 16) & 15, vpitch = (s >> 12) & 15, mpitch = (s >> 24) & 15;
+	if (rowLen == 0) rowLen = 16;
+	if (rows == 0) rows = 16;
+	uint32_t pitch = (mpitch) ? (8u << mpitch) : sim->vdrPitch;
+	uint32_t y = (s >> 4) & 0x7F, x = s & 15;
+	for (uint32_t r = 0; r < rows; r++) {
+		uint32_t* p = Mem(sim, addr + r * pitch, rowLen * 4);
+		if (!p) return Fail(sim, "VPM DMA load outside memory");
+		for (uint32_t c = 0; c < rowLen; c++)
+			sim->vpm[(y + r * vpitch) % QPUSIM_VPM_ROWS][(x + c) & 15] = p[c];
+	}
+	sim->stats.dmaWords += rows * rowLen;
+	sim->vdrDone = sim->now + QPUSIM_DMA_LATENCY + rows * rowLen / 4;
+	return true;
+}
+
+static bool DmaStore (QPU_SIM* sim, uint32_t addr)
+{
+	uint32_t s = sim->vdwSetup;
+	if (s & 7) return Fail(sim, "only 32 bit VPM DMA stores are simulated");
+	if (!(s & (1 << 14))) return Fail(sim, "only horizontal VPM DMA stores are simulated");
+	uint32_t units = (s >> 23) & 0x7F, depth = (s >> 16) & 0x7F, y = (s >> 7) & 0x7F;
+	if (units == 0) units = 128;
+	if (depth == 0) depth = 128;
+	if (depth > QPUSIM_LANES) return Fail(sim, "VPM DMA store deeper than a row");
+	for (uint32_t u = 0; u < units; u++) {
+		uint32_t* p = Mem(sim, addr, depth * 4);
+		if (!p) return Fail(sim, "VPM DMA store outside memory");
+		memcpy(p, sim->vpm[(y + u) % QPUSIM_VPM_ROWS], depth * 4);
+		addr += depth * 4 + sim->vdwStride;
+	}
+	sim->stats.dmaWords += units * depth;
+	sim->vdwDone = sim->now + QPUSIM_DMA_LATENCY + units * depth / 4;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ TMU request from a write to tmuN_s, a texture sample when tmuN_t was     }
+{ written first (it then takes 2 config uniforms) else a direct lookup.    }
+{--------------------------------------------------------------------------*/
+static bool TmuRequest (QPU_SIM* sim, int tmu, const uint32_t* s)
+{
+	if (sim->tmuCount[tmu] >= QPUSIM_TMU_FIFO) return Fail(sim, "TMU request FIFO overflow");
+	uint32_t* out = sim->tmuData[tmu][(sim->tmuHead[tmu] + sim->tmuCount[tmu]) % QPUSIM_TMU_FIFO];
+	if (sim->tmuTSet[tmu]) {
+		uint32_t config[2];
+		for (int i = 0; i < 2; i++) {
+			uint32_t v[QPUSIM_LANES];
+			if (!ReadSpecial(sim, 32, false, v)) return false;
+			config[i] = v[0];
+		}
+		if ((config[0] >> 4) & 15) return Fail(sim, "only RGBA8888 textures are simulated");
+		uint32_t w = (config[1] >> 8) & 0x7FF, h = (config[1] >> 20) & 0x7FF;
+		TEXTURE_LAYOUT layout;
+		if (!Texture_Layout(&layout, w ? w : 2048, h ? h : 2048, false)) return Fail(sim, "bad texture size");
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			float fs = F(s[i]), ft = F(sim->tmuT[tmu][i]);			// Repeat wrap, nearest texel
+			fs -= floorf(fs);
+			ft -= floorf(ft);
+			uint32_t x = (uint32_t)(fs * layout.level[0].width), y = (uint32_t)(ft * layout.level[0].height);
+			if (x >= layout.level[0].width) x = layout.level[0].width - 1;
+			if (y >= layout.level[0].height) y = layout.level[0].height - 1;
+			uint32_t* p = Mem(sim, (config[0] & 0xFFFFF000) + Texture_TexelOffset(&layout.level[0], x, y), 4);
+			if (!p) return Fail(sim, "texture outside memory");
+			out[i] = *p;
+		}
+		sim->tmuTSet[tmu] = false;
+	} else {
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			uint32_t* p = Mem(sim, s[i], 4);
+			if (!p) return Fail(sim, "TMU lookup outside memory");
+			out[i] = *p;
+		}
+	}
+	sim->tmuReady[tmu][(sim->tmuHead[tmu] + sim->tmuCount[tmu]) % QPUSIM_TMU_FIFO] = sim->now + QPUSIM_TMU_LATENCY;
+	sim->tmuCount[tmu]++;
+	sim->stats.tmuLookups++;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ A write of 16 values to waddr, lanes is the bit mask of lanes written.   }
+{ Regfile writes wait in pending until the next instruction has read.      }
+{--------------------------------------------------------------------------*/
+static bool Write (QPU_SIM* sim, uint32_t waddr, bool fileB, uint32_t lanes, const uint32_t* v)
+{
+	if ((waddr == QPU_R_NOP) || (lanes == 0)) return true;
+	if (waddr < 32) {
+		if (sim->pendingCount >= 2) return Fail(sim, "more than 2 regfile writes");
+		int n = sim->pendingCount++;
+		sim->pending[n].file = fileB;
+		sim->pending[n].addr = waddr;
+		sim->pending[n].lanes = lanes;
+		memcpy(sim->pending[n].value, v, sizeof(uint32_t) * QPUSIM_LANES);
+		return true;
+	}
+	if ((waddr >= 32) && (waddr <= 37) && (waddr != 36)) {			// r0-r3, r5
+		for (int i = 0; i < QPUSIM_LANES; i++)
+			if (lanes & (1 << i)) sim->acc[waddr - 32][i] = (waddr == 37) ? v[fileB ? 0 : (i & ~3)] : v[i];
+		return true;
+	}
+	switch (waddr) {
+		case 38:													// host_int
+			sim->hostInt = v[0] ? v[0] : 1;
+			return true;
+		case 40:													// unif_addr
+			sim->unifAddr = v[0];
+			sim->unifFromMem = true;
+			return true;
+		case 44:													// tlbz
+			for (int i = 0; i < QPUSIM_LANES; i++) if (lanes & (1 << i)) sim->tlbZ[i] = v[i];
+			sim->tlbZWrites++;
+			return true;
+		case 45:													// tlbm, tlbc and tlbam
+		case 46:
+		case 47:
+			for (int i = 0; i < QPUSIM_LANES; i++) if (lanes & (1 << i)) sim->tlbColour[i] = v[i];
+			sim->tlbColourWrites++;
+			return true;
+		case 48:													// vpm, generic write
+			for (int i = 0; i < QPUSIM_LANES; i++)
+				if (lanes & (1 << i)) sim->vpm[sim->vpwAddr % QPUSIM_VPM_ROWS][i] = v[i];
+			sim->vpwAddr += sim->vpwStride;
+			sim->stats.vpmWrites++;
+			return true;
+		case 49:
+			if (!fileB) {											// vr_setup
+				if (v[0] >> 31) sim->vdrSetup = v[0];
+				else if ((v[0] >> 28) == 9) sim->vdrPitch = v[0] & 0x1FFF;
+				else {
+					if (((v[0] >> 8) & 3) != 2) return Fail(sim, "only 32 bit VPM reads are simulated");
+					if (!(v[0] & (1 << 11))) return Fail(sim, "only horizontal VPM reads are simulated");
+					sim->vprAddr = v[0] & 0x3F;
+					sim->vprStride = (v[0] >> 12) & 0x3F;
+					sim->vprLeft = (v[0] >> 20) & 15;
+					if (sim->vprLeft == 0) sim->vprLeft = 16;
+					sim->vprReady = sim->now + QPUSIM_VPM_LATENCY + 1;
+				}
+			} else {												// vw_setup
+				uint32_t id = v[0] >> 30;
+				if (id == 2) sim->vdwSetup = v[0];
+				else if (id == 3) sim->vdwStride = v[0] & 0x1FFF;
+				else {
+					if (((v[0] >> 8) & 3) != 2) return Fail(sim, "only 32 bit VPM writes are simulated");
+					if (!(v[0] & (1 << 11))) return Fail(sim, "only horizontal VPM writes are simulated");
+					sim->vpwAddr = v[0] & 0x3F;
+					sim->vpwStride = (v[0] >> 12) & 0x3F;
+				}
+			}
+			return true;
+		case 50:													// vr_addr / vw_addr start a DMA
+			return fileB ? DmaStore(sim, v[0]) : DmaLoad(sim, v[0]);
+		case 52: case 53: case 54: case 55:							// SFU
+			for (int i = 0; i < QPUSIM_LANES; i++) {
+				float f = F(v[i]);
+				f = (waddr == 52) ? 1.0f / f : (waddr == 53) ? 1.0f / sqrtf(f) : (waddr == 54) ? exp2f(f) : log2f(f);
+				sim->r4Pending[i] = U(f);
+			}
+			sim->r4Ready = sim->now + QPUSIM_SFU_LATENCY + 1;
+			sim->r4IsSfu = true;
+			sim->stats.sfuOps++;
+			return true;
+		case 56: case 60:											// tmuN_s
+		case 36:													// tmu_noswap
+			return TmuRequest(sim, (waddr == 60), v);
+		case 57: case 61:											// tmuN_t
+			memcpy(sim->tmuT[waddr == 61], v, sizeof(uint32_t) * QPUSIM_LANES);
+			sim->tmuTSet[waddr == 61] = true;
+			return true;
+		case 58: case 59: case 62: case 63:							// r and b, not used by 2D nearest
+		case 41: case 42: case 43: case 51:							// quad, flags, stencil, mutex release
+			return true;
+	}
+	return Fail(sim, "write to an unknown address");
+}
+
+/* Puts the SFU answer in r4 once it has landed */
+static void SettleR4 (QPU_SIM* sim)
+{
+	if ((sim->r4IsSfu) && (sim->now >= sim->r4Ready)) {
+		memcpy(sim->acc[4], sim->r4Pending, sizeof(sim->acc[4]));
+		sim->r4IsSfu = false;
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ Stall before the instruction issues, waiting for what it reads.           }
+{--------------------------------------------------------------------------*/
+static void Stall (QPU_SIM* sim, uint32_t ready, uint32_t* counter)
+{
+	if (ready > sim->now) {
+		uint32_t wait = ready - sim->now;
+		*counter += wait;
+		sim->stats.slots += wait;
+		sim->now = ready;
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ One instruction.                                                          }
+{--------------------------------------------------------------------------*/
+static bool Step (QPU_SIM* sim)
+{
+	if (sim->pc >= sim->codeInstructions) return Fail(sim, "ran off the end of the code");
+	uint32_t lo = sim->code[sim->pc * 2], hi = sim->code[sim->pc * 2 + 1];
+	uint32_t sig = hi >> 28, unpack = (hi >> 25) & 7, pm = (hi >> 24) & 1, pack = (hi >> 20) & 15;
+	uint32_t condAdd = (hi >> 17) & 7, condMul = (hi >> 14) & 7, sf = (hi >> 13) & 1, ws = (hi >> 12) & 1;
+	uint32_t waddrAdd = (hi >> 6) & 63, waddrMul = hi & 63;
+	uint32_t opMul = lo >> 29, opAdd = (lo >> 24) & 31, raddrA = (lo >> 18) & 63, raddrB = (lo >> 12) & 63;
+	uint32_t mux[4] = { (lo >> 9) & 7, (lo >> 6) & 7, (lo >> 3) & 7, lo & 7 };
+
+	if (sim->trace) {
+		char text[200];
+		QPUAsm_Disassemble(lo, hi, sim->pc, text, sizeof(text));
+		printf("%5u %4u: %s\n", (unsigned)sim->now, (unsigned)sim->pc, text);
+	}
+	if (sig == QPU_SIG_BKPT) return Fail(sim, "breakpoint");
+	if ((sig == QPU_SIG_LOADCV) || (sig == QPU_SIG_LDCEND) || (sig == QPU_SIG_LOADAM)) return Fail(sim, "signal not simulated");
+
+	/* Stalls for what this instruction waits on */
+	bool alu = (sig < QPU_SIG_LDI);
+	bool readsR4 = false;
+	for (int i = 0; (alu) && (i < 4); i++)
+		if ((mux[i] == 4) && ((i < 2) ? opAdd : opMul)) readsR4 = true;
+	if ((readsR4) && (sim->r4IsSfu)) Stall(sim, sim->r4Ready, &sim->stats.stallSfu);
+	if ((alu) && (sig != QPU_SIG_SMALLIMM) && ((raddrA == 48) || (raddrB == 48))) Stall(sim, sim->vprReady, &sim->stats.stallVpm);
+	if ((alu) && (raddrA == 50)) Stall(sim, sim->vdrDone, &sim->stats.stallDma);
+	if ((alu) && (sig != QPU_SIG_SMALLIMM) && (raddrB == 50)) Stall(sim, sim->vdwDone, &sim->stats.stallDma);
+	if ((alu) && (((waddrAdd == 50) && (ws)) || ((waddrMul == 50) && (!ws)))) Stall(sim, sim->vdwDone, &sim->stats.stallDma);
+	if ((alu) && (((waddrAdd == 50) && (!ws)) || ((waddrMul == 50) && (ws)))) Stall(sim, sim->vdrDone, &sim->stats.stallDma);
+	if ((sig == QPU_SIG_LDTMU0) || (sig == QPU_SIG_LDTMU1)) {
+		int t = sig - QPU_SIG_LDTMU0;
+		if (sim->tmuCount[t] == 0) return Fail(sim, "ldtmu with no TMU request");
+		Stall(sim, sim->tmuReady[t][sim->tmuHead[t]], &sim->stats.stallTmu);
+	}
+	SettleR4(sim);
+
+	uint32_t addOut[QPUSIM_LANES], mulOut[QPUSIM_LANES];
+	bool carry[QPUSIM_LANES] = { false };
+	uint32_t lanesAdd = 0, lanesMul = 0;
+	bool wroteR5 = false;
+
+	if (sig == QPU_SIG_BRANCH) {
+		uint32_t cond = (hi >> 20) & 15;
+		if ((hi >> 18) & 1) return Fail(sim, "register branches not simulated");
+		int z = 0, n = 0, c = 0;
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			z += sim->flagZ[i];
+			n += sim->flagN[i];
+			c += sim->flagC[i];
+		}
+		int count[3] = { z, n, c };
+		bool take = (cond == 15);
+		if (cond < 12) {
+			int set = count[cond / 4];
+			switch (cond & 3) {
+				case 0: take = (set == QPUSIM_LANES); break;			// all set
+				case 1: take = (set == 0); break;						// all clear
+				case 2: take = (set > 0); break;						// any set
+				case 3: take = (set < QPUSIM_LANES); break;				// any clear
+			}
+		} else if (cond != 15) return Fail(sim, "bad branch condition");
+		int32_t target = ((hi >> 19) & 1) ? (int32_t)(sim->pc + 4) + (int32_t)lo / 8 : (int32_t)(lo / 8);
+		uint32_t link[QPUSIM_LANES];
+		for (int i = 0; i < QPUSIM_LANES; i++) link[i] = (sim->pc + 4) * 8;
+		if (!Write(sim, waddrAdd, ws, 0xFFFF, link) || !Write(sim, waddrMul, !ws, 0xFFFF, link)) return false;
+		if (take) {
+			if ((target < 0) || ((uint32_t)target >= sim->codeInstructions)) return Fail(sim, "branch outside the code");
+			sim->branchTarget = target;
+			sim->branchSlots = 4;
+			sim->stats.branches++;
+		}
+	} else if (sig == QPU_SIG_LDI) {
+		uint32_t mode = unpack;
+		for (int i = 0; i < QPUSIM_LANES; i++) {
+			uint32_t v = lo;
+			if (mode == 1) v = (uint32_t)(((int32_t)((((lo >> (16 + i)) & 1) << 1) | ((lo >> i) & 1)) << 30) >> 30);
+			else if (mode == 3) v = (((lo >> (16 + i)) & 1) << 1) | ((lo >> i) & 1);
+			else if (mode != 0) return Fail(sim, "semaphore ldi not simulated");
+			addOut[i] = mulOut[i] = v;
+			if (Cond(sim, condAdd, i)) lanesAdd |= 1 << i;
+			if (Cond(sim, condMul, i)) lanesMul |= 1 << i;
+		}
+		if (sf) {
+			for (int i = 0; i < QPUSIM_LANES; i++)
+				if (lanesAdd & (1 << i)) {
+					sim->flagZ[i] = (addOut[i] == 0);
+					sim->flagN[i] = (addOut[i] >> 31);
+					sim->flagC[i] = false;
+				}
+		}
+	} else {
+		/* Regfile reads with the hazard check, peripherals once each */
+		uint32_t valA[QPUSIM_LANES], valB[QPUSIM_LANES];
+		bool usesA = false, usesB = false;
+		for (int i = 0; i < 4; i++) {
+			if (!((i < 2) ? opAdd : opMul)) continue;
+			if (mux[i] == 6) usesA = true;
+			if (mux[i] == 7) usesB = true;
+		}
+		if (raddrA < 32) memcpy(valA, sim->regA[raddrA], sizeof(valA));
+		else if (!ReadSpecial(sim, raddrA, false, valA)) return false;
+		if (sig == QPU_SIG_SMALLIMM) {
+			uint32_t imm = raddrB, v;
+			if (imm >= 48) return Fail(sim, "vector rotate not simulated");
+			if (imm < 16) v = imm;
+			else if (imm < 32) v = (uint32_t)((int32_t)imm - 32);
+			else if (imm < 40) v = U((float)(1 << (imm - 32)));
+			else v = U(1.0f / (float)(256 >> (imm - 40)));
+			for (int i = 0; i < QPUSIM_LANES; i++) valB[i] = v;
+		} else if (raddrB < 32) memcpy(valB, sim->regB[raddrB], sizeof(valB));
+		else if (!ReadSpecial(sim, raddrB, true, valB)) return false;
+		for (int p = 0; p < sim->pendingCount; p++) {
+			bool hit = (sim->pending[p].file == 0) ? ((usesA) && (raddrA == (uint32_t)sim->pending[p].addr))
+				: ((usesB) && (sig != QPU_SIG_SMALLIMM) && (raddrB == (uint32_t)sim->pending[p].addr));
+			if (hit) {
+				if (sim->stats.hazards < QPUSIM_HAZARDS) sim->hazardAt[sim->stats.hazards] = sim->pc;
+				sim->stats.hazards++;
+			}
+		}
+
+		/* The two ALUs */
+		for (int alu2 = 0; alu2 < 2; alu2++) {
+			uint32_t op = alu2 ? opMul : opAdd;
+			if (!op) continue;
+			bool isFloat = alu2 ? (op == 1) : AddOpIsFloat(op);
+			uint32_t cond = alu2 ? condMul : condAdd;
+			uint32_t* out = alu2 ? mulOut : addOut;
+			for (int i = 0; i < QPUSIM_LANES; i++) {
+				uint32_t in[2];
+				for (int k = 0; k < 2; k++) {
+					uint32_t m = mux[alu2 * 2 + k];
+					if (m < 6) in[k] = sim->acc[m][i];
+					else in[k] = (m == 6) ? valA[i] : valB[i];
+					if ((unpack) && (((m == 6) && (!pm)) || ((m == 4) && (pm)))) in[k] = Unpack(in[k], unpack, isFloat);
+				}
+				out[i] = alu2 ? MulOp(op, in[0], in[1]) : AddOp(op, in[0], in[1], &carry[i]);
+				if (Cond(sim, cond, i)) {
+					if (alu2) lanesMul |= 1 << i; else lanesAdd |= 1 << i;
+				}
+			}
+		}
+		if (sf) {
+			bool fromAdd = (opAdd != 0);
+			uint32_t* out = fromAdd ? addOut : mulOut;
+			uint32_t lanes = fromAdd ? lanesAdd : lanesMul;
+			bool isFloat = fromAdd ? ((opAdd >= 1) && (opAdd <= 6)) : (opMul == 1);
+			for (int i = 0; (fromAdd || opMul) && (i < QPUSIM_LANES); i++)
+				if (lanes & (1 << i)) {
+					sim->flagZ[i] = isFloat ? (F(out[i]) == 0.0f) : (out[i] == 0);
+					sim->flagN[i] = isFloat ? (F(out[i]) < 0.0f) : (out[i] >> 31);
+					sim->flagC[i] = fromAdd ? carry[i] : false;
+				}
+		}
+		if ((raddrA == 35) || ((sig != QPU_SIG_SMALLIMM) && (raddrB == 35))) {	// The varying's C to r5
+			for (int i = 0; i < QPUSIM_LANES; i++) sim->acc[5][i] = U(sim->varyC[sim->varyPos]);
+			sim->varyPos++;
+			wroteR5 = true;
+		}
+		if (!opAdd) lanesAdd = 0;
+		if (!opMul) lanesMul = 0;
+	}
+
+	/* Pack then the writes, regfile writes of the last instruction land first */
+	if (sig != QPU_SIG_BRANCH) {
+		if (pack) {
+			bool addToA = (waddrAdd < 32) && (!ws), mulToA = (waddrMul < 32) && (ws);
+			if ((!pm) && (pack > 7)) return Fail(sim, "saturating pack not simulated");
+			if ((pm) && ((pack < 3) || (pack > 7))) return Fail(sim, "mul pack not simulated");
+			for (int i = 0; i < QPUSIM_LANES; i++) {
+				if (pm) {
+					uint32_t b = ColourByte(mulOut[i]);
+					uint32_t old = (waddrMul < 32) ? (ws ? sim->regA : sim->regB)[waddrMul][i]
+						: ((waddrMul >= 32) && (waddrMul <= 35)) ? sim->acc[waddrMul - 32][i] : 0;
+					mulOut[i] = (pack == 3) ? b * 0x01010101 : (old & ~(0xFFu << ((pack - 4) * 8))) | (b << ((pack - 4) * 8));
+				} else {
+					for (int k = 0; k < 2; k++) {
+						if (!(k ? mulToA : addToA)) continue;
+						uint32_t* v = k ? &mulOut[i] : &addOut[i];
+						uint32_t old = sim->regA[k ? waddrMul : waddrAdd][i];
+						bool isFloat = k ? (opMul == 1) : (((opAdd >= 1) && (opAdd <= 6)) || (opAdd == 8));
+						uint32_t h = (isFloat) ? FloatToHalf(F(*v)) : (*v & 0xFFFF);
+						switch (pack) {
+							case 1: *v = (old & 0xFFFF0000) | h; break;
+							case 2: *v = (old & 0xFFFF) | (h << 16); break;
+							case 3: *v = (*v & 0xFF) * 0x01010101; break;
+							default: *v = (old & ~(0xFFu << ((pack - 4) * 8))) | ((*v & 0xFF) << ((pack - 4) * 8)); break;
+						}
+					}
+				}
+			}
+		}
+	}
+	for (int p = 0; p < sim->pendingCount; p++)
+		for (int i = 0; i < QPUSIM_LANES; i++)
+			if (sim->pending[p].lanes & (1 << i))
+				(sim->pending[p].file ? sim->regB : sim->regA)[sim->pending[p].addr][i] = sim->pending[p].value[i];
+	sim->pendingCount = 0;
+	if (sig != QPU_SIG_BRANCH) {
+		if ((waddrAdd == waddrMul) && (waddrAdd != QPU_R_NOP) && (waddrAdd >= 32) && (lanesAdd) && (lanesMul))
+			return Fail(sim, "both ALUs write the same peripheral");
+		if ((wroteR5) && (((waddrAdd == 37) && (lanesAdd)) || ((waddrMul == 37) && (lanesMul))))
+			return Fail(sim, "r5 written in the instruction reading a varying");
+		if (!Write(sim, waddrAdd, ws, lanesAdd, addOut) || !Write(sim, waddrMul, !ws, lanesMul, mulOut)) return false;
+	}
+
+	/* Signals that load r4 or end the thread */
+	if ((sig == QPU_SIG_LDTMU0) || (sig == QPU_SIG_LDTMU1)) {
+		int t = sig - QPU_SIG_LDTMU0;
+		memcpy(sim->acc[4], sim->tmuData[t][sim->tmuHead[t]], sizeof(sim->acc[4]));
+		sim->tmuHead[t] = (sim->tmuHead[t] + 1) % QPUSIM_TMU_FIFO;
+		sim->tmuCount[t]--;
+		sim->r4IsSfu = false;
+	} else if (sig == QPU_SIG_LOADC) memcpy(sim->acc[4], sim->tileColour, sizeof(sim->acc[4]));
+	else if (sig == QPU_SIG_THREND) {
+		if (sim->endSlots >= 0) return Fail(sim, "thrend in a thrend delay slot");
+		sim->endSlots = 3;
+	}
+	sim->stats.instructions++;
+	sim->stats.slots++;
+	sim->now++;
+	return true;
+}
+
+/*-[QPUSim_Init]------------------------------------------------------------}
+. Resets sim to run the program code (codeWords words) from its start with
+. everything zero, set the inputs in sim after this.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_Init (QPU_SIM* sim, const uint32_t* code, uint32_t codeWords)
+{
+	memset(sim, 0, sizeof(QPU_SIM));
+	sim->code = code;
+	sim->codeInstructions = codeWords / 2;
+	sim->endSlots = -1;
+}
+
+/*-[QPUSim_Run]-------------------------------------------------------------}
+. Runs the program until thrend and its 2 delay slots, at most
+. maxInstructions instructions.
+. RETURN: True the program ended, False with sim->error set
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool QPUSim_Run (QPU_SIM* sim, uint32_t maxInstructions)
+{
+	sim->error[0] = '\0';
+	for (uint32_t n = 0; n < maxInstructions; n++) {
+		if (!Step(sim)) return false;
+		if ((sim->endSlots > 0) && (--sim->endSlots == 0)) {
+			if (sim->pendingCount) {								// Last regfile writes land
+				for (int p = 0; p < sim->pendingCount; p++)
+					for (int i = 0; i < QPUSIM_LANES; i++)
+						if (sim->pending[p].lanes & (1 << i))
+							(sim->pending[p].file ? sim->regB : sim->regA)[sim->pending[p].addr][i] = sim->pending[p].value[i];
+				sim->pendingCount = 0;
+			}
+			sim->ended = true;
+			return true;
+		}
+		if ((sim->branchSlots > 0) && (--sim->branchSlots == 0)) sim->pc = sim->branchTarget;
+		else sim->pc++;
+	}
+	return Fail(sim, "did not end within the instruction limit");
+}
+
+/*-[QPUSim_AddStats]--------------------------------------------------------}
+. Adds the figures of src to total, for programs run on several QPUs.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_AddStats (QPUSIM_STATS* total, const QPUSIM_STATS* src)
+{
+	uint32_t* t = (uint32_t*)total;
+	const uint32_t* s = (const uint32_t*)src;
+	for (size_t i = 0; i < sizeof(QPUSIM_STATS) / sizeof(uint32_t); i++) t[i] += s[i];
+}
+
+/*-[QPUSim_PrintStats]------------------------------------------------------}
+. Prints the instruction, stall and hazard figures on one line.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_PrintStats (const char* name, const QPUSIM_STATS* stats)
+{
+	printf("  %-14s %7u instr %7u slots  stalls tmu %u sfu %u vpm %u dma %u  hazards %u\n", name,
+		(unsigned)stats->instructions, (unsigned)stats->slots, (unsigned)stats->stallTmu, (unsigned)stats->stallSfu,
+		(unsigned)stats->stallVpm, (unsigned)stats->stallDma, (unsigned)stats->hazards);
+}
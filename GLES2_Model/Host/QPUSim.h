@@ -0,0 +1,166 @@
+#ifndef _QPUSIM_
+#define _QPUSIM_
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: QPUSim.h													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host instruction level simulator of one VideoCore IV QPU running one    }
+{  thread: 16 elements, regfiles A and B, r0-r5, the flags, the uniform    }
+{  stream, varyings, VPM generic reads/writes and 32 bit horizontal DMA,   }
+{  TMU direct lookups and nearest level 0 RGBA8888 texture samples, the    }
+{  SFU, the tile buffer Z and colour writes, branches and thrend with      }
+{  their delay slots. Memory is one flat block at a pretend VC4 address.   }
+{                                                                           }
+{  Timing is approximate, counted in instructions (4 clocks each): every   }
+{  instruction issues in one slot and stalls when it needs a result not    }
+{  there yet, a TMU lookup, the SFU answer in r4, a VPM read after its     }
+{  setup or a DMA. The latencies are the assumed figures below, not        }
+{  measurements, good for comparing two versions of a shader.              }
+{                                                                           }
+{  A regfile write can not be read by the very next instruction, the       }
+{  simulator gives that read the old value (as the hardware does) and      }
+{  counts it as a hazard with where it happened.                           }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define QPUSIM_LANES			16				// Elements of a QPU
+#define QPUSIM_MAX_VARY			32				// Varyings a fragment shader can read
+#define QPUSIM_VPM_ROWS			64				// 32 bit VPM rows of 16 words
+#define QPUSIM_TMU_FIFO			8				// Lookups a TMU holds for one QPU
+#define QPUSIM_HAZARDS			8				// Hazard addresses kept
+
+/* Assumed latencies in instructions */
+#define QPUSIM_TMU_LATENCY		9				// TMU lookup hitting the L2 cache
+#define QPUSIM_SFU_LATENCY		2				// Instructions between the SFU write and r4
+#define QPUSIM_VPM_LATENCY		3				// VPM read setup to first read
+#define QPUSIM_DMA_LATENCY		16				// DMA start up, plus 1 per 4 words moved
+
+/* What a run did */
+typedef struct qpusim_stats {
+	uint32_t instructions;						// Instructions executed
+	uint32_t stallTmu;							// Slots waiting for TMU data (ldtmu)
+	uint32_t stallSfu;							// Slots waiting for the SFU answer in r4
+	uint32_t stallVpm;							// Slots waiting for VPM reads after a setup
+	uint32_t stallDma;							// Slots waiting for VPM DMA (vr_wait, vw_wait, busy DMA)
+	uint32_t slots;								// Instructions plus stalls, 4 clocks each
+	uint32_t hazards;							// Regfile reads in the instruction after the write
+	uint32_t uniforms;							// Uniforms read (by the QPU and the TMU)
+	uint32_t varyings;							// Varyings read
+	uint32_t tmuLookups;						// TMU requests
+	uint32_t sfuOps;							// SFU requests
+	uint32_t vpmReads;							// VPM rows read by the QPU
+	uint32_t vpmWrites;							// VPM rows written by the QPU
+	uint32_t dmaWords;							// Words moved by VPM DMA
+	uint32_t branches;							// Branches taken
+} QPUSIM_STATS;
+
+/* A QPU, set the inputs after QPUSim_Init */
+typedef struct qpu_sim {
+	/* Program and inputs */
+	const uint32_t* code;						// Instructions, low word then high word
+	uint32_t codeInstructions;					// Instructions in code
+	const uint32_t* uniforms;					// Uniform stream
+	uint32_t uniformCount;						// Uniforms in the stream
+	uint32_t qpuNum;							// QPU number read as qpu_num
+	uint32_t varyingCount;						// Varyings
+	float vary[QPUSIM_MAX_VARY][QPUSIM_LANES];	// Varying read, already times W
+	float varyC[QPUSIM_MAX_VARY];				// C the read puts in r5
+	uint32_t xCoord[QPUSIM_LANES];				// Pixel x read as x_coord
+	uint32_t yCoord[QPUSIM_LANES];				// Pixel y read as y_coord
+	uint32_t tileColour[QPUSIM_LANES];			// Colour loadc gives
+	uint8_t* mem;								// Memory the program's addresses point into
+	uint32_t memVC4;							// VC4 address of mem[0]
+	uint32_t memSize;							// Bytes of mem
+	bool trace;									// Print every instruction as it runs
+
+	/* Outputs */
+	uint32_t tlbZ[QPUSIM_LANES];				// Last Z written to the tile buffer
+	uint32_t tlbColour[QPUSIM_LANES];			// Last colour written to the tile buffer
+	uint32_t tlbZWrites;						// Tile buffer Z writes
+	uint32_t tlbColourWrites;					// Tile buffer colour writes
+	uint32_t hostInt;							// Last host interrupt value (0 none)
+	bool ended;									// thrend and its delay slots ran
+	QPUSIM_STATS stats;
+	uint32_t hazardAt[QPUSIM_HAZARDS];			// Instruction of the first hazards
+	char error[160];							// Why a run failed
+
+	/* Machine state */
+	uint32_t regA[32][QPUSIM_LANES];
+	uint32_t regB[32][QPUSIM_LANES];
+	uint32_t acc[6][QPUSIM_LANES];				// r0-r5
+	bool flagZ[QPUSIM_LANES], flagN[QPUSIM_LANES], flagC[QPUSIM_LANES];
+	uint32_t vpm[QPUSIM_VPM_ROWS][QPUSIM_LANES];
+	uint32_t pc;
+	uint32_t unifPos;							// Next uniform of the stream
+	uint32_t unifAddr;							// Next uniform in memory after unif_addr
+	bool unifFromMem;
+	uint32_t varyPos;							// Next varying
+	uint32_t now;								// Issue slot of the instruction running
+	uint32_t branchTarget;
+	int branchSlots;							// Delay slots to the branch, 0 none
+	int endSlots;								// Delay slots to the end after thrend, -1 running
+	/* Regfile writes of the last instruction, committed after this one reads */
+	struct { int file, addr; uint32_t lanes; uint32_t value[QPUSIM_LANES]; } pending[2];
+	int pendingCount;
+	uint32_t r4Ready;							// Slot the SFU answer lands in r4
+	uint32_t r4Pending[QPUSIM_LANES];
+	bool r4IsSfu;
+	/* TMU 0 and 1 */
+	uint32_t tmuData[2][QPUSIM_TMU_FIFO][QPUSIM_LANES];
+	uint32_t tmuReady[2][QPUSIM_TMU_FIFO];
+	uint32_t tmuHead[2], tmuCount[2];
+	uint32_t tmuT[2][QPUSIM_LANES];
+	bool tmuTSet[2];
+	/* VPM */
+	uint32_t vprAddr, vprStride, vprLeft, vprReady;
+	uint32_t vpwAddr, vpwStride;
+	uint32_t vdrSetup, vdrPitch, vdwSetup, vdwStride;
+	uint32_t vdrDone, vdwDone;
+} QPU_SIM;
+
+/*-[QPUSim_Init]------------------------------------------------------------}
+. Resets sim to run the program code (codeWords words) from its start with
+. everything zero, set the inputs in sim after this.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_Init (QPU_SIM* sim, const uint32_t* code, uint32_t codeWords);
+
+/*-[QPUSim_Run]-------------------------------------------------------------}
+. Runs the program until thrend and its 2 delay slots, at most
+. maxInstructions instructions.
+. RETURN: True the program ended, False with sim->error set
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool QPUSim_Run (QPU_SIM* sim, uint32_t maxInstructions);
+
+/*-[QPUSim_AddStats]--------------------------------------------------------}
+. Adds the figures of src to total, for programs run on several QPUs.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_AddStats (QPUSIM_STATS* total, const QPUSIM_STATS* src);
+
+/*-[QPUSim_PrintStats]------------------------------------------------------}
+. Prints the instruction, stall and hazard figures on one line.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPUSim_PrintStats (const char* name, const QPUSIM_STATS* stats);
+
+#endif
@@ -0,0 +1,457 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf, fopen
+#include <stdlib.h>								// Needed for malloc, atoi
+#include <string.h>								// Needed for memcmp, strcmp
+#include <math.h>								// Needed for sinf, cosf
+#include <time.h>								// Needed for clock_gettime
+#include <pthread.h>							// Needed for the tile render threads
+#include "rpi-V3DList.h"						// Binning lists the scenes are read from
+#include "rpi-SoftRaster.h"						// Rasteriser under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: RasterCheck.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check and benchmark of rpi-SoftRaster. Two scenes are built the way }
+{  the Pi code builds them, a GLES2_Model style mesh (a sphere of emit      }
+{  vertexes) and the GL_GUI_STEP1 overlapping window quads, each with an NV }
+{  shader record and a binning list in fake GPU memory which the rasteriser }
+{  reads through SoftRaster_SetupFromList.                                  }
+{                                                                           }
+{  Checks: a screen covered by a jittered mesh has every pixel drawn once,  }
+{  the tiled render is pixel for pixel the same as a plain whole screen     }
+{  loop over the triangles, and 1 to 8 threads give the same image. Then    }
+{  triangles/sec is measured for 1 to 8 threads.                            }
+{                                                                           }
+{  Usage: RasterCheck [-w file.ppm] [-g file.ppm] [width height rings]      }
+{         -w writes the model scene image, -g compares it to a golden one   }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define BENCH_MIN_NS	300000000ull			// Each thread count runs at least this long
+#define MAX_THREADS		8
+
+#define GPU_VC4			0x1E000000u				// Fake VC4 address of the fake GPU memory
+#define GPU_SIZE		0x2000000u				// 32MB of it
+static uint8_t* gpuMem;							// Host memory standing in for GPU memory
+static uint32_t gpuUsed;
+
+static void* ToARM (uint32_t vc4)
+{
+	return &gpuMem[vc4 - GPU_VC4];
+}
+
+static uint32_t GpuAlloc (uint32_t size)
+{
+	uint32_t addr = GPU_VC4 + ((gpuUsed + 15) & ~15u);
+	gpuUsed = addr - GPU_VC4 + size;
+	return addr;
+}
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* A scene in fake GPU memory as the Pi code leaves it */
+typedef struct mesh {
+	uint32_t width, height;						// Screen
+	uint32_t vertexVC4, vertexCount;			// Emit vertexes
+	uint32_t indexVC4, indexCount;				// 16 bit triangle indexes
+	uint32_t binStart, binSize;					// Binning list
+} MESH;
+
+/*--------------------------------------------------------------------------}
+{ Writes the NV shader record and binning list EmitFrameLists would for the }
+{ mesh (GL_GUI_STEP1 differs only in the list format and early Z flags).    }
+{--------------------------------------------------------------------------*/
+static void BuildLists (MESH* m)
+{
+	uint32_t binWth = (m->width + 63) / 64, binHt = (m->height + 63) / 64;
+	uint32_t record = GpuAlloc(16);
+	uint8_t* r = ToARM(record);
+	r[0] = 0x01;												// flags
+	r[1] = sizeof(SOFT_VERTEX);									// stride
+	r[2] = 0;													// num uniforms
+	r[3] = 3;													// num varyings
+	memset(&r[4], 0, 8);										// fragment shader and uniforms (not run here)
+	memcpy(&r[12], &m->vertexVC4, 4);							// vertex data
+
+	uint32_t tileAlloc = GpuAlloc(binWth * binHt * 64);
+	uint32_t tileState = GpuAlloc(binWth * binHt * 48);
+	V3D_LIST list;
+	m->binStart = GpuAlloc(0x80);
+	V3DList_Init(&list, ToARM(m->binStart), m->binStart, 0x80);
+	V3DList_TileBinningConfig(&list, tileAlloc, binWth * binHt * 64, tileState, binWth, binHt, 0x04);
+	V3DList_StartTileBinning(&list);
+	V3DList_PrimitiveListFormat(&list, 0x12);
+	V3DList_ClipWindow(&list, 0, 0, m->width, m->height);
+	V3DList_ConfigState(&list, 0x03, 0x00, 0x00);
+	V3DList_ViewportOffset(&list, 0, 0);
+	V3DList_NVShaderState(&list, record);
+	V3DList_IndexedPrimitiveList(&list, PRIM_TRIANGLE | INDEX_TYPE_16, m->indexCount, m->indexVC4, m->vertexCount - 1);
+	V3DList_FlushAllState(&list);
+	V3DList_Nop(&list);
+	V3DList_Halt(&list);
+	m->binSize = V3DList_Size(&list);
+}
+
+static void SetVertex (SOFT_VERTEX* v, float x, float y, float red, float green, float blue)
+{
+	v->x = (uint16_t)(x * 16.0f);								// 12.4 fixed point
+	v->y = (uint16_t)(y * 16.0f);
+	v->z = 0.5f;
+	v->w = 1.0f;
+	v->red = red;
+	v->green = green;
+	v->blue = blue;
+}
+
+/* GLES2_Model style: a sphere turned to the screen shaded like the QPU path by depth */
+static void BuildSphere (MESH* m, uint32_t width, uint32_t height, uint32_t rings)
+{
+	uint32_t segs = rings * 2;
+	float radius = (width < height ? width : height) * 0.45f;
+	m->width = width;
+	m->height = height;
+	m->vertexCount = (rings + 1) * (segs + 1);
+	m->indexCount = rings * segs * 6;
+	m->vertexVC4 = GpuAlloc(m->vertexCount * sizeof(SOFT_VERTEX));
+	m->indexVC4 = GpuAlloc(m->indexCount * 2);
+	SOFT_VERTEX* v = ToARM(m->vertexVC4);
+	uint16_t* ix = ToARM(m->indexVC4);
+	for (uint32_t i = 0; i <= rings; i++) {
+		float lat = 3.14159265f * i / rings;
+		for (uint32_t j = 0; j <= segs; j++) {
+			float lon = 6.2831853f * j / segs;
+			float x = sinf(lat) * cosf(lon), y = cosf(lat), z = sinf(lat) * sinf(lon);
+			float shade = 0.5f + 0.5f * z;						// Near is bright
+			SetVertex(v++, width * 0.5f + x * radius, height * 0.5f + (y * 0.9f + z * 0.3f) * radius,
+				shade, shade * 0.8f, 1.0f - shade);
+		}
+	}
+	for (uint32_t i = 0; i < rings; i++)
+		for (uint32_t j = 0; j < segs; j++) {
+			uint16_t a = i * (segs + 1) + j, b = a + segs + 1;
+			*ix++ = a; *ix++ = b; *ix++ = a + 1;
+			*ix++ = a + 1; *ix++ = b; *ix++ = b + 1;
+		}
+	BuildLists(m);
+}
+
+/* GL_GUI_STEP1 style: red, green and blue window quads, later ones on top */
+static void BuildWindows (MESH* m, uint32_t width, uint32_t height)
+{
+	static const float colour[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+	m->width = width;
+	m->height = height;
+	m->vertexCount = 12;
+	m->indexCount = 18;
+	m->vertexVC4 = GpuAlloc(m->vertexCount * sizeof(SOFT_VERTEX));
+	m->indexVC4 = GpuAlloc(m->indexCount * 2);
+	SOFT_VERTEX* v = ToARM(m->vertexVC4);
+	uint16_t* ix = ToARM(m->indexVC4);
+	for (int w = 0; w < 3; w++) {
+		float xa = width * (0.1f + 0.2f * w), ya = height * (0.1f + 0.2f * w);
+		float xb = xa + width * 0.45f, yb = ya + height * 0.45f;
+		SetVertex(&v[w * 4 + 0], xa, ya, colour[w][0], colour[w][1], colour[w][2]);
+		SetVertex(&v[w * 4 + 1], xb, ya, colour[w][0], colour[w][1], colour[w][2]);
+		SetVertex(&v[w * 4 + 2], xb, yb, colour[w][0], colour[w][1], colour[w][2]);
+		SetVertex(&v[w * 4 + 3], xa, yb, colour[w][0], colour[w][1], colour[w][2]);
+		uint16_t q = w * 4;										// quad as GL_GUI_STEP1 indexes it
+		*ix++ = q; *ix++ = q + 3; *ix++ = q + 1;
+		*ix++ = q + 3; *ix++ = q + 2; *ix++ = q + 1;
+	}
+	BuildLists(m);
+}
+
+/* A screen covering grid with the inside vertexes jittered so edges are every angle */
+static void BuildJitterGrid (MESH* m, uint32_t width, uint32_t height)
+{
+	uint32_t cols = 37, rows = 23, seed = 12345;
+	m->width = width;
+	m->height = height;
+	m->vertexCount = (cols + 1) * (rows + 1);
+	m->indexCount = cols * rows * 6;
+	m->vertexVC4 = GpuAlloc(m->vertexCount * sizeof(SOFT_VERTEX));
+	m->indexVC4 = GpuAlloc(m->indexCount * 2);
+	SOFT_VERTEX* v = ToARM(m->vertexVC4);
+	uint16_t* ix = ToARM(m->indexVC4);
+	for (uint32_t i = 0; i <= rows; i++)
+		for (uint32_t j = 0; j <= cols; j++) {
+			float x = (float)width * j / cols, y = (float)height * i / rows;
+			if (i > 0 && i < rows && j > 0 && j < cols) {
+				seed = seed * 1103515245 + 12345;
+				x += ((int32_t)((seed >> 16) % 200) - 100) * 0.002f * width / cols;
+				seed = seed * 1103515245 + 12345;
+				y += ((int32_t)((seed >> 16) % 200) - 100) * 0.002f * height / rows;
+			}
+			SetVertex(v++, x, y, 1, 1, 1);
+		}
+	for (uint32_t i = 0; i < rows; i++)
+		for (uint32_t j = 0; j < cols; j++) {
+			uint16_t a = i * (cols + 1) + j, b = a + cols + 1;
+			*ix++ = a; *ix++ = b; *ix++ = a + 1;
+			*ix++ = a + 1; *ix++ = b; *ix++ = b + 1;
+		}
+	BuildLists(m);
+}
+
+/*--------------------------------------------------------------------------}
+{  Plain reference: every triangle over the whole screen in order, pixel    }
+{  centre test and weights worked out directly rather than stepped.         }
+{--------------------------------------------------------------------------*/
+static int64_t RefEdge (const SOFT_VERTEX* a, const SOFT_VERTEX* b, int32_t px, int32_t py)
+{
+	return (int64_t)((int32_t)b->x - (int32_t)a->x) * (py - (int32_t)a->y)
+		- (int64_t)((int32_t)b->y - (int32_t)a->y) * (px - (int32_t)a->x);
+}
+
+static bool RefOwns (const SOFT_VERTEX* a, const SOFT_VERTEX* b, int64_t e)
+{
+	int32_t dx = (int32_t)b->x - (int32_t)a->x, dy = (int32_t)b->y - (int32_t)a->y;
+	if (e > 0) return true;
+	return (e == 0 && (dy > 0 || (dy == 0 && dx > 0)));
+}
+
+static uint8_t ToByte (float c)
+{
+	if (c <= 0.0f) return 0;
+	if (c >= 1.0f) return 255;
+	return (uint8_t)(c * 255.0f + 0.5f);
+}
+
+static void RefRender (const MESH* m, uint32_t* pixels, uint8_t* coverage)
+{
+	const SOFT_VERTEX* vb = ToARM(m->vertexVC4);
+	const uint16_t* ix = ToARM(m->indexVC4);
+	for (uint32_t i = 0; i < m->width * m->height; i++) pixels[i] = 0xFF000000;
+	if (coverage) memset(coverage, 0, m->width * m->height);
+	for (uint32_t t = 0; t < m->indexCount / 3; t++) {
+		SOFT_VERTEX v[3] = { vb[ix[t * 3]], vb[ix[t * 3 + 1]], vb[ix[t * 3 + 2]] };
+		int64_t area = RefEdge(&v[0], &v[1], v[2].x, v[2].y);
+		if (area == 0) continue;
+		if (area < 0) { SOFT_VERTEX s = v[1]; v[1] = v[2]; v[2] = s; area = -area; }
+		float invArea = 1.0f / (float)area;
+		for (uint32_t y = 0; y < m->height; y++)
+			for (uint32_t x = 0; x < m->width; x++) {
+				int32_t px = x * 16 + 8, py = y * 16 + 8;
+				int64_t e0 = RefEdge(&v[1], &v[2], px, py), e1 = RefEdge(&v[2], &v[0], px, py), e2 = RefEdge(&v[0], &v[1], px, py);
+				if (!RefOwns(&v[1], &v[2], e0) || !RefOwns(&v[2], &v[0], e1) || !RefOwns(&v[0], &v[1], e2)) continue;
+				float l0 = (float)e0 * invArea, l1 = (float)e1 * invArea, l2 = (float)e2 * invArea;
+				float pw = l0 * v[0].w + l1 * v[1].w + l2 * v[2].w;
+				float ipw = (pw != 0.0f) ? 1.0f / pw : 0.0f;
+				float r = (l0 * v[0].red * v[0].w + l1 * v[1].red * v[1].w + l2 * v[2].red * v[2].w) * ipw;
+				float g = (l0 * v[0].green * v[0].w + l1 * v[1].green * v[1].w + l2 * v[2].green * v[2].w) * ipw;
+				float b = (l0 * v[0].blue * v[0].w + l1 * v[1].blue * v[1].w + l2 * v[2].blue * v[2].w) * ipw;
+				pixels[y * m->width + x] = 0xFF000000 | (ToByte(b) << 16) | (ToByte(g) << 8) | ToByte(r);
+				if (coverage && coverage[y * m->width + x] < 255) coverage[y * m->width + x]++;
+			}
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{                          THREADED TILE RENDER                             }
+{--------------------------------------------------------------------------*/
+static SOFT_SCENE scene;						// Big (tile table) so not on the stack
+static uint32_t* bins;
+static uint32_t binSize = 1 << 20;
+
+typedef struct job {
+	SOFT_TARGET target;							// Same pixels, own depth tile
+	uint32_t first, step;
+	uint32_t drawn;
+} JOB;
+
+static float depthTile[MAX_THREADS][SOFT_TILE_SIZE * SOFT_TILE_SIZE];
+
+static void* RenderJob (void* arg)
+{
+	JOB* j = arg;
+	j->drawn = SoftRaster_RenderTiles(&scene, &j->target, j->first, j->step);
+	return 0;
+}
+
+/* Sets the scene up from the mesh binning list and renders it with threads */
+static bool RenderScene (const MESH* m, uint32_t* pixels, uint32_t threads)
+{
+	pthread_t tid[MAX_THREADS];
+	JOB job[MAX_THREADS];
+	if (!SoftRaster_SetupFromList(&scene, ToARM(m->binStart), m->binSize, ToARM, 0xFF000000, bins, binSize))
+		return false;
+	for (uint32_t i = 0; i < threads; i++) {
+		job[i] = (JOB) { { pixels, m->width, m->height, m->width, depthTile[i] }, i, threads, 0 };
+		if (i) pthread_create(&tid[i], 0, RenderJob, &job[i]);
+	}
+	RenderJob(&job[0]);											// Main thread takes the first share
+	for (uint32_t i = 1; i < threads; i++) pthread_join(tid[i], 0);
+	return true;
+}
+
+static uint32_t Differences (const uint32_t* a, const uint32_t* b, uint32_t count)
+{
+	uint32_t diff = 0;
+	for (uint32_t i = 0; i < count; i++) if (a[i] != b[i]) diff++;
+	return diff;
+}
+
+static bool WritePPM (const char* name, const uint32_t* pixels, uint32_t width, uint32_t height)
+{
+	FILE* f = fopen(name, "wb");
+	if (!f) return false;
+	fprintf(f, "P6\n%u %u\n255\n", (unsigned)width, (unsigned)height);
+	for (uint32_t i = 0; i < width * height; i++) {
+		uint8_t rgb[3] = { (uint8_t)pixels[i], (uint8_t)(pixels[i] >> 8), (uint8_t)(pixels[i] >> 16) };
+		fwrite(rgb, 1, 3, f);
+	}
+	fclose(f);
+	return true;
+}
+
+/* Reads a P6 ppm of the given size into pixels, false if it differs in size */
+static bool ReadPPM (const char* name, uint32_t* pixels, uint32_t width, uint32_t height)
+{
+	unsigned w, h, maxval;
+	FILE* f = fopen(name, "rb");
+	if (!f) return false;
+	bool ok = (fscanf(f, "P6 %u %u %u", &w, &h, &maxval) == 3) && w == width && h == height && maxval == 255;
+	fgetc(f);
+	for (uint32_t i = 0; ok && i < width * height; i++) {
+		uint8_t rgb[3];
+		ok = (fread(rgb, 1, 3, f) == 3);
+		pixels[i] = 0xFF000000 | (rgb[2] << 16) | (rgb[1] << 8) | rgb[0];
+	}
+	fclose(f);
+	return ok;
+}
+
+int main (int argc, char* argv[])
+{
+	const char* writeName = 0;
+	const char* goldenName = 0;
+	uint32_t width = 1280, height = 720, rings = 48;
+	int failures = 0;
+	int arg = 1;
+
+	while (arg + 1 < argc && argv[arg][0] == '-') {
+		if (strcmp(argv[arg], "-w") == 0) writeName = argv[arg + 1];
+			else if (strcmp(argv[arg], "-g") == 0) goldenName = argv[arg + 1];
+		arg += 2;
+	}
+	if (arg + 2 < argc) {
+		width = atoi(argv[arg]);
+		height = atoi(argv[arg + 1]);
+		rings = atoi(argv[arg + 2]);
+	}
+	if (width == 0 || height == 0 || width > 4096 || height > 4096 || rings < 2 || rings > 120) {
+		printf("Usage: RasterCheck [-w file.ppm] [-g file.ppm] [width height rings]\n");
+		return 2;
+	}
+
+	gpuMem = calloc(1, GPU_SIZE);
+	bins = malloc(binSize * sizeof(uint32_t));
+	uint32_t* image = malloc(width * height * sizeof(uint32_t));
+	uint32_t* ref = malloc(width * height * sizeof(uint32_t));
+	uint8_t* coverage = malloc(width * height);
+	if (!gpuMem || !bins || !image || !ref || !coverage) return 2;
+
+	MESH grid, windows, sphere;
+	BuildJitterGrid(&grid, width, height);
+	BuildWindows(&windows, width, height);
+	BuildSphere(&sphere, width, height, rings);
+	const struct { const char* name; MESH* m; } scenes[3] = {
+		{ "jitter grid", &grid }, { "GUI windows", &windows }, { "model sphere", &sphere } };
+
+	for (int s = 0; s < 3; s++) {
+		const MESH* m = scenes[s].m;
+		uint32_t count = width * height;
+		RefRender(m, ref, coverage);
+		if (!RenderScene(m, image, 1)) {
+			printf("%-13s setup from binning list failed (bins needed %u)\n", scenes[s].name, (unsigned)scene.binUsed);
+			failures++;
+			continue;
+		}
+		uint32_t diff = Differences(image, ref, count);
+		uint32_t threadDiff = 0;
+		uint32_t* threaded = malloc(count * sizeof(uint32_t));
+		for (uint32_t t = 2; t <= MAX_THREADS; t++) {
+			RenderScene(m, threaded, t);
+			threadDiff += Differences(image, threaded, count);
+		}
+		free(threaded);
+		printf("%-13s %6u triangles %5u tile entries: %u pixels differ from reference, %u across 2-8 threads",
+			scenes[s].name, (unsigned)scene.triangles, (unsigned)scene.binUsed, (unsigned)diff, (unsigned)threadDiff);
+		if (m == &grid) {
+			uint32_t holes = 0, twice = 0;
+			for (uint32_t i = 0; i < count; i++) {
+				if (coverage[i] == 0) holes++;
+				if (coverage[i] > 1) twice++;
+			}
+			printf(", %u holes, %u drawn twice", (unsigned)holes, (unsigned)twice);
+			if (holes || twice) failures++;
+		}
+		printf("\n");
+		if (diff || threadDiff) failures++;
+	}
+
+	RenderScene(&sphere, image, 1);
+	if (writeName) {
+		if (WritePPM(writeName, image, width, height)) printf("Model image written to %s\n", writeName);
+			else failures++;
+	}
+	if (goldenName) {
+		if (!ReadPPM(goldenName, ref, width, height)) {
+			printf("Golden image %s can't be read or is not %ux%u\n", goldenName, (unsigned)width, (unsigned)height);
+			failures++;
+		} else {
+			uint32_t diff = Differences(image, ref, width * height);
+			printf("Golden image %s: %u pixels differ\n", goldenName, (unsigned)diff);
+			if (diff) failures++;
+		}
+	}
+
+	uint32_t setups = 0;
+	uint64_t setupStart = NowNs(), setupNs;
+	do {
+		SoftRaster_SetupFromList(&scene, ToARM(sphere.binStart), sphere.binSize, ToARM, 0xFF000000, bins, binSize);
+		setups++;
+		setupNs = NowNs() - setupStart;
+	} while (setupNs < BENCH_MIN_NS);
+	printf("\nBenchmark %ux%u, %u triangle model, setup (binning) %.3f ms/frame on one thread:\n",
+		(unsigned)width, (unsigned)height, (unsigned)(sphere.indexCount / 3), setupNs / 1e6 / setups);
+	double base = 0;
+	for (uint32_t t = 1; t <= MAX_THREADS; t++) {
+		uint32_t frames = 0;
+		uint64_t start = NowNs(), ns;
+		do {
+			RenderScene(&sphere, image, t);
+			frames++;
+			ns = NowNs() - start;
+		} while (ns < BENCH_MIN_NS);
+		double trisPerSec = (double)scene.triangles * frames * 1e9 / ns;
+		if (t == 1) base = trisPerSec;
+		printf("  %u thread%s %8.3f ms/frame %12.0f triangles/sec  x%.2f\n", (unsigned)t, t > 1 ? "s" : " ",
+			ns / 1e6 / frames, trisPerSec, trisPerSec / base);
+	}
+
+	printf("\n%s\n", failures ? "RASTER CHECK FAILED" : "Tiled render matches reference, threads agree");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,292 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t etc
+#include <stdio.h>								// Needed for printf
+#include <stdlib.h>								// Needed for malloc
+#include <string.h>								// Needed for memset, memcmp
+#include <time.h>								// Needed for clock_gettime
+#include "rpi-Texture.h"						// Texture layout under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: TexCheck.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host check and benchmark of rpi-Texture.                                 }
+{                                                                           }
+{  Checks: level layouts don't overlap and level 0 is 4K aligned, every    }
+{  padded texel of a level has its own address, T-format tiles, subtiles   }
+{  and microtiles land where the VideoCore IV reference figure puts them,  }
+{  Texture_Swizzle matches the per texel address sum with edge padding,    }
+{  Texture_Downsample is within 1 of the exact box filter, and BMP files   }
+{  (24 bit bottom up, 32 bit top down) decode bottom row first.            }
+{                                                                           }
+{  Then the conversion speed of the swizzle and of the whole mipmap chain  }
+{  is measured for square textures of 256 to 2048.                         }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define BENCH_MIN_NS	200000000ull			// Each size runs at least this long
+
+static int failures = 0;
+
+static uint64_t NowNs (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void Check (bool ok, const char* what)
+{
+	printf("  %-60s %s\n", what, ok ? "ok" : "FAILED");
+	if (!ok) failures++;
+}
+
+static uint32_t rng = 12345;
+static uint32_t Random (void)
+{
+	rng = rng * 1664525u + 1013904223u;
+	return rng;
+}
+
+/*--------------------------------------------------------------------------}
+{ Every level inside the memory, level 0 4K aligned and last, no overlaps, }
+{ and every padded texel of every level at its own address.               }
+{--------------------------------------------------------------------------*/
+static bool LayoutGood (uint32_t width, uint32_t height, bool mipmaps)
+{
+	TEXTURE_LAYOUT l;
+	if (!Texture_Layout(&l, width, height, mipmaps)) return false;
+	if ((l.level[0].offset & 0xFFF) || (l.level[0].offset + l.level[0].size != l.size)) return false;
+	uint8_t* used = calloc(l.size / 4, 1);
+	bool ok = (used != 0);
+	for (uint32_t i = 0; ok && i < l.levels; i++) {
+		const TEXTURE_LEVEL* lv = &l.level[i];
+		if ((i > 0) && (lv->offset + lv->size > l.level[i - 1].offset)) ok = false;	// Smaller levels go before
+		for (uint32_t y = 0; ok && y < lv->padHeight; y++)
+			for (uint32_t x = 0; ok && x < lv->padWidth; x++) {
+				uint32_t a = lv->offset + Texture_TexelOffset(lv, x, y);
+				if ((a >= l.size) || (a - lv->offset >= lv->size) || used[a / 4]) ok = false;
+				else used[a / 4] = 1;
+			}
+	}
+	free(used);
+	return ok;
+}
+
+/* Texture_Swizzle against the per texel sum, padding repeating the edges */
+static bool SwizzleGood (uint32_t width, uint32_t height)
+{
+	TEXTURE_LAYOUT l;
+	if (!Texture_Layout(&l, width, height, false)) return false;
+	const TEXTURE_LEVEL* lv = &l.level[0];
+	uint32_t pitch = width + 3;										// Pitch wider than the image
+	uint32_t* src = malloc(pitch * height * sizeof(uint32_t));
+	uint8_t* dst = malloc(lv->size);
+	if (!src || !dst) return false;
+	for (uint32_t i = 0; i < pitch * height; i++) src[i] = Random();
+	memset(dst, 0xAA, lv->size);
+	Texture_Swizzle(dst, lv, src, pitch);
+	bool ok = true;
+	for (uint32_t y = 0; ok && y < lv->padHeight; y++)
+		for (uint32_t x = 0; ok && x < lv->padWidth; x++) {
+			uint32_t sx = (x < width) ? x : width - 1, sy = (y < height) ? y : height - 1;
+			uint32_t t;
+			memcpy(&t, dst + Texture_TexelOffset(lv, x, y), 4);
+			if (t != src[sy * pitch + sx]) ok = false;
+		}
+	free(src);
+	free(dst);
+	return ok;
+}
+
+/* T-format places read off the reference figure for a 64x64 texture (2x2 tiles) */
+static bool TFormatGood (void)
+{
+	static const struct { uint16_t x, y; uint32_t offset; } place[] = {
+		{  0,  0,     0 },										// Tile row 0 runs left to right
+		{ 32,  0,  4096 },
+		{ 32, 32,  8192 + 2048 },									// Row 1 runs right to left, so tile (1,1) is third
+		{  0, 32, 12288 + 2048 },
+		{ 16,  0,  3072 },										// Even row subtiles: bottom left, top left, top right, bottom right
+		{  0, 16,  1024 },
+		{ 16, 16,  2048 },
+		{ 48, 32,  8192 + 1024 },									// Odd row subtiles: top right, bottom right, bottom left, top left
+		{ 48, 48,  8192 + 0 },
+		{ 32, 48,  8192 + 3072 },
+		{  4,  0,    64 },										// Microtiles in row order in a subtile
+		{  0,  4,   256 },
+		{  1,  2,    36 },										// Texels in row order in a microtile
+	};
+	TEXTURE_LAYOUT l;
+	if (!Texture_Layout(&l, 64, 64, false) || (l.level[0].tiling != TEXTURE_TILING_T)) return false;
+	for (uint32_t i = 0; i < sizeof(place) / sizeof(place[0]); i++)
+		if (Texture_TexelOffset(&l.level[0], place[i].x, place[i].y) != place[i].offset) {
+			printf("    texel %u,%u at %u not %u\n", place[i].x, place[i].y,
+				Texture_TexelOffset(&l.level[0], place[i].x, place[i].y), place[i].offset);
+			return false;
+		}
+	return true;
+}
+
+/* Every byte of the downsample within 1 of the exact box filter */
+static bool DownsampleGood (uint32_t width, uint32_t height)
+{
+	uint32_t dw = (width > 1) ? width / 2 : 1, dh = (height > 1) ? height / 2 : 1;
+	uint32_t* src = malloc(width * height * sizeof(uint32_t));
+	uint32_t* dst = malloc(dw * dh * sizeof(uint32_t));
+	if (!src || !dst) return false;
+	for (uint32_t i = 0; i < width * height; i++) src[i] = Random();
+	Texture_Downsample(dst, src, width, height);
+	bool ok = true;
+	for (uint32_t y = 0; y < dh; y++)
+		for (uint32_t x = 0; x < dw; x++)
+			for (uint32_t b = 0; b < 32; b += 8) {
+				uint32_t x0 = 2 * x, x1 = (2 * x + 1 < width) ? 2 * x + 1 : width - 1;
+				uint32_t y0 = 2 * y, y1 = (2 * y + 1 < height) ? 2 * y + 1 : height - 1;
+				int sum = ((src[y0 * width + x0] >> b) & 0xFF) + ((src[y0 * width + x1] >> b) & 0xFF)
+					+ ((src[y1 * width + x0] >> b) & 0xFF) + ((src[y1 * width + x1] >> b) & 0xFF);
+				int d = (dst[y * dw + x] >> b) & 0xFF;
+				if ((d * 4 - sum > 4) || (sum - d * 4 > 4)) ok = false;
+			}
+	free(src);
+	free(dst);
+	return ok;
+}
+
+static void Put16 (uint8_t* p, uint32_t v) { p[0] = v; p[1] = v >> 8; }
+static void Put32 (uint8_t* p, uint32_t v) { Put16(p, v); Put16(p + 2, v >> 16); }
+
+/* A w x h BMP of bits per pixel, rows bottom up or top down, texel x,y is x*16+y in each of R,G,B */
+static uint32_t MakeBmp (uint8_t* f, uint32_t w, uint32_t h, uint32_t bits, bool topDown)
+{
+	uint32_t stride = (w * bits / 8 + 3) & ~3u;
+	memset(f, 0, 54 + stride * h);
+	f[0] = 'B'; f[1] = 'M';
+	Put32(&f[2], 54 + stride * h);
+	Put32(&f[10], 54);
+	Put32(&f[14], 40);
+	Put32(&f[18], w);
+	Put32(&f[22], topDown ? (uint32_t)-(int32_t)h : h);
+	Put16(&f[26], 1);
+	Put16(&f[28], bits);
+	for (uint32_t y = 0; y < h; y++)
+		for (uint32_t x = 0; x < w; x++) {
+			uint8_t* p = f + 54 + (topDown ? h - 1 - y : y) * stride + x * bits / 8;
+			p[0] = x * 16 + y + 0x80;								// Blue
+			p[1] = x * 16 + y + 0x40;								// Green
+			p[2] = x * 16 + y;										// Red
+		}
+	return 54 + stride * h;
+}
+
+static bool BmpGood (uint32_t bits, bool topDown)
+{
+	uint8_t file[54 + 4 * 8 * 5];
+	uint32_t texels[7 * 5], w, h;
+	uint32_t size = MakeBmp(file, 7, 5, bits, topDown);
+	if (!Texture_BmpSize(file, size, &w, &h) || (w != 7) || (h != 5)) return false;
+	if (Texture_BmpSize(file, size - 1, &w, &h)) return false;		// Short file
+	if (!Texture_DecodeBmp(file, size, texels)) return false;
+	for (uint32_t y = 0; y < 5; y++)
+		for (uint32_t x = 0; x < 7; x++) {
+			uint32_t v = x * 16 + y;
+			if (texels[y * 7 + x] != (v | ((v + 0x40) << 8) | ((v + 0x80) << 16) | 0xFF000000u)) return false;
+		}
+	file[30] = 1;													// RLE is not read
+	return !Texture_BmpSize(file, size, &w, &h);
+}
+
+/*--------------------------------------------------------------------------}
+{ Times the level 0 swizzle and the whole mipmap chain of a size x size    }
+{ texture, as BuildTexture in rpi-GLES.c does it.                          }
+{--------------------------------------------------------------------------*/
+static void Bench (uint32_t size)
+{
+	TEXTURE_LAYOUT l;
+	Texture_Layout(&l, size, size, true);
+	uint32_t* src = malloc(size * size * sizeof(uint32_t));
+	uint32_t* mip = malloc((size / 2) * (size / 2) * 2 * sizeof(uint32_t));
+	uint8_t* tex = malloc(l.size);
+	if (!src || !mip || !tex) return;
+	for (uint32_t i = 0; i < size * size; i++) src[i] = Random();
+	memset(tex, 0, l.size);
+
+	uint32_t runs = 0;
+	uint64_t t = NowNs(), ns;
+	do {
+		Texture_Swizzle(tex + l.level[0].offset, &l.level[0], src, size);
+		runs++;
+	} while ((ns = NowNs() - t) < BENCH_MIN_NS);
+	double swizzleMs = ns / 1e6 / runs;
+
+	runs = 0;
+	t = NowNs();
+	do {
+		uint32_t* buffer[2] = { mip, mip + (size / 2) * (size / 2) };
+		const uint32_t* level = src;
+		for (uint32_t i = 0; i < l.levels; i++) {
+			if (i > 0) {
+				Texture_Downsample(buffer[(i - 1) & 1], level, l.level[i - 1].width, l.level[i - 1].height);
+				level = buffer[(i - 1) & 1];
+			}
+			Texture_Swizzle(tex + l.level[i].offset, &l.level[i], level, l.level[i].width);
+		}
+		runs++;
+	} while ((ns = NowNs() - t) < BENCH_MIN_NS);
+	double chainMs = ns / 1e6 / runs;
+
+	printf("  %4ux%-4u  swizzle %8.3f ms  %7.1f MB/s   mipmapped (%2u levels) %8.3f ms  %6.1f Mtexel/s\n",
+		size, size, swizzleMs, size * size * 4.0 / 1e3 / swizzleMs, l.levels, chainMs, size * size / 1e3 / chainMs);
+	free(src);
+	free(mip);
+	free(tex);
+}
+
+int main (void)
+{
+	printf("Layout\n");
+	Check(LayoutGood(2048, 2048, true), "2048x2048 mipmapped");
+	Check(LayoutGood(256, 1024, true), "256x1024 mipmapped (FUS.JPG size)");
+	Check(LayoutGood(1024, 16, true), "1024x16 mipmapped (LT from level 0)");
+	Check(LayoutGood(1, 1, true), "1x1");
+	Check(LayoutGood(100, 60, false), "100x60 not mipmapped");
+	TEXTURE_LAYOUT l;
+	Check(!Texture_Layout(&l, 100, 64, true) && !Texture_Layout(&l, 4096, 4, false)
+		&& !Texture_Layout(&l, 0, 4, false), "Non power of 2 mipmaps, too big and 0 refused");
+	Check(Texture_Layout(&l, 64, 64, true) && (l.levels == 7) && (l.level[0].tiling == TEXTURE_TILING_T)
+		&& (l.level[1].tiling == TEXTURE_TILING_T) && (l.level[2].tiling == TEXTURE_TILING_LT),
+		"64x64: 7 levels, T-format down to 32x32 then LT");
+	Check(TFormatGood(), "T-format tile, subtile and microtile order");
+
+	printf("Conversion\n");
+	Check(SwizzleGood(256, 256), "Swizzle 256x256 T-format");
+	Check(SwizzleGood(100, 60), "Swizzle 100x60 T-format with padding");
+	Check(SwizzleGood(13, 7), "Swizzle 13x7 LT-format with padding");
+	Check(SwizzleGood(2, 1), "Swizzle 2x1 LT-format with padding");
+	Check(DownsampleGood(256, 128), "Downsample 256x128");
+	Check(DownsampleGood(18, 6), "Downsample 18x6 (odd half width)");
+	Check(DownsampleGood(8, 1), "Downsample 8x1");
+	Check(BmpGood(24, false), "BMP 24 bit bottom up");
+	Check(BmpGood(32, true), "BMP 32 bit top down");
+
+	printf("Speed (one thread)\n");
+	for (uint32_t size = 256; size <= 2048; size *= 2) Bench(size);
+
+	printf("\n%s\n", failures ? "TEXTURE CHECK FAILED" : "All texture checks good");
+	return failures ? 1 : 0;
+}
@@ -5,10 +5,12 @@
 #include "emb-stdio.h"			// Needed for printf
 #include "rpi-smartstart.h"		// Needed for smart start API 
 #include "rpi-GLES.h"
+#include "rpi-QPUKernels.h"
 #include "SDCard.h"
 
 static bool lit = false;
 void c_irq_handler(void) {
+	if (V3D_IrqHandler()) return;									// V3D frame queue interrupt
 	if (lit) lit = false; else lit = true;							// Flip lit flag
 	set_Activity_LED(lit);											// Turn LED on/off as per new flag
 }
@@ -17,12 +19,158 @@ void c_irq_handler(void) {
 int halfScrWth;
 int halfScrHt;
 struct obj_model_t model = { 0 };
+V3D_TEXTURE texture = { 0 };
+
+/*--------------------------------------------------------------------------}
+{ Texture for when there is no pitts.bmp on the SD card, 32 texel checks    }
+{ with a lighter line round each so the mipmap levels show as it shrinks.   }
+{--------------------------------------------------------------------------*/
+#define CHECK_SIZE 256
+static uint32_t checkTexels[CHECK_SIZE * CHECK_SIZE];
+static void MakeCheckTexture (void) {
+	for (uint32_t y = 0; y < CHECK_SIZE; y++)
+		for (uint32_t x = 0; x < CHECK_SIZE; x++) {
+			uint32_t c = (((x >> 5) ^ (y >> 5)) & 1) ? 0xFF2040C0 : 0xFFE0E0E0;	// Red check on grey (R in low byte)
+			if (((x & 31) == 0) || ((y & 31) == 0)) c = 0xFF40FFFF;		// Yellow lines
+			checkTexels[y * CHECK_SIZE + x] = c;
+		}
+}
+
+/*--------------------------------------------------------------------------}
+{ Renders frames with the chosen vertex transform path and returns the time }
+{ per frame, the part of it spent transforming on the ARM and the V3D bin   }
+{ and render time of the last frame in usec. Frames are queued so the ARM   }
+{ transform of one frame overlaps the binning/rendering of the previous.    }
+{ The last frame's times and counters are left in lastFrame.                }
+{--------------------------------------------------------------------------*/
+#define BENCH_FRAMES 200
+#define SOFT_BENCH_FRAMES 20
+static V3D_FRAME_TIMES lastFrame;
+static void TimeTransformPath (bool onQPU, uint32_t* frameUs, uint32_t* rotateUs, uint32_t* binUs, uint32_t* renderUs) {
+	uint64_t rotateTime = 0;
+	uint32_t ticket = 0;
+	V3D_FRAME_TIMES ft = { 0 };
+	SetVertexShading(&model, onQPU);								// Select transform path
+	uint64_t start = timer_getTickCount();
+	for (int i = 0; i < BENCH_FRAMES; i++) {
+		DoRotate(0.01f, halfScrWth, halfScrHt, &model);
+		ticket = RenderModel(&model, printf);
+		rotateTime += model.transformUs;
+	}
+	V3D_WaitIdle();													// Last frames are still in flight
+	*frameUs = tick_difference(start, timer_getTickCount()) / BENCH_FRAMES;
+	*rotateUs = rotateTime / BENCH_FRAMES;
+	*binUs = *renderUs = 0;
+	if (V3D_GetFrameTimes(ticket, &ft)) {
+		*binUs = tick_difference(ft.binStartTick, ft.binDoneTick);
+		*renderUs = tick_difference(ft.renderStartTick, ft.renderDoneTick);
+	}
+	lastFrame = ft;
+}
+
+/*--------------------------------------------------------------------------}
+{ Runs each library kernel on the QPUs over buffers in coherent GPU memory, }
+{ checks the result against the ARM reference and times the two. Integer   }
+{ kernels must match exactly, float ones to within 1e-5 (the QPU flushes    }
+{ denormals and need not round as the ARM does). memcpy also goes through  }
+{ the blocking V3D_execute_qpu mailbox call to compare the launch costs.    }
+{--------------------------------------------------------------------------*/
+#define COMPUTE_WORDS	(256 * 1024)
+#define CONV_WIDTH		512
+#define CONV_HEIGHT		480
+static uint32_t computeRef[COMPUTE_WORDS];							// ARM reference results
+static void TimeCompute (void) {
+	static const QPU_KERNEL* const kernels[5] = { &QPU_KernelMemset, &QPU_KernelMemcpy,
+		&QPU_KernelSaxpy, &QPU_KernelConv3x3, &QPU_KernelRgbToYuv };
+	static const float w[9] = { 0.0625f, 0.125f, 0.0625f, 0.125f, 0.25f, 0.125f, 0.0625f, 0.125f, 0.0625f };
+	V3D_ARENA data;
+	if (!V3D_ArenaCreate(&data, 2 * COMPUTE_WORDS * sizeof(uint32_t))) {
+		printf("No GPU memory for the compute buffers\n");
+		return;
+	}
+	uint32_t srcVC4 = V3D_ArenaAlloc(&data, COMPUTE_WORDS * sizeof(uint32_t), 64);
+	uint32_t dstVC4 = V3D_ArenaAlloc(&data, COMPUTE_WORDS * sizeof(uint32_t), 64);
+	uint32_t* src = (uint32_t*)(uintptr_t)GPUaddrToARMaddr(srcVC4);
+	uint32_t* dst = (uint32_t*)(uintptr_t)GPUaddrToARMaddr(dstVC4);
+	float* fsrc = (float*)src;
+	float* fdst = (float*)dst;
+	float* fref = (float*)computeRef;
+	for (int k = 0; k < 5; k++) {
+		V3D_COMPUTE comp;
+		if (!V3D_ComputeCreate(&comp, kernels[k]->code, kernels[k]->codeWords, kernels[k]->uniforms)) break;
+		uint32_t* unif = V3D_ComputeUniforms(&comp);
+		uint32_t words = COMPUTE_WORDS, qpus = 0;
+		for (uint32_t i = 0; i < COMPUTE_WORDS; i++) {				// Inputs, floats from -1 to 1
+			src[i] = i * 2654435761u;
+			dst[i] = 0;
+			if ((k == 2) || (k == 3)) {
+				fsrc[i] = (float)(i % 1001) / 500.0f - 1.0f;
+				fdst[i] = (float)(i % 997) / 498.5f - 1.0f;
+			}
+		}
+		uint64_t start = timer_getTickCount();
+		switch (k) {												// ARM reference and the uniform streams
+		case 0:
+			for (uint32_t i = 0; i < words; i++) computeRef[i] = 0x5A5A5A5A;
+			qpus = QPU_MemsetUniforms(unif, QPU_MAX, dstVC4, 0x5A5A5A5A, words);
+			break;
+		case 1:
+			memcpy(computeRef, src, words * sizeof(uint32_t));
+			qpus = QPU_MemcpyUniforms(unif, QPU_MAX, dstVC4, srcVC4, words);
+			break;
+		case 2:
+			memcpy(computeRef, dst, words * sizeof(uint32_t));
+			QPU_RefSaxpy(fref, fsrc, 0.75f, words);
+			qpus = QPU_SaxpyUniforms(unif, QPU_MAX, dstVC4, srcVC4, 0.75f, words);
+			break;
+		case 3:
+			words = CONV_WIDTH * CONV_HEIGHT;
+			QPU_RefConv3x3(fref, CONV_WIDTH, fsrc, CONV_WIDTH + 2, CONV_WIDTH, CONV_HEIGHT, w);
+			qpus = QPU_Conv3x3Uniforms(unif, QPU_MAX, dstVC4, CONV_WIDTH, srcVC4, CONV_WIDTH + 2,
+				CONV_WIDTH, CONV_HEIGHT, w);
+			break;
+		case 4:
+			QPU_RefRgbToYuv(computeRef, src, words);
+			qpus = QPU_RgbToYuvUniforms(unif, QPU_MAX, dstVC4, srcVC4, words);
+			break;
+		}
+		uint32_t armUs = tick_difference(start, timer_getTickCount());
+		start = timer_getTickCount();
+		bool ran = V3D_ComputeWait(V3D_ComputeLaunch(&comp, qpus), 1000000);
+		uint32_t qpuUs = tick_difference(start, timer_getTickCount());
+		uint32_t bad = 0;
+		for (uint32_t i = 0; i < words; i++) {
+			if ((k == 2) || (k == 3)) {
+				float d = fdst[i] - fref[i];
+				if ((d > 1e-5f) || (d < -1e-5f)) bad++;
+			} else if (dst[i] != computeRef[i]) bad++;
+		}
+		printf("QPU %-8s %u words on %u QPUs: %u.%03u ms (ARM %u.%03u ms) %s, %u wrong\n",
+			kernels[k]->name, (unsigned)words, (unsigned)qpus,
+			(unsigned)(qpuUs / 1000), (unsigned)(qpuUs % 1000),
+			(unsigned)(armUs / 1000), (unsigned)(armUs % 1000),
+			ran ? "done" : "TIMED OUT", (unsigned)bad);
+		if (k == 1) {												// Same copy through the mailbox
+			memset(dst, 0, words * sizeof(uint32_t));
+			start = timer_getTickCount();
+			ran = V3D_ComputeExecute(&comp, qpus, 1000);
+			qpuUs = tick_difference(start, timer_getTickCount());
+			printf("QPU memcpy via V3D_execute_qpu: %u.%03u ms %s, %s\n",
+				(unsigned)(qpuUs / 1000), (unsigned)(qpuUs % 1000), ran ? "done" : "TIMED OUT",
+				memcmp(dst, computeRef, words * sizeof(uint32_t)) ? "wrong" : "matches");
+		}
+		V3D_ComputeDestroy(&comp);
+	}
+	V3D_ArenaDestroy(&data);
+}
+
 int main (void) {
 	InitV3D();														// Start 3D graphics
 	ARM_setmaxspeed(NULL);											// ARM CPU to max speed no message to screen
 	PiConsole_Init(0, 0, 32, NULL);									// Auto resolution console, no message to screen
 	TimerIrqSetup(500000, c_irq_handler);							// Give me flashing LED so I can tell if I have locked irq pipe up 
 	EnableInterrupts();												// Start interrupts rolling
+	V3D_EnableFrameIrq(true);										// V3D interrupt advances the frame queue
 	halfScrWth = GetConsole_Width() / 2;
 	halfScrHt = GetConsole_Height() / 2;
 
@@ -35,6 +183,59 @@ int main (void) {
 		printf("Model load failed .. check why\n");
 		while (1) {};
 	}
+	printf("%u vertices, %u triangles\n", (unsigned)model.num_verts, (unsigned)(model.IndexVertexCt / 3));
+	static const char* pathName[4] = { "NV shader + ARM   ", "QPU vertex shader ", "No cull, no depth ", "NV + texture      " };
+	uint32_t frameUs[4], rotateUs[4], binUs[4], renderUs[4];
+	SetCulling(&model, 0, false);									// Everything drawn in order, no depth buffer
+	TimeTransformPath(false, &frameUs[2], &rotateUs[2], &binUs[2], &renderUs[2]);
+	SetCulling(&model, CULL_FRUSTUM | CULL_BACKFACE, true);			// Clusters culled, depth with early Z
+	TimeTransformPath(false, &frameUs[0], &rotateUs[0], &binUs[0], &renderUs[0]);	// Time ARM transform with NV shader state
+	CULL_STATS cs = model.cullStats;								// Culling and counters of the last frame
+	V3D_FRAME_TIMES hw = lastFrame;
+	uint64_t softStart = timer_getTickCount();						// Time the ARM software render of the same lists
+	for (int i = 0; i < SOFT_BENCH_FRAMES; i++) {
+		DoRotate(0.01f, halfScrWth, halfScrHt, &model);
+		RenderModelSoftware(&model, (uint32_t*)(uintptr_t)GetConsole_FrameBuffer(), GetConsole_Width());
+	}
+	uint32_t softUs = tick_difference(softStart, timer_getTickCount()) / SOFT_BENCH_FRAMES;
+	TimeTransformPath(true, &frameUs[1], &rotateUs[1], &binUs[1], &renderUs[1]);	// Time QPU coordinate/vertex shaders
+	if (!LoadTexture("\\AirCraft\\pitts\\pitts.bmp", &texture, true, printf)) {	// A BMP the TMU layout is made from
+		MakeCheckTexture();
+		CreateTexture(&texture, checkTexels, CHECK_SIZE, CHECK_SIZE, true);
+	}
+	SetTexture(&model, &texture);									// Mipmapped, sampled by TMU0
+	TimeTransformPath(false, &frameUs[3], &rotateUs[3], &binUs[3], &renderUs[3]);	// Time the texturing fragment shader
+	for (int i = 0; i < 4; i++)
+		printf("%s: %u.%03u ms/frame (ARM transform %u.%03u ms, bin %u.%03u ms, render %u.%03u ms)\n",
+			pathName[i],
+			(unsigned)(frameUs[i] / 1000), (unsigned)(frameUs[i] % 1000),
+			(unsigned)(rotateUs[i] / 1000), (unsigned)(rotateUs[i] % 1000),
+			(unsigned)(binUs[i] / 1000), (unsigned)(binUs[i] % 1000),
+			(unsigned)(renderUs[i] / 1000), (unsigned)(renderUs[i] % 1000));
+	printf("ARM software render: %u.%03u ms/frame (rpi-SoftRaster, %u cores)\n",
+		(unsigned)(softUs / 1000), (unsigned)(softUs % 1000), (unsigned)SoftRenderCores());
+	printf("Triangles %u, submitted %u in %u lists (clusters %u: %u off screen, %u back facing)\n",
+		(unsigned)cs.trisTotal, (unsigned)cs.trisSubmitted, (unsigned)cs.runs,
+		(unsigned)cs.clusters, (unsigned)cs.offScreen, (unsigned)cs.backFacing);
+	printf("Texture %ux%u, %u levels, %u KB: swizzle and mipmaps %u.%03u ms on the ARM\n",
+		(unsigned)texture.width, (unsigned)texture.height, (unsigned)texture.levels,
+		(unsigned)(texture.memory.size / 1024), (unsigned)(texture.convertUs / 1000), (unsigned)(texture.convertUs % 1000));
+	printf("V3D binner: %u outside viewport, %u clipped; FEP: %u prim/tiles (%u no pixels), %u quads, %u early Z rejected\n",
+		(unsigned)hw.plbOutside, (unsigned)hw.plbClipped, (unsigned)hw.fepPrims,
+		(unsigned)hw.fepNoPixels, (unsigned)hw.fepQuads, (unsigned)hw.fepEarlyZ);
+	TimeCompute();													// QPU kernels between the frames
+	V3D_MEM_STATS ms;
+	if (GetRenderMemStats(&model, &ms)) {
+		printf("GPU memory %u KB: shaders %u, mesh %u, frame %u of %u bytes x %u\n",
+			(unsigned)(ms.totalGPU / 1024), (unsigned)ms.shaderPoolUsed, (unsigned)ms.meshPoolUsed,
+			(unsigned)ms.frameUsed, (unsigned)ms.frameSize, (unsigned)V3D_MAX_FRAMES);
+		printf("Tile memory %u + %u overflow bytes, %u frames overflowed (last %u bytes)\n",
+			(unsigned)ms.tileAllocSize, (unsigned)ms.tileOverflowSize,
+			(unsigned)ms.overflowFrames, (unsigned)ms.lastOverflow);
+	}
+	timer_wait(5000000);											// Give time to read results
+
+	SetVertexShading(&model, true);									// Animate on the QPU path, the timing left it on NV + texture
 	DoRotate(0.0f, halfScrWth, halfScrHt, &model);						// Preset rotation matrix to zero
 
 	uint64_t tick = timer_getTickCount();
@@ -49,6 +250,9 @@ int main (void) {
 		frameCount++;
     }
 
+	V3D_EnableFrameIrq(false);
+	SetTexture(&model, NULL);
+	DestroyTexture(&texture);
 	DoneRenderer(&model);
 
 	return(0);
@@ -0,0 +1,13 @@
+# Fragment shader, vertex colour from 3 varyings (r,g,b) packed to the
+# tile buffer colour with alpha 1.0, Z (rb15) written for the depth test.
+
+	mov r0, vary; mov r3.8d, 1.0
+	fadd r0, r0, r5; mov r1, vary; sbwait
+	fadd r1, r1, r5; mov r2, vary
+	fadd r2, r2, r5; mov r3.8a, r0
+	nop; mov r3.8b, r1
+	nop; mov r3.8c, r2
+	mov tlbz, rb15		# interpolated Z for the depth test
+	mov tlbc, r3; nop; thrend
+	nop; nop; nop
+	nop; nop; sbdone
@@ -0,0 +1,80 @@
+/* Generated from Conv3x3.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x159e6fc0, 0x10020027,	/* mov ra0, qpu_num */
+	0x15827d80, 0x10020227,	/* mov ra8, unif */
+	0x15827d80, 0x10021227,	/* mov rb8, unif */
+	0x15827d80, 0x10020267,	/* mov ra9, unif */
+	0x15827d80, 0x100211e7,	/* mov rb7, unif */
+	0x15827d80, 0x10020327,	/* mov ra12, unif */
+	0x15827d80, 0x100201a7,	/* mov ra6, unif */
+	0x15827d80, 0x10021527,	/* mov rb20, unif */
+	0x15827d80, 0x10021567,	/* mov rb21, unif */
+	0x15827d80, 0x100215a7,	/* mov rb22, unif */
+	0x15827d80, 0x100215e7,	/* mov rb23, unif */
+	0x15827d80, 0x10021627,	/* mov rb24, unif */
+	0x15827d80, 0x10021667,	/* mov rb25, unif */
+	0x15827d80, 0x100216a7,	/* mov rb26, unif */
+	0x15827d80, 0x100216e7,	/* mov rb27, unif */
+	0x15827d80, 0x10021727,	/* mov rb28, unif */
+	0x159a7d80, 0x10020827,	/* mov r0, elem_num */
+	0x119c21c0, 0xd0020827,	/* shl r0, r0, 2 */
+	0x0c267c00, 0x10020267,	/* add ra9, ra9, r0 */
+	0x00001a00, 0xe00208a7,	/* ldi r2, 0x1a00 */
+	0x15027c80, 0x10020127,	/* or ra4, ra0, r2 */
+	0x80904000, 0xe00208a7,	/* ldi r2, 0x80904000 */
+	0x11007dc0, 0xd00208e7,	/* shl r3, ra0, 7 */
+	0x159e74c0, 0x100200a7,	/* or ra2, r2, r3 */
+	0x00000040, 0xe00208a7,	/* ldi r2, 64 */
+	/* row: */
+	0x15267d80, 0x100202a7,	/* mov ra10, ra9 */
+	0x15227d80, 0x100202e7,	/* mov ra11, ra8 */
+	0x15327d80, 0x10020867,	/* mov r1, ra12 */
+	/* block: */
+	0x152a7d80, 0x10020367,	/* mov ra13, ra10 */
+	0x959c0fff, 0xd0024823,	/* mov r0, 0; mov r3, 0 */
+	0x15367d80, 0x10020e27,	/* mov tmu0_s, ra13 */
+	0x0c344dc0, 0xd0020e27,	/* add tmu0_s, ra13, 4 */
+	0x0c348dc0, 0xd0020e27,	/* add tmu0_s, ra13, 8 */
+	0x0c347dc0, 0xa0020367,	/* add ra13, ra13, rb7; nop; ldtmu0 */
+	0x219d40e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb20 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219d50e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb21 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219d60e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb22 */
+	0x15367d80, 0x10020e27,	/* mov tmu0_s, ra13 */
+	0x0c344dc0, 0xd0020e27,	/* add tmu0_s, ra13, 4 */
+	0x0c348dc0, 0xd0020e27,	/* add tmu0_s, ra13, 8 */
+	0x0c347dc0, 0xa0020367,	/* add ra13, ra13, rb7; nop; ldtmu0 */
+	0x219d70e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb23 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219d80e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb24 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219d90e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb25 */
+	0x15367d80, 0x10020e27,	/* mov tmu0_s, ra13 */
+	0x0c344dc0, 0xd0020e27,	/* add tmu0_s, ra13, 4 */
+	0x0c348dc0, 0xd0020e27,	/* add tmu0_s, ra13, 8 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219da0e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb26 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219db0e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb27 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x219dc0e7, 0x10024823,	/* fadd r0, r0, r3; fmul r3, r4, rb28 */
+	0x15127d80, 0x10021c67,	/* mov vw_setup, ra4 */
+	0x019e70c0, 0x10020c27,	/* fadd vpm, r0, r3 */
+	0x150a7d80, 0x10021c67,	/* mov vw_setup, ra2 */
+	0x152e7d80, 0x10021ca7,	/* mov vw_addr, ra11 */
+	0x0d9c13c0, 0xd0022867,	/* sub.setf r1, r1, 1 */
+	0xfffffed0, 0xf01809e7,	/* brr.allnz block */
+	0x0c2a7c80, 0x100202a7,	/* add ra10, ra10, r2 */
+	0x0c2e7c80, 0x100202e7,	/* add ra11, ra11, r2 */
+	0x159f2fc0, 0x100209e7,	/* mov -, vw_wait */
+	0x0c247dc0, 0x10020267,	/* add ra9, ra9, rb7 */
+	0x0c208dc0, 0x10020227,	/* add ra8, ra8, rb8 */
+	0x0d181dc0, 0xd00221a7,	/* sub.setf ra6, ra6, 1 */
+	0xfffffe80, 0xf01809e7,	/* brr.allnz row */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x159c1fc0, 0xd00209a7,	/* mov host_int, 1 */
+	0x009e7000, 0x300009e7,	/* nop; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7	/* nop */
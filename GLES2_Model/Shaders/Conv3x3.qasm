@@ -0,0 +1,82 @@
+# QPU_KernelConv3x3, uniforms dst, dstPitch, src, srcPitch, blocks across,
+# rows, w0..w8. Each block of 16 outputs sums the 9 products row by row.
+
+	mov ra0, qpu_num
+	mov ra8, unif
+	mov rb8, unif
+	mov ra9, unif
+	mov rb7, unif
+	mov ra12, unif
+	mov ra6, unif
+	mov rb20, unif
+	mov rb21, unif
+	mov rb22, unif
+	mov rb23, unif
+	mov rb24, unif
+	mov rb25, unif
+	mov rb26, unif
+	mov rb27, unif
+	mov rb28, unif
+	mov r0, elem_num
+	shl r0, r0, 2
+	add ra9, ra9, r0
+	ldi r2, 0x1a00
+	or ra4, ra0, r2
+	ldi r2, 0x80904000
+	shl r3, ra0, 7
+	or ra2, r2, r3
+	ldi r2, 64
+row:
+	mov ra10, ra9
+	mov ra11, ra8
+	mov r1, ra12
+block:
+	mov ra13, ra10
+	mov r0, 0; mov r3, 0
+	mov tmu0_s, ra13
+	add tmu0_s, ra13, 4
+	add tmu0_s, ra13, 8
+	add ra13, ra13, rb7; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb20
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb21
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb22
+	mov tmu0_s, ra13
+	add tmu0_s, ra13, 4
+	add tmu0_s, ra13, 8
+	add ra13, ra13, rb7; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb23
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb24
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb25
+	mov tmu0_s, ra13
+	add tmu0_s, ra13, 4
+	add tmu0_s, ra13, 8
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb26
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb27
+	nop; nop; ldtmu0
+	fadd r0, r0, r3; fmul r3, r4, rb28
+	mov vw_setup, ra4
+	fadd vpm, r0, r3
+	mov vw_setup, ra2
+	mov vw_addr, ra11
+	sub.setf r1, r1, 1
+	brr.allnz block
+	add ra10, ra10, r2
+	add ra11, ra11, r2
+	mov -, vw_wait
+	add ra9, ra9, rb7
+	add ra8, ra8, rb8
+	sub.setf ra6, ra6, 1
+	brr.allnz row
+	nop
+	nop
+	nop
+	mov host_int, 1
+	nop; nop; thrend
+	nop
+	nop
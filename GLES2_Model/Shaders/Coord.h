@@ -0,0 +1,47 @@
+/* Generated from Coord.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x00301a00, 0xe0020c67,	/* ldi vr_setup, 0x00301a00 (read x,y,z) */
+	0x00001a00, 0xe00049f1,	/* ldi vw_setup, 0x00001a00 */
+	0x009e7000, 0x100009e7,	/* nop; nop */
+	0x009e7000, 0x100009e7,	/* nop; nop */
+	0x15c27d80, 0x10020027,	/* mov ra0, vpm */
+	0x15c27d80, 0x10020067,	/* mov ra1, vpm */
+	0x15c27d80, 0x100200a7,	/* mov ra2, vpm */
+	0x20020037, 0x100049e0,	/* nop; fmul r0, ra0, unif */
+	0x20060037, 0x100049e1,	/* nop; fmul r1, ra1, unif */
+	0x210a0077, 0x10024821,	/* fadd r0, r0, r1; fmul r1, ra2, unif */
+	0x019e7040, 0x10020827,	/* fadd r0, r0, r1; nop */
+	0x019e01c0, 0x10020127,	/* fadd ra4, r0, unif */
+	0x20020037, 0x100049e0,	/* nop; fmul r0, ra0, unif */
+	0x20060037, 0x100049e1,	/* nop; fmul r1, ra1, unif */
+	0x210a0077, 0x10024821,	/* fadd r0, r0, r1; fmul r1, ra2, unif */
+	0x019e7040, 0x10020827,	/* fadd r0, r0, r1; nop */
+	0x019e01c0, 0x10020167,	/* fadd ra5, r0, unif */
+	0x20020037, 0x100049e0,	/* nop; fmul r0, ra0, unif */
+	0x20060037, 0x100049e1,	/* nop; fmul r1, ra1, unif */
+	0x210a0077, 0x10024821,	/* fadd r0, r0, r1; fmul r1, ra2, unif */
+	0x019e7040, 0x10020827,	/* fadd r0, r0, r1; nop */
+	0x019e01c0, 0x100201a7,	/* fadd ra6, r0, unif */
+	0x20020037, 0x100049e0,	/* nop; fmul r0, ra0, unif */
+	0x20060037, 0x100049e1,	/* nop; fmul r1, ra1, unif */
+	0x210a0077, 0x10024821,	/* fadd r0, r0, r1; fmul r1, ra2, unif */
+	0x019e7040, 0x10020827,	/* fadd r0, r0, r1; nop */
+	0x019e01c0, 0x100208e7,	/* fadd r3, r0, unif */
+	0x959e76db, 0x10025d07,	/* mov recip, r3; mov ra7, r3 */
+	0x15127d80, 0x10020c27,	/* mov vpm, ra4 (Xc) */
+	0x15167d80, 0x10020c27,	/* mov vpm, ra5 (Yc) */
+	0x151a7d80, 0x10020c27,	/* mov vpm, ra6 (Zc) */
+	0x151e7d80, 0x10020c27,	/* mov vpm, ra7 (Wc) */
+	0x20127034, 0x100049e0,	/* nop; fmul r0, ra4, r4 */
+	0x20167034, 0x100049e1,	/* nop; fmul r1, ra5, r4 */
+	0x209e4007, 0xd00049e0,	/* nop; fmul r0, r0, 16.0 */
+	0x279e400f, 0xd0024821,	/* ftoi r0, r0; fmul r1, r1, 16.0 */
+	0x271a7274, 0x10024862,	/* ftoi r1, r1; fmul r2, ra6, r4 */
+	0x119d01c0, 0xd0020827,	/* shl r0, r0, 16 */
+	0x0e9d01c0, 0xd0020827,	/* shr r0, r0, 16 */
+	0x119d03c0, 0xd0020867,	/* shl r1, r1, 16 */
+	0x159e7040, 0x10020c27,	/* or vpm, r0, r1 (Xs/Ys) */
+	0x159e7480, 0x10020c27,	/* mov vpm, r2 (Zs) */
+	0x159e7900, 0x10020c27,	/* mov vpm, r4 (1/Wc) */
+	0x009e7000, 0x300009e7,	/* nop; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop; nop */
+	0x009e7000, 0x100009e7	/* nop; nop */
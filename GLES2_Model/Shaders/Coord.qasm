@@ -0,0 +1,50 @@
+# Coordinate shader, 16 uniforms are the row major screen matrix.
+# ra0..2 = x,y,z from VPM, ra4..7 = Xc,Yc,Zc,Wc, r4 = 1/Wc.
+# Writes Xc, Yc, Zc, Wc, Xs|Ys (12.4), Zs, 1/Wc to VPM.
+
+	ldi vr_setup, 0x00301a00		# read x,y,z
+	ldi vw_setup, 0x00001a00
+	nop; nop
+	nop; nop
+	mov ra0, vpm
+	mov ra1, vpm
+	mov ra2, vpm
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra4, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra5, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra6, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd r3, r0, unif
+	mov recip, r3; mov ra7, r3
+	mov vpm, ra4		# Xc
+	mov vpm, ra5		# Yc
+	mov vpm, ra6		# Zc
+	mov vpm, ra7		# Wc
+	nop; fmul r0, ra4, r4
+	nop; fmul r1, ra5, r4
+	nop; fmul r0, r0, 16.0
+	ftoi r0, r0; fmul r1, r1, 16.0
+	ftoi r1, r1; fmul r2, ra6, r4
+	shl r0, r0, 16
+	shr r0, r0, 16
+	shl r1, r1, 16
+	or vpm, r0, r1		# Xs/Ys
+	mov vpm, r2		# Zs
+	mov vpm, r4		# 1/Wc
+	nop; nop; thrend
+	nop; nop
+	nop; nop
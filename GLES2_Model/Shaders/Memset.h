@@ -0,0 +1,24 @@
+/* Generated from Memset.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x159e6fc0, 0x10020027,	/* mov ra0, qpu_num */
+	0x15827d80, 0x10020067,	/* mov ra1, unif */
+	0x15827d80, 0x10020867,	/* mov r1, unif */
+	0x15827d80, 0x10020827,	/* mov r0, unif */
+	0x00001a00, 0xe00208a7,	/* ldi r2, 0x1a00 */
+	0x15027c80, 0x10021c67,	/* or vw_setup, ra0, r2 */
+	0x159e7000, 0x10020c27,	/* mov vpm, r0 */
+	0x80904000, 0xe00208a7,	/* ldi r2, 0x80904000 */
+	0x11007dc0, 0xd00208e7,	/* shl r3, ra0, 7 */
+	0x159e74c0, 0x100200a7,	/* or ra2, r2, r3 */
+	0x00000040, 0xe00208a7,	/* ldi r2, 64 */
+	/* loop: */
+	0x150a7d80, 0x10021c67,	/* mov vw_setup, ra2 */
+	0x15067d80, 0x10021ca7,	/* mov vw_addr, ra1 */
+	0x0d9c13c0, 0xd0022867,	/* sub.setf r1, r1, 1 */
+	0xffffffc8, 0xf01809e7,	/* brr.allnz loop */
+	0x8c072cbf, 0x10024067,	/* add ra1, ra1, r2; mov -, vw_wait */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x159c1fc0, 0xd00209a7,	/* mov host_int, 1 */
+	0x009e7000, 0x300009e7,	/* nop; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7	/* nop */
@@ -0,0 +1,27 @@
+# QPU_KernelMemset, uniforms dst, blocks, value.
+# ra0 QPU number (the VPM row), ra1 dst, ra2 VDW setup for the row,
+# r0 value, r1 blocks left, r2 64 (the bytes of a block).
+
+	mov ra0, qpu_num
+	mov ra1, unif
+	mov r1, unif
+	mov r0, unif
+	ldi r2, 0x1a00
+	or vw_setup, ra0, r2
+	mov vpm, r0
+	ldi r2, 0x80904000
+	shl r3, ra0, 7
+	or ra2, r2, r3
+	ldi r2, 64
+loop:
+	mov vw_setup, ra2
+	mov vw_addr, ra1
+	sub.setf r1, r1, 1
+	brr.allnz loop
+	add ra1, ra1, r2; mov -, vw_wait
+	nop
+	nop
+	mov host_int, 1
+	nop; nop; thrend
+	nop
+	nop
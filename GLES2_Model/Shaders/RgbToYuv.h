@@ -0,0 +1,73 @@
+/* Generated from RgbToYuv.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x159e6fc0, 0x10020027,	/* mov ra0, qpu_num */
+	0x15827d80, 0x10020067,	/* mov ra1, unif */
+	0x15827d80, 0x100200e7,	/* mov ra3, unif */
+	0x15827d80, 0x10020867,	/* mov r1, unif */
+	0x159a7d80, 0x10020827,	/* mov r0, elem_num */
+	0x119c21c0, 0xd0020827,	/* shl r0, r0, 2 */
+	0x0c0e7c00, 0x100200e7,	/* add ra3, ra3, r0 */
+	0x00001a00, 0xe00208a7,	/* ldi r2, 0x1a00 */
+	0x15027c80, 0x10020127,	/* or ra4, ra0, r2 */
+	0x80904000, 0xe00208a7,	/* ldi r2, 0x80904000 */
+	0x11007dc0, 0xd00208e7,	/* shl r3, ra0, 7 */
+	0x159e74c0, 0x100200a7,	/* or ra2, r2, r3 */
+	0x000000ff, 0xe0021167,	/* ldi rb5, 255 */
+	0x00000010, 0xe00211a7,	/* ldi rb6, 16 */
+	0xff000000, 0xe00211e7,	/* ldi rb7, 0xff000000 */
+	0x00000080, 0xe0021227,	/* ldi rb8, 128 */
+	0x00000042, 0xe00212a7,	/* ldi rb10, 66 */
+	0x00000081, 0xe00212e7,	/* ldi rb11, 129 */
+	0x00000019, 0xe0021327,	/* ldi rb12, 25 */
+	0x00000026, 0xe0021367,	/* ldi rb13, 38 */
+	0x0000004a, 0xe00213a7,	/* ldi rb14, 74 */
+	0x00000070, 0xe00213e7,	/* ldi rb15, 112 */
+	0x0000005e, 0xe0021427,	/* ldi rb16, 94 */
+	0x00000012, 0xe0021467,	/* ldi rb17, 18 */
+	0x00000040, 0xe00208a7,	/* ldi r2, 64 */
+	/* loop: */
+	0x150e7d80, 0x10020e27,	/* mov tmu0_s, ra3 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x149c59c0, 0x100202a7,	/* and ra10, r4, rb5 */
+	0x0e9c89c0, 0xd0020827,	/* shr r0, r4, 8 */
+	0x149c51c0, 0x100202e7,	/* and ra11, r0, rb5 */
+	0x0e9c69c0, 0x10020827,	/* shr r0, r4, rb6 */
+	0x149c51c0, 0x10020327,	/* and ra12, r0, rb5 */
+	0x149c79c0, 0x10020367,	/* and ra13, r4, rb7 */
+	0x4028a037, 0x100049e0,	/* nop; mul24 r0, ra10, rb10 */
+	0x402cb037, 0x100049e3,	/* nop; mul24 r3, ra11, rb11 */
+	0x4c30c0f7, 0x10024823,	/* add r0, r0, r3; mul24 r3, ra12, rb12 */
+	0x0c9e70c0, 0x10020827,	/* add r0, r0, r3 */
+	0x0c9c81c0, 0x10020827,	/* add r0, r0, rb8 */
+	0x0e9c81c0, 0xd0020827,	/* shr r0, r0, 8 */
+	0x0c9c61c0, 0x100203a7,	/* add ra14, r0, rb6 */
+	0x4030f037, 0x100049e0,	/* nop; mul24 r0, ra12, rb15 */
+	0x4028d037, 0x100049e3,	/* nop; mul24 r3, ra10, rb13 */
+	0x4d2ce0f7, 0x10024823,	/* sub r0, r0, r3; mul24 r3, ra11, rb14 */
+	0x0d9e70c0, 0x10020827,	/* sub r0, r0, r3 */
+	0x0c9c81c0, 0x10020827,	/* add r0, r0, rb8 */
+	0x0f9c81c0, 0xd0020827,	/* asr r0, r0, 8 */
+	0x0c9c81c0, 0x10020827,	/* add r0, r0, rb8 */
+	0x119c81c0, 0xd00203e7,	/* shl ra15, r0, 8 */
+	0x4028f037, 0x100049e0,	/* nop; mul24 r0, ra10, rb15 */
+	0x402d0037, 0x100049e3,	/* nop; mul24 r3, ra11, rb16 */
+	0x4d3110f7, 0x10024823,	/* sub r0, r0, r3; mul24 r3, ra12, rb17 */
+	0x0d9e70c0, 0x10020827,	/* sub r0, r0, r3 */
+	0x0c9c81c0, 0x10020827,	/* add r0, r0, rb8 */
+	0x0f9c81c0, 0xd0020827,	/* asr r0, r0, 8 */
+	0x0c9c81c0, 0x10020827,	/* add r0, r0, rb8 */
+	0x119c61c0, 0x10020827,	/* shl r0, r0, rb6 */
+	0x153a7180, 0x10020827,	/* or r0, r0, ra14 */
+	0x153e7180, 0x10020827,	/* or r0, r0, ra15 */
+	0x15127d80, 0x10021c67,	/* mov vw_setup, ra4 */
+	0x15367180, 0x10020c27,	/* or vpm, r0, ra13 */
+	0x150a7d80, 0x10021c67,	/* mov vw_setup, ra2 */
+	0x15067d80, 0x10021ca7,	/* mov vw_addr, ra1 */
+	0x0d9c13c0, 0xd0022867,	/* sub.setf r1, r1, 1 */
+	0xfffffeb0, 0xf01809e7,	/* brr.allnz loop */
+	0x0c0e7c80, 0x100200e7,	/* add ra3, ra3, r2 */
+	0x0c067c80, 0x10020067,	/* add ra1, ra1, r2 */
+	0x159f2fc0, 0x100209e7,	/* mov -, vw_wait */
+	0x159c1fc0, 0xd00209a7,	/* mov host_int, 1 */
+	0x009e7000, 0x300009e7,	/* nop; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7	/* nop */
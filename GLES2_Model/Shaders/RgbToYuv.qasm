@@ -0,0 +1,75 @@
+# QPU_KernelRgbToYuv, uniforms dst, src, blocks. BT.601 video range in
+# integer maths, alpha kept (see QPU_RefRgbToYuv).
+
+	mov ra0, qpu_num
+	mov ra1, unif
+	mov ra3, unif
+	mov r1, unif
+	mov r0, elem_num
+	shl r0, r0, 2
+	add ra3, ra3, r0
+	ldi r2, 0x1a00
+	or ra4, ra0, r2
+	ldi r2, 0x80904000
+	shl r3, ra0, 7
+	or ra2, r2, r3
+	ldi rb5, 255
+	ldi rb6, 16
+	ldi rb7, 0xff000000
+	ldi rb8, 128
+	ldi rb10, 66
+	ldi rb11, 129
+	ldi rb12, 25
+	ldi rb13, 38
+	ldi rb14, 74
+	ldi rb15, 112
+	ldi rb16, 94
+	ldi rb17, 18
+	ldi r2, 64
+loop:
+	mov tmu0_s, ra3
+	nop; nop; ldtmu0
+	and ra10, r4, rb5
+	shr r0, r4, 8
+	and ra11, r0, rb5
+	shr r0, r4, rb6
+	and ra12, r0, rb5
+	and ra13, r4, rb7
+	nop; mul24 r0, ra10, rb10
+	nop; mul24 r3, ra11, rb11
+	add r0, r0, r3; mul24 r3, ra12, rb12
+	add r0, r0, r3
+	add r0, r0, rb8
+	shr r0, r0, 8
+	add ra14, r0, rb6
+	nop; mul24 r0, ra12, rb15
+	nop; mul24 r3, ra10, rb13
+	sub r0, r0, r3; mul24 r3, ra11, rb14
+	sub r0, r0, r3
+	add r0, r0, rb8
+	asr r0, r0, 8
+	add r0, r0, rb8
+	shl ra15, r0, 8
+	nop; mul24 r0, ra10, rb15
+	nop; mul24 r3, ra11, rb16
+	sub r0, r0, r3; mul24 r3, ra12, rb17
+	sub r0, r0, r3
+	add r0, r0, rb8
+	asr r0, r0, 8
+	add r0, r0, rb8
+	shl r0, r0, rb6
+	or r0, r0, ra14
+	or r0, r0, ra15
+	mov vw_setup, ra4
+	or vpm, r0, ra13
+	mov vw_setup, ra2
+	mov vw_addr, ra1
+	sub.setf r1, r1, 1
+	brr.allnz loop
+	add ra3, ra3, r2
+	add ra1, ra1, r2
+	mov -, vw_wait
+	mov host_int, 1
+	nop; nop; thrend
+	nop
+	nop
@@ -0,0 +1,34 @@
+/* Generated from Saxpy.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x159e6fc0, 0x10020027,	/* mov ra0, qpu_num */
+	0x15827d80, 0x10020067,	/* mov ra1, unif */
+	0x15827d80, 0x100200e7,	/* mov ra3, unif */
+	0x15827d80, 0x10021127,	/* mov rb4, unif */
+	0x15827d80, 0x10020867,	/* mov r1, unif */
+	0x159a7d80, 0x10020827,	/* mov r0, elem_num */
+	0x119c21c0, 0xd0020827,	/* shl r0, r0, 2 */
+	0x0c0e7c00, 0x100200e7,	/* add ra3, ra3, r0 */
+	0x0c067c00, 0x10020167,	/* add ra5, ra1, r0 */
+	0x00001a00, 0xe00208a7,	/* ldi r2, 0x1a00 */
+	0x15027c80, 0x10020127,	/* or ra4, ra0, r2 */
+	0x80904000, 0xe00208a7,	/* ldi r2, 0x80904000 */
+	0x11007dc0, 0xd00208e7,	/* shl r3, ra0, 7 */
+	0x159e74c0, 0x100200a7,	/* or ra2, r2, r3 */
+	0x00000040, 0xe00208a7,	/* ldi r2, 64 */
+	/* loop: */
+	0x150e7d80, 0x10020e27,	/* mov tmu0_s, ra3 */
+	0x15167d80, 0x10020e27,	/* mov tmu0_s, ra5 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 */
+	0x209c4027, 0x100049e0,	/* nop; fmul r0, r4, rb4 */
+	0x15127d80, 0xa0021c67,	/* mov vw_setup, ra4; nop; ldtmu0 */
+	0x019e7100, 0x10020c27,	/* fadd vpm, r0, r4 */
+	0x150a7d80, 0x10021c67,	/* mov vw_setup, ra2 */
+	0x15067d80, 0x10021ca7,	/* mov vw_addr, ra1 */
+	0x0d9c13c0, 0xd0022867,	/* sub.setf r1, r1, 1 */
+	0xffffff98, 0xf01809e7,	/* brr.allnz loop */
+	0x0c0e7c80, 0x100200e7,	/* add ra3, ra3, r2 */
+	0x0c167c80, 0x10020167,	/* add ra5, ra5, r2 */
+	0x8c072cbf, 0x10024067,	/* add ra1, ra1, r2; mov -, vw_wait */
+	0x159c1fc0, 0xd00209a7,	/* mov host_int, 1 */
+	0x009e7000, 0x300009e7,	/* nop; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop */
+	0x009e7000, 0x100009e7	/* nop */
@@ -0,0 +1,38 @@
+# QPU_KernelSaxpy, uniforms y, x, a, blocks, y = a * x + y.
+# ra0 QPU number (the VPM row), ra1 y, ra2 VDW setup for the row,
+# ra3 x + element * 4, ra5 y + element * 4, ra4 VPM write setup,
+# rb4 a, r1 blocks left, r2 64 (the bytes of a block).
+
+	mov ra0, qpu_num
+	mov ra1, unif
+	mov ra3, unif
+	mov rb4, unif
+	mov r1, unif
+	mov r0, elem_num
+	shl r0, r0, 2
+	add ra3, ra3, r0
+	add ra5, ra1, r0
+	ldi r2, 0x1a00
+	or ra4, ra0, r2
+	ldi r2, 0x80904000
+	shl r3, ra0, 7
+	or ra2, r2, r3
+	ldi r2, 64
+loop:
+	mov tmu0_s, ra3
+	mov tmu0_s, ra5
+	nop; nop; ldtmu0
+	nop; fmul r0, r4, rb4
+	mov vw_setup, ra4; nop; ldtmu0
+	fadd vpm, r0, r4
+	mov vw_setup, ra2
+	mov vw_addr, ra1
+	sub.setf r1, r1, 1
+	brr.allnz loop
+	add ra3, ra3, r2
+	add ra5, ra5, r2
+	add ra1, ra1, r2; mov -, vw_wait
+	mov host_int, 1
+	nop; nop; thrend
+	nop
+	nop
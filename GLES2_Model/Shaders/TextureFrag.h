@@ -0,0 +1,11 @@
+/* Generated from TextureFrag.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x158e7d80, 0x10020827,	/* mov r0, vary */
+	0x818e7176, 0x40024821,	/* fadd r0, r0, r5; mov r1, vary; sbwait */
+	0x818e7376, 0x10024862,	/* fadd r1, r1, r5; mov r2, vary */
+	0x159e7240, 0x10020e67,	/* mov tmu0_t, r1 */
+	0x159e7000, 0x10020e27,	/* mov tmu0_s, r0 */
+	0x159cffc0, 0x10020b27,	/* mov tlbz, rb15 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 (texel to r4) */
+	0x159e7900, 0x30020ba7,	/* mov tlbc, r4; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop; nop; nop */
+	0x009e7000, 0x500009e7	/* nop; nop; sbdone */
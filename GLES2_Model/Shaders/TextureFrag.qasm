@@ -0,0 +1,14 @@
+# Texturing fragment shader, varyings 0,1 are s,t (varying 2 is read and
+# dropped). Writing tmu0_s starts the lookup, the TMU takes the texture
+# config from the uniforms.
+
+	mov r0, vary
+	fadd r0, r0, r5; mov r1, vary; sbwait
+	fadd r1, r1, r5; mov r2, vary
+	mov tmu0_t, r1
+	mov tmu0_s, r0
+	mov tlbz, rb15
+	nop; nop; ldtmu0		# texel to r4
+	mov tlbc, r4; nop; thrend
+	nop; nop; nop
+	nop; nop; sbdone
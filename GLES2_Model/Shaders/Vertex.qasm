@@ -0,0 +1,52 @@
+# Vertex shader, same transform as Coord.qasm writing Xs|Ys, Zs, 1/Wc and
+# 3 varyings. The varyings are a grey shade from depth (1.0 - Zs) for the
+# fragment shader.
+
+	ldi vr_setup, 0x00301a00		# read x,y,z
+	ldi vw_setup, 0x00001a00
+	nop; nop
+	nop; nop
+	mov ra0, vpm
+	mov ra1, vpm
+	mov ra2, vpm
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra4, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra5, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd ra6, r0, unif
+	nop; fmul r0, ra0, unif
+	nop; fmul r1, ra1, unif
+	fadd r0, r0, r1; fmul r1, ra2, unif
+	fadd r0, r0, r1; nop
+	fadd r3, r0, unif
+	mov recip, r3; mov ra7, r3
+	nop; nop
+	nop; nop
+	nop; fmul r0, ra4, r4
+	nop; fmul r1, ra5, r4
+	nop; fmul r0, r0, 16.0
+	ftoi r0, r0; fmul r1, r1, 16.0
+	ftoi r1, r1; fmul r2, ra6, r4
+	shl r0, r0, 16
+	shr r0, r0, 16
+	shl r1, r1, 16
+	or vpm, r0, r1		# Xs/Ys
+	mov vpm, r2		# Zs
+	mov vpm, r4		# 1/Wc
+	fsub r3, 1.0, r2		# depth shade
+	mov vpm, r3		# red
+	mov vpm, r3		# green
+	mov vpm, r3		# blue
+	nop; nop; thrend
+	nop; nop
+	nop; nop
@@ -0,0 +1,242 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memcpy
+#include <math.h>								// Needed for sqrtf
+#include "rpi-Math3D.h"							// Need for VEC3, MATRIX3D and FRUSTUM3D
+#include "rpi-Cull.h"							// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Cull.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+#define CONE_MARGIN		0.01f					// Cone must face this far past edge on to be culled
+
+static uint32_t ClusterCount (uint32_t indexCount)
+{
+	return (indexCount / 3 + CULL_CLUSTER_TRIS - 1) / CULL_CLUSTER_TRIS;
+}
+
+static void GetPosition (const uint8_t* positions, uint32_t stride, uint16_t index, VEC3* v)
+{
+	memcpy(v, positions + (uint32_t)index * stride, sizeof(VEC3));	// Positions need not be aligned
+}
+
+/*-[Cull_MemorySize]--------------------------------------------------------}
+. RETURN: Bytes of memory Cull_BuildSet needs for an index list of
+.         indexCount indexes (4 byte alignment is enough)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Cull_MemorySize (uint32_t indexCount)
+{
+	uint32_t count = ClusterCount(indexCount);
+	return count * (sizeof(CULL_CLUSTER) + sizeof(VEC3) + sizeof(GLfloat) + 1);
+}
+
+/*-[Cull_BuildSet]----------------------------------------------------------}
+. Cuts the triangle index list into clusters in mem (Cull_MemorySize bytes)
+. and works out each one's sphere and normal cone from the x,y,z float
+. positions which are stride bytes apart. Triangles with no area take no
+. part in the cone. The index list must not change while the set is used.
+. RETURN: True set built, False a parameter is bad or mem is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Cull_BuildSet (CULL_SET* set, void* mem, uint32_t memSize,		// Set to build and its memory
+					const void* positions, uint32_t stride,			// x,y,z floats stride apart
+					const uint16_t* indices, uint32_t indexCount)	// Triangle list indexes
+{
+	if (!set) return false;
+	set->count = 0;
+	if (!mem || !positions || !indices || stride < sizeof(VEC3) || indexCount < 3
+		|| memSize < Cull_MemorySize(indexCount)) return false;
+	uint32_t count = ClusterCount(indexCount);
+	set->cluster = (CULL_CLUSTER*)mem;								// Largest items first keeps them aligned
+	set->centre = (VEC3*)&set->cluster[count];
+	set->radius = (GLfloat*)&set->centre[count];
+	set->visible = (uint8_t*)&set->radius[count];
+	set->count = count;
+
+	const uint8_t* pos = (const uint8_t*)positions;
+	VEC3 meshMin = { 0 }, meshMax = { 0 };
+	for (uint32_t c = 0; c < count; c++) {
+		CULL_CLUSTER* cl = &set->cluster[c];
+		cl->firstIndex = c * CULL_CLUSTER_TRIS * 3;
+		cl->indexCount = (indexCount / 3) * 3 - cl->firstIndex;
+		if (cl->indexCount > CULL_CLUSTER_TRIS * 3) cl->indexCount = CULL_CLUSTER_TRIS * 3;
+		const uint16_t* idx = &indices[cl->firstIndex];
+
+		// Bounds give the sphere centre and the normals sum to the cone axis
+		VEC3 lo, hi, axis = { 0 };
+		GetPosition(pos, stride, idx[0], &lo);
+		hi = lo;
+		cl->maxIndex = 0;
+		for (uint32_t i = 0; i < cl->indexCount; i += 3) {
+			VEC3 v[3], e1, e2, n;
+			for (int k = 0; k < 3; k++) {
+				GetPosition(pos, stride, idx[i + k], &v[k]);
+				if (idx[i + k] > cl->maxIndex) cl->maxIndex = idx[i + k];
+				if (v[k].x < lo.x) lo.x = v[k].x;
+				if (v[k].y < lo.y) lo.y = v[k].y;
+				if (v[k].z < lo.z) lo.z = v[k].z;
+				if (v[k].x > hi.x) hi.x = v[k].x;
+				if (v[k].y > hi.y) hi.y = v[k].y;
+				if (v[k].z > hi.z) hi.z = v[k].z;
+			}
+			e1 = (VEC3) { v[1].x - v[0].x, v[1].y - v[0].y, v[1].z - v[0].z };
+			e2 = (VEC3) { v[2].x - v[0].x, v[2].y - v[0].y, v[2].z - v[0].z };
+			Vec3_Cross(&n, &e1, &e2);
+			Vec3_Normalize(&n);										// Zero area stays zero so adds nothing
+			axis.x += n.x;
+			axis.y += n.y;
+			axis.z += n.z;
+		}
+		VEC3* centre = &set->centre[c];
+		*centre = (VEC3) { (lo.x + hi.x) * 0.5f, (lo.y + hi.y) * 0.5f, (lo.z + hi.z) * 0.5f };
+		GLfloat r2 = 0.0f;
+		for (uint32_t i = 0; i < cl->indexCount; i++) {				// Radius about the bounds centre
+			VEC3 v;
+			GetPosition(pos, stride, idx[i], &v);
+			GLfloat dx = v.x - centre->x, dy = v.y - centre->y, dz = v.z - centre->z;
+			GLfloat d2 = dx * dx + dy * dy + dz * dz;
+			if (d2 > r2) r2 = d2;
+		}
+		set->radius[c] = sqrtf(r2);
+
+		// Cone cutoff is the widest face normal from the axis
+		GLfloat len = sqrtf(Vec3_Dot(&axis, &axis));
+		cl->coneCutoff = -1.0f;										// Until shown otherwise never culled
+		if (len > 0.0f) {
+			cl->coneAxis = (VEC3) { axis.x / len, axis.y / len, axis.z / len };
+			cl->coneCutoff = 1.0f;
+			for (uint32_t i = 0; i < cl->indexCount; i += 3) {
+				VEC3 v[3], e1, e2, n;
+				for (int k = 0; k < 3; k++) GetPosition(pos, stride, idx[i + k], &v[k]);
+				e1 = (VEC3) { v[1].x - v[0].x, v[1].y - v[0].y, v[1].z - v[0].z };
+				e2 = (VEC3) { v[2].x - v[0].x, v[2].y - v[0].y, v[2].z - v[0].z };
+				Vec3_Cross(&n, &e1, &e2);
+				if (Vec3_Dot(&n, &n) == 0.0f) continue;				// No area so no facing
+				Vec3_Normalize(&n);
+				GLfloat c = Vec3_Dot(&n, &cl->coneAxis);
+				if (c < cl->coneCutoff) cl->coneCutoff = c;
+			}
+		} else cl->coneAxis = (VEC3) { 0.0f, 0.0f, 0.0f };
+
+		if (c == 0) {
+			meshMin = lo;
+			meshMax = hi;
+		} else {
+			if (lo.x < meshMin.x) meshMin.x = lo.x;
+			if (lo.y < meshMin.y) meshMin.y = lo.y;
+			if (lo.z < meshMin.z) meshMin.z = lo.z;
+			if (hi.x > meshMax.x) meshMax.x = hi.x;
+			if (hi.y > meshMax.y) meshMax.y = hi.y;
+			if (hi.z > meshMax.z) meshMax.z = hi.z;
+		}
+	}
+
+	// The mesh sphere holds every cluster sphere
+	set->meshCentre = (VEC3) { (meshMin.x + meshMax.x) * 0.5f, (meshMin.y + meshMax.y) * 0.5f,
+		(meshMin.z + meshMax.z) * 0.5f };
+	set->meshRadius = 0.0f;
+	for (uint32_t c = 0; c < count; c++) {
+		GLfloat dx = set->centre[c].x - set->meshCentre.x;
+		GLfloat dy = set->centre[c].y - set->meshCentre.y;
+		GLfloat dz = set->centre[c].z - set->meshCentre.z;
+		GLfloat r = sqrtf(dx * dx + dy * dy + dz * dz) + set->radius[c];
+		if (r > set->meshRadius) set->meshRadius = r;
+	}
+	return true;
+}
+
+/*-[Cull_Visible]-----------------------------------------------------------}
+. Tests the clusters against the screen matrix mvp of a width x height
+. screen with the CULL_xxx flags and writes the runs of index list left to
+. draw to runs, which must hold set->count entries. Flags 0 gives one run
+. of the whole list. stats may be NULL.
+. RETURN: Number of runs (0 nothing on screen)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Cull_Visible (const CULL_SET* set, const MATRIX3D* mvp,		// Clusters and screen matrix
+					   uint32_t width, uint32_t height,				// Screen size in pixels
+					   uint32_t flags,								// CULL_xxx tests to make
+					   CULL_RUN* runs, CULL_STATS* stats)			// Runs out and counts
+{
+	CULL_STATS st = { 0 };
+	uint32_t runCount = 0;
+	if (!set || !mvp || !runs || set->count == 0) {
+		if (stats) *stats = st;
+		return 0;
+	}
+	st.clusters = set->count;
+	const CULL_CLUSTER* last = &set->cluster[set->count - 1];
+	st.trisTotal = (last->firstIndex + last->indexCount) / 3;
+	memset(set->visible, 1, set->count);
+
+	if ((flags & CULL_FRUSTUM) && width && height) {
+		// Screen x 0..width, y 0..height, z 0..1 to the -1..1 clip cube the frustum planes want
+		MATRIX3D clip = MATRIX3D_INIT(2.0f / width, 0.0f, 0.0f, -1.0f,  0.0f, 2.0f / height, 0.0f, -1.0f,
+									  0.0f, 0.0f, 2.0f, -1.0f,  0.0f, 0.0f, 0.0f, 1.0f);
+		FRUSTUM3D f;
+		Matrix3D_Multiply(&clip, &clip, mvp);
+		Frustum3D_FromMatrix(&f, &clip);
+		if (!Frustum3D_SphereVisible(&f, &set->meshCentre, set->meshRadius)) {
+			st.offScreen = set->count;								// Whole mesh is off screen
+			if (stats) *stats = st;
+			return 0;
+		}
+		st.offScreen = set->count - Frustum3D_CullSpheres(&f, set->centre, set->radius, set->visible, set->count);
+	}
+
+	if (flags & CULL_BACKFACE) {
+		// Model space view direction d has mvp * d = (0,0,+1), away from the viewer
+		const VEC3 r0 = { mvp->coef[0][0], mvp->coef[0][1], mvp->coef[0][2] };
+		const VEC3 r1 = { mvp->coef[1][0], mvp->coef[1][1], mvp->coef[1][2] };
+		const VEC3 r2 = { mvp->coef[2][0], mvp->coef[2][1], mvp->coef[2][2] };
+		VEC3 d;
+		Vec3_Cross(&d, &r0, &r1);
+		GLfloat det = Vec3_Dot(&d, &r2);
+		Vec3_Normalize(&d);
+		if (det < 0.0f) d = (VEC3) { -d.x, -d.y, -d.z };
+		if (det != 0.0f) {
+			for (uint32_t c = 0; c < set->count; c++) {
+				const CULL_CLUSTER* cl = &set->cluster[c];
+				if (!set->visible[c] || cl->coneCutoff <= 0.0f) continue;	// Cone of 90 degrees or more always has a front
+				// Every normal within acos(cutoff) of the axis faces away once the axis is that far past edge on
+				GLfloat sinCone = sqrtf(1.0f - cl->coneCutoff * cl->coneCutoff);
+				if (Vec3_Dot(&cl->coneAxis, &d) > sinCone + CONE_MARGIN) {
+					set->visible[c] = 0;
+					st.backFacing++;
+				}
+			}
+		}
+	}
+
+	// Clusters that are left and follow one another in the index list become one run
+	for (uint32_t c = 0; c < set->count; c++) {
+		const CULL_CLUSTER* cl = &set->cluster[c];
+		if (!set->visible[c]) continue;
+		st.trisSubmitted += cl->indexCount / 3;
+		if (runCount && (runs[runCount - 1].firstIndex + runs[runCount - 1].indexCount == cl->firstIndex)) {
+			CULL_RUN* r = &runs[runCount - 1];
+			r->indexCount += cl->indexCount;
+			if (cl->maxIndex > r->maxIndex) r->maxIndex = cl->maxIndex;
+		} else runs[runCount++] = (CULL_RUN) { cl->firstIndex, cl->indexCount, cl->maxIndex };
+	}
+	st.runs = runCount;
+	if (stats) *stats = st;
+	return runCount;
+}
@@ -0,0 +1,129 @@
+#ifndef _RPI_CULL_
+#define _RPI_CULL_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Cull.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Coarse CPU culling of a triangle list before it goes to the binner. The  }
+{  index list is cut into clusters of CULL_CLUSTER_TRIS triangles that     }
+{  follow one another in the list, so a mesh MeshConvert has put in vertex  }
+{  cache order gives tight clusters. Each cluster keeps a bounding sphere   }
+{  and a cone holding all its face normals. Each frame:                     }
+{                                                                           }
+{  1) The whole mesh sphere then each cluster sphere is tested against the  }
+{     frustum of the screen matrix (Frustum3D_CullSpheres).                 }
+{  2) A cluster whose whole normal cone faces away from the viewer has no   }
+{     triangle that can be seen so is dropped.                              }
+{  3) Clusters left are merged into runs of the index list, one indexed     }
+{     primitive list a run, so a mostly visible mesh is still few lists.    }
+{                                                                           }
+{  The screen matrix is affine (no perspective) taking the model to pixel   }
+{  x,y and depth z 0..1 with smaller z nearer, as DoRotate builds it.       }
+{  Face normals are (v1-v0) x (v2-v0), OBJ counter clockwise front faces.   }
+{                                                                           }
+{  The module has no hardware dependencies so it also builds on a host.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-Math3D.h"							// Need for VEC3, MATRIX3D and FRUSTUM3D
+
+#define CULL_CLUSTER_TRIS	64					// Triangles a cluster (the last may have fewer)
+
+#define CULL_FRUSTUM		0x01				// Drop clusters off the screen
+#define CULL_BACKFACE		0x02				// Drop clusters facing wholly away
+
+/* Triangles of one cluster and the cone all their face normals lie in */
+typedef struct cull_cluster {
+	uint32_t firstIndex;						// First index of the cluster in the index list
+	uint32_t indexCount;						// Indexes, 3 a triangle
+	uint32_t maxIndex;							// Largest vertex index the cluster uses
+	VEC3 coneAxis;								// Unit mean face normal
+	GLfloat coneCutoff;							// Least cosine of a face normal to the axis (-1 never culled)
+} CULL_CLUSTER;
+
+/* Clusters of a mesh, the spheres held apart for the SIMD sphere test */
+typedef struct cull_set {
+	CULL_CLUSTER* cluster;						// count clusters in index list order
+	VEC3* centre;								// Bounding sphere centre of each cluster
+	GLfloat* radius;							// Bounding sphere radius of each cluster
+	uint8_t* visible;							// Frustum test work, a byte a cluster
+	uint32_t count;								// Number of clusters
+	VEC3 meshCentre;							// Bounding sphere of the whole mesh
+	GLfloat meshRadius;
+} CULL_SET;
+
+/* A stretch of the index list to draw */
+typedef struct cull_run {
+	uint32_t firstIndex;						// First index of the run
+	uint32_t indexCount;						// Indexes in the run
+	uint32_t maxIndex;							// Largest vertex index the run uses
+} CULL_RUN;
+
+/* What the last Cull_Visible did */
+typedef struct cull_stats {
+	uint32_t clusters;							// Clusters tested
+	uint32_t offScreen;							// Clusters dropped by the frustum
+	uint32_t backFacing;						// Clusters dropped facing away
+	uint32_t trisTotal;							// Triangles in the mesh
+	uint32_t trisSubmitted;						// Triangles in the runs
+	uint32_t runs;								// Runs (primitive lists) made
+} CULL_STATS;
+
+/*-[Cull_MemorySize]--------------------------------------------------------}
+. RETURN: Bytes of memory Cull_BuildSet needs for an index list of
+.         indexCount indexes (4 byte alignment is enough)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Cull_MemorySize (uint32_t indexCount);
+
+/*-[Cull_BuildSet]----------------------------------------------------------}
+. Cuts the triangle index list into clusters in mem (Cull_MemorySize bytes)
+. and works out each one's sphere and normal cone from the x,y,z float
+. positions which are stride bytes apart. Triangles with no area take no
+. part in the cone. The index list must not change while the set is used.
+. RETURN: True set built, False a parameter is bad or mem is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Cull_BuildSet (CULL_SET* set, void* mem, uint32_t memSize,		// Set to build and its memory
+					const void* positions, uint32_t stride,			// x,y,z floats stride apart
+					const uint16_t* indices, uint32_t indexCount);	// Triangle list indexes
+
+/*-[Cull_Visible]-----------------------------------------------------------}
+. Tests the clusters against the screen matrix mvp of a width x height
+. screen with the CULL_xxx flags and writes the runs of index list left to
+. draw to runs, which must hold set->count entries. Flags 0 gives one run
+. of the whole list. stats may be NULL.
+. RETURN: Number of runs (0 nothing on screen)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Cull_Visible (const CULL_SET* set, const MATRIX3D* mvp,		// Clusters and screen matrix
+					   uint32_t width, uint32_t height,				// Screen size in pixels
+					   uint32_t flags,								// CULL_xxx tests to make
+					   CULL_RUN* runs, CULL_STATS* stats);			// Runs out and counts
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
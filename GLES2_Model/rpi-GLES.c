@@ -5,7 +5,14 @@
 #include "emb-stdio.h"
 #include "rpi-smartstart.h"						// Need for mailbox
 #include "rpi-GLES.h"
+#include "rpi-V3DList.h"						// Control list builder
+#include "rpi-SoftRaster.h"					// ARM software render of the binning lists
+#include "rpi-MeshFile.h"						// Binary mesh cache
+#include "rpi-Texture.h"						// Texture T/LT-format layout and mipmaps
 #include "SDCard.h"
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>							// Pi2/Pi3 builds have NEON for the batched vertex transform
+#endif
 
 /* REFERENCES */
 /* https://docs.broadcom.com/docs/12358545 */
@@ -101,6 +108,9 @@
 #define V3D_PCTR15  (0x6f8>>2) // Performance Counter Count 15
 #define V3D_PCTRS15 (0x6fc>>2) // Performance Counter Mapping 15
 
+#define V3D_DBQITE  (0xe2c>>2) // QPU Interrupt Enables
+#define V3D_DBQITC  (0xe30>>2) // QPU Interrupt Control
+
 #define V3D_DBGE    (0xf00>>2) // PSE Error Signals
 #define V3D_FDBGO   (0xf04>>2) // FEP Overrun Error Signals
 #define V3D_FDBGB   (0xf08>>2) // FEP Interface Ready and Stall Signals, FEP Busy Signals
@@ -122,73 +132,6 @@ enum {
 	MEM_FLAG_HINT_PERMALOCK = 1 << 6,			/* Likely to be locked for long periods of time. */
 };
 
-/* primitive type in the GL pipline */
-typedef enum {
-	PRIM_POINT = 0,
-	PRIM_LINE = 1,
-	PRIM_LINE_LOOP = 2,
-	PRIM_LINE_STRIP = 3,
-	PRIM_TRIANGLE = 4,
-	PRIM_TRIANGLE_STRIP = 5,
-	PRIM_TRIANGLE_FAN = 6,
-} PRIMITIVE;
-
-
-/* These come from the blob information header .. they start at   KHRN_HW_INSTR_HALT */
-/* https://github.com/raspberrypi/userland/blob/a1b89e91f393c7134b4cdc36431f863bb3333163/middleware/khronos/common/2708/khrn_prod_4.h */
-/* GL pipe control commands */
-typedef enum {
-	GL_HALT = 0,
-	GL_NOP = 1,
-	GL_FLUSH = 4,
-	GL_FLUSH_ALL_STATE = 5,
-	GL_START_TILE_BINNING = 6,
-	GL_INCREMENT_SEMAPHORE = 7,
-	GL_WAIT_ON_SEMAPHORE = 8,
-	GL_BRANCH = 16,
-	GL_BRANCH_TO_SUBLIST = 17,
-	GL_RETURN_FROM_SUBLIST = 18,
-	GL_STORE_MULTISAMPLE = 24,
-	GL_STORE_MULTISAMPLE_END = 25,
-	GL_STORE_FULL_TILE_BUFFER = 26,
-	GL_RELOAD_FULL_TILE_BUFFER = 27,
-	GL_STORE_TILE_BUFFER = 28,
-	GL_LOAD_TILE_BUFFER = 29,
-	GL_INDEXED_PRIMITIVE_LIST = 32,
-	GL_VERTEX_ARRAY_PRIMITIVES = 33,
-	GL_VG_COORDINATE_ARRAY_PRIMITIVES = 41,
-	GL_COMPRESSED_PRIMITIVE_LIST = 48,
-	GL_CLIP_COMPRESSD_PRIMITIVE_LIST = 49,
-	GL_PRIMITIVE_LIST_FORMAT = 56,
-	GL_SHADER_STATE = 64,
-	GL_NV_SHADER_STATE = 65,
-	GL_VG_SHADER_STATE = 66,
-	GL_VG_INLINE_SHADER_RECORD = 67,
-	GL_CONFIG_STATE = 96,
-	GL_FLAT_SHADE_FLAGS = 97,
-	GL_POINTS_SIZE = 98,
-	GL_LINE_WIDTH = 99,
-	GL_RHT_X_BOUNDARY = 100,
-	GL_DEPTH_OFFSET = 101,
-	GL_CLIP_WINDOW = 102,
-	GL_VIEWPORT_OFFSET = 103,
-	GL_Z_CLIPPING_PLANES = 104,
-	GL_CLIPPER_XY_SCALING = 105,
-	GL_CLIPPER_Z_ZSCALE_OFFSET = 106, 
-	GL_TILE_BINNING_CONFIG = 112,
-	GL_TILE_RENDER_CONFIG = 113,
-	GL_CLEAR_COLORS = 114,
-	GL_TILE_COORDINATES = 115
-}  GL_CONTROL;
-
-
-struct __attribute__((__packed__, aligned(1))) EMITDATA {
-	uint8_t byte1;
-	uint8_t byte2;
-	uint8_t byte3;
-	uint8_t byte4;
-};
-
 
 /* Our vertex shader text we will compile */
 char vShaderStr[] =
@@ -213,300 +156,488 @@ char fShaderStr[] =
 "}                                                   \n";
 
 
-/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
-{                           3D VECTOR ROUTINES                              }
-{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+bool InitV3D (void) {
+	if (mailbox_tag_message(0, 9,
+		MAILBOX_TAG_SET_CLOCK_RATE, 8, 8,
+		CLK_V3D_ID, 250000000,
+		MAILBOX_TAG_ENABLE_QPU, 4, 4, 1)) {
+		if (v3d[V3D_IDENT0] == 0x02443356) { // Magic number.
+			// Performance counters 0..5 count the culling figures V3D_FRAME_TIMES reports
+			v3d[V3D_PCTRE] = 0;										// Counters off while mapped
+			v3d[V3D_PCTRS0] = 10;									// PLB primitives outside the viewport
+			v3d[V3D_PCTRS1] = 11;									// PLB primitives needing clipping
+			v3d[V3D_PCTRS2] = 1;									// FEP valid primitives
+			v3d[V3D_PCTRS3] = 0;									// FEP valid primitives with no pixels
+			v3d[V3D_PCTRS4] = 3;									// FEP valid quads
+			v3d[V3D_PCTRS5] = 2;									// FEP early Z/near/far clipped quads
+			v3d[V3D_PCTRC] = 0x3F;									// Clear them
+			v3d[V3D_PCTRE] = 0x8000003F;							// Enable counters 0..5
+			if ((v3d[V3D_VPMBASE] & 0x1F) < 4)						// 16 VPM rows (1K) kept from the vertex
+				v3d[V3D_VPMBASE] = 4;								// pipe for user program kernels
+			return true;
+		}
+	}
+	return false;
+}
 
-/*--------------------------------------------------------------------------}
-{ Returns the dot product between the two vectors v1 & v2					}
-{ 14Sep2017 LdB                                                             }
-{--------------------------------------------------------------------------*/
-GLfloat vec3_dot (VEC3 v1, VEC3 v2) {
-	return (v1.x * v2.x + v1.y * v2.y + v1.z * v2.z);
+uint32_t V3D_mem_alloc (uint32_t size, uint32_t align, uint32_t flags)
+{
+	uint32_t buffer[6];
+	if (mailbox_tag_message(&buffer[0], 6,
+		MAILBOX_TAG_ALLOCATE_MEMORY, 12, 12, size, align, flags)) {
+		return buffer[3];
+	}
+	return 0;
 }
 
-/*--------------------------------------------------------------------------}
-{ Returns the cross product between the two vectors v1 & v2					}
-{ 14Sep2017 LdB                                                             }
-{--------------------------------------------------------------------------*/
-VEC3 vec3_cross (VEC3 v1, VEC3 v2) {
-	VEC3 result = { .x = v1.y * v2.z - v1.z * v2.y,
-		.y = v1.z * v2.x - v1.x * v2.z,
-		.z = v1.x * v2.y - v1.y * v2.x };
-	return result;
+bool V3D_mem_free (uint32_t handle)
+{
+	return (mailbox_tag_message(0, 4,
+		MAILBOX_TAG_RELEASE_MEMORY, 4, 4, handle));
 }
 
+uint32_t V3D_mem_lock (uint32_t handle)
+{
+	uint32_t buffer[4];
+	if (mailbox_tag_message(&buffer[0], 4,
+		MAILBOX_TAG_LOCK_MEMORY, 4, 4, handle)) {
+		return buffer[3];
+	}
+	return 0;
+}
+
+bool V3D_mem_unlock (uint32_t handle)
+{
+	return (mailbox_tag_message(0, 4,
+		MAILBOX_TAG_UNLOCK_MEMORY, 4, 4, handle));
+}
+
+bool V3D_execute_code (uint32_t code, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3, uint32_t r4, uint32_t r5)
+{
+	return (mailbox_tag_message(0, 10,
+		MAILBOX_TAG_EXECUTE_CODE, 28, 28,
+		code, r0, r1, r2, r3, r4, r5));
+}
+
+bool V3D_execute_qpu (int32_t num_qpus, uint32_t control, uint32_t noflush, uint32_t timeout) 
+{
+	return (mailbox_tag_message(0, 7,
+		MAILBOX_TAG_EXECUTE_QPU, 16, 16,
+		num_qpus, control, noflush, timeout));
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                      V3D FRAME SUBMISSION QUEUE                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/* The binner (CT0) and renderer (CT1) are separate control list threads so */
+/* frame N+1 can bin while frame N renders as long as each frame in flight  */
+/* has its own tile memory and lists. Frames bin and render in submit order */
+/* and tickets count up from 1 so a frame is done when its ticket is at or  */
+/* below the last rendered ticket. The queue is advanced by V3D_PollFrames  */
+/* or by V3D_IrqHandler when the V3D interrupt is enabled.                  */
+#define V3D_INT_FRDONE		0x01									// Render frame done interrupt
+#define V3D_INT_FLDONE		0x02									// Binning flush done interrupt
+#define V3D_INT_OUTOMEM		0x04									// Binner out of tile allocation memory
+#define V3D_GPU_IRQ			10										// V3D is GPU IRQ 10 (bank 1)
+#define IRQ_ENABLE1 (*(volatile uint32_t*)(uintptr_t)(RPi_IO_Base_Addr + 0xB210))
+#define IRQ_DISABLE1 (*(volatile uint32_t*)(uintptr_t)(RPi_IO_Base_Addr + 0xB21C))
+
+static struct v3d_frame {
+	uint32_t ticket;												// Ticket of frame in this entry
+	uint32_t binStart;												// VC4 binning control list start
+	uint32_t binEnd;												// VC4 binning control list end
+	uint32_t renderStart;											// VC4 render control list start
+	uint32_t renderEnd;												// VC4 render control list end
+	uint32_t overflow;												// VC4 binner overflow memory
+	uint32_t overflowSize;											// Binner overflow memory size
+	uint32_t binCount[2];											// PLB counters when binning started
+	uint32_t renderCount[4];										// FEP counters when rendering started
+	V3D_FRAME_TIMES times;											// Timestamps of the frame
+} frameQ[V3D_MAX_FRAMES] = { 0 };
+
+static volatile uint32_t submitTicket = 0;							// Last ticket submitted
+static volatile uint32_t binTicket = 0;								// Ticket binning (0 = binner idle)
+static volatile uint32_t binnedTicket = 0;							// Last ticket binning completed
+static volatile uint32_t renderTicket = 0;							// Ticket rendering (0 = renderer idle)
+static volatile uint32_t doneTicket = 0;							// Last ticket rendering completed
+static bool frameIrq = false;										// V3D interrupt drives the queue
+
 /*--------------------------------------------------------------------------}
-{ Returns the subtraction of v2 from v1										}
-{ 14Sep2017 LdB                                                             }
+{ Advances the queue, must not be re-entered (irq or interrupts disabled)   }
 {--------------------------------------------------------------------------*/
-VEC3 vec3_sub (VEC3 v1, VEC3 v2) {
-	VEC3 result = { .x = v1.x - v2.x, 
-		            .y = v1.y - v2.y, 
-					.z = v1.z - v2.z };
-	return result;
+static void AdvanceFrames (void)
+{
+	uint64_t now = timer_getTickCount();
+	if (binTicket && v3d[V3D_BFC]) {								// Binner has flushed the frame
+		struct v3d_frame* f = &frameQ[binTicket % V3D_MAX_FRAMES];
+		f->times.binDoneTick = now;
+		f->times.plbOutside = v3d[V3D_PCTR0] - f->binCount[0];		// Only one frame bins at a time
+		f->times.plbClipped = v3d[V3D_PCTR1] - f->binCount[1];
+		if (f->overflowSize && (v3d[V3D_BPOS] == 0))				// Binner took the overflow block
+			f->times.binOverflow = f->overflowSize - v3d[V3D_BPCS];	// It is the current pool, less what is left
+		binnedTicket = binTicket;
+		binTicket = 0;
+	}
+	if (renderTicket && v3d[V3D_RFC]) {								// Renderer has finished the frame
+		struct v3d_frame* f = &frameQ[renderTicket % V3D_MAX_FRAMES];
+		f->times.renderDoneTick = now;
+		f->times.fepPrims = v3d[V3D_PCTR2] - f->renderCount[0];		// Only one frame renders at a time
+		f->times.fepNoPixels = v3d[V3D_PCTR3] - f->renderCount[1];
+		f->times.fepQuads = v3d[V3D_PCTR4] - f->renderCount[2];
+		f->times.fepEarlyZ = v3d[V3D_PCTR5] - f->renderCount[3];
+		doneTicket = renderTicket;
+		renderTicket = 0;
+	}
+	if ((binTicket == 0) && (binnedTicket < submitTicket)) {		// Binner idle and a frame is waiting
+		struct v3d_frame* f = &frameQ[(binnedTicket + 1) % V3D_MAX_FRAMES];
+		v3d[V3D_L2CACTL] = 4;										// Clear L2 cache
+		v3d[V3D_SLCACTL] = 0x0F0F0F0F;								// Clear slice caches
+		v3d[V3D_CT0CS] = 0x20;										// Stop the binning thread
+		while (v3d[V3D_CT0CS] & 0x20);								// Wait for it to stop
+		v3d[V3D_BFC] = 1;											// Reset binning frame count
+		v3d[V3D_INTCTL] = V3D_INT_OUTOMEM;							// Clear any old out of memory
+		v3d[V3D_BPOA] = f->overflow;								// Overflow the binner moves to when the
+		v3d[V3D_BPOS] = f->overflowSize;							// tile allocation memory runs out
+		f->times.binStartTick = timer_getTickCount();
+		f->binCount[0] = v3d[V3D_PCTR0];
+		f->binCount[1] = v3d[V3D_PCTR1];
+		binTicket = f->ticket;
+		v3d[V3D_CT0CA] = f->binStart;								// Binning list start
+		v3d[V3D_CT0EA] = f->binEnd;									// Writing end address starts the thread
+	}
+	if ((renderTicket == 0) && (doneTicket < binnedTicket)) {		// Renderer idle and a frame is binned
+		struct v3d_frame* f = &frameQ[(doneTicket + 1) % V3D_MAX_FRAMES];
+		v3d[V3D_CT1CS] = 0x20;										// Stop the render thread
+		while (v3d[V3D_CT1CS] & 0x20);								// Wait for it to stop
+		v3d[V3D_RFC] = 1;											// Reset rendering frame count
+		f->times.renderStartTick = timer_getTickCount();
+		f->renderCount[0] = v3d[V3D_PCTR2];
+		f->renderCount[1] = v3d[V3D_PCTR3];
+		f->renderCount[2] = v3d[V3D_PCTR4];
+		f->renderCount[3] = v3d[V3D_PCTR5];
+		renderTicket = f->ticket;
+		v3d[V3D_CT1CA] = f->renderStart;							// Render list start
+		v3d[V3D_CT1EA] = f->renderEnd;								// Writing end address starts the thread
+	}
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the addition of v2 to v1											}
-{ 14Sep2017 LdB                                                             }
+{ Non blocking, starts binning/rendering of queued frames as the hardware   }
+{ frees up and retires finished ones.                                       }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-VEC3 vec3_add (VEC3 v1, VEC3 v2) {
-	VEC3 result = { .x = v1.x - v2.x,
-				    .y = v1.y - v2.y,
-					.z = v1.z - v2.z };
-	return result;
+bool V3D_PollFrames (void)
+{
+	if (frameIrq) {													// Interrupt also advances the queue
+		IRQ_DISABLE1 = (1 << V3D_GPU_IRQ);							// Mask only the V3D irq, the caller's
+		__sync_synchronize();										// irq state is left as it was
+		AdvanceFrames();
+		__sync_synchronize();
+		IRQ_ENABLE1 = (1 << V3D_GPU_IRQ);							// Unmask it, a pending irq fires now
+	} else AdvanceFrames();
+	return (doneTicket != submitTicket);
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the scale of v1 by scale s										}
-{ 14Sep2017 LdB                                                             }
+{ Queues a frame given its binning and render control lists and returns at  }
+{ once unless V3D_MAX_FRAMES are already in flight. The caller must not     }
+{ reuse the lists, tile memory or vertex data of a frame until it is done.  }
+{ The overflow block is preloaded for the binner to take if it runs out.    }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-VEC3 vec3_scale (VEC3 v, GLfloat s) {
-	VEC3 result = { .x = v.x * s,
-					.y = v.y * s,
-					.z = v.z * s };
-	return result;
+uint32_t V3D_SubmitFrame (uint32_t binStart, uint32_t binEnd, uint32_t renderStart, uint32_t renderEnd,
+						  uint32_t overflow, uint32_t overflowSize)
+{
+	while (submitTicket - doneTicket >= V3D_MAX_FRAMES) V3D_PollFrames();	// Queue full wait for a frame
+	struct v3d_frame* f = &frameQ[(submitTicket + 1) % V3D_MAX_FRAMES];
+	f->ticket = submitTicket + 1;
+	f->binStart = binStart;
+	f->binEnd = binEnd;
+	f->renderStart = renderStart;
+	f->renderEnd = renderEnd;
+	f->overflow = overflow;
+	f->overflowSize = overflow ? overflowSize : 0;
+	f->times = (V3D_FRAME_TIMES) { 0 };
+	f->times.submitTick = timer_getTickCount();
+	submitTicket = f->ticket;										// Frame is now visible to the queue
+	V3D_PollFrames();												// Start it if the binner is idle
+	return f->ticket;
 }
 
-/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
-{                           3D MATRIX ROUTINES                              }
-{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-
 /*--------------------------------------------------------------------------}
-{                  IDENTITY MATRIX3D (4x4 MATRIX) DEFINITION                }
+{ Non blocking check if the frame with the ticket has finished rendering.   }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-const MATRIX3D IdentityMatrix3D = {
-	.coef[0][0] = GLFLOAT_ONE,.coef[0][1] = GLFLOAT_ZERO,.coef[0][2] = GLFLOAT_ZERO,.coef[0][3] = GLFLOAT_ZERO,
-	.coef[1][0] = GLFLOAT_ZERO,.coef[1][1] = GLFLOAT_ONE,.coef[1][2] = GLFLOAT_ZERO,.coef[1][3] = GLFLOAT_ZERO,
-	.coef[2][0] = GLFLOAT_ZERO,.coef[2][1] = GLFLOAT_ZERO,.coef[2][2] = GLFLOAT_ONE,.coef[2][3] = GLFLOAT_ZERO,
-	.coef[3][0] = GLFLOAT_ZERO,.coef[3][1] = GLFLOAT_ZERO,.coef[3][2] = GLFLOAT_ZERO,.coef[3][3] = GLFLOAT_ONE };
+bool V3D_FrameDone (uint32_t ticket)
+{
+	if (ticket > doneTicket) V3D_PollFrames();						// Not done at last look so poll
+	return (ticket <= doneTicket);
+}
 
 /*--------------------------------------------------------------------------}
-{ Returns the X rotation matrix in MATRIX3D from the given angle in radians }
-{ 14Sep2017 LdB                                                             }
+{ Waits until the frame with the ticket has finished rendering.             }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D XRotationMatrix3D(GLfloat angle_in_rad) {
-	GLfloat sineValue = sinf(angle_in_rad);						// Sine of angle
-	GLfloat cosineValue = cosf(angle_in_rad);						// Cosine of angle
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[1][1] = cosineValue;										// Coef[0][0] = cos
-	m.coef[1][2] = -sineValue;										// Coef[0][1] = -sin
-	m.coef[2][1] = sineValue;										// Coef[1][0] = sin
-	m.coef[2][2] = cosineValue;										// Coef[1][1] = cos
-	return(m);														// Return the matrix
+void V3D_WaitFrame (uint32_t ticket)
+{
+	while (!V3D_FrameDone(ticket)) {};
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the Y rotation matrix in MATRIX3D from the given angle in radians }
-{ 14Sep2017 LdB                                                             }
+{ Waits until every submitted frame has finished rendering.                 }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D YRotationMatrix3D(GLfloat angle_in_rad) {
-	GLfloat sineValue = sinf(angle_in_rad);							// Sine of angle
-	GLfloat cosineValue = cosf(angle_in_rad);						// Cosine of angle
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[0][0] = cosineValue;										// Coef[0][0] = cos
-	m.coef[0][2] = -sineValue;										// Coef[0][1] = -sin
-	m.coef[2][0] = sineValue;										// Coef[1][0] = sin
-	m.coef[2][2] = cosineValue;										// Coef[1][1] = cos
-	return(m);														// Return the matrix
+void V3D_WaitIdle (void)
+{
+	V3D_WaitFrame(submitTicket);
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the Z rotation matrix in MATRIX3D from the given angle in radians }
-{ 14Sep2017 LdB                                                             }
+{ Copies the usec timestamps of a finished frame, only the last             }
+{ V3D_MAX_FRAMES tickets are held.                                          }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D ZRotationMatrix3D(GLfloat angle_in_rad) {
-	GLfloat sineValue = sinf(angle_in_rad);							// Sine of angle
-	GLfloat cosineValue = cosf(angle_in_rad);						// Cosine of angle
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[0][0] = cosineValue;										// Coef[0][0] = cos
-	m.coef[0][1] = -sineValue;										// Coef[0][1] = -sin
-	m.coef[1][0] = sineValue;										// Coef[1][0] = sin
-	m.coef[1][1] = cosineValue;										// Coef[1][1] = cos
-	return(m);														// Return the matrix
+bool V3D_GetFrameTimes (uint32_t ticket, V3D_FRAME_TIMES* times)
+{
+	struct v3d_frame* f = &frameQ[ticket % V3D_MAX_FRAMES];
+	if ((ticket == 0) || (!V3D_FrameDone(ticket)) || (f->ticket != ticket) || (!times)) return false;
+	*times = f->times;
+	return true;
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the translation matrix in MATRIX3D from the x,y,z offset values   }
-{ 16Sep2017 LdB                                                             }
+{ Call from the irq handler, services the V3D binning/render done interrupt }
+{ and advances the queue.                                                   }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D TranslationMatrix3D (GLfloat offsetX, GLfloat offsetY, GLfloat offsetZ) {
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[0][3] = offsetX;											// Set x offset value
-	m.coef[1][3] = offsetY;											// Set y offset value
-	m.coef[2][3] = offsetZ;											// Set z offset value
-	return(m);														// Return matrix
+bool V3D_IrqHandler (void)
+{
+	uint32_t status = v3d[V3D_INTCTL] & (V3D_INT_FRDONE | V3D_INT_FLDONE);
+	if (status == 0) return false;									// Not ours
+	v3d[V3D_INTCTL] = status;										// Write 1s to clear
+	AdvanceFrames();												// Already in irq so no lock
+	return true;
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the scale matrix in MATRIX3D from the x,y,z axis scale values     }
-{ 16Sep2017 LdB                                                             }
+{ Enables or disables the V3D binning/render done interrupt driving the     }
+{ queue. The irq handler must call V3D_IrqHandler when enabled.             }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D ScaleMatrix3D (GLfloat scaleX, GLfloat scaleY, GLfloat scaleZ) {
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[0][0] = scaleX;											// Set x scale value
-	m.coef[1][1] = scaleY;											// Set y scale value
-	m.coef[2][2] = scaleZ;											// Set z scale value
-	return(m);														// Return the matrix
+void V3D_EnableFrameIrq (bool enable)
+{
+	if (enable) {
+		v3d[V3D_INTCTL] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// Clear anything stale
+		v3d[V3D_INTENA] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// V3D raises irq on flush and frame done
+		frameIrq = true;
+		IRQ_ENABLE1 = (1 << V3D_GPU_IRQ);							// Enable GPU irq 10 at the ARM
+	} else {
+		IRQ_DISABLE1 = (1 << V3D_GPU_IRQ);							// Disable GPU irq 10 at the ARM
+		v3d[V3D_INTDIS] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// V3D stops raising them
+		frameIrq = false;
+	}
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                        V3D GPU MEMORY ARENAS                              }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/* Each arena is one V3D_mem_alloc block handed out by moving an offset up, */
+/* so a frame's lists and tile memory cost one mailbox call to set up and   */
+/* nothing to release. Pools are arenas that are never reset.               */
+
 /*--------------------------------------------------------------------------}
-{ Returns the mirror matrix in MATRIX3D from the x,y,z mirror axis values   }
-{ 17Sep2017 LdB                                                             }
+{ Allocates and locks a zeroed coherent GPU block for the arena.            }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D MirrorMatrix3D (bool mirrorX, bool mirrorY, bool mirrorZ) {
-	MATRIX3D m = IdentityMatrix3D;									// Start with identity matrix
-	m.coef[0][0] =  mirrorX ?  -GLFLOAT_ONE : GLFLOAT_ONE;			// Coef[0][0] is -1 rather than 1 if x mirror active
-	m.coef[1][1] =  mirrorY ?  -GLFLOAT_ONE : GLFLOAT_ONE;			// Coef[1][1] is -1 rather than 1 if y mirror active
-	m.coef[2][2] =  mirrorZ ?  -GLFLOAT_ONE : GLFLOAT_ONE;			// Coef[2][2] is -1 rather than 1 if z mirror active
-	return(m);														// Return the matrix
+bool V3D_ArenaCreate (V3D_ARENA* arena, uint32_t size)
+{
+	if (!arena) return false;
+	*arena = (V3D_ARENA) { 0 };
+	size = (size + 0xFFF) & ~0xFFF;									// Whole 4K pages
+	uint32_t handle = V3D_mem_alloc(size, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+	if (!handle) return false;										// No GPU memory
+	arena->baseVC4 = V3D_mem_lock(handle);
+	if (!arena->baseVC4) {											// Lock failed so give it back
+		V3D_mem_free(handle);
+		return false;
+	}
+	arena->handle = handle;
+	arena->size = size;
+	return true;
 }
 
 /*--------------------------------------------------------------------------}
-{ Transposes the 3D matrix from ROW MAJOR <==> COLUMN MAJOR or back again	}
-{ 17Sep2017 LdB                                                             }
+{ Hands out size bytes at a power of 2 alignment, 0 if the arena is full.   }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-void TransposeMatrix3D(MATRIX3D* matrix) {
-	for (uint_fast8_t i = 0; i < 3; i++) {
-		for (uint_fast8_t j = i + 1; j <= 3; j++) {
-			GLfloat* p1 = &matrix->coef[i][j];						// Pointer to first coefficient to swap
-			GLfloat* p2 = &matrix->coef[j][i];						// Pointer to second coefficient to swap
-			GLfloat temp = *p1; 									// Copy whats at p1 to temp
-			*p1 = *p2;												// Copy whats at p2 to p1
-			*p2 = temp;												// Copy temp to p2
-		}
-	}
+uint32_t V3D_ArenaAlloc (V3D_ARENA* arena, uint32_t size, uint32_t align)
+{
+	if ((!arena) || (!arena->handle)) return 0;
+	if (align == 0) align = 1;
+	uint32_t offs = (arena->used + align - 1) & ~(align - 1);		// Align up from the last allocation
+	if ((offs > arena->size) || (size > arena->size - offs)) return 0;	// Does not fit
+	arena->used = offs + size;
+	if (arena->used > arena->peak) arena->peak = arena->used;		// Track high water mark
+	return arena->baseVC4 + offs;
 }
 
 /*--------------------------------------------------------------------------}
-{ Returns the matrix result of multiplying matrix3D a by matrix3D b         }
-{ 14Sep2017 LdB                                                             }
+{ Takes back everything handed out keeping the block.                       }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-MATRIX3D MultiplyMatrix3D(MATRIX3D a, MATRIX3D  b) {
-	MATRIX3D  m = IdentityMatrix3D;									// Temp result matrix
-
-	for (uint_fast8_t i = 0; i < 4; i++) {							// For each row rank
-		for (uint_fast8_t j = 0; j < 4; j++) {						// For each column rank
-			GLfloat sum = (a.coef[i][0] * b.coef[0][j]);			// 1st calc
-			sum = sum + (a.coef[i][1] * b.coef[1][j]);				// 2nd calc
-			sum = sum + (a.coef[i][2] * b.coef[2][j]);				// 3rd calc
-			sum = sum + (a.coef[i][3] * b.coef[3][j]);				// 4th calc
-			m.coef[i][j] = sum;										// Set result to temp result matrix
-		}
-	}
-	return (m);														// Return result matrix
+void V3D_ArenaReset (V3D_ARENA* arena)
+{
+	if (arena) arena->used = 0;
 }
 
-/*-TransformPoint3D---------------------------------------------------------}
-{ The 3D point(inX, inY, inZ) is transformed by the Matrix3D to return the  }
-{ new position to the point ptrs(*outX, *outY, *outZ).You can use NULL 		}
-{ for a return pointer if you do not require that individual value, and IN  }
-{ and OUT can be the same variable.											}
-{ 14Sep2017 LdB 															}
+/*--------------------------------------------------------------------------}
+{ Unlocks and frees the arena block.                                        }
+{ 19Oct26 LdB                                                               }
 {--------------------------------------------------------------------------*/
-void TransformPoint3D (GLfloat inX, GLfloat inY, GLfloat inZ,		// 3D input point (inX,inY,inZ) 
-					   MATRIX3D a,									// Matrix to transform point by
-					   GLfloat* outX, GLfloat* outY, GLfloat* outZ)	// 3D point result ptrs (*outX, *outY, *outZ)
+void V3D_ArenaDestroy (V3D_ARENA* arena)
 {
-	GLfloat tw, tx, ty, tz;
-	tw = a.coef[3][0] * inX + a.coef[3][1] * inY +
-		a.coef[3][2] * inZ + a.coef[3][3];							// Calculate 4th value
-	tx = a.coef[0][0] * inX + a.coef[0][1] * inY +
-		a.coef[0][2] * inZ + a.coef[0][3];							// Calculate temp x value into tx
-	ty = a.coef[1][0] * inX + a.coef[1][1] * inY +
-		a.coef[1][2] * inZ + a.coef[1][3];							// Calculate temp y value into ty
-	tz = a.coef[2][0] * inX + a.coef[2][1] * inY +
-		a.coef[2][2] * inZ + a.coef[2][3];							// Calculate temp z value into tz
-	if ((tw != GLFLOAT_ZERO) && (tw != GLFLOAT_ONE)) {				// If tw is not zero or one
-		tx /= tw;													// Divid out tw from tx
-		ty /= tw;													// Divid out tw	from ty
-		tz /= tw;													// Divid out tw	from tz
+	if ((arena) && (arena->handle)) {
+		V3D_mem_unlock(arena->handle);
+		V3D_mem_free(arena->handle);
 	}
-	if (outX) *outX = tx;											// Pointer outX valid so output result
-	if (outY) *outY = ty;											// Pointer outY valid so output result
-	if (outZ) *outZ = tz;											// Pointer outZ valid so output result
+	if (arena) *arena = (V3D_ARENA) { 0 };
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                      V3D QPU USER PROGRAMS (COMPUTE)                      }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
+/* User programs are queued to the QPU scheduler by writing the uniforms   */
+/* address and length then the code address. The scheduler starts each on */
+/* a free QPU between the shaders and counts them done in SRQCS 23:16, an  */
+/* 8 bit count that is followed into a 32 bit one so tickets count up like */
+/* the frame queue's. The kernels' host interrupts are left disabled, only */
+/* the V3D_execute_qpu mailbox call waits on them.                         */
+#define V3D_MAX_QPUS		12										// QPUs user programs can run on
+#define V3D_USER_QUEUE		16										// Requests the scheduler queue holds
 
+static uint32_t computeRequests = 0;								// User programs queued
+static uint32_t computeDone = 0;									// User programs seen complete
+static uint32_t computeHwDone = 0;									// SRQCS complete count at the last look
 
-
-bool InitV3D (void) {
-	if (mailbox_tag_message(0, 9,
-		MAILBOX_TAG_SET_CLOCK_RATE, 8, 8,
-		CLK_V3D_ID, 250000000,
-		MAILBOX_TAG_ENABLE_QPU, 4, 4, 1)) {
-		if (v3d[V3D_IDENT0] == 0x02443356) { // Magic number.
-			return true;
-		}
-	}
-	return false;
+/*--------------------------------------------------------------------------}
+{ Follows the hardware complete count, clears the host interrupts of done   }
+{ programs when nothing is left running.                                    }
+{--------------------------------------------------------------------------*/
+static void PollCompute (void)
+{
+	uint32_t hwDone = (v3d[V3D_SRQCS] >> 16) & 0xFF;
+	computeDone += (hwDone - computeHwDone) & 0xFF;					// Never 256 in flight so no wrap lost
+	computeHwDone = hwDone;
+	if (computeDone == computeRequests) v3d[V3D_DBQITC] = 0xFFFF;	// Write 1s to clear
 }
 
-uint32_t V3D_mem_alloc (uint32_t size, uint32_t align, uint32_t flags)
+/*--------------------------------------------------------------------------}
+{ Loads the kernel code with room for a uniform stream for every QPU.       }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool V3D_ComputeCreate (V3D_COMPUTE* comp, const uint32_t* code, uint32_t codeWords, uint32_t uniformCount)
 {
-	uint32_t buffer[6];
-	if (mailbox_tag_message(&buffer[0], 6,
-		MAILBOX_TAG_ALLOCATE_MEMORY, 12, 12, size, align, flags)) {
-		return buffer[3];
-	}
-	return 0;
+	if ((!comp) || (!code) || (codeWords < 2) || (codeWords & 1)) return false;
+	*comp = (V3D_COMPUTE) { 0 };
+	uint32_t streamBytes = V3D_MAX_QPUS * uniformCount * sizeof(uint32_t);
+	uint32_t msgBytes = V3D_MAX_QPUS * 2 * sizeof(uint32_t);
+	if (!V3D_ArenaCreate(&comp->memory, codeWords * sizeof(uint32_t) + streamBytes + msgBytes + 16)) return false;
+	comp->codeVC4 = V3D_ArenaAlloc(&comp->memory, codeWords * sizeof(uint32_t), 8);
+	comp->uniformsVC4 = V3D_ArenaAlloc(&comp->memory, streamBytes, 4);
+	comp->messageVC4 = V3D_ArenaAlloc(&comp->memory, msgBytes, 4);
+	comp->uniformCount = uniformCount;
+	memcpy((void*)(uintptr_t)GPUaddrToARMaddr(comp->codeVC4), code, codeWords * sizeof(uint32_t));
+	return true;
 }
 
-bool V3D_mem_free (uint32_t handle)
+/*--------------------------------------------------------------------------}
+{ ARM pointer to the uniform streams, QPU n's starts n * uniformCount on.   }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+uint32_t* V3D_ComputeUniforms (V3D_COMPUTE* comp)
 {
-	return (mailbox_tag_message(0, 4,
-		MAILBOX_TAG_RELEASE_MEMORY, 4, 4, handle));
+	if ((!comp) || (!comp->memory.handle)) return NULL;
+	return (uint32_t*)(uintptr_t)GPUaddrToARMaddr(comp->uniformsVC4);
 }
 
-uint32_t V3D_mem_lock (uint32_t handle)
+/*--------------------------------------------------------------------------}
+{ Queues the kernel with the first qpus uniform streams and returns at once.}
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+uint32_t V3D_ComputeLaunch (V3D_COMPUTE* comp, uint32_t qpus)
 {
-	uint32_t buffer[4];
-	if (mailbox_tag_message(&buffer[0], 4,
-		MAILBOX_TAG_LOCK_MEMORY, 4, 4, handle)) {
-		return buffer[3];
+	if ((!comp) || (!comp->memory.handle) || (qpus == 0) || (qpus > V3D_MAX_QPUS)) return 0;
+	v3d[V3D_DBQITE] = 0;											// Polled, no QPU interrupts to the ARM
+	v3d[V3D_L2CACTL] = 4;											// Clear L2 cache
+	v3d[V3D_SLCACTL] = 0x0F0F0F0F;									// Clear slice caches (code, uniforms, TMU)
+	for (uint32_t i = 0; i < qpus; i++) {
+		while ((v3d[V3D_SRQCS] & 0x3F) >= V3D_USER_QUEUE) {};		// Queue full wait for a QPU to take one
+		v3d[V3D_SRQUA] = comp->uniformsVC4 + i * comp->uniformCount * sizeof(uint32_t);
+		v3d[V3D_SRQUL] = comp->uniformCount;
+		v3d[V3D_SRQPC] = comp->codeVC4;								// Writing the code address queues it
+		computeRequests++;
 	}
-	return 0;
+	comp->ticket = computeRequests;
+	return comp->ticket;
 }
 
-bool V3D_mem_unlock (uint32_t handle)
+/*--------------------------------------------------------------------------}
+{ Non blocking check if the launch with the ticket has finished.            }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool V3D_ComputeDone (uint32_t ticket)
 {
-	return (mailbox_tag_message(0, 4,
-		MAILBOX_TAG_UNLOCK_MEMORY, 4, 4, handle));
+	if (ticket > computeDone) PollCompute();						// Not done at last look so poll
+	return (ticket <= computeDone);
 }
 
-bool V3D_execute_code (uint32_t code, uint32_t r0, uint32_t r1, uint32_t r2, uint32_t r3, uint32_t r4, uint32_t r5)
+/*--------------------------------------------------------------------------}
+{ Waits for the launch with the ticket to finish or timeoutUs to pass.      }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool V3D_ComputeWait (uint32_t ticket, uint32_t timeoutUs)
 {
-	return (mailbox_tag_message(0, 10,
-		MAILBOX_TAG_EXECUTE_CODE, 28, 28,
-		code, r0, r1, r2, r3, r4, r5));
+	uint64_t start = timer_getTickCount();
+	while (!V3D_ComputeDone(ticket))
+		if ((timeoutUs) && (tick_difference(start, timer_getTickCount()) > timeoutUs)) return false;
+	return true;
 }
 
-bool V3D_execute_qpu (int32_t num_qpus, uint32_t control, uint32_t noflush, uint32_t timeout) 
+/*--------------------------------------------------------------------------}
+{ Runs the kernel through the V3D_execute_qpu mailbox call and blocks.      }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool V3D_ComputeExecute (V3D_COMPUTE* comp, uint32_t qpus, uint32_t timeoutMs)
 {
-	return (mailbox_tag_message(0, 7,
-		MAILBOX_TAG_EXECUTE_QPU, 16, 16,
-		num_qpus, control, noflush, timeout));
-}
-
-static void emit_uint8_t(uint8_t **list, uint8_t d) {
-	*((*list)++) = d;
+	if ((!comp) || (!comp->memory.handle) || (qpus == 0) || (qpus > V3D_MAX_QPUS)) return false;
+	V3D_ComputeWait(computeRequests, 0);							// The GPU uses the same request queue
+	uint32_t* msg = (uint32_t*)(uintptr_t)GPUaddrToARMaddr(comp->messageVC4);
+	for (uint32_t i = 0; i < qpus; i++) {
+		msg[i * 2] = comp->uniformsVC4 + i * comp->uniformCount * sizeof(uint32_t);
+		msg[i * 2 + 1] = comp->codeVC4;
+	}
+	bool ok = V3D_execute_qpu(qpus, comp->messageVC4, 0, timeoutMs);	// GPU clears the caches (noflush 0)
+	v3d[V3D_DBQITE] = 0;											// Leave the QPU interrupts as we found them
+	v3d[V3D_DBQITC] = 0xFFFF;
+	computeHwDone = (v3d[V3D_SRQCS] >> 16) & 0xFF;					// Its programs are not ours to count
+	return ok;
 }
 
-static void emit_uint16_t (uint8_t **list, uint16_t d) {
-	struct EMITDATA* data = (struct EMITDATA*)&d;
-	*((*list)++) = (*data).byte1;
-	*((*list)++) = (*data).byte2;
+/*--------------------------------------------------------------------------}
+{ Frees the kernel's GPU memory.                                            }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void V3D_ComputeDestroy (V3D_COMPUTE* comp)
+{
+	if (comp) {
+		V3D_ArenaDestroy(&comp->memory);
+		*comp = (V3D_COMPUTE) { 0 };
+	}
 }
 
-static void emit_uint32_t(uint8_t **list, uint32_t d) {
-	struct EMITDATA* data = (struct EMITDATA*)&d;
-	*((*list)++) = (*data).byte1;
-	*((*list)++) = (*data).byte2;
-	*((*list)++) = (*data).byte3;
-	*((*list)++) = (*data).byte4;
-}
 
 
 
@@ -526,14 +657,6 @@ struct __attribute__((__packed__, aligned(1))) OriginalVertex {
 	float	  z;													// Z
 };
 
-struct __attribute__((__packed__, aligned(1))) TileListEntry {
-	uint8_t   coord_cmd;											// cmd = GL_TILE_COORDINATES
-	uint8_t	  x;													// x
-	uint8_t	  y;													// y
-	uint8_t   sublist_cmd;											// cmd = GL_BRANCH_TO_SUBLIST
-	uint32_t  sublist_ptr;											// ptr to next sublist
-	uint8_t   tile_endcmd;											// GL_STORE_MULTISAMPLE or GL_STORE_MULTISAMPLE_END
-};
 
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
@@ -625,7 +748,7 @@ typedef union {
 typedef union {
 	struct {
 		unsigned mip_levels : 4;									// @0-3		number of mipmap levels minus 1
-		unsigned texture_type : 4;								    // @4-7		texture type .. TODO: enumerate them 
+		unsigned texture_type : 4;								    // @4-7		texture type (TEXTURE_TYPE_xxx)
 		unsigned flip_y : 1;										// @8		0,1  top to bottom, bottom to top
 		unsigned cubemap : 1;										// @9		0,1  cube map mode off, on
 		unsigned cswiz : 2;											// @10-11	cache swizzle
@@ -634,6 +757,8 @@ typedef union {
 	uint32_t Raw32;													// Access whole 32bits at once
 } TEXTURE_CONFIG_BLOCK;
 
+#define TEXTURE_TYPE_RGBA8888	0							// 32 bit texels, the only type rpi-Texture lays out
+
 /*--------------------------------------------------------------------------}
 {						ENUMERATED T & S WRAP MODE							}
 {--------------------------------------------------------------------------*/
@@ -662,8 +787,86 @@ typedef union {
 	uint32_t Raw32;													// Access whole 32bits at once
 } TEXTURE_CONFIG_PARAMS;
 
+/*--------------------------------------------------------------------------}
+{					   ENUMERATED TEXTURE FILTERS							}
+{--------------------------------------------------------------------------*/
+typedef enum {
+	MINFILT_LINEAR = 0,								// Bilinear, level 0 only
+	MINFILT_NEAREST = 1,							// Nearest, level 0 only
+	MINFILT_NEAR_MIP_NEAR = 2,						// Nearest in the nearest mipmap level
+	MINFILT_NEAR_MIP_LIN = 3,						// Nearest in the two nearest levels blended
+	MINFILT_LIN_MIP_NEAR = 4,						// Bilinear in the nearest mipmap level
+	MINFILT_LIN_MIP_LIN = 5,						// Trilinear
+} MIN_FILTER;
+
+#define MAGFILT_LINEAR		0						// Magnification filters
+#define MAGFILT_NEAREST		1
+
+
+
+
+// VC4 memory comes from arenas (see V3D_ArenaCreate). The shaders go in the
+// renderer's shader pool, the index and vertex arrays in the model's mesh pool
+// and everything a frame in flight uses (lists, uniforms, tile state, tile
+// allocation and overflow memory) in that frame's arena, which is sized and
+// refilled each time the frame lists are built.
+#define SHADER_MAX_SIZE			0x200		// Space for each QPU shader in the shader pool
+#define BIN_LIST_HEADER			0x40		// Binning list before the primitive lists
+#define BIN_LIST_PER_PRIM		14			// Indexed primitive list, one a run of visible clusters
+#define BIN_LIST_TAIL			0x10		// Flush, nop and halt after them
+#define SHADER_RECORD_SIZE		0x40		// GL shader record + 1 attribute record (NV is smaller)
+#define UNIFORMS_SIZE			0x40		// 16 float matrix uniforms
+#define RENDER_LIST_HEADER		0x40		// Render list before the tile entries
+#define RENDER_LIST_PER_TILE	9			// Tile coordinates, branch to sublist and store
+#define TILE_STATE_PER_TILE		48			// Tile state data the binner needs per tile
+#define TILE_ALLOC_PER_TILE		64			// 32 byte initial tile list block + state each list starts with
+#define TILE_ALLOC_PER_PRIM		8			// Compressed triangle record allowing for the tiles it crosses
+#define TILE_ALLOC_MIN			0x4000		// Never give the binner less than this
 
-
+/*--------------------------------------------------------------------------}
+{ Transforms count original vertices by the affine matrix m writing the     }
+{ 12.4 screen x,y and the z of each emit vertex. NEON builds do 4 vertices  }
+{ a pass, the bottom row of the matrix is taken to be 0,0,0,1 so there is  }
+{ no perspective divide (Matrix3D_TransformPoints does that in general).     }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+static void TransformVertexBatch (const MATRIX3D* m, const struct OriginalVertex* ov, struct EmitVertex* ev, uint32_t count)
+{
+	uint32_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; i + 4 <= count; i += 4) {
+		int32_t xs[4], ys[4];
+		float zs[4];
+		float32x4x3_t p = vld3q_f32((const float*)&ov[i]);			// De-interleave 4 x,y,z points
+		float32x4_t x = vdupq_n_f32(m->coef[0][3]);					// Start with the translations
+		float32x4_t y = vdupq_n_f32(m->coef[1][3]);
+		float32x4_t z = vdupq_n_f32(m->coef[2][3]);
+		x = vmlaq_n_f32(x, p.val[0], m->coef[0][0]);				// Accumulate each column
+		y = vmlaq_n_f32(y, p.val[0], m->coef[1][0]);
+		z = vmlaq_n_f32(z, p.val[0], m->coef[2][0]);
+		x = vmlaq_n_f32(x, p.val[1], m->coef[0][1]);
+		y = vmlaq_n_f32(y, p.val[1], m->coef[1][1]);
+		z = vmlaq_n_f32(z, p.val[1], m->coef[2][1]);
+		x = vmlaq_n_f32(x, p.val[2], m->coef[0][2]);
+		y = vmlaq_n_f32(y, p.val[2], m->coef[1][2]);
+		z = vmlaq_n_f32(z, p.val[2], m->coef[2][2]);
+		vst1q_s32(xs, vcvtq_s32_f32(vmulq_n_f32(x, 16.0f)));		// X in 12.4 fixed point
+		vst1q_s32(ys, vcvtq_s32_f32(vmulq_n_f32(y, 16.0f)));		// Y in 12.4 fixed point
+		vst1q_f32(zs, z);
+		for (int k = 0; k < 4; k++) {								// Emit vertex stride is 28 bytes so store singly
+			ev[i + k].x = (uint16_t)xs[k];
+			ev[i + k].y = (uint16_t)ys[k];
+			ev[i + k].z = zs[k];
+		}
+	}
+#endif
+	for (; i < count; i++) {										// Remaining (or all non NEON) vertices
+		GLfloat x = ov[i].x, y = ov[i].y, z = ov[i].z;
+		ev[i].x = (uint16_t)(int32_t)((m->coef[0][0] * x + m->coef[0][1] * y + m->coef[0][2] * z + m->coef[0][3]) * 16.0f);
+		ev[i].y = (uint16_t)(int32_t)((m->coef[1][0] * x + m->coef[1][1] * y + m->coef[1][2] * z + m->coef[1][3]) * 16.0f);
+		ev[i].z = m->coef[2][0] * x + m->coef[2][1] * y + m->coef[2][2] * z + m->coef[2][3];
+	}
+}
 
 static GLfloat angle = 0.0f;
 
@@ -671,71 +874,149 @@ void DoRotate(float delta, int screenCentreX, int screenCentreY, struct obj_mode
 	angle += delta;
 	if (angle >= (6.2831852)) angle -= (6.2831852);   // 2 * Pi = 360 degree rotation
 
-	if ((model) && (model->vertexARM) && (model->originalVertexARM)) {
-		MATRIX3D a = MultiplyMatrix3D(model->viewMatrix, ZRotationMatrix3D(angle));
-		// Vertex Data 1
-		struct EmitVertex* v = model->vertexARM;
-		struct OriginalVertex* ov = model->originalVertexARM;
-		for (unsigned int i = 0; i < model->num_verts; i++) {
-			GLfloat dx, dy, dz;
-			TransformPoint3D(ov->x, ov->y, ov->z, a, &dx, &dy, &dz);
-			v->x = (uint16_t)((int32_t)(dx + screenCentreX) << 4); // X in 12.4 fixed point
-			v->y = (uint16_t)((int32_t)(dy + screenCentreY) << 4); // Y in 12.4 fixed point
-			v->z = 0.25f; //    0.25f;
-			v++;	// Next vertex
-			ov++;
-		}
+	if (model) {
+		MATRIX3D* a = &model->mvp;
+		Matrix3D_SetRotation(a, 2, angle);							// Z rotation by angle
+		Matrix3D_Multiply(a, &model->viewMatrix, a);
+		// Screen matrix centres x,y in pixels and takes z from +-maxSize to 0..1
+		MATRIX3D s = MATRIX3D_TRANSLATE_INIT(screenCentreX, screenCentreY, 0.5f);
+		if (model->maxSize > 0.0f) s.coef[2][2] = 0.5f / model->maxSize;
+			else s.coef[2][2] = 0.0f;
+		Matrix3D_Multiply(a, &s, a);
 	}
 }
 
 
+static bool EmitFrameLists (struct obj_model_t* model);
+static void EmitPrimitives (struct obj_model_t* model, V3D_FRAME_LISTS* fl);
+
 // Render the model
-void RenderModel (struct obj_model_t* model, printhandler prn_handler) {
-	//  We allocate/lock some videocore memory
-	// I'm just shoving everything in a single buffer because I'm lazy 8Mb, 4k alignment
-	// Normally you would do individual allocations but not sure of interface I want yet
-	// So lets just define some address in that one single buffer for now 
-	// You need to make sure they don't overlap if you expand sample
-	#define BUFFER_SHADER_OFFSET	0x80
-	#define BUFFER_TILE_STATE		0x200
-	#define BUFFER_TILE_DATA		0x6000
-	#define BUFFER_RENDER_CONTROL	0x1e200
-	#define BUFFER_FRAGMENT_SHADER	0x1fe00
-	#define BUFFER_FRAGMENT_UNIFORM	0x1ff00
-	if (!model) return;
-
-	// clear caches
-	v3d[V3D_L2CACTL] = 4;
-	v3d[V3D_SLCACTL] = 0x0F0F0F0F;
-
-	// stop the thread
-	v3d[V3D_CT0CS] = 0x20;
-	// wait for it to stop
-	while (v3d[V3D_CT0CS] & 0x20);
-
-	// Run our control list
-	v3d[V3D_BFC] = 1;                         // reset binning frame count
-	v3d[V3D_CT0CA] = model->rendererDataVC4;
-	v3d[V3D_CT0EA] = model->rendererDataVC4 + model->binningConfigLength;
-
-	// wait for binning to finish
-	while (v3d[V3D_BFC] == 0) {}            
-
-	// stop the thread
-	v3d[V3D_CT1CS] = 0x20;
-
-	// Wait for thread to stop
-	while (v3d[V3D_CT1CS] & 0x20);
-
-	// Run our render
-	v3d[V3D_RFC] = 1;						// reset rendering frame count
-	v3d[V3D_CT1CA] = model->rendererDataVC4 + BUFFER_RENDER_CONTROL;
-	v3d[V3D_CT1EA] = model->rendererDataVC4 + BUFFER_RENDER_CONTROL + model->renderLength;
-
-	// wait for render to finish
-	while(v3d[V3D_RFC] == 0) {} 
+uint32_t RenderModel (struct obj_model_t* model, printhandler prn_handler) {
+	if ((!model) || (!model->vertexARM) || (!model->originalVertexARM)) return 0;
+
+	V3D_FRAME_TIMES ft;
+	uint32_t slot = model->frameSlot;
+	V3D_WaitFrame(model->frameTicket[slot]);						// Frame slot may still be in flight
+	if (V3D_GetFrameTimes(model->frameTicket[slot], &ft)) {			// See how its last use went
+		model->lastOverflow = ft.binOverflow;
+		if (ft.binOverflow) {										// Binner needed overflow memory
+			model->overflowFrames++;
+			model->tileAllocSize += (ft.binOverflow + 0xFFF) & ~0xFFF;	// Grow the tile allocation by it
+			V3D_WaitIdle();											// Lists are in use till frames finish
+			if (!EmitFrameLists(model)) return 0;					// Rebuild with the bigger tile memory
+		}
+	}
+	V3D_FRAME_LISTS* fl = &model->frameList[slot];
+
+	// Apply the matrix to this frame's copy of the data
+	uint64_t t = timer_getTickCount();
+	if (model->vertexShading) {
+		// The QPU shaders read the 16 matrix values row by row as uniforms
+		GLfloat* u = (GLfloat*)(uintptr_t)GPUaddrToARMaddr(fl->uniforms);
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++)
+				*u++ = model->mvp.coef[i][j];
+	} else TransformVertexBatch(&model->mvp, model->originalVertexARM,
+		(struct EmitVertex*)((uintptr_t)model->vertexARM + slot * model->emitSize), model->num_verts);
+	EmitPrimitives(model, fl);										// Only the clusters that can be seen
+	model->transformUs = tick_difference(t, timer_getTickCount());
+
+	// Queue it, the binner starts as soon as it is free so we don't wait
+	model->frameTicket[slot] = V3D_SubmitFrame(fl->binStart, fl->binEnd, fl->renderStart, fl->renderEnd,
+		fl->overflow, model->tileOverflowSize);
+	model->frameSlot = (slot + 1) % V3D_MAX_FRAMES;					// Next frame uses next slot
+	return model->frameTicket[slot];
+}
+
+/*--------------------------------------------------------------------------}
+{  Software render of a frame's binning list on the ARM, the tile lists     }
+{  can hold SOFT_BIN_ENTRIES triangle/tile pairs. Every ready core takes    }
+{  every n'th tile, each with its own depth tile and done flag. There is no }
+{  MMU so the cores see each others writes without cache maintenance.      }
+{--------------------------------------------------------------------------*/
+#define SOFT_BIN_ENTRIES	0x20000										// 512KB of tile lists
+#define SOFT_MAX_CORES		4											// Most cores tiles are dealt to
+static SOFT_SCENE softScene;
+static uint32_t softBins[SOFT_BIN_ENTRIES];
+static float softDepth[SOFT_MAX_CORES][SOFT_TILE_SIZE * SOFT_TILE_SIZE];	// Depth tile per core (the stacks are too small)
+
+static struct {
+	SOFT_TARGET target[SOFT_MAX_CORES];								// Each core's target, only the depth tile differs
+	uint32_t cores;													// Cores the tiles are dealt to
+	volatile uint32_t frame;										// Render number the cores are on
+	volatile uint32_t done[SOFT_MAX_CORES];							// Last render each core finished
+	volatile uint32_t drawn[SOFT_MAX_CORES];						// Triangle/tile pairs each core drew
+} softCores = { 0 };
+
+static void SoftCoreTiles (uint32_t core)
+{
+	softCores.drawn[core] = SoftRaster_RenderTiles(&softScene, &softCores.target[core], core, softCores.cores);
+	__sync_synchronize();											// Tiles written before the flag
+	softCores.done[core] = softCores.frame;
+}
+
+/* CoreExecute passes nothing so each core has its own entry point */
+static void SoftCore1Tiles (void) { SoftCoreTiles(1); }
+static void SoftCore2Tiles (void) { SoftCoreTiles(2); }
+static void SoftCore3Tiles (void) { SoftCoreTiles(3); }
+static const CORECALLFUNC softCoreEntry[SOFT_MAX_CORES] = { 0, SoftCore1Tiles, SoftCore2Tiles, SoftCore3Tiles };
 
+static void* SoftVC4ToARM (uint32_t vc4Addr)
+{
+	return (void*)(uintptr_t)GPUaddrToARMaddr(vc4Addr);
+}
+
+uint32_t RenderModelSoftware (struct obj_model_t* model, uint32_t* pixels, uint32_t pitch) {
+	if ((!model) || (!model->vertexARM) || (!model->originalVertexARM) || (!pixels)) return 0;
+	if (model->vertexShading) return 0;								// QPU shaders make those vertexes
+	V3D_WaitIdle();													// V3D frames may still write the screen
+
+	uint32_t slot = model->frameSlot;
+	V3D_FRAME_LISTS* fl = &model->frameList[slot];
+	uint64_t t = timer_getTickCount();
+	TransformVertexBatch(&model->mvp, model->originalVertexARM,
+		(struct EmitVertex*)((uintptr_t)model->vertexARM + slot * model->emitSize), model->num_verts);
+	EmitPrimitives(model, fl);
+	model->transformUs = tick_difference(t, timer_getTickCount());
+
+	// Read the same binning list, vertexes and indexes the V3D would
+	if (!SoftRaster_SetupFromList(&softScene, (uint8_t*)(uintptr_t)GPUaddrToARMaddr(fl->binStart),
+		fl->binEnd - fl->binStart, SoftVC4ToARM, 0xff000000, softBins, SOFT_BIN_ENTRIES)) return 0;
+	uint32_t cores = SoftRenderCores();
+	for (uint32_t core = 0; core < cores; core++) {
+		SOFT_TARGET target = { pixels, model->renderWth, model->renderHt, pitch, &softDepth[core][0] };
+		softCores.target[core] = target;
+	}
+	softCores.cores = cores;
+
+	/* Deal the tiles out, this core takes the tiles of any core that won't start */
+	bool started[SOFT_MAX_CORES] = { true };
+	softCores.frame++;
+	__sync_synchronize();											// Scene and targets set before the cores start
+	for (uint32_t core = 1; core < cores; core++)
+		started[core] = CoreExecute(core, softCoreEntry[core]);
+	SoftCoreTiles(0);
+	for (uint32_t core = 1; core < cores; core++)
+		if (!started[core]) SoftCoreTiles(core);
+	uint32_t drawn = 0;
+	for (uint32_t core = 0; core < cores; core++) {
+		while (softCores.done[core] != softCores.frame) {};			// Wait for that core
+		drawn += softCores.drawn[core];
+	}
+	__sync_synchronize();											// All tiles are in pixels
+	return drawn;
+}
 
+/*--------------------------------------------------------------------------}
+{ Cores RenderModelSoftware deals the tiles out to, 1 if only core 0.       }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+uint32_t SoftRenderCores (void)
+{
+	uint32_t cores = RPi_CoresReady;
+	if (cores < 1) cores = 1;
+	if (cores > SOFT_MAX_CORES) cores = SOFT_MAX_CORES;
+	return cores;
 }
 
 
@@ -816,7 +1097,7 @@ static bool ParseWaveFrontMesh(const char* fileName, struct obj_model_t *model,
 						ov->z = z;
 						ov++;
 
-						ev->w = 0.0f;
+						ev->w = 1.0f;													// No perspective so 1/W is 1
 						ev->red = 0.5f;													// Varying 0 (Red)
 						ev->green = 0.5f;												// Varying 1 (Green)
 						ev->blue = 0.5f;												// Varying 2 (Blue)
@@ -1080,112 +1361,51 @@ static bool ParseWaveFrontMesh(const char* fileName, struct obj_model_t *model,
 		printf("   * minX: %i maxX: %i\n", (int)model->minX, (int)model->maxX);
 		printf("   * minY: %i maxY: %i\n", (int)model->minY, (int)model->maxY);
 		printf("   * minZ: %i maxZ: %i\n", (int)model->minZ, (int)model->maxZ);
-		printf(" Display starts in 5 seconds\n");
-		timer_wait(5000000);
 	}
 	return true;
 }
 
-
-
-
-
-
+/* The renderer's QPU shaders, assembled from the .qasm sources in Shaders  */
+/* ColourFrag: vertex colour fragment shader writing Z for the depth test    */
+/* TextureFrag: fragment shader sampling TMU0 at varyings s,t               */
+/* Coord: coordinate shader, the matrix in 16 uniforms times x,y,z          */
+/* Vertex: the same transform plus a grey shade from depth in 3 varyings    */
+static const uint32_t colourFragShader[] = {
+#include "Shaders/ColourFrag.h"
+};
+static const uint32_t textureFragShader[] = {
+#include "Shaders/TextureFrag.h"
+};
+static const uint32_t coordShader[] = {
+#include "Shaders/Coord.h"
+};
+static const uint32_t vertexShader[] = {
+#include "Shaders/Vertex.h"
+};
 
 bool SetupRenderer (struct obj_model_t* model, uint32_t renderWth, uint32_t renderHt, uint32_t renderBufferAddr)
 {
 	if (model) {
-		model->rendererHandle = V3D_mem_alloc(0x800000, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
-		if (!model->rendererHandle)	return false;
-
-		model->rendererDataVC4 = V3D_mem_lock(model->rendererHandle);
-		model->rendererDataARM = GPUaddrToARMaddr(model->rendererDataVC4);
-
+		if (!V3D_ArenaCreate(&model->shaderPool, 5 * SHADER_MAX_SIZE + 16)) return false;
+		model->fragShaderVC4 = V3D_ArenaAlloc(&model->shaderPool, SHADER_MAX_SIZE, 16);
+		model->fragUniformVC4 = V3D_ArenaAlloc(&model->shaderPool, 16, 16);
+		model->coordShaderVC4 = V3D_ArenaAlloc(&model->shaderPool, SHADER_MAX_SIZE, 16);
+		model->vertShaderVC4 = V3D_ArenaAlloc(&model->shaderPool, SHADER_MAX_SIZE, 16);
+		model->texShaderVC4 = V3D_ArenaAlloc(&model->shaderPool, SHADER_MAX_SIZE, 16);
+
+		model->renderBufferAddr = renderBufferAddr;					// Frame lists render here
 		model->renderWth = renderWth;
 		model->renderHt = renderHt;
 		model->binWth = (renderWth + 63) / 64;							// Tiles across 
 		model->binHt = (renderHt + 63) / 64;							// Tiles down 
-		uint8_t *p; // = (uint8_t*)(uintptr_t)model->rendererDataARM;
-
-		// fragment shader
-		p = (uint8_t*)(uintptr_t)model->rendererDataARM + BUFFER_FRAGMENT_SHADER;
-		emit_uint32_t(&p, 0x958e0dbf);
-		emit_uint32_t(&p, 0xd1724823); /* mov r0, vary; mov r3.8d, 1.0 */
-		emit_uint32_t(&p, 0x818e7176);
-		emit_uint32_t(&p, 0x40024821); /* fadd r0, r0, r5; mov r1, vary */
-		emit_uint32_t(&p, 0x818e7376);
-		emit_uint32_t(&p, 0x10024862); /* fadd r1, r1, r5; mov r2, vary */
-		emit_uint32_t(&p, 0x819e7540);
-		emit_uint32_t(&p, 0x114248a3); /* fadd r2, r2, r5; mov r3.8a, r0 */
-		emit_uint32_t(&p, 0x809e7009);
-		emit_uint32_t(&p, 0x115049e3); /* nop; mov r3.8b, r1 */
-		emit_uint32_t(&p, 0x809e7012);
-		emit_uint32_t(&p, 0x116049e3); /* nop; mov r3.8c, r2 */
-		emit_uint32_t(&p, 0x159e76c0);
-		emit_uint32_t(&p, 0x30020ba7); /* mov tlbc, r3; nop; thrend */
-		emit_uint32_t(&p, 0x009e7000);
-		emit_uint32_t(&p, 0x100009e7); /* nop; nop; nop */
-		emit_uint32_t(&p, 0x009e7000);
-		emit_uint32_t(&p, 0x500009e7); /* nop; nop; sbdone */
-
-		// Render control list
-		p = (uint8_t*)(uintptr_t)model->rendererDataARM + BUFFER_RENDER_CONTROL;
-
-		// Clear colors
-		emit_uint8_t(&p, GL_CLEAR_COLORS);
-		emit_uint32_t(&p, 0xff000000);			// Opaque Black
-		emit_uint32_t(&p, 0xff000000);			// 32 bit clear colours need to be repeated twice
-		emit_uint32_t(&p, 0);
-		emit_uint8_t(&p, 0);
-
-		// Tile Rendering Mode Configuration
-		emit_uint8_t(&p, GL_TILE_RENDER_CONFIG);
-
-		emit_uint32_t(&p, renderBufferAddr);	// render address
-
-		emit_uint16_t(&p, model->renderWth);	// width
-		emit_uint16_t(&p, model->renderHt);		// height
-		emit_uint8_t(&p, 0x04);					// framebuffer mode (linear rgba8888)
-		emit_uint8_t(&p, 0x00);
-
-		// Do a store of the first tile to force the tile buffer to be cleared
-		// Tile Coordinates
-		emit_uint8_t(&p, GL_TILE_COORDINATES);
-		emit_uint8_t(&p, 0);
-		emit_uint8_t(&p, 0);
-		// Store Tile Buffer General
-		emit_uint8_t(&p, GL_STORE_TILE_BUFFER);
-		emit_uint16_t(&p, 0);					// Store nothing (just clear)
-		emit_uint32_t(&p, 0);					// no address is needed
-
-		struct TileListEntry* tp;
-		tp = (struct TileListEntry*)(uintptr_t) p;
-		// Link all binned lists together
-		for (int x = 0; x < model->binWth; x++) {
-			for (int y = 0; y < model->binHt; y++) {
-
-				// Tile Coordinates
-				tp->coord_cmd = GL_TILE_COORDINATES;
-				tp->x = x;
-				tp->y = y;
-
-				// Call Tile sublist
-				tp->sublist_cmd = GL_BRANCH_TO_SUBLIST;
-				tp->sublist_ptr = model->rendererDataVC4 + BUFFER_TILE_DATA + (y * model->binWth + x) * 32;
-
-				// Last tile needs a special store instruction
-				if (x == (model->binWth - 1) && (y == model->binHt - 1)) {
-					// Store resolved tile color buffer and signal end of frame
-					tp->tile_endcmd = GL_STORE_MULTISAMPLE_END;
-				}
-				else {
-					// Store resolved tile color buffer
-					tp->tile_endcmd = GL_STORE_MULTISAMPLE;
-				}
-				tp++;
-			}
-		}
-		model->renderLength = (uintptr_t)tp - (uintptr_t)(model->rendererDataARM + BUFFER_RENDER_CONTROL);
+
+		// Shader code is assembled from Shaders/*.qasm (make shaders in Host)
+		memcpy((void*)(uintptr_t)GPUaddrToARMaddr(model->fragShaderVC4), colourFragShader, sizeof(colourFragShader));
+		memcpy((void*)(uintptr_t)GPUaddrToARMaddr(model->texShaderVC4), textureFragShader, sizeof(textureFragShader));
+		memcpy((void*)(uintptr_t)GPUaddrToARMaddr(model->coordShaderVC4), coordShader, sizeof(coordShader));
+		memcpy((void*)(uintptr_t)GPUaddrToARMaddr(model->vertShaderVC4), vertexShader, sizeof(vertexShader));
+
+		// The render control lists are built with the binning lists (EmitFrameLists)
 
 		return true;
 	}
@@ -1195,9 +1415,14 @@ bool SetupRenderer (struct obj_model_t* model, uint32_t renderWth, uint32_t rend
 bool DoneRenderer(struct obj_model_t* model) 
 {
 	if (model) {
+		V3D_WaitIdle();													// Let frames in flight finish
 		// Release resources
-		V3D_mem_unlock(model->rendererHandle);
-		V3D_mem_free(model->rendererHandle);
+		for (int i = 0; i < V3D_MAX_FRAMES; i++)
+			V3D_ArenaDestroy(&model->frameArena[i]);
+		V3D_ArenaDestroy(&model->shaderPool);
+		V3D_ArenaDestroy(&model->meshPool);
+		model->vertexARM = NULL;										// Nothing left to render
+		model->originalVertexARM = NULL;
 		return true;
 	}
 	return false;
@@ -1218,121 +1443,540 @@ typedef struct __attribute__((__packed__, aligned(1))) tagNVShaderState
 	uint32_t  vertex_data;											// Shaded Vertex Data Address
 } NV_SHADER_STATE;
 
-bool CreateVertexData (const char* fileName, struct obj_model_t* model, float desiredMaxSize, printhandler prn_handler) {
-	if (prn_handler) prn_handler("Loading %s\n", fileName);
-	if (model) {
-		model->viewMatrix = MultiplyMatrix3D(XRotationMatrix3D(0.78539815), YRotationMatrix3D(0.78539815));
+/*--------------------------------------------------------------------------}
+{						GL_SHADER_STATE RECORD STRUCTURE	 				}
+{--------------------------------------------------------------------------*/
+typedef struct __attribute__((__packed__, aligned(1))) tagGLShaderState
+{
+	uint16_t  flags;												// shader flags
+	uint8_t	  fragNumUniforms;										// fragment shader number of uniforms (not used)
+	uint8_t   fragNumVaryings;										// fragment shader number of varyings
+	uint32_t  fragment_shader;										// Fragment Shader Code Address
+	uint32_t  fragment_uniforms;									// Frag Shader Uniforms Addr
+	uint16_t  vertNumUniforms;										// vertex shader number of uniforms (not used)
+	uint8_t   vertAttribSelect;										// vertex shader attribute array select bits
+	uint8_t   vertAttribSize;										// vertex shader total attributes size
+	uint32_t  vertex_shader;										// Vertex Shader Code Address
+	uint32_t  vertex_uniforms;										// Vertex Shader Uniforms Addr
+	uint16_t  coordNumUniforms;										// coordinate shader number of uniforms (not used)
+	uint8_t   coordAttribSelect;									// coordinate shader attribute array select bits
+	uint8_t   coordAttribSize;										// coordinate shader total attributes size
+	uint32_t  coordinate_shader;									// Coordinate Shader Code Address
+	uint32_t  coordinate_uniforms;									// Coordinate Shader Uniforms Addr
+} GL_SHADER_STATE_RECORD;
 
-		if (!ParseWaveFrontMesh(fileName, model, false, desiredMaxSize)) return false;
-		
-		model->IndexVertexCt = model->tri_count*3;
-		model->IndexVertexCt += model->quad_count * 6;
-		model->IndexVertexCt += model->polygon_count * 9;
+/*--------------------------------------------------------------------------}
+{					  GL_SHADER_STATE ATTRIBUTE RECORD	 					}
+{--------------------------------------------------------------------------*/
+typedef struct __attribute__((__packed__, aligned(1))) tagGLAttribRecord
+{
+	uint32_t  base_addr;											// Attribute array base address
+	uint8_t   sizeMinusOne;											// Number of bytes - 1
+	uint8_t   stride;												// Memory stride
+	uint8_t   vertVPMOffset;										// Vertex shader VPM offset
+	uint8_t   coordVPMOffset;										// Coordinate shader VPM offset
+} GL_ATTRIBUTE_RECORD;
 
-		uint32_t memSize = (model->num_verts * sizeof(struct EmitVertex));
-		memSize += (model->num_verts * sizeof(struct OriginalVertex));
-		memSize += (model->IndexVertexCt * sizeof(uint16_t));
+/*--------------------------------------------------------------------------}
+{ Culls the model clusters with the mvp (rpi-Cull.h) and writes a primitive }
+{ list for each run left and the end of the binning list of the frame. A    }
+{ model with no clusters is always drawn whole.                             }
+{--------------------------------------------------------------------------*/
+static void EmitPrimitives (struct obj_model_t* model, V3D_FRAME_LISTS* fl)
+{
+	uint32_t runs = 0;
+	if (model->cull.count) {
+		runs = Cull_Visible(&model->cull, &model->mvp, model->renderWth, model->renderHt,
+			model->cullFlags, model->cullRuns, &model->cullStats);
+	} else {
+		model->cullRuns[0] = (CULL_RUN) { 0, model->IndexVertexCt, model->MaxIndexVertex };
+		model->cullStats = (CULL_STATS) { 0 };
+		model->cullStats.trisTotal = model->cullStats.trisSubmitted = model->IndexVertexCt / 3;
+		model->cullStats.runs = runs = 1;
+	}
+	V3D_LIST list;
+	uint32_t used = fl->binPrims - fl->binStart;					// Header stays as EmitFrameLists wrote it
+	V3DList_Init(&list, (void*)(uintptr_t)GPUaddrToARMaddr(fl->binPrims), fl->binPrims, model->binListSize - used);
+	for (uint32_t i = 0; i < runs; i++)
+		V3DList_IndexedPrimitiveList(&list, PRIM_TRIANGLE | INDEX_TYPE_16,	// 16bit index, triangles
+			model->cullRuns[i].indexCount, model->modelDataVC4 + model->cullRuns[i].firstIndex * sizeof(uint16_t),
+			model->cullRuns[i].maxIndex);
+
+	// End of bin list
+	V3DList_FlushAllState(&list);
+	V3DList_Nop(&list);
+	V3DList_Halt(&list);
+	fl->binEnd = V3DList_EndVC4(&list);							// Sized for a list a cluster so can't overflow
+}
 
-		model->modelHandle = V3D_mem_alloc (memSize, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
-		if (model->modelHandle) {
-			model->modelDataVC4 = V3D_mem_lock(model->modelHandle);			// Lock the memory
-			model->modelDataARM = GPUaddrToARMaddr(model->modelDataVC4);	// Convert locked memory to ARM address
-			
-			model->vertexVC4 = (model->modelDataVC4 + (model->IndexVertexCt * sizeof(uint16_t)));  // Create pointer
-			model->vertexARM = (struct EmitVertex*)(uintptr_t)(model->modelDataARM + (model->IndexVertexCt * sizeof(uint16_t))); // Create pointer
+/*--------------------------------------------------------------------------}
+{ Builds the render and binning control lists and shader record of every   }
+{ frame slot in its own arena, GL_SHADER_STATE when model->vertexShading is }
+{ set otherwise GL_NV_SHADER_STATE with the ARM transformed emit vertexes.  }
+{ Tile memory is model->tileAllocSize with half as much again for overflow. }
+{ The primitive lists at the end of the binning list are rewritten for each }
+{ frame by EmitPrimitives. No frame may be in flight. Returns false if GPU  }
+{ memory ran out.                                                           }
+{--------------------------------------------------------------------------*/
+static bool EmitFrameLists (struct obj_model_t* model)
+{
+	uint32_t tiles = model->binWth * model->binHt;
+	uint32_t maxRuns = (model->cull.count) ? model->cull.count : 1;	// Worst case no two runs join
+	model->binListSize = BIN_LIST_HEADER + maxRuns * BIN_LIST_PER_PRIM + BIN_LIST_TAIL;
+	model->tileOverflowSize = ((model->tileAllocSize / 2) + 0xFFF) & ~0xFFF;	// Half as much again to overflow to
+	uint32_t frameSize = model->tileAllocSize + model->tileOverflowSize			// Both 4K aligned so allow 4K
+		+ 0x1000 + tiles * TILE_STATE_PER_TILE + model->binListSize + SHADER_RECORD_SIZE
+		+ UNIFORMS_SIZE + RENDER_LIST_HEADER + tiles * RENDER_LIST_PER_TILE + 0x40;
+
+	for (uint32_t frame = 0; frame < V3D_MAX_FRAMES; frame++) {
+		V3D_ARENA* arena = &model->frameArena[frame];
+		V3D_FRAME_LISTS* fl = &model->frameList[frame];
+		if (arena->size < frameSize) {								// First build or tile memory grew
+			V3D_ArenaDestroy(arena);
+			if (!V3D_ArenaCreate(arena, frameSize)) return false;
+		}
+		V3D_ArenaReset(arena);										// Refill the frame arena from the start
+		uint32_t tileAlloc = V3D_ArenaAlloc(arena, model->tileAllocSize, 0x1000);
+		fl->overflow = V3D_ArenaAlloc(arena, model->tileOverflowSize, 0x1000);
+		uint32_t tileState = V3D_ArenaAlloc(arena, tiles * TILE_STATE_PER_TILE, 16);
+		fl->binStart = V3D_ArenaAlloc(arena, model->binListSize, 16);
+		fl->shaderRecord = V3D_ArenaAlloc(arena, SHADER_RECORD_SIZE, 16);
+		fl->uniforms = V3D_ArenaAlloc(arena, UNIFORMS_SIZE, 16);
+		fl->renderStart = V3D_ArenaAlloc(arena, RENDER_LIST_HEADER + tiles * RENDER_LIST_PER_TILE, 16);
+		if (!fl->renderStart) return false;							// Frame size sum is wrong
+
+		// Render control list, clear then every tile branching to the list the binner built for it
+		V3D_LIST list;
+		V3DList_Init(&list, (void*)(uintptr_t)GPUaddrToARMaddr(fl->renderStart), fl->renderStart,
+			RENDER_LIST_HEADER + tiles * RENDER_LIST_PER_TILE);
+		V3DList_RenderTiles(&list, 0xff000000,							// Opaque Black
+			model->renderBufferAddr, model->renderWth, model->renderHt,
+			0x04,														// framebuffer mode (linear rgba8888)
+			model->binWth, model->binHt, tileAlloc);
+		if (list.overflow) return false;								// Render list size sum is wrong
+		fl->renderEnd = V3DList_EndVC4(&list);
+
+		// Binning control list
+		V3DList_Init(&list, (void*)(uintptr_t)GPUaddrToARMaddr(fl->binStart), fl->binStart, BIN_LIST_HEADER);
+
+		// Tile Binning Configuration.
+		//   Tile state data is 48 bytes per tile, I think it can be thrown away
+		//   as soon as binning is finished.
+		//   A tile itself is 64 x 64 pixels 
+		//   we will need binWth of them across to cover the render width
+		//   we will need binHt of them down to cover the render height
+		V3DList_TileBinningConfig(&list, tileAlloc, model->tileAllocSize, tileState,
+			model->binWth, model->binHt, 0x04);							// auto initialise tile state
+		V3DList_StartTileBinning(&list);
+
+		V3DList_PrimitiveListFormat(&list, 0x12);	/* was 0x32 ???? */		// 16 bit triangle
+		V3DList_ClipWindow(&list, 0, 0, model->renderWth, model->renderHt);
+		if (model->depthTest) V3DList_ConfigState(&list, 0x03, 0x90, 0x03);	// both faces, depth less and update, early Z on and update
+			else V3DList_ConfigState(&list, 0x03, 0x70, 0x00);			// both faces, depth always (shader writes Z), early Z off
+		V3DList_ViewportOffset(&list, 0, 0);
+
+		// The model
+		if (model->vertexShading) {
+			// Shader state with coordinate and vertex shaders, 1 attribute array
+			V3DList_ShaderState(&list, fl->shaderRecord, 1);
+		} else {
+			// No Vertex Shader state (takes pre-transformed vertexes so we don't have to supply a working coordinate shader.)
+			V3DList_NVShaderState(&list, fl->shaderRecord);
+		}
+		if (list.overflow) return false;								// Binning list header size is wrong
+		fl->binPrims = V3DList_EndVC4(&list);
+		EmitPrimitives(model, fl);										// RenderModel redoes these each frame
+
+		// Okay now we need Shader Record to buffer
+		if (model->vertexShading) {
+			GL_SHADER_STATE_RECORD* sp = (GL_SHADER_STATE_RECORD*)(uintptr_t)GPUaddrToARMaddr(fl->shaderRecord);
+			sp->flags = 0x01;											// fragment shader single threaded, no clipping
+			sp->fragNumUniforms = 0;									// num uniforms (not used)
+			sp->fragNumVaryings = 3;									// num varyings
+			sp->fragment_shader = model->fragShaderVC4;	// Fragment shader code
+			sp->fragment_uniforms = model->fragUniformVC4; // Fragment shader uniforms
+			sp->vertNumUniforms = 0;									// num uniforms (not used)
+			sp->vertAttribSelect = 0x01;								// attribute array 0
+			sp->vertAttribSize = sizeof(struct OriginalVertex);			// x,y,z floats
+			sp->vertex_shader = model->vertShaderVC4;	// Vertex shader code
+			sp->vertex_uniforms = fl->uniforms; // Matrix uniforms
+			sp->coordNumUniforms = 0;									// num uniforms (not used)
+			sp->coordAttribSelect = 0x01;								// attribute array 0
+			sp->coordAttribSize = sizeof(struct OriginalVertex);		// x,y,z floats
+			sp->coordinate_shader = model->coordShaderVC4;	// Coordinate shader code
+			sp->coordinate_uniforms = fl->uniforms; // Same matrix uniforms
+			GL_ATTRIBUTE_RECORD* ap = (GL_ATTRIBUTE_RECORD*)(sp + 1);	// Attribute records follow
+			ap->base_addr = model->originalVertexVC4;					// Original vertexes uploaded once
+			ap->sizeMinusOne = sizeof(struct OriginalVertex) - 1;		// 12 bytes read
+			ap->stride = sizeof(struct OriginalVertex);					// stride
+			ap->vertVPMOffset = 0;										// x,y,z at VPM start
+			ap->coordVPMOffset = 0;										// x,y,z at VPM start
+		} else {
+			NV_SHADER_STATE* sp = (NV_SHADER_STATE*)(uintptr_t)GPUaddrToARMaddr(fl->shaderRecord);
+			sp->flags =  0x01;										// flags
+			sp->stride = sizeof(struct EmitVertex);					// stride for VBO
+			sp->numUniforms = 0x0; // 0xcc;									// num uniforms (not used)
+			sp->numVaryings = 3;									// num varyings
+			sp->fragment_shader = (model->texture) ? model->texShaderVC4 : model->fragShaderVC4; // Fragment shader code
+			sp->uniform_data = model->fragUniformVC4; // Fragment shader uniforms (texture config)
+			sp->vertex_data = model->vertexVC4 + frame * model->emitSize;	// This frame's vertexes VC4 address
+		}
+	}
+	return true;
+}
 
-			model->originalVertexARM = (struct OriginalVertex*)(uintptr_t)(model->modelDataARM + 
-				(model->IndexVertexCt * sizeof(uint16_t)) + (model->num_verts * sizeof(struct  EmitVertex)));
+bool SetVertexShading (struct obj_model_t* model, bool onQPU)
+{
+	if ((model) && (model->meshPool.handle) && (model->shaderPool.handle)) {
+		V3D_WaitIdle();												// Lists are in use till frames finish
+		model->vertexShading = onQPU;								// Set transform path
+		return EmitFrameLists(model);								// Rebuild frame lists and shader records
+	}
+	return false;
+}
 
-			if (!ParseWaveFrontMesh(fileName, model, true, desiredMaxSize)) return false;
+bool SetCulling (struct obj_model_t* model, uint32_t cullFlags, bool depthTest)
+{
+	if ((model) && (model->meshPool.handle) && (model->shaderPool.handle)) {
+		V3D_WaitIdle();												// Lists are in use till frames finish
+		model->cullFlags = cullFlags;								// Tests EmitPrimitives makes
+		model->depthTest = depthTest;								// Config state in the binning list
+		return EmitFrameLists(model);								// Rebuild frame lists
+	}
+	return false;
+}
+
+/*--------------------------------------------------------------------------}
+{ Texels the two mipmap downsample buffers need, level 1 and level 2 size. }
+{ Each level is made from the one before into the other buffer in turn.    }
+{--------------------------------------------------------------------------*/
+static uint32_t MipScratchTexels (uint32_t width, uint32_t height, bool mipmaps)
+{
+	if (!mipmaps) return 0;
+	uint32_t w1 = (width > 1) ? width / 2 : 1, h1 = (height > 1) ? height / 2 : 1;
+	uint32_t w2 = (w1 > 1) ? w1 / 2 : 1, h2 = (h1 > 1) ? h1 / 2 : 1;
+	return w1 * h1 + w2 * h2;
+}
 
+/*--------------------------------------------------------------------------}
+{ Lays out the texture in its own arena, swizzles level 0 from texels and  }
+{ each smaller level from the one before, using mip (MipScratchTexels) to  }
+{ hold them, then makes the two texture config uniforms.                   }
+{--------------------------------------------------------------------------*/
+static bool BuildTexture (V3D_TEXTURE* tex, const uint32_t* texels, uint32_t width, uint32_t height, bool mipmaps, uint32_t* mip)
+{
+	TEXTURE_LAYOUT layout;
+	*tex = (V3D_TEXTURE) { 0 };
+	if (!Texture_Layout(&layout, width, height, mipmaps)) return false;
+	if (!V3D_ArenaCreate(&tex->memory, layout.size)) return false;
+	uint64_t t = timer_getTickCount();
+	uint8_t* base = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(tex->memory.baseVC4);
+	uint32_t* buffer[2] = { mip, mip + ((width > 1) ? width / 2 : 1) * ((height > 1) ? height / 2 : 1) };
+	const uint32_t* src = texels;
+	for (uint32_t i = 0; i < layout.levels; i++) {
+		if (i > 0) {												// Box filter the level before
+			Texture_Downsample(buffer[(i - 1) & 1], src, layout.level[i - 1].width, layout.level[i - 1].height);
+			src = buffer[(i - 1) & 1];
+		}
+		Texture_Swizzle(base + layout.level[i].offset, &layout.level[i], src, layout.level[i].width);
+	}
+	tex->convertUs = tick_difference(t, timer_getTickCount());
+	tex->levelVC4 = tex->memory.baseVC4 + layout.level[0].offset;
+	tex->width = width;
+	tex->height = height;
+	tex->levels = layout.levels;
+
+	TEXTURE_CONFIG_BLOCK p0 = { .Raw32 = 0 };
+	p0.base_addr = tex->levelVC4 >> 12;								// Level 0 page, the TMU steps back to the others
+	p0.texture_type = TEXTURE_TYPE_RGBA8888;
+	p0.mip_levels = layout.levels - 1;
+	TEXTURE_CONFIG_PARAMS p1 = { .Raw32 = 0 };
+	p1.wrap_s = WRAPMODE_REPEAT;
+	p1.wrap_t = WRAPMODE_REPEAT;
+	p1.minfilt = (mipmaps) ? MINFILT_LIN_MIP_NEAR : MINFILT_LINEAR;	// Bilinear in the nearest level
+	p1.magfilt = MAGFILT_LINEAR;
+	p1.width = width & 0x7FF;										// 2048 is held as 0
+	p1.height = height & 0x7FF;
+	tex->config[0] = p0.Raw32;
+	tex->config[1] = p1.Raw32;
+	return true;
+}
 
-			uint8_t *p = (uint8_t*)(uintptr_t)model->rendererDataARM;
+bool CreateTexture (V3D_TEXTURE* tex, const uint32_t* texels, uint32_t width, uint32_t height, bool mipmaps)
+{
+	V3D_ARENA scratch = { 0 };
+	if ((!tex) || (!texels)) return false;
+	uint32_t mipTexels = MipScratchTexels(width, height, mipmaps);
+	if ((mipTexels) && (!V3D_ArenaCreate(&scratch, mipTexels * sizeof(uint32_t)))) return false;
+	bool ok = BuildTexture(tex, texels, width, height, mipmaps,
+		(mipTexels) ? (uint32_t*)(uintptr_t)GPUaddrToARMaddr(scratch.baseVC4) : 0);
+	V3D_ArenaDestroy(&scratch);
+	return ok;
+}
 
-			// Configuration stuff
-			// Tile Binning Configuration.
-			//   Tile state data is 48 bytes per tile, I think it can be thrown away
-			//   as soon as binning is finished.
-			//   A tile itself is 64 x 64 pixels 
-			//   we will need binWth of them across to cover the render width
-			//   we will need binHt of them down to cover the render height
-			//   we add 63 before the division because any fraction at end must have a bin
+bool LoadTexture (const char* fileName, V3D_TEXTURE* tex, bool mipmaps, printhandler prn_handler)
+{
+	uint8_t header[54];												// BMP file and info headers
+	uint32_t bytesRead, width = 0, height = 0;
+	V3D_ARENA scratch = { 0 };
+	if ((!fileName) || (!tex)) return false;
+	HANDLE fh = sdCreateFile(fileName, GENERIC_READ, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fh == 0) {
+		if (prn_handler) prn_handler("Texture %s not found\n", fileName);
+		return false;
+	}
+	uint32_t fileSize = sdGetFileSize(fh, 0);
+	bool ok = sdReadFile(fh, header, sizeof(header), &bytesRead, 0)
+		&& (bytesRead == sizeof(header)) && Texture_BmpSize(header, fileSize, &width, &height);
+
+	// File, decoded texels and mipmap buffers only live while the texture is made
+	uint32_t fileBytes = (fileSize + 3) & ~3;
+	uint32_t texelBytes = width * height * sizeof(uint32_t);
+	ok = ok && V3D_ArenaCreate(&scratch, fileBytes + texelBytes + MipScratchTexels(width, height, mipmaps) * sizeof(uint32_t));
+	uint8_t* file = (ok) ? (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scratch.baseVC4) : 0;
+	if (ok) {
+		memcpy(file, header, sizeof(header));
+		ok = sdReadFile(fh, file + sizeof(header), fileSize - sizeof(header), &bytesRead, 0)
+			&& (bytesRead == fileSize - sizeof(header));
+	}
+	sdCloseHandle(fh);
+	uint32_t* texels = (uint32_t*)(file + fileBytes);
+	ok = ok && Texture_DecodeBmp(file, fileSize, texels)
+		&& BuildTexture(tex, texels, width, height, mipmaps, (uint32_t*)(file + fileBytes + texelBytes));
+	V3D_ArenaDestroy(&scratch);
+	if (prn_handler) {
+		if (ok) prn_handler("Texture %s %ux%u, %u levels in %u usec\n", fileName,
+			(unsigned int)width, (unsigned int)height, (unsigned int)tex->levels, (unsigned int)tex->convertUs);
+			else prn_handler("Texture %s is not a 24/32 bit BMP or did not fit in memory\n", fileName);
+	}
+	return ok;
+}
 
+void DestroyTexture (V3D_TEXTURE* tex)
+{
+	if (tex) {
+		V3D_ArenaDestroy(&tex->memory);
+		*tex = (V3D_TEXTURE) { 0 };
+	}
+}
 
-			//uint_fast32_t binListSize = (binWth * binHt) * sizeof(struct TileListEntry);
+bool SetTexture (struct obj_model_t* model, const V3D_TEXTURE* tex)
+{
+	if ((model) && (model->meshPool.handle) && (model->shaderPool.handle)) {
+		V3D_WaitIdle();												// Uniforms and vertexes are in use till frames finish
+		model->texture = (tex && tex->memory.handle) ? tex : 0;
+		uint32_t* uniforms = (uint32_t*)(uintptr_t)GPUaddrToARMaddr(model->fragUniformVC4);
+		uniforms[0] = (model->texture) ? tex->config[0] : 0;		// Texture config the TMU reads
+		uniforms[1] = (model->texture) ? tex->config[1] : 0;
+		// Varyings 0,1 of every frame's vertexes become s,t mapped from model x,y, or back to grey
+		for (uint32_t frame = 0; frame < V3D_MAX_FRAMES; frame++) {
+			struct EmitVertex* ev = (struct EmitVertex*)((uintptr_t)model->vertexARM + frame * model->emitSize);
+			struct OriginalVertex* ov = model->originalVertexARM;
+			for (uint32_t i = 0; i < model->num_verts; i++, ev++, ov++) {
+				ev->red = (model->texture) ? ov->x / model->maxSize + 0.5f : 0.5f;
+				ev->green = (model->texture) ? ov->y / model->maxSize + 0.5f : 0.5f;
+			}
+		}
+		return EmitFrameLists(model);								// Shader record picks the fragment shader
+	}
+	return false;
+}
 
-			emit_uint8_t(&p, GL_TILE_BINNING_CONFIG);						// tile binning config control 
-			emit_uint32_t(&p, model->rendererDataVC4 + BUFFER_TILE_DATA);	// tile allocation memory address
-			emit_uint32_t(&p, 0x10000);										// tile allocation memory size
-			emit_uint32_t(&p, model->rendererDataVC4 + BUFFER_TILE_STATE);	// Tile state data address
-			emit_uint8_t(&p, model->binWth);								// renderWidth/64
-			emit_uint8_t(&p, model->binHt);									// renderHt/64
-			emit_uint8_t(&p, 0x04);											// config
+bool GetRenderMemStats (struct obj_model_t* model, V3D_MEM_STATS* stats)
+{
+	if ((!model) || (!stats)) return false;
+	*stats = (V3D_MEM_STATS) { 0 };
+	stats->shaderPoolUsed = model->shaderPool.used;
+	stats->meshPoolUsed = model->meshPool.used;
+	stats->frameSize = model->frameArena[0].size;
+	stats->frameUsed = model->frameArena[0].used;					// Every frame is laid out the same
+	stats->tileAllocSize = model->tileAllocSize;
+	stats->tileOverflowSize = model->tileOverflowSize;
+	stats->lastOverflow = model->lastOverflow;
+	stats->overflowFrames = model->overflowFrames;
+	stats->totalGPU = model->shaderPool.size + model->meshPool.size;
+	for (int i = 0; i < V3D_MAX_FRAMES; i++)
+		stats->totalGPU += model->frameArena[i].size;
+	return true;
+}
 
-			// Start tile binning.
-			emit_uint8_t(&p, GL_START_TILE_BINNING);						// Start binning command
+/*--------------------------------------------------------------------------}
+{ Creates the mesh pool for the model counts and places the index array,   }
+{ a copy of the emit vertexes for each frame and the original vertexes.    }
+{ Each array starts 16 byte aligned, the original vertexes are read by the }
+{ vertex cache as the shader attribute array so are padded for max index+2 }
+{ The cull clusters and frame runs only the ARM uses go last.               }
+{--------------------------------------------------------------------------*/
+static bool CreateMeshPool (struct obj_model_t* model)
+{
+	uint32_t indexSize = ((model->IndexVertexCt * sizeof(uint16_t)) + 15) & ~15;
+	uint32_t emitSize = ((model->num_verts * sizeof(struct EmitVertex)) + 15) & ~15;
+	uint32_t origSize = (model->num_verts + 2) * sizeof(struct OriginalVertex);
+	uint32_t clusters = (model->IndexVertexCt / 3 + CULL_CLUSTER_TRIS - 1) / CULL_CLUSTER_TRIS;
+	uint32_t cullSize = ((Cull_MemorySize(model->IndexVertexCt) + 15) & ~15)
+		+ (clusters + 1) * sizeof(CULL_RUN);						// A run a cluster at worst, 1 if no clusters
+	uint32_t memSize = indexSize + emitSize * V3D_MAX_FRAMES + origSize + 16	// Emit vertexes for each frame in flight
+		+ cullSize + 16;
+
+	if (!V3D_ArenaCreate(&model->meshPool, memSize)) return false;
+	model->modelDataVC4 = V3D_ArenaAlloc(&model->meshPool, indexSize, 16);	// Index array
+	model->modelDataARM = GPUaddrToARMaddr(model->modelDataVC4);	// Convert locked memory to ARM address
+
+	model->vertexVC4 = V3D_ArenaAlloc(&model->meshPool, emitSize * V3D_MAX_FRAMES, 16);
+	model->vertexARM = (struct EmitVertex*)(uintptr_t)GPUaddrToARMaddr(model->vertexVC4); // Create pointer
+
+	model->emitSize = emitSize;										// Frame k vertexes at k * emitSize
+
+	model->originalVertexVC4 = V3D_ArenaAlloc(&model->meshPool, origSize, 16);	// Attribute array VC4 address
+	model->originalVertexARM = (struct OriginalVertex*)(uintptr_t)GPUaddrToARMaddr(model->originalVertexVC4);
+
+	model->cullVC4 = V3D_ArenaAlloc(&model->meshPool, cullSize, 16);	// Clusters then runs
+	model->cullRuns = (CULL_RUN*)(uintptr_t)(GPUaddrToARMaddr(model->cullVC4)
+		+ ((Cull_MemorySize(model->IndexVertexCt) + 15) & ~15));
+	model->cull.count = 0;											// Built once the mesh is loaded
+	return true;
+}
 
-			// Primitive type
-			emit_uint8_t(&p, GL_PRIMITIVE_LIST_FORMAT);
-			emit_uint8_t(&p, 0x12);		/* was 0x32 ???? */					// 16 bit triangle
+/*--------------------------------------------------------------------------}
+{ Loads a binary mesh cache (see rpi-MeshFile.h). The index block is read  }
+{ straight into the index array, the position block into the frame emit    }
+{ vertexes which are free till the positions are expanded from them.       }
+{ Returns false with nothing allocated if the file is missing or bad.      }
+{--------------------------------------------------------------------------*/
+static bool LoadMeshFile (const char* fileName, struct obj_model_t* model, float desiredMaxSize, printhandler prn_handler)
+{
+	MESH_FILE_HEADER hdr;
+	uint32_t bytesRead;
+	HANDLE fh = sdCreateFile(fileName, GENERIC_READ, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fh == 0) return false;										// No cache file
+	uint32_t fileSize = sdGetFileSize(fh, 0);
+	if (!sdReadFile(fh, &hdr, sizeof(hdr), &bytesRead, 0) || !MeshFile_CheckHeader(&hdr, fileSize)) {
+		sdCloseHandle(fh);
+		if (prn_handler) prn_handler("Mesh cache %s is not valid, ignored\n", fileName);
+		return false;
+	}
 
-			// Clip Window
-			emit_uint8_t(&p, GL_CLIP_WINDOW);								// Clip window 
-			emit_uint16_t(&p, 0);											// 0
-			emit_uint16_t(&p, 0);											// 0
-			emit_uint16_t(&p, model->renderWth);							// width
-			emit_uint16_t(&p, model->renderHt);								// height
+	model->num_verts = hdr.vertexCount;
+	model->IndexVertexCt = hdr.indexCount;
+	model->num_faces = hdr.sourceFaces;
+	model->tri_count = hdr.indexCount / 3;							// Faces are all triangles now
+	model->quad_count = model->polygon_count = 0;
+	model->minX = hdr.min[0]; model->maxX = hdr.max[0];
+	model->minY = hdr.min[1]; model->maxY = hdr.max[1];
+	model->minZ = hdr.min[2]; model->maxZ = hdr.max[2];
+	model->offsX = (model->maxX + model->minX) / 2.0f;
+	model->offsY = (model->maxY + model->minY) / 2.0f;
+	model->offsZ = (model->maxZ + model->minZ) / 2.0f;
+	float maxSize = model->maxX - model->minX;
+	if (model->maxY - model->minY > maxSize) maxSize = model->maxY - model->minY;
+	if (model->maxZ - model->minZ > maxSize) maxSize = model->maxZ - model->minZ;
+	model->scale = (maxSize > 0.0f) ? desiredMaxSize / maxSize : 1.0f;
+
+	uint32_t indexBytes = hdr.positionOffset - hdr.indexOffset;	// Index block with its padding
+	uint32_t restBytes = hdr.fileSize - hdr.positionOffset;			// Positions and normals
+	bool ok = CreateMeshPool(model);
+	ok = ok && (restBytes <= model->emitSize * V3D_MAX_FRAMES)		// Positions are far smaller than emit vertexes
+		&& sdReadFile(fh, (void*)(uintptr_t)model->modelDataARM, indexBytes, &bytesRead, 0)
+		&& sdReadFile(fh, model->vertexARM, restBytes, &bytesRead, 0);
+	sdCloseHandle(fh);
 
-			// GL State
-			emit_uint8_t(&p, GL_CONFIG_STATE);
-			emit_uint8_t(&p, 0x03);											// enable both foward and back facing polygons
-			emit_uint8_t(&p, 0x00);											// depth testing disabled
-			emit_uint8_t(&p, 0x0 /*0x02*/);											// enable early depth write
+	uint16_t* indices = (uint16_t*)(uintptr_t)model->modelDataARM;
+	model->MaxIndexVertex = 0;
+	for (uint32_t i = 0; ok && i < hdr.indexCount; i++)
+		if (indices[i] > model->MaxIndexVertex) model->MaxIndexVertex = indices[i];
+	if (!ok || (model->MaxIndexVertex != hdr.maxIndex)) {			// Short read or indexes don't match the header
+		V3D_ArenaDestroy(&model->meshPool);
+		model->num_verts = model->IndexVertexCt = model->MaxIndexVertex = 0;	// OBJ parse counts up from zero
+		model->num_faces = model->tri_count = 0;
+		if (prn_handler) prn_handler("Mesh cache %s did not load, ignored\n", fileName);
+		return false;
+	}
 
-			// Viewport offset
-			emit_uint8_t(&p, GL_VIEWPORT_OFFSET);							// Viewport offset
-			emit_uint16_t(&p, 0);											// 0
-			emit_uint16_t(&p, 0);											// 0
+	MeshFile_Positions(&hdr, (int16_t*)model->vertexARM, model->scale,
+		model->originalVertexARM, sizeof(struct OriginalVertex));	// Expand the positions first
+	struct EmitVertex* ev = model->vertexARM;						// Then the emit vertexes can overwrite them
+	for (uint32_t i = 0; i < model->num_verts; i++, ev++) {
+		ev->w = 1.0f;												// No perspective so 1/W is 1
+		ev->red = 0.5f;												// Varying 0 (Red)
+		ev->green = 0.5f;											// Varying 1 (Green)
+		ev->blue = 0.5f;											// Varying 2 (Blue)
+	}
+	if (prn_handler) prn_handler("Mesh cache: %u vertices, %u triangles\n",
+		(unsigned int)model->num_verts, (unsigned int)(model->IndexVertexCt / 3));
+	return true;
+}
 
-			// The model
-			// No Vertex Shader state (takes pre-transformed vertexes so we don't have to supply a working coordinate shader.)
-			emit_uint8_t(&p, GL_NV_SHADER_STATE);
-			emit_uint32_t(&p, model->rendererDataVC4 + BUFFER_SHADER_OFFSET);	// Shader Record
-
-			// primitive index list
-			#define INDEX_TYPE_8  0x00   //  Indexed_Primitive_List: Index Type = 8 - Bit
-			#define INDEX_TYPE_16 0x10   //  Indexed_Primitive_List: Index Type = 16 - Bit
-			emit_uint8_t(&p, GL_INDEXED_PRIMITIVE_LIST);					// Indexed primitive list command
-			emit_uint8_t(&p, PRIM_TRIANGLE | INDEX_TYPE_16);				// 16bit index, triangles
-			emit_uint32_t(&p, model->IndexVertexCt);						// Length
-			emit_uint32_t(&p, model->modelDataVC4);							// address of vertex data
-			emit_uint32_t(&p, model->MaxIndexVertex + 2);						// Maximum index
-
-			// End of bin list
-			// So Flush
-			emit_uint8_t(&p, GL_FLUSH_ALL_STATE);
-			// Nop
-			emit_uint8_t(&p, GL_NOP);
-			// Halt
-			emit_uint8_t(&p, GL_HALT);
-
-			model->binningConfigLength = (uintptr_t)p - (uintptr_t)model->rendererDataARM;
-			
-			// Okay now we need Shader Record to buffer
-			NV_SHADER_STATE* sp = (NV_SHADER_STATE*)(uintptr_t)(model->rendererDataARM + BUFFER_SHADER_OFFSET);
-			sp->flags =  0x01;										// flags
-			sp->stride = sizeof(struct EmitVertex);					// stride for VBO
-			sp->numUniforms = 0x0; // 0xcc;									// num uniforms (not used)
-			sp->numVaryings = 3;									// num varyings
-			sp->fragment_shader = (uintptr_t)(model->rendererDataVC4 + BUFFER_FRAGMENT_SHADER); // Fragment shader code
-			sp->uniform_data = (uintptr_t)(model->rendererDataVC4 + BUFFER_FRAGMENT_UNIFORM); // Fragment shader uniforms
-			sp->vertex_data = model->vertexVC4;						// Vertex with VC4 address
+/*--------------------------------------------------------------------------}
+{ Mesh cache name for an OBJ file, the same name with a .msh extension.    }
+{--------------------------------------------------------------------------*/
+static bool MeshCacheName (const char* fileName, char* cacheName, uint32_t size)
+{
+	const char* dot = strrchr(fileName, '.');
+	uint32_t len = (dot && !strchr(dot, '\\')) ? (uint32_t)(dot - fileName) : strlen(fileName);
+	if (len + 5 > size) return false;								// No room for .msh and terminate
+	memcpy(cacheName, fileName, len);
+	strcpy(&cacheName[len], ".msh");
+	return true;
+}
 
+bool CreateVertexData (const char* fileName, struct obj_model_t* model, float desiredMaxSize, printhandler prn_handler) {
+	if (prn_handler) prn_handler("Loading %s\n", fileName);
+	if (model) {
+		static const MATRIX3D tiltX = MATRIX3D_XROT_INIT(0.78539815f);	// Fixed 45 degree view tilts
+		static const MATRIX3D tiltY = MATRIX3D_YROT_INIT(0.78539815f);
+		Matrix3D_Multiply(&model->viewMatrix, &tiltX, &tiltY);
+
+		uint64_t t = timer_getTickCount();
+		char cacheName[256];
+		const char* dot = strrchr(fileName, '.');
+		bool isCache = (dot && (strcmp(dot, ".msh") == 0 || strcmp(dot, ".MSH") == 0));
+		if (isCache) {
+			if (!LoadMeshFile(fileName, model, desiredMaxSize, prn_handler)) return false;
+		} else if (MeshCacheName(fileName, cacheName, sizeof(cacheName))
+			&& LoadMeshFile(cacheName, model, desiredMaxSize, prn_handler)) {
+			fileName = cacheName;									// Cache beside the OBJ was used
+		} else {
+			// No cache so parse the OBJ text, a count pass then a fill pass
+			if (!ParseWaveFrontMesh(fileName, model, false, desiredMaxSize)) return false;
+
+			model->IndexVertexCt = model->tri_count*3;
+			model->IndexVertexCt += model->quad_count * 6;
+			model->IndexVertexCt += model->polygon_count * 9;
+
+			if (!CreateMeshPool(model)) {
+				if (prn_handler) prn_handler("Error: Unable to allocate vertex data memory");
+				return false;
+			}
+			if (!ParseWaveFrontMesh(fileName, model, true, desiredMaxSize)) return false;
+		}
+		model->maxSize = desiredMaxSize;
+		if (prn_handler) prn_handler("Loaded %s in %u ms\n", fileName,
+			(unsigned int)(tick_difference(t, timer_getTickCount()) / 1000));
+
+		for (uint32_t frame = 1; frame < V3D_MAX_FRAMES; frame++)		// Other frames start as copies of frame 0
+			memcpy((uint8_t*)model->vertexARM + frame * model->emitSize, model->vertexARM, model->emitSize);
+
+		// Clusters for culling, without them the whole mesh is always drawn
+		if (!Cull_BuildSet(&model->cull, (void*)(uintptr_t)GPUaddrToARMaddr(model->cullVC4),
+			Cull_MemorySize(model->IndexVertexCt), model->originalVertexARM, sizeof(struct OriginalVertex),
+			(uint16_t*)(uintptr_t)model->modelDataARM, model->IndexVertexCt)) model->cull.count = 0;
+		model->cullFlags = CULL_FRUSTUM | CULL_BACKFACE;
+		model->depthTest = true;
+		if (prn_handler) prn_handler("%u clusters of %u triangles for culling\n",
+			(unsigned int)model->cull.count, (unsigned int)CULL_CLUSTER_TRIS);
+
+		// Tile allocation memory sized from the screen tiles and triangle count
+		uint32_t tileAlloc = model->binWth * model->binHt * TILE_ALLOC_PER_TILE
+			+ (model->IndexVertexCt / 3) * TILE_ALLOC_PER_PRIM;
+		if (tileAlloc < TILE_ALLOC_MIN) tileAlloc = TILE_ALLOC_MIN;
+		model->tileAllocSize = (tileAlloc + 0xFFF) & ~0xFFF;
+
+		if (EmitFrameLists(model)) {									// Frame lists for current transform path
+			if (prn_handler) prn_handler(" Display starts in 5 seconds\n");
+			timer_wait(5000000);
 			return true;
 		}
-		if (prn_handler) prn_handler("Error: Unable to allocate vertex data memory");
+		if (prn_handler) prn_handler("Error: Unable to allocate frame memory");
 	}
 	return false;
 }
-
-
@@ -28,68 +28,137 @@ extern "C" {									// Put extern C directive wrapper around
 #include <stdbool.h>							// Needed for bool and true/false
 #include <stdint.h>								// Needed for uint8_t, uint32_t, etc
 #include "rpi-smartstart.h"						// Need for mailbox
+#include "rpi-Math3D.h"							// Need for VEC3 and MATRIX3D
+#include "rpi-Cull.h"							// Need for CULL_SET and CULL_STATS
 
-/* check if GLfloat is defined */
-#ifndef GLfloat
-#define GLfloat float
-#endif
+#define V3D_MAX_FRAMES	3						// Frames that can be in flight on the V3D at once
 
-/* check if GLFLOAT_ZERO is defined if not assign it as (GLfloat)0 */
-#ifndef GLFLOAT_ZERO
-#define GLFLOAT_ZERO ((GLfloat) 0)
-#endif
+/* Timestamps (1Mhz timer ticks) of a frame through the V3D queue */
+typedef struct v3d_frame_times {
+	uint64_t submitTick;						// Frame given to V3D_SubmitFrame
+	uint64_t binStartTick;						// Binner (CT0) started on the frame
+	uint64_t binDoneTick;						// Binning flush seen done
+	uint64_t renderStartTick;					// Renderer (CT1) started on the frame
+	uint64_t renderDoneTick;					// Render seen done
+	uint32_t binOverflow;						// Bytes of the frame's overflow memory the binner took
+	// V3D performance counters over the frame's binning (PLB) and rendering (FEP)
+	uint32_t plbOutside;						// Primitives the binner dropped outside the viewport
+	uint32_t plbClipped;						// Primitives the binner had to clip
+	uint32_t fepPrims;							// Valid primitives set up, once for each tile they are in
+	uint32_t fepNoPixels;						// Of those primitives the ones that covered no pixel
+	uint32_t fepQuads;							// Valid 2x2 quads rasterised
+	uint32_t fepEarlyZ;							// Quads dropped by early Z or near/far clipping
+} V3D_FRAME_TIMES;
 
-/* check if GLFLOAT_ONE is defined if not assign it as (GLfloat)1 */
-#ifndef GLFLOAT_ONE
-#define GLFLOAT_ONE ((GLfloat) 1)
-#endif
+/* GPU memory arena, one V3D_mem_alloc block handed out by moving an offset up */
+typedef struct v3d_arena {
+	uint32_t handle;							// V3D_mem_alloc handle (0 = no memory)
+	uint32_t baseVC4;							// VC4 locked address of the block
+	uint32_t size;								// Block size in bytes
+	uint32_t used;								// Bytes handed out since create/reset
+	uint32_t peak;								// Most bytes ever handed out
+} V3D_ARENA;
+
+/* VC4 addresses of the control lists and buffers of one frame in flight */
+typedef struct v3d_frame_lists {
+	uint32_t binStart;							// Binning control list start
+	uint32_t binEnd;							// Binning control list end (moves with the primitive lists)
+	uint32_t binPrims;							// Where the frame's primitive lists start in the binning list
+	uint32_t renderStart;						// Render control list start
+	uint32_t renderEnd;							// Render control list end
+	uint32_t shaderRecord;						// Shader record
+	uint32_t uniforms;							// Vertex/coordinate shader matrix uniforms
+	uint32_t overflow;							// Binner overflow memory
+} V3D_FRAME_LISTS;
+
+/* GPU memory use of a loaded model and its renderer */
+typedef struct v3d_mem_stats {
+	uint32_t shaderPoolUsed;					// Bytes of shader pool in use (life of renderer)
+	uint32_t meshPoolUsed;						// Bytes of mesh pool in use (life of model)
+	uint32_t frameSize;							// Bytes of each of the V3D_MAX_FRAMES frame arenas
+	uint32_t frameUsed;							// Bytes each frame's lists and buffers use
+	uint32_t tileAllocSize;						// Tile allocation memory given to the binner each frame
+	uint32_t tileOverflowSize;					// Overflow memory behind it each frame
+	uint32_t lastOverflow;						// Overflow bytes the last finished frame took
+	uint32_t overflowFrames;					// Frames that have needed overflow memory
+	uint32_t totalGPU;							// All GPU memory held (sum of arena blocks)
+} V3D_MEM_STATS;
 
+/* A texture in GPU memory in the TMU T/LT-format layout (rpi-Texture.h) */
+typedef struct v3d_texture {
+	V3D_ARENA memory;							// Texture memory, levels smallest first
+	uint32_t levelVC4;							// VC4 address of level 0 (4K aligned)
+	uint32_t width;								// Level 0 texels across
+	uint32_t height;							// Level 0 texels down
+	uint32_t levels;							// Mipmap levels (1 = no mipmaps)
+	uint32_t config[2];							// Texture config parameters 0 and 1, the TMU reads them as uniforms
+	uint32_t convertUs;							// ARM usec swizzling and downsampling the levels
+} V3D_TEXTURE;
 
-typedef struct vec3 {
-	GLfloat x;
-	GLfloat y;
-	GLfloat z;
-} VEC3;
-
-typedef union {
-	// Normal C format array which will be ROW MAJOR
-	float coef[4][4];
-	// OPENGL etc want COLUMN MAJOR so define it so we can transpose when needed
-	struct __attribute__((__packed__, aligned(1))) {
-		float m00, m01, m02, m03;
-		float m10, m11, m12, m13;
-		float m20, m21, m22, m23;
-		float m30, m31, m32, m33;
-	} cm;
-} MATRIX3D, *PMATRIX3D;
+/* A QPU user program (compute kernel) in GPU memory with its uniform streams */
+typedef struct v3d_compute {
+	V3D_ARENA memory;							// Code, uniform streams and V3D_execute_qpu message list
+	uint32_t codeVC4;							// VC4 address of the kernel code
+	uint32_t uniformsVC4;						// VC4 address of the first QPU's uniform stream
+	uint32_t messageVC4;						// VC4 address of the message list
+	uint32_t uniformCount;						// Uniforms in each QPU's stream
+	uint32_t ticket;							// Ticket of the last V3D_ComputeLaunch
+} V3D_COMPUTE;
 
 /* OBJ model structure */
 struct obj_model_t
 {
-	uint32_t rendererHandle;					// Renderer memory handle
-	uint32_t rendererDataVC4;					// Renderer data VC4 locked address
-	uint32_t rendererDataARM;					// Renderer data ARM locked address
+	V3D_ARENA shaderPool;						// Shaders, lives as long as the renderer
+	uint32_t fragShaderVC4;						// Fragment shader VC4 address
+	uint32_t fragUniformVC4;					// Fragment shader uniforms VC4 address
+	uint32_t vertShaderVC4;						// Vertex shader VC4 address
+	uint32_t coordShaderVC4;					// Coordinate shader VC4 address
+	uint32_t texShaderVC4;						// Texturing fragment shader VC4 address
+	uint32_t renderBufferAddr;					// VC4 address frames render to
 	uint32_t renderWth;							// Render width
 	uint32_t renderHt;							// Render height
 	uint32_t binWth;							// Bin width
 	uint32_t binHt;								// Bin height
-	uint32_t binningConfigLength;				// Binning config length
-	uint32_t renderLength;						// Renderer data length
 
-	uint32_t modelHandle;						// Model memory handle
-	uint32_t modelDataVC4;						// Model data VC4 locked address
-	uint32_t modelDataARM;						// Model data ARM locked address
+	V3D_ARENA frameArena[V3D_MAX_FRAMES];		// Lists and tile memory, rebuilt with the lists
+	V3D_FRAME_LISTS frameList[V3D_MAX_FRAMES];	// Where each frame's lists and buffers are
+	uint32_t tileAllocSize;						// Tile allocation memory per frame (grows on overflow)
+	uint32_t tileOverflowSize;					// Overflow memory per frame
+	uint32_t lastOverflow;						// Overflow bytes the last finished frame took
+	uint32_t overflowFrames;					// Frames that have needed overflow memory
+
+	V3D_ARENA meshPool;							// Index and vertex arrays, lives as long as the model
+	uint32_t modelDataVC4;						// Index array VC4 address
+	uint32_t modelDataARM;						// Index array ARM address
 
 	uint32_t IndexVertexCt;						// Index vertex count
 	uint32_t MaxIndexVertex;					// Maximum Index vertex referenced
 
-	uint32_t vertexVC4;							// Physical Vertexes VC4 address
-	struct EmitVertex* vertexARM;				// Physical Vertexes ARM address
+	uint32_t vertexVC4;							// Physical Vertexes VC4 address (frame 0, each frame has a copy)
+	struct EmitVertex* vertexARM;				// Physical Vertexes ARM address (frame 0)
+	uint32_t emitSize;							// Byte size of one frame of physical vertexes
+
+	uint32_t originalVertexVC4;					// Original Vertexes VC4 address (vertex shader attribute array)
+	struct OriginalVertex* originalVertexARM;	// Original Vertexes ARM address
 
-	struct OriginalVertex* originalVertexARM;	// Original Vertexes ARM address   ... Needed until we sort Shader out
+	uint32_t cullVC4;							// Cluster and run memory in the mesh pool (ARM use only)
+	CULL_SET cull;								// Clusters of the index array (count 0 = none, never culled)
+	CULL_RUN* cullRuns;							// Index runs the last frame drew
+	CULL_STATS cullStats;						// What culling did to the last frame
+	uint32_t cullFlags;							// CULL_xxx tests applied each frame
+	bool depthTest;								// Depth buffer on with early Z
+	const V3D_TEXTURE* texture;					// Texture SetTexture bound (NULL = vertex colour)
+	uint32_t binListSize;						// Binning list bytes, room for a primitive list a cluster
 
+	bool vertexShading;							// True = QPU vertex/coordinate shaders transform, False = NV shader with ARM transform
+	float maxSize;								// Size the model was scaled to (sets the depth range)
 
 	MATRIX3D viewMatrix;
+	MATRIX3D mvp;								// Matrix DoRotate built, applied by RenderModel
+
+	uint32_t frameSlot;							// Frame buffers the next RenderModel uses
+	uint32_t frameTicket[V3D_MAX_FRAMES];		// V3D ticket last submitted from each frame slot
+	uint32_t transformUs;						// ARM usec applying mvp to the last submitted frame
 
 	uint32_t num_verts;                 /* number of vertices */
 	int num_texCoords;                 /* number of texture coords. */
@@ -126,12 +195,271 @@ bool V3D_execute_qpu (int32_t num_qpus, uint32_t control, uint32_t noflush, uint
 #define GL_FRAGMENT_SHADER	35632
 #define GL_VERTEX_SHADER	35633
 
+/*-[V3D_ArenaCreate]--------------------------------------------------------}
+. Allocates and locks a zeroed coherent GPU block of size bytes for the
+. arena to hand out. Frame arenas are reset and refilled each time their
+. lists are rebuilt, pools are only ever added to until destroyed.
+. RETURN: True block allocated, False no GPU memory (arena left empty)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_ArenaCreate (V3D_ARENA* arena, uint32_t size);
+
+/*-[V3D_ArenaAlloc]---------------------------------------------------------}
+. Hands out size bytes from the arena at the given power of 2 alignment.
+. The ARM address is GPUaddrToARMaddr of the returned address.
+. RETURN: VC4 address of the memory, 0 if the arena is too full
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3D_ArenaAlloc (V3D_ARENA* arena, uint32_t size, uint32_t align);
+
+/*-[V3D_ArenaReset]---------------------------------------------------------}
+. Takes back everything handed out, the block itself is kept.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_ArenaReset (V3D_ARENA* arena);
+
+/*-[V3D_ArenaDestroy]-------------------------------------------------------}
+. Unlocks and frees the arena block, the GPU must be done with it.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_ArenaDestroy (V3D_ARENA* arena);
+
+/*-[V3D_ComputeCreate]------------------------------------------------------}
+. Loads a QPU kernel of codeWords instruction words (low then high word of
+. each 64 bit instruction) into its own GPU memory with room for uniform
+. streams of uniformCount words for every QPU. The kernel must end with a
+. host interrupt then thrend and 2 delay slots as V3D_execute_qpu needs.
+. RETURN: True kernel loaded, False bad arguments or no GPU memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_ComputeCreate (V3D_COMPUTE* comp, const uint32_t* code, uint32_t codeWords, uint32_t uniformCount);
+
+/*-[V3D_ComputeUniforms]----------------------------------------------------}
+. The uniform streams to fill before a launch, QPU n's stream starts at
+. word n * uniformCount. Only refill them when the last launch is done.
+. RETURN: ARM pointer to the first stream, NULL if no kernel loaded
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t* V3D_ComputeUniforms (V3D_COMPUTE* comp);
+
+/*-[V3D_ComputeLaunch]------------------------------------------------------}
+. Queues the kernel on qpus QPUs (up to 12, the first qpus streams) as V3D
+. user program requests and returns at once. The V3D caches are cleared
+. first so the kernel sees what the ARM wrote. Results are in coherent
+. memory (V3D_ArenaCreate) when V3D_ComputeDone says the ticket is done.
+. RETURN: Ticket of the launch, 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3D_ComputeLaunch (V3D_COMPUTE* comp, uint32_t qpus);
+
+/*-[V3D_ComputeDone]--------------------------------------------------------}
+. Non blocking check if every QPU program up to the ticket has finished.
+. RETURN: True launch done, False still running
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_ComputeDone (uint32_t ticket);
+
+/*-[V3D_ComputeWait]--------------------------------------------------------}
+. Waits for the launch with the ticket to finish, timeoutUs 0 waits forever.
+. RETURN: True launch done, False timed out
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_ComputeWait (uint32_t ticket, uint32_t timeoutUs);
+
+/*-[V3D_ComputeExecute]-----------------------------------------------------}
+. Runs the kernel on qpus QPUs through the V3D_execute_qpu mailbox call,
+. which blocks until every QPU has raised its host interrupt or timeoutMs
+. is up. Launches still queued are waited on first.
+. RETURN: True kernel ran, False bad arguments or the GPU timed out
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_ComputeExecute (V3D_COMPUTE* comp, uint32_t qpus, uint32_t timeoutMs);
+
+/*-[V3D_ComputeDestroy]-----------------------------------------------------}
+. Gives back the kernel's GPU memory, its launches must be done.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_ComputeDestroy (V3D_COMPUTE* comp);
+
+/*-[V3D_SubmitFrame]--------------------------------------------------------}
+. Queues a frame given the VC4 start/end of its binning and render control
+. lists and returns at once unless V3D_MAX_FRAMES are already in flight.
+. The binner starts on it as soon as it is free, so frame N+1 bins while
+. frame N renders. The caller must not touch the lists, tile memory or
+. vertex data of a frame until it is done. The overflow block (size may be
+. 0) is handed to the binner in case the tile allocation memory runs out,
+. V3D_GetFrameTimes reports how much of it the frame took.
+. RETURN: Frame ticket (never 0)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3D_SubmitFrame (uint32_t binStart, uint32_t binEnd, uint32_t renderStart, uint32_t renderEnd,
+						  uint32_t overflow, uint32_t overflowSize);
+
+/*-[V3D_PollFrames]---------------------------------------------------------}
+. Non blocking, starts binning/rendering of queued frames as the hardware
+. frees up and retires finished ones. Not needed with the irq enabled.
+. RETURN: True if frames are still in flight, False if the V3D is idle
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_PollFrames (void);
+
+/*-[V3D_FrameDone]----------------------------------------------------------}
+. Non blocking check if the frame with the ticket has finished rendering.
+. RETURN: True if done (ticket 0 is always done), False if still in flight
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_FrameDone (uint32_t ticket);
+
+/*-[V3D_WaitFrame]----------------------------------------------------------}
+. Waits until the frame with the ticket has finished rendering.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_WaitFrame (uint32_t ticket);
+
+/*-[V3D_WaitIdle]-----------------------------------------------------------}
+. Waits until every submitted frame has finished rendering.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_WaitIdle (void);
+
+/*-[V3D_GetFrameTimes]------------------------------------------------------}
+. Copies the timestamps of a finished frame, only the last V3D_MAX_FRAMES
+. tickets are held.
+. RETURN: True times copied, False frame not done or no longer held
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_GetFrameTimes (uint32_t ticket, V3D_FRAME_TIMES* times);
+
+/*-[V3D_IrqHandler]---------------------------------------------------------}
+. Call from the irq handler, services the V3D binning/render done interrupt
+. and advances the queue.
+. RETURN: True if the V3D interrupt was serviced, False it was not the V3D
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_IrqHandler (void);
+
+/*-[V3D_EnableFrameIrq]-----------------------------------------------------}
+. Enables or disables the V3D binning/render done interrupt (GPU irq 10)
+. driving the queue. The irq handler must call V3D_IrqHandler when enabled.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_EnableFrameIrq (bool enable);
+
+/*-[DoRotate]---------------------------------------------------------------}
+. Advances the model rotation by delta radians and builds the screen matrix
+. centred on the given point. Nothing is written to GPU memory, the next
+. RenderModel applies the matrix to the frame it submits.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
 void DoRotate(float delta, int screenCentreX, int screenCentreY, struct obj_model_t* model);
-// Render a single triangle to memory.
-void RenderModel (struct obj_model_t* model, printhandler prn_handler);
+
+/*-[SetVertexShading]-------------------------------------------------------}
+. Selects how the model vertices are transformed and rebuilds the binning
+. control list to match. With onQPU true the original vertices are uploaded
+. once and GL_SHADER_STATE coordinate/vertex shaders apply the matrix that
+. DoRotate places in the uniforms. With onQPU false DoRotate transforms the
+. vertices on the ARM (NEON batched where available) for GL_NV_SHADER_STATE.
+. RETURN: True if the control list was rebuilt, False for no model data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SetVertexShading (struct obj_model_t* model, bool onQPU);
+
+/*-[SetCulling]-------------------------------------------------------------}
+. Selects the CPU cluster culling (rpi-Cull.h CULL_xxx flags, 0 for none)
+. RenderModel applies each frame and whether the depth buffer is used, with
+. early Z rejecting hidden fragments before the fragment shader runs. The
+. frame lists are rebuilt to match. CreateVertexData starts with frustum
+. and back face culling and depth on.
+. RETURN: True if the lists were rebuilt, False for no model data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SetCulling (struct obj_model_t* model, uint32_t cullFlags, bool depthTest);
+
+/*-[CreateTexture]----------------------------------------------------------}
+. Makes a texture from width x height texel words (R | G<<8 | B<<16 | A<<24,
+. bottom row first) in its own GPU memory, swizzled to the T/LT-format the
+. TMU reads and with every mipmap level box filtered down to 1x1 when
+. mipmaps is set (power of 2 sides only). The texels can be freed after.
+. RETURN: True texture made, False bad size or no GPU memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool CreateTexture (V3D_TEXTURE* tex, const uint32_t* texels, uint32_t width, uint32_t height, bool mipmaps);
+
+/*-[LoadTexture]------------------------------------------------------------}
+. Reads an uncompressed 24 or 32 bit BMP file from the SD card and makes a
+. texture of it as CreateTexture does. The file and the decoded texels only
+. need GPU memory while the texture is made.
+. RETURN: True texture made, False file missing, not a BMP or no memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool LoadTexture (const char* fileName, V3D_TEXTURE* tex, bool mipmaps, printhandler prn_handler);
+
+/*-[DestroyTexture]---------------------------------------------------------}
+. Gives back the texture's GPU memory, no model may still have it bound.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void DestroyTexture (V3D_TEXTURE* tex);
+
+/*-[SetTexture]-------------------------------------------------------------}
+. Binds tex to the model (NULL goes back to vertex colour). Its config goes
+. in the fragment shader uniforms and the NV shader path switches to the
+. texturing fragment shader, which samples with TMU0 at varyings 0 and 1.
+. The models have no usable texture coordinates so s,t are mapped from
+. the model x,y and repeat. The QPU vertex shader path keeps its depth
+. shade and the software render shows s,t as red and green. The texture
+. must stay until the model is unbound or done. The lists are rebuilt.
+. RETURN: True texture bound, False for no model data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SetTexture (struct obj_model_t* model, const V3D_TEXTURE* tex);
+
+/*-[RenderModel]------------------------------------------------------------}
+. Waits for the next of the V3D_MAX_FRAMES frame slots to be free, applies
+. the DoRotate matrix to it (uniforms or ARM transformed vertexes), culls
+. its clusters into primitive lists (model->cullStats has the triangle
+. counts) and submits it to the V3D queue. Returns without waiting for
+. the render so the ARM can go on to prepare the next frame.
+. RETURN: V3D ticket of the submitted frame, 0 if no model
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t RenderModel (struct obj_model_t* model, printhandler prn_handler);
+
+/*-[RenderModelSoftware]----------------------------------------------------}
+. Fallback render on the ARM. Applies the DoRotate matrix to the next frame
+. slot, culls it as RenderModel does and draws its binning list with
+. rpi-SoftRaster into pixels (pitch is pixels row to row) instead of
+. submitting it. NV shader state path only, the V3D is left idle first so
+. the two never share the screen. The tiles are dealt out to every ready
+. core (SoftRenderCores) and all of them are drawn before it returns.
+. RETURN: Triangle/tile pairs drawn, 0 if no model or on the QPU path
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t RenderModelSoftware (struct obj_model_t* model, uint32_t* pixels, uint32_t pitch);
+
+/*-[SoftRenderCores]--------------------------------------------------------}
+. RETURN: Cores RenderModelSoftware deals tiles to, 1 if only core 0
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t SoftRenderCores (void);
+
+/*-[GetRenderMemStats]------------------------------------------------------}
+. Fills in the GPU memory use of the model and its renderer, the overflow
+. figures are from the frames RenderModel has seen finish.
+. RETURN: True stats filled in, False no model or stats
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool GetRenderMemStats (struct obj_model_t* model, V3D_MEM_STATS* stats);
 
 bool SetupRenderer(struct obj_model_t* model, uint32_t renderWth, uint32_t renderHt, uint32_t renderBufferAddr);
 bool DoneRenderer (struct obj_model_t* model);
+/*-[CreateVertexData]-------------------------------------------------------}
+. Loads a model scaled to desiredMaxSize and builds its frame lists. A .msh
+. file (rpi-MeshFile.h) is read directly, for an OBJ file a .msh of the same
+. name beside it is used when present and valid, otherwise the OBJ text is
+. parsed. Host/MeshConvert makes the .msh files.
+. RETURN: True model ready to render, False load or memory failure
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
 bool CreateVertexData (const char* fileName, struct obj_model_t* model, float desiredMaxSize, printhandler prn_handler);
 
 
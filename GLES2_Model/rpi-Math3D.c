@@ -0,0 +1,410 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <math.h>								// Needed for sinf, cosf, sqrtf
+#include "rpi-Math3D.h"							// This units header
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>							// Pi2/Pi3 builds use NEON 4 points at a time
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Math3D.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+/*--------------------------------------------------------------------------}
+{                  IDENTITY MATRIX3D (4x4 MATRIX) DEFINITION                }
+{--------------------------------------------------------------------------*/
+const MATRIX3D IdentityMatrix3D = MATRIX3D_IDENTITY_INIT;
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                           3D VECTOR ROUTINES                              }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*--------------------------------------------------------------------------}
+{ Returns the dot product between the two vectors v1 & v2					}
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+GLfloat Vec3_Dot (const VEC3* v1, const VEC3* v2)
+{
+	return (v1->x * v2->x + v1->y * v2->y + v1->z * v2->z);
+}
+
+/*--------------------------------------------------------------------------}
+{ Writes the cross product v1 x v2 to result (result may alias v1 or v2)	}
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Vec3_Cross (VEC3* result, const VEC3* v1, const VEC3* v2)
+{
+	GLfloat x = v1->y * v2->z - v1->z * v2->y;						// Calculate all three before writing
+	GLfloat y = v1->z * v2->x - v1->x * v2->z;
+	GLfloat z = v1->x * v2->y - v1->y * v2->x;
+	result->x = x;
+	result->y = y;
+	result->z = z;
+}
+
+/*--------------------------------------------------------------------------}
+{ Scales the vector to unit length, zero length vector is left unchanged    }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Vec3_Normalize (VEC3* v)
+{
+	GLfloat len = v->x * v->x + v->y * v->y + v->z * v->z;
+	if (len > GLFLOAT_ZERO) {
+		len = GLFLOAT_ONE / sqrtf(len);								// One divide, three multiplies
+		v->x *= len;
+		v->y *= len;
+		v->z *= len;
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                           3D MATRIX ROUTINES                              }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*--------------------------------------------------------------------------}
+{ Sets the matrix to rotate about axis 0 = X, 1 = Y, 2 = Z by the angle     }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Matrix3D_SetRotation (MATRIX3D* m, uint_fast8_t axis, GLfloat angle_in_rad)
+{
+	GLfloat sineValue = sinf(angle_in_rad);							// Sine of angle
+	GLfloat cosineValue = cosf(angle_in_rad);						// Cosine of angle
+	uint_fast8_t i = (axis == 0) ? 1 : 0;							// First row/col the rotation uses
+	uint_fast8_t j = (axis == 2) ? 1 : 2;							// Second row/col the rotation uses
+	*m = IdentityMatrix3D;											// Start with identity matrix
+	m->coef[i][i] = cosineValue;									// Coef[i][i] = cos
+	m->coef[i][j] = -sineValue;										// Coef[i][j] = -sin
+	m->coef[j][i] = sineValue;										// Coef[j][i] = sin
+	m->coef[j][j] = cosineValue;									// Coef[j][j] = cos
+}
+
+/*--------------------------------------------------------------------------}
+{ Writes a * b to result. Each result row is the a row coefficients times   }
+{ the b rows, b is held in registers so result may alias a or b.            }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Matrix3D_Multiply (MATRIX3D* result, const MATRIX3D* a, const MATRIX3D* b)
+{
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	float32x4_t b0 = vld1q_f32(&b->coef[0][0]);						// Load all of b first
+	float32x4_t b1 = vld1q_f32(&b->coef[1][0]);
+	float32x4_t b2 = vld1q_f32(&b->coef[2][0]);
+	float32x4_t b3 = vld1q_f32(&b->coef[3][0]);
+	float32x4_t r[4];
+	for (uint_fast8_t i = 0; i < 4; i++) {							// For each row rank
+		float32x4_t s = vmulq_n_f32(b0, a->coef[i][0]);
+		s = vmlaq_n_f32(s, b1, a->coef[i][1]);
+		s = vmlaq_n_f32(s, b2, a->coef[i][2]);
+		r[i] = vmlaq_n_f32(s, b3, a->coef[i][3]);
+	}
+	vst1q_f32(&result->coef[0][0], r[0]);							// Store once all rows are done
+	vst1q_f32(&result->coef[1][0], r[1]);
+	vst1q_f32(&result->coef[2][0], r[2]);
+	vst1q_f32(&result->coef[3][0], r[3]);
+#else
+	MATRIX3D bm = *b;												// Copy of b as result may be b
+	for (uint_fast8_t i = 0; i < 4; i++) {							// For each row rank
+		GLfloat a0 = a->coef[i][0], a1 = a->coef[i][1];				// Read the a row before writing it
+		GLfloat a2 = a->coef[i][2], a3 = a->coef[i][3];
+		for (uint_fast8_t j = 0; j < 4; j++)						// For each column rank
+			result->coef[i][j] = a0 * bm.coef[0][j] + a1 * bm.coef[1][j] + a2 * bm.coef[2][j] + a3 * bm.coef[3][j];
+	}
+#endif
+}
+
+/*--------------------------------------------------------------------------}
+{ Transposes the 3D matrix from ROW MAJOR <==> COLUMN MAJOR or back again	}
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Matrix3D_Transpose (MATRIX3D* m)
+{
+	for (uint_fast8_t i = 0; i < 3; i++) {
+		for (uint_fast8_t j = i + 1; j <= 3; j++) {
+			GLfloat temp = m->coef[i][j];							// Swap the pair of coefficients
+			m->coef[i][j] = m->coef[j][i];
+			m->coef[j][i] = temp;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ True if the bottom row is 0,0,0,1 so transformed points need no w divide  }
+{--------------------------------------------------------------------------*/
+static inline bool IsAffine (const MATRIX3D* m)
+{
+	return ((m->coef[3][0] == GLFLOAT_ZERO) && (m->coef[3][1] == GLFLOAT_ZERO) &&
+		(m->coef[3][2] == GLFLOAT_ZERO) && (m->coef[3][3] == GLFLOAT_ONE));
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+/*--------------------------------------------------------------------------}
+{ Transforms 4 points held as x,y,z vectors. AARCH32 NEON has no divide so  }
+{ 1/w is the reciprocal estimate refined by two Newton steps, w values of 0 }
+{ or 1 are left undivided the same as the scalar code.                      }
+{--------------------------------------------------------------------------*/
+static inline void Transform4 (const MATRIX3D* m, bool affine, float32x4_t* x, float32x4_t* y, float32x4_t* z)
+{
+	float32x4_t px = *x, py = *y, pz = *z;
+	float32x4_t tx = vmlaq_n_f32(vdupq_n_f32(m->coef[0][3]), px, m->coef[0][0]);
+	float32x4_t ty = vmlaq_n_f32(vdupq_n_f32(m->coef[1][3]), px, m->coef[1][0]);
+	float32x4_t tz = vmlaq_n_f32(vdupq_n_f32(m->coef[2][3]), px, m->coef[2][0]);
+	tx = vmlaq_n_f32(tx, py, m->coef[0][1]);
+	ty = vmlaq_n_f32(ty, py, m->coef[1][1]);
+	tz = vmlaq_n_f32(tz, py, m->coef[2][1]);
+	tx = vmlaq_n_f32(tx, pz, m->coef[0][2]);
+	ty = vmlaq_n_f32(ty, pz, m->coef[1][2]);
+	tz = vmlaq_n_f32(tz, pz, m->coef[2][2]);
+	if (!affine) {
+		float32x4_t tw = vmlaq_n_f32(vdupq_n_f32(m->coef[3][3]), px, m->coef[3][0]);
+		tw = vmlaq_n_f32(tw, py, m->coef[3][1]);
+		tw = vmlaq_n_f32(tw, pz, m->coef[3][2]);
+		uint32x4_t skip = vorrq_u32(vceqq_f32(tw, vdupq_n_f32(0.0f)), vceqq_f32(tw, vdupq_n_f32(1.0f)));
+		tw = vbslq_f32(skip, vdupq_n_f32(1.0f), tw);				// w of 0 or 1 divides by 1
+		float32x4_t r = vrecpeq_f32(tw);							// Estimate 1/w
+		r = vmulq_f32(r, vrecpsq_f32(tw, r));						// Newton step 1
+		r = vmulq_f32(r, vrecpsq_f32(tw, r));						// Newton step 2
+		tx = vmulq_f32(tx, r);
+		ty = vmulq_f32(ty, r);
+		tz = vmulq_f32(tz, r);
+	}
+	*x = tx;
+	*y = ty;
+	*z = tz;
+}
+#endif
+
+/*--------------------------------------------------------------------------}
+{ Transforms one point, divides by w unless it is 0 or 1 (as TransformPoint3D)}
+{--------------------------------------------------------------------------*/
+static inline void Transform1 (const MATRIX3D* m, bool affine, GLfloat inX, GLfloat inY, GLfloat inZ,
+							   GLfloat* outX, GLfloat* outY, GLfloat* outZ)
+{
+	GLfloat tx = m->coef[0][0] * inX + m->coef[0][1] * inY + m->coef[0][2] * inZ + m->coef[0][3];
+	GLfloat ty = m->coef[1][0] * inX + m->coef[1][1] * inY + m->coef[1][2] * inZ + m->coef[1][3];
+	GLfloat tz = m->coef[2][0] * inX + m->coef[2][1] * inY + m->coef[2][2] * inZ + m->coef[2][3];
+	if (!affine) {
+		GLfloat tw = m->coef[3][0] * inX + m->coef[3][1] * inY + m->coef[3][2] * inZ + m->coef[3][3];
+		if ((tw != GLFLOAT_ZERO) && (tw != GLFLOAT_ONE)) {			// If tw is not zero or one
+			tw = GLFLOAT_ONE / tw;									// One divide, three multiplies
+			tx *= tw;
+			ty *= tw;
+			tz *= tw;
+		}
+	}
+	*outX = tx;
+	*outY = ty;
+	*outZ = tz;
+}
+
+/*--------------------------------------------------------------------------}
+{ Transforms an array of x,y,z points by the matrix (array of structures)   }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Matrix3D_TransformPoints (const MATRIX3D* m, const VEC3* in, VEC3* out, uint32_t count)
+{
+	uint32_t i = 0;
+	bool affine = IsAffine(m);										// Test the bottom row once per batch
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; i + 4 <= count; i += 4) {
+		float32x4x3_t p = vld3q_f32(&in[i].x);						// De-interleave 4 x,y,z points
+		Transform4(m, affine, &p.val[0], &p.val[1], &p.val[2]);
+		vst3q_f32(&out[i].x, p);									// Interleave them back out
+	}
+#endif
+	for (; i < count; i++)											// Remaining (or all non NEON) points
+		Transform1(m, affine, in[i].x, in[i].y, in[i].z, &out[i].x, &out[i].y, &out[i].z);
+}
+
+/*--------------------------------------------------------------------------}
+{ Transforms points held as separate x, y, z arrays (structure of arrays)   }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Matrix3D_TransformPointsSoA (const MATRIX3D* m,
+								  const GLfloat* inX, const GLfloat* inY, const GLfloat* inZ,
+								  GLfloat* outX, GLfloat* outY, GLfloat* outZ,
+								  uint32_t count)
+{
+	uint32_t i = 0;
+	bool affine = IsAffine(m);										// Test the bottom row once per batch
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; i + 4 <= count; i += 4) {
+		float32x4_t x = vld1q_f32(&inX[i]);							// Straight loads, nothing to shuffle
+		float32x4_t y = vld1q_f32(&inY[i]);
+		float32x4_t z = vld1q_f32(&inZ[i]);
+		Transform4(m, affine, &x, &y, &z);
+		vst1q_f32(&outX[i], x);
+		vst1q_f32(&outY[i], y);
+		vst1q_f32(&outZ[i], z);
+	}
+#endif
+	for (; i < count; i++)											// Remaining (or all non NEON) points
+		Transform1(m, affine, inX[i], inY[i], inZ[i], &outX[i], &outY[i], &outZ[i]);
+}
+
+/*--------------------------------------------------------------------------}
+{ Normals transform by the inverse transpose of the upper 3x3, that is the  }
+{ cofactor matrix divided by the determinant. When the results are being   }
+{ normalized anyway the 1/det scale is skipped (only its sign is kept).     }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool Matrix3D_TransformNormals (const MATRIX3D* m, const VEC3* in, VEC3* out, uint32_t count, bool normalize)
+{
+	GLfloat c[3][3];
+	for (uint_fast8_t i = 0; i < 3; i++) {							// Cofactors of the upper 3x3
+		uint_fast8_t i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+		for (uint_fast8_t j = 0; j < 3; j++) {
+			uint_fast8_t j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+			c[i][j] = m->coef[i1][j1] * m->coef[i2][j2] - m->coef[i1][j2] * m->coef[i2][j1];
+		}
+	}
+	GLfloat det = m->coef[0][0] * c[0][0] + m->coef[0][1] * c[0][1] + m->coef[0][2] * c[0][2];
+	if (det == GLFLOAT_ZERO) return false;							// Singular nothing sensible to do
+	GLfloat s = normalize ? ((det < GLFLOAT_ZERO) ? -GLFLOAT_ONE : GLFLOAT_ONE) : GLFLOAT_ONE / det;
+	for (uint_fast8_t i = 0; i < 3; i++)
+		for (uint_fast8_t j = 0; j < 3; j++) c[i][j] *= s;
+	uint32_t i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; i + 4 <= count; i += 4) {
+		float32x4x3_t p = vld3q_f32(&in[i].x);						// De-interleave 4 normals
+		float32x4_t nx = vmulq_n_f32(p.val[0], c[0][0]);
+		float32x4_t ny = vmulq_n_f32(p.val[0], c[1][0]);
+		float32x4_t nz = vmulq_n_f32(p.val[0], c[2][0]);
+		nx = vmlaq_n_f32(nx, p.val[1], c[0][1]);
+		ny = vmlaq_n_f32(ny, p.val[1], c[1][1]);
+		nz = vmlaq_n_f32(nz, p.val[1], c[2][1]);
+		nx = vmlaq_n_f32(nx, p.val[2], c[0][2]);
+		ny = vmlaq_n_f32(ny, p.val[2], c[1][2]);
+		nz = vmlaq_n_f32(nz, p.val[2], c[2][2]);
+		if (normalize) {
+			float32x4_t len = vmulq_f32(nx, nx);
+			len = vmlaq_f32(len, ny, ny);
+			len = vmlaq_f32(len, nz, nz);
+			uint32x4_t zero = vceqq_f32(len, vdupq_n_f32(0.0f));
+			len = vbslq_f32(zero, vdupq_n_f32(1.0f), len);			// Zero length stays zero
+			float32x4_t r = vrsqrteq_f32(len);						// Estimate 1/sqrt(len)
+			r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(len, r), r));	// Newton step 1
+			r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(len, r), r));	// Newton step 2
+			nx = vmulq_f32(nx, r);
+			ny = vmulq_f32(ny, r);
+			nz = vmulq_f32(nz, r);
+		}
+		p.val[0] = nx;
+		p.val[1] = ny;
+		p.val[2] = nz;
+		vst3q_f32(&out[i].x, p);
+	}
+#endif
+	for (; i < count; i++) {										// Remaining (or all non NEON) normals
+		VEC3 n = { .x = c[0][0] * in[i].x + c[0][1] * in[i].y + c[0][2] * in[i].z,
+				   .y = c[1][0] * in[i].x + c[1][1] * in[i].y + c[1][2] * in[i].z,
+				   .z = c[2][0] * in[i].x + c[2][1] * in[i].y + c[2][2] * in[i].z };
+		if (normalize) Vec3_Normalize(&n);
+		out[i] = n;
+	}
+	return true;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                        FRUSTUM CULLING ROUTINES                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*--------------------------------------------------------------------------}
+{ With row major M * p the clip planes are the bottom row plus or minus the }
+{ x, y and z rows (Gribb & Hartmann). Each plane is normalized.             }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+void Frustum3D_FromMatrix (FRUSTUM3D* f, const MATRIX3D* m)
+{
+	for (uint_fast8_t p = 0; p < 6; p++) {
+		uint_fast8_t row = p >> 1;									// x,x,y,y,z,z rows
+		GLfloat sign = (p & 1) ? -GLFLOAT_ONE : GLFLOAT_ONE;		// left/bottom/near add, right/top/far subtract
+		for (uint_fast8_t j = 0; j < 4; j++)
+			f->plane[p][j] = m->coef[3][j] + sign * m->coef[row][j];
+		GLfloat len = sqrtf(f->plane[p][0] * f->plane[p][0] + f->plane[p][1] * f->plane[p][1]
+			+ f->plane[p][2] * f->plane[p][2]);
+		if (len > GLFLOAT_ZERO) {
+			len = GLFLOAT_ONE / len;
+			for (uint_fast8_t j = 0; j < 4; j++) f->plane[p][j] *= len;
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ Sphere is culled if it is entirely behind any one plane                   }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool Frustum3D_SphereVisible (const FRUSTUM3D* f, const VEC3* centre, GLfloat radius)
+{
+	for (uint_fast8_t p = 0; p < 6; p++) {
+		GLfloat d = f->plane[p][0] * centre->x + f->plane[p][1] * centre->y
+			+ f->plane[p][2] * centre->z + f->plane[p][3];
+		if (d < -radius) return false;								// Wholly outside this plane
+	}
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ For each plane only the box corner furthest along the plane normal needs  }
+{ testing, if even that corner is behind the plane the box is culled.       }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+bool Frustum3D_BoxVisible (const FRUSTUM3D* f, const VEC3* boxMin, const VEC3* boxMax)
+{
+	for (uint_fast8_t p = 0; p < 6; p++) {
+		GLfloat x = (f->plane[p][0] >= GLFLOAT_ZERO) ? boxMax->x : boxMin->x;
+		GLfloat y = (f->plane[p][1] >= GLFLOAT_ZERO) ? boxMax->y : boxMin->y;
+		GLfloat z = (f->plane[p][2] >= GLFLOAT_ZERO) ? boxMax->z : boxMin->z;
+		if (f->plane[p][0] * x + f->plane[p][1] * y + f->plane[p][2] * z + f->plane[p][3] < GLFLOAT_ZERO)
+			return false;											// Nearest corner outside
+	}
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Batch sphere test, NEON does 4 spheres against each plane at once         }
+{ 19Oct26 LdB                                                               }
+{--------------------------------------------------------------------------*/
+uint32_t Frustum3D_CullSpheres (const FRUSTUM3D* f, const VEC3* centre, const GLfloat* radius,
+								uint8_t* visible, uint32_t count)
+{
+	uint32_t i = 0, total = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	for (; i + 4 <= count; i += 4) {
+		float32x4x3_t c = vld3q_f32(&centre[i].x);					// De-interleave 4 centres
+		float32x4_t nr = vnegq_f32(vld1q_f32(&radius[i]));			// -radius
+		uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+		for (uint_fast8_t p = 0; p < 6; p++) {
+			float32x4_t d = vmlaq_n_f32(vdupq_n_f32(f->plane[p][3]), c.val[0], f->plane[p][0]);
+			d = vmlaq_n_f32(d, c.val[1], f->plane[p][1]);
+			d = vmlaq_n_f32(d, c.val[2], f->plane[p][2]);
+			inside = vandq_u32(inside, vcgeq_f32(d, nr));			// Still inside all planes so far
+		}
+		uint32_t res[4];
+		vst1q_u32(res, inside);
+		for (int k = 0; k < 4; k++) {
+			visible[i + k] = res[k] ? 1 : 0;
+			total += visible[i + k];
+		}
+	}
+#endif
+	for (; i < count; i++) {										// Remaining (or all non NEON) spheres
+		visible[i] = Frustum3D_SphereVisible(f, &centre[i], radius[i]) ? 1 : 0;
+		total += visible[i];
+	}
+	return total;
+}
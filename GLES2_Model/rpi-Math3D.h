@@ -0,0 +1,235 @@
+#ifndef _RPI_MATH3D_
+#define _RPI_MATH3D_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Math3D.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  3D vector and 4x4 matrix routines for the GLES code. Everything is       }
+{  passed by pointer and the point transforms work on whole arrays so the   }
+{  matrix is loaded once per batch. Pi2/Pi3 builds use NEON 4 points at a   }
+{  time, Pi1 and host builds use the plain C loops. Matrices are ROW MAJOR  }
+{  (coef[row][col]) and points are column vectors so M * p, like the       }
+{  original by value helpers these replace.                                 }
+{                                                                           }
+{  The module has no hardware dependencies so it also builds on a host.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/* check if GLfloat is defined */
+#ifndef GLfloat
+#define GLfloat float
+#endif
+
+/* check if GLFLOAT_ZERO is defined if not assign it as (GLfloat)0 */
+#ifndef GLFLOAT_ZERO
+#define GLFLOAT_ZERO ((GLfloat) 0)
+#endif
+
+/* check if GLFLOAT_ONE is defined if not assign it as (GLfloat)1 */
+#ifndef GLFLOAT_ONE
+#define GLFLOAT_ONE ((GLfloat) 1)
+#endif
+
+typedef struct vec3 {
+	GLfloat x;
+	GLfloat y;
+	GLfloat z;
+} VEC3;
+
+typedef union {
+	// Normal C format array which will be ROW MAJOR
+	float coef[4][4];
+	// OPENGL etc want COLUMN MAJOR so define it so we can transpose when needed
+	struct __attribute__((__packed__, aligned(1))) {
+		float m00, m01, m02, m03;
+		float m10, m11, m12, m13;
+		float m20, m21, m22, m23;
+		float m30, m31, m32, m33;
+	} cm;
+} MATRIX3D, *PMATRIX3D;
+
+/* Frustum as 6 planes a*x + b*y + c*z + d >= 0 is inside (left,right,bottom,top,near,far) */
+typedef struct frustum3d {
+	GLfloat plane[6][4];
+} FRUSTUM3D;
+
+/***************************************************************************}
+{                    COMPILE TIME MATRIX INITIALIZERS                       }
+{***************************************************************************/
+
+/* These expand to constant initializers so a matrix with a fixed angle is */
+/* built by the compiler (GCC folds the sine/cosine builtins) e.g.         */
+/*   static const MATRIX3D tilt = MATRIX3D_XROT_INIT(0.78539815f);         */
+#define MATRIX3D_INIT(a00,a01,a02,a03,a10,a11,a12,a13,a20,a21,a22,a23,a30,a31,a32,a33) \
+	{ .coef = { { (a00), (a01), (a02), (a03) }, { (a10), (a11), (a12), (a13) },			\
+				{ (a20), (a21), (a22), (a23) }, { (a30), (a31), (a32), (a33) } } }
+
+#define MATRIX3D_IDENTITY_INIT	MATRIX3D_INIT(1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,	\
+											  0.0f, 0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f)
+
+#define MATRIX3D_XROT_INIT(rad)	MATRIX3D_INIT(1.0f, 0.0f, 0.0f, 0.0f,							\
+							0.0f, __builtin_cosf(rad), -__builtin_sinf(rad), 0.0f,				\
+							0.0f, __builtin_sinf(rad), __builtin_cosf(rad), 0.0f,				\
+							0.0f, 0.0f, 0.0f, 1.0f)
+
+#define MATRIX3D_YROT_INIT(rad)	MATRIX3D_INIT(__builtin_cosf(rad), 0.0f, -__builtin_sinf(rad), 0.0f,	\
+							0.0f, 1.0f, 0.0f, 0.0f,												\
+							__builtin_sinf(rad), 0.0f, __builtin_cosf(rad), 0.0f,				\
+							0.0f, 0.0f, 0.0f, 1.0f)
+
+#define MATRIX3D_ZROT_INIT(rad)	MATRIX3D_INIT(__builtin_cosf(rad), -__builtin_sinf(rad), 0.0f, 0.0f,	\
+							__builtin_sinf(rad), __builtin_cosf(rad), 0.0f, 0.0f,				\
+							0.0f, 0.0f, 1.0f, 0.0f,												\
+							0.0f, 0.0f, 0.0f, 1.0f)
+
+#define MATRIX3D_TRANSLATE_INIT(x, y, z) MATRIX3D_INIT(1.0f, 0.0f, 0.0f, (x),  0.0f, 1.0f, 0.0f, (y),	\
+													   0.0f, 0.0f, 1.0f, (z),  0.0f, 0.0f, 0.0f, 1.0f)
+
+extern const MATRIX3D IdentityMatrix3D;
+
+/***************************************************************************}
+{                       PUBLIC VECTOR ROUTINES                              }
+{***************************************************************************/
+
+/*-[Vec3_Dot]---------------------------------------------------------------}
+. Returns the dot product of the two vectors v1 & v2
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+GLfloat Vec3_Dot (const VEC3* v1, const VEC3* v2);
+
+/*-[Vec3_Cross]-------------------------------------------------------------}
+. Writes the cross product v1 x v2 to result, result may be v1 or v2.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Vec3_Cross (VEC3* result, const VEC3* v1, const VEC3* v2);
+
+/*-[Vec3_Normalize]---------------------------------------------------------}
+. Scales the vector to unit length in place, a zero vector is left as is.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Vec3_Normalize (VEC3* v);
+
+/***************************************************************************}
+{                       PUBLIC MATRIX ROUTINES                              }
+{***************************************************************************/
+
+/*-[Matrix3D_SetRotation]---------------------------------------------------}
+. Sets the matrix to a rotation about the X, Y or Z axis (axis 0,1,2) by
+. the angle in radians. Same signs as the MATRIX3D_xROT_INIT macros.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Matrix3D_SetRotation (MATRIX3D* m, uint_fast8_t axis, GLfloat angle_in_rad);
+
+/*-[Matrix3D_Multiply]------------------------------------------------------}
+. Writes a * b to result. Result may be the same matrix as a or b so
+. Matrix3D_Multiply(&m, &m, &rot) accumulates in place.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Matrix3D_Multiply (MATRIX3D* result, const MATRIX3D* a, const MATRIX3D* b);
+
+/*-[Matrix3D_Transpose]-----------------------------------------------------}
+. Transposes the matrix in place ROW MAJOR <==> COLUMN MAJOR.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Matrix3D_Transpose (MATRIX3D* m);
+
+/*-[Matrix3D_TransformPoints]-----------------------------------------------}
+. Transforms count x,y,z points (array of structures) by the matrix, in and
+. out may be the same array. If the bottom matrix row is not 0,0,0,1 each
+. point is divided by its w like TransformPoint3D did.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Matrix3D_TransformPoints (const MATRIX3D* m,					// Matrix to transform points by
+							   const VEC3* in,						// Input points
+							   VEC3* out,							// Output points (may be in)
+							   uint32_t count);						// Number of points
+
+/*-[Matrix3D_TransformPointsSoA]--------------------------------------------}
+. As Matrix3D_TransformPoints but the points are held as separate x, y and
+. z arrays (structure of arrays) which NEON loads without de-interleaving.
+. Output arrays may be the input arrays.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Matrix3D_TransformPointsSoA (const MATRIX3D* m,				// Matrix to transform points by
+								  const GLfloat* inX, const GLfloat* inY, const GLfloat* inZ, // Input arrays
+								  GLfloat* outX, GLfloat* outY, GLfloat* outZ,	// Output arrays
+								  uint32_t count);					// Number of points
+
+/*-[Matrix3D_TransformNormals]----------------------------------------------}
+. Transforms count normals by the inverse transpose of the upper 3x3 of the
+. matrix so they stay perpendicular under non uniform scale, translation is
+. ignored. With normalize true each result is scaled back to unit length.
+. RETURN: False if the 3x3 is singular (out untouched), True otherwise
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Matrix3D_TransformNormals (const MATRIX3D* m,					// Matrix the points were transformed by
+								const VEC3* in,						// Input normals
+								VEC3* out,							// Output normals (may be in)
+								uint32_t count,						// Number of normals
+								bool normalize);					// Rescale results to unit length
+
+/***************************************************************************}
+{                    PUBLIC FRUSTUM CULLING ROUTINES                        }
+{***************************************************************************/
+
+/*-[Frustum3D_FromMatrix]---------------------------------------------------}
+. Extracts the 6 clip planes of a projection (or view * projection) matrix
+. whose clip volume is -w <= x,y,z <= w. Planes are normalized so the
+. sphere tests below get true distances.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Frustum3D_FromMatrix (FRUSTUM3D* f, const MATRIX3D* m);
+
+/*-[Frustum3D_SphereVisible]------------------------------------------------}
+. RETURN: True if any part of the sphere is inside the frustum
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Frustum3D_SphereVisible (const FRUSTUM3D* f, const VEC3* centre, GLfloat radius);
+
+/*-[Frustum3D_BoxVisible]---------------------------------------------------}
+. Tests an axis aligned box given by its min and max corners, conservative
+. (a box near a frustum corner can report visible).
+. RETURN: True if any part of the box may be inside the frustum
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Frustum3D_BoxVisible (const FRUSTUM3D* f, const VEC3* boxMin, const VEC3* boxMax);
+
+/*-[Frustum3D_CullSpheres]--------------------------------------------------}
+. Tests count spheres and writes 1 (visible) or 0 (culled) per sphere into
+. visible. NEON builds test 4 spheres against each plane at once.
+. RETURN: Number of visible spheres
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Frustum3D_CullSpheres (const FRUSTUM3D* f,					// Frustum planes
+								const VEC3* centre,					// Sphere centres
+								const GLfloat* radius,				// Sphere radii
+								uint8_t* visible,					// Per sphere 1 = visible, 0 = culled
+								uint32_t count);					// Number of spheres
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
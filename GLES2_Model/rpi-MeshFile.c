@@ -0,0 +1,149 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memset
+#include "rpi-MeshFile.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-MeshFile.c											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+#define BLOCK_ALIGN(x)	(((x) + 15) & ~15u)		// Blocks start 16 byte aligned
+
+/*--------------------------------------------------------------------------}
+{ Rounds v to the nearest integer and clamps it to -limit .. limit.         }
+{--------------------------------------------------------------------------*/
+static int32_t Quantise (float v, int32_t limit)
+{
+	int32_t i = (v < 0.0f) ? (int32_t)(v - 0.5f) : (int32_t)(v + 0.5f);
+	if (i > limit) i = limit;
+	if (i < -limit) i = -limit;
+	return i;
+}
+
+static float QuantStep (const MESH_FILE_HEADER* hdr, int axis)
+{
+	return (hdr->max[axis] - hdr->min[axis]) / (2.0f * MESH_QUANT_MAX);
+}
+
+/*-[MeshFile_Build]---------------------------------------------------------}
+. Builds a mesh file in file from vertexCount x,y,z float positions, the
+. triangle indexes and (if normals is not NULL) vertexCount x,y,z normals.
+. With file NULL nothing is written and only the size is worked out.
+. RETURN: Bytes the file takes, 0 if the mesh can't be stored (no vertexes,
+.         over 65536 vertexes, an index past them) or fileMax is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshFile_Build (void* file, uint32_t fileMax,					// Buffer to build in, NULL = size only
+						 const float* positions, uint32_t vertexCount,	// x,y,z a vertex
+						 const uint16_t* indices, uint32_t indexCount,	// Triangle list indexes
+						 const float* normals,							// x,y,z a vertex or NULL
+						 uint32_t sourceFaces)							// Faces before triangulating
+{
+	if ((vertexCount == 0) || (vertexCount > 65536) || (indexCount % 3)) return 0;
+	MESH_FILE_HEADER hdr = { 0 };
+	hdr.magic = MESH_FILE_MAGIC;
+	hdr.version = MESH_FILE_VERSION;
+	hdr.flags = (normals) ? MESH_FLAG_NORMALS : 0;
+	hdr.vertexCount = vertexCount;
+	hdr.indexCount = indexCount;
+	hdr.sourceFaces = sourceFaces;
+	hdr.indexOffset = BLOCK_ALIGN(sizeof(MESH_FILE_HEADER));
+	hdr.positionOffset = hdr.indexOffset + BLOCK_ALIGN(indexCount * sizeof(uint16_t));
+	hdr.fileSize = hdr.positionOffset + BLOCK_ALIGN(vertexCount * 3 * sizeof(int16_t));
+	if (normals) {
+		hdr.normalOffset = hdr.fileSize;
+		hdr.fileSize += vertexCount * 4;						// 4 bytes a normal so stays aligned
+	}
+	for (uint32_t i = 0; i < indexCount; i++) {
+		if (indices[i] >= vertexCount) return 0;				// Index past the vertexes
+		if (indices[i] > hdr.maxIndex) hdr.maxIndex = indices[i];
+	}
+	if (file == 0) return hdr.fileSize;							// Size only
+	if (fileMax < hdr.fileSize) return 0;						// Buffer too small
+
+	for (int a = 0; a < 3; a++) {
+		hdr.min[a] = hdr.max[a] = positions[a];
+		for (uint32_t i = 1; i < vertexCount; i++) {
+			float v = positions[i * 3 + a];
+			if (v < hdr.min[a]) hdr.min[a] = v;
+			if (v > hdr.max[a]) hdr.max[a] = v;
+		}
+	}
+
+	uint8_t* f = (uint8_t*)file;
+	memset(f, 0, hdr.fileSize);									// Padding is zero
+	memcpy(f, &hdr, sizeof(hdr));
+	memcpy(f + hdr.indexOffset, indices, indexCount * sizeof(uint16_t));
+	int16_t* q = (int16_t*)(f + hdr.positionOffset);
+	for (int a = 0; a < 3; a++) {
+		float centre = (hdr.min[a] + hdr.max[a]) * 0.5f;
+		float step = QuantStep(&hdr, a);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			q[i * 3 + a] = (step > 0.0f) ? Quantise((positions[i * 3 + a] - centre) / step, MESH_QUANT_MAX) : 0;
+	}
+	if (normals) {
+		int8_t* n = (int8_t*)(f + hdr.normalOffset);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			for (int a = 0; a < 3; a++)
+				n[i * 4 + a] = Quantise(normals[i * 3 + a] * 127.0f, 127);
+	}
+	return hdr.fileSize;
+}
+
+/*-[MeshFile_CheckHeader]---------------------------------------------------}
+. Checks a header read from a file fileSize bytes long before anything is
+. read into memory on the strength of it.
+. RETURN: True if the header is a version this code reads and every block
+.         lies inside the file
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MeshFile_CheckHeader (const MESH_FILE_HEADER* hdr, uint32_t fileSize)
+{
+	if ((hdr == 0) || (hdr->magic != MESH_FILE_MAGIC) || (hdr->version != MESH_FILE_VERSION)) return false;
+	if ((hdr->fileSize != fileSize) || (hdr->vertexCount == 0) || (hdr->vertexCount > 65536)
+		|| (hdr->indexCount % 3) || (hdr->maxIndex >= hdr->vertexCount)) return false;
+	// Blocks must be where MeshFile_Build puts them, so the sizes all agree
+	uint32_t indexOffset = BLOCK_ALIGN(sizeof(MESH_FILE_HEADER));
+	uint32_t positionOffset = indexOffset + BLOCK_ALIGN(hdr->indexCount * sizeof(uint16_t));
+	uint32_t size = positionOffset + BLOCK_ALIGN(hdr->vertexCount * 3 * sizeof(int16_t));
+	if ((hdr->indexCount > fileSize) || (hdr->indexOffset != indexOffset)
+		|| (hdr->positionOffset != positionOffset)) return false;
+	if (hdr->flags & MESH_FLAG_NORMALS) {
+		if (hdr->normalOffset != size) return false;
+		size += hdr->vertexCount * 4;
+	} else if (hdr->normalOffset != 0) return false;
+	if (hdr->flags & ~MESH_FLAG_NORMALS) return false;			// Flags this version does not know
+	return (size == fileSize);
+}
+
+/*-[MeshFile_Positions]-----------------------------------------------------}
+. Turns the quantised position block q back into floats, centred on the
+. middle of the bounds and multiplied by scale. Each x,y,z goes to dest
+. then dest moves on stride bytes.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MeshFile_Positions (const MESH_FILE_HEADER* hdr, const int16_t* q, float scale, void* dest, uint32_t stride)
+{
+	float m[3];
+	for (int a = 0; a < 3; a++) m[a] = QuantStep(hdr, a) * scale;
+	uint8_t* d = (uint8_t*)dest;
+	for (uint32_t i = 0; i < hdr->vertexCount; i++, q += 3, d += stride) {
+		float v[3] = { q[0] * m[0], q[1] * m[1], q[2] * m[2] };
+		memcpy(d, v, sizeof(v));								// dest need not be aligned
+	}
+}
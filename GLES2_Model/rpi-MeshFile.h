@@ -0,0 +1,104 @@
+#ifndef _RPI_MESHFILE_
+#define _RPI_MESHFILE_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-MeshFile.h											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Binary mesh cache (.msh) so a model loads without parsing OBJ text.      }
+{  The file is laid out as the loader wants it in memory, little endian:    }
+{                                                                           }
+{     MESH_FILE_HEADER     64 bytes                                         }
+{     indexes              uint16_t x indexCount, already triangulated      }
+{     positions            int16_t x,y,z per vertex, quantised on bounds    }
+{     normals (optional)   int8_t x,y,z,0 per vertex, 127 = 1.0             }
+{                                                                           }
+{  Every block starts 16 byte aligned so the index block is read straight   }
+{  into the V3D index array with one sized read.                            }
+{  Position = centre + q * (max - min) / 65534 on each axis, centre being   }
+{  (min + max) / 2, which is under 1/131068 of the size of the model off.   }
+{                                                                           }
+{  The module has no hardware dependencies, Host/MeshConvert.c uses it to  }
+{  make the files from OBJ on Linux.                                        }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define MESH_FILE_MAGIC		0x4853454D			// "MESH" read as a little endian uint32_t
+#define MESH_FILE_VERSION	1					// Format version this code reads and writes
+#define MESH_FLAG_NORMALS	0x0001				// File has the normal block
+
+#define MESH_QUANT_MAX		32767				// Quantised positions are -32767 .. 32767
+
+typedef struct __attribute__((__packed__, aligned(4))) mesh_file_header {
+	uint32_t magic;								// MESH_FILE_MAGIC
+	uint16_t version;							// MESH_FILE_VERSION
+	uint16_t flags;								// MESH_FLAG_xxx
+	uint32_t vertexCount;						// Vertexes (positions and normals)
+	uint32_t indexCount;						// Indexes, 3 a triangle
+	uint32_t maxIndex;							// Largest index used
+	uint32_t indexOffset;						// File offset of the index block
+	uint32_t positionOffset;					// File offset of the position block
+	uint32_t normalOffset;						// File offset of the normal block (0 if none)
+	uint32_t fileSize;							// Bytes in the whole file
+	uint32_t sourceFaces;						// Faces the source mesh had before triangulating
+	float    min[3];							// Bounds of the source positions x,y,z
+	float    max[3];
+} MESH_FILE_HEADER;
+
+/*-[MeshFile_Build]---------------------------------------------------------}
+. Builds a mesh file in file from vertexCount x,y,z float positions, the
+. triangle indexes and (if normals is not NULL) vertexCount x,y,z normals.
+. With file NULL nothing is written and only the size is worked out.
+. RETURN: Bytes the file takes, 0 if the mesh can't be stored (no vertexes,
+.         over 65536 vertexes, an index past them) or fileMax is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t MeshFile_Build (void* file, uint32_t fileMax,					// Buffer to build in, NULL = size only
+						 const float* positions, uint32_t vertexCount,	// x,y,z a vertex
+						 const uint16_t* indices, uint32_t indexCount,	// Triangle list indexes
+						 const float* normals,							// x,y,z a vertex or NULL
+						 uint32_t sourceFaces);							// Faces before triangulating
+
+/*-[MeshFile_CheckHeader]---------------------------------------------------}
+. Checks a header read from a file fileSize bytes long before anything is
+. read into memory on the strength of it.
+. RETURN: True if the header is a version this code reads and every block
+.         lies inside the file
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MeshFile_CheckHeader (const MESH_FILE_HEADER* hdr, uint32_t fileSize);
+
+/*-[MeshFile_Positions]-----------------------------------------------------}
+. Turns the quantised position block q back into floats, centred on the
+. middle of the bounds and multiplied by scale. Each x,y,z goes to dest
+. then dest moves on stride bytes.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MeshFile_Positions (const MESH_FILE_HEADER* hdr, const int16_t* q, float scale, void* dest, uint32_t stride);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,268 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-QPUKernels.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-QPUKernels.c											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+/* Register use common to the kernels                                       */
+/*   ra0  QPU number, the VPM row     ra2  VDW setup for the row            */
+/*   ra4  VPM write setup for the row r1   blocks left                      */
+/*   r2   64, the bytes of a block    ra1  dst   ra3  src (+ element * 4)   */
+/* VPM write setup 0x1a00 | row is horizontal 32 bit with stride 1 and the  */
+/* VDW setup 0x80904000 | row << 7 stores 1 row of 16 words. Reading        */
+/* vw_wait holds the QPU until the store is done so the row can be reused. */
+/* The kernels end with a host interrupt for V3D_execute_qpu.               */
+
+static const uint32_t memsetCode[] = {
+#include "Shaders/Memset.h"
+};
+
+static const uint32_t memcpyCode[] = {
+#include "Shaders/Memcpy.h"
+};
+
+/* The x and y TMU reads are both queued before the first result is taken */
+static const uint32_t saxpyCode[] = {
+#include "Shaders/Saxpy.h"
+};
+
+/* Each row of 3 taps is 3 TMU reads in flight, the next row's address is  */
+/* worked out under the first load. r0 sums what the last fmul left in r3. */
+static const uint32_t conv3x3Code[] = {
+#include "Shaders/Conv3x3.h"
+};
+
+/* mul24 takes the 8 bit channels times the coefficients, the negative U,V */
+/* terms are subtracted and asr keeps the rounding a floor as the ARM's.   */
+static const uint32_t rgbToYuvCode[] = {
+#include "Shaders/RgbToYuv.h"
+};
+
+const QPU_KERNEL QPU_KernelMemset = { "memset", memsetCode, sizeof(memsetCode) / sizeof(uint32_t), 3 };
+const QPU_KERNEL QPU_KernelMemcpy = { "memcpy", memcpyCode, sizeof(memcpyCode) / sizeof(uint32_t), 3 };
+const QPU_KERNEL QPU_KernelSaxpy = { "saxpy", saxpyCode, sizeof(saxpyCode) / sizeof(uint32_t), 4 };
+const QPU_KERNEL QPU_KernelConv3x3 = { "conv3x3", conv3x3Code, sizeof(conv3x3Code) / sizeof(uint32_t), 15 };
+const QPU_KERNEL QPU_KernelRgbToYuv = { "rgb2yuv", rgbToYuvCode, sizeof(rgbToYuvCode) / sizeof(uint32_t), 3 };
+
+#define BLOCK_BYTES		(QPU_BLOCK_WORDS * 4)	// Bytes of a block
+
+typedef union {
+	float f;
+	uint32_t u;
+} FLOAT_BITS;
+
+/*--------------------------------------------------------------------------}
+{ QPUs to use for total pieces of work, every QPU gets at least one.       }
+{--------------------------------------------------------------------------*/
+static uint32_t SplitQpus (uint32_t qpus, uint32_t total)
+{
+	if (qpus > QPU_MAX) qpus = QPU_MAX;
+	if (qpus > total) qpus = total;
+	return qpus;
+}
+
+/*--------------------------------------------------------------------------}
+{ QPU i's share of total pieces over qpus and the first piece of it, the   }
+{ spare pieces go one each to the first QPUs.                              }
+{--------------------------------------------------------------------------*/
+static uint32_t SplitShare (uint32_t total, uint32_t qpus, uint32_t i, uint32_t* first)
+{
+	uint32_t share = total / qpus, spare = total % qpus;
+	*first = i * share + ((i < spare) ? i : spare);
+	return share + ((i < spare) ? 1 : 0);
+}
+
+/*-[QPU_MemsetUniforms]-----------------------------------------------------}
+. Writes the streams for QPU_KernelMemset, fill words at dstVC4 with value.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_MemsetUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t value, uint32_t words)
+{
+	if ((!unif) || (words % QPU_BLOCK_WORDS)) return 0;
+	uint32_t blocks = words / QPU_BLOCK_WORDS;
+	qpus = SplitQpus(qpus, blocks);
+	for (uint32_t i = 0; i < qpus; i++) {
+		uint32_t first, count = SplitShare(blocks, qpus, i, &first);
+		*unif++ = dstVC4 + first * BLOCK_BYTES;
+		*unif++ = count;
+		*unif++ = value;
+	}
+	return qpus;
+}
+
+/*-[QPU_MemcpyUniforms]-----------------------------------------------------}
+. Writes the streams for QPU_KernelMemcpy, copy words from srcVC4 to dstVC4.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_MemcpyUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t srcVC4, uint32_t words)
+{
+	if ((!unif) || (words % QPU_BLOCK_WORDS)) return 0;
+	uint32_t blocks = words / QPU_BLOCK_WORDS;
+	qpus = SplitQpus(qpus, blocks);
+	for (uint32_t i = 0; i < qpus; i++) {
+		uint32_t first, count = SplitShare(blocks, qpus, i, &first);
+		*unif++ = dstVC4 + first * BLOCK_BYTES;
+		*unif++ = srcVC4 + first * BLOCK_BYTES;
+		*unif++ = count;
+	}
+	return qpus;
+}
+
+/*-[QPU_SaxpyUniforms]------------------------------------------------------}
+. Writes the streams for QPU_KernelSaxpy, y = a * x + y over count floats.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_SaxpyUniforms (uint32_t* unif, uint32_t qpus, uint32_t yVC4, uint32_t xVC4, float a, uint32_t count)
+{
+	if ((!unif) || (count % QPU_BLOCK_WORDS)) return 0;
+	uint32_t blocks = count / QPU_BLOCK_WORDS;
+	FLOAT_BITS fa = { .f = a };
+	qpus = SplitQpus(qpus, blocks);
+	for (uint32_t i = 0; i < qpus; i++) {
+		uint32_t first, share = SplitShare(blocks, qpus, i, &first);
+		*unif++ = yVC4 + first * BLOCK_BYTES;
+		*unif++ = xVC4 + first * BLOCK_BYTES;
+		*unif++ = fa.u;
+		*unif++ = share;
+	}
+	return qpus;
+}
+
+/*-[QPU_Conv3x3Uniforms]----------------------------------------------------}
+. Writes the streams for QPU_KernelConv3x3, whole rows to each QPU.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_Conv3x3Uniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t dstPitch,
+	uint32_t srcVC4, uint32_t srcPitch, uint32_t width, uint32_t height, const float w[9])
+{
+	if ((!unif) || (!w) || (width % QPU_BLOCK_WORDS) || (dstPitch < width) || (srcPitch < width + 2)) return 0;
+	qpus = SplitQpus(qpus, height);
+	for (uint32_t i = 0; i < qpus; i++) {
+		uint32_t first, rows = SplitShare(height, qpus, i, &first);
+		*unif++ = dstVC4 + first * dstPitch * 4;
+		*unif++ = dstPitch * 4;
+		*unif++ = srcVC4 + first * srcPitch * 4;
+		*unif++ = srcPitch * 4;
+		*unif++ = width / QPU_BLOCK_WORDS;
+		*unif++ = rows;
+		for (int j = 0; j < 9; j++) {
+			FLOAT_BITS fw = { .f = w[j] };
+			*unif++ = fw.u;
+		}
+	}
+	return qpus;
+}
+
+/*-[QPU_RgbToYuvUniforms]---------------------------------------------------}
+. Writes the streams for QPU_KernelRgbToYuv, pixels from srcVC4 to dstVC4.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_RgbToYuvUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t srcVC4, uint32_t pixels)
+{
+	return QPU_MemcpyUniforms(unif, qpus, dstVC4, srcVC4, pixels);	// Same stream as a copy
+}
+
+/*-[QPU_RefSaxpy]-----------------------------------------------------------}
+. ARM reference of QPU_KernelSaxpy.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefSaxpy (float* y, const float* x, float a, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++) {
+		float ax = a * x[i];										// fmul then fadd, never fused
+		y[i] = ax + y[i];
+	}
+}
+
+/*-[QPU_RefConv3x3]---------------------------------------------------------}
+. ARM reference of QPU_KernelConv3x3.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefConv3x3 (float* dst, uint32_t dstPitch, const float* src, uint32_t srcPitch,
+	uint32_t width, uint32_t height, const float w[9])
+{
+	for (uint32_t y = 0; y < height; y++, dst += dstPitch, src += srcPitch)
+		for (uint32_t x = 0; x < width; x++) {
+			float sum = 0.0f;
+			for (int j = 0; j < 3; j++)
+				for (int i = 0; i < 3; i++) {
+					float p = src[j * srcPitch + x + i] * w[j * 3 + i];
+					sum = sum + p;
+				}
+			dst[x] = sum;
+		}
+}
+
+/*--------------------------------------------------------------------------}
+{ Y | U<<8 | V<<16 | A<<24 of one R | G<<8 | B<<16 | A<<24 pixel.          }
+{--------------------------------------------------------------------------*/
+static uint32_t PixelToYuv (uint32_t p)
+{
+	int32_t r = p & 0xFF, g = (p >> 8) & 0xFF, b = (p >> 16) & 0xFF;
+	int32_t y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;		// Never negative
+	int32_t u = 112 * b - 38 * r - 74 * g + 128;
+	int32_t v = 112 * r - 94 * g - 18 * b + 128;
+	u = ((u < 0) ? -((-u + 255) >> 8) : (u >> 8)) + 128;			// Floor as the QPU asr does
+	v = ((v < 0) ? -((-v + 255) >> 8) : (v >> 8)) + 128;
+	return (uint32_t)y | ((uint32_t)u << 8) | ((uint32_t)v << 16) | (p & 0xFF000000);
+}
+
+/*-[QPU_RefRgbToYuv]--------------------------------------------------------}
+. ARM reference of QPU_KernelRgbToYuv.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefRgbToYuv (uint32_t* dst, const uint32_t* src, uint32_t pixels)
+{
+	for (uint32_t i = 0; i < pixels; i++)
+		dst[i] = PixelToYuv(src[i]);
+}
+
+/*-[QPU_KernelModel]--------------------------------------------------------}
+. Runs one QPU's uniform stream for kernel k in C.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool QPU_KernelModel (const QPU_KERNEL* k, const uint32_t* unif, void* (*vc4ToPtr) (uint32_t vc4Addr))
+{
+	if ((!k) || (!unif) || (!vc4ToPtr)) return false;
+	if (k == &QPU_KernelMemset) {
+		uint32_t* dst = vc4ToPtr(unif[0]);
+		for (uint32_t i = 0; i < unif[1] * QPU_BLOCK_WORDS; i++)
+			dst[i] = unif[2];
+	} else if (k == &QPU_KernelMemcpy) {
+		uint32_t* dst = vc4ToPtr(unif[0]);
+		const uint32_t* src = vc4ToPtr(unif[1]);
+		for (uint32_t i = 0; i < unif[2] * QPU_BLOCK_WORDS; i++)
+			dst[i] = src[i];
+	} else if (k == &QPU_KernelSaxpy) {
+		FLOAT_BITS a = { .u = unif[2] };
+		QPU_RefSaxpy(vc4ToPtr(unif[0]), vc4ToPtr(unif[1]), a.f, unif[3] * QPU_BLOCK_WORDS);
+	} else if (k == &QPU_KernelConv3x3) {
+		float w[9];
+		for (int j = 0; j < 9; j++) {
+			FLOAT_BITS fw = { .u = unif[6 + j] };
+			w[j] = fw.f;
+		}
+		QPU_RefConv3x3(vc4ToPtr(unif[0]), unif[1] / 4, vc4ToPtr(unif[2]), unif[3] / 4,
+			unif[4] * QPU_BLOCK_WORDS, unif[5], w);
+	} else if (k == &QPU_KernelRgbToYuv) {
+		QPU_RefRgbToYuv(vc4ToPtr(unif[0]), vc4ToPtr(unif[1]), unif[2] * QPU_BLOCK_WORDS);
+	} else return false;
+	return true;
+}
@@ -0,0 +1,149 @@
+#ifndef _RPI_QPUKERNELS_
+#define _RPI_QPUKERNELS_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-QPUKernels.h											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  A small library of QPU user program kernels for V3D_ComputeLaunch and    }
+{  V3D_ComputeExecute (rpi-GLES.h) with the ARM reference of each.         }
+{                                                                           }
+{  Every kernel works in blocks of 16 words, one per QPU element. Each      }
+{  element reads its word with a TMU direct memory lookup, the 16 results  }
+{  go to the QPU's own VPM row (its QPU number, so launches in flight at   }
+{  once never share a row) and one VDW DMA writes the row out. Addresses   }
+{  and pitches must be 4 byte aligned and sizes whole blocks.               }
+{                                                                           }
+{  A launch gives each QPU its own uniform stream, the xxxUniforms calls   }
+{  split the blocks between the QPUs and write the streams one after      }
+{  another. QPU_KernelModel runs a stream in C block for block as the     }
+{  kernel does, so the split and the reference can be checked on a host.   }
+{                                                                           }
+{  The module has no hardware dependencies so it also builds on a host.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define QPU_MAX					12				// QPUs a launch can use (3 slices of 4)
+#define QPU_BLOCK_WORDS			16				// Words a kernel moves per block, one per element
+
+/* A QPU kernel, the instructions are 64 bit as low word then high word */
+typedef struct qpu_kernel {
+	const char* name;							// Kernel name
+	const uint32_t* code;						// Instruction words
+	uint32_t codeWords;							// Count of instruction words (2 per instruction)
+	uint32_t uniforms;							// Uniforms in each QPU's stream
+} QPU_KERNEL;
+
+/* Uniform streams (VC4 addresses, pitches in bytes, counts in blocks)      */
+/* Memset:   dst, blocks, value                                             */
+/* Memcpy:   dst, src, blocks                                               */
+/* Saxpy:    y, x, a (float), blocks              y = a * x + y             */
+/* Conv3x3:  dst, dstPitch, src, srcPitch, blocks across, rows, w0..w8      */
+/* RgbToYuv: dst, src, blocks                                               */
+extern const QPU_KERNEL QPU_KernelMemset;
+extern const QPU_KERNEL QPU_KernelMemcpy;
+extern const QPU_KERNEL QPU_KernelSaxpy;
+extern const QPU_KERNEL QPU_KernelConv3x3;
+extern const QPU_KERNEL QPU_KernelRgbToYuv;
+
+/*-[QPU_MemsetUniforms]-----------------------------------------------------}
+. Writes the streams for QPU_KernelMemset to fill words (whole blocks) at
+. dstVC4 with value, split over up to qpus QPUs.
+. RETURN: QPUs the streams are for (launch that many), 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_MemsetUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t value, uint32_t words);
+
+/*-[QPU_MemcpyUniforms]-----------------------------------------------------}
+. Writes the streams for QPU_KernelMemcpy to copy words (whole blocks) from
+. srcVC4 to dstVC4, split over up to qpus QPUs. The areas may not overlap.
+. RETURN: QPUs the streams are for (launch that many), 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_MemcpyUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t srcVC4, uint32_t words);
+
+/*-[QPU_SaxpyUniforms]------------------------------------------------------}
+. Writes the streams for QPU_KernelSaxpy, y = a * x + y over count floats
+. (whole blocks) at yVC4 and xVC4, split over up to qpus QPUs.
+. RETURN: QPUs the streams are for (launch that many), 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_SaxpyUniforms (uint32_t* unif, uint32_t qpus, uint32_t yVC4, uint32_t xVC4, float a, uint32_t count);
+
+/*-[QPU_Conv3x3Uniforms]----------------------------------------------------}
+. Writes the streams for QPU_KernelConv3x3, the width x height float image
+. at dstVC4 from the (width+2) x (height+2) image at srcVC4 through the 3x3
+. weights w (row by row), the rows split over up to qpus QPUs. Pitches are
+. floats row to row and width is whole blocks.
+. RETURN: QPUs the streams are for (launch that many), 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_Conv3x3Uniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t dstPitch,
+	uint32_t srcVC4, uint32_t srcPitch, uint32_t width, uint32_t height, const float w[9]);
+
+/*-[QPU_RgbToYuvUniforms]---------------------------------------------------}
+. Writes the streams for QPU_KernelRgbToYuv to convert pixels (whole blocks)
+. of R | G<<8 | B<<16 | A<<24 at srcVC4 to Y | U<<8 | V<<16 | A<<24 at
+. dstVC4, split over up to qpus QPUs.
+. RETURN: QPUs the streams are for (launch that many), 0 for bad arguments
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t QPU_RgbToYuvUniforms (uint32_t* unif, uint32_t qpus, uint32_t dstVC4, uint32_t srcVC4, uint32_t pixels);
+
+/*-[QPU_RefSaxpy]-----------------------------------------------------------}
+. ARM reference of QPU_KernelSaxpy, y = a * x + y as a multiply then an add.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefSaxpy (float* y, const float* x, float a, uint32_t count);
+
+/*-[QPU_RefConv3x3]---------------------------------------------------------}
+. ARM reference of QPU_KernelConv3x3 (pitches in floats), the 9 products
+. are summed row by row in the order the kernel adds them.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefConv3x3 (float* dst, uint32_t dstPitch, const float* src, uint32_t srcPitch,
+	uint32_t width, uint32_t height, const float w[9]);
+
+/*-[QPU_RefRgbToYuv]--------------------------------------------------------}
+. ARM reference of QPU_KernelRgbToYuv, BT.601 video range in integer maths:
+. Y = ((66R + 129G + 25B + 128) >> 8) + 16, U = ((-38R - 74G + 112B + 128)
+. >> 8) + 128 and V = ((112R - 94G - 18B + 128) >> 8) + 128, alpha kept.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void QPU_RefRgbToYuv (uint32_t* dst, const uint32_t* src, uint32_t pixels);
+
+/*-[QPU_KernelModel]--------------------------------------------------------}
+. Runs one QPU's uniform stream for kernel k in C, block by block as the
+. kernel reads and writes them. vc4ToPtr maps the VC4 addresses in the
+. stream to memory.
+. RETURN: True the stream ran, False not a library kernel
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool QPU_KernelModel (const QPU_KERNEL* k, const uint32_t* unif, void* (*vc4ToPtr) (uint32_t vc4Addr));
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
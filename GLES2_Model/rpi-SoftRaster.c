@@ -0,0 +1,401 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memcpy
+#include "rpi-V3DList.h"						// Needed to walk binning lists
+#include "rpi-SoftRaster.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-SoftRaster.c											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+/*--------------------------------------------------------------------------}
+{  Pixel px,py is drawn when its centre (px*16+8, py*16+8 in 12.4) is in   }
+{  the triangle. A centre exactly on an edge belongs to only one of the two }
+{  triangles sharing that edge (edges going down, or flat going right).    }
+{--------------------------------------------------------------------------*/
+#define PIXEL_CENTRE	8						// Half a pixel in 12.4
+
+/*--------------------------------------------------------------------------}
+{ Edge function of a->b at p, positive on the inside of a triangle wound   }
+{ the way SoftRaster draws them (every triangle is turned that way).       }
+{--------------------------------------------------------------------------*/
+static int64_t Edge (const SOFT_VERTEX* a, const SOFT_VERTEX* b, int32_t px, int32_t py)
+{
+	return (int64_t)((int32_t)b->x - (int32_t)a->x) * (py - (int32_t)a->y)
+		- (int64_t)((int32_t)b->y - (int32_t)a->y) * (px - (int32_t)a->x);
+}
+
+static void GetTriangle (const SOFT_SCENE* scene, uint32_t tri, SOFT_VERTEX v[3])
+{
+	for (int i = 0; i < 3; i++)
+		memcpy(&v[i], scene->vertices + scene->indices[tri * 3 + i] * scene->stride, sizeof(SOFT_VERTEX));
+}
+
+/*--------------------------------------------------------------------------}
+{ Returns the pixel bounds of triangle tri clipped to the screen, false if  }
+{ it has a bad index, no area or covers no pixel centre on screen.          }
+{--------------------------------------------------------------------------*/
+static bool TriangleBounds (const SOFT_SCENE* scene, uint32_t tri, int32_t* minX, int32_t* minY, int32_t* maxX, int32_t* maxY)
+{
+	SOFT_VERTEX v[3];
+	for (int i = 0; i < 3; i++)
+		if (scene->indices[tri * 3 + i] >= scene->vertexCount) return false;	// Index past the vertexes
+	GetTriangle(scene, tri, v);
+	if (Edge(&v[0], &v[1], v[2].x, v[2].y) == 0) return false;	// No area
+	int32_t lx = v[0].x, hx = v[0].x, ly = v[0].y, hy = v[0].y;
+	for (int i = 1; i < 3; i++) {
+		if (v[i].x < lx) lx = v[i].x;
+		if (v[i].x > hx) hx = v[i].x;
+		if (v[i].y < ly) ly = v[i].y;
+		if (v[i].y > hy) hy = v[i].y;
+	}
+	*minX = (lx - PIXEL_CENTRE + 15) >> 4;						// First pixel centre at or right of lx
+	*minY = (ly - PIXEL_CENTRE + 15) >> 4;
+	*maxX = (hx - PIXEL_CENTRE) >> 4;							// Last pixel centre at or left of hx
+	*maxY = (hy - PIXEL_CENTRE) >> 4;
+	if (*minX < 0) *minX = 0;
+	if (*minY < 0) *minY = 0;
+	if (*maxX >= (int32_t)scene->width) *maxX = scene->width - 1;
+	if (*maxY >= (int32_t)scene->height) *maxY = scene->height - 1;
+	return (*minX <= *maxX && *minY <= *maxY);
+}
+
+/*--------------------------------------------------------------------------}
+{ Depth function of CONFIG_STATE, true if the fragment z passes against    }
+{ the depth d held for its pixel.                                           }
+{--------------------------------------------------------------------------*/
+static bool DepthPass (uint8_t func, float z, float d)
+{
+	switch (func) {
+	case 0: return false;										// Never
+	case 1: return (z < d);										// Less
+	case 2: return (z == d);									// Equal
+	case 3: return (z <= d);									// Less or equal
+	case 4: return (z > d);										// Greater
+	case 5: return (z != d);									// Not equal
+	case 6: return (z >= d);									// Greater or equal
+	default: return true;										// Always
+	}
+}
+
+static uint32_t PackColour (float red, float green, float blue)
+{
+	float c[3] = { red, green, blue };
+	uint32_t colour = 0xFF000000;								// Fragment shader writes alpha 1.0
+	for (int i = 0; i < 3; i++) {
+		uint32_t b;
+		if (c[i] <= 0.0f) b = 0;
+			else if (c[i] >= 1.0f) b = 255;
+			else b = (uint32_t)(c[i] * 255.0f + 0.5f);
+		colour |= b << (i * 8);									// Red low byte as tlbc gets it
+	}
+	return colour;
+}
+
+/*--------------------------------------------------------------------------}
+{ Draws triangle tri where it covers pixels x0..x1-1, y0..y1-1 of target,  }
+{ x0,y0 being the top left of the tile the target depth tile holds.        }
+{--------------------------------------------------------------------------*/
+static void DrawTriangle (const SOFT_SCENE* scene, const SOFT_TARGET* target, uint32_t tri,
+						  int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+	SOFT_VERTEX v[3];
+	int32_t minX, minY, maxX, maxY;
+	if (!TriangleBounds(scene, tri, &minX, &minY, &maxX, &maxY)) return;
+	if (minX < x0) minX = x0;
+	if (minY < y0) minY = y0;
+	if (maxX >= x1) maxX = x1 - 1;
+	if (maxY >= y1) maxY = y1 - 1;
+	if (minX > maxX || minY > maxY) return;						// Bounds miss this tile
+
+	GetTriangle(scene, tri, v);
+	int64_t area = Edge(&v[0], &v[1], v[2].x, v[2].y);
+	if (area < 0) {												// Back face, turn it round
+		SOFT_VERTEX t = v[1];
+		v[1] = v[2];
+		v[2] = t;
+		area = -area;
+	}
+
+	// Edge e is opposite vertex e so its value over area is that vertex's weight
+	const SOFT_VERTEX* ea[3] = { &v[1], &v[2], &v[0] };
+	const SOFT_VERTEX* eb[3] = { &v[2], &v[0], &v[1] };
+	int64_t rowE[3], stepX[3], stepY[3], bias[3];
+	int32_t px = minX * 16 + PIXEL_CENTRE, py = minY * 16 + PIXEL_CENTRE;
+	for (int e = 0; e < 3; e++) {
+		int32_t dx = (int32_t)eb[e]->x - (int32_t)ea[e]->x;
+		int32_t dy = (int32_t)eb[e]->y - (int32_t)ea[e]->y;
+		rowE[e] = Edge(ea[e], eb[e], px, py);
+		stepX[e] = -(int64_t)dy * 16;
+		stepY[e] = (int64_t)dx * 16;
+		bias[e] = (dy > 0 || (dy == 0 && dx > 0)) ? 0 : -1;	// Which side owns a centre on the edge
+	}
+
+	// Varyings are interpolated on 1/W (perspective correct) as the V3D does,
+	// all 1/W zero (the model loaders' orthographic vertexes) is taken as 1.0
+	float invArea = 1.0f / (float)area;
+	float w[3], r[3], g[3], b[3], z[3];
+	bool affine = (v[0].w == 0.0f) && (v[1].w == 0.0f) && (v[2].w == 0.0f);
+	for (int i = 0; i < 3; i++) {
+		if (affine) v[i].w = 1.0f;
+		w[i] = v[i].w;
+		z[i] = v[i].z;
+		r[i] = v[i].red * v[i].w;
+		g[i] = v[i].green * v[i].w;
+		b[i] = v[i].blue * v[i].w;
+	}
+
+	uint32_t* row = target->pixels + (uint32_t)minY * target->pitch;
+	float* depthRow = (scene->depthTest) ? target->depth + (minY - y0) * SOFT_TILE_SIZE : 0;
+	for (int32_t y = minY; y <= maxY; y++) {
+		int64_t e0 = rowE[0], e1 = rowE[1], e2 = rowE[2];
+		for (int32_t x = minX; x <= maxX; x++) {
+			if ((e0 + bias[0]) >= 0 && (e1 + bias[1]) >= 0 && (e2 + bias[2]) >= 0) {
+				float l0 = (float)e0 * invArea, l1 = (float)e1 * invArea, l2 = (float)e2 * invArea;
+				bool pass = true;
+				if (depthRow) {										// Z is linear in screen space
+					float pz = l0 * z[0] + l1 * z[1] + l2 * z[2];
+					if (pz < 0.0f) pz = 0.0f;
+					if (pz > 1.0f) pz = 1.0f;
+					pass = DepthPass(scene->depthFunc, pz, depthRow[x - x0]);
+					if (pass && scene->depthWrite) depthRow[x - x0] = pz;
+				}
+				if (pass) {
+					float pw = l0 * w[0] + l1 * w[1] + l2 * w[2];
+					float ipw = (pw != 0.0f) ? 1.0f / pw : 0.0f;
+					row[x] = PackColour((l0 * r[0] + l1 * r[1] + l2 * r[2]) * ipw,
+						(l0 * g[0] + l1 * g[1] + l2 * g[2]) * ipw,
+						(l0 * b[0] + l1 * b[1] + l2 * b[2]) * ipw);
+				}
+			}
+			e0 += stepX[0];
+			e1 += stepX[1];
+			e2 += stepX[2];
+		}
+		rowE[0] += stepY[0];
+		rowE[1] += stepY[1];
+		rowE[2] += stepY[2];
+		row += target->pitch;
+		if (depthRow) depthRow += SOFT_TILE_SIZE;
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{ Sets the scene fields every setup shares, the caller sets the ranges,    }
+{ index count and depth test.                                               }
+{--------------------------------------------------------------------------*/
+static bool InitScene (SOFT_SCENE* scene, const void* vertices, uint32_t stride, uint32_t vertexCount,
+					   const uint16_t* indices, uint32_t width, uint32_t height,
+					   uint32_t clearColour, uint32_t* bins, uint32_t binSize)
+{
+	scene->binUsed = scene->triangles = 0;
+	scene->binWth = scene->binHt = 0;
+	if (!vertices || !indices || stride < sizeof(SOFT_VERTEX) || width == 0 || height == 0) return false;
+	uint32_t binWth = (width + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+	uint32_t binHt = (height + SOFT_TILE_SIZE - 1) / SOFT_TILE_SIZE;
+	if (binWth * binHt > SOFT_MAX_TILES) return false;			// Screen too big
+	scene->vertices = (const uint8_t*)vertices;
+	scene->stride = stride;
+	scene->vertexCount = vertexCount;
+	scene->indices = indices;
+	scene->width = width;
+	scene->height = height;
+	scene->binWth = binWth;
+	scene->binHt = binHt;
+	scene->clearColour = clearColour;
+	scene->bins = bins;
+	scene->binSize = binSize;
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{ Bins the triangles of the scene ranges into the tile lists.               }
+{--------------------------------------------------------------------------*/
+static bool BinScene (SOFT_SCENE* scene)
+{
+	// Pass 1 counts the triangles of each tile into tileFirst[t+1]
+	uint32_t tiles = scene->binWth * scene->binHt;
+	memset(scene->tileFirst, 0, (tiles + 1) * sizeof(uint32_t));
+	for (uint32_t r = 0; r < scene->rangeCount; r++) {
+		uint32_t end = scene->range[r].firstTri + scene->range[r].triCount;
+		for (uint32_t tri = scene->range[r].firstTri; tri < end; tri++) {
+			int32_t minX, minY, maxX, maxY;
+			if (!TriangleBounds(scene, tri, &minX, &minY, &maxX, &maxY)) continue;
+			scene->triangles++;
+			for (int32_t ty = minY / SOFT_TILE_SIZE; ty <= maxY / SOFT_TILE_SIZE; ty++)
+				for (int32_t tx = minX / SOFT_TILE_SIZE; tx <= maxX / SOFT_TILE_SIZE; tx++)
+					scene->tileFirst[ty * scene->binWth + tx + 1]++;
+		}
+	}
+	for (uint32_t t = 1; t <= tiles; t++)						// Counts to start positions
+		scene->tileFirst[t] += scene->tileFirst[t - 1];
+	scene->binUsed = scene->tileFirst[tiles];
+	if (scene->binUsed > scene->binSize || (scene->binUsed && !scene->bins)) return false;
+
+	// Pass 2 fills the lists in triangle order moving each tile's start to its end
+	for (uint32_t r = 0; r < scene->rangeCount; r++) {
+		uint32_t end = scene->range[r].firstTri + scene->range[r].triCount;
+		for (uint32_t tri = scene->range[r].firstTri; tri < end; tri++) {
+			int32_t minX, minY, maxX, maxY;
+			if (!TriangleBounds(scene, tri, &minX, &minY, &maxX, &maxY)) continue;
+			for (int32_t ty = minY / SOFT_TILE_SIZE; ty <= maxY / SOFT_TILE_SIZE; ty++)
+				for (int32_t tx = minX / SOFT_TILE_SIZE; tx <= maxX / SOFT_TILE_SIZE; tx++)
+					scene->bins[scene->tileFirst[ty * scene->binWth + tx]++] = tri;
+		}
+	}
+	for (uint32_t t = tiles - 1; t > 0; t--)					// Ends back to starts
+		scene->tileFirst[t] = scene->tileFirst[t - 1];
+	scene->tileFirst[0] = 0;
+	return true;
+}
+
+/*-[SoftRaster_Setup]-------------------------------------------------------}
+. Bins the indexCount/3 triangles of indices into the tiles of a width x
+. height screen with no depth test. bins is binSize entries of work memory
+. holding the tile lists, needing one entry per triangle per tile it touches.
+. RETURN: true if the scene is ready, false if a parameter is bad or bins is
+.         too small (scene->binUsed is then the entries needed)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SoftRaster_Setup (SOFT_SCENE* scene,							// Scene to set up
+					   const void* vertices, uint32_t stride,		// SOFT_VERTEX layout, stride apart
+					   uint32_t vertexCount,						// Vertexes available
+					   const uint16_t* indices, uint32_t indexCount,// Triangle list indexes
+					   uint32_t width, uint32_t height,				// Screen (clip window) size
+					   uint32_t clearColour,						// Tile clear colour
+					   uint32_t* bins, uint32_t binSize)			// Tile list work memory
+{
+	if (!scene || !InitScene(scene, vertices, stride, vertexCount, indices, width, height,
+		clearColour, bins, binSize)) return false;
+	scene->indexCount = indexCount;
+	scene->range[0] = (SOFT_RANGE) { 0, indexCount / 3 };		// One range of the lot
+	scene->rangeCount = 1;
+	scene->depthTest = scene->depthWrite = false;
+	scene->depthFunc = 7;										// Always
+	return BinScene(scene);
+}
+
+/*-[SoftRaster_SetupFromList]-----------------------------------------------}
+. Sets the scene up from an NV shader state binning control list as the V3D
+. would read it. The clip window gives the screen size, the config state the
+. depth test, the NV shader record the vertexes and stride, the indexed
+. primitive lists the indexes. Every VC4 address in the list or record is
+. turned into a pointer by vc4ToARM. The lists must all index one array in
+. whole triangles (as rpi-Cull runs do) and be in address order.
+. RETURN: false if the list is not one this rasteriser can draw (coordinate
+.         shaders, not 16 bit triangles, lists out of order or more than
+.         SOFT_MAX_RANGES of them) or bins is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SoftRaster_SetupFromList (SOFT_SCENE* scene,					// Scene to set up
+							   const uint8_t* binList, uint32_t size,	// Binning control list
+							   void* (*vc4ToARM) (uint32_t vc4Addr),	// VC4 address to pointer
+							   uint32_t clearColour,					// Tile clear colour
+							   uint32_t* bins, uint32_t binSize)		// Tile list work memory
+{
+	const uint8_t* record = 0;
+	uint32_t width = 0, height = 0;
+	uint32_t indexBase = 0, indexEnd = 0, maxIndex = 0;
+	if (!scene || !binList || !vc4ToARM) return false;
+	scene->rangeCount = 0;
+	scene->depthTest = scene->depthWrite = false;
+	scene->depthFunc = 7;										// Always
+	for (uint32_t ofs = 0; ofs < size && binList[ofs] != GL_HALT; ) {
+		const uint8_t* p = &binList[ofs];
+		uint32_t len = V3DList_PacketLength(p[0]);
+		if (len == 0 || len > size - ofs) return false;			// Not a list we can walk
+		switch (p[0]) {
+		case GL_CLIP_WINDOW:
+			width = p[5] | (p[6] << 8);
+			height = p[7] | (p[8] << 8);
+			break;
+		case GL_CONFIG_STATE:
+			scene->depthTest = (p[3] & 0x01) != 0;					// Early Z enable
+			scene->depthFunc = (p[2] >> 4) & 0x07;					// Depth function bits 12-14
+			scene->depthWrite = (p[2] & 0x80) != 0;					// Z update bit 15
+			break;
+		case GL_NV_SHADER_STATE:
+			record = (const uint8_t*)vc4ToARM(p[1] | (p[2] << 8) | (p[3] << 16) | ((uint32_t)p[4] << 24));
+			break;
+		case GL_SHADER_STATE:
+		case GL_VG_SHADER_STATE:
+			return false;											// Vertexes are made by QPU shaders
+		case GL_INDEXED_PRIMITIVE_LIST: {
+			uint32_t count = p[2] | (p[3] << 8) | (p[4] << 16) | ((uint32_t)p[5] << 24);
+			uint32_t index = p[6] | (p[7] << 8) | (p[8] << 16) | ((uint32_t)p[9] << 24);
+			uint32_t max = p[10] | (p[11] << 8) | (p[12] << 16) | ((uint32_t)p[13] << 24);
+			if ((p[1] & 0x0F) != PRIM_TRIANGLE || (p[1] & INDEX_TYPE_16) == 0) return false;
+			if (scene->rangeCount == 0) indexBase = indexEnd = index;	// Ranges count from the first list
+			if (scene->rangeCount == SOFT_MAX_RANGES || index < indexEnd
+				|| (index - indexBase) % 6) return false;			// Out of order or not whole triangles
+			scene->range[scene->rangeCount++] = (SOFT_RANGE) { (index - indexBase) / 6, count / 3 };
+			indexEnd = index + (count / 3) * 6;
+			if (max > maxIndex) maxIndex = max;
+			break;
+		}
+		default:
+			break;
+		}
+		ofs += len;
+	}
+	if (!record || scene->rangeCount == 0) return false;
+	uint32_t vertex = record[12] | (record[13] << 8) | (record[14] << 16) | ((uint32_t)record[15] << 24);
+	if (!InitScene(scene, vc4ToARM(vertex), record[1],			// Vertex data and stride from the record
+		maxIndex + 1, (const uint16_t*)vc4ToARM(indexBase), width, height, clearColour, bins, binSize)) return false;
+	scene->indexCount = (indexEnd - indexBase) / 2;
+	return BinScene(scene);
+}
+
+/*-[SoftRaster_RenderTiles]-------------------------------------------------}
+. Clears and draws tiles first, first+step, first+2*step ... of the scene
+. into target. Calls with first = 0..step-1 together draw every tile once,
+. so step threads/cores can each make one call at the same time, each with
+. its own target depth tile when the scene depth tests.
+. RETURN: Number of triangle/tile pairs drawn, 0 if the scene depth tests
+.         and the target has no depth tile
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t SoftRaster_RenderTiles (const SOFT_SCENE* scene, const SOFT_TARGET* target, uint32_t first, uint32_t step)
+{
+	uint32_t drawn = 0;
+	if (!scene || !target || !target->pixels || step == 0) return 0;
+	if (scene->depthTest && !target->depth) return 0;			// Nowhere to hold depth
+	uint32_t tiles = scene->binWth * scene->binHt;
+	for (uint32_t t = first; t < tiles; t += step) {
+		int32_t x0 = (t % scene->binWth) * SOFT_TILE_SIZE;
+		int32_t y0 = (t / scene->binWth) * SOFT_TILE_SIZE;
+		int32_t x1 = x0 + SOFT_TILE_SIZE, y1 = y0 + SOFT_TILE_SIZE;
+		if (x1 > (int32_t)scene->width) x1 = scene->width;			// Clip to the screen
+		if (y1 > (int32_t)scene->height) y1 = scene->height;
+		if (x1 > (int32_t)target->width) x1 = target->width;		// and to the target
+		if (y1 > (int32_t)target->height) y1 = target->height;
+		if (x0 >= x1 || y0 >= y1) continue;
+
+		for (int32_t y = y0; y < y1; y++) {							// Clear the tile
+			uint32_t* row = target->pixels + (uint32_t)y * target->pitch;
+			for (int32_t x = x0; x < x1; x++) row[x] = scene->clearColour;
+		}
+		if (scene->depthTest)										// Depth clears to far (1.0)
+			for (uint32_t i = 0; i < SOFT_TILE_SIZE * SOFT_TILE_SIZE; i++) target->depth[i] = 1.0f;
+		for (uint32_t i = scene->tileFirst[t]; i < scene->tileFirst[t + 1]; i++) {
+			DrawTriangle(scene, target, scene->bins[i], x0, y0, x1, y1);	// Submission order as the V3D
+			drawn++;
+		}
+	}
+	return drawn;
+}
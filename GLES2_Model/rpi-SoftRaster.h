@@ -0,0 +1,155 @@
+#ifndef _RPI_SOFTRASTER_
+#define _RPI_SOFTRASTER_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-SoftRaster.h											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  CPU reference rasteriser for what the V3D draws from an NV shader state  }
+{  binning list: 12.4 fixed point screen vertexes, 16 bit triangle indexes, }
+{  the 3 colour varyings interpolated (perspective correct on 1/W) and     }
+{  written as the fragment shader packs them, both faces. Every indexed     }
+{  primitive list in the binning list is drawn in list order.               }
+{                                                                           }
+{  The depth test is the one CONFIG_STATE sets. The rasteriser can't see    }
+{  the fragment shader so it takes early Z enabled as the sign depth is in  }
+{  use (GLES2_Model then writes TLB_Z, without it the V3D tests nothing).   }
+{  Depth is Z interpolated straight across screen space against a tile of  }
+{  floats cleared to 1.0 (the 0xFFFFFF far clear of the render list).       }
+{                                                                           }
+{  Like the V3D it bins first, SoftRaster_Setup puts each triangle in the   }
+{  list of every 64x64 tile its bounds touch, then SoftRaster_RenderTiles   }
+{  clears and draws whole tiles. A tile is only ever written by one call so }
+{  threads (host) or cores (Pi) render in parallel by each taking every     }
+{  n'th tile. The same scene gives the same pixels whatever the split.      }
+{                                                                           }
+{  The module has no hardware dependencies so it also builds on a host     }
+{  where it is the golden image for the V3D lists (see Host/RasterCheck.c). }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define SOFT_TILE_SIZE		64					// Tile size in pixels (as the V3D)
+#define SOFT_MAX_TILES		4096				// Tiles a scene can have (4096 x 4096 pixels)
+#define SOFT_MAX_RANGES		4096				// Indexed primitive lists a scene can have
+
+/* The NV shader vertex the ARM transform writes (struct EmitVertex in rpi-GLES.c) */
+typedef struct __attribute__((__packed__, aligned(1))) soft_vertex {
+	int16_t   x;								// X in signed 12.4 fixed point (off screen may be negative)
+	int16_t   y;								// Y in signed 12.4 fixed point
+	float	  z;								// Z (0 near .. 1 far for the depth test)
+	float	  w;								// 1/W
+	float 	  red;								// Varying 0 (Red)
+	float	  green;							// Varying 1 (Green)
+	float	  blue;								// Varying 2 (Blue)
+} SOFT_VERTEX;
+
+/* Triangles firstTri .. firstTri+triCount-1 of the scene indexes are drawn */
+typedef struct soft_range {
+	uint32_t firstTri;							// First triangle (index / 3) of the range
+	uint32_t triCount;							// Triangles in the range
+} SOFT_RANGE;
+
+/* A binned scene, set up once per frame and read only while tiles render */
+typedef struct soft_scene {
+	const uint8_t* vertices;					// First vertex
+	uint32_t stride;							// Bytes vertex to vertex
+	uint32_t vertexCount;						// Indexes must be below this
+	const uint16_t* indices;					// Triangle indexes, 3 a triangle
+	uint32_t indexCount;						// Indexes from indices to the end of the last range
+	uint32_t rangeCount;						// Ranges of triangles drawn, in order
+	SOFT_RANGE range[SOFT_MAX_RANGES];
+	bool depthTest;								// Fragments pass the depth function to be drawn
+	bool depthWrite;							// Drawn fragments write their depth
+	uint8_t depthFunc;							// V3D depth function 0 never .. 7 always (CONFIG_STATE)
+	uint32_t width;								// Clip window width in pixels
+	uint32_t height;							// Clip window height in pixels
+	uint32_t binWth;							// Tiles across
+	uint32_t binHt;								// Tiles down
+	uint32_t clearColour;						// Colour tiles are cleared to
+	uint32_t* bins;								// Triangle numbers of each tile back to back
+	uint32_t binSize;							// Entries bins can hold
+	uint32_t binUsed;							// Entries used (or needed if Setup failed)
+	uint32_t triangles;							// Triangles binned (zero area and culled ones are not)
+	uint32_t tileFirst[SOFT_MAX_TILES + 1];		// Tile t's triangles are bins[tileFirst[t]] to bins[tileFirst[t+1]-1]
+} SOFT_SCENE;
+
+/* Memory the tiles are drawn in */
+typedef struct soft_target {
+	uint32_t* pixels;							// Top left pixel
+	uint32_t width;								// Pixels across (drawing is clipped to this)
+	uint32_t height;							// Pixels down
+	uint32_t pitch;								// Pixels from one row to the next
+	float* depth;								// Depth tile of SOFT_TILE_SIZE squared floats (one per concurrent call)
+} SOFT_TARGET;
+
+/*-[SoftRaster_Setup]-------------------------------------------------------}
+. Bins the indexCount/3 triangles of indices into the tiles of a width x
+. height screen with no depth test. bins is binSize entries of work memory
+. holding the tile lists, needing one entry per triangle per tile it touches.
+. RETURN: true if the scene is ready, false if a parameter is bad or bins is
+.         too small (scene->binUsed is then the entries needed)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SoftRaster_Setup (SOFT_SCENE* scene,							// Scene to set up
+					   const void* vertices, uint32_t stride,		// SOFT_VERTEX layout, stride apart
+					   uint32_t vertexCount,						// Vertexes available
+					   const uint16_t* indices, uint32_t indexCount,// Triangle list indexes
+					   uint32_t width, uint32_t height,				// Screen (clip window) size
+					   uint32_t clearColour,						// Tile clear colour
+					   uint32_t* bins, uint32_t binSize);			// Tile list work memory
+
+/*-[SoftRaster_SetupFromList]-----------------------------------------------}
+. Sets the scene up from an NV shader state binning control list as the V3D
+. would read it. The clip window gives the screen size, the config state the
+. depth test, the NV shader record the vertexes and stride, the indexed
+. primitive lists the indexes. Every VC4 address in the list or record is
+. turned into a pointer by vc4ToARM. The lists must all index one array in
+. whole triangles (as rpi-Cull runs do) and be in address order.
+. RETURN: false if the list is not one this rasteriser can draw (coordinate
+.         shaders, not 16 bit triangles, lists out of order or more than
+.         SOFT_MAX_RANGES of them) or bins is too small
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool SoftRaster_SetupFromList (SOFT_SCENE* scene,					// Scene to set up
+							   const uint8_t* binList, uint32_t size,	// Binning control list
+							   void* (*vc4ToARM) (uint32_t vc4Addr),	// VC4 address to pointer
+							   uint32_t clearColour,					// Tile clear colour
+							   uint32_t* bins, uint32_t binSize);		// Tile list work memory
+
+/*-[SoftRaster_RenderTiles]-------------------------------------------------}
+. Clears and draws tiles first, first+step, first+2*step ... of the scene
+. into target. Calls with first = 0..step-1 together draw every tile once,
+. so step threads/cores can each make one call at the same time, each with
+. its own target depth tile when the scene depth tests.
+. RETURN: Number of triangle/tile pairs drawn, 0 if the scene depth tests
+.         and the target has no depth tile
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t SoftRaster_RenderTiles (const SOFT_SCENE* scene, const SOFT_TARGET* target, uint32_t first, uint32_t step);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
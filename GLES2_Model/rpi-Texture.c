@@ -0,0 +1,245 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memcpy
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>							// Pi2/Pi3 builds move texels 16 bytes at a time
+#endif
+#include "rpi-Texture.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Texture.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+#define UTILE_SIZE		4						// Microtile side in 32 bit texels
+#define UTILE_BYTES		64						// Microtile bytes
+#define TTILE_SIZE		32						// T-format 4K tile side in texels
+#define LT_MAX_SIDE		16						// Levels with a side this size or less are LT
+
+/* Subtile a microtile is in for its x,y subtile bits (y * 2 + x), by tile row */
+static const uint8_t evenSubtile[4] = { 0, 3, 1, 2 };
+static const uint8_t oddSubtile[4] = { 2, 1, 3, 0 };
+
+/*--------------------------------------------------------------------------}
+{ Byte offset of microtile ux,uy (in microtiles) in a level.               }
+{--------------------------------------------------------------------------*/
+static uint32_t UtileOffset (const TEXTURE_LEVEL* level, uint32_t ux, uint32_t uy)
+{
+	if (level->tiling == TEXTURE_TILING_LT)							// Plain row order
+		return (uy * (level->padWidth / UTILE_SIZE) + ux) * UTILE_BYTES;
+	uint32_t tilesAcross = level->padWidth / TTILE_SIZE;
+	uint32_t tx = ux >> 3, ty = uy >> 3;							// 8x8 microtiles a 4K tile
+	uint32_t s = ((uy >> 2) & 1) * 2 + ((ux >> 2) & 1);				// Subtile within the tile
+	uint32_t sub;
+	if (ty & 1) {													// Odd tile rows run right to left
+		tx = tilesAcross - 1 - tx;
+		sub = oddSubtile[s];
+	} else sub = evenSubtile[s];
+	return ((ty * tilesAcross + tx) << 12) + (sub << 10) + (((uy & 3) * 4 + (ux & 3)) << 6);
+}
+
+/*--------------------------------------------------------------------------}
+{ Rounded up average of each of the 4 bytes of a and b (SIMD in a word).   }
+{--------------------------------------------------------------------------*/
+static uint32_t AverageBytes (uint32_t a, uint32_t b)
+{
+	return (a | b) - (((a ^ b) >> 1) & 0x7F7F7F7F);
+}
+
+static uint32_t Read16 (const uint8_t* p)
+{
+	return p[0] | ((uint32_t)p[1] << 8);
+}
+
+static uint32_t Read32 (const uint8_t* p)
+{
+	return p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*-[Texture_Layout]---------------------------------------------------------}
+. Works out the tiling, padding and offset of every level of a width x
+. height texture, level 0 only if mipmaps is false.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_Layout (TEXTURE_LAYOUT* layout, uint32_t width, uint32_t height, bool mipmaps)
+{
+	if ((!layout) || (width == 0) || (height == 0)) return false;
+	if ((width > TEXTURE_MAX_SIZE) || (height > TEXTURE_MAX_SIZE)) return false;
+	if (mipmaps && ((width & (width - 1)) || (height & (height - 1)))) return false;	// Power of 2 only
+	*layout = (TEXTURE_LAYOUT) { 0 };
+	layout->levels = 1;
+	if (mipmaps)
+		while ((width >> (layout->levels - 1)) > 1 || (height >> (layout->levels - 1)) > 1)
+			layout->levels++;
+
+	for (uint32_t i = 0; i < layout->levels; i++) {
+		TEXTURE_LEVEL* lv = &layout->level[i];
+		lv->width = (width >> i) ? (width >> i) : 1;
+		lv->height = (height >> i) ? (height >> i) : 1;
+		uint32_t pad = UTILE_SIZE;
+		lv->tiling = TEXTURE_TILING_LT;
+		if ((lv->width > LT_MAX_SIDE) && (lv->height > LT_MAX_SIDE)) {
+			pad = TTILE_SIZE;										// Whole 4K tiles
+			lv->tiling = TEXTURE_TILING_T;
+		}
+		lv->padWidth = (lv->width + pad - 1) & ~(pad - 1);
+		lv->padHeight = (lv->height + pad - 1) & ~(pad - 1);
+		lv->size = (uint32_t)lv->padWidth * lv->padHeight * 4;
+	}
+
+	// Smallest level first, then pad the front so level 0 starts on a 4K page
+	uint32_t offset = 0;
+	for (uint32_t i = layout->levels; i-- > 0;) {
+		layout->level[i].offset = offset;
+		offset += layout->level[i].size;
+	}
+	uint32_t pad = (0x1000 - (layout->level[0].offset & 0xFFF)) & 0xFFF;
+	for (uint32_t i = 0; i < layout->levels; i++)
+		layout->level[i].offset += pad;
+	layout->size = offset + pad;
+	return true;
+}
+
+/*-[Texture_TexelOffset]----------------------------------------------------}
+. RETURN: Byte offset of texel x,y from the start of the level
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Texture_TexelOffset (const TEXTURE_LEVEL* level, uint32_t x, uint32_t y)
+{
+	return UtileOffset(level, x / UTILE_SIZE, y / UTILE_SIZE) + ((y & 3) * 4 + (x & 3)) * 4;
+}
+
+/*-[Texture_Swizzle]--------------------------------------------------------}
+. Writes the level's texels from the row order image src into dest in its
+. T or LT order, padding repeats the edge texels.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Texture_Swizzle (void* dest, const TEXTURE_LEVEL* level, const uint32_t* src, uint32_t srcPitch)
+{
+	if ((!dest) || (!level) || (!src)) return;
+	uint32_t utilesAcross = level->padWidth / UTILE_SIZE;
+	uint32_t utilesDown = level->padHeight / UTILE_SIZE;
+	for (uint32_t uy = 0; uy < utilesDown; uy++) {
+		const uint32_t* row[UTILE_SIZE];
+		for (uint32_t r = 0; r < UTILE_SIZE; r++) {				// Rows past the bottom repeat the last
+			uint32_t y = uy * UTILE_SIZE + r;
+			row[r] = src + ((y < level->height) ? y : level->height - 1u) * srcPitch;
+		}
+		for (uint32_t ux = 0; ux < utilesAcross; ux++) {
+			uint32_t* d = (uint32_t*)((uint8_t*)dest + UtileOffset(level, ux, uy));
+			uint32_t x = ux * UTILE_SIZE;
+			if (x + UTILE_SIZE <= level->width) {					// Whole microtile row in the image
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+				uint32x4_t r0 = vld1q_u32(row[0] + x);
+				uint32x4_t r1 = vld1q_u32(row[1] + x);
+				uint32x4_t r2 = vld1q_u32(row[2] + x);
+				uint32x4_t r3 = vld1q_u32(row[3] + x);
+				vst1q_u32(d, r0);
+				vst1q_u32(d + 4, r1);
+				vst1q_u32(d + 8, r2);
+				vst1q_u32(d + 12, r3);
+#else
+				for (uint32_t r = 0; r < UTILE_SIZE; r++)
+					memcpy(d + r * UTILE_SIZE, row[r] + x, UTILE_SIZE * sizeof(uint32_t));
+#endif
+			} else {												// Right edge, columns past it repeat the last
+				for (uint32_t r = 0; r < UTILE_SIZE; r++)
+					for (uint32_t c = 0; c < UTILE_SIZE; c++)
+						d[r * UTILE_SIZE + c] = row[r][(x + c < level->width) ? x + c : level->width - 1u];
+			}
+		}
+	}
+}
+
+/*-[Texture_Downsample]-----------------------------------------------------}
+. Box filters the width x height row order image src into dest, the next
+. mipmap level (half each side, never below 1).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Texture_Downsample (uint32_t* dest, const uint32_t* src, uint32_t width, uint32_t height)
+{
+	if ((!dest) || (!src) || (width == 0) || (height == 0)) return;
+	uint32_t dw = (width > 1) ? width / 2 : 1;
+	uint32_t dh = (height > 1) ? height / 2 : 1;
+	for (uint32_t y = 0; y < dh; y++) {
+		const uint32_t* r0 = src + ((2 * y < height) ? 2 * y : height - 1) * width;
+		const uint32_t* r1 = src + ((2 * y + 1 < height) ? 2 * y + 1 : height - 1) * width;
+		uint32_t* d = dest + y * dw;
+		uint32_t x = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+		if (width > 1) {
+			for (; x + 4 <= dw; x += 4) {							// 8 source texels of both rows, even and odd apart
+				uint32x4x2_t a = vld2q_u32(r0 + 2 * x);
+				uint32x4x2_t b = vld2q_u32(r1 + 2 * x);
+				uint8x16_t top = vrhaddq_u8(vreinterpretq_u8_u32(a.val[0]), vreinterpretq_u8_u32(a.val[1]));
+				uint8x16_t bottom = vrhaddq_u8(vreinterpretq_u8_u32(b.val[0]), vreinterpretq_u8_u32(b.val[1]));
+				vst1q_u32(d + x, vreinterpretq_u32_u8(vrhaddq_u8(top, bottom)));
+			}
+		}
+#endif
+		for (; x < dw; x++) {
+			uint32_t x0 = (2 * x < width) ? 2 * x : width - 1;
+			uint32_t x1 = (2 * x + 1 < width) ? 2 * x + 1 : width - 1;
+			d[x] = AverageBytes(AverageBytes(r0[x0], r0[x1]), AverageBytes(r1[x0], r1[x1]));
+		}
+	}
+}
+
+/*-[Texture_BmpSize]--------------------------------------------------------}
+. Checks the header of an uncompressed 24 or 32 bit BMP file and gives its
+. size.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_BmpSize (const void* file, uint32_t fileSize, uint32_t* width, uint32_t* height)
+{
+	const uint8_t* f = file;
+	if ((!f) || (fileSize < 54) || (f[0] != 'B') || (f[1] != 'M')) return false;	// File + info header
+	uint32_t dataOffset = Read32(&f[10]);
+	int32_t w = (int32_t)Read32(&f[18]);
+	int32_t h = (int32_t)Read32(&f[22]);
+	uint32_t bits = Read16(&f[28]);
+	if ((Read32(&f[14]) < 40) || (Read32(&f[30]) != 0)) return false;	// Needs BITMAPINFOHEADER, BI_RGB
+	if ((bits != 24) && (bits != 32)) return false;
+	if (h < 0) h = -h;												// Negative height is top down
+	if ((w <= 0) || (h == 0) || (w > TEXTURE_MAX_SIZE) || (h > TEXTURE_MAX_SIZE)) return false;
+	uint32_t stride = ((uint32_t)w * (bits / 8) + 3) & ~3u;			// Rows pad to 4 bytes
+	if ((dataOffset > fileSize) || (stride * (uint32_t)h > fileSize - dataOffset)) return false;
+	if (width) *width = w;
+	if (height) *height = h;
+	return true;
+}
+
+/*-[Texture_DecodeBmp]------------------------------------------------------}
+. Converts a BMP Texture_BmpSize accepted to texel words, bottom row first.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_DecodeBmp (const void* file, uint32_t fileSize, uint32_t* dest)
+{
+	uint32_t w, h;
+	if ((!dest) || (!Texture_BmpSize(file, fileSize, &w, &h))) return false;
+	const uint8_t* f = file;
+	uint32_t bytes = Read16(&f[28]) / 8;
+	uint32_t stride = (w * bytes + 3) & ~3u;
+	bool topDown = ((int32_t)Read32(&f[22]) < 0);
+	for (uint32_t y = 0; y < h; y++) {
+		const uint8_t* p = f + Read32(&f[10]) + (topDown ? h - 1 - y : y) * stride;
+		uint32_t* d = dest + y * w;
+		for (uint32_t x = 0; x < w; x++, p += bytes)				// B,G,R(,X) bytes, BI_RGB has no alpha
+			d[x] = p[2] | ((uint32_t)p[1] << 8) | ((uint32_t)p[0] << 16) | 0xFF000000u;
+	}
+	return true;
+}
@@ -0,0 +1,657 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memset
+#include "rpi-V3DList.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-V3DList.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+/* REFERENCES */
+/* https://docs.broadcom.com/docs/12358545  (section 9 control lists) */
+
+#define V3DLIST_MAX_TILES 4096							// Render validate tile map (64 x 64 tiles is 4096 x 4096 pixels)
+
+/*--------------------------------------------------------------------------}
+{  Packet length (opcode byte included) and name, a zero length opcode is   }
+{  not one this module knows and ends a walk of the list.                   }
+{--------------------------------------------------------------------------*/
+static const struct {
+	uint8_t len;
+	const char* name;
+} packetInfo[128] = {
+	[GL_HALT] = { 1, "HALT" },
+	[GL_NOP] = { 1, "NOP" },
+	[GL_FLUSH] = { 1, "FLUSH" },
+	[GL_FLUSH_ALL_STATE] = { 1, "FLUSH_ALL_STATE" },
+	[GL_START_TILE_BINNING] = { 1, "START_TILE_BINNING" },
+	[GL_INCREMENT_SEMAPHORE] = { 1, "INCREMENT_SEMAPHORE" },
+	[GL_WAIT_ON_SEMAPHORE] = { 1, "WAIT_ON_SEMAPHORE" },
+	[GL_BRANCH] = { 5, "BRANCH" },
+	[GL_BRANCH_TO_SUBLIST] = { 5, "BRANCH_TO_SUBLIST" },
+	[GL_RETURN_FROM_SUBLIST] = { 1, "RETURN_FROM_SUBLIST" },
+	[GL_STORE_MULTISAMPLE] = { 1, "STORE_MULTISAMPLE" },
+	[GL_STORE_MULTISAMPLE_END] = { 1, "STORE_MULTISAMPLE_END" },
+	[GL_STORE_FULL_TILE_BUFFER] = { 5, "STORE_FULL_TILE_BUFFER" },
+	[GL_RELOAD_FULL_TILE_BUFFER] = { 5, "RELOAD_FULL_TILE_BUFFER" },
+	[GL_STORE_TILE_BUFFER] = { 7, "STORE_TILE_BUFFER" },
+	[GL_LOAD_TILE_BUFFER] = { 7, "LOAD_TILE_BUFFER" },
+	[GL_INDEXED_PRIMITIVE_LIST] = { 14, "INDEXED_PRIMITIVE_LIST" },
+	[GL_VERTEX_ARRAY_PRIMITIVES] = { 10, "VERTEX_ARRAY_PRIMITIVES" },
+	[GL_VG_COORDINATE_ARRAY_PRIMITIVES] = { 10, "VG_COORDINATE_ARRAY_PRIMITIVES" },
+	[GL_PRIMITIVE_LIST_FORMAT] = { 2, "PRIMITIVE_LIST_FORMAT" },
+	[GL_SHADER_STATE] = { 5, "SHADER_STATE" },
+	[GL_NV_SHADER_STATE] = { 5, "NV_SHADER_STATE" },
+	[GL_VG_SHADER_STATE] = { 5, "VG_SHADER_STATE" },
+	[GL_VG_INLINE_SHADER_RECORD] = { 5, "VG_INLINE_SHADER_RECORD" },
+	[GL_CONFIG_STATE] = { 4, "CONFIG_STATE" },
+	[GL_FLAT_SHADE_FLAGS] = { 5, "FLAT_SHADE_FLAGS" },
+	[GL_POINTS_SIZE] = { 5, "POINTS_SIZE" },
+	[GL_LINE_WIDTH] = { 5, "LINE_WIDTH" },
+	[GL_RHT_X_BOUNDARY] = { 3, "RHT_X_BOUNDARY" },
+	[GL_DEPTH_OFFSET] = { 5, "DEPTH_OFFSET" },
+	[GL_CLIP_WINDOW] = { 9, "CLIP_WINDOW" },
+	[GL_VIEWPORT_OFFSET] = { 5, "VIEWPORT_OFFSET" },
+	[GL_Z_CLIPPING_PLANES] = { 9, "Z_CLIPPING_PLANES" },
+	[GL_CLIPPER_XY_SCALING] = { 9, "CLIPPER_XY_SCALING" },
+	[GL_CLIPPER_Z_ZSCALE_OFFSET] = { 9, "CLIPPER_Z_ZSCALE_OFFSET" },
+	[GL_TILE_BINNING_CONFIG] = { 16, "TILE_BINNING_CONFIG" },
+	[GL_TILE_RENDER_CONFIG] = { 11, "TILE_RENDER_CONFIG" },
+	[GL_CLEAR_COLORS] = { 14, "CLEAR_COLORS" },
+	[GL_TILE_COORDINATES] = { 3, "TILE_COORDINATES" },
+};
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                       INTERNAL LIST WRITE ROUTINES                        }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*--------------------------------------------------------------------------}
+{ Starts a packet of len bytes (opcode included) writing the opcode. If the }
+{ packet does not fit the list is marked overflowed and false returned so   }
+{ the caller writes nothing more.                                           }
+{--------------------------------------------------------------------------*/
+static bool PacketStart (V3D_LIST* list, GL_CONTROL opcode)
+{
+	uint32_t len = packetInfo[opcode].len;
+	if (list->overflow || (uint32_t)(list->end - list->pos) < len) {
+		list->overflow = true;										// Once short always short
+		return false;
+	}
+	*list->pos++ = (uint8_t)opcode;
+	return true;
+}
+
+static void Put8 (V3D_LIST* list, uint8_t d)
+{
+	*list->pos++ = d;
+}
+
+static void Put16 (V3D_LIST* list, uint16_t d)
+{
+	*list->pos++ = (uint8_t)d;										// V3D lists are little endian
+	*list->pos++ = (uint8_t)(d >> 8);								// written a byte at a time as
+}																	// packets are not aligned
+
+static void Put32 (V3D_LIST* list, uint32_t d)
+{
+	*list->pos++ = (uint8_t)d;
+	*list->pos++ = (uint8_t)(d >> 8);
+	*list->pos++ = (uint8_t)(d >> 16);
+	*list->pos++ = (uint8_t)(d >> 24);
+}
+
+static uint16_t Get16 (const uint8_t* p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t Get32 (const uint8_t* p)
+{
+	return ((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                       PUBLIC LIST BUILDER ROUTINES                        }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*-[V3DList_Init]-----------------------------------------------------------}
+. Starts an empty list in size bytes at mem which the V3D sees at memVC4.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3DList_Init (V3D_LIST* list, void* mem, uint32_t memVC4, uint32_t size)
+{
+	list->start = (uint8_t*)mem;
+	list->pos = list->start;
+	list->end = list->start + size;
+	list->startVC4 = memVC4;
+	list->overflow = (mem == 0);									// No memory nothing will fit
+}
+
+/*-[V3DList_Size]-----------------------------------------------------------}
+. RETURN: Bytes written to the list so far
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Size (const V3D_LIST* list)
+{
+	return (uint32_t)(list->pos - list->start);
+}
+
+/*-[V3DList_EndVC4]---------------------------------------------------------}
+. RETURN: VC4 address one past the last packet (the CTnEA end address)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_EndVC4 (const V3D_LIST* list)
+{
+	return list->startVC4 + V3DList_Size(list);
+}
+
+void V3DList_Halt (V3D_LIST* list)
+{
+	PacketStart(list, GL_HALT);
+}
+
+void V3DList_Nop (V3D_LIST* list)
+{
+	PacketStart(list, GL_NOP);
+}
+
+void V3DList_Flush (V3D_LIST* list)
+{
+	PacketStart(list, GL_FLUSH);
+}
+
+void V3DList_FlushAllState (V3D_LIST* list)
+{
+	PacketStart(list, GL_FLUSH_ALL_STATE);
+}
+
+void V3DList_StartTileBinning (V3D_LIST* list)
+{
+	PacketStart(list, GL_START_TILE_BINNING);
+}
+
+void V3DList_BranchToSublist (V3D_LIST* list, uint32_t sublistVC4)
+{
+	if (PacketStart(list, GL_BRANCH_TO_SUBLIST)) {
+		Put32(list, sublistVC4);									// Sublist address
+	}
+}
+
+void V3DList_StoreMultisample (V3D_LIST* list, bool endOfFrame)
+{
+	PacketStart(list, endOfFrame ? GL_STORE_MULTISAMPLE_END : GL_STORE_MULTISAMPLE);
+}
+
+void V3DList_StoreTileBuffer (V3D_LIST* list, uint16_t flags, uint32_t addrVC4)
+{
+	if (PacketStart(list, GL_STORE_TILE_BUFFER)) {
+		Put16(list, flags);											// Buffer, format, mode (0 = store nothing just clear)
+		Put32(list, addrVC4);										// Memory base address
+	}
+}
+
+void V3DList_IndexedPrimitiveList (V3D_LIST* list, uint8_t modeAndIndexType, uint32_t count, uint32_t indexVC4, uint32_t maxIndex)
+{
+	if (PacketStart(list, GL_INDEXED_PRIMITIVE_LIST)) {
+		Put8(list, modeAndIndexType);								// PRIM_xxx | INDEX_TYPE_xx
+		Put32(list, count);											// Length (number of indices)
+		Put32(list, indexVC4);										// Address of index data
+		Put32(list, maxIndex);										// Maximum index
+	}
+}
+
+void V3DList_PrimitiveListFormat (V3D_LIST* list, uint8_t format)
+{
+	if (PacketStart(list, GL_PRIMITIVE_LIST_FORMAT)) {
+		Put8(list, format);											// Data type | primitive type
+	}
+}
+
+void V3DList_ShaderState (V3D_LIST* list, uint32_t recordVC4, uint8_t attribCount)
+{
+	if (PacketStart(list, GL_SHADER_STATE)) {
+		Put32(list, (recordVC4 & ~0xF) | (attribCount & 0x7));		// Record (16 byte aligned) | attribute arrays (0 = 8)
+	}
+}
+
+void V3DList_NVShaderState (V3D_LIST* list, uint32_t recordVC4)
+{
+	if (PacketStart(list, GL_NV_SHADER_STATE)) {
+		Put32(list, recordVC4);										// Record (16 byte aligned)
+	}
+}
+
+void V3DList_ConfigState (V3D_LIST* list, uint8_t flags8, uint8_t flags16, uint8_t flags24)
+{
+	if (PacketStart(list, GL_CONFIG_STATE)) {
+		Put8(list, flags8);											// Face enables, CW, depth offset, AA
+		Put8(list, flags16);										// Coverage, depth function and write
+		Put8(list, flags24);										// Early Z
+	}
+}
+
+void V3DList_ClipWindow (V3D_LIST* list, uint16_t left, uint16_t bottom, uint16_t width, uint16_t height)
+{
+	if (PacketStart(list, GL_CLIP_WINDOW)) {
+		Put16(list, left);
+		Put16(list, bottom);
+		Put16(list, width);
+		Put16(list, height);
+	}
+}
+
+void V3DList_ViewportOffset (V3D_LIST* list, uint16_t x, uint16_t y)
+{
+	if (PacketStart(list, GL_VIEWPORT_OFFSET)) {
+		Put16(list, x);
+		Put16(list, y);
+	}
+}
+
+void V3DList_TileBinningConfig (V3D_LIST* list, uint32_t tileAllocVC4, uint32_t tileAllocSize, uint32_t tileStateVC4,
+								uint8_t binWth, uint8_t binHt, uint8_t flags)
+{
+	if (PacketStart(list, GL_TILE_BINNING_CONFIG)) {
+		Put32(list, tileAllocVC4);									// Tile allocation memory address
+		Put32(list, tileAllocSize);									// Tile allocation memory size
+		Put32(list, tileStateVC4);									// Tile state data address (48 bytes a tile)
+		Put8(list, binWth);											// Tiles across
+		Put8(list, binHt);											// Tiles down
+		Put8(list, flags);											// Multisample, 64 bit, auto init, block sizes
+	}
+}
+
+void V3DList_TileRenderConfig (V3D_LIST* list, uint32_t renderVC4, uint16_t width, uint16_t height, uint16_t mode)
+{
+	if (PacketStart(list, GL_TILE_RENDER_CONFIG)) {
+		Put32(list, renderVC4);										// Frame buffer address
+		Put16(list, width);											// Width in pixels
+		Put16(list, height);										// Height in pixels
+		Put16(list, mode);											// Frame buffer mode
+	}
+}
+
+void V3DList_ClearColors (V3D_LIST* list, uint32_t colour, uint32_t clearZ, uint8_t clearStencil)
+{
+	if (PacketStart(list, GL_CLEAR_COLORS)) {
+		Put32(list, colour);										// 32 bit clear colours need to be repeated twice
+		Put32(list, colour);
+		Put32(list, clearZ);										// Clear Z (24 bit) and VG mask (8 bit)
+		Put8(list, clearStencil);									// Clear stencil
+	}
+}
+
+void V3DList_TileCoordinates (V3D_LIST* list, uint8_t x, uint8_t y)
+{
+	if (PacketStart(list, GL_TILE_COORDINATES)) {
+		Put8(list, x);
+		Put8(list, y);
+	}
+}
+
+/*-[V3DList_RenderTiles]----------------------------------------------------}
+. Writes the usual whole render list: clear colours (depth to the far
+. 0xFFFFFF), render config, a clearing store of tile 0,0 then every tile
+. branching to its initial block in tileAllocVC4 and storing, the last with
+. end of frame.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3DList_RenderTiles (V3D_LIST* list,							// List to write
+						  uint32_t clearColour,						// RGBA clear colour
+						  uint32_t renderVC4,						// Frame buffer VC4 address
+						  uint16_t width, uint16_t height,			// Render size in pixels
+						  uint16_t mode,							// Frame buffer mode (0x04 = linear rgba8888)
+						  uint8_t binWth, uint8_t binHt,				// Tiles across and down
+						  uint32_t tileAllocVC4)					// Tile allocation memory the binner filled
+{
+	V3DList_ClearColors(list, clearColour, 0xFFFFFF, 0);			// Depth clears to far
+	V3DList_TileRenderConfig(list, renderVC4, width, height, mode);
+
+	// Do a store of the first tile to force the tile buffer to be cleared
+	V3DList_TileCoordinates(list, 0, 0);
+	V3DList_StoreTileBuffer(list, 0, 0);							// Store nothing (just clear)
+
+	// Link all binned lists together
+	for (uint32_t x = 0; x < binWth; x++) {
+		for (uint32_t y = 0; y < binHt; y++) {
+			V3DList_TileCoordinates(list, x, y);
+			V3DList_BranchToSublist(list, tileAllocVC4 + (y * binWth + x) * 32);
+			V3DList_StoreMultisample(list, (x == binWth - 1u) && (y == binHt - 1u));	// Last tile signals end of frame
+		}
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                   PUBLIC VALIDATE/DISASSEMBLE ROUTINES                    }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*-[V3DList_PacketLength]---------------------------------------------------}
+. RETURN: Bytes of the packet with the opcode including the opcode byte,
+.         0 for an opcode the module does not know the length of
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_PacketLength (uint8_t opcode)
+{
+	if (opcode >= 128) return 0;
+	return packetInfo[opcode].len;
+}
+
+/*--------------------------------------------------------------------------}
+{ Returns true if addr to addr+len-1 sits inside one of the ranges in v, a  }
+{ validate with no ranges accepts any address.                              }
+{--------------------------------------------------------------------------*/
+static bool InRanges (const V3D_VALIDATE* v, uint32_t addr, uint32_t len)
+{
+	if (v->rangeCount == 0) return true;
+	for (uint32_t i = 0; i < v->rangeCount; i++) {
+		const V3D_MEM_RANGE* r = &v->ranges[i];
+		if (addr >= r->start && len <= r->size && (addr - r->start) <= (r->size - len))
+			return true;
+	}
+	return false;
+}
+
+#define LIST_PROBLEM(...) do { errors++; if (prn_handler) prn_handler(__VA_ARGS__); } while (0)
+#define CHECK_RANGE(addr, len, what) \
+	if (!InRanges(v, (addr), (len))) LIST_PROBLEM("0x%08x: %s 0x%08x (%u bytes) outside GPU memory\n", at, (what), (addr), (unsigned)(len))
+
+/*-[V3DList_Validate]-------------------------------------------------------}
+. Walks size bytes of list (at VC4 address listVC4) and checks it against
+. the rules in v. Each problem is printed through prn_handler (may be NULL).
+. Binning: config then start binning first, primitives only once shader
+. state, list format, clip window and config state are set, tile alloc big
+. enough for the initial blocks, all addresses in the ranges, ends with a
+. flush. Render: render config before the tiles, every tile once inside
+. the grid with a store after it, one end of frame store on the last tile,
+. sublist branches to the tile's initial block.
+. RETURN: Number of problems found (0 = list is good)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Validate (const uint8_t* list, uint32_t size, uint32_t listVC4,
+						   const V3D_VALIDATE* v, int (*prn_handler) (const char *fmt, ...))
+{
+	static uint8_t tileSeen[V3DLIST_MAX_TILES];						// Render list branches seen per tile
+	uint32_t errors = 0;
+	bool binConfig = false, binStarted = false, shader = false;		// Binning state seen
+	bool format = false, clip = false, config = false;
+	bool flushed = true, halted = false;
+	bool renderConfig = false, tileOpen = false, frameEnded = false;// Render state seen
+	bool extraTiles = false;
+	uint32_t binWth = v->binWth, binHt = v->binHt;
+	uint32_t tileX = 0, tileY = 0, tileCoords = 0, tilesDone = 0, blockSize = 32;
+
+	memset(tileSeen, 0, sizeof(tileSeen));
+	uint32_t ofs = 0;
+	while (ofs < size && !halted) {
+		uint32_t at = listVC4 + ofs;
+		const uint8_t* p = &list[ofs];
+		uint32_t len = V3DList_PacketLength(p[0]);
+		if (len == 0) {
+			LIST_PROBLEM("0x%08x: unknown packet %u, list can not be walked further\n", at, p[0]);
+			return errors;
+		}
+		if (len > size - ofs) {
+			LIST_PROBLEM("0x%08x: %s runs %u bytes past the end of the list\n", at, packetInfo[p[0]].name, len - (size - ofs));
+			return errors;
+		}
+		switch (p[0]) {
+		case GL_HALT:
+			halted = true;
+			break;
+		case GL_NOP:
+			break;
+		case GL_FLUSH:
+		case GL_FLUSH_ALL_STATE:
+			if (v->type != V3DLIST_BINNING) LIST_PROBLEM("0x%08x: flush in a render list\n", at);
+			flushed = true;
+			break;
+		case GL_TILE_BINNING_CONFIG: {
+			uint32_t alloc = Get32(&p[1]), allocSize = Get32(&p[5]), state = Get32(&p[9]);
+			if (v->type != V3DLIST_BINNING) LIST_PROBLEM("0x%08x: binning config in a render list\n", at);
+			if (binStarted) LIST_PROBLEM("0x%08x: binning config after binning started\n", at);
+			binConfig = true;
+			if (v->binWth && p[13] != v->binWth) LIST_PROBLEM("0x%08x: %u tiles across expected %u\n", at, p[13], (unsigned)v->binWth);
+			if (v->binHt && p[14] != v->binHt) LIST_PROBLEM("0x%08x: %u tiles down expected %u\n", at, p[14], (unsigned)v->binHt);
+			binWth = p[13];
+			binHt = p[14];
+			blockSize = 32u << ((p[15] >> 3) & 3);					// Initial tile block size from flags
+			if (binWth == 0 || binHt == 0) LIST_PROBLEM("0x%08x: empty tile grid %ux%u\n", at, (unsigned)binWth, (unsigned)binHt);
+			if (alloc & 0xFF) LIST_PROBLEM("0x%08x: tile allocation 0x%08x not 256 byte aligned\n", at, alloc);
+			if (state & 0xF) LIST_PROBLEM("0x%08x: tile state 0x%08x not 16 byte aligned\n", at, state);
+			if (allocSize < binWth * binHt * blockSize)
+				LIST_PROBLEM("0x%08x: tile allocation %u bytes can't hold %u initial %u byte blocks\n",
+					at, allocSize, (unsigned)(binWth * binHt), (unsigned)blockSize);
+			CHECK_RANGE(alloc, allocSize, "tile allocation");
+			CHECK_RANGE(state, binWth * binHt * 48, "tile state");
+			break;
+		}
+		case GL_START_TILE_BINNING:
+			if (v->type != V3DLIST_BINNING) LIST_PROBLEM("0x%08x: start binning in a render list\n", at);
+			if (!binConfig) LIST_PROBLEM("0x%08x: start binning before binning config\n", at);
+			if (binStarted) LIST_PROBLEM("0x%08x: binning started twice\n", at);
+			binStarted = true;
+			break;
+		case GL_PRIMITIVE_LIST_FORMAT:
+			format = true;
+			break;
+		case GL_CLIP_WINDOW:
+			clip = true;
+			if (Get16(&p[5]) == 0 || Get16(&p[7]) == 0) LIST_PROBLEM("0x%08x: clip window is empty\n", at);
+			break;
+		case GL_CONFIG_STATE:
+			config = true;
+			if ((p[1] & 0x03) == 0) LIST_PROBLEM("0x%08x: config state draws neither front nor back faces\n", at);
+			break;
+		case GL_SHADER_STATE:
+		case GL_NV_SHADER_STATE:
+		case GL_VG_SHADER_STATE: {
+			uint32_t rec = Get32(&p[1]);
+			if (p[0] == GL_NV_SHADER_STATE && (rec & 0xF)) LIST_PROBLEM("0x%08x: shader record 0x%08x not 16 byte aligned\n", at, rec);
+			CHECK_RANGE(rec & ~0xF, 16, "shader record");
+			shader = true;
+			break;
+		}
+		case GL_INDEXED_PRIMITIVE_LIST:
+		case GL_VERTEX_ARRAY_PRIMITIVES: {
+			if (v->type != V3DLIST_BINNING) LIST_PROBLEM("0x%08x: primitives in a render list\n", at);
+			if (!binStarted) LIST_PROBLEM("0x%08x: primitives before start binning\n", at);
+			if (!shader) LIST_PROBLEM("0x%08x: primitives with no shader state\n", at);
+			if (!format) LIST_PROBLEM("0x%08x: primitives with no primitive list format\n", at);
+			if (!clip) LIST_PROBLEM("0x%08x: primitives with no clip window\n", at);
+			if (!config) LIST_PROBLEM("0x%08x: primitives with no config state\n", at);
+			if ((p[1] & 0x0F) > PRIM_TRIANGLE_FAN) LIST_PROBLEM("0x%08x: primitive mode %u unknown\n", at, p[1] & 0x0F);
+			if (p[0] == GL_INDEXED_PRIMITIVE_LIST) {
+				uint32_t count = Get32(&p[2]), index = Get32(&p[6]);
+				uint32_t indexSize = (p[1] & INDEX_TYPE_16) ? 2 : 1;
+				if (count == 0) LIST_PROBLEM("0x%08x: primitive list with no indices\n", at);
+				if ((p[1] & INDEX_TYPE_16) && (index & 1)) LIST_PROBLEM("0x%08x: 16 bit indices at odd address 0x%08x\n", at, index);
+				CHECK_RANGE(index, count * indexSize, "index array");
+			}
+			flushed = false;
+			break;
+		}
+		case GL_TILE_RENDER_CONFIG: {
+			uint32_t buf = Get32(&p[1]), w = Get16(&p[5]), h = Get16(&p[7]), mode = Get16(&p[9]);
+			uint32_t bpp = (((mode >> 2) & 3) == 1) ? 4 : 2;		// rgba8888 or bgr565
+			if (v->type != V3DLIST_RENDER) LIST_PROBLEM("0x%08x: render config in a binning list\n", at);
+			if (renderConfig) LIST_PROBLEM("0x%08x: render config twice\n", at);
+			renderConfig = true;
+			if (w == 0 || h == 0) LIST_PROBLEM("0x%08x: render size %ux%u is empty\n", at, (unsigned)w, (unsigned)h);
+			if (!v->binWth) binWth = (w + 63) / 64;				// Tile grid from the render size
+			if (!v->binHt) binHt = (h + 63) / 64;
+			if (binWth != (w + 63) / 64 || binHt != (h + 63) / 64)
+				LIST_PROBLEM("0x%08x: render %ux%u needs %ux%u tiles not %ux%u\n", at, (unsigned)w, (unsigned)h,
+					(unsigned)((w + 63) / 64), (unsigned)((h + 63) / 64), (unsigned)binWth, (unsigned)binHt);
+			CHECK_RANGE(buf, w * h * bpp, "frame buffer");
+			break;
+		}
+		case GL_CLEAR_COLORS:
+			if (v->type != V3DLIST_RENDER) LIST_PROBLEM("0x%08x: clear colours in a binning list\n", at);
+			break;
+		case GL_TILE_COORDINATES:
+			if (v->type != V3DLIST_RENDER) LIST_PROBLEM("0x%08x: tile coordinates in a binning list\n", at);
+			if (!renderConfig && tileCoords == 0) LIST_PROBLEM("0x%08x: tile before render config\n", at);
+			if (tileOpen) LIST_PROBLEM("0x%08x: tile %u,%u was never stored\n", at, (unsigned)tileX, (unsigned)tileY);
+			if (frameEnded) {										// Report once, the frame is over
+				LIST_PROBLEM("0x%08x: tile after the end of frame store\n", at);
+				frameEnded = false;
+				extraTiles = true;
+			}
+			tileCoords++;
+			tileX = p[1];
+			tileY = p[2];
+			if (tileX >= binWth || tileY >= binHt)
+				LIST_PROBLEM("0x%08x: tile %u,%u outside the %ux%u grid\n", at, (unsigned)tileX, (unsigned)tileY, (unsigned)binWth, (unsigned)binHt);
+			tileOpen = true;
+			break;
+		case GL_BRANCH_TO_SUBLIST: {
+			uint32_t target = Get32(&p[1]);
+			if (v->type == V3DLIST_RENDER) {
+				if (!tileOpen) {
+					LIST_PROBLEM("0x%08x: sublist branch with no tile\n", at);
+				} else if (tileX < binWth && tileY < binHt) {
+					uint32_t tile = tileY * binWth + tileX;
+					if (v->tileAlloc && target != v->tileAlloc + tile * blockSize)
+						LIST_PROBLEM("0x%08x: tile %u,%u branches to 0x%08x not its block 0x%08x\n", at,
+							(unsigned)tileX, (unsigned)tileY, target, (unsigned)(v->tileAlloc + tile * blockSize));
+					if (tile < V3DLIST_MAX_TILES) {
+						if (tileSeen[tile]) LIST_PROBLEM("0x%08x: tile %u,%u rendered twice\n", at, (unsigned)tileX, (unsigned)tileY);
+						else tilesDone++;
+						tileSeen[tile] = 1;
+					}
+				}
+			}
+			CHECK_RANGE(target, blockSize, "sublist");
+			break;
+		}
+		case GL_BRANCH:
+			CHECK_RANGE(Get32(&p[1]), 1, "branch");
+			break;
+		case GL_STORE_TILE_BUFFER:
+		case GL_STORE_FULL_TILE_BUFFER:
+		case GL_STORE_MULTISAMPLE:
+		case GL_STORE_MULTISAMPLE_END:
+			if (v->type != V3DLIST_RENDER) LIST_PROBLEM("0x%08x: tile store in a binning list\n", at);
+			if (!tileOpen) LIST_PROBLEM("0x%08x: store with no tile\n", at);
+			if (p[0] == GL_STORE_TILE_BUFFER && (Get16(&p[1]) & 0x7) != 0)
+				CHECK_RANGE(Get32(&p[3]) & ~0xF, 16, "store");
+			tileOpen = false;
+			if (p[0] == GL_STORE_MULTISAMPLE_END) {
+				if (frameEnded || extraTiles) LIST_PROBLEM("0x%08x: second end of frame store\n", at);
+				else if (tilesDone != binWth * binHt)
+					LIST_PROBLEM("0x%08x: end of frame after %u of %u tiles\n", at, (unsigned)tilesDone, (unsigned)(binWth * binHt));
+				frameEnded = true;
+			}
+			break;
+		default:
+			break;
+		}
+		ofs += len;
+	}
+
+	if (v->type == V3DLIST_BINNING) {
+		if (!binStarted) LIST_PROBLEM("binning list never starts binning\n");
+		if (!flushed) LIST_PROBLEM("binning list does not flush after its last primitives\n");
+	} else {
+		if (!renderConfig) LIST_PROBLEM("render list has no render config\n");
+		if (tileOpen) LIST_PROBLEM("render list ends with tile %u,%u not stored\n", (unsigned)tileX, (unsigned)tileY);
+		if (!frameEnded && !extraTiles) LIST_PROBLEM("render list has no end of frame store (%u of %u tiles)\n",
+			(unsigned)tilesDone, (unsigned)(binWth * binHt));
+	}
+	return errors;
+}
+
+/*-[V3DList_Disassemble]----------------------------------------------------}
+. Prints size bytes of list (at VC4 address listVC4) one packet per line
+. followed by a packet count and byte total.
+. RETURN: Number of packets decoded
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Disassemble (const uint8_t* list, uint32_t size, uint32_t listVC4,
+							  int (*prn_handler) (const char *fmt, ...))
+{
+	uint32_t packets = 0;
+	uint32_t ofs = 0;
+	if (!prn_handler) return 0;
+	while (ofs < size) {
+		const uint8_t* p = &list[ofs];
+		uint32_t len = V3DList_PacketLength(p[0]);
+		if (len == 0 || len > size - ofs) {
+			prn_handler("0x%08x: ?? %02x (%u bytes left undecoded)\n", listVC4 + ofs, p[0], (unsigned)(size - ofs));
+			break;
+		}
+		prn_handler("0x%08x: %s", listVC4 + ofs, packetInfo[p[0]].name);
+		switch (p[0]) {
+		case GL_TILE_BINNING_CONFIG:
+			prn_handler(" alloc 0x%08x size 0x%x state 0x%08x tiles %ux%u flags 0x%02x",
+				Get32(&p[1]), Get32(&p[5]), Get32(&p[9]), p[13], p[14], p[15]);
+			break;
+		case GL_TILE_RENDER_CONFIG:
+			prn_handler(" buffer 0x%08x %ux%u mode 0x%04x", Get32(&p[1]), Get16(&p[5]), Get16(&p[7]), Get16(&p[9]));
+			break;
+		case GL_CLEAR_COLORS:
+			prn_handler(" colour 0x%08x 0x%08x z 0x%08x stencil %u", Get32(&p[1]), Get32(&p[5]), Get32(&p[9]), p[13]);
+			break;
+		case GL_TILE_COORDINATES:
+			prn_handler(" %u,%u", p[1], p[2]);
+			break;
+		case GL_STORE_TILE_BUFFER:
+		case GL_LOAD_TILE_BUFFER:
+			prn_handler(" flags 0x%04x addr 0x%08x", Get16(&p[1]), Get32(&p[3]));
+			break;
+		case GL_BRANCH:
+		case GL_BRANCH_TO_SUBLIST:
+		case GL_STORE_FULL_TILE_BUFFER:
+		case GL_RELOAD_FULL_TILE_BUFFER:
+		case GL_NV_SHADER_STATE:
+		case GL_VG_SHADER_STATE:
+			prn_handler(" 0x%08x", Get32(&p[1]));
+			break;
+		case GL_SHADER_STATE:
+			prn_handler(" record 0x%08x attribs %u", Get32(&p[1]) & ~0xF, Get32(&p[1]) & 0x7);
+			break;
+		case GL_INDEXED_PRIMITIVE_LIST:
+			prn_handler(" mode %u %s count %u indices 0x%08x max %u", p[1] & 0x0F,
+				(p[1] & INDEX_TYPE_16) ? "16bit" : "8bit", Get32(&p[2]), Get32(&p[6]), Get32(&p[10]));
+			break;
+		case GL_VERTEX_ARRAY_PRIMITIVES:
+			prn_handler(" mode %u count %u first %u", p[1] & 0x0F, Get32(&p[2]), Get32(&p[6]));
+			break;
+		case GL_PRIMITIVE_LIST_FORMAT:
+			prn_handler(" 0x%02x", p[1]);
+			break;
+		case GL_CONFIG_STATE:
+			prn_handler(" 0x%02x 0x%02x 0x%02x", p[1], p[2], p[3]);
+			break;
+		case GL_CLIP_WINDOW:
+			prn_handler(" %u,%u %ux%u", Get16(&p[1]), Get16(&p[3]), Get16(&p[5]), Get16(&p[7]));
+			break;
+		case GL_VIEWPORT_OFFSET:
+			prn_handler(" %d,%d", (int16_t)Get16(&p[1]), (int16_t)Get16(&p[3]));
+			break;
+		default:
+			for (uint32_t i = 1; i < len; i++) prn_handler(" %02x", p[i]);	// Raw payload bytes
+			break;
+		}
+		prn_handler("\n");
+		packets++;
+		ofs += len;
+	}
+	prn_handler("%u packets, %u bytes\n", (unsigned)packets, (unsigned)size);
+	return packets;
+}
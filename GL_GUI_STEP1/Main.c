@@ -25,11 +25,13 @@ int main (void) {
 	displaySmartStart(printf);										// Display smart start details
 	ARM_setmaxspeed(printf);										// ARM CPU to max speed no message to screen
 
-	Desktop_Start();
+	Desktop_Start(printf);											// Window scaling times to the screen then the desktop
 
 	while (1){
 		Move_Windows();
-		timer_wait(10000);	// 10000 usec delay
+		uint64_t tick = timer_getTickCount64();
+		while (tick_difference(tick, timer_getTickCount64()) < 10000)
+			V3D_PollFrames();	// 10000 usec delay, keep the queued frames moving
     }
 
 	// Release resources
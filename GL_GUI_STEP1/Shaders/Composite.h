@@ -0,0 +1,14 @@
+/* Generated from Composite.qasm by Host/QPUAs (make shaders), edit the .qasm not this */
+	0x158e7d80, 0x10020827,	/* mov r0, vary */
+	0x818e7176, 0x40024821,	/* fadd r0, r0, r5; mov r1, vary; sbwait */
+	0x019e7340, 0x10020867,	/* fadd r1, r1, r5 */
+	0x159e7240, 0x10020e67,	/* mov tmu0_t, r1 */
+	0x159e7000, 0x10020e27,	/* mov tmu0_s, r0 */
+	0x009e7000, 0xa00009e7,	/* nop; nop; ldtmu0 (src texel to r4) */
+	0x959e7924, 0x80024060,	/* mov ra1, r4; mov r0, r4; loadc (src to ra1 and r0, tile colour (dst) to r4) */
+	0x159e7900, 0x100208e7,	/* mov r3, r4 (dst) */
+	0x77067d86, 0x160248a0,	/* not r2, ra1.8dr; v8muld r0, r0, ra1.8dr (255 - a in every byte, src * a) */
+	0x609e701a, 0x100049e1,	/* nop; v8muld r1, r3, r2 (dst * (255 - a)) */
+	0x1e9e7040, 0x30020ba7,	/* v8adds tlbc, r0, r1; nop; thrend */
+	0x009e7000, 0x100009e7,	/* nop; nop; nop */
+	0x009e7000, 0x500009e7	/* nop; nop; sbdone */
@@ -0,0 +1,18 @@
+# Window compositing fragment shader, varyings 0,1 are s,t into the
+# window's surface texture (config in the 2 uniforms). The texel is
+# blended over the tile buffer colour by its alpha:
+#   out = src * a / 255 + dst * (255 - a) / 255   a byte at a time
+
+	mov r0, vary
+	fadd r0, r0, r5; mov r1, vary; sbwait
+	fadd r1, r1, r5
+	mov tmu0_t, r1
+	mov tmu0_s, r0
+	nop; nop; ldtmu0				# src texel to r4
+	mov ra1, r4; mov r0, r4; loadc			# src to ra1 and r0, tile colour (dst) to r4
+	mov r3, r4					# dst
+	not r2, ra1.8dr; v8muld r0, r0, ra1.8dr		# 255 - a in every byte, src * a
+	nop; v8muld r1, r3, r2				# dst * (255 - a)
+	v8adds tlbc, r0, r1; nop; thrend
+	nop; nop; nop
+	nop; nop; sbdone
@@ -4,6 +4,8 @@
 #include <ctype.h>
 #include "rpi-smartstart.h"						// Need for mailbox
 #include "rpi-GLES.h"
+#include "rpi-V3DList.h"						// Control list builder
+#include "rpi-Texture.h"						// Window surfaces to texture layout
 
 /* REFERENCES */
 /* https://docs.broadcom.com/docs/12358545 */
@@ -110,63 +112,6 @@
 #define ALIGN_128BIT_MASK  0xFFFFFF80
 
 
-/* primitive typoe in the GL pipline */
-typedef enum {
-	PRIM_POINT = 0,
-	PRIM_LINE = 1,
-	PRIM_LINE_LOOP = 2,
-	PRIM_LINE_STRIP = 3,
-	PRIM_TRIANGLE = 4,
-	PRIM_TRIANGLE_STRIP = 5,
-	PRIM_TRIANGLE_FAN = 6,
-} PRIMITIVE;
-
-/* GL pipe control commands */
-typedef enum {
-	GL_HALT = 0,
-	GL_NOP = 1,
-	GL_FLUSH = 4,
-	GL_FLUSH_ALL_STATE = 5,
-	GL_START_TILE_BINNING = 6,
-	GL_INCREMENT_SEMAPHORE = 7,
-	GL_WAIT_ON_SEMAPHORE = 8,
-	GL_BRANCH = 16,
-	GL_BRANCH_TO_SUBLIST = 17,
-	GL_RETURN_FROM_SUBLIST = 18,
-	GL_STORE_MULTISAMPLE = 24,
-	GL_STORE_MULTISAMPLE_END = 25,
-	GL_STORE_FULL_TILE_BUFFER = 26,
-	GL_RELOAD_FULL_TILE_BUFFER = 27,
-	GL_STORE_TILE_BUFFER = 28,
-	GL_LOAD_TILE_BUFFER = 29,
-	GL_INDEXED_PRIMITIVE_LIST = 32,
-	GL_VERTEX_ARRAY_PRIMITIVES = 33,
-	GL_VG_COORDINATE_ARRAY_PRIMITIVES = 41,
-	GL_COMPRESSED_PRIMITIVE_LIST = 48,
-	GL_CLIP_COMPRESSD_PRIMITIVE_LIST = 49,
-	GL_PRIMITIVE_LIST_FORMAT = 56,
-	GL_SHADER_STATE = 64,
-	GL_NV_SHADER_STATE = 65,
-	GL_VG_SHADER_STATE = 66,
-	GL_VG_INLINE_SHADER_RECORD = 67,
-	GL_CONFIG_STATE = 96,
-	GL_FLAT_SHADE_FLAGS = 97,
-	GL_POINTS_SIZE = 98,
-	GL_LINE_WIDTH = 99,
-	GL_RHT_X_BOUNDARY = 100,
-	GL_DEPTH_OFFSET = 101,
-	GL_CLIP_WINDOW = 102,
-	GL_VIEWPORT_OFFSET = 103,
-	GL_Z_CLIPPING_PLANES = 104,
-	GL_CLIPPER_XY_SCALING = 105,
-	GL_CLIPPER_Z_ZSCALE_OFFSET = 106, 
-	GL_TILE_BINNING_CONFIG = 112,
-	GL_TILE_RENDER_CONFIG = 113,
-	GL_CLEAR_COLORS = 114,
-	GL_TILE_COORDINATES = 115
-}  GL_CONTROL;
-
-
 struct __attribute__((__packed__, aligned(1))) EMITDATA {
 	uint8_t byte1;
 	uint8_t byte2;
@@ -197,6 +142,106 @@ typedef uint32_t GPU_HANDLE;
 typedef uint32_t VC4_ADDR;
 
 
+/*==========================================================================}
+{				 	  TEXTURE CONFIG BLOCK STRUCTURES 						}
+{==========================================================================*/
+
+/*--------------------------------------------------------------------------}
+{						  TEXTURE CONFIG BLOCK	 							}
+{--------------------------------------------------------------------------*/
+typedef union {
+	struct {
+		unsigned mip_levels : 4;									// @0-3		number of mipmap levels minus 1
+		unsigned texture_type : 4;								    // @4-7		texture type (TEXTURE_TYPE_xxx)
+		unsigned flip_y : 1;										// @8		0,1  top to bottom, bottom to top
+		unsigned cubemap : 1;										// @9		0,1  cube map mode off, on
+		unsigned cswiz : 2;											// @10-11	cache swizzle
+		unsigned base_addr : 20;									// @12-31	Texture base pointer in 4K blocks
+	};
+	uint32_t Raw32;													// Access whole 32bits at once
+} TEXTURE_CONFIG_BLOCK;
+
+#define TEXTURE_TYPE_RGBA8888	0							// 32 bit texels, the only type rpi-Texture lays out
+
+/*--------------------------------------------------------------------------}
+{						ENUMERATED T & S WRAP MODE							}
+{--------------------------------------------------------------------------*/
+/* In binary so any error is obvious */
+typedef enum {
+	WRAPMODE_REPEAT = 0b00,							// 0
+	WRAPMODE_CLAMP  = 0b01,							// 1
+	WRAPMODE_MIRROR = 0b10,							// 2
+	WRAPMODE_BORDER = 0b11,							// 3 
+} WRAP_MODE;
+
+/*--------------------------------------------------------------------------}
+{					    TEXTURE CONFIG PARAMETERS							}
+{--------------------------------------------------------------------------*/
+typedef union {
+	struct {
+		WRAP_MODE wrap_s : 2;										// @0-1		0,1,2,3   S wrap mode  (repeat, clamp mirror, border)
+		WRAP_MODE wrap_t : 2;									    // @2-3		0,1,2,3   T wrap mode  (repeat, clamp mirror, border)
+		unsigned minfilt : 3;										// @4-6		minification filter
+		unsigned magfilt : 1;										// @7		magnification filter
+		unsigned width : 11;										// @8-18	Image width (0-2048)
+		unsigned etcflip : 1;									    // @19		Flip etc Y
+		unsigned height : 11;										// @20-30	Image height (0-2048)
+		unsigned texture_type4 : 1;									// @31		Texture data type extended
+	};
+	uint32_t Raw32;													// Access whole 32bits at once
+} TEXTURE_CONFIG_PARAMS;
+
+/*--------------------------------------------------------------------------}
+{					   ENUMERATED TEXTURE FILTERS							}
+{--------------------------------------------------------------------------*/
+typedef enum {
+	MINFILT_LINEAR = 0,								// Bilinear, level 0 only
+	MINFILT_NEAREST = 1,							// Nearest, level 0 only
+	MINFILT_NEAR_MIP_NEAR = 2,						// Nearest in the nearest mipmap level
+	MINFILT_NEAR_MIP_LIN = 3,						// Nearest in the two nearest levels blended
+	MINFILT_LIN_MIP_NEAR = 4,						// Bilinear in the nearest mipmap level
+	MINFILT_LIN_MIP_LIN = 5,						// Trilinear
+} MIN_FILTER;
+
+#define MAGFILT_LINEAR		0						// Magnification filters
+#define MAGFILT_NEAREST		1
+
+
+/* Each frame in flight has a block of the binning memory holding its       */
+/* binning list then a slot per window (by window index, not z order) with  */
+/* the window's NV shader record, texture config uniforms and quad vertexes */
+/* A frame only rewrites the slots of windows changed since it last ran and */
+/* its list only when windows were added, removed or restacked.             */
+#define BINNING_LIST_FIXED		0x40			// List bytes before the windows (config, state, flush)
+#define BINNING_LIST_WINDOW		19				// List bytes a window adds (NV shader state, indexed list)
+#define BINNING_WINDOW_SIZE		0x80			// Bytes of a window slot
+#define WINDOW_SLOT_UNIFORMS	0x10			// Texture config uniforms offset in a slot
+#define WINDOW_SLOT_VERTEX		0x20			// Quad vertexes offset in a slot (128 bit aligned)
+#define WINDOW_VERTEX_SIZE		20				// X,Y 12.4, Z, 1/W, s, t
+#define TILE_BYTES_WINDOW		256				// Tile list bytes allowed a window (a few tiles of state and triangles)
+
+/*--------------------------------------------------------------------------}
+;{	  A WINDOW ... ARM DRAWN SURFACE COMPOSITED BY THE V3D AS A TEXTURE  	}
+;{-------------------------------------------------------------------------*/
+/* The surface is plain rows of texel words (R | G<<8 | B<<16 | A<<24) with */
+/* row 0 at the top. It is swizzled to one of two textures when it changes  */
+/* so the other can still be sampled by frames in flight.                   */
+typedef struct gui_window
+{
+	GPU_HANDLE handle;							// Memory of the textures and surface (0 = window not in use)
+	int x1, y1, x2, y2;							// Screen rectangle, the texture stretches to fit
+	uint32_t* surface;							// ARM address of the surface pixels, width a row
+	TEXTURE_LEVEL level;						// Layout of the surface as a texture
+	VC4_ADDR textureVC4[2];						// Level 0 of the two textures
+	uint32_t textureTicket[2];					// V3D ticket of the last frame sampling each texture
+	uint32_t texConfig[2];						// First texture config uniform of each texture
+	uint32_t texParams;							// Second texture config uniform (size, filters)
+	uint8_t current;							// Texture holding the surface as last uploaded
+	bool dirty;									// Surface changed since it was uploaded
+	uint32_t version;							// Bumped when the slot contents (rectangle, texture) change
+	uint32_t slotVersion[V3D_MAX_FRAMES];		// Version each frame's slot was last written with
+} GUI_WINDOW;
+
 /*--------------------------------------------------------------------------}
 ;{	    DEFINE A RENDER STRUCTURE ... WHICH JUST HOLD RENDER DETAILS	  	}
 ;{-------------------------------------------------------------------------*/
@@ -213,31 +258,46 @@ typedef struct render_t
 	uint16_t renderHt;							// Render height
 
 	VC4_ADDR shaderStart;						// VC4 address shader code starts 
-	VC4_ADDR fragShaderRecStart;				// VC4 start address for fragment shader record
+	VC4_ADDR quadIndexVC4;						// VC4 address of the 6 indexes every window quad uses
 
 	uint32_t binWth;							// Bin width
 	uint32_t binHt;								// Bin height
 
-	VC4_ADDR renderControlVC4;					// VC4 render control start address
-	VC4_ADDR renderControlEndVC4;				// VC4 render control end address
-
-	VC4_ADDR vertexVC4;							// VC4 address to vertex data
-	uint32_t num_verts;							// number of vertices 
+	VC4_ADDR renderControlVC4[V3D_MAX_FRAMES];	// VC4 render control start address of each frame
+	VC4_ADDR renderControlEndVC4[V3D_MAX_FRAMES];// VC4 render control end address of each frame
 
-	VC4_ADDR indexVertexVC4;					// VC4 address to start of index vertex data
-	uint32_t IndexVertexCt;						// Index vertex count
-	uint32_t MaxIndexVertex;					// Maximum Index vertex referenced
-
-	/* TILE DATA MEMORY ... HAS TO BE 4K ALIGN */
+	/* TILE DATA MEMORY ... HAS TO BE 4K ALIGN, ONE SET PER FRAME IN FLIGHT */
 	GPU_HANDLE tileHandle;						// Tile memory handle
 	uint32_t  tileMemSize;						// Tiel memory size;
-	VC4_ADDR tileStateDataVC4;					// Tile data VC4 locked address
-	VC4_ADDR tileDataBufferVC4;					// Tile data buffer VC4 locked address
+	VC4_ADDR tileStateDataVC4[V3D_MAX_FRAMES];	// Tile data VC4 locked address of each frame
+	VC4_ADDR tileDataBufferVC4[V3D_MAX_FRAMES];	// Tile data buffer VC4 locked address of each frame
 
-	/* BINNING DATA MEMORY ... HAS TO BE 4K ALIGN */
+	/* BINNING DATA MEMORY ... HAS TO BE 4K ALIGN, ONE BLOCK PER FRAME IN FLIGHT */
 	GPU_HANDLE binningHandle;					// Binning memory handle
-	VC4_ADDR binningDataVC4;					// Binning data VC4 locked address
-	VC4_ADDR binningCfgEnd;						// VC4 binning config end address
+	uint32_t binningListSize;					// Bytes of the list at the start of a frame's block
+	uint32_t binningFrameSize;					// Bytes of a frame's block, the list then the window slots
+	VC4_ADDR binningDataVC4[V3D_MAX_FRAMES];	// Binning list and window slots of each frame
+	VC4_ADDR binningCfgEnd[V3D_MAX_FRAMES];		// VC4 binning config end address of each frame
+	uint32_t listVersion[V3D_MAX_FRAMES];		// zVersion each frame's list was written for
+
+	/* FRAME QUEUE */
+	uint32_t frameSlot;							// Frame the next V3D_RenderScene uses
+	uint32_t frameTicket[V3D_MAX_FRAMES];		// V3D ticket last submitted from each frame
+
+	/* WINDOWS ... THE TABLE IS IN GPU MEMORY SIZED BY V3D_InitializeScene */
+	GPU_HANDLE windowHandle;					// Window table memory handle
+	GUI_WINDOW* window;							// maxWindows windows
+	uint16_t* zOrder;							// Window indexes bottom to top
+	uint32_t maxWindows;						// Windows the scene was made for
+	uint32_t windowCount;						// Windows in zOrder
+	uint32_t zVersion;							// Bumped when windows are added, removed or restacked
+
+	/* COUNTS */
+	uint32_t uploads;							// Surfaces uploaded to textures
+	uint32_t uploadUs;							// usec spent swizzling them
+	uint32_t slotWrites;						// Window slots rewritten
+	uint32_t listWrites;						// Binning lists rewritten
+	uint32_t prepareUs;							// usec V3D_RenderScene spent preparing frames (not waiting)
 
 } RENDER_STRUCT;
 
@@ -341,6 +401,194 @@ bool V3D_execute_qpu (int32_t num_qpus, uint32_t control, uint32_t noflush, uint
 		num_qpus, control, noflush, timeout));
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{                      V3D FRAME SUBMISSION QUEUE                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/* The binner (CT0) and renderer (CT1) are separate control list threads so */
+/* frame N+1 can bin while frame N renders as long as each frame in flight  */
+/* has its own tile memory and lists. Frames bin and render in submit order */
+/* and tickets count up from 1 so a frame is done when its ticket is at or  */
+/* below the last rendered ticket. The queue is advanced by V3D_PollFrames  */
+/* or by V3D_IrqHandler when the V3D interrupt is enabled.                  */
+#define V3D_INT_FRDONE		0x01									// Render frame done interrupt
+#define V3D_INT_FLDONE		0x02									// Binning flush done interrupt
+#define V3D_GPU_IRQ			10										// V3D is GPU IRQ 10 (bank 1)
+#define IRQ_ENABLE1 (*(volatile uint32_t*)(uintptr_t)(RPi_IO_Base_Addr + 0xB210))
+#define IRQ_DISABLE1 (*(volatile uint32_t*)(uintptr_t)(RPi_IO_Base_Addr + 0xB21C))
+
+static struct v3d_frame {
+	uint32_t ticket;												// Ticket of frame in this entry
+	uint32_t binStart;												// VC4 binning control list start
+	uint32_t binEnd;												// VC4 binning control list end
+	uint32_t renderStart;											// VC4 render control list start
+	uint32_t renderEnd;												// VC4 render control list end
+	V3D_FRAME_TIMES times;											// Timestamps of the frame
+} frameQ[V3D_MAX_FRAMES] = { 0 };
+
+static volatile uint32_t submitTicket = 0;							// Last ticket submitted
+static volatile uint32_t binTicket = 0;								// Ticket binning (0 = binner idle)
+static volatile uint32_t binnedTicket = 0;							// Last ticket binning completed
+static volatile uint32_t renderTicket = 0;							// Ticket rendering (0 = renderer idle)
+static volatile uint32_t doneTicket = 0;							// Last ticket rendering completed
+static bool frameIrq = false;										// V3D interrupt drives the queue
+
+/*--------------------------------------------------------------------------}
+{ Advances the queue, must not be re-entered (irq or interrupts disabled)   }
+{--------------------------------------------------------------------------*/
+static void AdvanceFrames (void)
+{
+	uint64_t now = timer_getTickCount64();
+	if (binTicket && v3d[V3D_BFC]) {								// Binner has flushed the frame
+		frameQ[binTicket % V3D_MAX_FRAMES].times.binDoneTick = now;
+		binnedTicket = binTicket;
+		binTicket = 0;
+	}
+	if (renderTicket && v3d[V3D_RFC]) {								// Renderer has finished the frame
+		frameQ[renderTicket % V3D_MAX_FRAMES].times.renderDoneTick = now;
+		doneTicket = renderTicket;
+		renderTicket = 0;
+	}
+	if ((binTicket == 0) && (binnedTicket < submitTicket)) {		// Binner idle and a frame is waiting
+		struct v3d_frame* f = &frameQ[(binnedTicket + 1) % V3D_MAX_FRAMES];
+		v3d[V3D_L2CACTL] = 4;										// Clear L2 cache
+		v3d[V3D_SLCACTL] = 0x0F0F0F0F;								// Clear slice caches
+		v3d[V3D_CT0CS] = 0x20;										// Stop the binning thread
+		while (v3d[V3D_CT0CS] & 0x20);								// Wait for it to stop
+		v3d[V3D_BFC] = 1;											// Reset binning frame count
+		f->times.binStartTick = timer_getTickCount64();
+		binTicket = f->ticket;
+		v3d[V3D_CT0CA] = f->binStart;								// Binning list start
+		v3d[V3D_CT0EA] = f->binEnd;									// Writing end address starts the thread
+	}
+	if ((renderTicket == 0) && (doneTicket < binnedTicket)) {		// Renderer idle and a frame is binned
+		struct v3d_frame* f = &frameQ[(doneTicket + 1) % V3D_MAX_FRAMES];
+		v3d[V3D_CT1CS] = 0x20;										// Stop the render thread
+		while (v3d[V3D_CT1CS] & 0x20);								// Wait for it to stop
+		v3d[V3D_RFC] = 1;											// Reset rendering frame count
+		f->times.renderStartTick = timer_getTickCount64();
+		renderTicket = f->ticket;
+		v3d[V3D_CT1CA] = f->renderStart;							// Render list start
+		v3d[V3D_CT1EA] = f->renderEnd;								// Writing end address starts the thread
+	}
+}
+
+/*-[ V3D_PollFrames ]------------------------------------------------------}
+. Non blocking, starts binning/rendering of queued frames as the hardware
+. frees up and retires finished ones.
+. RETURN: True if frames are still in flight, False if the V3D is idle
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_PollFrames (void)
+{
+	if (frameIrq) {													// Interrupt also advances the queue
+		DisableInterrupts();
+		AdvanceFrames();
+		EnableInterrupts();
+	} else AdvanceFrames();
+	return (doneTicket != submitTicket);
+}
+
+/*-[ V3D_SubmitFrame ]-----------------------------------------------------}
+. Queues a frame given its binning and render control lists and returns at
+. once unless V3D_MAX_FRAMES are already in flight. The caller must not
+. reuse the lists, tile memory or vertex data of a frame until it is done.
+. RETURN: Frame ticket (never 0)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3D_SubmitFrame (uint32_t binStart, uint32_t binEnd, uint32_t renderStart, uint32_t renderEnd)
+{
+	while (submitTicket - doneTicket >= V3D_MAX_FRAMES) V3D_PollFrames();	// Queue full wait for a frame
+	struct v3d_frame* f = &frameQ[(submitTicket + 1) % V3D_MAX_FRAMES];
+	f->ticket = submitTicket + 1;
+	f->binStart = binStart;
+	f->binEnd = binEnd;
+	f->renderStart = renderStart;
+	f->renderEnd = renderEnd;
+	f->times = (V3D_FRAME_TIMES) { 0 };
+	f->times.submitTick = timer_getTickCount64();
+	submitTicket = f->ticket;										// Frame is now visible to the queue
+	V3D_PollFrames();												// Start it if the binner is idle
+	return f->ticket;
+}
+
+/*-[ V3D_FrameDone ]-------------------------------------------------------}
+. Non blocking check if the frame with the ticket has finished rendering.
+. RETURN: True if done (ticket 0 is always done), False if still in flight
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_FrameDone (uint32_t ticket)
+{
+	if (ticket > doneTicket) V3D_PollFrames();						// Not done at last look so poll
+	return (ticket <= doneTicket);
+}
+
+/*-[ V3D_WaitFrame ]-------------------------------------------------------}
+. Waits until the frame with the ticket has finished rendering.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_WaitFrame (uint32_t ticket)
+{
+	while (!V3D_FrameDone(ticket)) {};
+}
+
+/*-[ V3D_WaitIdle ]--------------------------------------------------------}
+. Waits until every submitted frame has finished rendering.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_WaitIdle (void)
+{
+	V3D_WaitFrame(submitTicket);
+}
+
+/*-[ V3D_GetFrameTimes ]---------------------------------------------------}
+. Copies the usec timestamps of a finished frame, only the last
+. V3D_MAX_FRAMES tickets are held.
+. RETURN: True times copied, False frame not done or no longer held
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_GetFrameTimes (uint32_t ticket, V3D_FRAME_TIMES* times)
+{
+	struct v3d_frame* f = &frameQ[ticket % V3D_MAX_FRAMES];
+	if ((ticket == 0) || (!V3D_FrameDone(ticket)) || (f->ticket != ticket) || (!times)) return false;
+	*times = f->times;
+	return true;
+}
+
+/*-[ V3D_IrqHandler ]------------------------------------------------------}
+. Call from the irq handler, services the V3D binning/render done interrupt
+. and advances the queue.
+. RETURN: True if the V3D interrupt was serviced, False it was not the V3D
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_IrqHandler (void)
+{
+	uint32_t status = v3d[V3D_INTCTL] & (V3D_INT_FRDONE | V3D_INT_FLDONE);
+	if (status == 0) return false;									// Not ours
+	v3d[V3D_INTCTL] = status;										// Write 1s to clear
+	AdvanceFrames();												// Already in irq so no lock
+	return true;
+}
+
+/*-[ V3D_EnableFrameIrq ]--------------------------------------------------}
+. Enables or disables the V3D binning/render done interrupt driving the
+. queue. The irq handler must call V3D_IrqHandler when enabled.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3D_EnableFrameIrq (bool enable)
+{
+	if (enable) {
+		v3d[V3D_INTCTL] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// Clear anything stale
+		v3d[V3D_INTENA] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// V3D raises irq on flush and frame done
+		frameIrq = true;
+		IRQ_ENABLE1 = (1 << V3D_GPU_IRQ);							// Enable GPU irq 10 at the ARM
+	} else {
+		IRQ_DISABLE1 = (1 << V3D_GPU_IRQ);							// Disable GPU irq 10 at the ARM
+		v3d[V3D_INTDIS] = V3D_INT_FRDONE | V3D_INT_FLDONE;			// V3D stops raising them
+		frameIrq = false;
+	}
+}
+
 static void emit_uint8_t(uint8_t **list, uint8_t d) {
 	*((*list)++) = d;
 }
@@ -368,49 +616,96 @@ static void emit_float(uint8_t **list, float f) {
 }
 
 
-bool V3D_InitializeScene (RENDER_STRUCT* scene, uint32_t renderWth, uint32_t renderHt )
+/*--------------------------------------------------------------------------}
+{ Unlocks and frees a scene or window memory handle, a zero handle is       }
+{ skipped and the handle is zeroed so it is never released twice.           }
+{--------------------------------------------------------------------------*/
+static void SceneMemRelease (GPU_HANDLE* handle)
 {
-	if (scene) 
-	{
-		scene->rendererHandle = V3D_mem_alloc(0x10000, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
-		if (!scene->rendererHandle) return false;
-		scene->rendererDataVC4 = V3D_mem_lock(scene->rendererHandle);
-		scene->loadpos = scene->rendererDataVC4;					// VC4 load from start of memory
+	if (*handle) {
+		V3D_mem_unlock(*handle);									// Fails harmlessly if it never locked
+		V3D_mem_free(*handle);
+		*handle = 0;
+	}
+}
 
+/*-[ V3D_InitializeScene ]--------------------------------------------------}
+. Allocates the renderer, tile and binning memory of a renderWth x renderHt
+. scene for up to maxWindows windows. Each frame's binning block and tile
+. memory grow with maxWindows. If any allocation or lock fails the memory
+. already taken is released again and all four handles are left zero.
+. RETURN: True scene made, False no memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_InitializeScene (RENDER_STRUCT* scene, uint32_t renderWth, uint32_t renderHt, uint32_t maxWindows)
+{
+	if ((scene) && (maxWindows > 0) && (maxWindows <= 0xFFFF))
+	{
+		scene->maxWindows = maxWindows;
 		scene->renderWth = renderWth;								// Render width
 		scene->renderHt = renderHt;									// Render height
 		scene->binWth = (renderWth + 63) / 64;						// Tiles across 
 		scene->binHt = (renderHt + 63) / 64;						// Tiles down 
+		scene->tileMemSize = (scene->binWth * scene->binHt * 32 + maxWindows * TILE_BYTES_WINDOW + 0xFFF) & ~0xFFF;// Every window adds to the lists of the tiles it covers
+		scene->binningListSize = (BINNING_LIST_FIXED + maxWindows * BINNING_LIST_WINDOW + 127) & ALIGN_128BIT_MASK;
+		scene->binningFrameSize = scene->binningListSize + maxWindows * BINNING_WINDOW_SIZE;
 
-		scene->tileMemSize = 0x4000;
-		scene->tileHandle = V3D_mem_alloc(scene->tileMemSize + 0x4000, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
-		scene->tileStateDataVC4 = V3D_mem_lock(scene->tileHandle);
-		scene->tileDataBufferVC4 = scene->tileStateDataVC4 + 0x4000;
-
-		scene->binningHandle = V3D_mem_alloc(0x10000, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
-		scene->binningDataVC4 = V3D_mem_lock(scene->binningHandle);
-		return true;
-	}
-	return false;
-}
-
-bool V3D_AddVertexesToScene (RENDER_STRUCT* scene, int vertex_count)
-{
-	if (scene) 
-	{
-		scene->vertexVC4 = (scene->loadpos + 127) & ALIGN_128BIT_MASK;	// Hold vertex start adderss .. aligned to 128bits
+		scene->windowHandle = V3D_mem_alloc(maxWindows * (sizeof(GUI_WINDOW) + sizeof(uint16_t)), 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+		scene->rendererHandle = V3D_mem_alloc(0x10000, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+		scene->tileHandle = V3D_mem_alloc((scene->tileMemSize + 0x4000) * V3D_MAX_FRAMES, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+		scene->binningHandle = V3D_mem_alloc(scene->binningFrameSize * V3D_MAX_FRAMES, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+		VC4_ADDR windowVC4 = (scene->windowHandle) ? V3D_mem_lock(scene->windowHandle) : 0;
+		VC4_ADDR rendererVC4 = (scene->rendererHandle) ? V3D_mem_lock(scene->rendererHandle) : 0;
+		VC4_ADDR tileVC4 = (scene->tileHandle) ? V3D_mem_lock(scene->tileHandle) : 0;
+		VC4_ADDR binningVC4 = (scene->binningHandle) ? V3D_mem_lock(scene->binningHandle) : 0;
+		if ((!windowVC4) || (!rendererVC4) || (!tileVC4) || (!binningVC4)) {// An allocation or lock failed
+			SceneMemRelease(&scene->binningHandle);					// Release in reverse order
+			SceneMemRelease(&scene->tileHandle);
+			SceneMemRelease(&scene->rendererHandle);
+			SceneMemRelease(&scene->windowHandle);
+			return false;
+		}
 
-		scene->loadpos = scene->vertexVC4 + (vertex_count * 24);		// Update load position for vertex_count * 24 (2+2+4+4+4+4+4 bytes)
+		scene->window = (GUI_WINDOW*)(uintptr_t)GPUaddrToARMaddr(windowVC4);
+		scene->zOrder = (uint16_t*)&scene->window[maxWindows];
+		scene->windowCount = 0;
+		scene->zVersion = 1;										// Every frame's list needs writing
+		scene->rendererDataVC4 = rendererVC4;
+		scene->loadpos = scene->rendererDataVC4;					// VC4 load from start of memory
 
-		scene->indexVertexVC4 = (scene->loadpos + 127) & ALIGN_128BIT_MASK;// Hold index vertex start adderss .. align it to 128 bits
+		for (int i = 0; i < V3D_MAX_FRAMES; i++) {					// Split the memory between the frames
+			scene->tileStateDataVC4[i] = tileVC4 + i * (scene->tileMemSize + 0x4000);
+			scene->tileDataBufferVC4[i] = scene->tileStateDataVC4[i] + 0x4000;
+			scene->binningDataVC4[i] = binningVC4 + i * scene->binningFrameSize;
+		}
 
-		scene->loadpos = scene->indexVertexVC4 + (vertex_count * 6);	// Move loaad pos to new position
+		// Every window is the same two triangles of its own 4 vertexes
+		scene->quadIndexVC4 = (scene->loadpos + 127) & ALIGN_128BIT_MASK;// Hold index start adderss .. align it to 128 bits
+		uint8_t* p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->quadIndexVC4);
+		emit_uint16_t(&p, 0);										// quad - top left
+		emit_uint16_t(&p, 3);										// quad - bottom left
+		emit_uint16_t(&p, 1);										// quad - top right
+		emit_uint16_t(&p, 3);										// quad - bottom left
+		emit_uint16_t(&p, 2);										// quad - bottom right
+		emit_uint16_t(&p, 1);										// quad - top right
+		scene->loadpos = scene->quadIndexVC4 + 12;					// Move load pos past the indexes
 		return true;
 	}
 	return false;
 }
 
 
+static void EmitShaderRecord (uint8_t **list, RENDER_STRUCT* scene, VC4_ADDR uniformsVC4, VC4_ADDR vertexVC4)
+{
+	emit_uint8_t(list, 0x01);										// flags
+	emit_uint8_t(list, WINDOW_VERTEX_SIZE);							// stride
+	emit_uint8_t(list, 0xcc);										// num uniforms (not used)
+	emit_uint8_t(list, 2);											// num varyings (s, t)
+	emit_uint32_t(list, scene->shaderStart);						// Shader code address
+	emit_uint32_t(list, uniformsVC4);								// Fragment shader uniforms (texture config)
+	emit_uint32_t(list, vertexVC4);									// Vertex Data
+}
+
 bool V3D_AddShadderToScene (RENDER_STRUCT* scene, uint32_t* frag_shader, uint32_t frag_shader_emits)
 {
 	if (scene)
@@ -423,22 +718,6 @@ bool V3D_AddShadderToScene (RENDER_STRUCT* scene, uint32_t* frag_shader, uint32_
 			emit_uint32_t(&p, frag_shader[i]);						// Emit fragment shader into our allocated memory
 
 		scene->loadpos = scene->shaderStart + (p - q);				// Update load position
-
-		scene->fragShaderRecStart = (scene->loadpos + 127) & ALIGN_128BIT_MASK;// Hold frag shader start adderss .. .aligned to 128bits
-		p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->fragShaderRecStart);
-		q = p;
-
-		// Okay now we need Shader Record to buffer
-		emit_uint8_t(&p, 0x01);										// flags
-		emit_uint8_t(&p, 6 * 4);									// stride
-		emit_uint8_t(&p, 0xcc);										// num uniforms (not used)
-		emit_uint8_t(&p, 3);										// num varyings
-		emit_uint32_t(&p, scene->shaderStart);						// Shader code address
-		emit_uint32_t(&p, 0);										// Fragment shader uniforms (not in use)
-		emit_uint32_t(&p, scene->vertexVC4);						// Vertex Data
-
-		scene->loadpos = scene->fragShaderRecStart + (p - q);		// Adjust VC4 load poistion
-
 		return true;
 	}
 	return false;
@@ -449,302 +728,331 @@ bool V3D_SetupRenderControl (RENDER_STRUCT* scene, VC4_ADDR renderBufferAddr)
 {
 	if (scene)
 	{
-		scene->renderControlVC4 = (scene->loadpos + 127) & ALIGN_128BIT_MASK;// Hold render control start adderss .. aligned to 128 bits
-		uint8_t *p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->renderControlVC4); // ARM address for load
-		uint8_t *q = p;												// Hold start address
-
-		// Clear colors
-		emit_uint8_t(&p, GL_CLEAR_COLORS);
-		emit_uint32_t(&p, 0xff000000);								// Opaque Black
-		emit_uint32_t(&p, 0xff000000);								// 32 bit clear colours need to be repeated twice
-		emit_uint32_t(&p, 0);
-		emit_uint8_t(&p, 0);
-
-		// Tile Rendering Mode Configuration
-		emit_uint8_t(&p, GL_TILE_RENDER_CONFIG);
-
-		emit_uint32_t(&p, renderBufferAddr);						// render address (will be framebuffer)
-
-		emit_uint16_t(&p, scene->renderWth);						// render width
-		emit_uint16_t(&p, scene->renderHt);							// render height
-		emit_uint8_t(&p, 0x04);										// framebuffer mode (linear rgba8888)
-		emit_uint8_t(&p, 0x00);
-
-		// Do a store of the first tile to force the tile buffer to be cleared
-		// Tile Coordinates
-		emit_uint8_t(&p, GL_TILE_COORDINATES);
-		emit_uint8_t(&p, 0);
-		emit_uint8_t(&p, 0);
-
-		// Store Tile Buffer General
-		emit_uint8_t(&p, GL_STORE_TILE_BUFFER);
-		emit_uint16_t(&p, 0);										// Store nothing (just clear)
-		emit_uint32_t(&p, 0);										// no address is needed
-
-		// Link all binned lists together
-		for (int x = 0; x < scene->binWth; x++) {
-			for (int y = 0; y < scene->binHt; y++) {
-
-				// Tile Coordinates
-				emit_uint8_t(&p, GL_TILE_COORDINATES);
-				emit_uint8_t(&p, x);
-				emit_uint8_t(&p, y);
-
-				// Call Tile sublist
-				emit_uint8_t(&p, GL_BRANCH_TO_SUBLIST);
-				emit_uint32_t(&p, scene->tileDataBufferVC4 + (y * scene->binWth + x) * 32);
-
-				// Last tile needs a special store instruction
-				if (x == (scene->binWth - 1) && (y == scene->binHt - 1)) {
-					// Store resolved tile color buffer and signal end of frame
-					emit_uint8_t(&p, GL_STORE_MULTISAMPLE_END);
-				}
-				else {
-					// Store resolved tile color buffer
-					emit_uint8_t(&p, GL_STORE_MULTISAMPLE);
-				}
-			}
+		for (int frame = 0; frame < V3D_MAX_FRAMES; frame++) {		// Each frame has its own tile data to branch to
+			scene->renderControlVC4[frame] = (scene->loadpos + 127) & ALIGN_128BIT_MASK;// Hold render control start adderss .. aligned to 128 bits
+			V3D_LIST list;
+			V3DList_Init(&list, (void*)(uintptr_t)GPUaddrToARMaddr(scene->renderControlVC4[frame]), // ARM address for load
+				scene->renderControlVC4[frame], scene->rendererDataVC4 + 0x10000 - scene->renderControlVC4[frame]);
+
+			// Clear, render config then every tile branching to this frame's tile data
+			V3DList_RenderTiles(&list, 0xff000000,						// Opaque Black
+				renderBufferAddr,											// render address (will be framebuffer)
+				scene->renderWth, scene->renderHt,
+				0x04,													// framebuffer mode (linear rgba8888)
+				scene->binWth, scene->binHt, scene->tileDataBufferVC4[frame]);
+			if (list.overflow) return false;							// Renderer memory is full
+
+			scene->loadpos = V3DList_EndVC4(&list);					// Adjust VC4 load poistion
+			scene->renderControlEndVC4[frame] = scene->loadpos;			// Hold end of render control data
 		}
 
-		scene->loadpos = scene->renderControlVC4 + (p - q);			// Adjust VC4 load poistion
-		scene->renderControlEndVC4 = scene->loadpos;				// Hold end of render control data
-
 		return true;
 	}
 	return false;
 }
 
+/*--------------------------------------------------------------------------}
+{ Writes a window's 4 vertexes, the screen rectangle with s,t running 0 to  }
+{ 1 across and down so texel row 0 (the surface top) is at the top.         }
+{--------------------------------------------------------------------------*/
+static void EmitWindowQuad (uint8_t **p, const GUI_WINDOW* win)
+{
+	static const uint8_t corner[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };	// TL, TR, BR, BL
+	for (int i = 0; i < 4; i++) {
+		int x = corner[i][0] ? win->x2 : win->x1;
+		int y = corner[i][1] ? win->y2 : win->y1;
+		x = (x < -2048) ? -2048 : (x > 2047) ? 2047 : x;			// Signed 12.4 range, the clip window does the rest
+		y = (y < -2048) ? -2048 : (y > 2047) ? 2047 : y;
+		emit_uint16_t(p, (uint16_t)(x * 16));						// X in 12.4 fixed point
+		emit_uint16_t(p, (uint16_t)(y * 16));						// Y in 12.4 fixed point
+		emit_float(p, 1.0f);										// Z
+		emit_float(p, 1.0f);										// 1/W
+		emit_float(p, corner[i][0]);								// Varying 0 (s)
+		emit_float(p, corner[i][1]);								// Varying 1 (t)
+	}
+}
 
-bool V3D_SetupBinningConfig (RENDER_STRUCT* scene) 
+/*--------------------------------------------------------------------------}
+{ Writes a window's slot in a frame's block: its shader record, texture     }
+{ config uniforms and quad. Only the vertexes and the texture config of a   }
+{ window go into a frame, the pixels stay in the textures.                  }
+{--------------------------------------------------------------------------*/
+static void EmitWindowSlot (RENDER_STRUCT* scene, int frame, uint32_t window_index)
 {
-	if (scene)
-	{
-		uint8_t *p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->binningDataVC4); // ARM address for binning data load
-		uint8_t *list = p;												// Hold start address
-
-		emit_uint8_t(&p, GL_TILE_BINNING_CONFIG);						// tile binning config control 
-		emit_uint32_t(&p, scene->tileDataBufferVC4);					// tile allocation memory address
-		emit_uint32_t(&p, scene->tileMemSize);							// tile allocation memory size
-		emit_uint32_t(&p, scene->tileStateDataVC4);						// Tile state data address
-		emit_uint8_t(&p, scene->binWth);								// renderWidth/64
-		emit_uint8_t(&p, scene->binHt);									// renderHt/64
-		emit_uint8_t(&p, 0x04);											// config
-
-		// Start tile binning.
-		emit_uint8_t(&p, GL_START_TILE_BINNING);						// Start binning command
-
-		// Primitive type
-		emit_uint8_t(&p, GL_PRIMITIVE_LIST_FORMAT);
-		emit_uint8_t(&p, 0x32);											// 16 bit triangle
-
-		// Clip Window
-		emit_uint8_t(&p, GL_CLIP_WINDOW);								// Clip window 
-		emit_uint16_t(&p, 0);											// 0
-		emit_uint16_t(&p, 0);											// 0
-		emit_uint16_t(&p, scene->renderWth);							// width
-		emit_uint16_t(&p, scene->renderHt);								// height
-
-		// GL State
-		emit_uint8_t(&p, GL_CONFIG_STATE);
-		emit_uint8_t(&p, 0x03);											// enable both foward and back facing polygons
-		emit_uint8_t(&p, 0x00);											// depth testing disabled
-		emit_uint8_t(&p, 0x02);											// enable early depth write
-
-		// Viewport offset
-		emit_uint8_t(&p, GL_VIEWPORT_OFFSET);							// Viewport offset
-		emit_uint16_t(&p, 0);											// 0
-		emit_uint16_t(&p, 0);											// 0
-
-		// The triangle
-		// No Vertex Shader state (takes pre-transformed vertexes so we don't have to supply a working coordinate shader.)
-		emit_uint8_t(&p, GL_NV_SHADER_STATE);
-		emit_uint32_t(&p, scene->fragShaderRecStart);					// Shader Record
-
-		// primitive index list
-#define INDEX_TYPE_8  0x00   //  Indexed_Primitive_List: Index Type = 8 - Bit
-#define INDEX_TYPE_16 0x10   //  Indexed_Primitive_List: Index Type = 16 - Bit
-		emit_uint8_t(&p, GL_INDEXED_PRIMITIVE_LIST);					// Indexed primitive list command
-		emit_uint8_t(&p, PRIM_TRIANGLE | INDEX_TYPE_16);				// 8bit index, triangles
-		emit_uint32_t(&p, scene->IndexVertexCt);						// Number of index vertex
-		emit_uint32_t(&p, scene->indexVertexVC4);						// Address of index vertex data
-		emit_uint32_t(&p, scene->MaxIndexVertex);						// Maximum index
-
-
-		// End of bin list
-		// So Flush
-		emit_uint8_t(&p, GL_FLUSH_ALL_STATE);
-		// Nop
-		emit_uint8_t(&p, GL_NOP);
-		// Halt
-		emit_uint8_t(&p, GL_HALT);
-		scene->binningCfgEnd = scene->binningDataVC4 + (p-list);		// Hold binning data end address
+	const GUI_WINDOW* win = &scene->window[window_index];
+	VC4_ADDR slotVC4 = scene->binningDataVC4[frame] + scene->binningListSize + window_index * BINNING_WINDOW_SIZE;
+	uint8_t *p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(slotVC4);
+	EmitShaderRecord(&p, scene, slotVC4 + WINDOW_SLOT_UNIFORMS, slotVC4 + WINDOW_SLOT_VERTEX);
+	p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(slotVC4 + WINDOW_SLOT_UNIFORMS);
+	emit_uint32_t(&p, win->texConfig[win->current]);				// Texture the surface was last uploaded to
+	emit_uint32_t(&p, win->texParams);
+	p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(slotVC4 + WINDOW_SLOT_VERTEX);
+	EmitWindowQuad(&p, win);
+}
 
-		return true;
+/*--------------------------------------------------------------------------}
+{ Writes the frame's binning list, the shader state and quad of each window }
+{ bottom to top so the V3D draws them in z order, each blending over what   }
+{ is below it in the tile buffer. The list only points at the slots so it  }
+{ stays good while windows move or their surfaces change.                   }
+{--------------------------------------------------------------------------*/
+static bool EmitBinningList (RENDER_STRUCT* scene, int frame)
+{
+	V3D_LIST list;
+	V3DList_Init(&list, (void*)(uintptr_t)GPUaddrToARMaddr(scene->binningDataVC4[frame]), // ARM address for binning data load
+		scene->binningDataVC4[frame], scene->binningListSize);		// List runs up to the window slots
+
+	V3DList_TileBinningConfig(&list, scene->tileDataBufferVC4[frame],// tile allocation memory address
+		scene->tileMemSize, scene->tileStateDataVC4[frame],			// tile allocation memory size, tile state address
+		scene->binWth, scene->binHt, 0x04);							// renderWidth/64, renderHt/64, config
+	V3DList_StartTileBinning(&list);								// Start binning command
+
+	V3DList_PrimitiveListFormat(&list, 0x32);						// 16 bit triangle
+	V3DList_ClipWindow(&list, 0, 0, scene->renderWth, scene->renderHt);
+	V3DList_ConfigState(&list, 0x03, 0x00, 0x02);					// both faces, depth test off, early depth write
+	V3DList_ViewportOffset(&list, 0, 0);
+
+	// The windows
+	// No Vertex Shader state (takes pre-transformed vertexes so we don't have to supply a working coordinate shader.)
+	for (uint32_t i = 0; i < scene->windowCount; i++) {
+		VC4_ADDR slotVC4 = scene->binningDataVC4[frame] + scene->binningListSize + scene->zOrder[i] * BINNING_WINDOW_SIZE;
+		V3DList_NVShaderState(&list, slotVC4);
+		V3DList_IndexedPrimitiveList(&list, PRIM_TRIANGLE | INDEX_TYPE_16,	// 16bit index, triangles
+			6, scene->quadIndexVC4, 3);
 	}
-	return false;
+
+	// End of bin list
+	V3DList_FlushAllState(&list);
+	V3DList_Nop(&list);
+	V3DList_Halt(&list);
+	scene->binningCfgEnd[frame] = V3DList_EndVC4(&list);			// Hold binning data end address
+	return !list.overflow;
 }
 
+/*--------------------------------------------------------------------------}
+{ Swizzles a changed surface into the window's other texture, first waiting }
+{ for the last frame that sampled that texture. Frames in flight keep the   }
+{ texture they were given so a surface never changes under a render.       }
+{--------------------------------------------------------------------------*/
+static void UploadWindow (RENDER_STRUCT* scene, GUI_WINDOW* win)
+{
+	uint32_t next = win->current ^ 1;
+	V3D_WaitFrame(win->textureTicket[next]);						// Still being sampled wait for it
+	uint64_t t = timer_getTickCount64();
+	Texture_Swizzle((void*)(uintptr_t)GPUaddrToARMaddr(win->textureVC4[next]), &win->level,
+		win->surface, win->level.width);
+	scene->uploadUs += tick_difference(t, timer_getTickCount64());
+	scene->uploads++;
+	win->current = next;
+	win->dirty = false;
+	win->version++;													// Slots must point at the new texture
+}
 
 
 /*-[ V3D_RenderScene ]------------------------------------------------------}
-. Pretty obvious asks the VC4 to renders the given scene
+. Asks the VC4 to composite the windows as they stand. Surfaces changed
+. since the last frame are uploaded to their textures, the next of the
+. V3D_MAX_FRAMES frames gets the slots of the windows changed since it last
+. ran (and a new binning list if windows were added, removed or restacked)
+. and it is queued with its render list, which never changes. This only
+. waits if that frame (or a texture being replaced) is still in flight. The
+. windows can be changed for the next frame as soon as this returns while
+. the V3D bins and renders this one.
+. RETURN: V3D ticket of the queued frame, 0 for no scene
+. 19Oct26 LdB
 .--------------------------------------------------------------------------*/
-void V3D_RenderScene (RENDER_STRUCT* scene) 
+uint32_t V3D_RenderScene (RENDER_STRUCT* scene) 
 {
 	if (scene) {
-		// clear caches
-		v3d[V3D_L2CACTL] = 4;
-		v3d[V3D_SLCACTL] = 0x0F0F0F0F;
-
-		// stop the thread
-		v3d[V3D_CT0CS] = 0x20;
-		// wait for it to stop
-		while (v3d[V3D_CT0CS] & 0x20);
-
-		// Run our control list
-		v3d[V3D_BFC] = 1;											// reset binning frame count
-		v3d[V3D_CT0CA] = scene->binningDataVC4;						// Start binning config address
-		v3d[V3D_CT0EA] = scene->binningCfgEnd;						// End binning config address is at render control start
-
-		// wait for binning to finish
-		while (v3d[V3D_BFC] == 0) {}
-
-		// stop the thread
-		v3d[V3D_CT1CS] = 0x20;
-
-		// Wait for thread to stop
-		while (v3d[V3D_CT1CS] & 0x20);
-
-		// Run our render
-		v3d[V3D_RFC] = 1;											// reset rendering frame count
-		v3d[V3D_CT1CA] = scene->renderControlVC4;					// Start address for render control
-		v3d[V3D_CT1EA] = scene->renderControlEndVC4;				// End address for render control
-
-		// wait for render to finish
-		while (v3d[V3D_RFC] == 0) {}
-
+		int frame = scene->frameSlot;
+		V3D_WaitFrame(scene->frameTicket[frame]);					// Wait if this frame is still in flight
+		uint64_t t = timer_getTickCount64();
+
+		// Only the surfaces that changed go to the GPU and only the slots that changed to the frame
+		for (uint32_t i = 0; i < scene->windowCount; i++) {
+			uint32_t index = scene->zOrder[i];
+			GUI_WINDOW* win = &scene->window[index];
+			if (win->dirty) UploadWindow(scene, win);
+			if (win->slotVersion[frame] != win->version) {
+				EmitWindowSlot(scene, frame, index);
+				win->slotVersion[frame] = win->version;
+				scene->slotWrites++;
+			}
+		}
+		if (scene->listVersion[frame] != scene->zVersion) {		// Windows added, removed or restacked
+			if (!EmitBinningList(scene, frame)) return 0;			// Too many windows for the list
+			scene->listVersion[frame] = scene->zVersion;
+			scene->listWrites++;
+		}
+		scene->prepareUs += tick_difference(t, timer_getTickCount64());
+
+		// Queue it, the binner starts as soon as it has finished the last frame
+		uint32_t ticket = V3D_SubmitFrame(scene->binningDataVC4[frame], scene->binningCfgEnd[frame],
+			scene->renderControlVC4[frame], scene->renderControlEndVC4[frame]);
+		for (uint32_t i = 0; i < scene->windowCount; i++) {			// Textures this frame samples
+			GUI_WINDOW* win = &scene->window[scene->zOrder[i]];
+			win->textureTicket[win->current] = ticket;
+		}
+		scene->frameTicket[frame] = ticket;
+		scene->frameSlot = (frame + 1) % V3D_MAX_FRAMES;			// Next frame uses next slot
+		return ticket;
 	}
+	return 0;
 }
 
-
-
+/*-[ V3D_AddWindowToScene ]-------------------------------------------------}
+. Makes window window_index on top of the others at x1,y1 - x2,y2 with a
+. surface of that size filled with colour (rgbAlpha is the opacity). The
+. surface and its two textures get their own GPU memory.
+. RETURN: True window made, False bad index/size, in use or no memory
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
 bool V3D_AddWindowToScene (RENDER_STRUCT* scene, int window_index, int x1, int y1, int x2, int y2, RGBA colour)
 {
-	if (scene)
+	TEXTURE_LAYOUT layout;
+	if ((scene) && (window_index >= 0) && (window_index < scene->maxWindows)
+		&& (scene->window[window_index].handle == 0) && (x2 > x1) && (y2 > y1)
+		&& Texture_Layout(&layout, x2 - x1, y2 - y1, false))		// Surface as a texture, no mipmaps so any size
 	{
-		double r, g, b;
-		uint16_t xa, ya, xb, yb;
-		uint8_t * p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->vertexVC4); // Start of vertex index
-		p += (window_index * (4 * 24));									// Adjust vertex position
-
-		r = colour.rgbRed;
-		r /= 255.0;
-		g = colour.rgbGreen;
-		g /= 255.0;
-		b = colour.rgbBlue;
-		b /= 255.0;
-
-		xa = (x1 < 0) ? 0 : (x1 > 0xFFFF) ? 0xFFFF : x1;
-		ya = (y1 < 0) ? 0 : (y1 > 0xFFFF) ? 0xFFFF : y1;
-		xb = (x2 < 0) ? 0 : (x2 > 0xFFFF) ? 0xFFFF : x2;
-		yb = (y2 < 0) ? 0 : (y2 > 0xFFFF) ? 0xFFFF : y2;
-
-
-		// Vertex: Top left
-		emit_uint16_t(&p, xa << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, ya << 4);										// Y in 12.4 fixed point
-		emit_float(&p, 1.0f);											// Z
-		emit_float(&p, 1.0f);											// 1/W
-		emit_float(&p, r);												// Varying 0 (Red)
-		emit_float(&p, g);												// Varying 1 (Green)
-		emit_float(&p, b);												// Varying 2 (Blue)
-
-		// Vertex: top right
-		emit_uint16_t(&p, xb << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, ya << 4);										// Y in 12.4 fixed point
-		emit_float(&p, 1.0f);											// Z
-		emit_float(&p, 1.0f);											// 1/W
-		emit_float(&p, r);												// Varying 0 (Red)
-		emit_float(&p, g);												// Varying 1 (Green)
-		emit_float(&p, b);												// Varying 2 (Blue)
-
-		// Vertex: bottom right 
-		emit_uint16_t(&p, xb << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, yb << 4);										// Y in 12.4 fixed point
-		emit_float(&p, 1.0f);											// Z
-		emit_float(&p, 1.0f);											// 1/W
-		emit_float(&p, r);												// Varying 0 (Red)
-		emit_float(&p, g);												// Varying 1 (Green)
-		emit_float(&p, b);												// Varying 2 (Blue)
-
-
-		// Vertex: bottom left
-		emit_uint16_t(&p, xa << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, yb << 4);										// Y in 12.4 fixed point
-		emit_float(&p, 1.0f);											// Z
-		emit_float(&p, 1.0f);											// 1/W
-		emit_float(&p, r);												// Varying 0 (Red)
-		emit_float(&p, g);												// Varying 1 (Green)
-		emit_float(&p, b);												// Varying 2 (Blue)
-
-
-		scene->num_verts += 4;
-
-		p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->indexVertexVC4);
-		p += (window_index * 12);										// Adjust vertex position
-
-		uint32_t w = window_index * 4;
-		emit_uint16_t(&p, w);											// quad - top left
-		emit_uint16_t(&p, w+3);											// quad - bottom left
-		emit_uint16_t(&p, w+1);											// quad - top right
-
-		emit_uint16_t(&p, w+3);											// quad - bottom left
-		emit_uint16_t(&p, w+2);											// quad - bottom right
-		emit_uint16_t(&p, w+1);											// quad - top right
-		
-		scene->IndexVertexCt += 6;
-		scene->MaxIndexVertex = w+4;
+		GUI_WINDOW* win = &scene->window[window_index];
+		uint32_t texSize = (layout.size + 0xFFF) & ~0xFFF;			// Each texture 4K aligned
+		uint32_t surfaceSize = layout.level[0].width * layout.level[0].height * 4;
+		win->handle = V3D_mem_alloc(texSize * 2 + surfaceSize, 0x1000, MEM_FLAG_COHERENT | MEM_FLAG_ZERO);
+		if (!win->handle) return false;
+		VC4_ADDR baseVC4 = V3D_mem_lock(win->handle);
+		if (!baseVC4) {												// Lock failed, give the memory back
+			SceneMemRelease(&win->handle);
+			return false;
+		}
+		win->level = layout.level[0];
+		win->surface = (uint32_t*)(uintptr_t)GPUaddrToARMaddr(baseVC4 + texSize * 2);
+
+		TEXTURE_CONFIG_PARAMS p1 = { .Raw32 = 0 };
+		p1.wrap_s = WRAPMODE_CLAMP;
+		p1.wrap_t = WRAPMODE_CLAMP;
+		p1.minfilt = MINFILT_NEAREST;								// Texel for pixel when the window is not stretched
+		p1.magfilt = MAGFILT_NEAREST;
+		p1.width = win->level.width & 0x7FF;						// 2048 is held as 0
+		p1.height = win->level.height & 0x7FF;
+		win->texParams = p1.Raw32;
+		for (int i = 0; i < 2; i++) {
+			win->textureVC4[i] = baseVC4 + i * texSize + layout.level[0].offset;
+			TEXTURE_CONFIG_BLOCK p0 = { .Raw32 = 0 };
+			p0.base_addr = win->textureVC4[i] >> 12;
+			p0.texture_type = TEXTURE_TYPE_RGBA8888;
+			win->texConfig[i] = p0.Raw32;
+			win->textureTicket[i] = 0;
+		}
 
+		uint32_t c = colour.rgbRed | (colour.rgbGreen << 8) | (colour.rgbBlue << 16) | (colour.rgbAlpha << 24);
+		for (uint32_t i = 0; i < win->level.width * win->level.height; i++)
+			win->surface[i] = c;
+		win->current = 1;											// First upload goes to texture 0
+		win->dirty = true;
+		win->version++;												// Differs from whatever a frame's slot holds
+		win->x1 = x1;
+		win->y1 = y1;
+		win->x2 = x2;
+		win->y2 = y2;
+		scene->zOrder[scene->windowCount++] = window_index;			// On top
+		scene->zVersion++;
 		return true;
 	}
 	return false;
 }
 
-
+/*-[ V3D_MoveWindowInScene ]------------------------------------------------}
+. Moves the window to x1,y1 - x2,y2 for the next frame, a new size
+. stretches the surface to fit. Nothing is uploaded, each frame rewrites
+. only this window's 128 byte slot.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
 bool V3D_MoveWindowInScene(RENDER_STRUCT* scene, int window_index, int x1, int y1, int x2, int y2)
 {
-	if (scene)
+	if ((scene) && (window_index >= 0) && (window_index < scene->maxWindows) && (scene->window[window_index].handle))
 	{
-		uint16_t xa, ya, xb, yb;
-		uint8_t* p = (uint8_t*)(uintptr_t)GPUaddrToARMaddr(scene->vertexVC4); // Start of vertex index
-		p += (window_index * (4 * 24));									// Adjust vertex position
-
-		xa = (x1 < 0) ? 0 : (x1 > 0xFFFF) ? 0xFFFF : x1;
-		ya = (y1 < 0) ? 0 : (y1 > 0xFFFF) ? 0xFFFF : y1;
-		xb = (x2 < 0) ? 0 : (x2 > 0xFFFF) ? 0xFFFF : x2;
-		yb = (y2 < 0) ? 0 : (y2 > 0xFFFF) ? 0xFFFF : y2;
+		GUI_WINDOW* win = &scene->window[window_index];
+		if ((win->x1 != x1) || (win->y1 != y1) || (win->x2 != x2) || (win->y2 != y2)) {
+			win->x1 = x1;
+			win->y1 = y1;
+			win->x2 = x2;
+			win->y2 = y2;
+			win->version++;											// Frames rewrite just this slot
+		}
+		return true;
+	}
+	return false;
+}
 
-		// Vertex: Top left
-		emit_uint16_t(&p, xa << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, ya << 4);										// Y in 12.4 fixed point
-		p += 20;
+/*-[ V3D_WindowSurface ]----------------------------------------------------}
+. The pixels of the window for the ARM to draw in, width words a row and row
+. 0 at the top. Call V3D_InvalidateWindow when done so they are uploaded.
+. RETURN: Surface pixels, NULL no such window
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t* V3D_WindowSurface (RENDER_STRUCT* scene, int window_index, uint32_t* width, uint32_t* height)
+{
+	if ((scene) && (window_index >= 0) && (window_index < scene->maxWindows) && (scene->window[window_index].handle))
+	{
+		GUI_WINDOW* win = &scene->window[window_index];
+		if (width) *width = win->level.width;
+		if (height) *height = win->level.height;
+		return win->surface;
+	}
+	return 0;
+}
 
-		// Vertex: top right
-		emit_uint16_t(&p, xb << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, ya << 4);										// Y in 12.4 fixed point
-		p += 20;
+/*-[ V3D_InvalidateWindow ]-------------------------------------------------}
+. Marks the window's surface changed, the next V3D_RenderScene uploads it.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_InvalidateWindow (RENDER_STRUCT* scene, int window_index)
+{
+	if ((scene) && (window_index >= 0) && (window_index < scene->maxWindows) && (scene->window[window_index].handle))
+	{
+		scene->window[window_index].dirty = true;
+		return true;
+	}
+	return false;
+}
 
-		// Vertex: bottom right 
-		emit_uint16_t(&p, xb << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, yb << 4);										// Y in 12.4 fixed point
-		p += 20;
+/*-[ V3D_RaiseWindow ]------------------------------------------------------}
+. Puts the window on top of the others from the next frame.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_RaiseWindow (RENDER_STRUCT* scene, int window_index)
+{
+	if (scene)
+	{
+		for (uint32_t i = 0; i < scene->windowCount; i++)
+			if (scene->zOrder[i] == window_index) {
+				memmove(&scene->zOrder[i], &scene->zOrder[i + 1], (scene->windowCount - i - 1) * sizeof(uint16_t));
+				scene->zOrder[scene->windowCount - 1] = window_index;
+				scene->zVersion++;
+				return true;
+			}
+	}
+	return false;
+}
 
 
-		// Vertex: bottom left
-		emit_uint16_t(&p, xa << 4);										// X in 12.4 fixed point
-		emit_uint16_t(&p, yb << 4);										// Y in 12.4 fixed point
-		p += 20;
 
+/*-[ V3D_RemoveWindowFromScene ]--------------------------------------------}
+. Takes the window out of the scene from the next frame and frees its
+. memory once no frame in flight samples its textures.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool V3D_RemoveWindowFromScene (RENDER_STRUCT* scene, int window_index)
+{
+	if (V3D_RaiseWindow(scene, window_index))						// Move it to the top then drop the top
+	{
+		GUI_WINDOW* win = &scene->window[window_index];
+		scene->windowCount--;
+		V3D_WaitFrame(win->textureTicket[0]);						// Frames still sampling it must finish
+		V3D_WaitFrame(win->textureTicket[1]);
+		V3D_mem_unlock(win->handle);
+		V3D_mem_free(win->handle);
+		win->handle = 0;											// Version is kept so a new window here rewrites the slots
 		return true;
 	}
 	return false;
@@ -752,16 +1060,8 @@ bool V3D_MoveWindowInScene(RENDER_STRUCT* scene, int window_index, int x1, int y
 
 
 
-static uint32_t shader1[18] = {  // Vertex Color Shader
-		0x958e0dbf, 0xd1724823,   /* mov r0, vary; mov r3.8d, 1.0 */
-		0x818e7176, 0x40024821,   /* fadd r0, r0, r5; mov r1, vary */
-		0x818e7376, 0x10024862,   /* fadd r1, r1, r5; mov r2, vary */
-		0x819e7540, 0x114248a3,   /* fadd r2, r2, r5; mov r3.8a, r0 */
-		0x809e7009, 0x115049e3,   /* nop; mov r3.8b, r1 */
-		0x809e7012, 0x116049e3,   /* nop; mov r3.8c, r2 */
-		0x159e76c0, 0x30020ba7,   /* mov tlbc, r3; nop; thrend */
-		0x009e7000, 0x100009e7,   /* nop; nop; nop */
-		0x009e7000, 0x500009e7,   /* nop; nop; sbdone */
+static uint32_t shader1[] = {  // Window composite shader, assembled from Shaders/Composite.qasm
+#include "Shaders/Composite.h"
 };
 
 static RENDER_STRUCT scene = { 0 };
@@ -774,32 +1074,132 @@ static int window_x[3] = { 20, 700, 400 };
 static int window_y[3] = { 20, 600, 200 };
 static int window_width[3] = { 200, 200, 400 };
 static int window_height[3] = { 200, 200, 200 };
+static int bar_x = 0;											// Bar sweeping across the top window
 
+/*--------------------------------------------------------------------------}
+{ Fills a rectangle of a surface width pixels across with a texel colour.  }
+{--------------------------------------------------------------------------*/
+static void FillSurface (uint32_t* surface, uint32_t width, int x, int y, int w, int h, uint32_t colour)
+{
+	for (int j = y; j < y + h; j++)
+		for (int i = x; i < x + w; i++) surface[j * width + i] = colour;
+}
 
-#include <stdlib.h> // needed for rand
-void Desktop_Start (void)
+/*--------------------------------------------------------------------------}
+{ Draws a title bar and border in the window's surface, keeping its alpha.  }
+{--------------------------------------------------------------------------*/
+static void DrawWindowFrame (int window_index)
 {
-	InitV3D();														// Initialize 3D graphics
+	uint32_t w, h;
+	uint32_t* surface = V3D_WindowSurface(&scene, window_index, &w, &h);
+	if (surface) {
+		uint32_t alpha = surface[w * h / 2] & 0xFF000000;			// Body alpha
+		FillSurface(surface, w, 0, 0, w, 16, alpha | 0x404040);		// Title bar
+		FillSurface(surface, w, w - 14, 2, 12, 12, alpha | 0x0000C0);	// Close box
+		FillSurface(surface, w, 0, 0, w, 1, 0xFFFFFFFF);			// Border
+		FillSurface(surface, w, 0, h - 1, w, 1, 0xFFFFFFFF);
+		FillSurface(surface, w, 0, 0, 1, h, 0xFFFFFFFF);
+		FillSurface(surface, w, w - 1, 0, 1, h, 0xFFFFFFFF);
+		V3D_InvalidateWindow(&scene, window_index);
+	}
+}
 
-	// Step1: Initialize scene
-	V3D_InitializeScene(&scene, GetConsole_Width(), GetConsole_Height());
+/*--------------------------------------------------------------------------}
+{ Moves the bar across the top window, the only surface that changes each  }
+{ frame so the only one uploaded.                                          }
+{--------------------------------------------------------------------------*/
+static void AnimateWindow (int window_index)
+{
+	uint32_t w, h;
+	uint32_t* surface = V3D_WindowSurface(&scene, window_index, &w, &h);
+	if (surface) {
+		uint32_t body = surface[(h - 2) * w + 1];					// Colour under the bar
+		FillSurface(surface, w, bar_x + 2, 24, 16, h - 32, body);	// Clear the old bar
+		bar_x = (bar_x + 4) % (w - 20);
+		FillSurface(surface, w, bar_x + 2, 24, 16, h - 32, 0xFFFFFFFF);
+		V3D_InvalidateWindow(&scene, window_index);
+	}
+}
+
+
+#define SCALE_WINDOWS		512							// Windows the scene is made for, the most the scaling test uses
+#define SCALE_FRAMES		60							// Frames timed for each window count
+
+/*--------------------------------------------------------------------------}
+{ Times SCALE_FRAMES frames of n 32x16 windows spread over the screen, once }
+{ moving one window a frame and once moving all of them, for n up to        }
+{ SCALE_WINDOWS and prints the usec a frame takes, the ARM usec preparing   }
+{ it, the window slots rewritten a frame and the V3D bin to render done.   }
+{--------------------------------------------------------------------------*/
+static void ScaleTest (printhandler prn_handler)
+{
+	static const uint32_t counts[5] = { 1, 16, 64, 256, SCALE_WINDOWS };
+	uint32_t frameUs[5][2], prepUs[5][2], slots[5][2], v3dUs[5] = { 0 };
+	for (int c = 0; c < 5; c++) {
+		uint32_t n = counts[c];
+		for (uint32_t i = 0; i < n; i++) {
+			int x = (i * 37) % (scene.renderWth - 40) + 4;
+			int y = (i * 23) % (scene.renderHt - 24) + 4;
+			V3D_AddWindowToScene(&scene, i, x, y, x + 32, y + 16,
+				(RGBA) { .rgbRed = i * 7, .rgbGreen = i * 13, .rgbBlue = 0xFF, .rgbAlpha = 0xFF });
+		}
+		V3D_RenderScene(&scene);									// Uploads and the new lists are not timed
+		V3D_RenderScene(&scene);
+		V3D_RenderScene(&scene);
+		V3D_WaitIdle();
+		uint32_t ticket = 0;
+		for (int all = 0; all < 2; all++) {
+			uint32_t slotWrites = scene.slotWrites, prepareUs = scene.prepareUs;
+			uint64_t t = timer_getTickCount64();
+			for (int f = 0; f < SCALE_FRAMES; f++) {
+				int dx = (f & 1) ? -1 : 1;
+				for (uint32_t i = 0; i < ((all) ? n : 1); i++) {
+					GUI_WINDOW* win = &scene.window[i];
+					V3D_MoveWindowInScene(&scene, i, win->x1 + dx, win->y1, win->x2 + dx, win->y2);
+				}
+				ticket = V3D_RenderScene(&scene);
+			}
+			V3D_WaitIdle();
+			frameUs[c][all] = tick_difference(t, timer_getTickCount64()) / SCALE_FRAMES;
+			prepUs[c][all] = (scene.prepareUs - prepareUs) / SCALE_FRAMES;
+			slots[c][all] = (scene.slotWrites - slotWrites) / SCALE_FRAMES;
+		}
+		V3D_FRAME_TIMES times;
+		if (V3D_GetFrameTimes(ticket, &times)) v3dUs[c] = times.renderDoneTick - times.binStartTick;
+		for (uint32_t i = 0; i < n; i++) V3D_RemoveWindowFromScene(&scene, i);
+	}
+	// The frames drew over the console so print once they are done
+	for (int c = 0; c < 5; c++)
+		prn_handler("%4u windows: move 1 %5u us/frame (ARM %4u us, %3u slots) move all %5u us/frame (ARM %4u us, %3u slots) V3D %5u us\n",
+			(unsigned int)counts[c], (unsigned int)frameUs[c][0], (unsigned int)prepUs[c][0], (unsigned int)slots[c][0],
+			(unsigned int)frameUs[c][1], (unsigned int)prepUs[c][1], (unsigned int)slots[c][1], (unsigned int)v3dUs[c]);
+	uint64_t t = timer_getTickCount64();
+	while (tick_difference(t, timer_getTickCount64()) < 5000000) {};	// 5 seconds to read it
+}
 
-	// Step2: Add vertexes to scene
-	V3D_AddVertexesToScene(&scene, 100);
 
+#include <stdlib.h> // needed for rand
+void Desktop_Start (printhandler prn_handler)
+{
+	InitV3D();														// Initialize 3D graphics
 
-	V3D_AddWindowToScene(&scene, 0, window_x[0], window_y[0], window_x[0] + window_width[0], window_y[0] + window_height[0], (RGBA) { .rgbBlue = 0xFF });
-	V3D_AddWindowToScene(&scene, 1, window_x[1], window_y[1], window_x[1] + window_width[1], window_y[1] + window_height[1], (RGBA) { .rgbGreen = 0xFF });
-	V3D_AddWindowToScene(&scene, 2, window_x[2], window_y[2], window_x[2] + window_width[2], window_y[2] + window_height[2], (RGBA) { .rgbRed = 0xFF });
+	// Step1: Initialize scene
+	V3D_InitializeScene(&scene, GetConsole_Width(), GetConsole_Height(), SCALE_WINDOWS);
 
-	// Step3: Add shader to scene
+	// Step2: Add shader to scene
 	V3D_AddShadderToScene(&scene, &shader1[0], _countof(shader1));
 
-	// Step4: Setup render control
+	// Step3: Setup render control, the same lists every frame
 	V3D_SetupRenderControl(&scene, GetConsole_FrameBuffer());
 
-	// Step5: Setup binning
-	V3D_SetupBinningConfig(&scene);
+	// Step4: Time frames as the window count grows
+	if (prn_handler) ScaleTest(prn_handler);
+
+	// Step5: Add windows bottom to top, the middle one is see through
+	V3D_AddWindowToScene(&scene, 0, window_x[0], window_y[0], window_x[0] + window_width[0], window_y[0] + window_height[0], (RGBA) { .rgbBlue = 0xFF, .rgbAlpha = 0xFF });
+	V3D_AddWindowToScene(&scene, 1, window_x[1], window_y[1], window_x[1] + window_width[1], window_y[1] + window_height[1], (RGBA) { .rgbGreen = 0xFF, .rgbAlpha = 0xA0 });
+	V3D_AddWindowToScene(&scene, 2, window_x[2], window_y[2], window_x[2] + window_width[2], window_y[2] + window_height[2], (RGBA) { .rgbRed = 0xFF, .rgbAlpha = 0xFF });
+	for (int i = 0; i < 3; i++) DrawWindowFrame(i);
 
 	// Step 6: Render the scene
 	V3D_RenderScene(&scene);
@@ -825,6 +1225,7 @@ void Move_Windows (void)
 				window_dx[i] = rand() % 10 + 1;
 				window_dy[i] = rand() % 10 + 1;
 				window_xdir[i] = -1;
+				V3D_RaiseWindow(&scene, i);							// Bouncing off the right side brings it to the top
 			}
 		}
 		else {
@@ -865,5 +1266,6 @@ void Move_Windows (void)
 
 		V3D_MoveWindowInScene(&scene, i, window_x[i], window_y[i], window_x[i] + window_width[i], window_y[i] + window_height[i]);
 	}
+	AnimateWindow(2);
 	V3D_RenderScene(&scene);
 }
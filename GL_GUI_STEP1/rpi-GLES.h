@@ -30,7 +30,27 @@ extern "C" {									// Put extern C directive wrapper around
 #include "rpi-smartstart.h"						// Need for mailbox
 
 
-void Desktop_Start (void);
+#define V3D_MAX_FRAMES	3						// Frames that can be in flight on the V3D at once
+
+/* Timestamps (1Mhz timer ticks) of a frame through the V3D queue */
+typedef struct v3d_frame_times {
+	uint64_t submitTick;						// Frame given to V3D_SubmitFrame
+	uint64_t binStartTick;						// Binner (CT0) started on the frame
+	uint64_t binDoneTick;						// Binning flush seen done
+	uint64_t renderStartTick;					// Renderer (CT1) started on the frame
+	uint64_t renderDoneTick;					// Render seen done
+} V3D_FRAME_TIMES;
+
+uint32_t V3D_SubmitFrame (uint32_t binStart, uint32_t binEnd, uint32_t renderStart, uint32_t renderEnd);
+bool V3D_PollFrames (void);
+bool V3D_FrameDone (uint32_t ticket);
+void V3D_WaitFrame (uint32_t ticket);
+void V3D_WaitIdle (void);
+bool V3D_GetFrameTimes (uint32_t ticket, V3D_FRAME_TIMES* times);
+bool V3D_IrqHandler (void);
+void V3D_EnableFrameIrq (bool enable);
+
+void Desktop_Start (printhandler prn_handler);
 void Move_Windows (void);
 
 
@@ -0,0 +1,132 @@
+#ifndef _RPI_TEXTURE_
+#define _RPI_TEXTURE_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Texture.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Texture memory layout for the V3D texture unit (TMU), 32 bit RGBA8888   }
+{  texels only. The TMU does not read rows of texels, it reads:            }
+{                                                                           }
+{  Microtiles: 4x4 texels, 64 bytes, the 4 rows one after another.          }
+{  T-format:   4K tiles of 32x32 texels (2x2 subtiles of 1K, 4x4 micro-    }
+{              tiles each). Tile rows alternate direction, even rows run    }
+{              left to right and odd rows right to left, and the subtile   }
+{              order in a tile flips with them so the walk never jumps.    }
+{  LT-format:  Microtiles in plain row order, used by levels with a side   }
+{              of 16 texels or less where whole 4K tiles would be waste.   }
+{                                                                           }
+{  A mipmapped texture has its levels smallest first with level 0 last and }
+{  4K aligned, the address the texture config gives. The TMU finds level n }
+{  by stepping back from level 0 so the padded level sizes must be exactly }
+{  what Texture_Layout works out. Mipmaps need power of 2 sides.           }
+{                                                                           }
+{  Texel words are R | G<<8 | B<<16 | A<<24, the byte order the fragment   }
+{  shaders pack colour in, so a sampled texel goes straight to the tile    }
+{  buffer. Row 0 is the bottom of the image (t = 0) as BMP files hold it.  }
+{                                                                           }
+{  The module has no hardware dependencies so it also builds on a host.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+#define TEXTURE_MAX_SIZE		2048			// Largest side the TMU takes
+#define TEXTURE_MAX_LEVELS		12				// 2048 down to 1
+
+#define TEXTURE_TILING_T		0				// 4K tiles
+#define TEXTURE_TILING_LT		1				// Microtiles in row order
+
+/* Where one mipmap level sits in the texture memory */
+typedef struct texture_level {
+	uint32_t offset;							// Byte offset from the start of the texture memory
+	uint32_t size;								// Bytes the padded level takes
+	uint16_t width;								// Texels across
+	uint16_t height;							// Texels down
+	uint16_t padWidth;							// Width padded to whole tiles or microtiles
+	uint16_t padHeight;							// Height padded to whole tiles or microtiles
+	uint8_t tiling;								// TEXTURE_TILING_T or TEXTURE_TILING_LT
+} TEXTURE_LEVEL;
+
+/* The levels of a texture, level 0 is the full size image */
+typedef struct texture_layout {
+	uint32_t levels;							// Mipmap levels (1 = no mipmaps)
+	uint32_t size;								// Bytes of texture memory (4K aligned allocation)
+	TEXTURE_LEVEL level[TEXTURE_MAX_LEVELS];
+} TEXTURE_LAYOUT;
+
+/*-[Texture_Layout]---------------------------------------------------------}
+. Works out the tiling, padding and offset of every level of a width x
+. height texture, level 0 only if mipmaps is false. The memory given to the
+. TMU must be 4K aligned and layout->size bytes.
+. RETURN: True layout made, False a side is 0, over TEXTURE_MAX_SIZE or
+.         not a power of 2 with mipmaps
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_Layout (TEXTURE_LAYOUT* layout, uint32_t width, uint32_t height, bool mipmaps);
+
+/*-[Texture_TexelOffset]----------------------------------------------------}
+. RETURN: Byte offset of texel x,y from the start of the level, the plain
+.         per texel address sum Texture_Swizzle does a microtile at a time
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Texture_TexelOffset (const TEXTURE_LEVEL* level, uint32_t x, uint32_t y);
+
+/*-[Texture_Swizzle]--------------------------------------------------------}
+. Writes the level's texels from the row order image src (srcPitch texels
+. row to row, level->width x level->height) into dest, the level's place in
+. the texture memory, in its T or LT order. Padding repeats the edge texels.
+. NEON builds move each microtile row as one 16 byte load and store.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Texture_Swizzle (void* dest, const TEXTURE_LEVEL* level, const uint32_t* src, uint32_t srcPitch);
+
+/*-[Texture_Downsample]-----------------------------------------------------}
+. Box filters the width x height row order image src into dest, the next
+. mipmap level (half each side, never below 1). Each byte is the rounded
+. average of averages of pairs, so the NEON path gives the same result.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Texture_Downsample (uint32_t* dest, const uint32_t* src, uint32_t width, uint32_t height);
+
+/*-[Texture_BmpSize]--------------------------------------------------------}
+. Checks the header of an uncompressed 24 or 32 bit BMP file of fileSize
+. bytes and gives its size.
+. RETURN: True a BMP Texture_DecodeBmp can read, False it is not
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_BmpSize (const void* file, uint32_t fileSize, uint32_t* width, uint32_t* height);
+
+/*-[Texture_DecodeBmp]------------------------------------------------------}
+. Converts a BMP Texture_BmpSize accepted to texel words in dest, bottom row
+. first whichever way the file holds its rows. Alpha is 255 as BI_RGB files
+. have none (the 4th byte of 32 bit texels is unused).
+. RETURN: True converted, False not a BMP Texture_BmpSize accepts
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Texture_DecodeBmp (const void* file, uint32_t fileSize, uint32_t* dest);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef _RPI_V3DLIST_
+#define _RPI_V3DLIST_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-V3DList.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  VC4 control list builder, validator and disassembler. There is one      }
+{  function per GL_ packet so a list is written as calls rather than bytes  }
+{  and magic numbers. The validator walks a finished binning or render      }
+{  list checking packet order, the addresses it holds and the tile layout,  }
+{  the disassembler prints it packet by packet.                             }
+{                                                                           }
+{  The module has no hardware dependencies so lists can be built, checked   }
+{  and measured on a host (GLES2_Model/Host/ListCheck.c) before a Pi.      }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/* primitive type in the GL pipline */
+typedef enum {
+	PRIM_POINT = 0,
+	PRIM_LINE = 1,
+	PRIM_LINE_LOOP = 2,
+	PRIM_LINE_STRIP = 3,
+	PRIM_TRIANGLE = 4,
+	PRIM_TRIANGLE_STRIP = 5,
+	PRIM_TRIANGLE_FAN = 6,
+} PRIMITIVE;
+
+#define INDEX_TYPE_8  0x00   //  Indexed_Primitive_List: Index Type = 8 - Bit
+#define INDEX_TYPE_16 0x10   //  Indexed_Primitive_List: Index Type = 16 - Bit
+
+/* These come from the blob information header .. they start at   KHRN_HW_INSTR_HALT */
+/* https://github.com/raspberrypi/userland/blob/a1b89e91f393c7134b4cdc36431f863bb3333163/middleware/khronos/common/2708/khrn_prod_4.h */
+/* GL pipe control commands */
+typedef enum {
+	GL_HALT = 0,
+	GL_NOP = 1,
+	GL_FLUSH = 4,
+	GL_FLUSH_ALL_STATE = 5,
+	GL_START_TILE_BINNING = 6,
+	GL_INCREMENT_SEMAPHORE = 7,
+	GL_WAIT_ON_SEMAPHORE = 8,
+	GL_BRANCH = 16,
+	GL_BRANCH_TO_SUBLIST = 17,
+	GL_RETURN_FROM_SUBLIST = 18,
+	GL_STORE_MULTISAMPLE = 24,
+	GL_STORE_MULTISAMPLE_END = 25,
+	GL_STORE_FULL_TILE_BUFFER = 26,
+	GL_RELOAD_FULL_TILE_BUFFER = 27,
+	GL_STORE_TILE_BUFFER = 28,
+	GL_LOAD_TILE_BUFFER = 29,
+	GL_INDEXED_PRIMITIVE_LIST = 32,
+	GL_VERTEX_ARRAY_PRIMITIVES = 33,
+	GL_VG_COORDINATE_ARRAY_PRIMITIVES = 41,
+	GL_COMPRESSED_PRIMITIVE_LIST = 48,
+	GL_CLIP_COMPRESSD_PRIMITIVE_LIST = 49,
+	GL_PRIMITIVE_LIST_FORMAT = 56,
+	GL_SHADER_STATE = 64,
+	GL_NV_SHADER_STATE = 65,
+	GL_VG_SHADER_STATE = 66,
+	GL_VG_INLINE_SHADER_RECORD = 67,
+	GL_CONFIG_STATE = 96,
+	GL_FLAT_SHADE_FLAGS = 97,
+	GL_POINTS_SIZE = 98,
+	GL_LINE_WIDTH = 99,
+	GL_RHT_X_BOUNDARY = 100,
+	GL_DEPTH_OFFSET = 101,
+	GL_CLIP_WINDOW = 102,
+	GL_VIEWPORT_OFFSET = 103,
+	GL_Z_CLIPPING_PLANES = 104,
+	GL_CLIPPER_XY_SCALING = 105,
+	GL_CLIPPER_Z_ZSCALE_OFFSET = 106,
+	GL_TILE_BINNING_CONFIG = 112,
+	GL_TILE_RENDER_CONFIG = 113,
+	GL_CLEAR_COLORS = 114,
+	GL_TILE_COORDINATES = 115
+}  GL_CONTROL;
+
+/* A control list being written, mem is where the ARM (or host) writes it */
+/* and memVC4 the address the V3D will see it at */
+typedef struct v3d_list {
+	uint8_t* start;								// First byte of list memory
+	uint8_t* pos;								// Where the next packet goes
+	uint8_t* end;								// One past the last byte of list memory
+	uint32_t startVC4;							// VC4 address of start
+	bool overflow;								// A packet did not fit (list is short)
+} V3D_LIST;
+
+/* Which of the two control list threads a list is for */
+typedef enum {
+	V3DLIST_BINNING = 0,						// CT0 binning list
+	V3DLIST_RENDER = 1,							// CT1 render list
+} V3DLIST_TYPE;
+
+/* A block of VC4 memory a list is allowed to point into */
+typedef struct v3d_mem_range {
+	uint32_t start;								// VC4 start address
+	uint32_t size;								// Size in bytes
+	const char* name;							// Name used in messages
+} V3D_MEM_RANGE;
+
+/* What V3DList_Validate checks a list against, zero fields are not checked */
+typedef struct v3d_validate {
+	V3DLIST_TYPE type;							// Binning or render list
+	const V3D_MEM_RANGE* ranges;				// Memory the addresses in the list must be in
+	uint32_t rangeCount;						// Number of ranges
+	uint32_t binWth;							// Tiles across (render list, binning takes it from config)
+	uint32_t binHt;								// Tiles down (render list, binning takes it from config)
+	uint32_t tileAlloc;							// Render list sublist branches must be the initial tile blocks here
+} V3D_VALIDATE;
+
+/***************************************************************************}
+{                       PUBLIC LIST BUILDER ROUTINES                        }
+{***************************************************************************/
+
+/*-[V3DList_Init]-----------------------------------------------------------}
+. Starts an empty list in size bytes at mem which the V3D sees at memVC4.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3DList_Init (V3D_LIST* list, void* mem, uint32_t memVC4, uint32_t size);
+
+/*-[V3DList_Size]-----------------------------------------------------------}
+. RETURN: Bytes written to the list so far
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Size (const V3D_LIST* list);
+
+/*-[V3DList_EndVC4]---------------------------------------------------------}
+. RETURN: VC4 address one past the last packet (the CTnEA end address)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_EndVC4 (const V3D_LIST* list);
+
+/* One builder per packet, a packet that does not fit sets list->overflow */
+/* and is dropped whole so the list never holds half a packet.           */
+void V3DList_Halt (V3D_LIST* list);
+void V3DList_Nop (V3D_LIST* list);
+void V3DList_Flush (V3D_LIST* list);
+void V3DList_FlushAllState (V3D_LIST* list);
+void V3DList_StartTileBinning (V3D_LIST* list);
+void V3DList_BranchToSublist (V3D_LIST* list, uint32_t sublistVC4);
+void V3DList_StoreMultisample (V3D_LIST* list, bool endOfFrame);
+void V3DList_StoreTileBuffer (V3D_LIST* list, uint16_t flags, uint32_t addrVC4);
+void V3DList_IndexedPrimitiveList (V3D_LIST* list, uint8_t modeAndIndexType, uint32_t count, uint32_t indexVC4, uint32_t maxIndex);
+void V3DList_PrimitiveListFormat (V3D_LIST* list, uint8_t format);
+void V3DList_ShaderState (V3D_LIST* list, uint32_t recordVC4, uint8_t attribCount);
+void V3DList_NVShaderState (V3D_LIST* list, uint32_t recordVC4);
+void V3DList_ConfigState (V3D_LIST* list, uint8_t flags8, uint8_t flags16, uint8_t flags24);
+void V3DList_ClipWindow (V3D_LIST* list, uint16_t left, uint16_t bottom, uint16_t width, uint16_t height);
+void V3DList_ViewportOffset (V3D_LIST* list, uint16_t x, uint16_t y);
+void V3DList_TileBinningConfig (V3D_LIST* list, uint32_t tileAllocVC4, uint32_t tileAllocSize, uint32_t tileStateVC4,
+								uint8_t binWth, uint8_t binHt, uint8_t flags);
+void V3DList_TileRenderConfig (V3D_LIST* list, uint32_t renderVC4, uint16_t width, uint16_t height, uint16_t mode);
+void V3DList_ClearColors (V3D_LIST* list, uint32_t colour, uint32_t clearZ, uint8_t clearStencil);
+void V3DList_TileCoordinates (V3D_LIST* list, uint8_t x, uint8_t y);
+
+/*-[V3DList_RenderTiles]----------------------------------------------------}
+. Writes the usual whole render list: clear colours, render config, a
+. clearing store of tile 0,0 then every tile branching to its initial block
+. in tileAllocVC4 and storing, the last with end of frame.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void V3DList_RenderTiles (V3D_LIST* list,							// List to write
+						  uint32_t clearColour,						// RGBA clear colour
+						  uint32_t renderVC4,						// Frame buffer VC4 address
+						  uint16_t width, uint16_t height,			// Render size in pixels
+						  uint16_t mode,							// Frame buffer mode (0x04 = linear rgba8888)
+						  uint8_t binWth, uint8_t binHt,				// Tiles across and down
+						  uint32_t tileAllocVC4);					// Tile allocation memory the binner filled
+
+/***************************************************************************}
+{                   PUBLIC VALIDATE/DISASSEMBLE ROUTINES                    }
+{***************************************************************************/
+
+/*-[V3DList_PacketLength]---------------------------------------------------}
+. RETURN: Bytes of the packet with the opcode including the opcode byte,
+.         0 for an opcode the module does not know the length of
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_PacketLength (uint8_t opcode);
+
+/*-[V3DList_Validate]-------------------------------------------------------}
+. Walks size bytes of list (at VC4 address listVC4) and checks it against
+. the rules in v. Each problem is printed through prn_handler (may be NULL).
+. Binning: config then start binning first, primitives only once shader
+. state, list format, clip window and config state are set, tile alloc big
+. enough for the initial blocks, all addresses in the ranges, ends with a
+. flush. Render: render config before the tiles, every tile once inside
+. the grid with a store after it, one end of frame store on the last tile,
+. sublist branches to the tile's initial block.
+. RETURN: Number of problems found (0 = list is good)
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Validate (const uint8_t* list, uint32_t size, uint32_t listVC4,
+						   const V3D_VALIDATE* v, int (*prn_handler) (const char *fmt, ...));
+
+/*-[V3DList_Disassemble]----------------------------------------------------}
+. Prints size bytes of list (at VC4 address listVC4) one packet per line
+. followed by a packet count and byte total.
+. RETURN: Number of packets decoded
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t V3DList_Disassemble (const uint8_t* list, uint32_t size, uint32_t listVC4,
+							  int (*prn_handler) (const char *fmt, ...));
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
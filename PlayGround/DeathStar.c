@@ -0,0 +1,394 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <math.h>								// Needed for sqrt, pow, floor, ceil
+#include "rpi-SmartStart.h"						// Needed for SetPixel, ImageLineOut, CoreExecute
+#include "DeathStar.h"							// This units header
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>							// Pi2/Pi3 builds have NEON for the row spans
+#define DS_NEON
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: DeathStar.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The two surface points a pixel can show are on a sphere, so the vector   }
+{  from the centre to them is the sphere radius long and lighting needs no  }
+{  normalise, only a multiply by 1/radius. How lit a point is (0 to 1) is   }
+{  looked up in a table of pixels made once for each k and ambient, which   }
+{  takes the pow() out of every pixel. The only per pixel roots left are    }
+{  where the pixel's ray meets each sphere, 4 at a time on NEON.            }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define RGBA(r, g, b, a)  ( (COLORREF) ( (uint32_t)(b) | (uint32_t) ((uint32_t)g << 8) | (uint32_t) ((uint32_t)r << 16) | (uint32_t) ((uint32_t)a << 24) ) )
+
+#define DS_LUT_SIZE			1024				// Steps of how lit a point is in the shade table
+#define DS_BLACK			0xFF000000			// Background pixel
+
+typedef struct { double cx, cy, cz, r; } sphere_t;
+
+/* positive shpere and negative sphere */
+static const sphere_t pos = { 40, 40, 0, 40 }, neg = { 1, 1, -6, 40 };
+
+static struct {
+	HDC dc;										// DC rows are sent to
+	int posX;									// Box left on the DC
+	int posY;									// Box top on the DC
+	int rows;									// Box height
+	int width;									// Box width
+	int firstJ;									// Pixel column number of the box left
+	float y0;									// Ray y of the top row
+	float lx, ly, lz;							// Light vector
+	float pcx, pcy, pcz, pr2, invPr;			// Positive sphere
+	float ncx, ncy, ncz, nr2, invNr;			// Negative sphere
+	double k;									// Shine power the shade table is for
+	double ambient;								// Ambient the shade table is for
+	bool shadeMade;								// Shade table is made
+	uint32_t cores;								// Cores the rows are dealt to
+	volatile uint32_t frame;					// Draw number the cores are on
+	volatile uint32_t done[DS_MAX_CORES];		// Last draw each core finished
+	uint32_t shade[DS_LUT_SIZE + 1];			// Pixel for each step of lit
+} ds = { 0 };
+
+static uint32_t __attribute__((aligned(16))) RowBuf[DS_MAX_CORES][DS_MAX_WIDTH];	// A row buffer per core
+
+/***************************************************************************}
+{				  THE DEMO AS IT ALWAYS WAS, DOUBLE AND SETPIXEL			}
+****************************************************************************/
+static void normalize(double * v)
+{
+	double len = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+	v[0] /= len; v[1] /= len; v[2] /= len;
+}
+
+static double dot(const double *x, const double *y)
+{
+	double d = x[0] * y[0] + x[1] * y[1] + x[2] * y[2];
+	return d < 0 ? -d : 0;
+}
+
+/* check if a ray (x,y, -inf)->(x, y, inf) hits a sphere; if so, return
+the intersecting z values.  z1 is closer to the eye */
+static int hit_sphere(const sphere_t *sph, double x, double y, double *z1, double *z2)
+{
+	double zsq;
+	x -= sph->cx;
+	y -= sph->cy;
+	zsq = sph->r * sph->r - (x * x + y * y);
+	if (zsq < 0) return 0;
+	zsq = sqrt(zsq);
+	*z1 = sph->cz - zsq;
+	*z2 = sph->cz + zsq;
+	return 1;
+}
+
+static void deathstar(HDC Screen, const double* light, double k, double ambient, int PosX, int PosY) {
+	int i, j, intensity, hit_result;
+	double b;
+	double vec[3], x, y, zb1, zb2, zs1, zs2;
+	int xCursor = PosX;
+	int yCursor = PosY;
+	for (i = floor(pos.cy - pos.r); i <= ceil(pos.cy + pos.r); i++) {
+		y = i + .5;
+		for (j = floor(pos.cx - 2 * pos.r); j <= ceil(pos.cx + 2 * pos.r); j++) {
+			x = (j - pos.cx) / 2. + .5 + pos.cx;
+
+			/* ray lands in blank space, draw bg */
+			if (!hit_sphere(&pos, x, y, &zb1, &zb2))
+				hit_result = 0;
+
+			/* ray hits pos sphere but not neg, draw pos sphere surface */
+			else if (!hit_sphere(&neg, x, y, &zs1, &zs2))
+				hit_result = 1;
+
+			/* ray hits both, but pos front surface is closer */
+			else if (zs1 > zb1) hit_result = 1;
+
+			/* pos sphere surface is inside neg sphere, show bg */
+			else if (zs2 > zb2) hit_result = 0;
+
+			/* back surface on neg sphere is inside pos sphere,
+			the only place where neg sphere surface will be shown */
+			else if (zs2 > zb1) hit_result = 2;
+			else		    hit_result = 1;
+
+			switch (hit_result) {
+			case 0:			
+				SetPixel(Screen, xCursor, yCursor, RGBA(0x0, 0x0, 0x0, 0xff));
+				xCursor++;
+				continue;
+			case 1:
+				vec[0] = x - pos.cx;
+				vec[1] = y - pos.cy;
+				vec[2] = zb1 - pos.cz;
+				break;
+			default:
+				vec[0] = neg.cx - x;
+				vec[1] = neg.cy - y;
+				vec[2] = neg.cz - zs2;
+			}
+
+			normalize(vec);
+			b = pow(dot(light, vec), k) + ambient;
+			intensity = (1 - b) * (256 - 1);
+			if (intensity < 0) intensity = 0;
+			if (intensity >= 256 - 1)
+				intensity = 256 - 2;
+			uint8_t shade = intensity;
+			SetPixel(Screen, xCursor, yCursor, RGBA(shade, shade, shade, 0xff));
+			xCursor++;
+		}
+		xCursor = PosX;
+		yCursor++;
+	}
+}
+
+/***************************************************************************}
+{						 FLOAT ROW SPANS INTO A ROW BUFFER					}
+****************************************************************************/
+
+/*--------------------------------------------------------------------------}
+{	 The shade table, pixel n is for a point lit n/DS_LUT_SIZE, the same	}
+{	 sum as the scalar demo so the two look alike							}
+{--------------------------------------------------------------------------*/
+static void MakeShadeTable (double k, double ambient)
+{
+	for (int n = 0; n <= DS_LUT_SIZE; n++) {
+		double b = pow((double)n / DS_LUT_SIZE, k) + ambient;
+		int intensity = (1 - b) * (256 - 1);
+		if (intensity < 0) intensity = 0;
+		if (intensity >= 256 - 1) intensity = 256 - 2;
+		ds.shade[n] = DS_BLACK | ((uint32_t)intensity * 0x010101);
+	}
+	ds.k = k;
+	ds.ambient = ambient;
+	ds.shadeMade = true;
+}
+
+#ifdef DS_NEON
+/*--------------------------------------------------------------------------}
+{	  Square root of 4 floats >= 0, AARCH32 NEON has only an estimate so	}
+{	  it is taken to full float with two newton steps						}
+{--------------------------------------------------------------------------*/
+static inline float32x4_t Sqrt4 (float32x4_t v)
+{
+#if __aarch64__ == 1
+	return vsqrtq_f32(v);
+#else
+	float32x4_t s = vmaxq_f32(v, vdupq_n_f32(1.0e-20f));			// Estimate of 0 is infinity
+	float32x4_t r = vrsqrteq_f32(s);								// 1/sqrt good to 8 bits
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(s, r), r));				// Newton step, 16 bits
+	r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(s, r), r));				// Newton step, full float
+	return vmulq_f32(v, r);											// sqrt(v) = v / sqrt(v)
+#endif
+}
+
+/*--------------------------------------------------------------------------}
+{	  4 pixels of a row from ray x, x + 0.5, x + 1 and x + 1.5 into dst		}
+{--------------------------------------------------------------------------*/
+static inline void ShadeFour (float32x4_t x, float zP, float zN, float lyP, float lyN, uint32_t* dst)
+{
+	float32x4_t zero = vdupq_n_f32(0.0f);
+	float32x4_t dxP = vsubq_f32(x, vdupq_n_f32(ds.pcx));
+	float32x4_t zsqP = vmlsq_f32(vdupq_n_f32(zP), dxP, dxP);		// Depth squared into the big sphere
+	uint32x4_t hitP = vcgeq_f32(zsqP, zero);
+	float32x4_t sP = Sqrt4(vmaxq_f32(zsqP, zero));
+	float32x4_t zb1 = vsubq_f32(vdupq_n_f32(ds.pcz), sP);
+	float32x4_t zb2 = vaddq_f32(vdupq_n_f32(ds.pcz), sP);
+	float32x4_t dxN = vsubq_f32(x, vdupq_n_f32(ds.ncx));
+	float32x4_t zsqN = vmlsq_f32(vdupq_n_f32(zN), dxN, dxN);		// Depth squared into the bite
+	uint32x4_t hitN = vcgeq_f32(zsqN, zero);
+	float32x4_t sN = Sqrt4(vmaxq_f32(zsqN, zero));
+	float32x4_t zs1 = vsubq_f32(vdupq_n_f32(ds.ncz), sN);
+	float32x4_t zs2 = vaddq_f32(vdupq_n_f32(ds.ncz), sN);
+	uint32x4_t c1 = vcgtq_f32(zs1, zb1);							// Big sphere front is nearer
+	uint32x4_t c2 = vcgtq_f32(zs2, zb2);							// Big sphere is all inside the bite
+	uint32x4_t c3 = vcgtq_f32(zs2, zb1);							// Bite back is inside the big sphere
+	uint32x4_t inBite = vandq_u32(vandq_u32(hitP, hitN), vbicq_u32(c3, vorrq_u32(c1, c2)));
+	uint32x4_t onBig = vbicq_u32(hitP, vandq_u32(vbicq_u32(hitN, c1), vorrq_u32(c2, c3)));
+
+	/* Light . surface normal, the normal is the centre to point vector / radius */
+	float32x4_t dP = vmlaq_f32(vdupq_n_f32(lyP), dxP, vdupq_n_f32(ds.lx));
+	dP = vmlsq_f32(dP, sP, vdupq_n_f32(ds.lz));
+	dP = vmulq_f32(dP, vdupq_n_f32(ds.invPr));
+	float32x4_t dN = vmlaq_f32(vdupq_n_f32(lyN), dxN, vdupq_n_f32(ds.lx));
+	dN = vmlaq_f32(dN, sN, vdupq_n_f32(ds.lz));
+	dN = vmulq_f32(dN, vdupq_n_f32(-ds.invNr));					// Bite normal points inwards
+	float32x4_t lit = vnegq_f32(vbslq_f32(inBite, dN, dP));
+	lit = vminq_f32(vmaxq_f32(lit, zero), vdupq_n_f32(1.0f));
+	uint32x4_t idx = vcvtq_u32_f32(vmlaq_f32(vdupq_n_f32(0.5f), lit, vdupq_n_f32(DS_LUT_SIZE)));
+
+	uint32_t __attribute__((aligned(16))) i[4];
+	vst1q_u32(&i[0], idx);
+	uint32_t __attribute__((aligned(16))) px[4] = { ds.shade[i[0]], ds.shade[i[1]], ds.shade[i[2]], ds.shade[i[3]] };
+	uint32x4_t shown = vorrq_u32(inBite, onBig);
+	vst1q_u32(dst, vbslq_u32(shown, vld1q_u32(&px[0]), vdupq_n_u32(DS_BLACK)));
+}
+#else
+/*--------------------------------------------------------------------------}
+{	  One pixel at ray x, the same sums as the NEON code one at a time		}
+{--------------------------------------------------------------------------*/
+static inline uint32_t ShadeOne (float x, float zP, float zN, float lyP, float lyN)
+{
+	float dxP = x - ds.pcx;
+	float zsqP = zP - dxP * dxP;
+	if (zsqP < 0.0f) return DS_BLACK;								// Misses the big sphere
+	float sP = sqrtf(zsqP);
+	float zb1 = ds.pcz - sP, zb2 = ds.pcz + sP;
+	float dxN = x - ds.ncx;
+	float zsqN = zN - dxN * dxN;
+	float d;
+	if (zsqN < 0.0f) d = (lyP + dxP * ds.lx - sP * ds.lz) * ds.invPr;// Misses the bite
+	else {
+		float sN = sqrtf(zsqN);
+		float zs1 = ds.ncz - sN, zs2 = ds.ncz + sN;
+		if (zs1 > zb1) d = (lyP + dxP * ds.lx - sP * ds.lz) * ds.invPr;
+		else if (zs2 > zb2) return DS_BLACK;						// Big sphere all inside the bite
+		else if (zs2 > zb1) d = -(lyN + dxN * ds.lx + sN * ds.lz) * ds.invNr;
+		else d = (lyP + dxP * ds.lx - sP * ds.lz) * ds.invPr;
+	}
+	float lit = (d < 0.0f) ? ((d > -1.0f) ? -d : 1.0f) : 0.0f;
+	return ds.shade[(uint32_t)(lit * DS_LUT_SIZE + 0.5f)];
+}
+#endif
+
+/*--------------------------------------------------------------------------}
+{	   Works out one row of the box into buf and sends it to the DC			}
+{--------------------------------------------------------------------------*/
+static void DrawRow (int row, uint32_t* buf)
+{
+	float y = ds.y0 + row;
+	float dyP = y - ds.pcy, dyN = y - ds.ncy;
+	float zP = ds.pr2 - dyP * dyP;									// Depth squared at dx = 0
+	float zN = ds.nr2 - dyN * dyN;
+	float lyP = ds.ly * dyP, lyN = ds.ly * dyN;
+	int start = 0, end = 0;
+	if (zP >= 0.0f) {												// Row crosses the big sphere
+		float h = sqrtf(zP);										// Half the span in ray x
+		start = (int)floorf(ds.pcx - 2.0f * h - 1.0f) - ds.firstJ - 1;	// Pixel j has ray x (j + pcx + 1) / 2
+		end = (int)ceilf(ds.pcx + 2.0f * h - 1.0f) - ds.firstJ + 2;
+		if (start < 0) start = 0;
+		if (end > ds.width) end = ds.width;
+		start &= ~3;												// Whole groups of 4 for NEON
+	}
+	int i;
+	for (i = 0; i < start; i++) buf[i] = DS_BLACK;
+	float x = (start + ds.firstJ + ds.pcx + 1.0f) * 0.5f;			// Ray x of the first pixel in the span
+#ifdef DS_NEON
+	static const float __attribute__((aligned(16))) steps[4] = { 0.0f, 0.5f, 1.0f, 1.5f };
+	float32x4_t xs = vaddq_f32(vdupq_n_f32(x), vld1q_f32(&steps[0]));
+	for (; i < end; i += 4) {										// Row buffer has room past the end
+		ShadeFour(xs, zP, zN, lyP, lyN, &buf[i]);
+		xs = vaddq_f32(xs, vdupq_n_f32(2.0f));
+	}
+#else
+	for (; i < end; i++, x += 0.5f)
+		buf[i] = ShadeOne(x, zP, zN, lyP, lyN);
+#endif
+	for (; i < ds.width; i++) buf[i] = DS_BLACK;
+	ImageLineOut(ds.dc, ds.posX, ds.posY + row, ds.width, PIXFMT_BGRA8888, (const uint8_t*)buf, 0);
+}
+
+/***************************************************************************}
+{							ROWS DEALT OUT TO THE CORES						}
+****************************************************************************/
+static void CoreRows (uint32_t core)
+{
+	for (int row = core; row < ds.rows; row += ds.cores)
+		DrawRow(row, &RowBuf[core][0]);
+}
+
+/*--------------------------------------------------------------------------}
+{	  CoreExecute passes nothing so each core has its own entry point		}
+{--------------------------------------------------------------------------*/
+static void CoreDone (uint32_t core)
+{
+	CoreRows(core);
+	__sync_synchronize();											// Rows written before the flag
+	ds.done[core] = ds.frame;
+}
+static void Core1Rows (void) { CoreDone(1); }
+static void Core2Rows (void) { CoreDone(2); }
+static void Core3Rows (void) { CoreDone(3); }
+static const CORECALLFUNC CoreEntry[DS_MAX_CORES] = { 0, Core1Rows, Core2Rows, Core3Rows };
+
+/***************************************************************************}
+{					      PUBLIC INTERFACE ROUTINES			                }
+****************************************************************************/
+
+/*-[DeathStar_Draw]---------------------------------------------------------}
+. Draws the death star with its box top left at (PosX, PosY). The light is
+. the unit vector it is lit from, k the shine power and ambient the light
+. every surface gets. Background in the box is drawn black.
+. RETURN: True for success, False if the star is too wide for DS_MAX_WIDTH
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool DeathStar_Draw (HDC dc, DS_MODE mode, const double light[3], double k, double ambient, int PosX, int PosY)
+{
+	if ((!dc) || (!light)) return false;
+	if (mode == DS_SCALAR) {
+		deathstar(dc, light, k, ambient, PosX, PosY);
+		return true;
+	}
+	int firstJ = floor(pos.cx - 2 * pos.r);
+	ds.width = (int)ceil(pos.cx + 2 * pos.r) - firstJ + 1;
+	if (ds.width + 3 > DS_MAX_WIDTH) return false;					// NEON may write 3 past the end
+	ds.firstJ = firstJ;
+	ds.rows = (int)ceil(pos.cy + pos.r) - (int)floor(pos.cy - pos.r) + 1;
+	ds.y0 = floor(pos.cy - pos.r) + 0.5f;
+	ds.dc = dc;
+	ds.posX = PosX;
+	ds.posY = PosY;
+	ds.lx = light[0];
+	ds.ly = light[1];
+	ds.lz = light[2];
+	ds.pcx = pos.cx; ds.pcy = pos.cy; ds.pcz = pos.cz;
+	ds.pr2 = pos.r * pos.r; ds.invPr = 1.0 / pos.r;
+	ds.ncx = neg.cx; ds.ncy = neg.cy; ds.ncz = neg.cz;
+	ds.nr2 = neg.r * neg.r; ds.invNr = 1.0 / neg.r;
+	if ((!ds.shadeMade) || (ds.k != k) || (ds.ambient != ambient))
+		MakeShadeTable(k, ambient);									// Only when k or ambient change
+	ds.cores = (mode == DS_MULTICORE) ? DeathStar_Cores() : 1;
+
+	/* Deal the rows out, core 0 takes the rows of any core that won't start */
+	bool started[DS_MAX_CORES] = { true };
+	ds.frame++;
+	__sync_synchronize();											// Frame set before the cores start
+	for (uint32_t core = 1; core < ds.cores; core++)
+		started[core] = CoreExecute(core, CoreEntry[core]);
+	CoreRows(0);
+	for (uint32_t core = 1; core < ds.cores; core++)
+		if (!started[core]) CoreRows(core);
+	for (uint32_t core = 1; core < ds.cores; core++)
+		if (started[core]) while (ds.done[core] != ds.frame) {};	// Wait for that core
+	__sync_synchronize();
+	return true;
+}
+
+/*-[DeathStar_Cores]--------------------------------------------------------}
+. RETURN: The cores DS_MULTICORE deals rows to, 1 if there is only core 0
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t DeathStar_Cores (void)
+{
+	uint32_t cores = RPi_CoresReady;
+	if (cores < 1) cores = 1;
+	if (cores > DS_MAX_CORES) cores = DS_MAX_CORES;
+	return cores;
+}
@@ -0,0 +1,84 @@
+#ifndef _DEATHSTAR_H_
+#define _DEATHSTAR_H_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-SmartStart.h"						// Needed for HDC
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: DeathStar.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The death star demo, a sphere with a bite taken out by a second sphere   }
+{  lit from one direction. It can be drawn three ways so they can be timed  }
+{  against each other on the same screen.                                   }
+{                                                                           }
+{  DS_SCALAR is the demo as it always was, both spheres hit in double for   }
+{  every pixel in the box and each pixel written with SetPixel.             }
+{                                                                           }
+{  DS_SIMD works a row at a time in float. Only the span of the row inside  }
+{  the big sphere is worked out, 4 pixels at once with NEON on a Pi2/Pi3    }
+{  (one at a time on a Pi1), into a row buffer sent with one ImageLineOut.  }
+{                                                                           }
+{  DS_MULTICORE is DS_SIMD with the rows dealt out to every core in turn,   }
+{  row n to core n % cores, by CoreExecute. The middle rows hold the most   }
+{  pixels so dealing them out keeps the cores evenly loaded.                }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define DS_MAX_CORES		4					// Cores that can share the rows
+#define DS_MAX_WIDTH		1024				// Widest row, the box is 4 radius + 1 wide
+
+/* The ways to draw it */
+typedef enum {
+	DS_SCALAR = 0,								// Double, every pixel through SetPixel
+	DS_SIMD = 1,								// Float row spans on one core
+	DS_MULTICORE = 2,							// Float row spans on every core
+	DS_MODES = 3								// Number of ways
+} DS_MODE;
+
+/*-[DeathStar_Draw]---------------------------------------------------------}
+. Draws the death star with its box top left at (PosX, PosY). The light is
+. the unit vector it is lit from, k the shine power and ambient the light
+. every surface gets. Background in the box is drawn black.
+. RETURN: True for success, False if the star is too wide for DS_MAX_WIDTH
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool DeathStar_Draw (HDC dc,											// Handle to the DC
+					 DS_MODE mode,										// Way to draw it
+					 const double light[3],								// Unit vector to light
+					 double k,											// Shine power
+					 double ambient,									// Ambient light
+					 int PosX,											// Box left
+					 int PosY);											// Box top
+
+/*-[DeathStar_Cores]--------------------------------------------------------}
+. RETURN: The cores DS_MULTICORE deals rows to, 1 if there is only core 0
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t DeathStar_Cores (void);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
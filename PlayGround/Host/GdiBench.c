@@ -0,0 +1,294 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, uint64_t etc
+#include <stdio.h>								// Needed for printf, snprintf
+#include <stdlib.h>								// Needed for atoi
+#include <string.h>								// Needed for strcmp
+#include "rpi-SmartStart.h"						// Console and GDI routines under test
+#include "HostFB.h"								// Host framebuffer emulation
+#include "DeathStar.h"							// Death star renderer under test
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: GdiBench.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host microbenchmark of the PlayGround GDI primitives at 16, 24 and 32    }
+{  bit colour depth. Each primitive is repeated until it has run for at    }
+{  least BENCH_MIN_US and the time per call and pixel rate are printed.    }
+{  A demo scene is then drawn and saved as scene16/24/32 .ppm and .png so   }
+{  output of a change can be compared against a previous build. With scene  }
+{  only the scenes are drawn, make check compares them to those in golden.  }
+{                                                                           }
+{  Usage: GdiBench [scene] [width height]     default 1024 x 768            }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define RGBA(r, g, b, a)  ( (COLORREF) ( (uint32_t)(b) | (uint32_t) ((uint32_t)g << 8) | (uint32_t) ((uint32_t)r << 16) | (uint32_t) ((uint32_t)a << 24) ) )
+
+#define BENCH_MIN_US	200000							// Each primitive runs at least this many usec
+#define BENCH_POINTS	4096							// Pseudo random co-ordinates in the table
+
+typedef void (*BENCHFUNC) (uint32_t i);					// Bench body, i is the repeat count
+
+static HDC Screen = 0;
+static uint32_t scrWth = 0;
+static uint32_t scrHt = 0;
+static POINT pts[BENCH_POINTS];							// Random co-ordinates on screen
+static uint8_t imgRow[4096 * 4];						// Source row for the image line tests
+static const double dsLight[3] = { 0.5773503, -0.5773503, -0.5773503 };	// Unit light for the death star
+
+/*--------------------------------------------------------------------------}
+{							BENCHMARK BODIES								}
+{--------------------------------------------------------------------------*/
+static void BenchSetPixel (uint32_t i)
+{
+	POINT* p = &pts[i % BENCH_POINTS];
+	SetPixel(Screen, p->x, p->y, RGBA(i, i >> 3, i >> 6, 0xFF));
+}
+
+static void BenchHorzLine (uint32_t i)
+{
+	MoveToEx(Screen, 16, 16 + (i & 255), 0);
+	LineTo(Screen, 16 + 512, 16 + (i & 255));
+}
+
+static void BenchVertLine (uint32_t i)
+{
+	MoveToEx(Screen, 16 + (i & 255), 16, 0);
+	LineTo(Screen, 16 + (i & 255), 16 + 512);
+}
+
+static void BenchDiagLine (uint32_t i)
+{
+	MoveToEx(Screen, 16, 16 + (i & 127), 0);
+	LineTo(Screen, 16 + 400, 16 + 300 + (i & 127));
+}
+
+static void BenchAALine (uint32_t i)
+{
+	SetLineAntiAlias(Screen, TRUE);
+	MoveToEx(Screen, 16, 16 + (i & 127), 0);
+	LineTo(Screen, 16 + 400, 16 + 300 + (i & 127));
+	SetLineAntiAlias(Screen, FALSE);
+}
+
+static void BenchRectangle (uint32_t i)
+{
+	int x = 16 + (i & 63);
+	Rectangle(Screen, x, 16, x + 200, 16 + 200);
+}
+
+static void BenchFillRect (uint32_t i)
+{
+	RECT rc = { 16 + (i & 63), 16, 16 + (i & 63) + 200, 16 + 200 };
+	FillRect(Screen, &rc);
+}
+
+static void BenchClearScreen (uint32_t i)
+{
+	RECT rc = { 0, 0, scrWth, scrHt };
+	FillRect(Screen, &rc);
+}
+
+static void BenchTextOut (uint32_t i)
+{
+	TextOut(Screen, 16, 16 + (i & 255), "The quick brown fox jumps over t", 32);
+}
+
+static void BenchPolygon (uint32_t i)
+{
+	POINT star[5] = { {135, 40}, {235, 320}, {15, 140}, {255, 140}, {35, 320} };
+	Polygon(Screen, star, 5);
+}
+
+static void BenchEllipse (uint32_t i)
+{
+	Ellipse(Screen, 16, 16, 16 + 200, 16 + 150);
+}
+
+static void BenchImageLine32 (uint32_t i)
+{
+	ImageLineOut(Screen, 0, i % scrHt, scrWth, PIXFMT_BGRA8888, &imgRow[0], 0);
+}
+
+static void BenchImageLine24 (uint32_t i)
+{
+	ImageLineOut(Screen, 0, i % scrHt, scrWth, PIXFMT_RGB888, &imgRow[0], 0);
+}
+
+static void BenchImageLine16 (uint32_t i)
+{
+	ImageLineOut(Screen, 0, i % scrHt, scrWth, PIXFMT_RGB565, &imgRow[0], 0);
+}
+
+static void BenchDeathStar (uint32_t i)
+{
+	DeathStar_Draw(Screen, DS_SCALAR, dsLight, 2.0, 0.3, 500, 100);
+}
+
+static void BenchDeathStarSimd (uint32_t i)
+{
+	DeathStar_Draw(Screen, DS_SIMD, dsLight, 2.0, 0.3, 500, 100);
+}
+
+static void BenchDeathStarCores (uint32_t i)
+{
+	DeathStar_Draw(Screen, DS_MULTICORE, dsLight, 2.0, 0.3, 500, 100);
+}
+
+/*--------------------------------------------------------------------------}
+{  Runs a bench body in doubling batches until BENCH_MIN_US has elapsed.    }
+{  pixels is the number of pixels one call writes (0 = not meaningful).     }
+{--------------------------------------------------------------------------*/
+static void RunBench (const char* name, BENCHFUNC fn, uint32_t pixels)
+{
+	uint64_t start, elapsed = 0;
+	uint32_t count = 0, batch = 16;
+	fn(0);															// Warm up caches and tables
+	start = timer_getTickCount64();
+	while (elapsed < BENCH_MIN_US) {
+		for (uint32_t i = 0; i < batch; i++) fn(count + i);			// Run the batch
+		count += batch;
+		if (batch < (1u << 20)) batch <<= 1;						// Double batch size
+		elapsed = tick_difference(start, timer_getTickCount64());
+	}
+	double ns = (double)elapsed * 1000.0 / count;					// Nanoseconds per call
+	if (pixels) printf("  %-16s %10.1f ns %9.1f Mpix/s\n", name, ns, (double)pixels * 1000.0 / ns);
+		else printf("  %-16s %10.1f ns %9s\n", name, ns, "-");
+}
+
+/*--------------------------------------------------------------------------}
+{  Draws the same scene as the PlayGround demo start up into the screen,    }
+{  with a ramp row through each ImageLineOut source format under it.        }
+{--------------------------------------------------------------------------*/
+static void DrawScene (void)
+{
+	RECT rc = { 0, 0, scrWth, scrHt };
+	POINT star[5] = { {255, 160}, {280, 230}, {220, 185}, {290, 185}, {230, 230} };
+	SetDCBrushColor(Screen, RGBA(0, 0, 0, 0xff));
+	FillRect(Screen, &rc);
+	SetDCBrushColor(Screen, RGBA(0, 0, 0xff, 0xff));
+	Rectangle(Screen, 100, 100, 200, 200);
+	SetTextColor(Screen, RGBA(0xff, 0, 0, 0xff));
+	TextOut(Screen, 300, 140, "HELLO WORLD!!", 13);
+	SetDCBrushColor(Screen, RGBA(0xff, 0xff, 0, 0xff));
+	SetDCPenColor(Screen, RGBA(0xff, 0, 0, 0xff));
+	Polygon(Screen, star, 5);
+	SetDCBrushColor(Screen, RGBA(0, 0x80, 0xff, 0xff));
+	Ellipse(Screen, 215, 100, 295, 150);
+	SetDCPenColor(Screen, RGBA(0xff, 0xff, 0xff, 0xff));
+	SetLineAntiAlias(Screen, TRUE);
+	MoveToEx(Screen, 300, 160, 0);
+	LineTo(Screen, 400, 230);
+	SetLineAntiAlias(Screen, FALSE);
+	for (uint32_t x = 0; x < 256; x++) {							// Colour ramp through the image line path
+		imgRow[x * 4] = x;
+		imgRow[x * 4 + 1] = 255 - x;
+		imgRow[x * 4 + 2] = x ^ 0x80;
+		imgRow[x * 4 + 3] = 0xFF;
+	}
+	for (uint32_t y = 260; y < 300; y++)
+		ImageLineOut(Screen, 100, y, 256, PIXFMT_BGRA8888, &imgRow[0], 0);
+
+	static const PIXEL_FORMAT fmts[5] = { PIXFMT_PAL8, PIXFMT_RGB555, PIXFMT_RGB565, PIXFMT_RGB888, PIXFMT_BGRA8888 };
+	RGBA palette[256];
+	uint8_t src[256 * 4];
+	for (uint32_t x = 0; x < 256; x++) {							// Grey palette reversed so it differs from the ramp
+		palette[x].rgbBlue = palette[x].rgbGreen = palette[x].rgbRed = 255 - x;
+		palette[x].rgbAlpha = 0;
+	}
+	for (int f = 0; f < 5; f++) {
+		uint32_t bpp = (fmts[f] + 7) / 8;
+		for (uint32_t i = 0; i < 256 * bpp; i++) src[i] = i * 13 + f;// Every bit pattern mix, different each format
+		for (uint32_t y = 0; y < 8; y++)
+			ImageLineOut(Screen, 100, 305 + f * 10 + y, 256, fmts[f], &src[0], &palette[0]);
+	}
+}
+
+int main (int argc, char* argv[])
+{
+	static const uint32_t depths[3] = { 16, 24, 32 };
+	uint32_t wth = 1024, ht = 768;
+	bool sceneOnly = false;
+	if ((argc >= 2) && (strcmp(argv[1], "scene") == 0)) {			// Scenes only, no timing
+		sceneOnly = true;
+		argc--;
+		argv++;
+	}
+	if (argc >= 3) {
+		wth = atoi(argv[1]);
+		ht = atoi(argv[2]);
+	}
+	if ((wth < 640) || (ht < 400) || (wth > 4096)) {
+		printf("Screen must be at least 640 x 400 and no wider than 4096\n");
+		return 1;
+	}
+	for (int d = 0; d < 3; d++) {
+		char name[32];
+		if (!PiConsole_Init(wth, ht, depths[d], 0)) {				// Framebuffer from emulated mailbox
+			printf("PiConsole_Init %ix%i %i bit failed\n", (int)wth, (int)ht, (int)depths[d]);
+			return 1;
+		}
+		Screen = GetConsoleDC();
+		scrWth = GetConsole_Width();
+		scrHt = GetConsole_Height();
+		for (uint32_t i = 0, s = 12345; i < BENCH_POINTS; i++) {	// Same co-ordinates each depth
+			s = s * 1103515245 + 12345;
+			pts[i].x = (s >> 8) % scrWth;
+			s = s * 1103515245 + 12345;
+			pts[i].y = (s >> 8) % scrHt;
+		}
+		for (uint32_t i = 0; i < sizeof(imgRow); i++) imgRow[i] = i * 7;
+
+		printf("%i x %i %i bit colour\n", (int)scrWth, (int)scrHt, (int)depths[d]);
+		if (!sceneOnly) {
+			SetDCPenColor(Screen, RGBA(0xff, 0xff, 0xff, 0xff));
+			SetDCBrushColor(Screen, RGBA(0x20, 0x60, 0xa0, 0xff));
+			SetTextColor(Screen, RGBA(0xff, 0xff, 0, 0xff));
+			RunBench("SetPixel", BenchSetPixel, 1);
+			RunBench("LineTo horz", BenchHorzLine, 512);
+			RunBench("LineTo vert", BenchVertLine, 512);
+			RunBench("LineTo diag", BenchDiagLine, 400);
+			RunBench("LineTo AA", BenchAALine, 400);
+			RunBench("Rectangle", BenchRectangle, 200 * 200);
+			RunBench("FillRect", BenchFillRect, 200 * 200);
+			RunBench("FillRect screen", BenchClearScreen, scrWth * scrHt);
+			RunBench("TextOut 32 ch", BenchTextOut, 32 * BitFontWth * BitFontHt);
+			RunBench("Polygon star", BenchPolygon, 0);
+			RunBench("Ellipse", BenchEllipse, 23562);			// PI/4 * 200 * 150
+			RunBench("ImageLine 16", BenchImageLine16, scrWth);
+			RunBench("ImageLine 24", BenchImageLine24, scrWth);
+			RunBench("ImageLine 32", BenchImageLine32, scrWth);
+			RunBench("DeathStar scalar", BenchDeathStar, 161 * 81);	// Box is 161 x 81
+			RunBench("DeathStar simd", BenchDeathStarSimd, 161 * 81);
+			RunBench("DeathStar cores", BenchDeathStarCores, 161 * 81);
+		}
+
+		DrawScene();
+		snprintf(name, sizeof(name), "scene%i.ppm", (int)depths[d]);
+		if (!HostFB_SavePPM(name)) {
+			printf("Could not write %s\n", name);
+			return 1;
+		}
+		snprintf(name, sizeof(name), "scene%i.png", (int)depths[d]);
+		if (!HostFB_SavePNG(name)) {
+			printf("Could not write %s\n", name);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,425 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, uint64_t etc
+#include <stdio.h>								// Needed for FILE, fopen, fwrite
+#include <string.h>								// Needed for memset
+#include <time.h>								// Needed for clock_gettime
+#include <sys/mman.h>							// Needed for mmap, munmap
+#include "rpi-SmartStart.h"						// Smartstart types and tag enumerations
+#include "HostFB.h"								// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: HostFB.c													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The console code keeps the framebuffer address in a 32 bit GPU address  }
+{  so the emulated framebuffer is mapped below 4GB and the ARM to GPU bus  }
+{  address conversions are simply identity on the host.                    }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/***************************************************************************}
+{      PUBLIC MEMORY VARIABLES NORMALLY PROVIDED BY SmartStartxx.S          }
+{***************************************************************************/
+uint32_t RPi_IO_Base_Addr = 0;					// No IO on host, any register access faults
+uint32_t RPi_BootAddr = 0;						// Not used on host
+uint32_t RPi_CoresReady = 1;					// Only the calling core is available
+CPU_ID RPi_CpuId = { .Raw32 = 0x410FD034 };		// Report a Cortex A53 (Pi3)
+CODE_TYPE RPi_CompileMode = { .ArmCodeTarget = ARM8_CODE, .AArchMode = AARCH64, .CoresSupported = 1 };
+uint32_t RPi_CPUBootMode = 0;					// Not used on host
+uint32_t RPi_CPUCurrentMode = 0;				// Not used on host
+
+/***************************************************************************}
+{                     PRIVATE INTERNAL MEMORY VARIABLES                     }
+{***************************************************************************/
+static struct {
+	uint8_t* fb;													// Framebuffer memory
+	uint32_t fbSize;												// Framebuffer size in bytes
+	uint32_t physWth;												// Physical width reported by GET tags
+	uint32_t physHt;												// Physical height reported by GET tags
+	uint32_t physDepth;												// Colour depth reported by GET tags
+	uint32_t wth;													// Width set by SET tags
+	uint32_t ht;													// Height set by SET tags
+	uint32_t depth;													// Colour depth set by SET tags
+	uint32_t pitch;													// Line pitch in bytes of allocated framebuffer
+	uint32_t armClock;												// Emulated ARM clock rate
+} host = { 0, 0, 1024, 768, 32, 1024, 768, 32, 0, 600000000 };
+
+/*--------------------------------------------------------------------------}
+{					 VC4 FRAMEBUFFER ALLOCATE / RELEASE						}
+{--------------------------------------------------------------------------*/
+static void HostReleaseFB (void)
+{
+	if (host.fb) munmap(host.fb, host.fbSize);						// Release any current framebuffer
+	host.fb = 0;													// Clear framebuffer pointer
+	host.fbSize = 0;												// Clear framebuffer size
+	host.pitch = 0;													// Clear pitch
+}
+
+static bool HostAllocateFB (void)
+{
+	void* p;
+	HostReleaseFB();												// Release any old framebuffer
+	if ((host.depth != 16) && (host.depth != 24) && (host.depth != 32))
+		return false;												// Console only has 16, 24 and 32 bit code
+	host.pitch = host.wth * (host.depth / 8);						// Tight pitch, same as firmware for usual modes
+	host.fbSize = host.pitch * host.ht;								// Framebuffer size in bytes
+#ifdef MAP_32BIT
+	p = mmap(0, host.fbSize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);			// Map below 4GB so a 32 bit address holds it
+#else
+	p = mmap((void*)0x10000000, host.fbSize, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);						// Hint a low address where MAP_32BIT is missing
+#endif
+	if ((p == MAP_FAILED) || ((uintptr_t)p + host.fbSize > 0xFFFFFFFFul)) {
+		if (p != MAP_FAILED) munmap(p, host.fbSize);				// Mapped too high to be a GPU address
+		host.fbSize = 0;											// No framebuffer
+		return false;												// Allocate failed
+	}
+	host.fb = p;													// Hold framebuffer pointer
+	return true;													// Framebuffer allocated
+}
+
+/*--------------------------------------------------------------------------}
+{						 PNG CHUNK WRITE HELPERS							}
+{--------------------------------------------------------------------------*/
+static uint32_t crcTable[256] = { 0 };
+
+static uint32_t Crc32 (uint32_t crc, const uint8_t* p, uint32_t len)
+{
+	if (crcTable[1] == 0) {											// Build table on first use
+		for (uint32_t n = 0; n < 256; n++) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			crcTable[n] = c;
+		}
+	}
+	crc = ~crc;
+	while (len--) crc = crcTable[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void PutBE32 (uint8_t* p, uint32_t v)
+{
+	p[0] = v >> 24; p[1] = v >> 16; p[2] = v >> 8; p[3] = v;		// Big endian as PNG requires
+}
+
+static void PngChunkStart (FILE* f, const char* type, uint32_t len, uint32_t* crc)
+{
+	uint8_t hdr[8];
+	PutBE32(&hdr[0], len);											// Chunk data length
+	memcpy(&hdr[4], type, 4);										// Chunk type
+	fwrite(hdr, 1, 8, f);
+	*crc = Crc32(0, &hdr[4], 4);									// CRC covers type and data
+}
+
+static void PngChunkData (FILE* f, const uint8_t* p, uint32_t len, uint32_t* crc)
+{
+	fwrite(p, 1, len, f);
+	*crc = Crc32(*crc, p, len);
+}
+
+static void PngChunkEnd (FILE* f, uint32_t crc)
+{
+	uint8_t b[4];
+	PutBE32(&b[0], crc);
+	fwrite(b, 1, 4, f);
+}
+
+/*--------------------------------------------------------------------------}
+{  Converts one framebuffer row to 8 bit R,G,B triples. Memory order of the }
+{  framebuffer is blue first for 24/32 bit just as RGBTRIPLE and RGBA are.  }
+{--------------------------------------------------------------------------*/
+static void RowToRGB (uint32_t y, uint8_t* dst)
+{
+	const uint8_t* src = host.fb + y * host.pitch;
+	for (uint32_t x = 0; x < host.wth; x++, dst += 3) {
+		switch (host.depth) {
+		case 16: {
+			uint16_t c = src[x * 2] | (src[x * 2 + 1] << 8);		// RGB565 little endian
+			uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+			dst[0] = (r << 3) | (r >> 2);							// Expand 5 bits to 8
+			dst[1] = (g << 2) | (g >> 4);							// Expand 6 bits to 8
+			dst[2] = (b << 3) | (b >> 2);							// Expand 5 bits to 8
+			break;
+		}
+		case 24:
+			dst[0] = src[x * 3 + 2];
+			dst[1] = src[x * 3 + 1];
+			dst[2] = src[x * 3];
+			break;
+		default:
+			dst[0] = src[x * 4 + 2];
+			dst[1] = src[x * 4 + 1];
+			dst[2] = src[x * 4];
+			break;
+		}
+	}
+}
+
+/***************************************************************************}
+{              HOST REPLACEMENTS CALLED FROM rpi-SmartStart.c               }
+{***************************************************************************/
+
+/*-[HostTimerTicks]---------------------------------------------------------}
+. Host stand in for the 1Mhz ARM system timer.
+. RETURN: Monotonic tick count in microseconds
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint64_t HostTimerTicks (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);							// Host monotonic clock
+	return (uint64_t)ts.tv_sec * 1000000ull + ts.tv_nsec / 1000;	// As microseconds
+}
+
+/*-[HostMailboxProperty]----------------------------------------------------}
+. Processes a property tag message exactly where the VC4 would, answering
+. the display, clock and board tags the SmartStart code uses. Each tag is
+. marked as a response and the message is marked successful. Unknown tags
+. are left unanswered as the firmware does.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void HostMailboxProperty (uint32_t* message)
+{
+	uint32_t i = 2;
+	bool ok = true;
+	uint32_t words = message[0] / 4;								// Message size in uint32_t
+	while ((i + 2 < words) && (message[i] != 0)) {
+		uint32_t tag = message[i];									// Tag id
+		uint32_t bufSize = message[i + 1];							// Tag value buffer size in bytes
+		uint32_t* v = &message[i + 3];								// Tag value buffer
+		uint32_t respLen = 0;										// Response length in bytes
+		switch (tag) {
+		case MAILBOX_TAG_GET_BOARD_REVISION:
+			v[0] = 0xA02082;										// Pi3 model B
+			respLen = 4;
+			break;
+		case MAILBOX_TAG_GET_BOARD_MODEL:
+			v[0] = 0;
+			respLen = 4;
+			break;
+		case MAILBOX_TAG_GET_CLOCK_RATE:
+		case MAILBOX_TAG_GET_MAX_CLOCK_RATE:
+		case MAILBOX_TAG_GET_MIN_CLOCK_RATE:
+			if (v[0] == CLK_ARM_ID) {
+				v[1] = (tag == MAILBOX_TAG_GET_CLOCK_RATE) ? host.armClock
+					: (tag == MAILBOX_TAG_GET_MAX_CLOCK_RATE) ? 1200000000 : 600000000;
+			} else v[1] = 250000000;								// Core and other clocks at 250Mhz
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_SET_CLOCK_RATE:
+			if (v[0] == CLK_ARM_ID) host.armClock = v[1];			// Only ARM clock is tracked
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_GET_TEMPERATURE:
+			v[1] = 45000;											// 45 degrees C
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_SET_GPIO_STATE:
+		case MAILBOX_TAG_SET_POWER_STATE:
+			respLen = 8;											// Accepted and ignored
+			break;
+		case MAILBOX_TAG_GET_PHYSICAL_WIDTH_HEIGHT:
+			v[0] = host.physWth;
+			v[1] = host.physHt;
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_GET_VIRTUAL_WIDTH_HEIGHT:
+			v[0] = host.wth;
+			v[1] = host.ht;
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_SET_PHYSICAL_WIDTH_HEIGHT:
+		case MAILBOX_TAG_SET_VIRTUAL_WIDTH_HEIGHT:
+			host.wth = v[0];
+			host.ht = v[1];
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_GET_COLOUR_DEPTH:
+			v[0] = host.physDepth;
+			respLen = 4;
+			break;
+		case MAILBOX_TAG_SET_COLOUR_DEPTH:
+			host.depth = v[0];
+			respLen = 4;
+			break;
+		case MAILBOX_TAG_ALLOCATE_FRAMEBUFFER:
+			if (HostAllocateFB()) {
+				v[0] = (uint32_t)(uintptr_t)host.fb;				// Framebuffer GPU address
+				v[1] = host.fbSize;									// Framebuffer size
+			} else {
+				v[0] = 0;
+				v[1] = 0;
+				ok = false;											// Fail the message like a bad mode would
+			}
+			respLen = 8;
+			break;
+		case MAILBOX_TAG_RELEASE_FRAMEBUFFER:
+			HostReleaseFB();
+			break;
+		case MAILBOX_TAG_GET_PITCH:
+			v[0] = host.pitch;
+			respLen = 4;
+			break;
+		default:
+			break;
+		}
+		if (respLen) message[i + 2] = 0x80000000 | respLen;			// Mark tag as responded
+		i += 3 + (bufSize + 3) / 4;									// Move to next tag
+	}
+	message[1] = ok ? 0x80000000 : 0x80000001;						// Message response code
+}
+
+/***************************************************************************}
+{            HOST STUBS FOR ROUTINES PROVIDED BY SmartStartxx.S             }
+{***************************************************************************/
+void EnableInterrupts (void) {}
+void DisableInterrupts (void) {}
+
+bool CoreExecute (uint8_t coreNum, CORECALLFUNC func)
+{
+	return false;													// No other cores on host
+}
+
+uint32_t ARMaddrToGPUaddr (void* ARMaddress)
+{
+	return (uint32_t)(uintptr_t)ARMaddress;							// Identity on host
+}
+
+uint32_t GPUaddrToARMaddr (uint32_t GPUaddress)
+{
+	return GPUaddress;												// Identity on host
+}
+
+void PUT32 (uint32_t addr, uint32_t value) {}						// No IO on host
+
+uint32_t GET32 (uint32_t addr)
+{
+	return 0;														// No IO on host
+}
+
+TimerIrqHandler setTimerIrqAddress (TimerIrqHandler ARMaddress)
+{
+	static TimerIrqHandler handler = 0;
+	TimerIrqHandler old = handler;
+	handler = ARMaddress;											// Held but never called, no interrupts on host
+	return old;
+}
+
+/***************************************************************************}
+{                       PUBLIC C INTERFACE ROUTINES                         }
+{***************************************************************************/
+
+/*-[HostFB_SetDisplay]------------------------------------------------------}
+. Sets the physical screen size and colour depth the emulated VC4 reports
+. when PiConsole_Init is asked for auto width, height or depth (0 values).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void HostFB_SetDisplay (uint32_t width, uint32_t height, uint32_t depth)
+{
+	host.physWth = width;
+	host.physHt = height;
+	host.physDepth = depth;
+}
+
+/*-[HostFB_Buffer]----------------------------------------------------------}
+. Returns the current emulated framebuffer and optionally its geometry.
+. RETURN: Framebuffer pointer, NULL if no framebuffer has been allocated
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint8_t* HostFB_Buffer (uint32_t* width, uint32_t* height, uint32_t* depth, uint32_t* pitch)
+{
+	if (width) *width = host.wth;
+	if (height) *height = host.ht;
+	if (depth) *depth = host.depth;
+	if (pitch) *pitch = host.pitch;
+	return host.fb;
+}
+
+/*-[HostFB_SavePPM]---------------------------------------------------------}
+. Writes the current framebuffer to a binary (P6) PPM file.
+. RETURN: true file written, false no framebuffer or file error
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool HostFB_SavePPM (const char* filename)
+{
+	static uint8_t row[8192 * 3];
+	FILE* f;
+	if ((host.fb == 0) || (host.wth > 8192)) return false;			// No framebuffer or too wide for row buffer
+	f = fopen(filename, "wb");
+	if (f == 0) return false;										// File create failed
+	fprintf(f, "P6\n%u %u\n255\n", (unsigned)host.wth, (unsigned)host.ht);
+	for (uint32_t y = 0; y < host.ht; y++) {
+		RowToRGB(y, &row[0]);										// Convert row to RGB
+		fwrite(&row[0], 3, host.wth, f);							// Write the row
+	}
+	return (fclose(f) == 0);
+}
+
+/*-[HostFB_SavePNG]---------------------------------------------------------}
+. Writes the current framebuffer to a 24 bit RGB PNG file using stored
+. deflate blocks, one zlib block per row (rows are under 64K bytes).
+. RETURN: true file written, false no framebuffer or file error
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool HostFB_SavePNG (const char* filename)
+{
+	static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	static uint8_t row[5 + 1 + 8192 * 3];
+	uint8_t ihdr[13], b[4];
+	uint32_t crc, rowLen, adlerA = 1, adlerB = 0;
+	FILE* f;
+	if ((host.fb == 0) || (host.wth > 8192)) return false;			// No framebuffer or too wide for row buffer
+	f = fopen(filename, "wb");
+	if (f == 0) return false;										// File create failed
+	fwrite(sig, 1, 8, f);											// PNG signature
+
+	PutBE32(&ihdr[0], host.wth);									// Width
+	PutBE32(&ihdr[4], host.ht);										// Height
+	ihdr[8] = 8;													// 8 bits per channel
+	ihdr[9] = 2;													// Colour type RGB
+	ihdr[10] = 0; ihdr[11] = 0; ihdr[12] = 0;						// Deflate, adaptive filter, no interlace
+	PngChunkStart(f, "IHDR", 13, &crc);
+	PngChunkData(f, ihdr, 13, &crc);
+	PngChunkEnd(f, crc);
+
+	rowLen = 1 + host.wth * 3;										// Filter byte plus RGB row
+	PngChunkStart(f, "IDAT", 2 + host.ht * (5 + rowLen) + 4, &crc);
+	b[0] = 0x78; b[1] = 0x01;										// Zlib header, 32K window no compression
+	PngChunkData(f, b, 2, &crc);
+	for (uint32_t y = 0; y < host.ht; y++) {
+		row[0] = (y == host.ht - 1) ? 1 : 0;						// Stored block, final flag on last row
+		row[1] = rowLen & 0xFF; row[2] = rowLen >> 8;				// LEN
+		row[3] = ~rowLen & 0xFF; row[4] = (~rowLen >> 8) & 0xFF;	// NLEN
+		row[5] = 0;													// Filter type none
+		RowToRGB(y, &row[6]);										// Convert row to RGB
+		for (uint32_t i = 0; i < rowLen; i++) {
+			adlerA = (adlerA + row[5 + i]) % 65521;					// Adler32 over uncompressed data
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+		PngChunkData(f, row, 5 + rowLen, &crc);
+	}
+	PutBE32(&b[0], (adlerB << 16) | adlerA);						// Zlib Adler32 trailer
+	PngChunkData(f, b, 4, &crc);
+	PngChunkEnd(f, crc);
+
+	PngChunkStart(f, "IEND", 0, &crc);
+	PngChunkEnd(f, crc);
+	return (fclose(f) == 0);
+}
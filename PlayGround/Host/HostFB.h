@@ -0,0 +1,82 @@
+#ifndef _HOST_FB_H_
+#define _HOST_FB_H_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: HostFB.h													}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Host (Linux) stand in for the Pi hardware used by rpi-SmartStart.c when  }
+{  it is compiled with SMARTSTART_HOST=1. The VC4 mailbox property tags     }
+{  are answered from a plain memory framebuffer, the 1Mhz system timer      }
+{  comes from the host monotonic clock and the SmartStart assembler stub    }
+{  symbols are provided. The framebuffer can be dumped as PPM or PNG.       }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/***************************************************************************}
+{                       PUBLIC C INTERFACE ROUTINES                         }
+{***************************************************************************/
+
+/*-[HostFB_SetDisplay]------------------------------------------------------}
+. Sets the physical screen size and colour depth the emulated VC4 reports
+. when PiConsole_Init is asked for auto width, height or depth (0 values).
+. Defaults to 1024 x 768 at 32 bit.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void HostFB_SetDisplay (uint32_t width,								// Physical screen width
+						uint32_t height,							// Physical screen height
+						uint32_t depth);							// Screen colour depth 16, 24 or 32
+
+/*-[HostFB_Buffer]----------------------------------------------------------}
+. Returns the current emulated framebuffer and optionally its geometry.
+. RETURN: Framebuffer pointer, NULL if no framebuffer has been allocated
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint8_t* HostFB_Buffer (uint32_t* width,							// Width return (NULL = not wanted)
+						uint32_t* height,							// Height return (NULL = not wanted)
+						uint32_t* depth,							// Colour depth return (NULL = not wanted)
+						uint32_t* pitch);							// Line pitch in bytes return (NULL = not wanted)
+
+/*-[HostFB_SavePPM]---------------------------------------------------------}
+. Writes the current framebuffer to a binary (P6) PPM file, 16 and 32 bit
+. pixels are expanded to 8 bits per channel, alpha is dropped.
+. RETURN: true file written, false no framebuffer or file error
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool HostFB_SavePPM (const char* filename);
+
+/*-[HostFB_SavePNG]---------------------------------------------------------}
+. Writes the current framebuffer to a 24 bit RGB PNG file. The image data
+. is written as stored (uncompressed) deflate blocks so no zlib is needed.
+. RETURN: true file written, false no framebuffer or file error
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool HostFB_SavePNG (const char* filename);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
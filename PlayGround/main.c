@@ -8,6 +8,7 @@
 
 #include "rpi-SmartStart.h"
 #include "emb-stdio.h"
+#include "DeathStar.h"
 
 int __errno = 0;
 static HDC Screen = { 0 };
@@ -34,93 +35,6 @@ void normalize(double * v)
 	v[0] /= len; v[1] /= len; v[2] /= len;
 }
 
-double dot(double *x, double *y)
-{
-	double d = x[0] * y[0] + x[1] * y[1] + x[2] * y[2];
-	return d < 0 ? -d : 0;
-}
-
-typedef struct { double cx, cy, cz, r; } sphere_t;
-
-/* positive shpere and negative sphere */
-sphere_t pos = { 40, 40, 0, 40 }, neg = { 1, 1, -6, 40 };
-
-/* check if a ray (x,y, -inf)->(x, y, inf) hits a sphere; if so, return
-the intersecting z values.  z1 is closer to the eye */
-int hit_sphere(sphere_t *sph, double x, double y, double *z1, double *z2)
-{
-	double zsq;
-	x -= sph->cx;
-	y -= sph->cy;
-	zsq = sph->r * sph->r - (x * x + y * y);
-	if (zsq < 0) return 0;
-	zsq = sqrt(zsq);
-	*z1 = sph->cz - zsq;
-	*z2 = sph->cz + zsq;
-	return 1;
-}
-
-void deathstar(double k, double ambient, int PosX, int PosY) {
-	int i, j, intensity, hit_result;
-	double b;
-	double vec[3], x, y, zb1, zb2, zs1, zs2;
-	int xCursor = PosX;
-	int yCursor = PosY;
-	for (i = floor(pos.cy - pos.r); i <= ceil(pos.cy + pos.r); i++) {
-		y = i + .5;
-		for (j = floor(pos.cx - 2 * pos.r); j <= ceil(pos.cx + 2 * pos.r); j++) {
-			x = (j - pos.cx) / 2. + .5 + pos.cx;
-
-			/* ray lands in blank space, draw bg */
-			if (!hit_sphere(&pos, x, y, &zb1, &zb2))
-				hit_result = 0;
-
-			/* ray hits pos sphere but not neg, draw pos sphere surface */
-			else if (!hit_sphere(&neg, x, y, &zs1, &zs2))
-				hit_result = 1;
-
-			/* ray hits both, but pos front surface is closer */
-			else if (zs1 > zb1) hit_result = 1;
-
-			/* pos sphere surface is inside neg sphere, show bg */
-			else if (zs2 > zb2) hit_result = 0;
-
-			/* back surface on neg sphere is inside pos sphere,
-			the only place where neg sphere surface will be shown */
-			else if (zs2 > zb1) hit_result = 2;
-			else		    hit_result = 1;
-
-			switch (hit_result) {
-			case 0:			
-				SetPixel(Screen, xCursor, yCursor, RGBA(0x0, 0x0, 0x0, 0xff));
-				xCursor++;
-				continue;
-			case 1:
-				vec[0] = x - pos.cx;
-				vec[1] = y - pos.cy;
-				vec[2] = zb1 - pos.cz;
-				break;
-			default:
-				vec[0] = neg.cx - x;
-				vec[1] = neg.cy - y;
-				vec[2] = neg.cz - zs2;
-			}
-
-			normalize(vec);
-			b = pow(dot(light, vec), k) + ambient;
-			intensity = (1 - b) * (256 - 1);
-			if (intensity < 0) intensity = 0;
-			if (intensity >= 256 - 1)
-				intensity = 256 - 2;
-			uint8_t shade = intensity;
-			SetPixel(Screen, xCursor, yCursor, RGBA(shade, shade, shade, 0xff));
-			xCursor++;
-		}
-		xCursor = PosX;
-		yCursor++;
-	}
-}
-
 /* IFS DISPLAY DEMO STUFF */
 
 typedef struct {
@@ -304,9 +218,29 @@ void main (void) {
 	SetTextColor(Screen, RGBA(0xff, 0, 0, 0xff));
 	TextOut(Screen, 300, 140, "HELLO WORLD!!", 13);
 
+	/* Span filled vector shapes */
+	POINT star[5] = { {255, 160}, {280, 230}, {220, 185}, {290, 185}, {230, 230} };
+	SetDCBrushColor(Screen, RGBA(0xff, 0xff, 0, 0xff));
+	SetDCPenColor(Screen, RGBA(0xff, 0, 0, 0xff));
+	Polygon(Screen, star, 5);
+	SetDCBrushColor(Screen, RGBA(0, 0x80, 0xff, 0xff));
+	Ellipse(Screen, 215, 100, 295, 150);
+	SetDCPenColor(Screen, RGBA(0xff, 0xff, 0xff, 0xff));
+	SetLineAntiAlias(Screen, TRUE);
+	MoveToEx(Screen, 300, 160, 0);
+	LineTo(Screen, 400, 230);
+	SetLineAntiAlias(Screen, FALSE);
+
 
 	Matrix_Rain(20, 295);
 
+	/* Death star drawn each way in turn, 2 seconds a time, to compare them */
+	DS_MODE dsMode = DS_SCALAR;
+	uint32_t dsRate[DS_MODES] = { 0 };								// Draws a second each way last managed
+	uint32_t dsDraws = 0;
+	uint64_t dsUs = 0;
+	uint64_t dsModeEnd = timer_getTickCount64() + 2000000ul;		// 2 seconds from now
+
 	double ang = 0;
 	while (1) {
 		set_Activity_LED(false); // Activity led on
@@ -317,7 +251,23 @@ void main (void) {
 		normalize(light);
 		ang += .05;
 
-		deathstar(2.0, .3, 500, 100);
+		uint64_t dsStart = timer_getTickCount64();
+		DeathStar_Draw(Screen, dsMode, light, 2.0, .3, 500, 100);
+		dsUs += tick_difference(dsStart, timer_getTickCount64());
+		dsDraws++;
+		if (timer_getTickCount64() >= dsModeEnd) {
+			char dsText[80];
+			dsRate[dsMode] = (dsUs) ? (uint32_t)(dsDraws * 1000000ull / dsUs) : 0;
+			int n = snprintf(dsText, sizeof(dsText), "Deathstar draws/s: scalar %-5u simd %-5u %u cores %-5u",
+				(unsigned)dsRate[DS_SCALAR], (unsigned)dsRate[DS_SIMD],
+				(unsigned)DeathStar_Cores(), (unsigned)dsRate[DS_MULTICORE]);
+			SetTextColor(Screen, RGBA(0xff, 0xff, 0xff, 0xff));
+			TextOut(Screen, 500, 190, dsText, n);
+			dsMode = (dsMode + 1) % DS_MODES;							// Next way to draw it
+			dsDraws = 0;
+			dsUs = 0;
+			dsModeEnd = timer_getTickCount64() + 2000000ul;
+		}
 
 		set_Activity_LED(false); // Activity led off
 
@@ -34,6 +34,19 @@
 #include "Font8x16.h"							// Provides the 8x16 bitmap font for console 
 #include "rpi-SmartStart.h"						// This units header
 
+/*--------------------------------------------------------------------------}
+{  SMARTSTART_HOST = 1 builds this unit as a normal Linux program, the VC   }
+{  mailbox and system timer are then supplied by Host/HostFB.c so the       }
+{  console and GDI code can be run and timed without a Pi.                  }
+{--------------------------------------------------------------------------*/
+#if !defined(SMARTSTART_HOST)
+#define SMARTSTART_HOST 0
+#endif
+#if SMARTSTART_HOST == 1
+extern void HostMailboxProperty (uint32_t* message);				// Host emulation of the VC property tag channel
+extern uint64_t HostTimerTicks (void);								// Host 1Mhz tick count
+#endif
+
 /***************************************************************************}
 {       PRIVATE INTERNAL RASPBERRY PI REGISTER STRUCTURE DEFINITIONS        }
 ****************************************************************************/
@@ -510,6 +523,8 @@ typedef struct __attribute__((__packed__, aligned(4))) tagINTDC {
 	RGBA BkColor;													// Background colour to write
 	RGBA BrushColor;												// Brush colour to write
 
+	/* Line drawing control */
+	bool AntiAlias;													// Lines are drawn anti-aliased
 
 	/* Function pointers that are set to graphics primitives depending on colour depth */
 	COLORREF (*SetPixel) (struct tagINTDC* dc, uint_fast32_t x, uint_fast32_t y, COLORREF crColor);
@@ -520,6 +535,8 @@ typedef struct __attribute__((__packed__, aligned(4))) tagINTDC {
 	void (*WriteChar) (struct tagINTDC* dc, uint8_t Ch);
 	void (*TransparentWriteChar) (struct tagINTDC* dc, uint8_t Ch);
 	void (*PutImage) (struct tagINTDC* dc, uint_fast32_t dx, uint_fast32_t dy, HBITMAP imgSrc, bool BottomUp);
+	void (*FillSpan) (struct tagINTDC* dc, uint_fast32_t x1, uint_fast32_t x2, uint_fast32_t y, RGBA col);
+	void (*BlendPixel) (struct tagINTDC* dc, uint_fast32_t x, uint_fast32_t y, RGBA col, uint_fast8_t alpha);
 } INTDC;
 
 
@@ -698,6 +715,9 @@ bool gpio_fixResistor (uint_fast8_t gpio, GPIO_FIX_RESISTOR resistor)
 .--------------------------------------------------------------------------*/
 uint64_t timer_getTickCount (void) 
 {
+#if SMARTSTART_HOST == 1
+	return (HostTimerTicks() / 1000);								// Host tick count converted to milliseconds
+#else
 	uint64_t resVal;
 	uint32_t lowCount;
 	do {
@@ -707,6 +727,7 @@ uint64_t timer_getTickCount (void)
 	resVal = (uint64_t)resVal << 32 | lowCount;						// Join the 32 bit values to a full 64 bit
 	resVal /= 1000;													// Convert to milliseconds					
 	return(resVal);													// Return the uint64_t timer tick count
+#endif
 }
 
 /*-[timer_getTickCount64]---------------------------------------------------}
@@ -717,6 +738,9 @@ uint64_t timer_getTickCount (void)
 .--------------------------------------------------------------------------*/
 uint64_t timer_getTickCount64 (void)
 {
+#if SMARTSTART_HOST == 1
+	return HostTimerTicks();										// Host tick count already in microseconds
+#else
 	uint64_t resVal;
 	uint32_t lowCount;
 	do {
@@ -725,6 +749,7 @@ uint64_t timer_getTickCount64 (void)
 	} while (resVal != (uint64_t)SYSTEMTIMER->TimerHi);				// Check hi counter hasn't rolled in that time
 	resVal = (uint64_t)resVal << 32 | lowCount;						// Join the 32 bit values to a full 64 bit
 	return(resVal);													// Return the uint64_t timer tick count
+#endif
 }
 
 /*-[timer_Wait]-------------------------------------------------------------}
@@ -820,8 +845,12 @@ bool mailbox_tag_message (uint32_t* response_buf,					// Pointer to response buf
 		message[2 + i] = va_arg(list, uint32_t);					// Fetch next variadic
 	}
 	va_end(list);													// variadic cleanup								
+#if SMARTSTART_HOST == 1
+	HostMailboxProperty(&message[0]);								// Host answers the property tags directly
+#else
 	mailbox_write(MB_CHANNEL_TAGS, ARMaddrToGPUaddr(&message[0]));	// Write message to mailbox
 	mailbox_read(MB_CHANNEL_TAGS);									// Wait for write response	
+#endif
 	if (message[1] == 0x80000000) {
 		if (response_buf) {											// If buffer NULL used then don't want response
 			for (int i = 0; i < data_count; i++)
@@ -1119,33 +1148,148 @@ BOOL MoveToEx(HDC hdc,
 	return FALSE;
 }
 
+/*-[INTERNAL: ClipLine]----------------------------------------------------}
+. Cohen-Sutherland clip of the line (x0,y0)-(x1,y1) to the DC bounds. The
+. end points are moved onto the DC edge where they lie outside.
+. RETURN: True if any part of the line is visible, false otherwise
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+#define CLIP_LEFT	1
+#define CLIP_RIGHT	2
+#define CLIP_TOP	4
+#define CLIP_BOTTOM	8
+static uint_fast8_t ClipCode (INTDC* dc, int_fast32_t x, int_fast32_t y) {
+	uint_fast8_t code = 0;
+	if (x < 0) code |= CLIP_LEFT;
+		else if (x >= (int_fast32_t)dc->wth) code |= CLIP_RIGHT;
+	if (y < 0) code |= CLIP_TOP;
+		else if (y >= (int_fast32_t)dc->ht) code |= CLIP_BOTTOM;
+	return code;
+}
+
+static bool ClipLine (INTDC* dc, int_fast32_t* x0, int_fast32_t* y0, int_fast32_t* x1, int_fast32_t* y1) {
+	int_fast32_t xmax = dc->wth - 1;
+	int_fast32_t ymax = dc->ht - 1;
+	uint_fast8_t code0 = ClipCode(dc, *x0, *y0);
+	uint_fast8_t code1 = ClipCode(dc, *x1, *y1);
+	while (code0 | code1) {											// Either end outside
+		if (code0 & code1) return false;							// Both ends outside same edge
+		uint_fast8_t code = (code0) ? code0 : code1;				// Pick an end that is outside
+		int64_t dx = *x1 - *x0;
+		int64_t dy = *y1 - *y0;
+		int_fast32_t x, y;
+		if (code & CLIP_TOP) {
+			x = *x0 + (int_fast32_t)(dx * (0 - *y0) / dy);
+			y = 0;
+		} else if (code & CLIP_BOTTOM) {
+			x = *x0 + (int_fast32_t)(dx * (ymax - *y0) / dy);
+			y = ymax;
+		} else if (code & CLIP_LEFT) {
+			y = *y0 + (int_fast32_t)(dy * (0 - *x0) / dx);
+			x = 0;
+		} else {
+			y = *y0 + (int_fast32_t)(dy * (xmax - *x0) / dx);
+			x = xmax;
+		}
+		if (code == code0) {										// Start point was clipped
+			*x0 = x;
+			*y0 = y;
+			code0 = ClipCode(dc, x, y);
+		} else {													// End point was clipped
+			*x1 = x;
+			*y1 = y;
+			code1 = ClipCode(dc, x, y);
+		}
+	}
+	return true;
+}
+
+/*-[INTERNAL: AALine]-------------------------------------------------------}
+. Xiaolin Wu anti-aliased line from (x0,y0) up to, but not including, the
+. point (x1,y1) in the current pen colour. The line must be pre-clipped.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void AALine (INTDC* dc, int_fast32_t x0, int_fast32_t y0, int_fast32_t x1, int_fast32_t y1) {
+	int_fast32_t t;
+	bool steep = (abs(y1 - y0) > abs(x1 - x0));						// Step along y if line is steep
+	if (steep) {
+		t = x0; x0 = y0; y0 = t;
+		t = x1; x1 = y1; y1 = t;
+	}
+	bool reversed = (x0 > x1);										// Always step from left to right
+	if (reversed) {
+		t = x0; x0 = x1; x1 = t;
+		t = y0; y0 = y1; y1 = t;
+	}
+	int_fast32_t dx = x1 - x0;
+	if (dx == 0) return;											// Zero length line
+	int32_t grad = (int32_t)(((int64_t)(y1 - y0) * 65536) / dx);		// 16.16 fixed point gradient
+	int32_t yf = (int32_t)(y0 * 65536);								// 16.16 fixed point y position
+	int_fast32_t xs = (reversed) ? x0 + 1 : x0;						// Endpoint is never drawn
+	int_fast32_t xe = (reversed) ? x1 : x1 - 1;
+	yf += grad * (xs - x0);
+	int_fast32_t lim = (steep) ? dc->wth : dc->ht;					// Limit of the minor axis
+	for (int_fast32_t x = xs; x <= xe; x++) {
+		int_fast32_t y = yf >> 16;									// Integer part of y
+		uint_fast8_t frac = (yf >> 8) & 0xFF;						// Fraction of y is coverage
+		if (y >= 0 && y < lim) {
+			if (steep) dc->BlendPixel(dc, y, x, dc->TxtColor, 255 - frac);
+				else dc->BlendPixel(dc, x, y, dc->TxtColor, 255 - frac);
+		}
+		if (frac && (y + 1) >= 0 && (y + 1) < lim) {
+			if (steep) dc->BlendPixel(dc, y + 1, x, dc->TxtColor, frac);
+				else dc->BlendPixel(dc, x, y + 1, dc->TxtColor, frac);
+		}
+		yf += grad;
+	}
+}
+
+/*-[INTERNAL: ClippedLine]--------------------------------------------------}
+. Draws the line (x0,y0)-(x1,y1) clipped to the DC bounds using the depth
+. specific line routines or anti-aliased if the DC has that set. On return
+. the current position is the end of the visible part of the line.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void ClippedLine (INTDC* dc, int_fast32_t x0, int_fast32_t y0, int_fast32_t x1, int_fast32_t y1) {
+	if (!ClipLine(dc, &x0, &y0, &x1, &y1)) return;					// Line not visible
+	if (dc->AntiAlias) {
+		AALine(dc, x0, y0, x1, y1);									// Anti-aliased line
+		return;
+	}
+	int_fast8_t xdir, ydir;
+	uint_fast32_t dx, dy;
+	dc->curPos.x = x0;												// Start at clipped start
+	dc->curPos.y = y0;
+	if (x1 < x0) {
+		dx = x0 - x1;
+		xdir = -1;
+	}
+	else {
+		dx = x1 - x0;
+		xdir = 1;
+	}
+	if (y1 < y0) {
+		dy = y0 - y1;
+		ydir = -1;
+	}
+	else {
+		dy = y1 - y0;
+		ydir = 1;
+	}
+	if (dx == 0) dc->VertLine(dc, dy, ydir);
+	else if (dy == 0) dc->HorzLine(dc, dx, xdir);
+	else dc->DiagLine(dc, dx, dy, xdir, ydir);
+}
+
 BOOL LineTo(HDC hdc,
 	int nXEnd,
 	int nYEnd)
 {
 	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
 	if (intDC) {													// Pointer valid
-		int_fast8_t xdir, ydir;
-		uint_fast32_t dx, dy;
-		if (nXEnd < intDC->curPos.x) {
-			dx = intDC->curPos.x - nXEnd;
-			xdir = -1;
-		}
-		else {
-			dx = nXEnd - intDC->curPos.x;
-			xdir = 1;
-		}
-		if (nYEnd < intDC->curPos.y) {
-			dy = intDC->curPos.y - nYEnd;
-			ydir = -1;
-		}
-		else {
-			dy = nYEnd - intDC->curPos.y;
-			ydir = 1;
-		}
-		if (dx == 0) intDC->VertLine(intDC, dy, ydir);
-		else if (dy == 0) intDC->HorzLine(intDC, dx, xdir);
-		else intDC->DiagLine(intDC, dx, dy, xdir, ydir);
+		ClippedLine(intDC, intDC->curPos.x, intDC->curPos.y, nXEnd, nYEnd);
+		intDC->curPos.x = nXEnd;									// Current position is line end
+		intDC->curPos.y = nYEnd;
 		return TRUE;
 	}
 	return FALSE;
@@ -1207,6 +1351,210 @@ BOOL BmpOut(HDC hdc,
 	return FALSE;
 }
 
+/*--------------------------------------------------------------------------}
+{					ROW BASED PIXEL FORMAT CONVERSION						}
+{--------------------------------------------------------------------------*/
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>								// Pi2/Pi3 builds have NEON for the row converters
+#define ROW_CONVERT_NEON
+#endif
+
+#define CVT_CHUNK 256								// Pixels per pass through a staging buffer
+
+/*-[INTERNAL: RowToRGBA]----------------------------------------------------}
+. Expands count pixels of the source format out to 32 bit RGBA. The NEON path
+. does 16 (RGB888) or 8 (RGB555/RGB565) pixels a step with the scalar loop
+. picking up the tail and doing all the work on the Pi1. Alpha is always set
+. opaque.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void RowToRGBA (PIXEL_FORMAT fmt, const uint8_t* src, RGBA* dst, uint_fast32_t count, const RGBA* palette) {
+	uint_fast32_t i = 0;
+	switch (fmt) {
+	case PIXFMT_PAL8:
+		for (; i < count; i++) {
+			dst[i] = palette[src[i]];								// Palette lookup
+			dst[i].rgbAlpha = 0xFF;									// BMP palettes have zero alpha
+		}
+		break;
+	case PIXFMT_RGB565:
+#ifdef ROW_CONVERT_NEON
+		for (; i + 8 <= count; i += 8) {
+			uint16x8_t p = vld1q_u16((const uint16_t*)&src[i * 2]);	// Load 8 RGB565 pixels
+			uint8x8x4_t o;
+			o.val[2] = vshrn_n_u16(p, 8);							// Red to top 5 bits
+			o.val[2] = vsri_n_u8(o.val[2], o.val[2], 5);			// Replicate into low 3 bits
+			o.val[1] = vshrn_n_u16(vshlq_n_u16(p, 5), 8);			// Green to top 6 bits
+			o.val[1] = vsri_n_u8(o.val[1], o.val[1], 6);			// Replicate into low 2 bits
+			o.val[0] = vshrn_n_u16(vshlq_n_u16(p, 11), 8);			// Blue to top 5 bits
+			o.val[0] = vsri_n_u8(o.val[0], o.val[0], 5);			// Replicate into low 3 bits
+			o.val[3] = vdup_n_u8(0xFF);								// Opaque alpha
+			vst4_u8((uint8_t*)&dst[i], o);							// Store 8 interleaved RGBA
+		}
+#endif
+		for (; i < count; i++) {
+			uint_fast16_t p = src[i * 2] | (src[i * 2 + 1] << 8);	// Fetch RGB565 pixel
+			uint_fast8_t r = (p >> 8) & 0xF8;
+			uint_fast8_t g = (p >> 3) & 0xFC;
+			uint_fast8_t b = (p << 3) & 0xF8;
+			dst[i].rgbRed = r | (r >> 5);
+			dst[i].rgbGreen = g | (g >> 6);
+			dst[i].rgbBlue = b | (b >> 5);
+			dst[i].rgbAlpha = 0xFF;
+		}
+		break;
+	case PIXFMT_RGB555:
+#ifdef ROW_CONVERT_NEON
+		for (; i + 8 <= count; i += 8) {
+			uint16x8_t p = vld1q_u16((const uint16_t*)&src[i * 2]);	// Load 8 X1R5G5B5 pixels
+			uint8x8x4_t o;
+			o.val[2] = vshrn_n_u16(vshlq_n_u16(p, 1), 8);			// Red to top 5 bits
+			o.val[2] = vsri_n_u8(o.val[2], o.val[2], 5);			// Replicate into low 3 bits
+			o.val[1] = vshrn_n_u16(vshlq_n_u16(p, 6), 8);			// Green to top 5 bits
+			o.val[1] = vsri_n_u8(o.val[1], o.val[1], 5);			// Replicate into low 3 bits
+			o.val[0] = vshrn_n_u16(vshlq_n_u16(p, 11), 8);			// Blue to top 5 bits
+			o.val[0] = vsri_n_u8(o.val[0], o.val[0], 5);			// Replicate into low 3 bits
+			o.val[3] = vdup_n_u8(0xFF);								// Opaque alpha
+			vst4_u8((uint8_t*)&dst[i], o);							// Store 8 interleaved RGBA
+		}
+#endif
+		for (; i < count; i++) {
+			uint_fast16_t p = src[i * 2] | (src[i * 2 + 1] << 8);	// Fetch X1R5G5B5 pixel
+			uint_fast8_t r = (p >> 7) & 0xF8;
+			uint_fast8_t g = (p >> 2) & 0xF8;
+			uint_fast8_t b = (p << 3) & 0xF8;
+			dst[i].rgbRed = r | (r >> 5);
+			dst[i].rgbGreen = g | (g >> 5);
+			dst[i].rgbBlue = b | (b >> 5);
+			dst[i].rgbAlpha = 0xFF;
+		}
+		break;
+	case PIXFMT_RGB888:
+#ifdef ROW_CONVERT_NEON
+		for (; i + 16 <= count; i += 16) {
+			uint8x16x3_t v = vld3q_u8(&src[i * 3]);					// Load 16 RGB triples deinterleaved
+			uint8x16x4_t o;
+			o.val[0] = v.val[0];
+			o.val[1] = v.val[1];
+			o.val[2] = v.val[2];
+			o.val[3] = vdupq_n_u8(0xFF);							// Opaque alpha
+			vst4q_u8((uint8_t*)&dst[i], o);							// Store 16 interleaved RGBA
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i].rgbBlue = src[i * 3];
+			dst[i].rgbGreen = src[i * 3 + 1];
+			dst[i].rgbRed = src[i * 3 + 2];
+			dst[i].rgbAlpha = 0xFF;
+		}
+		break;
+	case PIXFMT_BGRA8888:
+		memcpy(dst, src, count * 4);								// Already RGBA
+		break;
+	}
+}
+
+/*-[INTERNAL: RowFromRGBA]--------------------------------------------------}
+. Packs count 32 bit RGBA pixels down to the given destination depth. The
+. NEON path does 16 (24 bit) or 8 (16 bit) pixels a step with the scalar loop
+. picking up the tail and doing all the work on the Pi1.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void RowFromRGBA (uint_fast32_t depth, const RGBA* src, uint8_t* dst, uint_fast32_t count) {
+	uint_fast32_t i = 0;
+	switch (depth) {
+	case 16:
+#ifdef ROW_CONVERT_NEON
+		for (; i + 8 <= count; i += 8) {
+			uint8x8x4_t v = vld4_u8((const uint8_t*)&src[i]);		// Load 8 RGBA deinterleaved
+			uint16x8_t p = vshll_n_u8(v.val[2], 8);					// Red to top of 16 bits
+			p = vsriq_n_u16(p, vshll_n_u8(v.val[1], 8), 5);			// Insert green below red
+			p = vsriq_n_u16(p, vshll_n_u8(v.val[0], 8), 11);		// Insert blue below green
+			vst1q_u16((uint16_t*)&dst[i * 2], p);					// Store 8 RGB565 pixels
+		}
+#endif
+		for (; i < count; i++) {
+			uint_fast16_t p = ((src[i].rgbRed & 0xF8) << 8) | ((src[i].rgbGreen & 0xFC) << 3) | (src[i].rgbBlue >> 3);
+			dst[i * 2] = p & 0xFF;
+			dst[i * 2 + 1] = p >> 8;
+		}
+		break;
+	case 24:
+#ifdef ROW_CONVERT_NEON
+		for (; i + 16 <= count; i += 16) {
+			uint8x16x4_t v = vld4q_u8((const uint8_t*)&src[i]);		// Load 16 RGBA deinterleaved
+			uint8x16x3_t o;
+			o.val[0] = v.val[0];
+			o.val[1] = v.val[1];
+			o.val[2] = v.val[2];
+			vst3q_u8(&dst[i * 3], o);								// Store 16 interleaved RGB triples
+		}
+#endif
+		for (; i < count; i++) {
+			dst[i * 3] = src[i].rgbBlue;
+			dst[i * 3 + 1] = src[i].rgbGreen;
+			dst[i * 3 + 2] = src[i].rgbRed;
+		}
+		break;
+	case 32:
+		memcpy(dst, src, count * 4);								// Already RGBA
+		break;
+	}
+}
+
+/*-[INTERNAL: ConvertRow]---------------------------------------------------}
+. Converts count pixels from the source format to the destination depth. Same
+. format rows are copied, rows to or from 32 bit go direct and anything else
+. is staged through a small RGBA buffer so any width row can be converted.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void ConvertRow (PIXEL_FORMAT fmt, const uint8_t* src, uint_fast32_t depth, uint8_t* dst, uint_fast32_t count, const RGBA* palette) {
+	if ((uint_fast32_t)fmt == depth) memcpy(dst, src, count * (depth / 8));// Formats match just copy
+	else if (depth == 32) RowToRGBA(fmt, src, (RGBA*)dst, count, palette);// Expand direct to destination
+	else if (fmt == PIXFMT_BGRA8888) RowFromRGBA(depth, (const RGBA*)src, dst, count);// Pack direct from source
+	else {
+		RGBA __attribute__((aligned(16))) buffer[CVT_CHUNK];		// Staging buffer
+		uint_fast32_t srcBpp = (fmt + 7) / 8;						// Source bytes per pixel
+		uint_fast32_t dstBpp = depth / 8;							// Destination bytes per pixel
+		while (count) {
+			uint_fast32_t n = (count > CVT_CHUNK) ? CVT_CHUNK : count;// Pixels this pass
+			RowToRGBA(fmt, src, &buffer[0], n, palette);			// Expand to RGBA
+			RowFromRGBA(depth, &buffer[0], dst, n);					// Pack to destination
+			src += n * srcBpp;
+			dst += n * dstBpp;
+			count -= n;
+		}
+	}
+}
+
+BOOL ImageLineOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	uint32_t cX,
+	PIXEL_FORMAT srcFormat,
+	const uint8_t* imgSrc,
+	const RGBA* palette)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if ((intDC) && (imgSrc) && ((srcFormat == PIXFMT_RGB555) || (srcFormat == PIXFMT_RGB565) || (srcFormat == PIXFMT_RGB888) ||
+		(srcFormat == PIXFMT_BGRA8888) || ((srcFormat == PIXFMT_PAL8) && (palette)))) {
+		int_fast32_t nXEnd = nXStart + cX;
+		if ((nYStart < 0) || (nYStart >= (int_fast32_t)intDC->ht)) return TRUE;// Row is off the DC
+		if (nXStart < 0) {											// Clip left
+			imgSrc += (0 - nXStart) * ((srcFormat + 7) / 8);
+			nXStart = 0;
+		}
+		if (nXEnd > (int_fast32_t)intDC->wth) nXEnd = intDC->wth;	// Clip right
+		if (nXStart < nXEnd) {
+			uint_fast32_t dstBpp = intDC->depth / 8;				// Destination bytes per pixel
+			uint8_t* dst = (uint8_t*)(uintptr_t)(intDC->fb + ((nYStart * intDC->pitch) + nXStart) * dstBpp);
+			ConvertRow(srcFormat, imgSrc, intDC->depth, dst, nXEnd - nXStart, palette);
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
+
 BOOL CvtBmpLine (HDC hdc,
 	uint32_t nXStart,
 	uint32_t nYStart,
@@ -1214,108 +1562,157 @@ BOOL CvtBmpLine (HDC hdc,
 	uint32_t imgDepth,
 	uint8_t* imgSrc)
 {
-	HBITMAP p;
-	uint8_t __attribute__((aligned(4))) buffer[4096];
-	p.rawImage = &buffer[0];
-	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
-	if (intDC) {													// Pointer valid
-		intDC->curPos.x = nXStart;
-		intDC->curPos.y = nYStart;
-		if (intDC->depth != imgDepth) {
-			switch (intDC->depth) {
-				case 16:
-					if (imgDepth == 24) {
-						RGBTRIPLE val;
-						RGB565 out;
-						RGB565* __attribute__((aligned(2))) video_wr_ptrD = (RGB565*)(uintptr_t)&buffer[0];
-						RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptrS = (RGBTRIPLE*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.R = val.rgbRed >> 3;
-							out.G =  val.rgbGreen >> 2;
-							out.B = val.rgbBlue >> 3;
-							*video_wr_ptrD++ = out;
-						}
-					} else {
-						RGBA val;
-						RGB565 out;
-						RGB565* __attribute__((aligned(2))) video_wr_ptrD = (RGB565*)(uintptr_t)&buffer[0];
-						RGBA* __attribute__((aligned(4))) video_wr_ptrS = (RGBA*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.R = val.rgbRed >> 3;
-							out.G = val.rgbGreen >> 2;
-							out.B = val.rgbBlue >> 3;
-							*video_wr_ptrD++ = out;
-						}
-					}
-					break;
-				case 24:
-					if (imgDepth == 16) {
-						RGB565 val;
-						RGBTRIPLE out;
-						RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptrD = (RGBTRIPLE*)(uintptr_t)&buffer[0];
-						RGB565* __attribute__((aligned(2))) video_wr_ptrS = (RGB565*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.rgbRed = val.R << 3;
-							out.rgbGreen = val.G << 2;
-							out.rgbBlue = val.B << 3;
-							*video_wr_ptrD++ = out;
-						}
-					} else {
-						RGBA val;
-						RGBTRIPLE out;
-						RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptrD = (RGBTRIPLE*)(uintptr_t)&buffer[0];
-						RGBA* __attribute__((aligned(4))) video_wr_ptrS = (RGBA*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.rgbRed = val.rgbRed;
-							out.rgbGreen = val.rgbGreen;
-							out.rgbBlue = val.rgbBlue;
-							*video_wr_ptrD++ = out;
-						}
-					}
-					break;
-				case 32:
-					if (imgDepth == 16) {
-						RGB565 val;
-						RGBA out;
-						RGBA* __attribute__((aligned(4))) video_wr_ptrD = (RGBA*)(uintptr_t)&buffer[0];
-						RGB565* __attribute__((aligned(2))) video_wr_ptrS = (RGB565*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.rgbRed = val.R << 3;
-							out.rgbGreen = val.G << 2;
-							out.rgbBlue = val.B << 3;
-							*video_wr_ptrD++ = out;
-						}
-					}
-					else {
-						RGBTRIPLE val;
-						RGBA out;
-						RGBA* __attribute__((aligned(4))) video_wr_ptrD = (RGBA*)(uintptr_t)&buffer[0];
-						RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptrS = (RGBTRIPLE*)(uintptr_t)&imgSrc[0];
-						for (unsigned int i = 0; i < cX; i++) {
-							val = *video_wr_ptrS++;
-							out.rgbRed = val.rgbRed;
-							out.rgbGreen = val.rgbGreen;
-							out.rgbBlue = val.rgbBlue;
-							*video_wr_ptrD++ = out;
-						}
-					}
-					break;
-			}
+	return ImageLineOut(hdc, nXStart, nYStart, cX, (PIXEL_FORMAT)imgDepth, imgSrc, 0);
+}
+
+/*-[INTERNAL: BmpHeaderCheck]-----------------------------------------------}
+. Checks the bitmap headers describe an image the conversion pipeline can
+. handle and returns the pixel format, row stride, palette size and draw
+. direction. masks are the BI_BITFIELDS red, green and blue masks (NULL for
+. BI_RGB), only the 555 and 565 masks at 16 bit and the 8 bits a channel
+. masks at 32 bit are accepted. 16 bit BI_RGB is X1R5G5B5 as per the spec.
+. RETURN: True if the bitmap can be drawn, false otherwise
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool BmpHeaderCheck (const BITMAPFILEHEADER* bmpHeader, const BITMAPINFOHEADER* bmpInfo, const uint32_t* masks, PIXEL_FORMAT* fmt, uint32_t* stride, uint32_t* palCount, uint32_t* height, bool* bottomUp) {
+	if (bmpHeader->bfType != 0x4D42) return false;					// Not "BM"
+	if ((bmpInfo->biCompression != 0) && (bmpInfo->biCompression != 3)) return false;// Only BI_RGB or BI_BITFIELDS
+	if ((bmpInfo->biCompression == 3) && (!masks)) return false;	// Bitfields need their masks
+	*palCount = 0;
+	switch (bmpInfo->biBitCount) {
+	case 8:
+		if (bmpInfo->biCompression != 0) return false;				// Bitfields are 16 or 32 bit only
+		*palCount = (bmpInfo->biClrUsed) ? bmpInfo->biClrUsed : 256;
+		if (*palCount > 256) return false;
+		*fmt = PIXFMT_PAL8;
+		break;
+	case 16:
+		*fmt = PIXFMT_RGB555;										// BI_RGB 16 bit is X1R5G5B5
+		if (bmpInfo->biCompression == 3) {
+			if ((masks[0] == 0xF800) && (masks[1] == 0x07E0) && (masks[2] == 0x001F)) *fmt = PIXFMT_RGB565;
+				else if ((masks[0] != 0x7C00) || (masks[1] != 0x03E0) || (masks[2] != 0x001F)) return false;
+		}
+		break;
+	case 24:
+		if (bmpInfo->biCompression != 0) return false;				// Bitfields are 16 or 32 bit only
+		*fmt = PIXFMT_RGB888;
+		break;
+	case 32:
+		if ((bmpInfo->biCompression == 3) &&
+			((masks[0] != 0x00FF0000) || (masks[1] != 0x0000FF00) || (masks[2] != 0x000000FF))) return false;
+		*fmt = PIXFMT_BGRA8888;
+		break;
+	default:
+		return false;												// Depth not supported
+	}
+	int32_t h = (int32_t)bmpInfo->biHeight;							// Negative height is top down
+	*bottomUp = (h > 0);
+	*height = (h > 0) ? (uint32_t)h : (uint32_t)(0 - h);
+	*stride = ((bmpInfo->biWidth * bmpInfo->biBitCount + 31) / 32) * 4;// Rows are padded to 4 bytes
+	return true;
+}
+
+BOOL BmpFileOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	const uint8_t* bmpFile)
+{
+	if ((hdc) && (bmpFile)) {
+		BITMAPFILEHEADER bmpHeader;
+		BITMAPINFOHEADER bmpInfo;
+		RGBA palette[256];
+		uint32_t masks[3];
+		uint32_t stride, palCount, height;
+		PIXEL_FORMAT fmt;
+		bool bottomUp;
+		memcpy(&bmpHeader, bmpFile, sizeof(bmpHeader));				// File image may not be aligned
+		memcpy(&bmpInfo, &bmpFile[sizeof(bmpHeader)], sizeof(bmpInfo));
+		if (bmpInfo.biCompression == 3)								// Masks follow the info header fields
+			memcpy(&masks[0], &bmpFile[sizeof(bmpHeader) + sizeof(bmpInfo)], sizeof(masks));
+		if (!BmpHeaderCheck(&bmpHeader, &bmpInfo, (bmpInfo.biCompression == 3) ? &masks[0] : 0,
+			&fmt, &stride, &palCount, &height, &bottomUp)) return FALSE;
+		if (palCount) memcpy(&palette[0], &bmpFile[sizeof(bmpHeader) + bmpInfo.biSize], palCount * sizeof(RGBA));
+		const uint8_t* row = &bmpFile[bmpHeader.bfOffBits];			// First row of image data
+		for (uint32_t y = 0; y < height; y++) {
+			int_fast32_t dy = (bottomUp) ? nYStart + height - 1 - y : nYStart + y;
+			ImageLineOut(hdc, nXStart, dy, bmpInfo.biWidth, fmt, row, &palette[0]);
+			row += stride;											// Next row of image data
 		}
-		intDC->PutImage(intDC, cX, 1, p, true);
 		return TRUE;
 	}
 	return FALSE;
 }
 
+/*-[INTERNAL: StreamSkip]---------------------------------------------------}
+. Reads and discards count bytes from the stream.
+. RETURN: True if all the bytes were read, false otherwise
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool StreamSkip (HANDLE hFile, IMGREADFUNC readHandler, uint32_t count) {
+	uint8_t buf[64];
+	while (count) {
+		uint32_t n = (count > sizeof(buf)) ? sizeof(buf) : count;
+		uint32_t bytesRead = 0;
+		if (!readHandler(hFile, &buf[0], n, &bytesRead, 0) || (bytesRead != n)) return false;
+		count -= n;
+	}
+	return true;
+}
 
-
-
+BOOL BmpStreamOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	HANDLE hFile,
+	IMGREADFUNC readHandler)
+{
+	if ((hdc) && (readHandler)) {
+		BITMAPFILEHEADER bmpHeader;
+		BITMAPINFOHEADER bmpInfo;
+		RGBA palette[256];
+		uint8_t __attribute__((aligned(16))) buf[CVT_CHUNK * 4];	// One chunk of the largest pixel format
+		uint32_t masks[3];
+		uint32_t stride, palCount, height, bytesRead, pos;
+		PIXEL_FORMAT fmt;
+		bool bottomUp;
+		if (!readHandler(hFile, &bmpHeader, sizeof(bmpHeader), &bytesRead, 0) || (bytesRead != sizeof(bmpHeader)) ||
+			!readHandler(hFile, &bmpInfo, sizeof(bmpInfo), &bytesRead, 0) || (bytesRead != sizeof(bmpInfo)) ||
+			(bmpInfo.biSize < sizeof(bmpInfo))) return FALSE;
+		pos = sizeof(bmpHeader) + sizeof(bmpInfo);					// Track position in file
+		if (bmpInfo.biCompression == 3) {							// Masks follow the info header fields
+			if (!readHandler(hFile, &masks[0], sizeof(masks), &bytesRead, 0) ||
+				(bytesRead != sizeof(masks))) return FALSE;
+			pos += sizeof(masks);
+		}
+		if (!BmpHeaderCheck(&bmpHeader, &bmpInfo, (bmpInfo.biCompression == 3) ? &masks[0] : 0,
+			&fmt, &stride, &palCount, &height, &bottomUp)) return FALSE;
+		if (pos < sizeof(bmpHeader) + bmpInfo.biSize) {				// Skip the rest of an extended header
+			if (!StreamSkip(hFile, readHandler, sizeof(bmpHeader) + bmpInfo.biSize - pos)) return FALSE;
+			pos = sizeof(bmpHeader) + bmpInfo.biSize;
+		}
+		if (palCount) {
+			if (!readHandler(hFile, &palette[0], palCount * sizeof(RGBA), &bytesRead, 0) ||
+				(bytesRead != palCount * sizeof(RGBA))) return FALSE;
+			pos += palCount * sizeof(RGBA);
+		}
+		if ((bmpHeader.bfOffBits < pos) ||
+			!StreamSkip(hFile, readHandler, bmpHeader.bfOffBits - pos)) return FALSE;// Move to image data
+		uint32_t srcBpp = bmpInfo.biBitCount / 8;					// Source bytes per pixel
+		uint32_t pad = stride - (bmpInfo.biWidth * srcBpp);			// Row padding bytes
+		for (uint32_t y = 0; y < height; y++) {
+			int_fast32_t dy = (bottomUp) ? nYStart + height - 1 - y : nYStart + y;
+			for (uint32_t x = 0; x < bmpInfo.biWidth; x += CVT_CHUNK) {// Row is read a chunk at a time
+				uint32_t n = bmpInfo.biWidth - x;
+				if (n > CVT_CHUNK) n = CVT_CHUNK;
+				if (!readHandler(hFile, &buf[0], n * srcBpp, &bytesRead, 0) ||
+					(bytesRead != n * srcBpp)) return FALSE;
+				ImageLineOut(hdc, nXStart + x, dy, n, fmt, &buf[0], &palette[0]);
+			}
+			if (!StreamSkip(hFile, readHandler, pad)) return FALSE;	// Skip row padding
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
 
 /*--------------------------------------------------------------------------}
 {					   16 BIT COLOUR GRAPHICS ROUTINES						}
@@ -1410,7 +1807,7 @@ static void DiagLine16 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 	Fc.G = dc->TxtColor.rgbGreen >> 2;
 	Fc.B = dc->TxtColor.rgbBlue >> 3;								// Colour for line
 	uint_fast32_t eulerMax = dx;									// Start with dx value
-	if (dy > eulerMax) dy = eulerMax;								// If dy greater change to that value
+	if (dy > eulerMax) eulerMax = dy;								// If dy greater change to that value
 	for (uint_fast32_t i = 0; i < eulerMax; i++) {					// For euler steps
 		video_wr_ptr[0] = Fc;										// Write pixel
 		tx += dx;													// Increment test x value by dx
@@ -1421,7 +1818,7 @@ static void DiagLine16 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir*dc->pitch);						// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * (int_fast32_t)dc->pitch);			// Move pointer up/down 1 line
 		}
 	}
 	dc->curPos.x += (dx * xdir);									// Set current x2 position
@@ -1499,6 +1896,42 @@ static void PutImage16 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, HBITMAP I
 	}
 }
 
+/*-[INTERNAL: FillSpan16]--------------------------------------------------}
+. 16 Bit colour version of the horizontal span fill from (x1,y) up to, but
+. not including, (x2,y) in the given colour. As an internal function the span
+. is assumed to be clipped and the dc valid.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void FillSpan16 (INTDC* dc, uint_fast32_t x1, uint_fast32_t x2, uint_fast32_t y, RGBA col) {
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (y * dc->pitch * 2) + (x1 * 2));
+	RGB565 Fc;
+	Fc.R = col.rgbRed >> 3;
+	Fc.G = col.rgbGreen >> 2;
+	Fc.B = col.rgbBlue >> 3;										// Colour for span
+	for (uint_fast32_t x = 0; x < (x2 - x1); x++) {					// For each x between x1 and x2
+		video_wr_ptr[x] = Fc;										// Write the colour
+	}
+}
+
+/*-[INTERNAL: BlendPixel16]-------------------------------------------------}
+. 16 Bit colour version of the blended pixel write. The colour is mixed with
+. the existing screen pixel by alpha (0 = screen .. 255 = colour).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void BlendPixel16 (INTDC* dc, uint_fast32_t x, uint_fast32_t y, RGBA col, uint_fast8_t alpha) {
+	RGB565* __attribute__((aligned(2))) video_wr_ptr = (RGB565*)(uintptr_t)(dc->fb + (y * dc->pitch * 2) + (x * 2));
+	RGB565 Bc = video_wr_ptr[0];									// Fetch screen pixel
+	uint_fast32_t inv = 256 - alpha;
+	uint_fast32_t a = alpha + 1;
+	uint_fast32_t r = ((col.rgbRed * a) + ((Bc.R << 3) * inv)) >> 8;
+	uint_fast32_t g = ((col.rgbGreen * a) + ((Bc.G << 2) * inv)) >> 8;
+	uint_fast32_t b = ((col.rgbBlue * a) + ((Bc.B << 3) * inv)) >> 8;
+	Bc.R = r >> 3;
+	Bc.G = g >> 2;
+	Bc.B = b >> 3;
+	video_wr_ptr[0] = Bc;											// Write blended pixel
+}
+
 /*--------------------------------------------------------------------------}
 {					   24 BIT COLOUR GRAPHICS ROUTINES						}
 {--------------------------------------------------------------------------*/
@@ -1572,7 +2005,7 @@ static void DiagLine24 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 	uint_fast32_t tx = 0;
 	uint_fast32_t ty = 0;
 	uint_fast32_t eulerMax = dx;									// Start with dx value
-	if (dy > eulerMax) dy = eulerMax;								// If dy greater change to that value
+	if (dy > eulerMax) eulerMax = dy;								// If dy greater change to that value
 	for (uint_fast32_t i = 0; i < eulerMax; i++) {					// For euler steps
 		video_wr_ptr[0] = dc->TxtColor.rgb;							// Write pixel
 		tx += dx;													// Increment test x value by dx
@@ -1583,7 +2016,7 @@ static void DiagLine24 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir*dc->pitch);						// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * (int_fast32_t)dc->pitch);			// Move pointer up/down 1 line
 		}
 	}
 	dc->curPos.x += (dx * xdir);									// Set current x2 position
@@ -1650,6 +2083,35 @@ static void PutImage24 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, HBITMAP I
 	}
 }
 
+/*-[INTERNAL: FillSpan24]--------------------------------------------------}
+. 24 Bit colour version of the horizontal span fill from (x1,y) up to, but
+. not including, (x2,y) in the given colour. As an internal function the span
+. is assumed to be clipped and the dc valid.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void FillSpan24 (INTDC* dc, uint_fast32_t x1, uint_fast32_t x2, uint_fast32_t y, RGBA col) {
+	RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptr = (RGBTRIPLE*)(uintptr_t)(dc->fb + (y * dc->pitch * 3) + (x1 * 3));
+	for (uint_fast32_t x = 0; x < (x2 - x1); x++) {					// For each x between x1 and x2
+		video_wr_ptr[x] = col.rgb;									// Write the colour
+	}
+}
+
+/*-[INTERNAL: BlendPixel24]-------------------------------------------------}
+. 24 Bit colour version of the blended pixel write. The colour is mixed with
+. the existing screen pixel by alpha (0 = screen .. 255 = colour).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void BlendPixel24 (INTDC* dc, uint_fast32_t x, uint_fast32_t y, RGBA col, uint_fast8_t alpha) {
+	RGBTRIPLE* __attribute__((aligned(1))) video_wr_ptr = (RGBTRIPLE*)(uintptr_t)(dc->fb + (y * dc->pitch * 3) + (x * 3));
+	RGBTRIPLE Bc = video_wr_ptr[0];									// Fetch screen pixel
+	uint_fast32_t inv = 256 - alpha;
+	uint_fast32_t a = alpha + 1;
+	Bc.rgbRed = ((col.rgbRed * a) + (Bc.rgbRed * inv)) >> 8;
+	Bc.rgbGreen = ((col.rgbGreen * a) + (Bc.rgbGreen * inv)) >> 8;
+	Bc.rgbBlue = ((col.rgbBlue * a) + (Bc.rgbBlue * inv)) >> 8;
+	video_wr_ptr[0] = Bc;											// Write blended pixel
+}
+
 /*--------------------------------------------------------------------------}
 {					   32 BIT COLOUR GRAPHICS ROUTINES						}
 {--------------------------------------------------------------------------*/
@@ -1660,7 +2122,7 @@ static void PutImage24 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, HBITMAP I
 . 10Aug17 LdB
 .--------------------------------------------------------------------------*/
 static COLORREF SetPixel32 (INTDC* dc, uint_fast32_t x, uint_fast32_t y, COLORREF crColor) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y * dc->pitch * 4) + (y * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y * dc->pitch * 4));
 	video_wr_ptr[x] = crColor.rgba;									// Write the current brush colour
 	return (crColor);												// Return the color
 }
@@ -1672,7 +2134,7 @@ static COLORREF SetPixel32 (INTDC* dc, uint_fast32_t x, uint_fast32_t y, COLORRE
 . 10Aug17 LdB
 .--------------------------------------------------------------------------*/
 static void ClearArea32 (INTDC* dc, uint_fast32_t x1, uint_fast32_t y1, uint_fast32_t x2, uint_fast32_t y2) {
-	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y1 * dc->pitch * 4) + (y1 * 4));
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y1 * dc->pitch * 4) + (x1 * 4));
 	for (uint_fast32_t y = 0; y < (y2 - y1); y++) {					// For each y line
 		for (uint_fast32_t x = 0; x < (x2 - x1); x++) {				// For each x between x1 and x2
 			video_wr_ptr[x] = dc->BrushColor;						// Write the current brush colour
@@ -1723,7 +2185,7 @@ static void DiagLine32 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 	uint_fast32_t tx = 0;
 	uint_fast32_t ty = 0;
 	uint_fast32_t eulerMax = dx;									// Start with dx value
-	if (dy > eulerMax) dy = eulerMax;								// If dy greater change to that value
+	if (dy > eulerMax) eulerMax = dy;								// If dy greater change to that value
 	for (uint_fast32_t i = 0; i < eulerMax; i++) {					// For euler steps
 		video_wr_ptr[0] = dc->TxtColor;								// Write pixel
 		tx += dx;													// Increment test x value by dx
@@ -1734,7 +2196,7 @@ static void DiagLine32 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, int_fast8
 		ty += dy;													// Increment test y value by dy
 		if (ty >= eulerMax) {										// If ty >= eulerMax we step
 			ty -= eulerMax;											// Subtract eulerMax
-			video_wr_ptr += (ydir*dc->pitch);						// Move pointer up/down 1 line
+			video_wr_ptr += (ydir * (int_fast32_t)dc->pitch);			// Move pointer up/down 1 line
 		}
 	}
 	dc->curPos.x += (dx * xdir);									// Set current x2 position
@@ -1801,7 +2263,51 @@ static void PutImage32 (INTDC* dc, uint_fast32_t dx, uint_fast32_t dy, HBITMAP I
 	}
 }
 
+/*-[INTERNAL: FillSpan32]--------------------------------------------------}
+. 32 Bit colour version of the horizontal span fill from (x1,y) up to, but
+. not including, (x2,y) in the given colour. As an internal function the span
+. is assumed to be clipped and the dc valid.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void FillSpan32 (INTDC* dc, uint_fast32_t x1, uint_fast32_t x2, uint_fast32_t y, RGBA col) {
+	uint32_t* __attribute__((aligned(4))) video_wr_ptr = (uint32_t*)(uintptr_t)(dc->fb + (y * dc->pitch * 4) + (x1 * 4));
+	uint32_t Fc = col.Raw32;										// Colour for span
+	for (uint_fast32_t x = 0; x < (x2 - x1); x++) {					// For each x between x1 and x2
+		video_wr_ptr[x] = Fc;										// Write the colour
+	}
+}
 
+/*-[INTERNAL: BlendPixel32]-------------------------------------------------}
+. 32 Bit colour version of the blended pixel write. The colour is mixed with
+. the existing screen pixel by alpha (0 = screen .. 255 = colour).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void BlendPixel32 (INTDC* dc, uint_fast32_t x, uint_fast32_t y, RGBA col, uint_fast8_t alpha) {
+	RGBA* __attribute__((aligned(4))) video_wr_ptr = (RGBA*)(uintptr_t)(dc->fb + (y * dc->pitch * 4) + (x * 4));
+	RGBA Bc = video_wr_ptr[0];										// Fetch screen pixel
+	uint_fast32_t inv = 256 - alpha;
+	uint_fast32_t a = alpha + 1;
+	Bc.rgbRed = ((col.rgbRed * a) + (Bc.rgbRed * inv)) >> 8;
+	Bc.rgbGreen = ((col.rgbGreen * a) + (Bc.rgbGreen * inv)) >> 8;
+	Bc.rgbBlue = ((col.rgbBlue * a) + (Bc.rgbBlue * inv)) >> 8;
+	video_wr_ptr[0] = Bc;											// Write blended pixel
+}
+
+/*--------------------------------------------------------------------------}
+{					  CLIPPED SPAN BASED FILL ROUTINES						}
+{--------------------------------------------------------------------------*/
+
+/*-[INTERNAL: ClipSpan]-----------------------------------------------------}
+. Clips the span (x1,y) up to but not including (x2,y) to the DC bounds and
+. passes anything left to the depth specific span fill routine.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void ClipSpan (INTDC* dc, int_fast32_t x1, int_fast32_t x2, int_fast32_t y, RGBA col) {
+	if ((y < 0) || (y >= (int_fast32_t)dc->ht)) return;				// Span line is off screen
+	if (x1 < 0) x1 = 0;												// Clip left
+	if (x2 > (int_fast32_t)dc->wth) x2 = dc->wth;					// Clip right
+	if (x1 < x2) dc->FillSpan(dc, x1, x2, y, col);					// Fill anything that is left
+}
 
 BOOL Rectangle(HDC hdc,
 	int_fast32_t nLeftRect,
@@ -1811,12 +2317,222 @@ BOOL Rectangle(HDC hdc,
 {
 	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
 	if (intDC) {
-		intDC->ClearArea(intDC, nLeftRect, nTopRect, nRightRect, nBottomRect);
+		if (nLeftRect < 0) nLeftRect = 0;							// Clip to DC bounds
+		if (nTopRect < 0) nTopRect = 0;
+		if (nRightRect > (int_fast32_t)intDC->wth) nRightRect = intDC->wth;
+		if (nBottomRect > (int_fast32_t)intDC->ht) nBottomRect = intDC->ht;
+		if ((nLeftRect < nRightRect) && (nTopRect < nBottomRect))
+			intDC->ClearArea(intDC, nLeftRect, nTopRect, nRightRect, nBottomRect);
 		return TRUE;
 	}
 	return FALSE;
 }
 
+BOOL FillRect (HDC hdc,
+	const RECT* lprc)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if ((intDC) && (lprc)) {
+		int_fast32_t top = (lprc->top < 0) ? 0 : lprc->top;			// Clip top to DC
+		int_fast32_t bottom = (lprc->bottom > (int_fast32_t)intDC->ht) ? (int_fast32_t)intDC->ht : lprc->bottom;
+		for (int_fast32_t y = top; y < bottom; y++)					// For each visible line
+			ClipSpan(intDC, lprc->left, lprc->right, y, intDC->BrushColor);
+		return TRUE;
+	}
+	return FALSE;
+}
+
+BOOL Polyline (HDC hdc,
+	const POINT* apt,
+	int_fast32_t cpt)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if ((intDC) && (apt) && (cpt >= 2)) {
+		POINT oldPos = intDC->curPos;								// Polyline does not change position
+		for (int_fast32_t i = 1; i < cpt; i++)						// For each segment
+			ClippedLine(intDC, apt[i-1].x, apt[i-1].y, apt[i].x, apt[i].y);
+		intDC->curPos = oldPos;										// Restore current position
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*-[INTERNAL: POLYEDGE]-----------------------------------------------------}
+. Edge table entry for the scanline polygon filler. Edges cover scanlines
+. ymin up to but not including ymax, x is sampled at the pixel centre line.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+#define MAX_POLYGON_EDGES 256										// Maximum edges Polygon will fill
+typedef struct {
+	int_fast32_t ymin;												// First scanline edge covers
+	int_fast32_t ymax;												// Scanline after last edge covers
+	int32_t x;														// 16.16 fixed point x on current scanline
+	int32_t dxdy;													// 16.16 fixed point x step per scanline
+} POLYEDGE;
+
+BOOL Polygon (HDC hdc,
+	const POINT* apt,
+	int_fast32_t cpt)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if ((intDC) && (apt) && (cpt >= 2) && (cpt <= MAX_POLYGON_EDGES)) {
+		POLYEDGE edges[MAX_POLYGON_EDGES];
+		POLYEDGE* active[MAX_POLYGON_EDGES];
+		int_fast32_t edgeCount = 0;
+		int_fast32_t ymin = INT32_MAX;
+		int_fast32_t ymax = INT32_MIN;
+
+		/* Build the edge table skipping horizontal edges */
+		for (int_fast32_t i = 0; i < cpt; i++) {
+			const POINT* p0 = &apt[i];
+			const POINT* p1 = &apt[(i + 1 == cpt) ? 0 : i + 1];
+			if (p0->y == p1->y) continue;							// Horizontal edges add nothing
+			if (p0->y > p1->y) {									// Edges always run top to bottom
+				const POINT* t = p0; p0 = p1; p1 = t;
+			}
+			POLYEDGE e;
+			e.ymin = p0->y;
+			e.ymax = p1->y;
+			e.dxdy = (int32_t)(((int64_t)(p1->x - p0->x) * 65536) / (p1->y - p0->y));
+			e.x = (int32_t)(p0->x * 65536) + (e.dxdy >> 1);		// Sample at centre of first scanline
+			if (e.ymin < 0) {										// Clip edge to top of DC
+				e.x += e.dxdy * (0 - e.ymin);
+				e.ymin = 0;
+			}
+			if (e.ymax > (int_fast32_t)intDC->ht) e.ymax = intDC->ht;// Clip edge to bottom of DC
+			if (e.ymin >= e.ymax) continue;							// Edge is not visible
+			if (e.ymin < ymin) ymin = e.ymin;
+			if (e.ymax > ymax) ymax = e.ymax;
+			int_fast32_t j = edgeCount;								// Insertion sort edge table on ymin
+			while ((j > 0) && (edges[j-1].ymin > e.ymin)) {
+				edges[j] = edges[j-1];
+				j--;
+			}
+			edges[j] = e;
+			edgeCount++;
+		}
+
+		/* Scan convert emitting horizontal spans */
+		int_fast32_t nextEdge = 0;
+		int_fast32_t activeCount = 0;
+		for (int_fast32_t y = ymin; y < ymax; y++) {
+			while ((nextEdge < edgeCount) && (edges[nextEdge].ymin == y))
+				active[activeCount++] = &edges[nextEdge++];			// Edges starting on this line go active
+			int_fast32_t k = 0;
+			for (int_fast32_t i = 0; i < activeCount; i++)			// Drop edges that have finished
+				if (active[i]->ymax > y) active[k++] = active[i];
+			activeCount = k;
+			for (int_fast32_t i = 1; i < activeCount; i++) {		// Insertion sort active edges on x
+				POLYEDGE* t = active[i];
+				int_fast32_t j = i;
+				while ((j > 0) && (active[j-1]->x > t->x)) {
+					active[j] = active[j-1];
+					j--;
+				}
+				active[j] = t;
+			}
+			for (int_fast32_t i = 0; i + 1 < activeCount; i += 2) {	// Fill between edge pairs (even-odd)
+				int_fast32_t x1 = (active[i]->x + 0x7FFF) >> 16;	// First pixel centre inside
+				int_fast32_t x2 = (active[i+1]->x + 0x7FFF) >> 16;	// First pixel centre outside
+				ClipSpan(intDC, x1, x2, y, intDC->BrushColor);
+			}
+			for (int_fast32_t i = 0; i < activeCount; i++)			// Step edges to next scanline
+				active[i]->x += active[i]->dxdy;
+		}
+
+		/* Outline with the pen */
+		POINT oldPos = intDC->curPos;								// Polygon does not change position
+		for (int_fast32_t i = 0; i < cpt; i++) {
+			const POINT* p1 = &apt[(i + 1 == cpt) ? 0 : i + 1];
+			ClippedLine(intDC, apt[i].x, apt[i].y, p1->x, p1->y);
+		}
+		intDC->curPos = oldPos;										// Restore current position
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*-[INTERNAL: EllipseRow]---------------------------------------------------}
+. Returns the inclusive x extent of the ellipse on the given row. The centre
+. and radii are in 16.16 fixed point and the ellipse equation is evaluated at
+. the pixel centres using an integer square root.
+. RETURN: True if the row has pixels inside the ellipse, false otherwise
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool EllipseRow (int_fast32_t y, int64_t cx, int64_t cy, int64_t rx, int64_t ry, int_fast32_t* xl, int_fast32_t* xr) {
+	int64_t dy = ((int64_t)y * 65536) - cy;
+	if ((dy >= ry) || (-dy >= ry)) return false;					// Row outside ellipse
+	uint64_t t = (uint64_t)((ry * ry) - (dy * dy));					// ry^2 - dy^2 in 32.32
+	uint64_t root = 0, bit = (uint64_t)1 << 62;
+	while (bit > t) bit >>= 2;
+	while (bit) {													// Integer square root gives 16.16 result
+		if (t >= root + bit) {
+			t -= root + bit;
+			root = (root >> 1) + bit;
+		} else root >>= 1;
+		bit >>= 2;
+	}
+	int64_t hw = (rx * (int64_t)root) / ry;							// Half width in 16.16
+	*xl = (int_fast32_t)((cx - hw + 0xFFFF) >> 16);					// ceil(cx - hw)
+	*xr = (int_fast32_t)((cx + hw) >> 16);							// floor(cx + hw)
+	return (*xl <= *xr);
+}
+
+BOOL Ellipse (HDC hdc,
+	int_fast32_t nLeftRect,
+	int_fast32_t nTopRect,
+	int_fast32_t nRightRect,
+	int_fast32_t nBottomRect)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if ((intDC) && (nLeftRect < nRightRect) && (nTopRect < nBottomRect)) {
+		int64_t cx = ((int64_t)(nLeftRect + nRightRect - 1) << 15);	// Centre x in 16.16
+		int64_t cy = ((int64_t)(nTopRect + nBottomRect - 1) << 15);	// Centre y in 16.16
+		int64_t rx = ((int64_t)(nRightRect - nLeftRect) << 15);		// Radius x in 16.16
+		int64_t ry = ((int64_t)(nBottomRect - nTopRect) << 15);		// Radius y in 16.16
+		int_fast32_t top = (nTopRect < 0) ? 0 : nTopRect;			// Clip rows to DC
+		int_fast32_t bottom = (nBottomRect > (int_fast32_t)intDC->ht) ? (int_fast32_t)intDC->ht : nBottomRect;
+		int_fast32_t pl = 0, pr = 0, cl = 0, cr = 0, nl = 0, nr = 0;
+		bool prev = EllipseRow(top - 1, cx, cy, rx, ry, &pl, &pr);
+		bool cur = EllipseRow(top, cx, cy, rx, ry, &cl, &cr);
+		for (int_fast32_t y = top; y < bottom; y++) {
+			bool next = EllipseRow(y + 1, cx, cy, rx, ry, &nl, &nr);
+			if (cur) {
+				/* Interior pixels are inside both neighbour rows and not the row ends */
+				int_fast32_t il = cl + 1, ir = cr - 1;
+				if (!prev || !next) ir = il - 1;					// Top or bottom row is all outline
+				else {
+					if (pl > il) il = pl;
+					if (nl > il) il = nl;
+					if (pr < ir) ir = pr;
+					if (nr < ir) ir = nr;
+				}
+				if (il <= ir) {
+					ClipSpan(intDC, cl, il, y, intDC->TxtColor);	// Left outline
+					ClipSpan(intDC, il, ir + 1, y, intDC->BrushColor);// Interior fill
+					ClipSpan(intDC, ir + 1, cr + 1, y, intDC->TxtColor);// Right outline
+				} else ClipSpan(intDC, cl, cr + 1, y, intDC->TxtColor);// Row is all outline
+			}
+			prev = cur; pl = cl; pr = cr;							// Roll rows down
+			cur = next; cl = nl; cr = nr;
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
+
+BOOL SetLineAntiAlias (HDC hdc,
+	BOOL enable)
+{
+	INTDC* intDC = (INTDC*)hdc;										// Typecast hdc to internal DC
+	if (intDC) {
+		BOOL retValue = (intDC->AntiAlias) ? TRUE : FALSE;			// We will return current setting
+		intDC->AntiAlias = (enable != FALSE);						// Set new setting
+		return retValue;
+	}
+	return FALSE;
+}
+
 
 COLORREF SetPixel (HDC hdc, uint_fast32_t x, uint_fast32_t y, COLORREF crColor)
 {
@@ -1871,6 +2587,8 @@ bool PiConsole_Init (int Width, int Height, int Depth, int(*printhandler) (const
 		console.WriteChar = WriteChar32;							// Set console function ptr to 32bit colour version of write character
 		console.TransparentWriteChar = TransparentWriteChar32;		// Set console function ptr to 32bit colour version of transparent write character
 		console.PutImage = PutImage32;								// Set console function ptr to 32bit colour version of put bitmap image
+		console.FillSpan = FillSpan32;								// Set console function ptr to 32bit colour version of span fill
+		console.BlendPixel = BlendPixel32;							// Set console function ptr to 32bit colour version of blended pixel
 		console.pitch /= 4;											// 4 bytes per write
 		break;
 	case 24:														/* 24 bit colour screen mode */
@@ -1882,6 +2600,8 @@ bool PiConsole_Init (int Width, int Height, int Depth, int(*printhandler) (const
 		console.WriteChar = WriteChar24;							// Set console function ptr to 24bit colour version of write character
 		console.TransparentWriteChar = TransparentWriteChar24;		// Set console function ptr to 24bit colour version of transparent write character
 		console.PutImage = PutImage24;								// Set console function ptr to 24bit colour version of put bitmap image
+		console.FillSpan = FillSpan24;								// Set console function ptr to 24bit colour version of span fill
+		console.BlendPixel = BlendPixel24;							// Set console function ptr to 24bit colour version of blended pixel
 		console.pitch /= 3;											// 3 bytes per write
 		break;
 	case 16:														/* 16 bit colour screen mode */
@@ -1893,6 +2613,8 @@ bool PiConsole_Init (int Width, int Height, int Depth, int(*printhandler) (const
 		console.WriteChar = WriteChar16;							// Set console function ptr to 16bit colour version of write character
 		console.TransparentWriteChar = TransparentWriteChar16;		// Set console function ptr to 16bit colour version of transparent write character
 		console.PutImage = PutImage16;								// Set console function ptr to 16bit colour version of put bitmap image
+		console.FillSpan = FillSpan16;								// Set console function ptr to 16bit colour version of span fill
+		console.BlendPixel = BlendPixel16;							// Set console function ptr to 16bit colour version of blended pixel
 		console.pitch /= 2;											// 2 bytes per write
 		break;
 	}
@@ -1933,7 +2655,8 @@ void GotoXY(uint32_t x, uint32_t y)
 /* Increase program data space. As malloc and related functions depend on this,
 it is useful to have a working implementation. The following suffices for a
 standalone system; it exploits the symbol _end automatically defined by the
-GNU linker. */
+GNU linker. The host build uses the C library heap so it is left out. */
+#if SMARTSTART_HOST == 0
 #include <sys/types.h>
 caddr_t __attribute__((weak)) _sbrk (int incr)
 {
@@ -1949,4 +2672,4 @@ caddr_t __attribute__((weak)) _sbrk (int incr)
 
 	return (caddr_t)prev_heap_end;
 }
-
+#endif
@@ -652,6 +652,36 @@ typedef struct
 	int_fast32_t y;									// y co-ordinate
 } POINT, *LPPOINT;									// Typedef define POINT and LPPOINT
 
+typedef struct
+{
+	int_fast32_t left;								// Left x co-ordinate
+	int_fast32_t top;								// Top y co-ordinate
+	int_fast32_t right;								// Right x co-ordinate (not drawn)
+	int_fast32_t bottom;							// Bottom y co-ordinate (not drawn)
+} RECT, *LPRECT;									// Typedef define RECT and LPRECT
+
+
+/*--------------------------------------------------------------------------}
+{	   PIXEL FORMATS THE IMAGE CONVERSION PIPELINE ACCEPTS AS A SOURCE		}
+{	 Values match the bit depth so a biBitCount can be used directly, the	}
+{	 bytes a pixel takes is (value + 7) / 8 so RGB555 is 2 bytes too		}
+{--------------------------------------------------------------------------*/
+typedef enum {
+	PIXFMT_PAL8 = 8,												// 8 bit index into an RGBA palette
+	PIXFMT_RGB555 = 15,												// 16 bit X1R5G5B5 (BMP 16 bit BI_RGB)
+	PIXFMT_RGB565 = 16,												// 16 bit RGB565
+	PIXFMT_RGB888 = 24,												// 24 bit RGBTRIPLE (blue byte first as per BMP)
+	PIXFMT_BGRA8888 = 32,											// 32 bit RGBA (blue byte first as per BMP)
+} PIXEL_FORMAT;
+
+/*--------------------------------------------------------------------------}
+{	   IMAGE READ HANDLER ... MATCHES THE SDCARD sdReadFile PROTOTYPE		}
+{--------------------------------------------------------------------------*/
+typedef bool (*IMGREADFUNC) (HANDLE hFile,							// Handle to read from
+							 void* lpBuffer,						// Buffer to place read data
+							 uint32_t nNumberOfBytesToRead,			// Number of bytes requested
+							 uint32_t* lpNumberOfBytesRead,			// Number of bytes actually read
+							 void* lpOverlapped);					// Unused (passed as 0)
 
 /*--------------------------------------------------------------------------}
 {                        BITMAP FILE HEADER DEFINITION                      }
@@ -730,6 +760,55 @@ BOOL Rectangle(HDC hdc,
 	int_fast32_t nRightRect,
 	int_fast32_t nBottomRect);
 
+/*-[FillRect]--------------------------------------------------------------}
+. Fills the rectangle with the current brush colour, the right and bottom 
+. edges are not drawn. The rectangle is clipped to the DC bounds.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL FillRect (HDC hdc,
+	const RECT* lprc);
+
+/*-[Polyline]---------------------------------------------------------------}
+. Draws a series of connected line segments through the given points in the
+. current pen colour. The current position is neither used nor updated and
+. each segment is clipped to the DC bounds.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL Polyline (HDC hdc,
+	const POINT* apt,
+	int_fast32_t cpt);
+
+/*-[Polygon]----------------------------------------------------------------}
+. The polygon is filled with the current brush colour using the alternate
+. (even-odd) fill rule and then outlined with the current pen colour. The
+. polygon is closed automatically and is clipped to the DC bounds.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL Polygon (HDC hdc,
+	const POINT* apt,
+	int_fast32_t cpt);
+
+/*-[Ellipse]----------------------------------------------------------------}
+. The ellipse bounded by the rectangle is filled with the current brush and
+. outlined with the current pen colour. The right and bottom co-ordinates are
+. not included in the drawing and the ellipse is clipped to the DC bounds.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL Ellipse (HDC hdc,
+	int_fast32_t nLeftRect,
+	int_fast32_t nTopRect,
+	int_fast32_t nRightRect,
+	int_fast32_t nBottomRect);
+
+/*-[SetLineAntiAlias]-------------------------------------------------------}
+. Turns anti-aliasing on/off for LineTo, Polyline and the Polygon outline.
+. Anti-aliased lines blend the pen colour with what is on the screen.
+. RETURN: The previous anti-alias setting of the DC
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL SetLineAntiAlias (HDC hdc,
+	BOOL enable);
+
 BOOL BmpOut(HDC hdc,
 	uint32_t nXStart,
 	uint32_t nYStart,
@@ -744,6 +823,45 @@ BOOL CvtBmpLine(HDC hdc,
 	uint32_t imgDepth,
 	uint8_t* imgSrc);
 
+/*-[ImageLineOut]-----------------------------------------------------------}
+. Converts one row of cX pixels in the given source format directly into the
+. DC at (nXStart, nYStart) whatever the DC colour depth. PIXFMT_PAL8 sources
+. require a 256 entry palette, it is ignored for other formats. The row is
+. clipped to the DC bounds.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL ImageLineOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	uint32_t cX,
+	PIXEL_FORMAT srcFormat,
+	const uint8_t* imgSrc,
+	const RGBA* palette);
+
+/*-[BmpFileOut]-------------------------------------------------------------}
+. Draws a complete .BMP file image held in memory at (nXStart, nYStart). It
+. handles 8, 16, 24 and 32 bit uncompressed bitmaps top down or bottom up.
+. 16 bit BI_RGB is X1R5G5B5 as per the BMP spec, BI_BITFIELDS must have the
+. 555 or 565 masks at 16 bit and the standard RGB masks at 32 bit.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL BmpFileOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	const uint8_t* bmpFile);
+
+/*-[BmpStreamOut]-----------------------------------------------------------}
+. Streams a .BMP file from the handle drawing each row as it is read so no
+. full size copy of the image is ever needed. The read handler prototype is
+. that of sdReadFile so an SD card file handle can be passed straight in.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL BmpStreamOut (HDC hdc,
+	int_fast32_t nXStart,
+	int_fast32_t nYStart,
+	HANDLE hFile,
+	IMGREADFUNC readHandler);
+
 typedef char* caddr_t;
 caddr_t __attribute__((weak)) _sbrk(int incr);
 
@@ -2,12 +2,14 @@
 @echo off
 set "bindir=g:\pi\gcc_pi_6_3\bin\"
 set "cpuflags=-Wall -O3 -mfpu=neon -mfloat-abi=hard -march=armv7-a -mtune=cortex-a7"
+@REM Ray maths SCALAR_TYPE 0 = float, 1 = double, 2 = Q16.16 fixed point
+set "numflags=-DSCALAR_TYPE=0"
 set "asmflags=-nostdlib -nostartfiles -ffreestanding -fno-asynchronous-unwind-tables -fomit-frame-pointer -Wa,-a>list.txt"
 set "linkerflags=-Wl,-gc-sections -Wl,--build-id=none -Wl,-Bdynamic -Wl,-Map,kernel.map"
 set "outflags=-o kernel.elf"
 set "libflags=-lc -lm -lg -lgcc"
 @echo on
-%bindir%arm-none-eabi-gcc %cpuflags% %asmflags% %linkerflags% -Wl,-T,rpi32.ld main.c SmartStart32.S rpi-BasicHardware.c %outflags% %libflags%
+%bindir%arm-none-eabi-gcc %cpuflags% %numflags% %asmflags% %linkerflags% -Wl,-T,rpi32.ld main.c SmartStart32.S rpi-BasicHardware.c mmu.c rpi-RayCast.c rpi-PolyMap.c rpi-Scalar.c rpi-Input.c rpi-GameLoop.c %outflags% %libflags%
 @echo off
 if %errorlevel% EQU 1 (goto build_fail)
 
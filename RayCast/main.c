@@ -5,11 +5,26 @@
 #include <math.h>
 #include "rpi-smartstart.h"		
 #include "rpi-BasicHardware.h"
+#include "rpi-RayCast.h"
+#include "rpi-PolyMap.h"
+#include "rpi-Scalar.h"
+#include "rpi-Input.h"
+#include "rpi-GameLoop.h"
+
+#define STEP_HZ		60							// Simulation steps a second, the timer irq rate
+#define MOVE_SPEED	3.0f						// Map squares a second walking
+#define TURN_SPEED	2.5f						// Radians a second turning
+#define RUN_SPEED	2.0f						// Times faster running
+#define DEMO_TURN	0.6f						// Radians a second turning before any key
+#define WALL_GAP	0.25f						// Closest the camera comes to a wall
 
 static bool lit = false;
+static bool uartOn = false;
+static volatile bool ledFlip = false;								// Set by the irq, the main loop drives the LED
 void c_irq_handler (void) {
-	if (lit) lit = false; else lit = true;							// Flip lit flag
-	set_Activity_LED(lit);											// Turn LED on/off as per new flag
+	uint32_t step = GameLoop_TimerIrq();							// Count a simulation step
+	if (uartOn) Input_PollUart(step);								// Take any keys from the terminal
+	if ((step % (STEP_HZ / 2)) == 0) ledFlip = true;				// LED is a mailbox call so not done in the irq
 }
 
 void c_irq_identify_and_clear_source (void) {
@@ -87,126 +102,52 @@ int worldMap[mapWidth][mapHeight]=
 };
 
 
-/* We may wish to change between float type  this makes it easy */
-#define CFLOAT double				// We may choose float, double, long double etc
-#define CFLOAT_ZERO ((CFLOAT)0.0)
-#define CFLOAT_ONE ((CFLOAT)1.0)
-
-/*-LineIntersect2D----------------------------------------------------------}
-{																			}
-{ REF: http://paulbourke.net/geometry/pointlineplane/						}
-{																			}
-{ Given two line segments (x1,y1)-(x2,y2) &  (x3,y3)-(x4,y4) we calculate   }
-{ the intersection point of the two lines. If line segment only flag set    }
-{ the intersection must be within the line segments, otherwise interesction }
-{ assumes each line is extended to infinite length and returns intersection }
-{																			}
-{ The pointers to results intersect Ipx, Ipy, can be NULL if that result    }
-{ is not required.															}
-{																			}
-{ RETURN FALSE:																}
-{	If the two lines are parallel.											}
-{	If the two lines are coincident (one and the same line).				}
-{	Line segment flag set and intersection point is outside the segments	}
-{																			}
-{ RETURN TRUE:																}
-{	Ipx, Ipy will be the intersection point returned						}
-{																			}
-{ 8aug2017 LdB																}
----------------------------------------------------------------------------*/
-bool LineIntersect2D (_In_ int32_t x1, _In_ int32_t y1,				// First line segement first coord
-					  _In_ int32_t x2, _In_ int32_t y2,				// First line segement second coord
-					  _In_ int32_t x3, _In_	int32_t y3,				// Second line segment first coord
-					  _In_ int32_t x4, _In_ int32_t y4, 			// Second line segment second cord
-					  _Out_ int32_t* Ipx, _Out_ int32_t* Ipy,		// Interection point return
-					  bool LineSegmentOnly) 						// Line segment intersect only flag
-{
-	int_fast32_t UaNum, Denom, Xa, Xb, Xc, Ya, Yb, Yc;
-	CFLOAT Ua;
-
-	Xa = x4 - x3;													// Line 2 dx
-	Xc = x2 - x1;													// Line 1 dx
-	Yb = y4 - y3;													// Line 2 dy
-	Yc = y2 - y1;													// Line 2 dy
-	Denom = (Yb*Xc) - (Xa*Yc);										// Denominator of two equations
-	if (Denom == 0) return (false);									// The two lines are parallel and/or coincident
-	Xb = x1 - x3;													// Dx between first x coord of each line
-	Ya = y1 - y3;													// Dy between first y corrd of each line
-	UaNum = (Xa*Ya) - (Yb*Xb);										// Ua numerator
-	Ua = (CFLOAT)UaNum / (CFLOAT)Denom;								// Calculate Ua
-	if (LineSegmentOnly) {											// Want intersect point of line segments
-		int_fast32_t  UbNum;
-		CFLOAT Ub;
-		if (Ua < CFLOAT_ZERO || Ua > CFLOAT_ONE) return (false);	// Line intersection outside line segement 1
-		UbNum = (Xc*Ya) - (Yc*Xb);									// Ub numerator 
-		Ub = (CFLOAT)UbNum / (CFLOAT)Denom;							// Calculate Ub
-		if (Ub < CFLOAT_ZERO || Ub > CFLOAT_ONE) return (false);	// Line intersection outside line segement 2
-	}
-	if (Ipx) (*Ipx) = x1 + (int_fast32_t)(Ua*Xc);					// Calculate and return intersect x point		
-	if (Ipy) (*Ipy) = y1 + (int_fast32_t)(Ua*Yc);					// Calculate and return intersect y point
-	return (true);													// return true for success
-}
-
-/*-VERTEX_TYPE--------------------------------------------------------------}
-{  Units your vertex points are in typically int32_t, uint64_t or doubles.  }
-{--------------------------------------------------------------------------*/
-typedef int_fast32_t VERTEX_TYPE;									// For our example we are 32 bit ints
-
-/*-VERTEX FLAGS-------------------------------------------------------------}
-{ These are flags for our vertex points above so our shape is made of lines }
-{ and bezier linked up (IE exactly what Win32 GetGlyphOutline returns).		}
-{--------------------------------------------------------------------------*/
-#define VF_NORMAL 			0x00
-
-#define VF_DIRECTIONS		0x07									// Lower 3 bits = direction flags (0-7)
-#define VF_LIFTCLOSE 		0x08									// Open contour .. close vertexes in air
-
-#define VF_BEZONGRID 		0x10									// Bezier on grid point
-#define VF_QUADBEZOFFGRID 	0x20									// Quad bezier off grid point
-#define VF_CUBICBEZOFFGRID 	0x40									// Cubic bezier off grid point
-
-#define VF_BEZOFFGRID 		0x60									// Any bezier off grid point
-#define VF_BEZIER 			0x70									// Any bezier on or off grid point
-
-#define VF_JOINEDCONTOUR 	0x80									// Contour joins to next
-
-/*-CONTOUR DIRECTION--------------------------------------------------------}
-{                        Contour direction enumeration						}
-{--------------------------------------------------------------------------*/
-enum CONTOUR_DIR {
-	CW_DIR = 0,														// Clockwise contour direction
-	CCW_DIR = 1,													// Counter clockwise contour direction
-	UNKNOWN_DIR = 2													// Unknown contour direction
+/* An octagonal pillar and a wedge, walls no grid map could have */
+VERTEX2D Octagon[8] = {
+	{ .x = 16, .y = 7, .next = &Octagon[1], .prev = &Octagon[7] },
+	{ .x = 18, .y = 7, .next = &Octagon[2], .prev = &Octagon[0] },
+	{ .x = 19, .y = 8, .next = &Octagon[3], .prev = &Octagon[1] },
+	{ .x = 19, .y = 10, .next = &Octagon[4], .prev = &Octagon[2] },
+	{ .x = 18, .y = 11, .next = &Octagon[5], .prev = &Octagon[3] },
+	{ .x = 16, .y = 11, .next = &Octagon[6], .prev = &Octagon[4] },
+	{ .x = 15, .y = 10, .next = &Octagon[7], .prev = &Octagon[5] },
+	{ .x = 15, .y = 8, .next = &Octagon[0], .prev = &Octagon[6] }
 };
 
-/*---------------------------------------------------------------------------}
-{                        VERTEX2D RECORD DEFINITION                          }
-{---------------------------------------------------------------------------*/
-typedef struct Vertex2D {
-	uint_fast32_t v_flags;											// Vertex flags
-	VERTEX_TYPE x;													// Vertex x co-ord
-	VERTEX_TYPE y;													// Vertex y co-ord
-	struct Vertex2D* next;											// Next vertex
-	struct Vertex2D* prev;											// Prev vertex
-} VERTEX2D, *PVERTEX2D;
+VERTEX2D Wedge1[3] = {
+	{ .x = 3, .y = 16, .next = &Wedge1[1], .prev = &Wedge1[2] },
+	{ .x = 8, .y = 18, .next = &Wedge1[2], .prev = &Wedge1[0] },
+	{ .x = 3, .y = 20, .next = &Wedge1[0], .prev = &Wedge1[1] }
+};
 
+extern CONTOUR2D InnerBox;
+extern CONTOUR2D Pillar;
 
-/*--------------------------------------------------------------------------}
-{                       CONTOUR2D RECORD DEFINITION							}
-{--------------------------------------------------------------------------*/
-typedef struct Contour2D {
-	enum CONTOUR_DIR dir;											// Direction of contour
-	uint32_t index;													// Label index of contour 
-	VERTEX_TYPE xmin;												// Contour min x value
-	VERTEX_TYPE ymin;												// Contour min y value
-	VERTEX_TYPE xmax;												// Contour max x value
-	VERTEX_TYPE ymax;												// Contour max y value
-	PVERTEX2D firstvertex;											// First vertex on this contour
-	struct Contour2D* inside_contours;								// Inside paired contours
-	struct Contour2D* nextpeer;										// Next peer contour
-	struct Contour2D* prevpeer;										// Prev peer contour
-} CONTOUR2D, *PCONTOUR2D;
+CONTOUR2D Wedge = {
+	.dir = CW_DIR,
+	.index = 5,
+	.xmin = 3,
+	.ymin = 16,
+	.xmax = 8,
+	.ymax = 20,
+	.firstvertex = &Wedge1[0],
+	.inside_contours = 0,
+	.nextpeer = 0,
+	.prevpeer = &Pillar,
+};
 
+CONTOUR2D Pillar = {
+	.dir = CW_DIR,
+	.index = 2,
+	.xmin = 15,
+	.ymin = 7,
+	.xmax = 19,
+	.ymax = 11,
+	.firstvertex = &Octagon[0],
+	.inside_contours = 0,
+	.nextpeer = &Wedge,
+	.prevpeer = &InnerBox,
+};
 
 VERTEX2D InBox1[4] = {
 	{ .x = 6, .y = 5, .next = &InBox1[1], .prev = &InBox1[3] },
@@ -224,7 +165,7 @@ CONTOUR2D InnerBox = {
 	.ymax = 9,
 	.firstvertex = &InBox1[1],
 	.inside_contours = 0,
-	.nextpeer = 0,
+	.nextpeer = &Pillar,
 	.prevpeer = 0,
 };
 
@@ -248,8 +189,198 @@ CONTOUR2D Level = {
 	.prevpeer = 0,
 };
 
+/*--------------------------------------------------------------------------}
+{  A large map to time the PolyMap grid against LineIntersect2D on every	}
+{  wall. Pillars, square and diamond, stand on a 4 unit pitch with some		}
+{  left out, x = 4n to 4n+1 is always clear so rays can start there.		}
+{--------------------------------------------------------------------------*/
+#define BENCH_PITCH 4												// Map units between pillars
+#define BENCH_ACROSS ((SC_MAX_MAP / BENCH_PITCH < 32) ? SC_MAX_MAP / BENCH_PITCH : 32)	// Pillar places a side, 30 for fixed point
+#define BENCH_SIZE (BENCH_PITCH * BENCH_ACROSS)						// Map units a side
+#define BENCH_RAYS 4096												// Different rays cast
+#define BENCH_PASSES 16												// Times the grid casts them
+#define BENCH_BRUTE_RAYS 256										// Of them cast the slow way
+
+static VERTEX2D BenchVertex[BENCH_ACROSS * BENCH_ACROSS * 4 + 4];
+static CONTOUR2D BenchContour[BENCH_ACROSS * BENCH_ACROSS + 1];
+static float BenchRay[BENCH_RAYS][4];								// ox, oy, dx, dy
+
+static void BenchContourAdd (CONTOUR2D* c, VERTEX2D* v, const VERTEX_TYPE* xy, uint32_t index)
+{
+	for (int i = 0; i < 4; i++) {
+		v[i].v_flags = VF_NORMAL;
+		v[i].x = xy[i * 2];
+		v[i].y = xy[i * 2 + 1];
+		v[i].next = &v[(i + 1) & 3];
+		v[i].prev = &v[(i + 3) & 3];
+	}
+	c->dir = CW_DIR;
+	c->index = index;
+	c->firstvertex = &v[0];
+	c->inside_contours = 0;
+	c->nextpeer = 0;
+	c->prevpeer = 0;
+}
+
+static void MakeBenchMap (void)
+{
+	static const VERTEX_TYPE border[8] = { 0, 0, BENCH_SIZE, 0, BENCH_SIZE, BENCH_SIZE, 0, BENCH_SIZE };
+	BenchContourAdd(&BenchContour[0], &BenchVertex[0], border, 0);
+	uint32_t n = 1;
+	CONTOUR2D* last = 0;
+	for (int i = 0; i < BENCH_ACROSS; i++) {
+		for (int j = 0; j < BENCH_ACROSS; j++) {
+			if (((i * 7 + j * 13) % 5) < 2) continue;				// Leave some places open
+			VERTEX_TYPE cx = i * BENCH_PITCH + BENCH_PITCH / 2;
+			VERTEX_TYPE cy = j * BENCH_PITCH + BENCH_PITCH / 2;
+			VERTEX_TYPE square[8] = { cx - 1, cy - 1, cx + 1, cy - 1, cx + 1, cy + 1, cx - 1, cy + 1 };
+			VERTEX_TYPE diamond[8] = { cx, cy - 1, cx + 1, cy, cx, cy + 1, cx - 1, cy };
+			BenchContourAdd(&BenchContour[n], &BenchVertex[n * 4], ((i + j) & 1) ? diamond : square, n);
+			if (last) {
+				last->nextpeer = &BenchContour[n];
+				BenchContour[n].prevpeer = last;
+			} else BenchContour[0].inside_contours = &BenchContour[n];
+			last = &BenchContour[n++];
+		}
+	}
+}
+
+static void PolyMapBenchmark (char* text)
+{
+	MakeBenchMap();
+	uint32_t walls = PolyMap_Build(&BenchContour[0], 0.0f);
+	if (walls == 0) {
+		sprintf(text, "PolyMap benchmark map failed to build");
+		return;
+	}
+	uint32_t seed = 12345;
+	for (int i = 0; i < BENCH_RAYS; i++) {
+		seed = seed * 1103515245 + 12345;
+		float a = (seed >> 8) * (6.2831853f / 16777216.0f);			// Any direction
+		seed = seed * 1103515245 + 12345;
+		BenchRay[i][0] = ((seed >> 16) % BENCH_ACROSS) * BENCH_PITCH + 0.1f + ((seed >> 8) & 0xFF) * (0.8f / 256.0f);
+		seed = seed * 1103515245 + 12345;
+		BenchRay[i][1] = ((seed >> 8) & 0xFFFF) * (BENCH_SIZE / 65536.0f);
+		BenchRay[i][2] = cosf(a);
+		BenchRay[i][3] = sinf(a);
+	}
+
+	POLYMAP_HIT hit;
+	uint64_t start = timer_getTickCount();
+	for (int p = 0; p < BENCH_PASSES; p++)
+		for (int i = 0; i < BENCH_RAYS; i++)
+			PolyMap_CastRay(BenchRay[i][0], BenchRay[i][1], BenchRay[i][2], BenchRay[i][3], &hit);
+	uint64_t gridUs = tick_difference(start, timer_getTickCount());
+
+	start = timer_getTickCount();
+	for (int i = 0; i < BENCH_BRUTE_RAYS; i++)
+		PolyMap_CastRayBrute(BenchRay[i][0], BenchRay[i][1], BenchRay[i][2], BenchRay[i][3], &hit);
+	uint64_t bruteUs = tick_difference(start, timer_getTickCount());
+
+	/* Both ways should find the same wall. LineIntersect2D works in 1/64 unit	*/
+	/* integers which can shift a glancing hit along the wall or round a ray	*/
+	/* past a corner, so a few near misses are expected						*/
+	uint32_t agree = 0;
+	for (int i = 0; i < BENCH_BRUTE_RAYS; i++) {
+		POLYMAP_HIT brute;
+		bool g = PolyMap_CastRay(BenchRay[i][0], BenchRay[i][1], BenchRay[i][2], BenchRay[i][3], &hit);
+		bool b = PolyMap_CastRayBrute(BenchRay[i][0], BenchRay[i][1], BenchRay[i][2], BenchRay[i][3], &brute);
+		if ((g == b) && (!g || (hit.segment == brute.segment) || (fabsf(hit.dist - brute.dist) < 0.05f))) agree++;
+	}
+
+	uint32_t gridRate = (uint32_t)((BENCH_PASSES * BENCH_RAYS * 1000000ull) / (gridUs ? gridUs : 1));
+	uint32_t bruteRate = (uint32_t)((BENCH_BRUTE_RAYS * 1000000ull) / (bruteUs ? bruteUs : 1));
+	sprintf(text, "PolyMap %s %u walls: grid %u rays/s, all walls %u rays/s, %u/%u same wall ",
+		SC_NAME, (unsigned int)walls, (unsigned int)gridRate, (unsigned int)bruteRate,
+		(unsigned int)agree, (unsigned int)BENCH_BRUTE_RAYS);
+}
+
+/* Barrels, pillars and lamps standing in open squares */
+static RAYCAST_SPRITE Sprites[] = {
+	{ .x = 12.5f, .y = 12.5f, .texture = RC_TEX_SPRITE + 2 },
+	{ .x = 14.5f, .y = 16.5f, .texture = RC_TEX_SPRITE },
+	{ .x = 9.5f,  .y = 20.5f, .texture = RC_TEX_SPRITE + 1 },
+	{ .x = 6.5f,  .y = 13.5f, .texture = RC_TEX_SPRITE },
+	{ .x = 20.5f, .y = 20.5f, .texture = RC_TEX_SPRITE + 1 },
+	{ .x = 2.5f,  .y = 12.5f, .texture = RC_TEX_SPRITE + 2 },
+	{ .x = 10.5f, .y = 6.5f,  .texture = RC_TEX_SPRITE + 1 },
+	{ .x = 15.5f, .y = 3.5f,  .texture = RC_TEX_SPRITE },
+};
+
+/* True if the camera can move by (mx, my) without coming within WALL_GAP of a wall */
+static bool CanMove (float x, float y, float mx, float my, bool polyMap)
+{
+	float len = sqrtf(mx * mx + my * my);
+	if (len == 0.0f) return true;
+	if (polyMap) {
+		/* Rays from the centre and both sides of a WALL_GAP wide path, so corners are seen */
+		float dx = mx / len, dy = my / len;
+		for (int i = -1; i <= 1; i++) {
+			POLYMAP_HIT hit;
+			float ox = x - dy * WALL_GAP * i, oy = y + dx * WALL_GAP * i;
+			if (PolyMap_CastRay(ox, oy, dx, dy, &hit) && hit.dist <= len + WALL_GAP)
+				return false;
+		}
+		return true;
+	}
+	float gx = x + mx + ((mx > 0.0f) ? WALL_GAP : (mx < 0.0f) ? -WALL_GAP : 0.0f);
+	float gy = y + my + ((my > 0.0f) ? WALL_GAP : (my < 0.0f) ? -WALL_GAP : 0.0f);
+	if (gx < 0.0f || gy < 0.0f || gx >= mapWidth || gy >= mapHeight) return false;
+	return (worldMap[(int)gx][(int)gy] == 0);
+}
 
-#define CFLOAT double
+/* One fixed simulation step of the camera for the keys held */
+static void UpdateCamera (RAYCAST_CAMERA* cam, uint32_t keys, bool demo, float dt, bool polyMap)
+{
+	float speed = (keys & KEY_RUN) ? RUN_SPEED : 1.0f;
+	float turn = 0.0f;
+	if (keys & KEY_TURN_LEFT) turn += TURN_SPEED * speed * dt;
+	if (keys & KEY_TURN_RIGHT) turn -= TURN_SPEED * speed * dt;
+	if (demo) turn = -DEMO_TURN * dt;
+	if (turn != 0.0f) {
+		//both camera direction and camera plane must be rotated
+		float cf = cosf(turn);
+		float sf = sinf(turn);
+		float oldDirX = cam->dirX;
+		cam->dirX = cam->dirX * cf - cam->dirY * sf;
+		cam->dirY = oldDirX * sf + cam->dirY * cf;
+		float oldPlaneX = cam->planeX;
+		cam->planeX = cam->planeX * cf - cam->planeY * sf;
+		cam->planeY = oldPlaneX * sf + cam->planeY * cf;
+	}
+
+	/* Walk along the view and strafe along the camera plane, which points right */
+	float walk = 0.0f, strafe = 0.0f;
+	if (keys & KEY_FORWARD) walk += 1.0f;
+	if (keys & KEY_BACK) walk -= 1.0f;
+	if (keys & KEY_STRAFE_RIGHT) strafe += 1.0f;
+	if (keys & KEY_STRAFE_LEFT) strafe -= 1.0f;
+	if (walk == 0.0f && strafe == 0.0f) return;
+	float dirLen = sqrtf(cam->dirX * cam->dirX + cam->dirY * cam->dirY);
+	float planeLen = sqrtf(cam->planeX * cam->planeX + cam->planeY * cam->planeY);
+	float step = MOVE_SPEED * speed * dt;
+	float mx = (cam->dirX / dirLen * walk + cam->planeX / planeLen * strafe) * step;
+	float my = (cam->dirY / dirLen * walk + cam->planeY / planeLen * strafe) * step;
+
+	/* Each axis on its own so the camera slides along a wall it runs into */
+	if (CanMove(cam->posX, cam->posY, mx, 0.0f, polyMap)) cam->posX += mx;
+	if (CanMove(cam->posX, cam->posY, 0.0f, my, polyMap)) cam->posY += my;
+}
+
+/* The camera part way from the last step to this one */
+static RAYCAST_CAMERA BlendCamera (const RAYCAST_CAMERA* a, const RAYCAST_CAMERA* b, float t)
+{
+	return (RAYCAST_CAMERA) {
+		.posX = a->posX + (b->posX - a->posX) * t,
+		.posY = a->posY + (b->posY - a->posY) * t,
+		.dirX = a->dirX + (b->dirX - a->dirX) * t,
+		.dirY = a->dirY + (b->dirY - a->dirY) * t,
+		.planeX = a->planeX + (b->planeX - a->planeX) * t,
+		.planeY = a->planeY + (b->planeY - a->planeY) * t
+	};
+}
+
+static const char HelpText[] = "w s a d q e or arrows move, shift runs, p grid/polygon map, h histogram, u histograms to uart ";
 
 int grWth = 1280;
 int grHt = 1024;
@@ -259,188 +390,101 @@ int main (void) {
 	printf("SmartStart compiled for Arm%d, AARCH%d with %u core s/w support\n",
 		RPi_CompileMode.CodeType, RPi_CompileMode.AArchMode * 32 + 32,
 		(unsigned int)RPi_CompileMode.CoresSupported);							// Write text
-	int posX = 12, posY = 16;  //x and y start position
-	CFLOAT dirX = -1, dirY = -1; //initial direction vector
-	CFLOAT planeX = 0, planeY = 0.66; //the 2d raycaster version of camera plane
-
-	//double time = 0; //time of current frame
-	//double oldTime = 0; //time of previous frame
-
-    /* Enable the timer interrupt IRQ */
-	IRQ->EnableBasicIRQs.Enable_Timer_IRQ = true;
-
-
-    /* Setup the system timer interrupt */
-	ARMTIMER->Load = 0x400;
+	uint32_t cores = RayCast_Init((uint32_t*)PiConsole_FrameBuffer(0, 0), grWth, grHt,
+		&worldMap[0][0], mapWidth, mapHeight);
+	if (cores == 0) DeadLoop();
+	RayCast_SetSprites(&Sprites[0], _countof(Sprites));
+
+	/* Time the polygon map on a big map, then build the contour level for the p key */
+	char benchText[128];
+	PolyMapBenchmark(benchText);
+	printf("%s\n", benchText);
+	bool polyReady = (PolyMap_Build(&Level, 0.0f) != 0);
+	bool polyMap = false;											// Start on the grid map
+	RayCast_UsePolyMap(polyMap);
+	RAYCAST_CAMERA cam = {
+		.posX = 12.0f, .posY = 16.0f,								// x and y start position
+		.dirX = -1.0f, .dirY = -1.0f,								// initial direction vector
+		.planeX = 0.0f, .planeY = 0.66f								// the 2d raycaster version of camera plane
+	};
+	RAYCAST_CAMERA lastCam = cam;
 
-    /* Setup the ARM Timer */
-	ARMTIMER->Control.Counter32Bit = true;
-	ARMTIMER->Control.Prescale = Clkdiv256;
-	ARMTIMER->Control.TimerIrqEnable = true;
-	ARMTIMER->Control.TimerEnable = true;
+	/* Keys from a terminal on the uart, steps from the timer irq */
+	uartOn = Input_Init(115200);
+	if (uartOn) miniuart_puts("RayCast keys: w s a d q e or arrows move, shift runs, p grid/polygon map\n");
+	if (!GameLoop_Init(1000000 / STEP_HZ)) DeadLoop();
 
     /* Enable interrupts! */
     EnableInterrupts();
 
+	char fpsText[96] = { 0 };
+	char timeText[GL_TIMES][100] = { { 0 } };
+	bool demo = true;
+	bool showHistogram = true;
+	uint32_t frames = 0;
+	uint64_t fpsTick = timer_getTickCount();
+	uint64_t frameTick = fpsTick;
 	while (1) {
-
-		for (uint_fast32_t x = 0; x < grWth; x++) {
-
-			//calculate ray position and direction
-			CFLOAT cameraX = 2 * x / (CFLOAT)grWth - 1; //x-coordinate in camera space
-			int_fast32_t rayPosX = posX;
-			int_fast32_t rayPosY = posY;
-			CFLOAT rayDirX = dirX + planeX * cameraX;
-			CFLOAT rayDirY = dirY + planeY * cameraX;
-			
-			// box of the map we start in
-			int_fast32_t mapX = rayPosX;
-			int_fast32_t mapY = rayPosY;
-
-			//length of ray from current position to next x or y-side
-			CFLOAT sideDistX;
-			CFLOAT sideDistY;
-
-			//length of ray from one x or y-side to next x or y-side
-			CFLOAT deltaDistX = sqrt(1 + (rayDirY * rayDirY) / (rayDirX * rayDirX));
-			CFLOAT deltaDistY = sqrt(1 + (rayDirX * rayDirX) / (rayDirY * rayDirY));
-
-
-			//what direction to step in x or y-direction (either +1 or -1)
-			int_fast8_t stepX;
-			int_fast8_t stepY;
-
-
-					  //calculate step and initial sideDist
-			if (rayDirX < 0){
-				stepX = -1;
-				sideDistX = (rayPosX - mapX) * deltaDistX;
-			} else {
-				stepX = 1;
-				sideDistX = (mapX + 1 - rayPosX) * deltaDistX;
-			}
-			if (rayDirY < 0) {
-				stepY = -1;
-				sideDistY = (rayPosY - mapY) * deltaDistY;
-			} else {
-				stepY = 1;
-				sideDistY = (mapY + 1 - rayPosY) * deltaDistY;
-			}
-
-			
-
-			//perform DDA
-			bool hit = false;	// was there a wall hit?
-			bool hit_NS;		//was a NS or a EW wall hit?
-			while (!hit) {
-				//jump to next map square, OR in x-direction, OR in y-direction
-				if (sideDistX < sideDistY) {
-					sideDistX += deltaDistX;
-					mapX += stepX;
-					hit_NS = false;
-				} else {
-					sideDistY += deltaDistY;
-					mapY += stepY;
-					hit_NS = true;
-				}
-				//Check if ray has hit a wall
-				if (worldMap[mapX][mapY] > 0) hit = true;
-			}
-	
-			//Calculate distance projected on camera direction (oblique distance will give fisheye effect!)
-			int lineHeight;
-			if (hit_NS) lineHeight = grHt / ((CFLOAT)(mapY - rayPosY + (1 - stepY) / 2) / rayDirY);
-				else lineHeight = grHt/((CFLOAT)(mapX - rayPosX + (1 - stepX) / 2) / rayDirX);
-
-			//calculate lowest and highest pixel to fill in current stripe
-			int drawStart = -lineHeight / 2 + grHt / 2;
-			if(drawStart < 0)drawStart = 0;
-			int drawEnd = lineHeight / 2 + grHt / 2;
-			if(drawEnd >= grHt)drawEnd = grHt - 1;
-
-			//choose wall color
-			RGBACOLOR color;
-			switch(worldMap[mapX][mapY]) {
-				case 1:  color = RGBA_Red;  break; //red
-				case 2:  color = RGBA_Green;  break; //green
-				case 3:  color = RGBA_Blue;   break; //blue
-				case 4:  color = RGBA_White;  break; //white
-				default: color = RGBA_Yellow; break; //yellow
-			}
-
-			//give x and y sides different brightness
-			if (hit_NS) {color.R = color.R / 2; color.G = color.G / 2; color.B = color.B / 2; }
-
-			//draw the pixels of the stripe as a vertical line
-			//verLine(x, drawStart, drawEnd, color);
-			PiConsole_VertLine(x, 0, drawStart, 0x0);
-			PiConsole_VertLine(x, drawStart, drawEnd, color.raw32);
-			PiConsole_VertLine(x, drawEnd, grHt, 0x0);
-
+		/* Run the simulation steps that are due */
+		uint64_t updateTick = timer_getTickCount();
+		uint32_t step;
+		while (GameLoop_NextStep(&step)) {
+			uint32_t keys = Input_Held(step);
+			if (keys) demo = false;									// A key ends the demo spin
+			lastCam = cam;
+			UpdateCamera(&cam, keys, demo, 1.0f / STEP_HZ, polyMap);
 		}
-		//timing for input and FPS counter
-		//oldTime = time;
-		//time = getTicks();
-		//double frameTime = (time - oldTime) / 1000.0; //frameTime is the time this frame has taken, in seconds
-		//printf(1.0 / frameTime); //FPS counter
-		//redraw();
-
-		/*for (int y = 0; y < grHt; y++) {
-			uint32_t lineOffs = y * grWth;
-			for (int x = 0; x < grWth; x++) {
-				PiConsole_VertLine(x, y, y, Buffer[lineOffs + x].raw32);
+		if (ledFlip) {
+			ledFlip = false;
+			if (lit) lit = false; else lit = true;					// Flip lit flag
+			set_Activity_LED(lit);									// Turn LED on/off as per new flag
+		}
+		int ch;
+		while ((ch = Input_GetChar()) >= 0) {
+			demo = false;
+			if (ch == 'h') showHistogram = !showHistogram;
+			if (ch == 'p' && polyReady) {
+				polyMap = !polyMap;									// Flip grid and polygon walls
+				RayCast_UsePolyMap(polyMap);
+			}
+			if (ch == 'u' && uartOn) {
+				for (int i = GL_TIMES - 1; i >= 0; i--)
+					GameLoop_Print((GL_TIME)i, miniuart_puts);
 			}
 		}
 
-		memset(&Buffer[0], 0, sizeof(Buffer));*/
-		
-
-		//speed modifiers
-		//double moveSpeed = frameTime * 5.0; //the constant value is in squares/second
-		CFLOAT rotSpeed = 0.02; // frameTime * 3.0; //the constant value is in radians/second
-		
-
-		//readKeys();
-		//move forward if no wall in front of you
-		//if (keyDown(SDLK_UP))
-		//{
-		//	if(worldMap[int(posX + dirX * moveSpeed)][int(posY)] == false) posX += dirX * moveSpeed;
-		//	if(worldMap[int(posX)][int(posY + dirY * moveSpeed)] == false) posY += dirY * moveSpeed;
-		//}
-		//move backwards if no wall behind you
-		//if (keyDown(SDLK_DOWN))
-		//{
-		//	if(worldMap[int(posX - dirX * moveSpeed)][int(posY)] == false) posX -= dirX * moveSpeed;
-		//	if(worldMap[int(posX)][int(posY - dirY * moveSpeed)] == false) posY -= dirY * moveSpeed;
-		//}
-		//rotate to the right
-		//if (keyDown(SDLK_RIGHT))
-		//{
-			//both camera direction and camera plane must be rotated
-			CFLOAT oldDirX = dirX;
-			CFLOAT cf, sf;
-			cf = cos(-rotSpeed);
-			sf = sin(-rotSpeed);
-
-			dirX = dirX * cf - dirY * sf;
-			dirY = oldDirX * sf + dirY * cf;
-			CFLOAT oldPlaneX = planeX;
-			planeX = planeX * cf - planeY * sf;
-			planeY = oldPlaneX * sf + planeY * cf;
-		//}
-		//rotate to the left
-		//if (keyDown(SDLK_LEFT))
-		//{
-			//both camera direction and camera plane must be rotated
-		//	double oldDirX = dirX;
-		//	dirX = dirX * cos(rotSpeed) - dirY * sin(rotSpeed);
-		//	dirY = oldDirX * sin(rotSpeed) + dirY * cos(rotSpeed);
-		//	double oldPlaneX = planeX;
-		//	planeX = planeX * cos(rotSpeed) - planeY * sin(rotSpeed);
-		//	planeY = oldPlaneX * sin(rotSpeed) + planeY * cos(rotSpeed);
-		//}
-
+		/* Render the camera blended between the last two steps */
+		uint64_t renderTick = timer_getTickCount();
+		RAYCAST_CAMERA view = BlendCamera(&lastCam, &cam, GameLoop_Alpha());
+		RayCast_Render(&view);
+		uint64_t now = timer_getTickCount();
+		WriteText(0, 0, fpsText);									// FPS counter over the frame
+		WriteText(0, BitFontHt, benchText);
+		for (int i = 0; i < GL_TIMES; i++)
+			WriteText(0, (i + 2) * BitFontHt, timeText[GL_TIMES - 1 - i]);
+		if (demo) WriteText(0, 5 * BitFontHt, (char*)HelpText);
+		if (showHistogram)
+			GameLoop_DrawHistogram(GL_TIME_FRAME, 0, grHt - 1, 96, RGBA_LightGreen.raw32);
+		GameLoop_Record(GL_TIME_UPDATE, (uint32_t)tick_difference(updateTick, renderTick));
+		GameLoop_Record(GL_TIME_RENDER, (uint32_t)tick_difference(renderTick, now));
+		GameLoop_Record(GL_TIME_FRAME, (uint32_t)tick_difference(frameTick, now));
+		frameTick = now;
+
+		/* Count frames, once a second update the FPS text and the frame times */
+		frames++;
+		uint64_t us = tick_difference(fpsTick, now);
+		if (us >= 1000000) {
+			sprintf(fpsText, "%u FPS  %u us/frame  %u cores  %s rays  %u Hz steps  %s map ",
+				(unsigned int)((frames * 1000000ull) / us),
+				(unsigned int)(us / frames), (unsigned int)cores, SC_NAME,
+				(unsigned int)STEP_HZ, polyMap ? "polygon" : "grid");
+			GameLoop_EndWindow();
+			for (int i = 0; i < GL_TIMES; i++)
+				GameLoop_Report((GL_TIME)i, timeText[i]);
+			fpsTick = now;
+			frames = 0;
+		}
 	}
 
 	return(0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,127 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "rpi-smartstart.h"
+#include "rpi-BasicHardware.h"
+#include "mmu.h"
+
+#if __aarch64__ == 1
+/* AARCH64 */
+/* We have 2Mb blocks, level 1 has 2 entries of 1GB pointing at level 2 */
+#define NUM_PAGE_TABLE_ENTRIES 512
+/* Each Block is 2Mb in size */
+#define LEVEL1_BLOCKSIZE (1 << 21)
+/* TABLE ALIGNMENT 4K */
+#define TLB_ALIGNMENT 4096
+#else
+/* AARCH32 */
+/* We have 1MB blocks, with minimum 4096 entries	*/
+/* Covers 4GB which is more than 1GB + QA7 we need */
+#define NUM_PAGE_TABLE_ENTRIES 4096
+/* Each Block is 1Mb in size */
+#define LEVEL1_BLOCKSIZE (1 << 20)
+/* LEVEL1 TABLE ALIGNMENT 16K */
+#define TLB_ALIGNMENT 16384
+#endif
+
+/* Data cache line, 32 bytes is the smallest of the Pi cpus */
+#define DCACHE_LINE 32
+
+/***************************************************************************}
+{						   PRIVATE INTERNAL MEMORY DATA				        }
+****************************************************************************/
+#if __aarch64__ == 1
+/* First Level Page Table for 1:1 mapping */
+static uint64_t __attribute__((aligned(TLB_ALIGNMENT))) page_table_map1to1[NUM_PAGE_TABLE_ENTRIES] = { 0 };
+/* Level 2 and final ... 1024 entries x 2M so a full range of 2GB */
+static uint64_t __attribute__((aligned(TLB_ALIGNMENT))) Stage2map1to1[1024] = { 0 };
+/* Block descriptor, AF set + inner shareable (normal memory only) + block */
+#define BLOCK_NORMAL(base, attr)	((uint64_t)(base) << 21 | (1 << 10) | (3 << 8) | ((attr) << 2) | 1)
+#define BLOCK_DEVICE(base, attr)	((uint64_t)(base) << 21 | (1 << 10) | ((attr) << 2) | 1)
+#else
+/* First Level Page Table for 1:1 mapping */
+static uint32_t __attribute__((aligned(TLB_ALIGNMENT))) page_table_map1to1[NUM_PAGE_TABLE_ENTRIES] = { 0 };
+#endif
+
+/*-[ MMU_setup_pagetable ]--------------------------------------------------}
+.  Sets up the 1:1 table, asking the VideoCore where its memory starts. This
+.  needs to be called only once by one core with the MMU still off. Each
+.  core then uses the same table.
+.  RETURN: True the table is ready, False the VideoCore did not answer
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MMU_setup_pagetable (void)
+{
+	uint32_t __attribute__((aligned(16))) message[8] = {
+		sizeof(message), 0, MAILBOX_TAG_GET_VC_MEMORY, 8, 0, 0, 0, 0 };
+	mailbox_write(MB_CHANNEL_TAGS, ARMaddrToGPUaddr(&message[0]));
+	mailbox_read(MB_CHANNEL_TAGS);
+	if ((message[1] != 0x80000000) || (message[5] == 0)) return false;
+	uint32_t vcBase = message[5] / LEVEL1_BLOCKSIZE;				// First block of VC4 memory
+	uint32_t ioBase = RPi_IO_Base_Addr / LEVEL1_BLOCKSIZE;			// First block of the peripherals
+	uint32_t base;
+
+#if __aarch64__ == 1
+	/* Ram from 0x0 to VC4 RAM start */
+	for (base = 0; base < vcBase; base++)
+		Stage2map1to1[base] = BLOCK_NORMAL(base, MT_NORMAL);
+
+	/* VC ram up to the peripherals, uncached so the GPU sees what we write */
+	for (; base < ioBase; base++)
+		Stage2map1to1[base] = BLOCK_NORMAL(base, MT_NORMAL_NC);
+
+	/* Peripherals then the QA7 local peripherals at 0x40000000 */
+	for (; base < 1024; base++)
+		Stage2map1to1[base] = BLOCK_DEVICE(base, MT_DEVICE_NGNRNE);
+
+	/* Level 1 has just 2 valid entries mapping the each 1GB in stage2 to cover the 2GB */
+	page_table_map1to1[0] = (0x8000000000000000) | (uintptr_t)&Stage2map1to1[0] | 3;
+	page_table_map1to1[1] = (0x8000000000000000) | (uintptr_t)&Stage2map1to1[512] | 3;
+#else
+	/* APX = 0	AP[1:0] = b01 so read/write for privilege and cache_writeback */
+	for (base = 0; base < vcBase; base++)
+		page_table_map1to1[base] = base << 20 | MT_NORMAL;
+
+	/* VC ram up to the peripherals, uncached so the GPU sees what we write */
+	for (; base < ioBase; base++)
+		page_table_map1to1[base] = base << 20 | MT_NORMAL_NC;
+
+	/* Set some no cache strong order default values for rest of 4GB */
+	for (; base < NUM_PAGE_TABLE_ENTRIES; base++)
+		page_table_map1to1[base] = base << 20 | MT_DEVICE_NS;
+#endif
+	return true;
+}
+
+/*-[ MMU_enable ]-----------------------------------------------------------}
+.  Enables the MMU and caches with the table MMU_setup_pagetable made. This
+.  needs to be called by each individual core on a multicore system.
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MMU_enable (void)
+{
+	enable_mmu_tables(&page_table_map1to1[0]);
+}
+
+/*-[ MMU_flush_dcache ]-----------------------------------------------------}
+.  Cleans and invalidates the data cache lines over size bytes at addr, for
+.  memory the VideoCore reads or writes such as mailbox messages. Harmless
+.  with the MMU off.
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MMU_flush_dcache (void* addr, uint32_t size)
+{
+	uintptr_t p = (uintptr_t)addr & ~(uintptr_t)(DCACHE_LINE - 1);
+	uintptr_t end = (uintptr_t)addr + size;
+	for (; p < end; p += DCACHE_LINE) {
+#if __aarch64__ == 1
+		__asm volatile ("dc civac, %0" : : "r" (p) : "memory");
+#else
+		__asm volatile ("mcr p15, 0, %0, c7, c14, 1" : : "r" (p) : "memory");
+#endif
+	}
+#if __aarch64__ == 1
+	__asm volatile ("dsb sy" : : : "memory");
+#else
+	__asm volatile ("mcr p15, 0, %0, c7, c10, 4" : : "r" (0) : "memory");	// DSB, the cp15 form works on ARM6 too
+#endif
+}
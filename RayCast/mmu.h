@@ -0,0 +1,77 @@
+#ifndef _MMU_H
+#define _MMU_H
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: mmu.h														}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  A 1:1 MMU table so the data cache works (with the MMU off every data     }
+{  access is uncached). Ram up to the VideoCore memory is normal cached,    }
+{  VideoCore memory (where the framebuffer is) normal uncached and the      }
+{  peripherals device memory. Pi2 and Pi3 only, AARCH32 or AARCH64.         }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#if __aarch64__ == 1
+#define MT_DEVICE_NGNRNE	0
+#define MT_DEVICE_NGNRE		1
+#define MT_DEVICE_GRE		2
+#define MT_NORMAL_NC		3
+#define MT_NORMAL		    4
+#else
+#define MT_DEVICE_NS  0x10412					//  device no share (strongly ordered)
+#define MT_DEVICE     0x10416                   //  device + shareable
+#define MT_NORMAL	  0x1040E					//	normal cache + shareable
+#define MT_NORMAL_NC  0x11402					//	normal no cache + shareable
+#endif
+
+/*-[ MMU_setup_pagetable ]--------------------------------------------------}
+.  Sets up the 1:1 table, asking the VideoCore where its memory starts. This
+.  needs to be called only once by one core with the MMU still off. Each
+.  core then uses the same table.
+.  RETURN: True the table is ready, False the VideoCore did not answer
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool MMU_setup_pagetable (void);
+
+/*-[ MMU_enable ]-----------------------------------------------------------}
+.  Enables the MMU and caches with the table MMU_setup_pagetable made. This
+.  needs to be called by each individual core on a multicore system.
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MMU_enable (void);
+
+/*-[ MMU_flush_dcache ]-----------------------------------------------------}
+.  Cleans and invalidates the data cache lines over size bytes at addr, for
+.  memory the VideoCore reads or writes such as mailbox messages. Harmless
+.  with the MMU off.
+.  19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void MMU_flush_dcache (void* addr, uint32_t size);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #include <stdint.h>								// Needed for uint8_t, uint32_t, uint64_t etc
 #include <stdio.h>								// Needed for printf
 #include "rpi-BasicHardware.h"					// This units header
+#include "mmu.h"								// Needed for MMU_flush_dcache
 #include <string.h>
 
 /***************************************************************************}
@@ -26,6 +27,7 @@ static_assert(sizeof(struct GPIORegisters) == 0xA0, "Register/Structure should b
 static_assert(sizeof(struct SystemTimerRegisters) == 0x1C, "Register/Structure should be 0x1C bytes in size");
 static_assert(sizeof(struct IrqControlRegisters) == 0x28, "Register/Structure should be 0x28 bytes in size");
 static_assert(sizeof(struct ArmTimerRegisters) == 0x1C, "Register/Structure should be 0x1C bytes in size");
+static_assert(sizeof(struct AuxRegisters) == 0x6C, "Register/Structure should be 0x6C bytes in size");
 
 
 /***************************************************************************}
@@ -188,6 +190,34 @@ uint64_t tick_difference (uint64_t us1, uint64_t us2) {
 	return us2 - us1;												// Return difference between values
 }
 
+/*-[timer_irqSetup]---------------------------------------------------------}
+ Starts the ARM timer raising the timer irq every period_in_us microseconds.
+ The ARM timer runs off the core clock through a divider, so it is measured
+ against the 1Mhz system timer first. Interrupts must still be enabled.
+ RETURN: True for success, False if the period will not fit the timer
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool timer_irqSetup (uint32_t period_in_us) {
+	ARMTIMER->Control.TimerEnable = false;							// Illegal to change anything while running
+	ARMTIMER->Control.TimerIrqEnable = false;						// No irq while we measure
+	ARMTIMER->Control.Counter32Bit = true;							// Counter in 32 bit mode
+	ARMTIMER->Control.Prescale = Clkdiv1;							// No prescale
+	ARMTIMER->Load = 0xFFFFFFFF;									// Count down from the top
+	ARMTIMER->Control.TimerEnable = true;							// Start it counting
+	uint32_t start = ARMTIMER->Value;
+	timer_wait(10000);												// 10ms of the system timer
+	uint64_t counts = start - ARMTIMER->Value;						// ARM timer counts in 10ms
+	ARMTIMER->Control.TimerEnable = false;							// Stop it to set the period
+	uint64_t load = (counts * period_in_us) / 10000;				// Counts in the period
+	if (load == 0 || load > 0xFFFFFFFF) return false;				// Period can't be made
+	ARMTIMER->Load = (uint32_t)load;								// Set the load value
+	ARMTIMER->Clear = 1;											// Drop any irq already raised
+	IRQ->EnableBasicIRQs.Enable_Timer_IRQ = true;					// Enable the timer interrupt IRQ
+	ARMTIMER->Control.TimerIrqEnable = true;						// Enable timer irq
+	ARMTIMER->Control.TimerEnable = true;							// Now start the clock
+	return true;
+}
+
 /*--------------------------------------------------------------------------}
 {						    PI MAILBOX ROUTINES								}
 {--------------------------------------------------------------------------*/
@@ -231,6 +261,90 @@ uint32_t mailbox_read (MAILBOX_CHANNEL channel) {
 	return value;													// Return the value
 }
 
+/*--------------------------------------------------------------------------}
+{						    PI MINI UART ROUTINES							}
+{--------------------------------------------------------------------------*/
+
+/*-[INTERNAL: CoreClockRate]------------------------------------------------}
+ Reads the core (VPU) clock the mini uart baud rate is divided from.
+ RETURN: Clock in Hz, 0 for failure
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+static uint32_t CoreClockRate (void) {
+	uint32_t __attribute__((aligned(16))) message[8];
+	message[0] = sizeof(message);									// Set total message size
+	message[1] = 0;													// Zero response message
+	message[2] = MAILBOX_TAG_GET_CLOCK_RATE;						// Get clock rate
+	message[3] = 8;													// Response Buffer length is 8 bytes
+	message[4] = 4;													// Request length data length = 4
+	message[5] = 0x000000004;										// Core clock
+	message[6] = 0;													// Value
+	message[7] = 0;													// END no more tags
+	MMU_flush_dcache(&message[0], sizeof(message));					// GPU must see the message with the cache on
+	mailbox_write(MB_CHANNEL_TAGS, ARMaddrToGPUaddr(&message[0]));
+	mailbox_read(MB_CHANNEL_TAGS);									// Write message and clear response
+	MMU_flush_dcache(&message[0], sizeof(message));					// Drop any stale lines over the response
+	if ((message[1] == 0x80000000) && (message[4] == 0x80000008))
+		return message[6];											// Clock rate in Hz
+	return 0;														// Clock read failed
+}
+
+/*-[miniuart_init]----------------------------------------------------------}
+ Sets the mini uart up at baudrate, 8 data bits no parity 1 stop bit, on
+ GPIO14 (TXD) and GPIO15 (RXD).
+ RETURN: True for success, False if the baudrate can't be made
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool miniuart_init (uint32_t baudrate) {
+	uint32_t clock = CoreClockRate();
+	if (clock == 0 || baudrate == 0) return false;					// No clock or no baudrate
+	uint32_t divisor = (clock / (baudrate * 8)) - 1;				// Baud = clock / (8 * (divisor + 1))
+	if (divisor > 0xFFFF) return false;								// Baudrate too low to make
+	AUX->Enables |= 1;												// Enable the mini uart
+	AUX->MuCntl = 0;												// Receiver and transmitter off
+	AUX->MuIER = 0;													// No mini uart interrupts
+	AUX->MuLCR = 3;													// 8 data bits
+	AUX->MuMCR = 0;													// RTS line high
+	AUX->MuIIR = 0x06;												// Clear both fifos
+	AUX->MuBaud = divisor;											// Set the divisor
+	gpio_setup(14, ALTFUNC5);										// GPIO14 is TXD1
+	gpio_setup(15, ALTFUNC5);										// GPIO15 is RXD1
+	gpio_fixResistor(15, PULLUP);									// Idle the receive line high
+	AUX->MuCntl = 3;												// Receiver and transmitter on
+	return true;
+}
+
+/*-[miniuart_poll]----------------------------------------------------------}
+ Takes the next received character without waiting, safe from an irq.
+ RETURN: True with the character in *ch, False if none is waiting
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool miniuart_poll (char* ch) {
+	if ((AUX->MuLSR & MU_LSR_RX_READY) == 0) return false;			// Nothing in the receive fifo
+	*ch = (char)(AUX->MuIO & 0xFF);									// Take the character
+	return true;
+}
+
+/*-[miniuart_putc]----------------------------------------------------------}
+ Sends a character, waiting for room in the transmit fifo.
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+void miniuart_putc (char ch) {
+	while ((AUX->MuLSR & MU_LSR_TX_EMPTY) == 0) {};					// Wait for room in the fifo
+	AUX->MuIO = (uint8_t)ch;										// Send the character
+}
+
+/*-[miniuart_puts]----------------------------------------------------------}
+ Sends a string, each \n is sent as \r\n for a terminal.
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+void miniuart_puts (const char* str) {
+	while (*str) {
+		if (*str == '\n') miniuart_putc('\r');						// Terminals want a carriage return
+		miniuart_putc(*str++);
+	}
+}
+
 
 /*--------------------------------------------------------------------------}
 {						  PI ACTIVITY LED ROUTINES							}
@@ -286,8 +400,10 @@ bool set_Activity_LED (bool on) {
 			message[5] = 130;										// Port 130
 			message[6] = (uint32_t)on;								// Set on/off
 			message[7] = 0;											// END no more tags
+			MMU_flush_dcache(&message[0], sizeof(message));			// GPU must see the message with the cache on
 			mailbox_write(MB_CHANNEL_TAGS, ARMaddrToGPUaddr(&message[0]));
 			mailbox_read(MB_CHANNEL_TAGS);							// Write message and clear response
+			MMU_flush_dcache(&message[0], sizeof(message));			// Drop any stale lines over the response
 			if ((message[1] == 0x80000000) && (message[4] == 0x80000008))
 				return true;
 		}
@@ -542,6 +658,17 @@ void PiConsole_VertLine(int X1, int Y1, int Y2, uint32_t col) {
 	con.fb.VertLine(&con.fb, X1, Y1, Y2, col);
 }
 
+/*-PiConsole_FrameBuffer-----------------------------------------------------
+Returns the ARM address of the console framebuffer and sets its width and
+height in pixels if the pointers are not NULL. Rows are width pixels apart.
+19Oct26 LdB
+--------------------------------------------------------------------------*/
+uintptr_t PiConsole_FrameBuffer (int* Width, int* Height) {
+	if (Width) *Width = con.fb.width;
+	if (Height) *Height = con.fb.height;
+	return (uintptr_t)con.fb.buffer;
+}
+
 /*-WriteText-----------------------------------------------------------------
 Draws given string in BitFont Characters in the colour specified starting at
 (X,Y) on the screen. It just redirects each character write to WriteChar.
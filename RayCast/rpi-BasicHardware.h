@@ -583,6 +583,29 @@ struct __attribute__((__packed__, aligned(4))) MailBoxRegisters {
 	volatile uint32_t Config1;										// 0x3C 
 };
 
+/*--------------------------------------------------------------------------}
+{  RASPBERRY PI AUX MINI UART HARDWARE REGISTERS - BCM2835 Manual Section 2	}
+{--------------------------------------------------------------------------*/
+struct __attribute__((__packed__, aligned(4))) AuxRegisters {
+	const volatile uint32_t Irq;									// 0x00  ** Read only hence const
+	volatile uint32_t Enables;										// 0x04  Bit 0 enables the mini uart
+	uint32_t Unused[14];											// 0x08-0x3F
+	volatile uint32_t MuIO;											// 0x40  Data in/out, 8 bits
+	volatile uint32_t MuIER;										// 0x44  Interrupt enables
+	volatile uint32_t MuIIR;										// 0x48  Interrupt id, write 0x06 clears both fifos
+	volatile uint32_t MuLCR;										// 0x4C  Line control, 3 = 8 data bits
+	volatile uint32_t MuMCR;										// 0x50  Modem control
+	const volatile uint32_t MuLSR;									// 0x54  ** Read only hence const
+	const volatile uint32_t MuMSR;									// 0x58  ** Read only hence const
+	volatile uint32_t MuScratch;									// 0x5C
+	volatile uint32_t MuCntl;										// 0x60  Bit 0 receiver, bit 1 transmitter enable
+	const volatile uint32_t MuStat;									// 0x64  ** Read only hence const
+	volatile uint32_t MuBaud;										// 0x68  Baud = core clock / (8 * (MuBaud + 1))
+};
+
+#define MU_LSR_RX_READY		0x01							// Receive fifo holds at least 1 byte
+#define MU_LSR_TX_EMPTY		0x20							// Transmit fifo can take at least 1 byte
+
 
 /***************************************************************************}
 {     PUBLIC POINTERS TO ALL OUR RASPBERRY PI REGISTER BANK STRUCTURES	    }
@@ -595,6 +618,7 @@ struct __attribute__((__packed__, aligned(4))) MailBoxRegisters {
 #define IRQ ((volatile __attribute__((aligned(4))) struct IrqControlRegisters*)(uintptr_t)(RPi_IO_Base_Addr + 0xB200u))
 #define ARMTIMER ((volatile __attribute__((aligned(4))) struct  ArmTimerRegisters*)(uintptr_t)(RPi_IO_Base_Addr + 0xB400u))
 #define MAILBOX ((volatile __attribute__((aligned(4))) struct MailBoxRegisters*)(uintptr_t)(RPi_IO_Base_Addr + 0xB880u))
+#define AUX ((volatile __attribute__((aligned(4))) struct AuxRegisters*)(uintptr_t)(RPi_IO_Base_Addr + 0x215000u))
 
 /***************************************************************************}
 {					      PUBLIC INTERFACE ROUTINES			                }
@@ -678,6 +702,15 @@ void timer_wait (uint64_t us);
  --------------------------------------------------------------------------*/
 uint64_t tick_difference (uint64_t us1, uint64_t us2);
 
+/*-[timer_irqSetup]---------------------------------------------------------}
+ Starts the ARM timer raising the timer irq every period_in_us microseconds.
+ The ARM timer runs off the core clock through a divider, so it is measured
+ against the 1Mhz system timer first. Interrupts must still be enabled.
+ RETURN: True for success, False if the period will not fit the timer
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool timer_irqSetup (uint32_t period_in_us);
+
 /*--------------------------------------------------------------------------}
 {						    PI MAILBOX ROUTINES								}
 {--------------------------------------------------------------------------*/
@@ -697,6 +730,37 @@ bool mailbox_write (MAILBOX_CHANNEL channel, uint32_t message);
  --------------------------------------------------------------------------*/
 uint32_t mailbox_read (MAILBOX_CHANNEL channel);
 
+/*--------------------------------------------------------------------------}
+{						   PUBLIC MINI UART ROUTINES						}
+{--------------------------------------------------------------------------*/
+
+/*-[miniuart_init]----------------------------------------------------------}
+ Sets the mini uart up at baudrate, 8 data bits no parity 1 stop bit, on
+ GPIO14 (TXD) and GPIO15 (RXD).
+ RETURN: True for success, False if the baudrate can't be made
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool miniuart_init (uint32_t baudrate);
+
+/*-[miniuart_poll]----------------------------------------------------------}
+ Takes the next received character without waiting, safe from an irq.
+ RETURN: True with the character in *ch, False if none is waiting
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+bool miniuart_poll (char* ch);
+
+/*-[miniuart_putc]----------------------------------------------------------}
+ Sends a character, waiting for room in the transmit fifo.
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+void miniuart_putc (char ch);
+
+/*-[miniuart_puts]----------------------------------------------------------}
+ Sends a string, each \n is sent as \r\n for a terminal.
+ 19Oct26 LdB
+ --------------------------------------------------------------------------*/
+void miniuart_puts (const char* str);
+
 /*--------------------------------------------------------------------------}
 {						  PI ACTIVITY LED ROUTINES							}
 {--------------------------------------------------------------------------*/
@@ -709,6 +773,7 @@ void DeadLoop (void);
 bool PiConsole_Init (int Width, int Height, int Depth);
 void PiConsole_WriteChar (char Ch);
 void PiConsole_VertLine (int X1, int Y1, int Y2, uint32_t col);
+uintptr_t PiConsole_FrameBuffer (int* Width, int* Height);
 void WriteText (int x, int y, char* txt);
 
 int printf(const char *fmt, ...);
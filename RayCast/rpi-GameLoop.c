@@ -0,0 +1,248 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <stdio.h>								// Needed for sprintf
+#include "rpi-smartstart.h"						// Needed for RPi_IO_Base_Addr
+#include "rpi-BasicHardware.h"					// Needed for ARMTIMER, timer_irqSetup, PiConsole_VertLine
+#include "rpi-GameLoop.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-GameLoop.c											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The irq only ever writes the tick count and the main code only the done  }
+{  count, so the steps due are the difference with no lock. Bin b covers    }
+{  times from (4 + b%4) << (b/4 + 2) up to the start of the next bin, the   }
+{  first bin also takes anything under 16us and the last anything over.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+typedef struct {
+	uint32_t bins[GL_HIST_BINS];				// Count in each bin
+	uint32_t count;								// Times recorded
+	uint32_t max;								// Longest time
+	uint64_t sum;								// Total of the times
+} GL_HISTOGRAM;
+
+static struct {
+	volatile uint32_t ticks;					// Steps raised by the irq
+	uint32_t done;								// Steps run or dropped
+	uint32_t run;								// Steps run since the last render
+	uint32_t steps[2];							// Steps run this window and last window
+	uint32_t dropped[2];						// Steps dropped this window and last window
+	GL_HISTOGRAM now[GL_TIMES];					// The window being recorded
+	GL_HISTOGRAM last[GL_TIMES];				// The window last ended
+} gl = { 0 };
+
+static const char* TimeName[GL_TIMES] = { "update", "render", "frame" };
+
+/*--------------------------------------------------------------------------}
+{						 The bin a time in us goes in						}
+{--------------------------------------------------------------------------*/
+static uint32_t BinOf (uint32_t us)
+{
+	if (us < 16) return 0;
+	uint32_t octave = 31 - __builtin_clz(us);						// 4 or more
+	uint32_t bin = (octave - 4) * 4 + ((us >> (octave - 2)) & 3);	// Next 2 bits pick the quarter
+	return (bin < GL_HIST_BINS) ? bin : GL_HIST_BINS - 1;
+}
+
+/*--------------------------------------------------------------------------}
+{					  The first time past the end of a bin					}
+{--------------------------------------------------------------------------*/
+static uint32_t BinTop (uint32_t bin)
+{
+	return (5 + (bin & 3)) << (bin / 4 + 2);
+}
+
+/*--------------------------------------------------------------------------}
+{	   Top of the bin holding the given percent of the times, held to max	}
+{--------------------------------------------------------------------------*/
+static uint32_t Percentile (const GL_HISTOGRAM* h, uint32_t percent)
+{
+	uint32_t want = (uint32_t)(((uint64_t)h->count * percent + 99) / 100);
+	uint32_t seen = 0;
+	for (uint32_t b = 0; b < GL_HIST_BINS; b++) {
+		seen += h->bins[b];
+		if (seen >= want) return (BinTop(b) < h->max && b < GL_HIST_BINS - 1) ? BinTop(b) : h->max;
+	}
+	return h->max;
+}
+
+/*-[GameLoop_Init]----------------------------------------------------------}
+. Starts the ARM timer irq at one step every stepUs microseconds and clears
+. the step count and histograms. The irq handler must call GameLoop_TimerIrq
+. and interrupts must still be enabled.
+. RETURN: True for success, False if the timer could not be set up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool GameLoop_Init (uint32_t stepUs)
+{
+	gl = (typeof(gl)) { 0 };
+	return timer_irqSetup(stepUs);
+}
+
+/*-[GameLoop_TimerIrq]------------------------------------------------------}
+. Counts a step, called from the timer irq handler.
+. RETURN: Steps counted since GameLoop_Init
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t GameLoop_TimerIrq (void)
+{
+	uint32_t ticks = gl.ticks + 1;
+	gl.ticks = ticks;
+	return ticks;
+}
+
+/*-[GameLoop_NextStep]------------------------------------------------------}
+. Loop on this before each render to run the updates that are due. After
+. GL_MAX_STEPS in one go any more due are dropped.
+. RETURN: True with the number of the step to run, False when caught up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool GameLoop_NextStep (uint32_t* step)
+{
+	uint32_t due = gl.ticks - gl.done;								// Wraps safely
+	if (due == 0 || gl.run >= GL_MAX_STEPS) {
+		gl.dropped[0] += due;										// Too far behind, let them go
+		gl.done += due;
+		gl.run = 0;
+		return false;
+	}
+	*step = gl.done++;
+	gl.run++;
+	gl.steps[0]++;
+	return true;
+}
+
+/*-[GameLoop_Alpha]---------------------------------------------------------}
+. How far the timer is from the last step run to the next, to blend the
+. last two steps by for the render.
+. RETURN: 0.0 just after a step up to 1.0 when the next is due
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+float GameLoop_Alpha (void)
+{
+	if (gl.ticks != gl.done) return 1.0f;							// A step came in since the updates
+	uint32_t load = ARMTIMER->Load;
+	uint32_t value = ARMTIMER->Value;								// Counts down to the next step
+	if (load == 0 || value > load) return 1.0f;
+	return (float)(load - value) / (float)load;
+}
+
+/*-[GameLoop_Record]--------------------------------------------------------}
+. Adds a time in microseconds to the histogram of the part of the frame.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Record (GL_TIME which, uint32_t us)
+{
+	if (which >= GL_TIMES) return;
+	GL_HISTOGRAM* h = &gl.now[which];
+	h->bins[BinOf(us)]++;
+	h->count++;
+	h->sum += us;
+	if (us > h->max) h->max = us;
+}
+
+/*-[GameLoop_EndWindow]-----------------------------------------------------}
+. Ends the histogram window, it is kept for the report, print and draw
+. calls and a new empty window starts.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_EndWindow (void)
+{
+	for (int i = 0; i < GL_TIMES; i++) {
+		gl.last[i] = gl.now[i];
+		gl.now[i] = (GL_HISTOGRAM) { 0 };
+	}
+	gl.steps[1] = gl.steps[0];
+	gl.dropped[1] = gl.dropped[0];
+	gl.steps[0] = gl.dropped[0] = 0;
+}
+
+/*-[GameLoop_Report]--------------------------------------------------------}
+. Writes one line of text for a part of the frame over the last window,
+. the count, average, 50th and 99th percentile and the longest time. The
+. percentiles are the top of their bin. The update line adds the steps run
+. and dropped in the window.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Report (GL_TIME which, char* text)
+{
+	if (which >= GL_TIMES) {
+		text[0] = 0;
+		return;
+	}
+	const GL_HISTOGRAM* h = &gl.last[which];
+	int n = sprintf(text, "%-6s x%-4u avg %6u  p50 %6u  p99 %6u  max %6u us",
+		TimeName[which], (unsigned int)h->count,
+		(unsigned int)(h->count ? h->sum / h->count : 0),
+		(unsigned int)Percentile(h, 50), (unsigned int)Percentile(h, 99),
+		(unsigned int)h->max);
+	if (which == GL_TIME_UPDATE)
+		sprintf(&text[n], "  %u steps %u dropped ",
+			(unsigned int)gl.steps[1], (unsigned int)gl.dropped[1]);
+}
+
+/*-[GameLoop_Print]---------------------------------------------------------}
+. Prints the report line and every bin in use over the last window through
+. the given puts function (miniuart_puts for a terminal).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Print (GL_TIME which, void (*puts) (const char* str))
+{
+	char line[128];
+	if (which >= GL_TIMES || puts == 0) return;
+	const GL_HISTOGRAM* h = &gl.last[which];
+	GameLoop_Report(which, line);
+	puts(line);
+	puts("\n");
+	for (uint32_t b = 0; b < GL_HIST_BINS; b++) {
+		if (h->bins[b] == 0) continue;
+		uint32_t from = (b == 0) ? 0 : BinTop(b - 1);
+		uint32_t to = (b == GL_HIST_BINS - 1) ? h->max : BinTop(b);	// Last bin runs to the longest
+		sprintf(line, "  %7u - %7u us %6u ", (unsigned int)from,
+			(unsigned int)to, (unsigned int)h->bins[b]);
+		puts(line);
+		for (uint32_t i = 0; i < (h->bins[b] * 40 + h->count - 1) / h->count; i++)
+			puts("#");												// Bar 40 wide for all the times
+		puts("\n");
+	}
+}
+
+/*-[GameLoop_DrawHistogram]-------------------------------------------------}
+. Draws the histogram of the last window as bars on the console screen,
+. 4 pixels a bin with the bottom left corner at x,y and height tall.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_DrawHistogram (GL_TIME which, int x, int y, int height, uint32_t col)
+{
+	if (which >= GL_TIMES || height < 2) return;
+	const GL_HISTOGRAM* h = &gl.last[which];
+	uint32_t tallest = 1;
+	for (uint32_t b = 0; b < GL_HIST_BINS; b++)
+		if (h->bins[b] > tallest) tallest = h->bins[b];
+	for (uint32_t b = 0; b < GL_HIST_BINS; b++) {
+		int bar = (int)((h->bins[b] * (uint32_t)(height - 1)) / tallest);
+		if (h->bins[b] && bar == 0) bar = 1;						// Any count at all shows
+		for (int i = 0; i < 4; i++) {
+			int px = x + (int)b * 4 + i;
+			PiConsole_VertLine(px, y - height + 1, y, 0xFF000000);	// Black behind the bars
+			if (bar && i < 3) PiConsole_VertLine(px, y - bar + 1, y, col);
+		}
+	}
+}
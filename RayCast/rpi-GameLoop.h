@@ -0,0 +1,124 @@
+#ifndef _RPI_GAMELOOP_
+#define _RPI_GAMELOOP_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-GameLoop.h											}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  A fixed step game loop. The ARM timer irq counts simulation steps at a   }
+{  fixed rate and the main loop runs the updates that are due then renders  }
+{  once, as often as it can. So the world moves at the same speed whatever  }
+{  the frame rate, and the render blends the last two steps by how far the  }
+{  timer is into the next one. A frame that falls more than GL_MAX_STEPS    }
+{  behind drops the rest rather than spiral ever further behind.            }
+{                                                                           }
+{  The time spent in each part of a frame goes in a histogram of quarter    }
+{  octave bins, 16us up to a second, over a window the caller ends.         }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define GL_MAX_STEPS		5					// Most updates run before each render
+#define GL_HIST_BINS		64					// Quarter octave bins from 16us up
+
+/* The parts of a frame that are timed */
+typedef enum {
+	GL_TIME_UPDATE = 0,							// All the updates run before a render
+	GL_TIME_RENDER = 1,							// The render
+	GL_TIME_FRAME = 2,							// One whole pass of the loop
+	GL_TIMES = 3								// Number of parts timed
+} GL_TIME;
+
+/*-[GameLoop_Init]----------------------------------------------------------}
+. Starts the ARM timer irq at one step every stepUs microseconds and clears
+. the step count and histograms. The irq handler must call GameLoop_TimerIrq
+. and interrupts must still be enabled.
+. RETURN: True for success, False if the timer could not be set up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool GameLoop_Init (uint32_t stepUs);
+
+/*-[GameLoop_TimerIrq]------------------------------------------------------}
+. Counts a step, called from the timer irq handler.
+. RETURN: Steps counted since GameLoop_Init
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t GameLoop_TimerIrq (void);
+
+/*-[GameLoop_NextStep]------------------------------------------------------}
+. Loop on this before each render to run the updates that are due. After
+. GL_MAX_STEPS in one go any more due are dropped.
+. RETURN: True with the number of the step to run, False when caught up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool GameLoop_NextStep (uint32_t* step);
+
+/*-[GameLoop_Alpha]---------------------------------------------------------}
+. How far the timer is from the last step run to the next, to blend the
+. last two steps by for the render.
+. RETURN: 0.0 just after a step up to 1.0 when the next is due
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+float GameLoop_Alpha (void);
+
+/*-[GameLoop_Record]--------------------------------------------------------}
+. Adds a time in microseconds to the histogram of the part of the frame.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Record (GL_TIME which, uint32_t us);
+
+/*-[GameLoop_EndWindow]-----------------------------------------------------}
+. Ends the histogram window, it is kept for the report, print and draw
+. calls and a new empty window starts.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_EndWindow (void);
+
+/*-[GameLoop_Report]--------------------------------------------------------}
+. Writes one line of text for a part of the frame over the last window,
+. the count, average, 50th and 99th percentile and the longest time. The
+. percentiles are the top of their bin. The update line adds the steps run
+. and dropped in the window.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Report (GL_TIME which, char* text);
+
+/*-[GameLoop_Print]---------------------------------------------------------}
+. Prints the report line and every bin in use over the last window through
+. the given puts function (miniuart_puts for a terminal).
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_Print (GL_TIME which, void (*puts) (const char* str));
+
+/*-[GameLoop_DrawHistogram]-------------------------------------------------}
+. Draws the histogram of the last window as bars on the console screen,
+. 4 pixels a bin with the bottom left corner at x,y and height tall.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void GameLoop_DrawHistogram (GL_TIME which, int x, int y, int height, uint32_t col);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,216 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-smartstart.h"						// Needed for EnableInterrupts, DisableInterrupts
+#include "rpi-BasicHardware.h"					// Needed for miniuart_init, miniuart_poll
+#include "rpi-Input.h"							// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Input.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  A terminal sends an arrow as ESC [ A to D, shift arrows as ESC [ 1 ; 2 A }
+{  and the escape is taken apart one character at a time as it arrives.     }
+{  The queue has one writer at a time, the irq for the uart and the main    }
+{  code for USB with the irq held off while it writes.                      }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/* USB HID usage codes for the movement keys */
+#define HID_A				0x04
+#define HID_D				0x07
+#define HID_E				0x08
+#define HID_Q				0x14
+#define HID_S				0x16
+#define HID_W				0x1A
+#define HID_RIGHT			0x4F
+#define HID_LEFT			0x50
+#define HID_DOWN			0x51
+#define HID_UP				0x52
+#define HID_SHIFTS			0x22				// Left and right shift modifier bits
+
+static struct {
+	volatile uint32_t heldUntil[INPUT_KEYS];	// Step each terminal key is held until
+	volatile uint32_t hidKeys;					// KEY_ bits down in the last USB report
+	uint8_t lastReport[6];						// Key codes in the last USB report
+	uint8_t escState;							// 0 plain, 1 after ESC, 2 inside ESC [
+	uint8_t escParam;							// Last number inside ESC [
+	volatile uint32_t qHead;					// Next queue slot written
+	volatile uint32_t qTail;					// Next queue slot read
+	char queue[INPUT_QUEUE];
+} in = { 0 };
+
+/*--------------------------------------------------------------------------}
+{				The KEY_ bits for a terminal character, 0 for none			}
+{--------------------------------------------------------------------------*/
+static uint32_t CharKeys (char ch)
+{
+	switch (ch) {
+		case 'w': return KEY_FORWARD;
+		case 's': return KEY_BACK;
+		case 'a': return KEY_TURN_LEFT;
+		case 'd': return KEY_TURN_RIGHT;
+		case 'q': return KEY_STRAFE_LEFT;
+		case 'e': return KEY_STRAFE_RIGHT;
+		case 'W': return KEY_FORWARD | KEY_RUN;
+		case 'S': return KEY_BACK | KEY_RUN;
+		case 'A': return KEY_TURN_LEFT | KEY_RUN;
+		case 'D': return KEY_TURN_RIGHT | KEY_RUN;
+		case 'Q': return KEY_STRAFE_LEFT | KEY_RUN;
+		case 'E': return KEY_STRAFE_RIGHT | KEY_RUN;
+	}
+	return 0;
+}
+
+/*--------------------------------------------------------------------------}
+{				Adds a character to the queue, dropped if full				}
+{--------------------------------------------------------------------------*/
+static void QueueChar (char ch)
+{
+	uint32_t head = in.qHead;
+	if (head - in.qTail >= INPUT_QUEUE) return;						// Full, drop it
+	in.queue[head & (INPUT_QUEUE - 1)] = ch;
+	in.qHead = head + 1;											// Publish after the write
+}
+
+/*--------------------------------------------------------------------------}
+{					Holds the keys until the step given						}
+{--------------------------------------------------------------------------*/
+static void HoldKeys (uint32_t keys, uint32_t until)
+{
+	for (int i = 0; i < INPUT_KEYS; i++)
+		if (keys & (1u << i)) in.heldUntil[i] = until;
+}
+
+/*-[Input_Init]-------------------------------------------------------------}
+. Starts the mini uart at baudrate for a terminal and clears all key state.
+. The USB keyboard path needs no set up here.
+. RETURN: True for success, False if the uart could not be set up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Input_Init (uint32_t baudrate)
+{
+	for (int i = 0; i < INPUT_KEYS; i++) in.heldUntil[i] = 0;
+	in.hidKeys = 0;
+	for (int i = 0; i < 6; i++) in.lastReport[i] = 0;
+	in.escState = 0;
+	in.qHead = in.qTail = 0;
+	return miniuart_init(baudrate);
+}
+
+/*-[Input_PollUart]---------------------------------------------------------}
+. Empties the uart receive fifo, holding each movement key until step is
+. INPUT_HOLD_STEPS further on. Made to be called from the timer irq with
+. the step count the irq has reached.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Input_PollUart (uint32_t step)
+{
+	char ch;
+	while (miniuart_poll(&ch)) {
+		uint32_t keys = 0;
+		if (in.escState == 1) {										// After ESC
+			in.escParam = 0;
+			in.escState = (ch == '[') ? 2 : 0;
+			if (ch == '[') continue;								// Anything else is a plain key
+		}
+		if (in.escState == 2) {										// Inside ESC [
+			if (ch >= '0' && ch <= '9') {
+				in.escParam = (uint8_t)(ch - '0');					// Only the last digit matters
+				continue;
+			}
+			if (ch == ';') continue;
+			in.escState = 0;
+			switch (ch) {
+				case 'A': keys = KEY_FORWARD; break;
+				case 'B': keys = KEY_BACK; break;
+				case 'C': keys = KEY_TURN_RIGHT; break;
+				case 'D': keys = KEY_TURN_LEFT; break;
+			}
+			if (keys && in.escParam == 2) keys |= KEY_RUN;			// ESC [ 1 ; 2 is shift
+		} else if (ch == 0x1B) {
+			in.escState = 1;										// Escape started
+			continue;
+		} else {
+			keys = CharKeys(ch);
+			if (keys == 0) QueueChar(ch);							// Not a movement key
+		}
+		HoldKeys(keys, step + INPUT_HOLD_STEPS);
+	}
+}
+
+/*-[Input_HidReport]--------------------------------------------------------}
+. Takes an 8 byte USB boot protocol keyboard report, the keys in it are
+. held until a report without them. Keys not in the last report are queued.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Input_HidReport (const uint8_t report[8])
+{
+	uint32_t keys = 0;
+	bool shift = (report[0] & HID_SHIFTS) != 0;
+	for (int i = 2; i < 8; i++) {
+		uint8_t code = report[i];
+		switch (code) {
+			case HID_W: case HID_UP: keys |= KEY_FORWARD; break;
+			case HID_S: case HID_DOWN: keys |= KEY_BACK; break;
+			case HID_A: case HID_LEFT: keys |= KEY_TURN_LEFT; break;
+			case HID_D: case HID_RIGHT: keys |= KEY_TURN_RIGHT; break;
+			case HID_Q: keys |= KEY_STRAFE_LEFT; break;
+			case HID_E: keys |= KEY_STRAFE_RIGHT; break;
+			default:
+				if (code >= HID_A && code <= 0x1D) {				// Other letters are queued
+					bool wasDown = false;
+					for (int j = 0; j < 6; j++)
+						if (in.lastReport[j] == code) wasDown = true;
+					if (!wasDown) {
+						DisableInterrupts();						// The uart irq writes the queue too
+						QueueChar((char)((shift ? 'A' : 'a') + code - HID_A));
+						EnableInterrupts();
+					}
+				}
+		}
+	}
+	if (keys && shift) keys |= KEY_RUN;
+	in.hidKeys = keys;
+	for (int i = 0; i < 6; i++) in.lastReport[i] = report[i + 2];
+}
+
+/*-[Input_Held]-------------------------------------------------------------}
+. The KEY_ bits held during the given step.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Input_Held (uint32_t step)
+{
+	uint32_t keys = in.hidKeys;
+	for (int i = 0; i < INPUT_KEYS; i++)
+		if ((int32_t)(in.heldUntil[i] - step) > 0) keys |= (1u << i);	// Wraps safely
+	return keys;
+}
+
+/*-[Input_GetChar]----------------------------------------------------------}
+. Takes the next key from the queue, movement keys are never queued.
+. RETURN: The character, -1 if the queue is empty
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+int Input_GetChar (void)
+{
+	uint32_t tail = in.qTail;
+	if (tail == in.qHead) return -1;								// Queue empty
+	char ch = in.queue[tail & (INPUT_QUEUE - 1)];
+	in.qTail = tail + 1;
+	return (uint8_t)ch;
+}
@@ -0,0 +1,93 @@
+#ifndef _RPI_INPUT_
+#define _RPI_INPUT_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Input.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Keyboard input for the game loop from two places. A terminal on the      }
+{  mini uart (GPIO14/15) is read from the timer irq so no key is lost while }
+{  a long frame renders. A terminal only sends characters, not key up and   }
+{  down, so a movement key counts as held for INPUT_HOLD_STEPS steps after  }
+{  each character and its auto repeat keeps it held. A USB keyboard report  }
+{  in boot protocol (HIDReadReport) gives true key up and down instead.     }
+{                                                                           }
+{  Movement keys are w s a d q e or the arrows, upper case or shift runs.   }
+{  Every other key goes in a queue for Input_GetChar.                       }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define KEY_FORWARD			0x01				// w or up arrow
+#define KEY_BACK			0x02				// s or down arrow
+#define KEY_TURN_LEFT		0x04				// a or left arrow
+#define KEY_TURN_RIGHT		0x08				// d or right arrow
+#define KEY_STRAFE_LEFT		0x10				// q
+#define KEY_STRAFE_RIGHT	0x20				// e
+#define KEY_RUN				0x40				// Upper case or shift
+#define INPUT_KEYS			7					// Number of key bits above
+
+#define INPUT_HOLD_STEPS	8					// Steps a terminal key stays held, covers its auto repeat
+#define INPUT_QUEUE			32					// Characters queued for Input_GetChar, a power of 2
+
+/*-[Input_Init]-------------------------------------------------------------}
+. Starts the mini uart at baudrate for a terminal and clears all key state.
+. The USB keyboard path needs no set up here.
+. RETURN: True for success, False if the uart could not be set up
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool Input_Init (uint32_t baudrate);
+
+/*-[Input_PollUart]---------------------------------------------------------}
+. Empties the uart receive fifo, holding each movement key until step is
+. INPUT_HOLD_STEPS further on. Made to be called from the timer irq with
+. the step count the irq has reached.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Input_PollUart (uint32_t step);
+
+/*-[Input_HidReport]--------------------------------------------------------}
+. Takes an 8 byte USB boot protocol keyboard report, the keys in it are
+. held until a report without them. Keys not in the last report are queued.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void Input_HidReport (const uint8_t report[8]);
+
+/*-[Input_Held]-------------------------------------------------------------}
+. The KEY_ bits held during the given step.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t Input_Held (uint32_t step);
+
+/*-[Input_GetChar]----------------------------------------------------------}
+. Takes the next key from the queue, movement keys are never queued.
+. RETURN: The character, -1 if the queue is empty
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+int Input_GetChar (void);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,435 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <math.h>								// Needed for fabsf, sqrtf, floorf
+#include "rpi-smartstart.h"						// Needed for _In_ and _Out_
+#include "rpi-Scalar.h"							// Needed for SCALAR and the SC_ macros
+#include "rpi-PolyMap.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-PolyMap.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The cells of the grid are held like a compressed sparse row table, the   }
+{  segments touching cell i are CellSeg[CellStart[i]] up to but not         }
+{  including CellSeg[CellStart[i+1]]. A wall lying along a cell edge goes   }
+{  in the cells both sides so no ray can slip past it.                      }
+{                                                                           }
+{  The ray walk is the usual grid DDA (Amanatides and Woo). A wall found in }
+{  a cell may be met past the far side of that cell, so the walk only stops }
+{  when the nearest hit so far is before the point the ray leaves the cell. }
+{                                                                           }
+{  LineIntersect2D works in integers, so the brute force check scales the   }
+{  map by a fixed factor chosen at build so no product overflows 32 bits.   }
+{                                                                           }
+{  The walk and the wall tests are in SCALAR (rpi-Scalar.h) so they run in  }
+{  float, double or fixed point. A wall test only divides once it knows the }
+{  ray meets the wall, a fixed point divide being a table lookup and more.  }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define PM_EPS			1.0e-4f					// Slack on cell edges when binning walls
+#define PM_MIN_T		SC_TINY					// Nearest a hit may be along a ray
+#define PM_FIXED_RANGE	8192					// Brute force map size in LineIntersect2D units
+
+/***************************************************************************}
+{					      PRIVATE INTERNAL MEMORY DATA				        }
+****************************************************************************/
+
+/* A wall, first vertex (x,y) running (ex,ey) to the second */
+typedef struct PmSegment {
+	SCALAR x;									// First vertex x
+	SCALAR y;									// First vertex y
+	SCALAR ex;									// Second vertex x - first
+	SCALAR ey;									// Second vertex y - first
+	SCALAR len;									// Length in map units
+	uint32_t texture;							// Label index of the contour
+	int32_t ix1, iy1, ix2, iy2;					// Vertices in brute force units
+} PM_SEGMENT;
+
+static PM_SEGMENT Segment[PM_MAX_SEGMENTS];
+static uint32_t CellStart[PM_MAX_GRID * PM_MAX_GRID + 1];
+static uint16_t CellSeg[PM_MAX_REFS];
+
+static struct {
+	uint32_t segCount;							// Segments in the map
+	VERTEX_TYPE xmin, ymin, xmax, ymax;			// Map bounds
+	SCALAR x0;									// Grid left edge
+	SCALAR y0;									// Grid top edge
+	SCALAR cell;								// Cell size in map units
+	SCALAR invCell;								// 1/cell
+	int gw;										// Cells across
+	int gh;										// Cells down
+	float fixed;								// Map units to brute force units
+	float extent;								// Largest side of the map
+} pm = { 0 };
+
+/*-LineIntersect2D----------------------------------------------------------}
+{																			}
+{ REF: http://paulbourke.net/geometry/pointlineplane/						}
+{																			}
+{ Given two line segments (x1,y1)-(x2,y2) &  (x3,y3)-(x4,y4) we calculate   }
+{ the intersection point of the two lines. If line segment only flag set    }
+{ the intersection must be within the line segments, otherwise interesction }
+{ assumes each line is extended to infinite length and returns intersection }
+{																			}
+{ The pointers to results intersect Ipx, Ipy, can be NULL if that result    }
+{ is not required.															}
+{																			}
+{ RETURN FALSE:																}
+{	If the two lines are parallel.											}
+{	If the two lines are coincident (one and the same line).				}
+{	Line segment flag set and intersection point is outside the segments	}
+{																			}
+{ RETURN TRUE:																}
+{	Ipx, Ipy will be the intersection point returned						}
+{																			}
+{ 8aug2017 LdB																}
+---------------------------------------------------------------------------*/
+bool LineIntersect2D (_In_ int32_t x1, _In_ int32_t y1,				// First line segement first coord
+					  _In_ int32_t x2, _In_ int32_t y2,				// First line segement second coord
+					  _In_ int32_t x3, _In_	int32_t y3,				// Second line segment first coord
+					  _In_ int32_t x4, _In_ int32_t y4, 			// Second line segment second cord
+					  _Out_ int32_t* Ipx, _Out_ int32_t* Ipy,		// Interection point return
+					  bool LineSegmentOnly) 						// Line segment intersect only flag
+{
+	int_fast32_t UaNum, Denom, Xa, Xb, Xc, Ya, Yb, Yc;
+	SCALAR Ua;
+
+	Xa = x4 - x3;													// Line 2 dx
+	Xc = x2 - x1;													// Line 1 dx
+	Yb = y4 - y3;													// Line 2 dy
+	Yc = y2 - y1;													// Line 2 dy
+	Denom = (Yb*Xc) - (Xa*Yc);										// Denominator of two equations
+	if (Denom == 0) return (false);									// The two lines are parallel and/or coincident
+	Xb = x1 - x3;													// Dx between first x coord of each line
+	Ya = y1 - y3;													// Dy between first y corrd of each line
+	UaNum = (Xa*Ya) - (Yb*Xb);										// Ua numerator
+	Ua = SC_RATIO(UaNum, Denom);									// Calculate Ua
+	if (LineSegmentOnly) {											// Want intersect point of line segments
+		int_fast32_t  UbNum;
+		SCALAR Ub;
+		if (Ua < SC_ZERO || Ua > SC_ONE) return (false);			// Line intersection outside line segement 1
+		UbNum = (Xc*Ya) - (Yc*Xb);									// Ub numerator
+		Ub = SC_RATIO(UbNum, Denom);								// Calculate Ub
+		if (Ub < SC_ZERO || Ub > SC_ONE) return (false);			// Line intersection outside line segement 2
+	}
+	if (Ipx) (*Ipx) = x1 + SC_MUL_TO_INT(Ua, Xc);					// Calculate and return intersect x point
+	if (Ipy) (*Ipy) = y1 + SC_MUL_TO_INT(Ua, Yc);					// Calculate and return intersect y point
+	return (true);													// return true for success
+}
+
+/*--------------------------------------------------------------------------}
+{	 Add the walls of a contour, its peers and everything inside them		}
+{--------------------------------------------------------------------------*/
+static bool AddContours (const CONTOUR2D* c)
+{
+	for (; c; c = c->nextpeer) {
+		const VERTEX2D* v = c->firstvertex;
+		for (uint32_t i = 0; v && (i < PM_MAX_SEGMENTS); i++) {		// Count guards a broken list
+			const VERTEX2D* n = v->next;
+			if (!n) break;
+			if (!(v->v_flags & VF_LIFTCLOSE) && ((n->x != v->x) || (n->y != v->y))) {
+				if (pm.segCount >= PM_MAX_SEGMENTS) return false;
+				if (pm.segCount == 0) {
+					pm.xmin = pm.xmax = v->x;
+					pm.ymin = pm.ymax = v->y;
+				}
+				if (v->x < pm.xmin) pm.xmin = v->x;
+				if (v->x > pm.xmax) pm.xmax = v->x;
+				if (v->y < pm.ymin) pm.ymin = v->y;
+				if (v->y > pm.ymax) pm.ymax = v->y;
+				if (n->x < pm.xmin) pm.xmin = n->x;
+				if (n->x > pm.xmax) pm.xmax = n->x;
+				if (n->y < pm.ymin) pm.ymin = n->y;
+				if (n->y > pm.ymax) pm.ymax = n->y;
+				PM_SEGMENT* s = &Segment[pm.segCount++];
+				s->x = SC_FROM_INT(v->x);
+				s->y = SC_FROM_INT(v->y);
+				s->ex = SC_FROM_INT(n->x - v->x);
+				s->ey = SC_FROM_INT(n->y - v->y);
+				SCALAR hx = s->ex / 2, hy = s->ey / 2;				// Halves keep fixed point squares in range
+				s->len = SC_SQRT(SC_MUL(hx, hx) + SC_MUL(hy, hy)) * 2;
+				s->texture = c->index;
+			}
+			v = n;
+			if (v == c->firstvertex) break;							// Back round to the start
+		}
+		if (c->inside_contours && !AddContours(c->inside_contours)) return false;
+	}
+	return true;
+}
+
+/*--------------------------------------------------------------------------}
+{	 Put segment n in every grid cell it touches, or just count them when	}
+{	 fill is false. Cells checked are those of the segment's bounding box	}
+{	 that the wall's line actually crosses. Only done at build so float.	}
+{--------------------------------------------------------------------------*/
+static void BinSegment (uint32_t n, bool fill)
+{
+	const PM_SEGMENT* s = &Segment[n];
+	float x = SC_TO_FLOAT(s->x), y = SC_TO_FLOAT(s->y);
+	float ex = SC_TO_FLOAT(s->ex), ey = SC_TO_FLOAT(s->ey);
+	float x0 = SC_TO_FLOAT(pm.x0), y0 = SC_TO_FLOAT(pm.y0);
+	float cell = SC_TO_FLOAT(pm.cell), invCell = 1.0f / cell;
+	float xa = fminf(x, x + ex) - PM_EPS, xb = fmaxf(x, x + ex) + PM_EPS;
+	float ya = fminf(y, y + ey) - PM_EPS, yb = fmaxf(y, y + ey) + PM_EPS;
+	int cx0 = (int)floorf((xa - x0) * invCell), cx1 = (int)floorf((xb - x0) * invCell);
+	int cy0 = (int)floorf((ya - y0) * invCell), cy1 = (int)floorf((yb - y0) * invCell);
+	if (cx0 < 0) cx0 = 0;
+	if (cy0 < 0) cy0 = 0;
+	if (cx1 >= pm.gw) cx1 = pm.gw - 1;
+	if (cy1 >= pm.gh) cy1 = pm.gh - 1;
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			float bx0 = x0 + cx * cell - PM_EPS - x, bx1 = bx0 + cell + 2 * PM_EPS;
+			float by0 = y0 + cy * cell - PM_EPS - y, by1 = by0 + cell + 2 * PM_EPS;
+			float c0 = bx0 * ey - by0 * ex;							// Which side of the line each corner is
+			float c1 = bx1 * ey - by0 * ex;
+			float c2 = bx0 * ey - by1 * ex;
+			float c3 = bx1 * ey - by1 * ex;
+			if ((c0 > 0 && c1 > 0 && c2 > 0 && c3 > 0) || (c0 < 0 && c1 < 0 && c2 < 0 && c3 < 0))
+				continue;											// Line misses the cell
+			uint32_t i = cy * pm.gw + cx;
+			if (fill) CellSeg[CellStart[i]++] = n;
+				else CellStart[i + 1]++;
+		}
+	}
+}
+
+/*-[PolyMap_Build]----------------------------------------------------------}
+. Makes the map from the contour list, every peer and every contour inside
+. them. Each edge vertex to next vertex is a wall, except from a vertex
+. flagged VF_LIFTCLOSE, and bezier points are taken as plain corners. The
+. grid cells are cellSize map units square, 0 picks a size giving about 2
+. segments a cell. Any map built before is replaced. A Q16.16 build
+. (SCALAR_TYPE 2) takes maps at most SC_MAX_MAP (120) units a side and
+. returns 0 for a larger one, float and double have no practical limit.
+. RETURN: Segments in the map, 0 for no walls, too many or too large
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t PolyMap_Build (const CONTOUR2D* contours, float cellSize)
+{
+	pm.segCount = 0;
+	if (!AddContours(contours) || (pm.segCount == 0) ||
+		(pm.xmax - pm.xmin > SC_MAX_MAP) || (pm.ymax - pm.ymin > SC_MAX_MAP)) {
+		pm.segCount = 0;
+		return 0;
+	}
+	float w = fmaxf((float)(pm.xmax - pm.xmin), 1.0f);
+	float h = fmaxf((float)(pm.ymax - pm.ymin), 1.0f);
+	pm.extent = fmaxf(w, h);
+
+	/* Grid size, never more than PM_MAX_GRID cells a side */
+	if (cellSize <= 0.0f) cellSize = sqrtf(w * h * 2.0f / pm.segCount);
+	cellSize = fmaxf(cellSize, pm.extent / (PM_MAX_GRID - 1));
+	pm.cell = SC_FROM_FLOAT(cellSize);
+	pm.invCell = SC_RECIP(pm.cell);
+	pm.x0 = SC_FROM_INT(pm.xmin);
+	pm.y0 = SC_FROM_INT(pm.ymin);
+	pm.gw = (int)(w / SC_TO_FLOAT(pm.cell)) + 1;
+	pm.gh = (int)(h / SC_TO_FLOAT(pm.cell)) + 1;
+	uint32_t cells = pm.gw * pm.gh;
+
+	/* Count each cell's segments, running total gives the starts */
+	for (uint32_t i = 0; i <= cells; i++) CellStart[i] = 0;
+	for (uint32_t n = 0; n < pm.segCount; n++) BinSegment(n, false);
+	for (uint32_t i = 0; i < cells; i++) CellStart[i + 1] += CellStart[i];
+	if (CellStart[cells] > PM_MAX_REFS) {
+		pm.segCount = 0;
+		return 0;
+	}
+
+	/* Fill moving each start up to its end, then shift them back */
+	for (uint32_t n = 0; n < pm.segCount; n++) BinSegment(n, true);
+	for (uint32_t i = cells; i > 0; i--) CellStart[i] = CellStart[i - 1];
+	CellStart[0] = 0;
+
+	/* Brute force units, origin at the map corner */
+	pm.fixed = floorf(PM_FIXED_RANGE / pm.extent);
+	if (pm.fixed < 1.0f) pm.fixed = 1.0f;
+	int32_t f = (int32_t)pm.fixed;
+	for (uint32_t n = 0; n < pm.segCount; n++) {
+		PM_SEGMENT* s = &Segment[n];
+		s->ix1 = (SC_TO_INT(s->x) - pm.xmin) * f;
+		s->iy1 = (SC_TO_INT(s->y) - pm.ymin) * f;
+		s->ix2 = (SC_TO_INT(s->x + s->ex) - pm.xmin) * f;
+		s->iy2 = (SC_TO_INT(s->y + s->ey) - pm.ymin) * f;
+	}
+	return pm.segCount;
+}
+
+/*--------------------------------------------------------------------------}
+{	 Test the ray against segment n, keeping it if nearer than *best. The	}
+{	 signs are checked first so only a wall the ray meets costs a divide	}
+{--------------------------------------------------------------------------*/
+static inline void TestSegment (uint32_t n, SCALAR ox, SCALAR oy, SCALAR dx, SCALAR dy, SCALAR* best, uint32_t* bestSeg, SCALAR* bestU)
+{
+	const PM_SEGMENT* s = &Segment[n];
+	SCALAR denom = SC_MUL(dx, s->ey) - SC_MUL(dy, s->ex);			// Cross of ray and wall
+	if (denom == SC_ZERO) return;									// Parallel
+	SCALAR wx = s->x - ox;
+	SCALAR wy = s->y - oy;
+	SCALAR tn = SC_MUL(wx, s->ey) - SC_MUL(wy, s->ex);				// t * denom, along the ray
+	SCALAR un = SC_MUL(wx, dy) - SC_MUL(wy, dx);					// u * denom, along the wall
+	if (denom < SC_ZERO) {
+		denom = -denom;
+		tn = -tn;
+		un = -un;
+	}
+	if ((tn <= SC_ZERO) || (un < SC_ZERO) || (un > denom)) return;	// Behind the ray or off the wall
+	SCALAR t = SC_DIV(tn, denom);
+	if ((t > PM_MIN_T) && (t < *best)) {
+		*best = t;
+		*bestSeg = n;
+		*bestU = SC_DIV(un, denom);
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{					  Fill in a hit from the wall found						}
+{--------------------------------------------------------------------------*/
+static void SetHit (POLYMAP_HIT* hit, float t, uint32_t n, float u)
+{
+	const PM_SEGMENT* s = &Segment[n];
+	hit->dist = t;
+	hit->along = u * SC_TO_FLOAT(s->len);
+	hit->segment = n;
+	hit->texture = s->texture;
+	hit->xWall = (SC_ABS(s->ex) > SC_ABS(s->ey));
+}
+
+/*-[PolyMap_CastRay]--------------------------------------------------------}
+. Finds the nearest wall along the ray (ox,oy) + t*(dx,dy), t > 0, walking
+. the grid cells the ray passes through. Safe to call from every core at
+. once as it only reads the map.
+. RETURN: True with hit filled in, False if the ray leaves the map
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool PolyMap_CastRay (float fox, float foy, float fdx, float fdy, POLYMAP_HIT* hit)
+{
+	if ((pm.segCount == 0) || (!hit)) return false;
+	SCALAR ox = SC_FROM_FLOAT(fox), oy = SC_FROM_FLOAT(foy);
+	SCALAR dx = SC_FROM_FLOAT(fdx), dy = SC_FROM_FLOAT(fdy);
+
+	/* Clip the ray to the grid box, it may start outside */
+	SCALAR gx1 = pm.x0 + pm.cell * pm.gw, gy1 = pm.y0 + pm.cell * pm.gh;
+	SCALAR tIn = SC_ZERO, tOut = SC_HUGE;
+	if (dx != SC_ZERO) {
+		SCALAR ta = SC_DIV(pm.x0 - ox, dx), tb = SC_DIV(gx1 - ox, dx);
+		if (ta > tb) {
+			SCALAR t = ta;
+			ta = tb;
+			tb = t;
+		}
+		if (ta > tIn) tIn = ta;
+		if (tb < tOut) tOut = tb;
+	} else if ((ox < pm.x0) || (ox >= gx1)) return false;
+	if (dy != SC_ZERO) {
+		SCALAR ta = SC_DIV(pm.y0 - oy, dy), tb = SC_DIV(gy1 - oy, dy);
+		if (ta > tb) {
+			SCALAR t = ta;
+			ta = tb;
+			tb = t;
+		}
+		if (ta > tIn) tIn = ta;
+		if (tb < tOut) tOut = tb;
+	} else if ((oy < pm.y0) || (oy >= gy1)) return false;
+	if (tIn >= tOut) return false;
+
+	/* Start cell and the DDA steps */
+	int cx = SC_TO_INT(SC_MUL(ox + SC_MUL(tIn, dx) - pm.x0, pm.invCell));
+	int cy = SC_TO_INT(SC_MUL(oy + SC_MUL(tIn, dy) - pm.y0, pm.invCell));
+	if (cx < 0) cx = 0;
+	if (cx >= pm.gw) cx = pm.gw - 1;
+	if (cy < 0) cy = 0;
+	if (cy >= pm.gh) cy = pm.gh - 1;
+	int stepX = (dx < SC_ZERO) ? -1 : 1;
+	int stepY = (dy < SC_ZERO) ? -1 : 1;
+	SCALAR tMaxX = SC_HUGE, tMaxY = SC_HUGE, tDeltaX = SC_HUGE, tDeltaY = SC_HUGE;
+	if (dx != SC_ZERO) {
+		tMaxX = SC_DIV(pm.x0 + pm.cell * (cx + (dx > SC_ZERO)) - ox, dx);	// Where the ray leaves the cell in x
+		tDeltaX = SC_DIV(pm.cell, SC_ABS(dx));
+	}
+	if (dy != SC_ZERO) {
+		tMaxY = SC_DIV(pm.y0 + pm.cell * (cy + (dy > SC_ZERO)) - oy, dy);
+		tDeltaY = SC_DIV(pm.cell, SC_ABS(dy));
+	}
+
+	SCALAR best = SC_HUGE, bestU = SC_ZERO;
+	uint32_t bestSeg = 0;
+	while (1) {
+		uint32_t i = cy * pm.gw + cx;
+		for (uint32_t k = CellStart[i]; k < CellStart[i + 1]; k++)
+			TestSegment(CellSeg[k], ox, oy, dx, dy, &best, &bestSeg, &bestU);
+		if (tMaxX < tMaxY) {
+			if (best <= tMaxX) break;								// Nearest wall is inside this cell
+			cx += stepX;
+			if ((cx < 0) || (cx >= pm.gw)) break;
+			tMaxX += tDeltaX;
+		} else {
+			if (best <= tMaxY) break;
+			cy += stepY;
+			if ((cy < 0) || (cy >= pm.gh)) break;
+			tMaxY += tDeltaY;
+		}
+	}
+	if (best == SC_HUGE) return false;
+	SetHit(hit, SC_TO_FLOAT(best), bestSeg, SC_TO_FLOAT(bestU));
+	return true;
+}
+
+/*-[PolyMap_CastRayBrute]---------------------------------------------------}
+. The same answer as PolyMap_CastRay found the slow way, LineIntersect2D of
+. the ray against every segment in the map. Kept to check and time the grid.
+. RETURN: True with hit filled in, False if the ray leaves the map
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool PolyMap_CastRayBrute (float ox, float oy, float dx, float dy, POLYMAP_HIT* hit)
+{
+	if ((pm.segCount == 0) || (!hit)) return false;
+	float dd = dx * dx + dy * dy;
+	if (dd == 0.0f) return false;
+
+	/* The ray as a segment long enough to cross the whole map */
+	float tFar = 2.0f * pm.extent / sqrtf(dd);
+	int32_t x1 = (int32_t)((ox - pm.xmin) * pm.fixed);
+	int32_t y1 = (int32_t)((oy - pm.ymin) * pm.fixed);
+	int32_t x2 = (int32_t)((ox + tFar * dx - pm.xmin) * pm.fixed);
+	int32_t y2 = (int32_t)((oy + tFar * dy - pm.ymin) * pm.fixed);
+	float rx = (float)(x2 - x1), ry = (float)(y2 - y1);
+	float rr = rx * rx + ry * ry;
+
+	float best = INFINITY, bestU = 0.0f;
+	uint32_t bestSeg = 0;
+	for (uint32_t n = 0; n < pm.segCount; n++) {
+		const PM_SEGMENT* s = &Segment[n];
+		int32_t ix, iy;
+		if (!LineIntersect2D(x1, y1, x2, y2, s->ix1, s->iy1, s->ix2, s->iy2, &ix, &iy, true))
+			continue;
+		float t = ((ix - x1) * rx + (iy - y1) * ry) / rr * tFar;	// Back to ray lengths
+		if ((t > SC_TO_FLOAT(PM_MIN_T)) && (t < best)) {
+			float wx = (float)(s->ix2 - s->ix1), wy = (float)(s->iy2 - s->iy1);
+			best = t;
+			bestSeg = n;
+			bestU = ((ix - s->ix1) * wx + (iy - s->iy1) * wy) / (wx * wx + wy * wy);
+		}
+	}
+	if (best == INFINITY) return false;
+	SetHit(hit, best, bestSeg, bestU);
+	return true;
+}
@@ -0,0 +1,173 @@
+#ifndef _RPI_POLYMAP_
+#define _RPI_POLYMAP_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-PolyMap.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  A map made of polygon walls. The CONTOUR2D/VERTEX2D linked lists are     }
+{  walked once and every edge becomes a wall segment in a flat array. The   }
+{  map area is cut in a uniform grid of cells and each cell holds a run of  }
+{  the segment numbers that touch it, so a ray only tests the segments of   }
+{  the cells it passes through, nearest cell first.                         }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define PM_MAX_SEGMENTS		16384				// Most wall segments in a map
+#define PM_MAX_GRID			256					// Most cells across or down the grid
+#define PM_MAX_REFS			131072				// Most segment entries over all cells
+
+/*-VERTEX_TYPE--------------------------------------------------------------}
+{  Units your vertex points are in typically int32_t, uint64_t or doubles.  }
+{--------------------------------------------------------------------------*/
+typedef int_fast32_t VERTEX_TYPE;									// For our example we are 32 bit ints
+
+/*-VERTEX FLAGS-------------------------------------------------------------}
+{ These are flags for our vertex points above so our shape is made of lines }
+{ and bezier linked up (IE exactly what Win32 GetGlyphOutline returns).		}
+{--------------------------------------------------------------------------*/
+#define VF_NORMAL 			0x00
+
+#define VF_DIRECTIONS		0x07									// Lower 3 bits = direction flags (0-7)
+#define VF_LIFTCLOSE 		0x08									// Open contour .. close vertexes in air
+
+#define VF_BEZONGRID 		0x10									// Bezier on grid point
+#define VF_QUADBEZOFFGRID 	0x20									// Quad bezier off grid point
+#define VF_CUBICBEZOFFGRID 	0x40									// Cubic bezier off grid point
+
+#define VF_BEZOFFGRID 		0x60									// Any bezier off grid point
+#define VF_BEZIER 			0x70									// Any bezier on or off grid point
+
+#define VF_JOINEDCONTOUR 	0x80									// Contour joins to next
+
+/*-CONTOUR DIRECTION--------------------------------------------------------}
+{                        Contour direction enumeration						}
+{--------------------------------------------------------------------------*/
+enum CONTOUR_DIR {
+	CW_DIR = 0,														// Clockwise contour direction
+	CCW_DIR = 1,													// Counter clockwise contour direction
+	UNKNOWN_DIR = 2													// Unknown contour direction
+};
+
+/*---------------------------------------------------------------------------}
+{                        VERTEX2D RECORD DEFINITION                          }
+{---------------------------------------------------------------------------*/
+typedef struct Vertex2D {
+	uint_fast32_t v_flags;											// Vertex flags
+	VERTEX_TYPE x;													// Vertex x co-ord
+	VERTEX_TYPE y;													// Vertex y co-ord
+	struct Vertex2D* next;											// Next vertex
+	struct Vertex2D* prev;											// Prev vertex
+} VERTEX2D, *PVERTEX2D;
+
+
+/*--------------------------------------------------------------------------}
+{                       CONTOUR2D RECORD DEFINITION							}
+{--------------------------------------------------------------------------*/
+typedef struct Contour2D {
+	enum CONTOUR_DIR dir;											// Direction of contour
+	uint32_t index;													// Label index of contour
+	VERTEX_TYPE xmin;												// Contour min x value
+	VERTEX_TYPE ymin;												// Contour min y value
+	VERTEX_TYPE xmax;												// Contour max x value
+	VERTEX_TYPE ymax;												// Contour max y value
+	PVERTEX2D firstvertex;											// First vertex on this contour
+	struct Contour2D* inside_contours;								// Inside paired contours
+	struct Contour2D* nextpeer;										// Next peer contour
+	struct Contour2D* prevpeer;										// Prev peer contour
+} CONTOUR2D, *PCONTOUR2D;
+
+/* Where a ray met a wall */
+typedef struct PolyMapHit {
+	float dist;									// Ray lengths to the wall (view distance for a camera ray)
+	float along;								// Map units along the wall from its first vertex
+	uint32_t segment;							// Segment number hit
+	uint32_t texture;							// Label index of the contour the wall came from
+	bool xWall;									// Wall runs more along x than y
+} POLYMAP_HIT;
+
+/*-LineIntersect2D----------------------------------------------------------}
+{																			}
+{ REF: http://paulbourke.net/geometry/pointlineplane/						}
+{																			}
+{ Given two line segments (x1,y1)-(x2,y2) &  (x3,y3)-(x4,y4) we calculate   }
+{ the intersection point of the two lines. If line segment only flag set    }
+{ the intersection must be within the line segments, otherwise interesction }
+{ assumes each line is extended to infinite length and returns intersection }
+{																			}
+{ The pointers to results intersect Ipx, Ipy, can be NULL if that result    }
+{ is not required.															}
+{																			}
+{ RETURN FALSE:																}
+{	If the two lines are parallel.											}
+{	If the two lines are coincident (one and the same line).				}
+{	Line segment flag set and intersection point is outside the segments	}
+{																			}
+{ RETURN TRUE:																}
+{	Ipx, Ipy will be the intersection point returned						}
+{																			}
+{ 8aug2017 LdB																}
+---------------------------------------------------------------------------*/
+bool LineIntersect2D (int32_t x1, int32_t y1,						// First line segement first coord
+					  int32_t x2, int32_t y2,						// First line segement second coord
+					  int32_t x3, int32_t y3,						// Second line segment first coord
+					  int32_t x4, int32_t y4, 						// Second line segment second cord
+					  int32_t* Ipx, int32_t* Ipy,					// Interection point return
+					  bool LineSegmentOnly); 						// Line segment intersect only flag
+
+/*-[PolyMap_Build]----------------------------------------------------------}
+. Makes the map from the contour list, every peer and every contour inside
+. them. Each edge vertex to next vertex is a wall, except from a vertex
+. flagged VF_LIFTCLOSE, and bezier points are taken as plain corners. The
+. grid cells are cellSize map units square, 0 picks a size giving about 2
+. segments a cell. Any map built before is replaced. A Q16.16 build
+. (SCALAR_TYPE 2) takes maps at most SC_MAX_MAP (120) units a side and
+. returns 0 for a larger one, float and double have no practical limit.
+. RETURN: Segments in the map, 0 for no walls, too many or too large
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t PolyMap_Build (const CONTOUR2D* contours, float cellSize);
+
+/*-[PolyMap_CastRay]--------------------------------------------------------}
+. Finds the nearest wall along the ray (ox,oy) + t*(dx,dy), t > 0, walking
+. the grid cells the ray passes through. Safe to call from every core at
+. once as it only reads the map.
+. RETURN: True with hit filled in, False if the ray leaves the map
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool PolyMap_CastRay (float ox, float oy, float dx, float dy, POLYMAP_HIT* hit);
+
+/*-[PolyMap_CastRayBrute]---------------------------------------------------}
+. The same answer as PolyMap_CastRay found the slow way, LineIntersect2D of
+. the ray against every segment in the map. Kept to check and time the grid.
+. RETURN: True with hit filled in, False if the ray leaves the map
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool PolyMap_CastRayBrute (float ox, float oy, float dx, float dy, POLYMAP_HIT* hit);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,642 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <math.h>								// Needed for fabsf
+#include "rpi-smartstart.h"						// Needed for CoreExecute, RPi_CoresReady
+#include "mmu.h"								// Needed for MMU_setup_pagetable, MMU_enable
+#include "rpi-PolyMap.h"						// Needed for PolyMap_CastRay
+#include "rpi-Scalar.h"							// Needed for SCALAR and the SC_ macros
+#include "rpi-RayCast.h"						// This units header
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>							// Needed for the 4 ray kernel
+#define RC_NEON 1
+#if SCALAR_TYPE == SCALAR_FLOAT
+#define RC_NEON_RAYS 1							// The 4 ray kernel is float only
+#endif
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-RayCast.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The DDA uses deltaDist = |1/rayDir| rather than the sqrt form, only the  }
+{  ratio of the two matters, and then sideDist - deltaDist on the side hit  }
+{  is straight away the distance along the view direction (no fisheye).    }
+{  The 4 ray kernel steps all 4 rays together with masks, a ray that has   }
+{  hit stops moving and the loop ends when all 4 have hit.                 }
+{                                                                           }
+{  Column x of the back buffer is the height pixels at BackBuffer[x*height] }
+{  so drawing a column is sequential stores, the flush turns 4x4 blocks    }
+{  round into framebuffer rows. Texel (u,v) of a texture is at u*64+v so   }
+{  the wall and sprite columns read sequential texels as well.             }
+{                                                                           }
+{  Floor row y (below the centre) is a distance h/(2y+1-h) away along the  }
+{  view direction, so the floor point under that pixel is pos + that       }
+{  distance * rayDir. The ceiling is the same point mirrored about the     }
+{  centre row. The row distances are worked out once at init.              }
+{                                                                           }
+{  A polygon map wall is cast one ray at a time through the PolyMap grid,  }
+{  its texture repeats every map unit along the wall and walls running     }
+{  more along x than y are shaded as the grid's y sides are.               }
+{                                                                           }
+{  Core 0 projects and sorts the sprites before the bands start, then      }
+{  every core draws the sprite columns in its band over the walls where    }
+{  the sprite is nearer than that column's wall (ColDist is the Z buffer). }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define RC_TINY		1.0e-20f					// Smallest |rayDir| the 4 ray kernel uses
+
+#define RC_NEAR		0.1f						// Sprites nearer than this are not drawn
+#define RC_FAR		1000.0f						// Distance given a ray that leaves a polygon map
+
+/***************************************************************************}
+{					      PRIVATE INTERNAL MEMORY DATA				        }
+****************************************************************************/
+static uint32_t __attribute__((aligned(64))) BackBuffer[RC_MAX_WIDTH * RC_MAX_HEIGHT];
+static float ColDist[RC_MAX_WIDTH];				// Distance to the wall along the view direction
+static uint8_t ColSide[RC_MAX_WIDTH];			// 1 the wall hit was a y side (NS)
+static uint8_t ColCell[RC_MAX_WIDTH];			// Map value of the wall hit
+static uint8_t ColTexX[RC_MAX_WIDTH];			// Texture column of the wall hit
+static float RowDist[RC_MAX_HEIGHT];			// Floor distance of each row below the centre
+static uint32_t __attribute__((aligned(64))) Texture[RC_TEXTURES][RC_TEX_SIZE * RC_TEX_SIZE];
+
+/* A sprite as it lands on the screen this frame */
+typedef struct SpriteView {
+	float depth;								// Distance along the view direction
+	int startX;									// Left screen column (may be off screen)
+	int startY;									// Top screen row (may be off screen)
+	int size;									// Width and height on screen
+	uint32_t texture;							// Atlas texture
+} SPRITE_VIEW;
+static SPRITE_VIEW SpriteView[RC_MAX_SPRITES];
+
+static struct {
+	uint32_t* fb;								// Framebuffer
+	int width;									// Screen width
+	int height;									// Screen height
+	const int* map;								// Map cells, map[x * mapHeight + y]
+	int mapWidth;								// Map width in cells
+	int mapHeight;								// Map height in cells
+	uint32_t cores;								// Cores rendering
+	int band;									// Columns each core renders, a multiple of 4
+	RAYCAST_CAMERA cam;							// Camera of the frame being rendered
+	volatile uint32_t frame;					// Frame number being rendered
+	volatile uint32_t done[RC_MAX_CORES];		// Last frame each core finished
+	volatile uint32_t coresWithMMU;				// Secondary cores that have the MMU on
+	bool mmu;									// MMU table made and enabled
+	const RAYCAST_SPRITE* sprites;				// Sprites set by RayCast_SetSprites
+	uint32_t spriteCount;						// Sprites in that array
+	uint32_t viewCount;							// Sprites in SpriteView this frame
+	bool texturesMade;							// Start up textures are in the atlas
+	bool polyMap;								// Walls come from the PolyMap not the grid
+} rc = { 0 };
+
+/*--------------------------------------------------------------------------}
+{						   CORE NUMBER OF THE CALLER						}
+{--------------------------------------------------------------------------*/
+static uint32_t CoreNumber (void)
+{
+#if __aarch64__ == 1
+	uint64_t mpidr;
+	__asm volatile ("mrs %0, mpidr_el1" : "=r" (mpidr));
+#else
+	uint32_t mpidr;
+	__asm volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+#endif
+	return (uint32_t)(mpidr & 3);
+}
+
+/*--------------------------------------------------------------------------}
+{   Cast one ray, the scalar form of the 4 ray kernel for leftover columns  }
+{   and every column when built for double or fixed point					}
+{--------------------------------------------------------------------------*/
+static void CastRay (int x, float cameraX)
+{
+	const RAYCAST_CAMERA* c = &rc.cam;
+	SCALAR camX = SC_FROM_FLOAT(cameraX);
+	SCALAR posX = SC_FROM_FLOAT(c->posX);
+	SCALAR posY = SC_FROM_FLOAT(c->posY);
+	SCALAR rayDirX = SC_FROM_FLOAT(c->dirX) + SC_MUL(SC_FROM_FLOAT(c->planeX), camX);
+	SCALAR rayDirY = SC_FROM_FLOAT(c->dirY) + SC_MUL(SC_FROM_FLOAT(c->planeY), camX);
+	int mapX = SC_TO_INT(posX);
+	int mapY = SC_TO_INT(posY);
+	SCALAR absX = SC_ABS(rayDirX);
+	SCALAR absY = SC_ABS(rayDirY);
+	SCALAR deltaDistX = SC_RECIP((absX > SC_TINY) ? absX : SC_TINY);
+	SCALAR deltaDistY = SC_RECIP((absY > SC_TINY) ? absY : SC_TINY);
+	SCALAR sideDistX, sideDistY;
+	int stepX, stepY, side, cell;
+	if (rayDirX < SC_ZERO) {
+		stepX = -1;
+		sideDistX = SC_MUL(posX - SC_FROM_INT(mapX), deltaDistX);
+	} else {
+		stepX = 1;
+		sideDistX = SC_MUL(SC_FROM_INT(mapX + 1) - posX, deltaDistX);
+	}
+	if (rayDirY < SC_ZERO) {
+		stepY = -1;
+		sideDistY = SC_MUL(posY - SC_FROM_INT(mapY), deltaDistY);
+	} else {
+		stepY = 1;
+		sideDistY = SC_MUL(SC_FROM_INT(mapY + 1) - posY, deltaDistY);
+	}
+	do {
+		if (sideDistX < sideDistY) {
+			sideDistX += deltaDistX;
+			mapX += stepX;
+			side = 0;
+		} else {
+			sideDistY += deltaDistY;
+			mapY += stepY;
+			side = 1;
+		}
+		cell = rc.map[mapX * rc.mapHeight + mapY];
+	} while (cell == 0);
+	SCALAR dist = side ? sideDistY - deltaDistY : sideDistX - deltaDistX;
+	SCALAR wallX = side ? posX + SC_MUL(dist, rayDirX) : posY + SC_MUL(dist, rayDirY);
+	int texX = SC_TO_INT(SC_FRAC(wallX) * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+	if ((side == 0 && rayDirX > SC_ZERO) || (side == 1 && rayDirY < SC_ZERO))
+		texX = RC_TEX_SIZE - 1 - texX;								// Texture reads left to right from either face
+	ColDist[x] = SC_TO_FLOAT(dist);
+	ColSide[x] = side;
+	ColCell[x] = cell;
+	ColTexX[x] = texX;
+}
+
+/*--------------------------------------------------------------------------}
+{			  Cast one ray of column x through the polygon map				}
+{--------------------------------------------------------------------------*/
+static void CastRayPoly (int x, float cameraX)
+{
+	const RAYCAST_CAMERA* c = &rc.cam;
+	float rayDirX = c->dirX + c->planeX * cameraX;
+	float rayDirY = c->dirY + c->planeY * cameraX;
+	POLYMAP_HIT hit;
+	if (!PolyMap_CastRay(c->posX, c->posY, rayDirX, rayDirY, &hit)) {
+		hit.dist = RC_FAR;											// Nothing there, a speck on the horizon
+		hit.along = 0.0f;
+		hit.texture = 0;
+		hit.xWall = false;
+	}
+	ColDist[x] = hit.dist;											// Ray lengths are already view distance
+	ColSide[x] = hit.xWall;
+	ColCell[x] = (hit.texture % RC_WALL_TEXTURES) + 1;
+	ColTexX[x] = (int)(hit.along * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+}
+
+#ifdef RC_NEON_RAYS
+/*--------------------------------------------------------------------------}
+{		  1/v to near float precision, estimate plus 2 newton steps			}
+{--------------------------------------------------------------------------*/
+static inline float32x4_t Recip4 (float32x4_t v)
+{
+	float32x4_t r = vrecpeq_f32(v);
+	r = vmulq_f32(r, vrecpsq_f32(v, r));
+	return vmulq_f32(r, vrecpsq_f32(v, r));
+}
+
+/*--------------------------------------------------------------------------}
+{					  True if any lane of the mask is set					}
+{--------------------------------------------------------------------------*/
+static inline bool AnyLane (uint32x4_t m)
+{
+	uint32x2_t t = vorr_u32(vget_low_u32(m), vget_high_u32(m));
+	return (vget_lane_u32(vpmax_u32(t, t), 0) != 0);
+}
+
+/*--------------------------------------------------------------------------}
+{	 Cast the 4 rays of columns x to x+3, cameraX is the first one's and	}
+{	 cameraStep the change between columns									}
+{--------------------------------------------------------------------------*/
+static void CastRays4 (int x, float cameraX, float cameraStep)
+{
+	static const float lane[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+	const RAYCAST_CAMERA* c = &rc.cam;
+	float32x4_t camX = vmlaq_n_f32(vdupq_n_f32(cameraX), vld1q_f32(lane), cameraStep);
+	float32x4_t rayDirX = vmlaq_n_f32(vdupq_n_f32(c->dirX), camX, c->planeX);
+	float32x4_t rayDirY = vmlaq_n_f32(vdupq_n_f32(c->dirY), camX, c->planeY);
+	float32x4_t deltaDistX = Recip4(vmaxq_f32(vabsq_f32(rayDirX), vdupq_n_f32(RC_TINY)));
+	float32x4_t deltaDistY = Recip4(vmaxq_f32(vabsq_f32(rayDirY), vdupq_n_f32(RC_TINY)));
+	int mx = (int)c->posX;
+	int my = (int)c->posY;
+	float fx = c->posX - mx;										// How far into the start square
+	float fy = c->posY - my;
+	uint32x4_t negX = vcltq_f32(rayDirX, vdupq_n_f32(0.0f));
+	uint32x4_t negY = vcltq_f32(rayDirY, vdupq_n_f32(0.0f));
+	int32x4_t stepX = vbslq_s32(negX, vdupq_n_s32(-1), vdupq_n_s32(1));
+	int32x4_t stepY = vbslq_s32(negY, vdupq_n_s32(-1), vdupq_n_s32(1));
+	float32x4_t sideDistX = vmulq_f32(vbslq_f32(negX, vdupq_n_f32(fx), vdupq_n_f32(1.0f - fx)), deltaDistX);
+	float32x4_t sideDistY = vmulq_f32(vbslq_f32(negY, vdupq_n_f32(fy), vdupq_n_f32(1.0f - fy)), deltaDistY);
+	int32x4_t mapX = vdupq_n_s32(mx);
+	int32x4_t mapY = vdupq_n_s32(my);
+	uint32x4_t side = vdupq_n_u32(0);								// All ones on a y side
+	uint32x4_t active = vdupq_n_u32(~0u);							// Rays still moving
+	int32x4_t cell;
+	do {
+		uint32x4_t xs = vcltq_f32(sideDistX, sideDistY);			// Rays stepping in x
+		uint32x4_t mx4 = vandq_u32(active, xs);
+		uint32x4_t my4 = vbicq_u32(active, xs);
+		sideDistX = vaddq_f32(sideDistX, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(deltaDistX), mx4)));
+		sideDistY = vaddq_f32(sideDistY, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(deltaDistY), my4)));
+		mapX = vaddq_s32(mapX, vandq_s32(stepX, vreinterpretq_s32_u32(mx4)));
+		mapY = vaddq_s32(mapY, vandq_s32(stepY, vreinterpretq_s32_u32(my4)));
+		side = vbslq_u32(active, vmvnq_u32(xs), side);
+		int32x4_t idx = vmlaq_n_s32(mapY, mapX, rc.mapHeight);	// No gather so 4 loads
+		cell = vdupq_n_s32(rc.map[vgetq_lane_s32(idx, 0)]);
+		cell = vsetq_lane_s32(rc.map[vgetq_lane_s32(idx, 1)], cell, 1);
+		cell = vsetq_lane_s32(rc.map[vgetq_lane_s32(idx, 2)], cell, 2);
+		cell = vsetq_lane_s32(rc.map[vgetq_lane_s32(idx, 3)], cell, 3);
+		active = vceqq_s32(cell, vdupq_n_s32(0));
+	} while (AnyLane(active));
+	float32x4_t dist = vbslq_f32(side, vsubq_f32(sideDistY, deltaDistY), vsubq_f32(sideDistX, deltaDistX));
+	float32x4_t wallX = vbslq_f32(side, vmlaq_f32(vdupq_n_f32(c->posX), dist, rayDirX),
+		vmlaq_f32(vdupq_n_f32(c->posY), dist, rayDirY));
+	wallX = vsubq_f32(wallX, vcvtq_f32_s32(vcvtq_s32_f32(wallX)));	// Fraction along the wall
+	int32x4_t texX = vandq_s32(vcvtq_s32_f32(vmulq_n_f32(wallX, RC_TEX_SIZE)), vdupq_n_s32(RC_TEX_SIZE - 1));
+	uint32x4_t flip = vbslq_u32(side, negY, vcgtq_f32(rayDirX, vdupq_n_f32(0.0f)));
+	texX = vbslq_s32(flip, vsubq_s32(vdupq_n_s32(RC_TEX_SIZE - 1), texX), texX);
+	vst1q_f32(&ColDist[x], dist);
+	ColSide[x] = vgetq_lane_u32(side, 0) & 1;
+	ColSide[x + 1] = vgetq_lane_u32(side, 1) & 1;
+	ColSide[x + 2] = vgetq_lane_u32(side, 2) & 1;
+	ColSide[x + 3] = vgetq_lane_u32(side, 3) & 1;
+	ColCell[x] = vgetq_lane_s32(cell, 0);
+	ColCell[x + 1] = vgetq_lane_s32(cell, 1);
+	ColCell[x + 2] = vgetq_lane_s32(cell, 2);
+	ColCell[x + 3] = vgetq_lane_s32(cell, 3);
+	ColTexX[x] = vgetq_lane_s32(texX, 0);
+	ColTexX[x + 1] = vgetq_lane_s32(texX, 1);
+	ColTexX[x + 2] = vgetq_lane_s32(texX, 2);
+	ColTexX[x + 3] = vgetq_lane_s32(texX, 3);
+}
+#endif
+
+/*--------------------------------------------------------------------------}
+{	 Floor and ceiling of column x, floor rows yStart to the bottom and	}
+{	 the ceiling rows mirroring them from the top							}
+{--------------------------------------------------------------------------*/
+static void DrawFloor (uint32_t* col, int x, int yStart)
+{
+	const RAYCAST_CAMERA* c = &rc.cam;
+	int h = rc.height;
+	float cameraX = x * (2.0f / rc.width) - 1.0f;
+	float rayDirX = c->dirX + c->planeX * cameraX;
+	float rayDirY = c->dirY + c->planeY * cameraX;
+	const uint32_t* floorTex = Texture[RC_TEX_FLOOR];
+	const uint32_t* ceilTex = Texture[RC_TEX_CEILING];
+	int y = yStart;
+#ifdef RC_NEON
+	for (; (y & 3) && (y < h); y++) {								// Up to a 4 row boundary
+		float d = RowDist[y];
+		uint32_t u = (int)((c->posX + d * rayDirX) * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+		uint32_t v = (int)((c->posY + d * rayDirY) * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+		col[y] = floorTex[(u << RC_TEX_SHIFT) | v];
+		col[h - 1 - y] = ceilTex[(u << RC_TEX_SHIFT) | v];
+	}
+	float32x4_t px = vdupq_n_f32(c->posX * RC_TEX_SIZE);			// All in texels
+	float32x4_t py = vdupq_n_f32(c->posY * RC_TEX_SIZE);
+	int32x4_t mask = vdupq_n_s32(RC_TEX_SIZE - 1);
+	for (; y + 4 <= h; y += 4) {
+		float32x4_t d = vld1q_f32(&RowDist[y]);
+		int32x4_t u = vandq_s32(vcvtq_s32_f32(vmlaq_n_f32(px, d, rayDirX * RC_TEX_SIZE)), mask);
+		int32x4_t v = vandq_s32(vcvtq_s32_f32(vmlaq_n_f32(py, d, rayDirY * RC_TEX_SIZE)), mask);
+		int32x4_t idx = vorrq_s32(vshlq_n_s32(u, RC_TEX_SHIFT), v);
+		int i0 = vgetq_lane_s32(idx, 0), i1 = vgetq_lane_s32(idx, 1);
+		int i2 = vgetq_lane_s32(idx, 2), i3 = vgetq_lane_s32(idx, 3);
+		uint32x4_t f = vdupq_n_u32(floorTex[i0]);
+		f = vsetq_lane_u32(floorTex[i1], f, 1);
+		f = vsetq_lane_u32(floorTex[i2], f, 2);
+		f = vsetq_lane_u32(floorTex[i3], f, 3);
+		uint32x4_t t = vdupq_n_u32(ceilTex[i3]);					// Ceiling runs upward so reversed
+		t = vsetq_lane_u32(ceilTex[i2], t, 1);
+		t = vsetq_lane_u32(ceilTex[i1], t, 2);
+		t = vsetq_lane_u32(ceilTex[i0], t, 3);
+		vst1q_u32(col + y, f);
+		vst1q_u32(col + h - 4 - y, t);
+	}
+#endif
+	for (; y < h; y++) {
+		float d = RowDist[y];
+		uint32_t u = (int)((c->posX + d * rayDirX) * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+		uint32_t v = (int)((c->posY + d * rayDirY) * RC_TEX_SIZE) & (RC_TEX_SIZE - 1);
+		col[y] = floorTex[(u << RC_TEX_SHIFT) | v];
+		col[h - 1 - y] = ceilTex[(u << RC_TEX_SHIFT) | v];
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{		  Draw column x into the back buffer from its ray result			}
+{--------------------------------------------------------------------------*/
+static void DrawColumn (int x)
+{
+	int h = rc.height;
+	uint32_t* col = &BackBuffer[x * h];
+	float lineHeight = (float)h / ColDist[x];						// Wall height on screen
+	int drawStart = 0;
+	if (lineHeight < (float)h) drawStart = (int)((h - lineHeight) * 0.5f);
+	int drawEnd = h - drawStart;									// Floor mirrors the ceiling exactly
+	const uint32_t* tex = &Texture[(ColCell[x] - 1) % RC_WALL_TEXTURES][ColTexX[x] << RC_TEX_SHIFT];
+	uint32_t step = (uint32_t)((RC_TEX_SIZE * 65536.0f) / lineHeight);	// 16.16 texels a pixel
+	float texStart = (drawStart - (h - lineHeight) * 0.5f) * (RC_TEX_SIZE * 65536.0f) / lineHeight;
+	uint32_t texPos = (texStart > 0.0f) ? (uint32_t)texStart : 0;	// Texel of the first row drawn
+	if (ColSide[x]) {												// y sides half bright
+		for (int y = drawStart; y < drawEnd; y++) {
+			uint32_t t = tex[(texPos >> 16) & (RC_TEX_SIZE - 1)];
+			col[y] = (t & 0xFF000000) | ((t >> 1) & 0x007F7F7F);
+			texPos += step;
+		}
+	} else {
+		for (int y = drawStart; y < drawEnd; y++) {
+			col[y] = tex[(texPos >> 16) & (RC_TEX_SIZE - 1)];
+			texPos += step;
+		}
+	}
+	DrawFloor(col, x, drawEnd);
+}
+
+/*--------------------------------------------------------------------------}
+{	 Project the sprites for this frame's camera and sort them far to near	}
+{--------------------------------------------------------------------------*/
+static void ProjectSprites (void)
+{
+	const RAYCAST_CAMERA* c = &rc.cam;
+	float invDet = 1.0f / (c->planeX * c->dirY - c->dirX * c->planeY);
+	uint32_t n = 0;
+	for (uint32_t i = 0; i < rc.spriteCount; i++) {
+		float sx = rc.sprites[i].x - c->posX;
+		float sy = rc.sprites[i].y - c->posY;
+		float depth = invDet * (c->planeX * sy - c->planeY * sx);	// Along the view direction
+		if ((depth < RC_NEAR) || (rc.sprites[i].texture >= RC_TEXTURES)) continue;
+		float across = invDet * (c->dirY * sx - c->dirX * sy);		// Along the camera plane
+		SPRITE_VIEW v;
+		v.depth = depth;
+		v.size = (int)(rc.height / depth);
+		v.startX = (int)((rc.width / 2) * (1.0f + across / depth)) - v.size / 2;
+		v.startY = (rc.height - v.size) / 2;
+		v.texture = rc.sprites[i].texture;
+		if ((v.size <= 0) || (v.startX >= rc.width) || (v.startX + v.size <= 0)) continue;
+		uint32_t j = n++;
+		for (; (j > 0) && (SpriteView[j - 1].depth < depth); j--)	// Insertion sort far to near
+			SpriteView[j] = SpriteView[j - 1];
+		SpriteView[j] = v;
+	}
+	rc.viewCount = n;
+}
+
+/*--------------------------------------------------------------------------}
+{		   Draw the sprite columns x0 to x1 into the back buffer			}
+{--------------------------------------------------------------------------*/
+static void DrawSprites (int x0, int x1)
+{
+	int h = rc.height;
+	for (uint32_t i = 0; i < rc.viewCount; i++) {
+		const SPRITE_VIEW* v = &SpriteView[i];
+		int sx0 = (v->startX > x0) ? v->startX : x0;
+		int sx1 = (v->startX + v->size < x1) ? v->startX + v->size : x1;
+		int y0 = (v->startY > 0) ? v->startY : 0;
+		int y1 = (v->startY + v->size < h) ? v->startY + v->size : h;
+		uint32_t step = (RC_TEX_SIZE << 16) / v->size;				// 16.16 texels a pixel
+		for (int x = sx0; x < sx1; x++) {
+			if (v->depth >= ColDist[x]) continue;					// Wall in front
+			const uint32_t* tex = &Texture[v->texture][((x - v->startX) * RC_TEX_SIZE / v->size) << RC_TEX_SHIFT];
+			uint32_t* col = &BackBuffer[x * h];
+			uint32_t texPos = (y0 - v->startY) * step;
+			for (int y = y0; y < y1; y++) {
+				uint32_t t = tex[(texPos >> 16) & (RC_TEX_SIZE - 1)];
+				if (t & 0xFF000000) col[y] = t;						// Alpha 0 is see through
+				texPos += step;
+			}
+		}
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{	  Copy columns x0 to x1 of back buffer rows y0 to y1 to the screen		}
+{--------------------------------------------------------------------------*/
+static void FlushRect (int x0, int x1, int y0, int y1)
+{
+	for (int y = y0; y < y1; y++) {
+		uint32_t* dst = rc.fb + y * rc.width;
+		const uint32_t* src = &BackBuffer[y];
+		for (int x = x0; x < x1; x++) dst[x] = src[x * rc.height];
+	}
+}
+
+/*--------------------------------------------------------------------------}
+{		Flush the band of columns x0 to x1 to the framebuffer rows			}
+{--------------------------------------------------------------------------*/
+static void FlushBand (int x0, int x1)
+{
+	int y = 0;
+#ifdef RC_NEON
+	int h = rc.height;
+	int pitch = rc.width;
+	int xEnd = x0 + ((x1 - x0) & ~3);
+	for (; y + 4 <= h; y += 4) {
+		uint32_t* dst = rc.fb + y * pitch;
+		for (int x = x0; x < xEnd; x += 4) {
+			const uint32_t* src = &BackBuffer[x * h + y];			// 4 rows of 4 columns
+			uint32x4x2_t t01 = vtrnq_u32(vld1q_u32(src), vld1q_u32(src + h));
+			uint32x4x2_t t23 = vtrnq_u32(vld1q_u32(src + 2 * h), vld1q_u32(src + 3 * h));
+			vst1q_u32(dst + x, vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+			vst1q_u32(dst + pitch + x, vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+			vst1q_u32(dst + 2 * pitch + x, vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+			vst1q_u32(dst + 3 * pitch + x, vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+		}
+	}
+	if (xEnd < x1) FlushRect(xEnd, x1, 0, y);						// Odd columns at the band end
+#endif
+	FlushRect(x0, x1, y, rc.height);								// Rows not done above
+}
+
+/*--------------------------------------------------------------------------}
+{	 Cast, draw and flush the band of columns this core is given			}
+{--------------------------------------------------------------------------*/
+static void RenderBand (uint32_t core)
+{
+	int x0 = core * rc.band;
+	int x1 = x0 + rc.band;
+	if (x1 > rc.width) x1 = rc.width;
+	if (x0 >= x1) return;
+	float cameraStep = 2.0f / rc.width;								// Camera x runs -1 to 1 across the screen
+	int x = x0;
+	if (rc.polyMap) {
+		for (; x < x1; x++) CastRayPoly(x, x * cameraStep - 1.0f);
+	} else {
+#ifdef RC_NEON_RAYS
+		for (; x + 4 <= x1; x += 4) CastRays4(x, x * cameraStep - 1.0f, cameraStep);
+#endif
+		for (; x < x1; x++) CastRay(x, x * cameraStep - 1.0f);
+	}
+	for (x = x0; x < x1; x++) DrawColumn(x);
+	DrawSprites(x0, x1);
+	FlushBand(x0, x1);
+}
+
+/*--------------------------------------------------------------------------}
+{	 Make the start up textures, patterns in place of loaded images. u is	}
+{	 across the texture, v down it and texel (u,v) is at u*64+v			}
+{--------------------------------------------------------------------------*/
+static void MakeTextures (void)
+{
+	const int half = RC_TEX_SIZE / 2;
+	for (int u = 0; u < RC_TEX_SIZE; u++) {
+		for (int v = 0; v < RC_TEX_SIZE; v++) {
+			uint32_t i = (u << RC_TEX_SHIFT) | v;
+			uint32_t xorc = (u * 256 / RC_TEX_SIZE) ^ (v * 256 / RC_TEX_SIZE);
+			uint32_t vc = v * 256 / RC_TEX_SIZE;
+			uint32_t uvc = v * 128 / RC_TEX_SIZE + u * 128 / RC_TEX_SIZE;
+			bool mortar = ((v & 15) == 0) || (((u + ((v & 16) ? 8 : 0)) & 15) == 0);
+			Texture[0][i] = 0xFF000000 | (((u != v) && (u != RC_TEX_SIZE - 1 - v)) ? 0xFE0000 : 0);	// Red with black cross
+			Texture[1][i] = 0xFF000000 | (uvc << 16) | (uvc << 8) | uvc;		// Sloped greyscale
+			Texture[2][i] = 0xFF000000 | (uvc << 16) | (uvc << 8);			// Sloped yellow
+			Texture[3][i] = 0xFF000000 | (xorc << 16) | (xorc << 8) | xorc;	// Xor greyscale
+			Texture[4][i] = 0xFF000000 | (xorc << 8);						// Xor green
+			Texture[5][i] = 0xFF000000 | (mortar ? 0x808080 : 0xA03020);		// Red bricks
+			Texture[6][i] = 0xFF000000 | (vc << 16);						// Red gradient
+			Texture[7][i] = 0xFF808080;										// Flat grey
+			Texture[RC_TEX_FLOOR][i] = (((u >> 3) ^ (v >> 3)) & 1) ? 0xFF505050 : 0xFF707070;
+			Texture[RC_TEX_CEILING][i] = 0xFF000000 | ((xorc >> 2) << 8) | (0x40 + (xorc >> 2));
+
+			/* Sprites, alpha 0 round the shape */
+			int du = u - half, dv = v - half;
+			int r2 = du * du + dv * dv;
+			Texture[RC_TEX_SPRITE][i] = (r2 < 28 * 28) ?				// Barrel, banded brown disc
+				(((v & 15) < 3) ? 0xFF404040 : 0xFF8B5A2B) : 0;
+			Texture[RC_TEX_SPRITE + 1][i] = ((du >= -6) && (du < 6)) ?	// Pillar, shaded stone column
+				(0xFF000000 | ((0x90 - du * du) * 0x010101)) : 0;
+			Texture[RC_TEX_SPRITE + 2][i] = (r2 < 10 * 10) ?			// Lamp, yellow glow
+				(0xFFFF0000 | ((0xFF - r2) << 8)) : ((du == 0) && (v < half)) ? 0xFF303030 : 0;
+		}
+	}
+	rc.texturesMade = true;
+}
+
+/*--------------------------------------------------------------------------}
+{		  Secondary core entries, called from the core spin loops			}
+{--------------------------------------------------------------------------*/
+static void CoreEnableMMU (void)
+{
+	MMU_enable();
+	rc.coresWithMMU++;
+}
+
+static void CoreRender (void)
+{
+	uint32_t core = CoreNumber();
+	RenderBand(core);
+	__sync_synchronize();											// Band written before we say so
+	rc.done[core] = rc.frame;
+}
+
+/*-[RayCast_Init]-----------------------------------------------------------}
+. Sets up to render a width x height screen into the 32 bit framebuffer at
+. frameBuffer (rows width pixels apart). The map is mapWidth x mapHeight
+. cells read as map[x * mapHeight + y], 0 is empty and the outside edge
+. must all be walls. On a Pi2/Pi3 this turns on the MMU and caches on every
+. core so the back buffer is cached ram.
+. RETURN: Cores that will render, 0 for a bad size
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t RayCast_Init (uint32_t* frameBuffer, int width, int height, const int* map, int mapWidth, int mapHeight)
+{
+	if ((!frameBuffer) || (!map) || (width <= 0) || (height <= 0) ||
+		(width > RC_MAX_WIDTH) || (height > RC_MAX_HEIGHT)) return 0;
+	rc.fb = frameBuffer;
+	rc.width = width;
+	rc.height = height;
+	rc.map = map;
+	rc.mapWidth = mapWidth;
+	rc.mapHeight = mapHeight;
+	rc.cores = RPi_CoresReady;
+	if (rc.cores < 1) rc.cores = 1;
+	if (rc.cores > RC_MAX_CORES) rc.cores = RC_MAX_CORES;
+	rc.band = ((width / rc.cores) + 3) & ~3;
+	for (int y = height / 2; y < height; y++)
+		RowDist[y] = (float)height / (float)(2 * y + 1 - height);	// Floor distance at the row centre
+	if (!rc.texturesMade) MakeTextures();							// Once, keeps any loaded textures
+
+	/* The ARM6 Pi1 has one core and no use for the table */
+	if ((RPi_CompileMode.CodeType >= ARM7_CODE) && (!rc.mmu) && MMU_setup_pagetable()) {
+		MMU_enable();												// Core 0
+		rc.mmu = true;
+		for (uint32_t core = 1; core < rc.cores; core++) {
+			CoreExecute(core, CoreEnableMMU);
+			while (rc.coresWithMMU != core) {};						// Wait for that core
+		}
+	}
+	return rc.cores;
+}
+
+/*-[RayCast_SetTexture]-----------------------------------------------------}
+. Loads RC_TEX_SIZE x RC_TEX_SIZE pixels (row major, as an image is held)
+. into texture index of the atlas, replacing the one made at start up.
+. RETURN: True for success, False for a bad index or pixels
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool RayCast_SetTexture (uint32_t index, const uint32_t* pixels)
+{
+	if ((index >= RC_TEXTURES) || (!pixels)) return false;
+	if (!rc.texturesMade) MakeTextures();							// So RayCast_Init won't overwrite it
+	for (int v = 0; v < RC_TEX_SIZE; v++)
+		for (int u = 0; u < RC_TEX_SIZE; u++)
+			Texture[index][(u << RC_TEX_SHIFT) | v] = pixels[v * RC_TEX_SIZE + u];	// Rows to columns
+	return true;
+}
+
+/*-[RayCast_SetSprites]-----------------------------------------------------}
+. Sets the sprites drawn by each render from now on, at most RC_MAX_SPRITES.
+. The array is read every frame so sprites can be moved between renders.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_SetSprites (const RAYCAST_SPRITE* sprites, uint32_t count)
+{
+	rc.sprites = sprites;
+	rc.spriteCount = (!sprites) ? 0 : (count > RC_MAX_SPRITES) ? RC_MAX_SPRITES : count;
+}
+
+/*-[RayCast_UsePolyMap]----------------------------------------------------}
+. Switches the walls between the grid map given to RayCast_Init and the
+. polygon map made by PolyMap_Build. A polygon wall uses wall texture
+. (contour index % RC_WALL_TEXTURES) repeated every map unit along it.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_UsePolyMap (bool use)
+{
+	rc.polyMap = use;
+}
+
+/*-[RayCast_Render]---------------------------------------------------------}
+. Renders a frame from the camera on all the cores and returns once every
+. band is flushed to the screen.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_Render (const RAYCAST_CAMERA* cam)
+{
+	if (!rc.fb || !cam) return;
+	rc.cam = *cam;
+	ProjectSprites();
+	rc.frame++;
+	__sync_synchronize();											// Frame set before the cores start
+	for (uint32_t core = 1; core < rc.cores; core++)
+		CoreExecute(core, CoreRender);
+	RenderBand(0);
+	for (uint32_t core = 1; core < rc.cores; core++)
+		while (rc.done[core] != rc.frame) {};						// Wait for each band
+	__sync_synchronize();
+}
@@ -0,0 +1,118 @@
+#ifndef _RPI_RAYCAST_
+#define _RPI_RAYCAST_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-RayCast.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Column renderer for the grid raycaster. The screen is split in bands     }
+{  of columns, one per core. Each core casts its rays 4 at a time in float  }
+{  (NEON when the compiler has it), draws the columns into a column major   }
+{  back buffer in cached ram and then flushes its band to the framebuffer.  }
+{                                                                           }
+{  Walls, floor and ceiling are textured and sprites are drawn over them    }
+{  far to near, hidden by walls nearer in that column. The textures are     }
+{  held column major too so a wall or sprite column reads one run of ram.   }
+{                                                                           }
+{  The walls can instead come from a polygon map (rpi-PolyMap.h), made of   }
+{  contours rather than grid squares.                                       }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define RC_MAX_WIDTH		1920				// Largest screen width
+#define RC_MAX_HEIGHT		1200				// Largest screen height
+#define RC_MAX_CORES		4					// Cores that can share the work
+#define RC_MAX_SPRITES		64					// Most sprites drawn
+
+#define RC_TEX_SHIFT		6					// Textures are 64 x 64
+#define RC_TEX_SIZE			(1 << RC_TEX_SHIFT)
+#define RC_TEXTURES			16					// Textures in the atlas
+#define RC_WALL_TEXTURES	8					// Map value n uses texture (n - 1) % 8
+#define RC_TEX_FLOOR		8					// Floor texture
+#define RC_TEX_CEILING		9					// Ceiling texture
+#define RC_TEX_SPRITE		10					// First sprite texture (barrel, pillar, lamp)
+
+/* The viewer, all in map squares */
+typedef struct RayCastCamera {
+	float posX;									// Position x
+	float posY;									// Position y
+	float dirX;									// Direction x
+	float dirY;									// Direction y
+	float planeX;								// Camera plane x (perpendicular to direction)
+	float planeY;								// Camera plane y
+} RAYCAST_CAMERA;
+
+/* A billboard, texels with alpha 0 are see through */
+typedef struct RayCastSprite {
+	float x;									// Centre x in map squares
+	float y;									// Centre y in map squares
+	uint32_t texture;							// Atlas texture
+} RAYCAST_SPRITE;
+
+/*-[RayCast_Init]-----------------------------------------------------------}
+. Sets up to render a width x height screen into the 32 bit framebuffer at
+. frameBuffer (rows width pixels apart). The map is mapWidth x mapHeight
+. cells read as map[x * mapHeight + y], 0 is empty and the outside edge
+. must all be walls. On a Pi2/Pi3 this turns on the MMU and caches on every
+. core so the back buffer is cached ram.
+. RETURN: Cores that will render, 0 for a bad size
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+uint32_t RayCast_Init (uint32_t* frameBuffer, int width, int height, const int* map, int mapWidth, int mapHeight);
+
+/*-[RayCast_SetTexture]-----------------------------------------------------}
+. Loads RC_TEX_SIZE x RC_TEX_SIZE pixels (row major, as an image is held)
+. into texture index of the atlas, replacing the one made at start up.
+. RETURN: True for success, False for a bad index or pixels
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+bool RayCast_SetTexture (uint32_t index, const uint32_t* pixels);
+
+/*-[RayCast_SetSprites]-----------------------------------------------------}
+. Sets the sprites drawn by each render from now on, at most RC_MAX_SPRITES.
+. The array is read every frame so sprites can be moved between renders.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_SetSprites (const RAYCAST_SPRITE* sprites, uint32_t count);
+
+/*-[RayCast_UsePolyMap]----------------------------------------------------}
+. Switches the walls between the grid map given to RayCast_Init and the
+. polygon map made by PolyMap_Build. A polygon wall uses wall texture
+. (contour index % RC_WALL_TEXTURES) repeated every map unit along it.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_UsePolyMap (bool use);
+
+/*-[RayCast_Render]---------------------------------------------------------}
+. Renders a frame from the camera on all the cores and returns once every
+. band is flushed to the screen.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+void RayCast_Render (const RAYCAST_CAMERA* cam);
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-Scalar.h"							// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Scalar.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The fixed point tables. Entry i of the 1/x table is 1/(1 + (i+0.5)/256)  }
+{  in 0.32, the middle of its range so the error either side is the same.   }
+{  Entry i of the square root table is sqrt((64+i)/256) in 1.31, the last   }
+{  entry (1.0) is only there to step towards.                               }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#if SCALAR_TYPE == SCALAR_FIXED
+const uint32_t Fix_RecipTable[256] = {
+	0xFF803FE0, 0xFE823CA5, 0xFD863086, 0xFC8C15B4, 0xFB93E672, 0xFA9D9D1F,
+	0xF9A9342C, 0xF8B6A622, 0xF7C5ED9C, 0xF6D7054D, 0xF5E9E7FC, 0xF4FE9082,
+	0xF414F9CD, 0xF32D1EDF, 0xF246FACB, 0xF16288B8, 0xF07FC3E0, 0xEF9EA78B,
+	0xEEBF2F18, 0xEDE155F3, 0xED05179C, 0xEC2A6FA0, 0xEB51599F, 0xEA79D149,
+	0xE9A3D25E, 0xE8CF58AA, 0xE7FC600E, 0xE72AE475, 0xE65AE1DB, 0xE58C5449,
+	0xE4BF37D8, 0xE3F388AE, 0xE32942FE, 0xE260630A, 0xE198E51F, 0xE0D2C599,
+	0xE00E00E0, 0xDF4A9368, 0xDE8879B2, 0xDDC7B04C, 0xDD0833CD, 0xDC4A00DC,
+	0xDB8D1427, 0xDAD16A6A, 0xDA17006D, 0xD95DD2FF, 0xD8A5DEFE, 0xD7EF2151,
+	0xD73996E8, 0xD6853CC0, 0xD5D20FDE, 0xD5200D52, 0xD46F3234, 0xD3BF7BA8,
+	0xD310E6DA, 0xD2637100, 0xD1B71758, 0xD10BD72B, 0xD061ADC9, 0xCFB8988B,
+	0xCF1094D3, 0xCE69A00C, 0xCDC3B7A9, 0xCD1ED923, 0xCC7B01FF, 0xCBD82FC6,
+	0xCB36600C, 0xCA95906B, 0xC9F5BE85, 0xC956E803, 0xC8B90A95, 0xC81C23F5,
+	0xC78031E0, 0xC6E5321C, 0xC64B2278, 0xC5B200C5, 0xC519CAE0, 0xC4827EA8,
+	0xC3EC1A05, 0xC3569AE5, 0xC2C1FF3D, 0xC22E4506, 0xC19B6A41, 0xC1096CF5,
+	0xC0784B2E, 0xBFE802FF, 0xBF58927F, 0xBEC9F7CD, 0xBE3C310B, 0xBDAF3C63,
+	0xBD231802, 0xBC97C21E, 0xBC0D38EE, 0xBB837AB0, 0xBAFA85A9, 0xBA725820,
+	0xB9EAF062, 0xB9644CC3, 0xB8DE6B99, 0xB8594B40, 0xB7D4EA19, 0xB7514688,
+	0xB6CE5EF9, 0xB64C31D8, 0xB5CABD9A, 0xB54A00B5, 0xB4C9F9A4, 0xB44AA6E9,
+	0xB3CC0705, 0xB34E1883, 0xB2D0D9EE, 0xB25449D6, 0xB1D866D1, 0xB15D2F75,
+	0xB0E2A260, 0xB068BE30, 0xAFEF818B, 0xAF76EB18, 0xAEFEF981, 0xAE87AB76,
+	0xAE10FFA8, 0xAD9AF4CF, 0xAD2589A3, 0xACB0BCE1, 0xAC3C8D49, 0xABC8F9A0,
+	0xAB5600AB, 0xAAE3A135, 0xAA71DA0C, 0xAA00AA00, 0xA9900FE5, 0xA9200A92,
+	0xA8B098E0, 0xA841B9AC, 0xA7D36BD7, 0xA765AE43, 0xA6F87FD6, 0xA68BDF78,
+	0xA61FCC16, 0xA5B4449C, 0xA54947FD, 0xA4DED52C, 0xA474EB1F, 0xA40B88CF,
+	0xA3A2AD39, 0xA33A575A, 0xA2D28633, 0xA26B38C8, 0xA2046E1F, 0xA19E253F,
+	0xA1385D34, 0xA0D3150B, 0xA06E4BD4, 0xA00A00A0, 0x9FA63283, 0x9F42E095,
+	0x9EE009EE, 0x9E7DADA8, 0x9E1BCAE2, 0x9DBA60BB, 0x9D596E54, 0x9CF8F2D1,
+	0x9C98ED57, 0x9C395D10, 0x9BDA4124, 0x9B7B98BF, 0x9B1D6311, 0x9ABF9F48,
+	0x9A624C96, 0x9A056A30, 0x99A8F74B, 0x994CF320, 0x98F15CE6, 0x989633DB,
+	0x983B773A, 0x97E12644, 0x97874038, 0x972DC45A, 0x96D4B1EE, 0x967C083A,
+	0x9623C686, 0x95CBEC1A, 0x95747843, 0x951D6A4D, 0x94C6C186, 0x94707D3E,
+	0x941A9CC8, 0x93C51F75, 0x9370049B, 0x931B4B90, 0x92C6F3AC, 0x9272FC48,
+	0x921F64BE, 0x91CC2C6C, 0x917952AE, 0x9126D6E4, 0x90D4B86E, 0x9082F6AF,
+	0x90319109, 0x8FE086E2, 0x8F8FD79F, 0x8F3F82A8, 0x8EEF8765, 0x8E9FE542,
+	0x8E509BA8, 0x8E01AA04, 0x8DB30FC6, 0x8D64CC5B, 0x8D16DF35, 0x8CC947C4,
+	0x8C7C057C, 0x8C2F17D2, 0x8BE27E39, 0x8B963829, 0x8B4A4519, 0x8AFEA483,
+	0x8AB355E0, 0x8A6858AA, 0x8A1DAC60, 0x89D3507C, 0x8989447F, 0x893F87E8,
+	0x88F61A37, 0x88ACFAED, 0x8864298E, 0x881BA59D, 0x87D36E9F, 0x878B841A,
+	0x8743E594, 0x86FC9296, 0x86B58AA7, 0x866ECD53, 0x86285A23, 0x85E230A3,
+	0x859C5060, 0x8556B8E7, 0x851169C7, 0x84CC628F, 0x8487A2D0, 0x84432A1B,
+	0x83FEF802, 0x83BB0C17, 0x837765F0, 0x83340520, 0x82F0E93D, 0x82AE11DD,
+	0x826B7E99, 0x82292F07, 0x81E722C2, 0x81A55962, 0x8163D282, 0x81228DBE,
+	0x80E18AB2, 0x80A0C8FB, 0x80604836, 0x80200802
+};
+
+const uint32_t Fix_SqrtTable[193] = {
+	0x40000000, 0x407F80FE, 0x40FE07D9, 0x417B9A3C, 0x41F83D9B, 0x4273F736,
+	0x42EECC1F, 0x4368C136, 0x43E1DB33, 0x445A1EA3, 0x44D18FE9, 0x45483345,
+	0x45BE0CD2, 0x46332087, 0x46A7723E, 0x471B05AD, 0x478DDE6E, 0x48000000,
+	0x48716DC3, 0x48E22B00, 0x49523AE4, 0x49C1A086, 0x4A305EE5, 0x4A9E78E9,
+	0x4B0BF165, 0x4B78CB1A, 0x4BE508B1, 0x4C50ACC3, 0x4CBBB9D6, 0x4D26325F,
+	0x4D9018C1, 0x4DF96F50, 0x4E623850, 0x4ECA75F6, 0x4F322A67, 0x4F9957BC,
+	0x50000000, 0x50662531, 0x50CBC93F, 0x5130EE10, 0x5195957C, 0x51F9C153,
+	0x525D7356, 0x52C0AD3E, 0x532370B9, 0x5385BF6B, 0x53E79AEF, 0x544904D6,
+	0x54A9FEA7, 0x550A89E3, 0x556AA801, 0x55CA5A6E, 0x5629A293, 0x568881CD,
+	0x56E6F975, 0x57450ADB, 0x57A2B749, 0x58000000, 0x585CE63D, 0x58B96B34,
+	0x59159016, 0x5971560A, 0x59CCBE34, 0x5A27C9B2, 0x5A82799A, 0x5ADCCEFF,
+	0x5B36CAEF, 0x5B906E70, 0x5BE9BA86, 0x5C42B02D, 0x5C9B5061, 0x5CF39C14,
+	0x5D4B9437, 0x5DA339B5, 0x5DFA8D76, 0x5E51905C, 0x5EA84346, 0x5EFEA710,
+	0x5F54BC91, 0x5FAA849C, 0x60000000, 0x60552F8A, 0x60AA1402, 0x60FEAE2D,
+	0x6152FECE, 0x61A706A1, 0x61FAC664, 0x624E3ECE, 0x62A17094, 0x62F45C68,
+	0x634702FA, 0x639964F6, 0x63EB8305, 0x643D5DD0, 0x648EF5F9, 0x64E04C22,
+	0x653160EB, 0x658234F1, 0x65D2C8CD, 0x66231D18, 0x66733266, 0x66C3094C,
+	0x6712A25A, 0x6761FE20, 0x67B11D29, 0x68000000, 0x684EA72E, 0x689D133A,
+	0x68EB44A8, 0x69393BFB, 0x6986F9B4, 0x69D47E51, 0x6A21CA50, 0x6A6EDE2C,
+	0x6ABBBA5E, 0x6B085F60, 0x6B54CDA6, 0x6BA105A5, 0x6BED07D1, 0x6C38D49A,
+	0x6C846C72, 0x6CCFCFC5, 0x6D1AFF01, 0x6D65FA92, 0x6DB0C2E1, 0x6DFB5856,
+	0x6E45BB5A, 0x6E8FEC52, 0x6ED9EBA1, 0x6F23B9AD, 0x6F6D56D5, 0x6FB6C37C,
+	0x70000000, 0x70490CC0, 0x7091EA18, 0x70DA9865, 0x71231800, 0x716B6945,
+	0x71B38C8A, 0x71FB8228, 0x72434A75, 0x728AE5C5, 0x72D2546D, 0x731996C1,
+	0x7360AD12, 0x73A797B1, 0x73EE56EE, 0x7434EB1A, 0x747B5482, 0x74C19373,
+	0x7507A83A, 0x754D9323, 0x75935478, 0x75D8EC83, 0x761E5B8D, 0x7663A1DF,
+	0x76A8BFBF, 0x76EDB574, 0x77328343, 0x77772972, 0x77BBA846, 0x78000000,
+	0x784430E4, 0x78883B34, 0x78CC1F31, 0x790FDD1C, 0x79537534, 0x7996E7B8,
+	0x79DA34E6, 0x7A1D5CFE, 0x7A60603A, 0x7AA33ED9, 0x7AE5F915, 0x7B288F2B,
+	0x7B6B0153, 0x7BAD4FC9, 0x7BEF7AC5, 0x7C318281, 0x7C736734, 0x7CB52916,
+	0x7CF6C85D, 0x7D384541, 0x7D799FF7, 0x7DBAD8B5, 0x7DFBEFAE, 0x7E3CE518,
+	0x7E7DB926, 0x7EBE6C0C, 0x7EFEFDFB, 0x7F3F6F26, 0x7F7FBFC0, 0x7FBFEFF8,
+	0x80000000
+};
+#endif
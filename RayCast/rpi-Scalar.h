@@ -0,0 +1,172 @@
+#ifndef _RPI_SCALAR_
+#define _RPI_SCALAR_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <math.h>								// Needed for sqrtf, sqrt, INFINITY
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: rpi-Scalar.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  The number type the ray code is written in, picked when compiling with   }
+{  -DSCALAR_TYPE=0 float (the default), 1 double or 2 Q16.16 fixed point.   }
+{  Add, subtract, negate and compare are the plain C operators for all of   }
+{  them, everything else goes through the SC_ macros below.                 }
+{                                                                           }
+{  Fixed point has no divide, the ARM1176 in a Pi1 has no divide at all.    }
+{  A divide is a 256 entry 1/x table lookup on the top bits of the divisor  }
+{  and one newton step, a square root is a 192 entry table with linear      }
+{  steps between entries. A divide result is held to +-SC_HUGE (8192) and a }
+{  multiply to the int32_t range so neither can wrap. Values must stay      }
+{  under 32768, so the products in a wall test keep maps to 120 units.      }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define SCALAR_FLOAT		0					// 32 bit float
+#define SCALAR_DOUBLE		1					// 64 bit double
+#define SCALAR_FIXED		2					// Q16.16 fixed point in an int32_t
+
+#ifndef SCALAR_TYPE
+#define SCALAR_TYPE			SCALAR_FLOAT		// Float unless the build says otherwise
+#endif
+
+#if SCALAR_TYPE == SCALAR_FIXED
+/***************************************************************************}
+{						   Q16.16 FIXED POINT BACKEND						}
+****************************************************************************/
+typedef int32_t SCALAR;
+
+#define SC_NAME				"Q16.16"
+#define SC_FRAC_BITS		16
+#define SC_ZERO				((SCALAR)0)
+#define SC_ONE				((SCALAR)(1 << SC_FRAC_BITS))
+#define SC_HUGE				((SCALAR)0x20000000)	// 8192.0, twice it still fits
+#define SC_TINY				((SCALAR)1)			// Smallest above zero
+#define SC_MAX_MAP			120					// Largest map side, wall cross products fit
+
+extern const uint32_t Fix_RecipTable[256];		// 1/m for m = 1 to 2 in 0.32
+extern const uint32_t Fix_SqrtTable[193];		// sqrt(m) for m = 0.25 to 1 in 1.31
+
+/*--------------------------------------------------------------------------}
+{	 num/den as Q16.16, num and den in the same units (ints or Q16.16)		}
+{--------------------------------------------------------------------------*/
+static inline SCALAR Fix_Div (int32_t num, int32_t den)
+{
+	if (den == 0) return (num < 0) ? -SC_HUGE : SC_HUGE;
+	uint32_t n = (num < 0) ? -(uint32_t)num : (uint32_t)num;
+	uint32_t d = (den < 0) ? -(uint32_t)den : (uint32_t)den;
+	int lz = __builtin_clz(d);
+	uint32_t m = d << lz;											// 1.31 with the top bit set
+	uint64_t r = Fix_RecipTable[(m >> 23) & 0xFF];					// 1/m good to 8 bits
+	uint64_t e = ((uint64_t)m * r) >> 32;							// m*r in 1.31, near 1
+	r = (r * ((2ull << 31) - e)) >> 31;								// Newton, good to 16 bits
+	uint64_t q = ((uint64_t)n * r) >> (47 - lz);
+	if (q > (uint64_t)SC_HUGE) q = SC_HUGE;
+	return ((num < 0) != (den < 0)) ? -(SCALAR)q : (SCALAR)q;
+}
+
+/*--------------------------------------------------------------------------}
+{				  a*b held to the int32_t range, never wraps				}
+{--------------------------------------------------------------------------*/
+static inline SCALAR Fix_Mul (SCALAR a, SCALAR b)
+{
+	int64_t p = ((int64_t)a * b) >> SC_FRAC_BITS;
+	if (p > INT32_MAX) return INT32_MAX;
+	if (p < -INT32_MAX) return -INT32_MAX;
+	return (SCALAR)p;
+}
+
+/*--------------------------------------------------------------------------}
+{			 a*i to an int, rounding toward zero as a C cast does			}
+{--------------------------------------------------------------------------*/
+static inline int32_t Fix_MulToInt (SCALAR a, int32_t i)
+{
+	int64_t p = (int64_t)a * i;
+	return (int32_t)((p < 0) ? -((-p) >> SC_FRAC_BITS) : (p >> SC_FRAC_BITS));
+}
+
+/*--------------------------------------------------------------------------}
+{						 Square root, 0 for x <= 0							}
+{--------------------------------------------------------------------------*/
+static inline SCALAR Fix_Sqrt (SCALAR x)
+{
+	if (x <= 0) return 0;
+	int sh = __builtin_clz((uint32_t)x) & ~1;						// Even shift keeps the root exact
+	uint32_t m = (uint32_t)x << sh;									// 0.25 to 1 in 0.32
+	uint32_t i = (m >> 24) - 64;
+	uint32_t f = (m >> 8) & 0xFFFF;									// Step between entries
+	uint32_t s = Fix_SqrtTable[i] + (uint32_t)(((uint64_t)(Fix_SqrtTable[i + 1] - Fix_SqrtTable[i]) * f) >> 16);
+	return (SCALAR)(s >> (7 + sh / 2));
+}
+
+#define SC_FROM_FLOAT(f)	((SCALAR)((f) * 65536.0f))
+#define SC_FROM_INT(i)		((SCALAR)((i) << SC_FRAC_BITS))
+#define SC_TO_FLOAT(s)		((float)(s) * (1.0f / 65536.0f))
+#define SC_TO_INT(s)		((int)((s) >> SC_FRAC_BITS))		// Floor
+#define SC_FRAC(s)			((s) & (SC_ONE - 1))
+#define SC_MUL(a, b)		Fix_Mul((a), (b))
+#define SC_MUL_TO_INT(a, i)	Fix_MulToInt((a), (i))
+#define SC_DIV(a, b)		Fix_Div((a), (b))
+#define SC_RECIP(a)			Fix_Div(SC_ONE, (a))
+#define SC_RATIO(n, d)		Fix_Div((n), (d))
+#define SC_SQRT(a)			Fix_Sqrt(a)
+#define SC_ABS(a)			(((a) < 0) ? -(a) : (a))
+
+#else
+/***************************************************************************}
+{						 FLOAT AND DOUBLE BACKENDS							}
+****************************************************************************/
+#if SCALAR_TYPE == SCALAR_DOUBLE
+typedef double SCALAR;
+#define SC_NAME				"double"
+#define SC_SQRT(a)			sqrt(a)
+#define SC_ABS(a)			fabs(a)
+#else
+typedef float SCALAR;
+#define SC_NAME				"float"
+#define SC_SQRT(a)			sqrtf(a)
+#define SC_ABS(a)			fabsf(a)
+#endif
+
+#define SC_ZERO				((SCALAR)0)
+#define SC_ONE				((SCALAR)1)
+#define SC_HUGE				((SCALAR)INFINITY)
+#define SC_TINY				((SCALAR)1.0e-20f)	// Small enough, 1/SC_TINY still finite
+#define SC_MAX_MAP			1000000				// No practical limit
+
+#define SC_FROM_FLOAT(f)	((SCALAR)(f))
+#define SC_FROM_INT(i)		((SCALAR)(i))
+#define SC_TO_FLOAT(s)		((float)(s))
+#define SC_TO_INT(s)		((int)(s))							// Positive values only, a cast truncates
+#define SC_FRAC(s)			((s) - (int)(s))
+#define SC_MUL(a, b)		((a) * (b))
+#define SC_MUL_TO_INT(a, i)	((int32_t)((a) * (i)))
+#define SC_DIV(a, b)		((a) / (b))
+#define SC_RECIP(a)			(SC_ONE / (a))
+#define SC_RATIO(n, d)		((SCALAR)(n) / (SCALAR)(d))
+#endif
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
@@ -148,7 +148,13 @@ typedef void (*CORECALLFUNC) (void);
 {	   	RPi-SmartStart API TO SET CORE EXECUTE ROUTINE AT ADDRESS 		    }
 {++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* Execute function on (1..CoresReady) */
-extern bool CoreExecute (uint8_t coreNum, CORECALLFUNC func); 
+extern bool CoreExecute (uint8_t coreNum, CORECALLFUNC func);
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{			MMU HELPER ROUTINES PROVIDE BY RPi-SmartStart API			    }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Turn the MMU and caches on for the calling core with the 1:1 table */
+extern void enable_mmu_tables (void* map1to1);
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
 {			MEMORY HELPER ROUTINES PROVIDE BY RPi-SmartStart API		    }
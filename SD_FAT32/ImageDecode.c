@@ -0,0 +1,738 @@
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include <string.h>								// Needed for memcpy, memset, memcmp
+#include "rpi-smartstart.h"						// Provides CvtBmpLine, HDC and RGBA
+#include "ImageDecode.h"						// This units header
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: ImageDecode.c												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************/
+
+#define IMG_CHUNK_SIZE	4096					// File read size, one cluster on most cards
+#define IMG_SEG_PIXELS	1024					// CvtBmpLine stages through a 4096 byte buffer so 1024 x 32 bit max
+
+#define QOI_OP_INDEX	0x00					// 00xxxxxx
+#define QOI_OP_DIFF		0x40					// 01xxxxxx
+#define QOI_OP_LUMA		0x80					// 10xxxxxx
+#define QOI_OP_RUN		0xC0					// 11xxxxxx
+#define QOI_OP_RGB		0xFE					// 11111110
+#define QOI_OP_RGBA		0xFF					// 11111111
+#define QOI_HASH(p)		((p.rgbRed * 3 + p.rgbGreen * 5 + p.rgbBlue * 7 + p.rgbAlpha * 11) & 63)
+
+#define PNG_WIN_SIZE	32768					// Deflate window size
+#define PNG_WIN_MASK	(PNG_WIN_SIZE - 1)		// Deflate window wrap mask
+#define PNG_WIN_FLUSH	16384					// Unflushed bytes before window is passed to scanlines
+#define HUFF_FAST_BITS	9						// Codes up to this length decode with one table lookup
+#define HUFF_FAST_SIZE	(1 << HUFF_FAST_BITS)
+
+/***************************************************************************}
+{					    PRIVATE INTERNAL STRUCTURES							}
+****************************************************************************/
+
+/*--------------------------------------------------------------------------}
+{			 BUFFERED FILE STREAM THE DECODERS PULL BYTES FROM				}
+{--------------------------------------------------------------------------*/
+typedef struct tagIMGSTREAM {
+	HANDLE		hFile;							// File handle
+	IMGREADFUNC	readFn;							// Read function for file handle
+	uint32_t	pos;							// Current read position in buffer
+	uint32_t	len;							// Valid bytes in buffer
+	bool		eof;							// Read function has run out of data
+	uint8_t __attribute__((aligned(4))) buf[IMG_CHUNK_SIZE];
+} IMGSTREAM;
+
+/*--------------------------------------------------------------------------}
+{		CANONICAL HUFFMAN TABLE WITH A FAST LOOKUP FOR SHORT CODES			}
+{--------------------------------------------------------------------------*/
+typedef struct tagHUFFTABLE {
+	uint16_t fast[HUFF_FAST_SIZE];				// (symbol << 4) | length indexed by next bits, 0 = long code
+	uint16_t count[16];							// Number of codes of each length
+	uint16_t symbol[288];						// Symbols in canonical order
+} HUFFTABLE;
+
+/*--------------------------------------------------------------------------}
+{					  PNG DECODE STATE FOR ONE IMAGE						}
+{--------------------------------------------------------------------------*/
+typedef struct tagPNGSTATE {
+	uint32_t	width;							// Image width
+	uint32_t	height;							// Image height
+	uint8_t		colourType;						// PNG colour type 0,2,3,4,6
+	uint8_t		bitDepth;						// Bits per sample 1,2,4,8,16
+	uint32_t	channels;						// Samples per pixel
+	uint32_t	bpp;							// Filter byte distance (bytes per pixel min 1)
+	uint32_t	stride;							// Bytes in a scanline excluding filter byte
+	uint32_t	idatLeft;						// Bytes left in current IDAT chunk
+	bool		idatDone;						// No further IDAT chunks
+	uint32_t	bitBuf;							// Deflate bit buffer
+	uint32_t	bitCnt;							// Valid bits in bit buffer
+	uint32_t	overrun;						// Bytes padded past end of IDAT data
+	uint32_t	winPos;							// Total bytes written to window
+	uint32_t	winFlushed;						// Total bytes passed on to scanlines
+	uint32_t	rowPos;							// Bytes gathered in current scanline
+	uint32_t	rowY;							// Current scanline
+	HDC			hdc;							// Device context drawing to
+	uint32_t	x;								// Screen x position
+	uint32_t	y;								// Screen y position
+} PNGSTATE;
+
+/***************************************************************************}
+{                         PRIVATE INTERNAL DATA                             }
+****************************************************************************/
+static IMGSTREAM img = { 0 };
+static RGBA __attribute__((aligned(4))) imgRow[IMG_MAX_WIDTH];
+
+static PNGSTATE png = { 0 };
+static HUFFTABLE litTable = { 0 };
+static HUFFTABLE distTable = { 0 };
+static RGBA pngPalette[256] = { 0 };
+static uint8_t pngWindow[PNG_WIN_SIZE];
+static uint8_t __attribute__((aligned(4))) pngRows[2][IMG_MAX_WIDTH * 8 + 1];
+
+static const uint8_t pngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+static const uint16_t lenBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lenExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t clOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+/***************************************************************************}
+{                       PRIVATE FILE STREAM ROUTINES                        }
+****************************************************************************/
+
+/*-[INTERNAL: StreamInit]---------------------------------------------------}
+. Attaches the stream buffer to the file handle and read function.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void StreamInit (HANDLE hFile, IMGREADFUNC readFn) {
+	img.hFile = hFile;
+	img.readFn = readFn;
+	img.pos = 0;
+	img.len = 0;
+	img.eof = (readFn == 0);
+}
+
+/*-[INTERNAL: StreamFill]---------------------------------------------------}
+. Reads the next chunk of the file into the stream buffer.
+. RETURN: true if any bytes were read, false at end of file or error
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool StreamFill (void) {
+	uint32_t bytesRead = 0;
+	img.pos = 0;
+	img.len = 0;
+	if (img.eof) return false;										// Already at end of file
+	if (!img.readFn(img.hFile, &img.buf[0], IMG_CHUNK_SIZE, &bytesRead, 0)
+		|| bytesRead == 0) {
+		img.eof = true;												// Nothing more to read
+		return false;
+	}
+	img.len = bytesRead;											// Bytes available
+	return true;
+}
+
+/*-[INTERNAL: StreamByte]---------------------------------------------------}
+. Fetches the next byte of the file, refilling the buffer as required.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static inline bool StreamByte (uint8_t* b) {
+	if (img.pos == img.len && !StreamFill()) return false;			// Buffer empty and no more data
+	*b = img.buf[img.pos++];										// Return next byte
+	return true;
+}
+
+/*-[INTERNAL: StreamRead]---------------------------------------------------}
+. Copies the next n bytes of the file to dst.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool StreamRead (void* dst, uint32_t n) {
+	uint8_t* d = (uint8_t*)dst;
+	while (n) {
+		if (img.pos == img.len && !StreamFill()) return false;		// Ran out of data
+		uint32_t take = img.len - img.pos;							// Bytes left in buffer
+		if (take > n) take = n;										// Only what is needed
+		memcpy(d, &img.buf[img.pos], take);							// Copy them
+		img.pos += take;
+		d += take;
+		n -= take;
+	}
+	return true;
+}
+
+/*-[INTERNAL: StreamSkip]---------------------------------------------------}
+. Discards the next n bytes of the file.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool StreamSkip (uint32_t n) {
+	while (n) {
+		if (img.pos == img.len && !StreamFill()) return false;		// Ran out of data
+		uint32_t take = img.len - img.pos;							// Bytes left in buffer
+		if (take > n) take = n;										// Only what is needed
+		img.pos += take;
+		n -= take;
+	}
+	return true;
+}
+
+/*-[INTERNAL: BigEndian32]--------------------------------------------------}
+. Both QOI and PNG store their header values big endian.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static uint32_t BigEndian32 (const uint8_t* p) {
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/*-[INTERNAL: EmitRow]------------------------------------------------------}
+. Passes the decoded 32 bit row to the DC through CvtBmpLine. The row goes
+. in segments as CvtBmpLine can only stage 1024 pixels at a time.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void EmitRow (HDC hdc, uint32_t x, uint32_t y, uint32_t cX) {
+	for (uint32_t i = 0; i < cX; i += IMG_SEG_PIXELS) {
+		uint32_t n = cX - i;										// Pixels left in row
+		if (n > IMG_SEG_PIXELS) n = IMG_SEG_PIXELS;					// Limit to one segment
+		CvtBmpLine(hdc, x + i, y, n, 32, (uint8_t*)&imgRow[i]);		// Draw the segment
+	}
+}
+
+/***************************************************************************}
+{                          PRIVATE QOI DECODER                              }
+****************************************************************************/
+
+/*-[INTERNAL: QoiDecode]----------------------------------------------------}
+. Decodes the QOI image from the attached stream a row at a time.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static BOOL QoiDecode (HDC hdc, uint32_t nXStart, uint32_t nYStart) {
+	uint8_t hdr[14];
+	RGBA index[64];
+	RGBA px;
+	uint32_t run = 0;
+	if (!StreamRead(&hdr[0], sizeof(hdr)) || memcmp(&hdr[0], "qoif", 4) != 0)
+		return FALSE;												// Not a QOI file
+	uint32_t w = BigEndian32(&hdr[4]);								// Image width
+	uint32_t h = BigEndian32(&hdr[8]);								// Image height
+	if (w == 0 || w > IMG_MAX_WIDTH || h == 0 || hdr[12] < 3 || hdr[12] > 4)
+		return FALSE;												// Invalid or too wide for buffers
+	memset(&index[0], 0, sizeof(index));							// Zero the colour index
+	px.ref = 0;														// Start pixel is black
+	px.rgbAlpha = 255;												// Fully opaque
+	for (uint32_t y = 0; y < h; y++) {
+		for (uint32_t x = 0; x < w; x++) {
+			if (run > 0) run--;										// Repeat of last pixel
+			else {
+				uint8_t b1, b2;
+				if (!StreamByte(&b1)) return FALSE;					// Truncated file
+				if (b1 >= QOI_OP_RGB) {
+					uint8_t c[4];
+					if (!StreamRead(&c[0], b1 - QOI_OP_RGB + 3)) return FALSE;
+					px.rgbRed = c[0];								// Full colour values follow
+					px.rgbGreen = c[1];
+					px.rgbBlue = c[2];
+					if (b1 == QOI_OP_RGBA) px.rgbAlpha = c[3];
+				} else {
+					switch (b1 & 0xC0) {
+						case QOI_OP_INDEX:
+							px = index[b1];							// Previously seen colour
+							break;
+						case QOI_OP_DIFF:
+							px.rgbRed += ((b1 >> 4) & 0x03) - 2;	// Small channel differences
+							px.rgbGreen += ((b1 >> 2) & 0x03) - 2;
+							px.rgbBlue += (b1 & 0x03) - 2;
+							break;
+						case QOI_OP_LUMA: {
+							if (!StreamByte(&b2)) return FALSE;
+							int vg = (b1 & 0x3F) - 32;				// Green difference
+							px.rgbRed += vg - 8 + ((b2 >> 4) & 0x0F);
+							px.rgbGreen += vg;
+							px.rgbBlue += vg - 8 + (b2 & 0x0F);
+							break;
+						}
+						case QOI_OP_RUN:
+							run = (b1 & 0x3F);						// This pixel plus run more
+							break;
+					}
+				}
+				index[QOI_HASH(px)] = px;							// Update colour index
+			}
+			imgRow[x] = px;											// Write pixel to row
+		}
+		EmitRow(hdc, nXStart, nYStart + y, w);						// Draw the row
+	}
+	return TRUE;
+}
+
+/***************************************************************************}
+{                        PRIVATE PNG INFLATE ROUTINES                       }
+****************************************************************************/
+
+/*-[INTERNAL: IdatByte]-----------------------------------------------------}
+. Fetches the next byte of compressed data, stepping over the CRC and header
+. between consecutive IDAT chunks.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool IdatByte (uint8_t* b) {
+	while (png.idatLeft == 0) {
+		uint8_t hdr[8];
+		if (png.idatDone) return false;								// No more compressed data
+		if (!StreamSkip(4) || !StreamRead(&hdr[0], 8)				// Skip CRC read next chunk header
+			|| memcmp(&hdr[4], "IDAT", 4) != 0) {
+			png.idatDone = true;									// Data run has ended
+			return false;
+		}
+		png.idatLeft = BigEndian32(&hdr[0]);						// Next IDAT chunk size
+	}
+	png.idatLeft--;
+	return StreamByte(b);
+}
+
+/*-[INTERNAL: GetBits]------------------------------------------------------}
+. Reads n (0..16) bits of the deflate stream LSB first. Past the end of
+. data zeros are fed in and counted so truncated files are caught.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static inline void BitFill (void) {
+	while (png.bitCnt <= 24) {
+		uint8_t b = 0;
+		if (!IdatByte(&b)) png.overrun++;							// Pad with zero past end
+		png.bitBuf |= (uint32_t)b << png.bitCnt;
+		png.bitCnt += 8;
+	}
+}
+
+static inline uint32_t GetBits (uint32_t n) {
+	BitFill();
+	uint32_t val = png.bitBuf & ((1u << n) - 1);					// Take the low bits
+	png.bitBuf >>= n;
+	png.bitCnt -= n;
+	return val;
+}
+
+/*-[INTERNAL: BuildHuff]----------------------------------------------------}
+. Builds the canonical Huffman table from a set of code lengths, codes of
+. HUFF_FAST_BITS or less are also placed in the direct lookup table.
+. RETURN: false if the lengths are over subscribed
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool BuildHuff (HUFFTABLE* t, const uint8_t* lengths, uint32_t n) {
+	uint16_t offs[16];
+	int left = 1;
+	memset(&t->count[0], 0, sizeof(t->count));
+	memset(&t->fast[0], 0, sizeof(t->fast));
+	for (uint32_t i = 0; i < n; i++) t->count[lengths[i]]++;		// Count codes of each length
+	t->count[0] = 0;
+	for (int len = 1; len < 16; len++) {
+		left <<= 1;
+		left -= t->count[len];
+		if (left < 0) return false;									// Over subscribed
+	}
+	offs[1] = 0;
+	for (int len = 1; len < 15; len++) offs[len + 1] = offs[len] + t->count[len];
+	for (uint32_t i = 0; i < n; i++)
+		if (lengths[i]) t->symbol[offs[lengths[i]]++] = i;			// Canonical symbol order
+	uint32_t code = 0, idx = 0;
+	for (uint32_t len = 1; len <= HUFF_FAST_BITS; len++) {
+		for (uint32_t k = 0; k < t->count[len]; k++, code++) {
+			uint32_t rev = 0;
+			for (uint32_t b = 0; b < len; b++)						// Deflate codes are bit reversed
+				rev |= ((code >> b) & 1) << (len - 1 - b);
+			uint16_t entry = (t->symbol[idx++] << 4) | len;
+			for (uint32_t j = rev; j < HUFF_FAST_SIZE; j += (1u << len))
+				t->fast[j] = entry;									// Every index starting with code
+		}
+		code <<= 1;
+	}
+	return true;
+}
+
+/*-[INTERNAL: HuffDecode]---------------------------------------------------}
+. Decodes one symbol, short codes come straight from the fast table and
+. longer codes walk the canonical counts a bit at a time.
+. RETURN: symbol or -1 for an invalid code
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static int HuffDecode (const HUFFTABLE* t) {
+	BitFill();
+	uint16_t entry = t->fast[png.bitBuf & (HUFF_FAST_SIZE - 1)];
+	if (entry) {
+		png.bitBuf >>= (entry & 0x0F);								// Consume code bits
+		png.bitCnt -= (entry & 0x0F);
+		return (entry >> 4);
+	}
+	int code = 0, first = 0, index = 0;
+	uint32_t bits = png.bitBuf;
+	for (uint32_t len = 1; len < 16; len++) {
+		code |= (bits & 1);											// Next code bit
+		bits >>= 1;
+		int count = t->count[len];
+		if (code - count < first) {									// Code is this length
+			png.bitBuf >>= len;
+			png.bitCnt -= len;
+			return t->symbol[index + (code - first)];
+		}
+		index += count;
+		first += count;
+		first <<= 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+/*-[INTERNAL: PngUnfilterRow]-----------------------------------------------}
+. Reverses the scanline filter in place, prev is the unfiltered line above.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool PngUnfilterRow (uint8_t* cur, const uint8_t* prev) {
+	uint8_t* r = &cur[1];
+	const uint8_t* p = &prev[1];
+	uint32_t bpp = png.bpp, n = png.stride, i;
+	switch (cur[0]) {
+		case 0:														// None
+			break;
+		case 1:														// Sub
+			for (i = bpp; i < n; i++) r[i] += r[i - bpp];
+			break;
+		case 2:														// Up
+			for (i = 0; i < n; i++) r[i] += p[i];
+			break;
+		case 3:														// Average
+			for (i = 0; i < bpp; i++) r[i] += p[i] >> 1;
+			for (; i < n; i++) r[i] += (uint8_t)(((uint32_t)r[i - bpp] + p[i]) >> 1);
+			break;
+		case 4:														// Paeth
+			for (i = 0; i < bpp; i++) r[i] += p[i];
+			for (; i < n; i++) {
+				int a = r[i - bpp], b = p[i], c = p[i - bpp];
+				int pa = b - c, pb = a - c, pc;
+				pc = pa + pb;
+				if (pa < 0) pa = -pa;
+				if (pb < 0) pb = -pb;
+				if (pc < 0) pc = -pc;
+				if (pa <= pb && pa <= pc) r[i] += a;
+					else if (pb <= pc) r[i] += b;
+					else r[i] += c;
+			}
+			break;
+		default:
+			return false;											// Unknown filter
+	}
+	return true;
+}
+
+/*-[INTERNAL: PngConvertRow]------------------------------------------------}
+. Converts an unfiltered scanline of any colour type and depth to the 32
+. bit row buffer. 16 bit samples keep their high byte.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static void PngConvertRow (const uint8_t* r) {
+	uint32_t w = png.width;
+	if (png.bitDepth < 8) {											// Packed grey or palette
+		uint32_t depth = png.bitDepth, mask = (1u << depth) - 1;
+		uint32_t scale = 255 / mask;
+		for (uint32_t x = 0; x < w; x++) {
+			uint32_t bit = x * depth;
+			uint32_t v = (r[bit >> 3] >> (8 - depth - (bit & 7))) & mask;
+			if (png.colourType == 3) imgRow[x] = pngPalette[v];
+			else {
+				RGBA* d = &imgRow[x];
+				d->rgbRed = d->rgbGreen = d->rgbBlue = (uint8_t)(v * scale);
+				d->rgbAlpha = 255;
+			}
+		}
+		return;
+	}
+	uint32_t step = png.bitDepth >> 3;								// Bytes per sample
+	uint32_t pstep = step * png.channels;							// Bytes per pixel
+	for (uint32_t x = 0; x < w; x++, r += pstep) {
+		RGBA* d = &imgRow[x];
+		switch (png.colourType) {
+			case 0:													// Greyscale
+				d->rgbRed = d->rgbGreen = d->rgbBlue = r[0];
+				d->rgbAlpha = 255;
+				break;
+			case 2:													// Truecolour
+				d->rgbRed = r[0];
+				d->rgbGreen = r[step];
+				d->rgbBlue = r[2 * step];
+				d->rgbAlpha = 255;
+				break;
+			case 3:													// Palette
+				*d = pngPalette[r[0]];
+				break;
+			case 4:													// Greyscale with alpha
+				d->rgbRed = d->rgbGreen = d->rgbBlue = r[0];
+				d->rgbAlpha = r[step];
+				break;
+			default:												// Truecolour with alpha
+				d->rgbRed = r[0];
+				d->rgbGreen = r[step];
+				d->rgbBlue = r[2 * step];
+				d->rgbAlpha = r[3 * step];
+				break;
+		}
+	}
+}
+
+/*-[INTERNAL: PngRowBytes]--------------------------------------------------}
+. Gathers inflated bytes into scanlines, each completed scanline is
+. unfiltered, converted and drawn. The two row buffers swap each line.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool PngRowBytes (const uint8_t* src, uint32_t n) {
+	while (n && png.rowY < png.height) {
+		uint8_t* cur = &pngRows[png.rowY & 1][0];
+		uint32_t take = png.stride + 1 - png.rowPos;				// Bytes to complete scanline
+		if (take > n) take = n;
+		memcpy(&cur[png.rowPos], src, take);
+		png.rowPos += take;
+		src += take;
+		n -= take;
+		if (png.rowPos == png.stride + 1) {							// Scanline complete
+			if (!PngUnfilterRow(cur, &pngRows[(png.rowY & 1) ^ 1][0]))
+				return false;
+			PngConvertRow(&cur[1]);
+			EmitRow(png.hdc, png.x, png.y + png.rowY, png.width);
+			png.rowY++;
+			png.rowPos = 0;
+		}
+	}
+	return true;
+}
+
+/*-[INTERNAL: PngFlushWindow]-----------------------------------------------}
+. Passes the bytes written to the window since the last flush to the
+. scanline assembler, in two pieces if they wrap the window end.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool PngFlushWindow (void) {
+	while (png.winFlushed != png.winPos) {
+		uint32_t start = png.winFlushed & PNG_WIN_MASK;
+		uint32_t n = png.winPos - png.winFlushed;					// Unflushed bytes
+		if (n > PNG_WIN_SIZE - start) n = PNG_WIN_SIZE - start;		// Up to window end
+		if (!PngRowBytes(&pngWindow[start], n)) return false;
+		png.winFlushed += n;
+	}
+	return true;
+}
+
+/*-[INTERNAL: PngInflate]---------------------------------------------------}
+. Inflates the zlib stream held in the IDAT chunks. Output goes to the 32K
+. window and is flushed to the scanlines before it can be overwritten.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static bool PngInflate (void) {
+	uint8_t lengths[320];
+	uint32_t final;
+	uint32_t cmf = GetBits(8);
+	uint32_t flg = GetBits(8);
+	if ((cmf & 0x0F) != 8 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20))
+		return false;												// Not deflate or preset dictionary
+	do {
+		final = GetBits(1);
+		uint32_t type = GetBits(2);
+		if (type == 0) {											// Stored block
+			GetBits(png.bitCnt & 7);								// Align to byte
+			uint32_t len = GetBits(16);
+			uint32_t nlen = GetBits(16);
+			if ((len ^ 0xFFFF) != nlen) return false;
+			while (len--) {
+				pngWindow[png.winPos++ & PNG_WIN_MASK] = (uint8_t)GetBits(8);
+				if (png.winPos - png.winFlushed >= PNG_WIN_FLUSH && !PngFlushWindow())
+					return false;
+			}
+		} else {
+			if (type == 1) {										// Fixed Huffman codes
+				uint32_t i = 0;
+				for (; i < 144; i++) lengths[i] = 8;
+				for (; i < 256; i++) lengths[i] = 9;
+				for (; i < 280; i++) lengths[i] = 7;
+				for (; i < 288; i++) lengths[i] = 8;
+				BuildHuff(&litTable, &lengths[0], 288);
+				for (i = 0; i < 30; i++) lengths[i] = 5;
+				BuildHuff(&distTable, &lengths[0], 30);
+			} else if (type == 2) {									// Dynamic Huffman codes
+				uint32_t hlit = GetBits(5) + 257;
+				uint32_t hdist = GetBits(5) + 1;
+				uint32_t hclen = GetBits(4) + 4;
+				memset(&lengths[0], 0, 19);
+				for (uint32_t i = 0; i < hclen; i++) lengths[clOrder[i]] = GetBits(3);
+				if (!BuildHuff(&litTable, &lengths[0], 19)) return false;	// Code length codes
+				uint32_t n = 0;
+				while (n < hlit + hdist) {
+					uint32_t rep, val = 0;
+					int sym = HuffDecode(&litTable);
+					if (sym < 0) return false;
+					if (sym < 16) {
+						lengths[n++] = sym;
+						continue;
+					}
+					if (sym == 16) {								// Repeat previous length
+						if (n == 0) return false;
+						val = lengths[n - 1];
+						rep = 3 + GetBits(2);
+					} else if (sym == 17) rep = 3 + GetBits(3);		// Short zero run
+						else rep = 11 + GetBits(7);					// Long zero run
+					if (n + rep > hlit + hdist) return false;
+					while (rep--) lengths[n++] = val;
+				}
+				if (lengths[256] == 0) return false;				// No end of block code
+				if (!BuildHuff(&litTable, &lengths[0], hlit)
+					|| !BuildHuff(&distTable, &lengths[hlit], hdist)) return false;
+			} else return false;									// Reserved block type
+			for (;;) {
+				int sym = HuffDecode(&litTable);
+				if (sym < 0) return false;
+				if (sym < 256) pngWindow[png.winPos++ & PNG_WIN_MASK] = (uint8_t)sym;
+				else if (sym == 256) break;							// End of block
+				else {
+					sym -= 257;
+					if (sym >= 29) return false;
+					uint32_t len = lenBase[sym] + GetBits(lenExtra[sym]);
+					int dsym = HuffDecode(&distTable);
+					if (dsym < 0 || dsym >= 30) return false;
+					uint32_t dist = distBase[dsym] + GetBits(distExtra[dsym]);
+					if (dist > png.winPos) return false;			// Before start of data
+					while (len--) {
+						pngWindow[png.winPos & PNG_WIN_MASK] = pngWindow[(png.winPos - dist) & PNG_WIN_MASK];
+						png.winPos++;
+					}
+				}
+				if (png.winPos - png.winFlushed >= PNG_WIN_FLUSH && !PngFlushWindow())
+					return false;
+				if (png.overrun > 4) return false;					// Truncated data
+			}
+		}
+		if (png.rowY >= png.height) break;							// All rows already out
+	} while (!final);
+	return PngFlushWindow();
+}
+
+/*-[INTERNAL: PngDecode]----------------------------------------------------}
+. Walks the PNG chunks, takes the header and palette then inflates the
+. IDAT run straight to the screen a scanline at a time.
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+static BOOL PngDecode (HDC hdc, uint32_t nXStart, uint32_t nYStart) {
+	uint8_t hdr[13];
+	bool gotHeader = false;
+	if (!StreamRead(&hdr[0], 8) || memcmp(&hdr[0], &pngSignature[0], 8) != 0)
+		return FALSE;												// Not a PNG file
+	memset(&png, 0, sizeof(png));
+	png.hdc = hdc;
+	png.x = nXStart;
+	png.y = nYStart;
+	for (;;) {
+		if (!StreamRead(&hdr[0], 8)) return FALSE;					// Chunk length and type
+		uint32_t len = BigEndian32(&hdr[0]);
+		if (memcmp(&hdr[4], "IHDR", 4) == 0) {
+			if (len != 13 || !StreamRead(&hdr[0], 13)) return FALSE;
+			png.width = BigEndian32(&hdr[0]);
+			png.height = BigEndian32(&hdr[4]);
+			png.bitDepth = hdr[8];
+			png.colourType = hdr[9];
+			switch (png.colourType) {
+				case 0: png.channels = 1; break;
+				case 2: png.channels = 3; break;
+				case 3: png.channels = 1; break;
+				case 4: png.channels = 2; break;
+				case 6: png.channels = 4; break;
+				default: return FALSE;
+			}
+			if (png.width == 0 || png.width > IMG_MAX_WIDTH || png.height == 0
+				|| hdr[10] != 0 || hdr[11] != 0 || hdr[12] != 0)	// Deflate, adaptive filter, no interlace
+				return FALSE;
+			if (png.bitDepth != 8 && png.bitDepth != 16
+				&& !((png.colourType == 0 || png.colourType == 3)
+				&& (png.bitDepth == 1 || png.bitDepth == 2 || png.bitDepth == 4)))
+				return FALSE;										// Illegal depth for colour type
+			if (png.colourType == 3 && png.bitDepth == 16) return FALSE;
+			png.stride = (png.width * png.channels * png.bitDepth + 7) >> 3;
+			png.bpp = (png.channels * png.bitDepth + 7) >> 3;
+			gotHeader = true;
+		} else if (memcmp(&hdr[4], "PLTE", 4) == 0) {
+			uint8_t rgb[3];
+			if (len > 768 || (len % 3) != 0) return FALSE;
+			for (uint32_t i = 0; i < len / 3; i++) {
+				if (!StreamRead(&rgb[0], 3)) return FALSE;
+				pngPalette[i].rgbRed = rgb[0];
+				pngPalette[i].rgbGreen = rgb[1];
+				pngPalette[i].rgbBlue = rgb[2];
+				pngPalette[i].rgbAlpha = 255;
+			}
+		} else if (memcmp(&hdr[4], "IDAT", 4) == 0) {
+			if (!gotHeader) return FALSE;
+			png.idatLeft = len;
+			memset(&pngRows[0][0], 0, png.stride + 1);				// Line above first row is zero
+			memset(&pngRows[1][0], 0, png.stride + 1);
+			if (!PngInflate()) return FALSE;
+			return (png.rowY == png.height) ? TRUE : FALSE;
+		} else if (memcmp(&hdr[4], "IEND", 4) == 0) {
+			return FALSE;											// No image data
+		} else if (!StreamSkip(len)) return FALSE;					// Ancillary chunk we don't use
+		if (!StreamSkip(4)) return FALSE;							// Chunk CRC
+	}
+}
+
+/***************************************************************************}
+{                       PUBLIC C INTERFACE ROUTINES                         }
+{***************************************************************************/
+
+/*-[QoiStreamOut]-----------------------------------------------------------}
+. Decodes a QOI image read from the open file handle and draws it top down
+. with its top left corner at nXStart, nYStart on the device context.
+. RETURN: TRUE image decoded and drawn, FALSE on invalid or unsupported data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL QoiStreamOut (HDC hdc, uint32_t nXStart, uint32_t nYStart, HANDLE hFile, IMGREADFUNC readFn) {
+	if (hdc == 0 || readFn == 0) return FALSE;						// Invalid parameters
+	StreamInit(hFile, readFn);										// Attach stream to file
+	return QoiDecode(hdc, nXStart, nYStart);						// Decode the image
+}
+
+/*-[PngStreamOut]-----------------------------------------------------------}
+. Decodes a PNG image read from the open file handle and draws it top down
+. with its top left corner at nXStart, nYStart on the device context. The
+. IDAT data is inflated through a 32K window a scanline at a time.
+. RETURN: TRUE image decoded and drawn, FALSE on invalid or unsupported data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL PngStreamOut (HDC hdc, uint32_t nXStart, uint32_t nYStart, HANDLE hFile, IMGREADFUNC readFn) {
+	if (hdc == 0 || readFn == 0) return FALSE;						// Invalid parameters
+	StreamInit(hFile, readFn);										// Attach stream to file
+	return PngDecode(hdc, nXStart, nYStart);						// Decode the image
+}
+
+/*-[ImageStreamOut]---------------------------------------------------------}
+. Checks the file signature and hands the open file to the QOI or PNG
+. stream decoder, the file must be positioned at the start of the image.
+. RETURN: TRUE image decoded and drawn, FALSE on unknown or invalid image
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL ImageStreamOut (HDC hdc, uint32_t nXStart, uint32_t nYStart, HANDLE hFile, IMGREADFUNC readFn) {
+	if (hdc == 0 || readFn == 0) return FALSE;						// Invalid parameters
+	StreamInit(hFile, readFn);										// Attach stream to file
+	if (!StreamFill() || img.len < 8) return FALSE;					// Read first chunk to check signature
+	if (memcmp(&img.buf[0], "qoif", 4) == 0)
+		return QoiDecode(hdc, nXStart, nYStart);					// QOI image
+	if (memcmp(&img.buf[0], &pngSignature[0], 8) == 0)
+		return PngDecode(hdc, nXStart, nYStart);					// PNG image
+	return FALSE;													// Unknown format
+}
@@ -0,0 +1,96 @@
+#ifndef _IMAGE_DECODE_H_
+#define _IMAGE_DECODE_H_
+
+#ifdef __cplusplus								// If we are including to a C++
+extern "C" {									// Put extern C directive wrapper around
+#endif
+
+#include <stdbool.h>							// Needed for bool and true/false
+#include <stdint.h>								// Needed for uint8_t, uint32_t, etc
+#include "rpi-smartstart.h"						// Provides HDC, HANDLE and BOOL types
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++}
+{																			}
+{       Filename: ImageDecode.h												}
+{       Copyright(c): Leon de Boer(LdB) 2017								}
+{       Version: 1.00														}
+{																			}
+{***************[ THIS CODE IS FREEWARE UNDER CC Attribution]***************}
+{																            }
+{     This sourcecode is released for the purpose to promote programming    }
+{  on the Raspberry Pi. You may redistribute it and/or modify with the      }
+{  following disclaimer and condition.                                      }
+{																            }
+{      The SOURCE CODE is distributed "AS IS" WITHOUT WARRANTIES AS TO      }
+{   PERFORMANCE OF MERCHANTABILITY WHETHER EXPRESSED OR IMPLIED.            }
+{   Redistributions of source code must retain the copyright notices to     }
+{   maintain the author credit (attribution) .								}
+{																			}
+{***************************************************************************}
+{                                                                           }
+{  Streaming QOI and PNG decoders that read a file in small chunks and      }
+{  draw each decoded row straight to a device context via CvtBmpLine. The  }
+{  whole image is never held in memory so large compressed images can be   }
+{  shown with only a few static row buffers.                                }
+{                                                                           }
+{  PNG support is non interlaced only, all colour types and bit depths.     }
+{                                                                           }
+{++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#define IMG_MAX_WIDTH	2048					// Widest image row the static decode buffers can take
+
+/*--------------------------------------------------------------------------}
+{  Read function the decoders pull file data through, matches sdReadFile    }
+{--------------------------------------------------------------------------*/
+typedef bool (*IMGREADFUNC) (HANDLE hFile,						// Handle of the open file
+							 void* lpBuffer,					// Buffer to read into
+							 uint32_t nNumberOfBytesToRead,		// Bytes requested
+							 uint32_t* lpNumberOfBytesRead,		// Bytes actually read
+							 void* lpOverlapped);				// Unused pass 0
+
+/***************************************************************************}
+{                       PUBLIC C INTERFACE ROUTINES                         }
+{***************************************************************************/
+
+/*-[QoiStreamOut]-----------------------------------------------------------}
+. Decodes a QOI image read from the open file handle and draws it top down
+. with its top left corner at nXStart, nYStart on the device context.
+. RETURN: TRUE image decoded and drawn, FALSE on invalid or unsupported data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL QoiStreamOut (HDC hdc,										// Handle to the DC
+				   uint32_t nXStart,							// Screen x position
+				   uint32_t nYStart,							// Screen y position
+				   HANDLE hFile,								// Open file handle positioned at image start
+				   IMGREADFUNC readFn);							// Read function for the file handle
+
+/*-[PngStreamOut]-----------------------------------------------------------}
+. Decodes a PNG image read from the open file handle and draws it top down
+. with its top left corner at nXStart, nYStart on the device context. The
+. IDAT data is inflated through a 32K window a scanline at a time.
+. RETURN: TRUE image decoded and drawn, FALSE on invalid or unsupported data
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL PngStreamOut (HDC hdc,										// Handle to the DC
+				   uint32_t nXStart,							// Screen x position
+				   uint32_t nYStart,							// Screen y position
+				   HANDLE hFile,								// Open file handle positioned at image start
+				   IMGREADFUNC readFn);							// Read function for the file handle
+
+/*-[ImageStreamOut]---------------------------------------------------------}
+. Checks the file signature and hands the open file to the QOI or PNG
+. stream decoder, the file must be positioned at the start of the image.
+. RETURN: TRUE image decoded and drawn, FALSE on unknown or invalid image
+. 19Oct26 LdB
+.--------------------------------------------------------------------------*/
+BOOL ImageStreamOut (HDC hdc,									// Handle to the DC
+					 uint32_t nXStart,							// Screen x position
+					 uint32_t nYStart,							// Screen y position
+					 HANDLE hFile,								// Open file handle positioned at image start
+					 IMGREADFUNC readFn);						// Read function for the file handle
+
+#ifdef __cplusplus								// If we are including to a C++ file
+}												// Close the extern C directive wrapper
+#endif
+
+#endif
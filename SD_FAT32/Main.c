@@ -5,6 +5,7 @@
 #include "emb-stdio.h"			// Needed for printf
 #include "rpi-smartstart.h"		// Needed for smart start API 
 #include "SDCard.h"
+#include "ImageDecode.h"		// Needed for QOI and PNG stream decoders
 
 
 void DisplayBitmap (uint32_t xoff, uint32_t yoff, char* bmpName) {
@@ -40,6 +41,18 @@ void DisplayBitmap (uint32_t xoff, uint32_t yoff, char* bmpName) {
 	}
 }
 
+void DisplayImage (uint32_t xoff, uint32_t yoff, char* imgName) {
+	// Open the file
+	HANDLE fHandle = sdCreateFile(imgName, GENERIC_READ, 0, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (fHandle != 0) {
+		// Decoder pulls the file through sdReadFile a chunk at a time
+		if (ImageStreamOut(GetConsoleDC(), xoff, yoff, fHandle, sdReadFile) == FALSE)
+			printf("Image file: %s, is not a valid format\n", imgName);
+		// Close the file
+		sdCloseHandle(fHandle);
+	}
+}
+
 void DisplayDirectory(const char* dirName) {
 	HANDLE fh;
 	FIND_DATA find;
@@ -79,8 +92,18 @@ int main (void) {
 	printf("Bitmap directory: \n");
 	DisplayDirectory("\\bitmaps\\*.*");
 
-	/* display bitmap on screen */
+	/* display bitmap on screen and the same image compressed, timing each load */
+	uint64_t t = timer_getTickCount();
 	DisplayBitmap(50, 360, "\\bitmaps\\elle_kathy.bmp");
+	uint32_t bmpTime = (uint32_t)tick_difference(t, timer_getTickCount());
+	t = timer_getTickCount();
+	DisplayImage(270, 360, "\\bitmaps\\elle_kathy.qoi");
+	uint32_t qoiTime = (uint32_t)tick_difference(t, timer_getTickCount());
+	t = timer_getTickCount();
+	DisplayImage(490, 360, "\\bitmaps\\elle_kathy.png");
+	uint32_t pngTime = (uint32_t)tick_difference(t, timer_getTickCount());
+	printf("Load times BMP: %u us, QOI: %u us, PNG: %u us\n", 
+		(unsigned int)bmpTime, (unsigned int)qoiTime, (unsigned int)pngTime);
 
 	while (1){
 		set_Activity_LED(1);			// Turn LED on
@@ -7,7 +7,7 @@ set "linkerflags=-Wl,-gc-sections -Wl,--build-id=none -Wl,-Bdynamic -Wl,-Map,ker
 set "outflags=-o kernel.elf"
 set "libflags=-lc -lm -lgcc -lnosys"
 @echo on
-%bindir%arm-none-eabi-gcc %cpuflags% %asmflags% %linkerflags% -Wl,-T,rpi32.ld main.c SmartStart32.S rpi-SmartStart.c emb-stdio.c SDCard.c %outflags% %libflags% 
+%bindir%arm-none-eabi-gcc %cpuflags% %asmflags% %linkerflags% -Wl,-T,rpi32.ld main.c SmartStart32.S rpi-SmartStart.c emb-stdio.c SDCard.c ImageDecode.c %outflags% %libflags% 
 @echo off
 if %errorlevel% EQU 1 (goto build_fail)
 
@@ -891,7 +891,7 @@ BOOL CvtBmpLine (HDC hdc,
 					}
 					break;
 			}
-		}
+		} else p.rawImage = imgSrc;									// Same depth put source directly
 		intDC->PutImage(intDC, cX, 1, p, true);
 		return TRUE;
 	}